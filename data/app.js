@@ -31,18 +31,38 @@
   let _ws = null;
   let _wsReconnectTimer = null;
 
-  // Heartbeat : si aucun message WS reçu depuis > 12 s, on considère l'ESP hors ligne
+  // Heartbeat : si aucun message WS reçu depuis > 12 s, on considère l'ESP hors ligne.
+  // Onglet masqué : le firmware ne pousse plus qu'une trame par minute → tolérance élargie.
   const kWsHeartbeatMs = 12000;
+  const kWsHeartbeatHiddenMs = 150000;
   let _wsHeartbeatTimer = null;
 
+  // Cadence de push adaptative côté firmware : l'UI rapporte sa visibilité et si une
+  // vue de calibration est ouverte (live → push 1 s pour suivre la stabilisation).
+  let _wsLive = false;
+  function _wsSendClientState() {
+    if (!_ws || _ws.readyState !== WebSocket.OPEN) return;
+    try {
+      _ws.send(JSON.stringify({ type: 'client_state', hidden: document.hidden, live: _wsLive }));
+    } catch (e) { /* ignore */ }
+  }
+  function _wsRefreshLive() {
+    const live = ["#temperature-card-calibration", "#ph-card-calibration", "#orp-card-calibration"]
+      .some(sel => { const el = $(sel); return !!el && el.offsetParent !== null; });
+    if (live === _wsLive) return;
+    _wsLive = live;
+    _wsSendClientState();
+  }
+
   function _resetWsHeartbeat() {
     if (_wsHeartbeatTimer) clearTimeout(_wsHeartbeatTimer);
+    const timeoutMs = document.hidden ? kWsHeartbeatHiddenMs : kWsHeartbeatMs;
     _wsHeartbeatTimer = setTimeout(() => {
       setNetStatus('bad', 'Hors ligne');
       debugLog('[WS] Heartbeat timeout — no message received');
       _closeWs();
       _wsReconnectTimer = setTimeout(() => { _wsReconnectTimer = null; initWebSocket(); }, 3000);
-    }, kWsHeartbeatMs);
+    }, timeoutMs);
   }
 
   function _closeWs() {
@@ -66,6 +86,7 @@
     _ws.onopen = () => {
       if (_wsReconnectTimer) { clearTimeout(_wsReconnectTimer); _wsReconnectTimer = null; }
       if (token) _ws.send(JSON.stringify({ type: 'auth', token }));
+      _wsSendClientState();
       setNetStatus('ok', 'En ligne');
       _resetWsHeartbeat();
       debugLog('[WS] Connected');
@@ -79,8 +100,13 @@
           _onWsSensorData(msg.data);
         } else if (msg.type === 'config') {
           loadConfig({ data: msg.data });
+        } else if (msg.type === 'logs') {
+          // Lot de logs regroupés côté firmware (fenêtre ~250 ms)
+          if (Array.isArray(msg.data)) msg.data.forEach(_onWsLog);
         } else if (msg.type === 'log') {
-          _onWsLog(msg.data);
+          _onWsLog(msg.data);  // ancien firmware : une trame par entrée
+        } else if (msg.type === 'calibration') {
+          _onWsCalibration(msg.data);
         }
       } catch (e) { console.error('[WS] parse error:', e); }
     };
@@ -1224,6 +1250,12 @@
     }
   }
 
+  // Champ empreinte visible uniquement en TLS.
+  function updateMqttTlsFields() {
+    const field = $("#mqtt_tls_fingerprint_field");
+    if (field) field.hidden = !($("#mqtt_tls")?.checked ?? false);
+  }
+
   function updateFiltrationControls() {
     const modeSelect = $("#filtration_mode");
     const start = $("#filtration_start");
@@ -1463,6 +1495,9 @@
       topic: $("#mqtt_topic")?.value || "",
       username: $("#mqtt_username")?.value || "",
       password: $("#mqtt_password")?.value || "",
+      state_json: $("#mqtt_state_json")?.checked ?? false,
+      tls: $("#mqtt_tls")?.checked ?? false,
+      tls_fingerprint: ($("#mqtt_tls_fingerprint")?.value || "").trim(),
       ph_target: isNaN(phValue) ? 7.2 : phValue,
       orp_target: isNaN(orpValue) ? 650 : orpValue,
       ph_enabled: (window._config?.ph_regulation_mode || "automatic") !== "manual",
@@ -1516,6 +1551,9 @@
       topic: $("#mqtt_topic")?.value || "",
       username: $("#mqtt_username")?.value || "",
       password: $("#mqtt_password")?.value || "",
+      state_json: $("#mqtt_state_json")?.checked ?? false,
+      tls: $("#mqtt_tls")?.checked ?? false,
+      tls_fingerprint: ($("#mqtt_tls_fingerprint")?.value || "").trim(),
     };
   }
 
@@ -1546,7 +1584,7 @@
     window._config = cfg;
 
     const activeId = document.activeElement?.id || "";
-    const mqttEditing = ["mqtt_server", "mqtt_port", "mqtt_topic", "mqtt_username", "mqtt_password", "mqtt_enabled"].includes(activeId);
+    const mqttEditing = ["mqtt_server", "mqtt_port", "mqtt_topic", "mqtt_username", "mqtt_password", "mqtt_enabled", "mqtt_state_json", "mqtt_tls", "mqtt_tls_fingerprint"].includes(activeId);
 
     if (!mqttEditing) {
       $("#mqtt_server").value = cfg.server || "";
@@ -1555,6 +1593,10 @@
       $("#mqtt_username").value = cfg.username || "";
       $("#mqtt_password").value = cfg.password || "";
       $("#mqtt_enabled").checked = cfg.enabled !== false;
+      $("#mqtt_state_json").checked = cfg.state_json === true;
+      $("#mqtt_tls").checked = cfg.tls === true;
+      $("#mqtt_tls_fingerprint").value = cfg.tls_fingerprint || "";
+      updateMqttTlsFields();
     }
 
     updateMqttStatusIndicator(cfg.enabled, cfg.mqtt_connected);
@@ -3510,6 +3552,7 @@
     const refInput = $("#temp_reference_value");
     if (refInput) refInput.value = "";
     updateTempCalibrationSteps();
+    _wsRefreshLive();
   }
   function hideTempCalibrationCard() {
     const enable = $("#temperature-card-enable");
@@ -3525,6 +3568,7 @@
     if (refInput) refInput.value = "";
     updateTempCalibrationSteps();
     calBtn?.focus();
+    _wsRefreshLive();
   }
 
   function updateTempCalibrationSteps() {
@@ -3985,6 +4029,7 @@
     if (hist) hist.style.display = "none";
     if (cal) cal.style.display = "";
     if (calBtn) calBtn.disabled = true;
+    _wsRefreshLive();
   }
   function hidePhCalibrationCard() {
     _calEndAwait(); // annuler une attente de calibration en cours
@@ -3997,6 +4042,7 @@
     if (cal) cal.style.display = "none";
     if (calBtn) calBtn.disabled = false;
     updatePhModeControls();
+    _wsRefreshLive();
   }
   function showOrpCalibrationCard() {
     const reg = $("#orp-card-regulation");
@@ -4007,6 +4053,7 @@
     if (hist) hist.style.display = "none";
     if (cal) cal.style.display = "";
     if (calBtn) calBtn.disabled = true;
+    _wsRefreshLive();
   }
   function hideOrpCalibrationCard() {
     _calEndAwait(); // annuler une attente de calibration en cours
@@ -4019,6 +4066,7 @@
     if (cal) cal.style.display = "none";
     if (calBtn) calBtn.disabled = false;
     updateOrpModeControls();
+    _wsRefreshLive();
   }
 
   // ---------- feature-034 : calibration ÉVÉNEMENTIELLE (remplace le polling bloquant) ----------
@@ -4027,9 +4075,13 @@
   // mise à jour de données (WS push, fetch /data périodique/forcé, retour de focus). C'est
   // robuste : insensible à la pause des timers/WebSocket par Safari (au retour sur l'onglet,
   // le refresh déclenche la détection). _calPollTimer force /data en best-effort pendant l'attente.
+  // Firmware récent : l'avancement arrive en push WS {"type":"calibration"} (attente de
+  // stabilité, exécution, bilan) → _onWsCalibration() fait foi et checkCalAwait() ne sert
+  // plus que de filet (ancien firmware, WS coupé) avec une échéance allongée d'autant.
   let _calAwait = null;
   let _calPollTimer = null;
   const CAL_AWAIT_TIMEOUT_MS = 20000;
+  const CAL_AWAIT_PUSHED_TIMEOUT_MS = 140000;  // 120 s de stabilité max + exécution EZO
   // Délai d'exécution EZO avant de valider une RECALIBRATION (point déjà calibré : le compteur
   // de points ne change pas, donc on ne peut pas se fier à un incrément). Au-delà de ce délai,
   // si la sonde est joignable et que le point attendu est présent, on considère la cal réussie.
@@ -4066,6 +4118,14 @@
   function checkCalAwait() {
     if (!_calAwait) return;
     const a = _calAwait;
+    if (a.pushed) {
+      // Le firmware pousse le bilan : ni heuristique de points, ni échéance courte.
+      if (Date.now() - a.startMs > CAL_AWAIT_PUSHED_TIMEOUT_MS) {
+        showToast("Calibration " + a.stepLabel + " : délai dépassé — vérifier la sonde", "warning");
+        _calEndAwait();
+      }
+      return;
+    }
     const pts = a.product === "ph" ? latestSensorData?.phCalPoints : latestSensorData?.orpCalPoints;
     if (pts === -1) {
       showToast("Calibration " + a.stepLabel + " : EZO injoignable", "error");
@@ -4095,6 +4155,38 @@
     }
   }
 
+  // Push WS {"type":"calibration","data":{sensor, step, state, error, stable_run,
+  // stable_required, spread, points, elapsed_ms, waited_ms}}.
+  function _onWsCalibration(d) {
+    const a = _calAwait;
+    if (!a || !d || d.sensor !== a.product) return;
+    const step = d.sensor === "ph" ? d.step : "orp";
+    if (step !== a.step) return;  // Autre étape (ex. Cal,clear) : pas la nôtre
+    a.pushed = true;
+    if (_calPollTimer) { clearInterval(_calPollTimer); _calPollTimer = null; }
+    const btn = $("#" + a.btnId);
+    if (d.state === "stabilizing") {
+      if (btn) btn.textContent = "Stabilisation " + (d.stable_run ?? 0) + "/" + (d.stable_required ?? "?") + "…";
+    } else if (d.state === "running") {
+      if (btn) btn.textContent = "Calibration en cours…";
+    } else if (d.state === "done") {
+      const detail = a.product === "ph"
+        ? (typeof d.points === "number" && d.points >= 0 ? " (" + d.points + "/2 points)" : "")
+        : (a.reference != null ? " (référence " + a.reference + " mV)" : "");
+      showToast("Calibration " + a.stepLabel + " réussie" + detail, "success");
+      if (a.product === "ph") completeCalStep("ph", a.step === "mid" ? 1 : 3);
+      else completeCalStep("orp", 2);
+      _calEndAwait();
+      loadSensorData({ force: true, source: "cal-done" });
+    } else if (d.state === "failed") {
+      const why = d.error === "unstable" ? "lectures instables — laisser la sonde se poser puis réessayer"
+                : d.error === "rejected" ? "refusée par l'EZO"
+                : "EZO injoignable";
+      showToast("Calibration " + a.stepLabel + " : " + why, "error");
+      _calEndAwait();
+    }
+  }
+
   // POST /calibrate_ph {step} — non bloquant : la détection se fait via checkCalAwait().
   async function calibratePh(step /* 'mid' | 'low' */) {
     if (_calAwait) return; // une calibration déjà en attente
@@ -5075,7 +5167,15 @@
       }
     };
 
-    trackDirtyState("#mqtt_save_btn", ["mqtt_enabled", "mqtt_server", "mqtt_port", "mqtt_topic", "mqtt_username", "mqtt_password"]);
+    trackDirtyState("#mqtt_save_btn", ["mqtt_enabled", "mqtt_server", "mqtt_port", "mqtt_topic", "mqtt_username", "mqtt_password", "mqtt_state_json", "mqtt_tls", "mqtt_tls_fingerprint"]);
+
+    // Bascule TLS : port par défaut suivi (1883 ↔ 8883) s'il n'a pas été personnalisé.
+    $("#mqtt_tls")?.addEventListener("change", (e) => {
+      const port = $("#mqtt_port");
+      if (port && e.target.checked && port.value === "1883") port.value = "8883";
+      if (port && !e.target.checked && port.value === "8883") port.value = "1883";
+      updateMqttTlsFields();
+    });
 
     mqttEnabled?.addEventListener("change", () => {
       updateMqttStatusIndicator(mqttEnabled.checked, false);
@@ -6166,6 +6266,7 @@
       routePerf?.end(`route=${r.view}`);
     };
     window.addEventListener("hashchange", applyRoute);
+    window.addEventListener("hashchange", _wsRefreshLive);  // quitter la vue ferme le mode live
     applyRoute(); // Afficher la vue immédiatement
 
     // charts - Les anciens graphiques restent pour stocker les données historiques
@@ -6229,11 +6330,15 @@
 
     // Reconnexion immédiate lors du retour sur la page (iPad/mobile : après déverrouillage)
     document.addEventListener('visibilitychange', () => {
-      if (!document.hidden) {
-        _closeWs();
-        // Petit délai pour laisser Safari libérer la socket avant d'en ouvrir une nouvelle
-        setTimeout(initWebSocket, 100);
+      if (document.hidden) {
+        // Passage en arrière-plan : le firmware bascule ce client en heartbeat 60 s
+        _wsSendClientState();
+        if (_ws) _resetWsHeartbeat();
+        return;
       }
+      _closeWs();
+      // Petit délai pour laisser Safari libérer la socket avant d'en ouvrir une nouvelle
+      setTimeout(initWebSocket, 100);
     });
 
     // Charger la config avant d'ouvrir le WebSocket : l'ESP32 a fini de traiter
@@ -5,7 +5,9 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include "config.h"   // i2cMutex
+#include "ezo_cal_logic.h"
+#include "ezo_comp_logic.h"
+#include "i2c_bus.h"
 #include "logger.h"   // systemLogger
 
 // =============================================================================
@@ -27,14 +29,14 @@ static constexpr size_t kEzoReadBufLen = 32;
 // Construction
 // =============================================================================
 
-AtlasEzoSensor::AtlasEzoSensor(uint8_t i2cAddress, const char* name)
-    : _address(i2cAddress), _name(name ? name : "EZO") {}
+AtlasEzoSensor::AtlasEzoSensor(uint8_t i2cAddress, I2cDevice device, const char* name)
+    : _address(i2cAddress), _device(device), _name(name ? name : "EZO") {}
 
 // =============================================================================
-// Helpers bas niveau (mutex I²C doit être pris par l'appelant)
+// Primitives d'étape (i2cTask, aucune attente)
 // =============================================================================
 
-bool AtlasEzoSensor::_sendCmdLocked(const char* cmd) {
+bool AtlasEzoSensor::sendCmd(const char* cmd) {
   if (cmd == nullptr) return false;
 
   Wire.beginTransmission(_address);
@@ -49,14 +51,12 @@ bool AtlasEzoSensor::_sendCmdLocked(const char* cmd) {
   return true;
 }
 
-int AtlasEzoSensor::_readResponseLocked(char* buf, size_t bufLen, uint32_t delayMs) {
+int AtlasEzoSensor::readResponse(char* buf, size_t bufLen) {
   if (buf == nullptr || bufLen < kEzoReadBufLen) return -1;
 
-  // Le firmware EZO requiert un délai minimal entre la commande et la lecture
-  // (600 ms pour RT, 900 ms pour R/Cal/I). Pendant ce délai, FreeRTOS reste
-  // libre — vTaskDelay équivalent à delay() ici, le watchdog (30 s) n'est
-  // jamais menacé.
-  delay(delayMs);
+  // Le délai de traitement EZO (300 ms pour T, 900 ms pour R/Cal/I) est
+  // l'attente entre deux étapes de la transaction : le bus sert les autres
+  // périphériques pendant ce temps (i2c_sched_logic).
 
   // Lecture I²C : on demande bufLen-1 octets pour pouvoir terminer par '\0'.
   size_t requested = bufLen - 1;
@@ -103,209 +103,142 @@ int AtlasEzoSensor::_readResponseLocked(char* buf, size_t bufLen, uint32_t delay
 }
 
 // =============================================================================
-// Méthodes publiques bas niveau (l'appelant tient le mutex)
+// Lecture en deux temps (étapes du cycle SensorManager)
 // =============================================================================
 
-bool AtlasEzoSensor::sendCmd(const char* cmd) {
-  return _sendCmdLocked(cmd);
+// "R" sur les deux modules :
+//   - EZO pH (0x63) : la valeur retournée est compensée avec la T° mémorisée
+//     par le dernier `T,<t>` (poussé sur changement par SensorManager).
+//     Remplace `RT,<t>` à chaque cycle.
+//   - EZO ORP (0x62) : pas de compensation T°. Le module ACCEPTE "RT,<t>"
+//     (statut 1) mais ne retourne PAS de payload — confirmé empiriquement
+//     2026-05-10 : RT,25.0 → status=1 resp="", R → status=1 resp="-369.2".
+//
+// Hotfix oscillation 2026-05-07 (PCB v2) : la séquence RT,<t> puis R à chaque
+// cycle causait une oscillation pH "1 sur 2" (~0.1 pH crête-à-crête, période
+// 10 s). Avec T persistant, toutes les lectures R partagent la même
+// compensation : pas d'alternance.
+bool AtlasEzoSensor::startRead() {
+  return sendCmd("R");
 }
 
-int AtlasEzoSensor::readResponse(char* buf, size_t bufLen, uint32_t delayMs) {
-  return _readResponseLocked(buf, bufLen, delayMs);
+bool AtlasEzoSensor::startTempCompensation(float tempC) {
+  char cmd[16];
+  return ezoFormatTempCmd(tempC, cmd, sizeof(cmd)) > 0 && sendCmd(cmd);
 }
 
-// =============================================================================
-// Méthodes publiques de haut niveau (mutex pris en interne, séquence atomique)
-// =============================================================================
-
-bool AtlasEzoSensor::readSingle(float& out, float tempC) {
-  if (xSemaphoreTake(i2cMutex, pdMS_TO_TICKS(kI2cMutexTimeoutMs)) != pdTRUE) {
-    systemLogger.warning(String(_name) + " : timeout mutex I²C (readSingle)");
+bool AtlasEzoSensor::collectReading(float& out) {
+  char buf[kEzoReadBufLen];
+  // Délai de conversion déjà écoulé (attente de la transaction).
+  int n = readResponse(buf, sizeof(buf));
+  if (n <= 0) return false;
+  // La réponse est une chaîne ASCII type "7.234" (pH) ou "650.0" (ORP).
+  char* endptr = nullptr;
+  float v = strtof(buf, &endptr);
+  if (endptr == buf) {
+    systemLogger.warning(String(_name) + " : parse float échoué (\"" + String(buf) + "\")");
     return false;
   }
+  out = v;
+  return true;
+}
 
-  bool ok = false;
+bool AtlasEzoSensor::collectAck() {
   char buf[kEzoReadBufLen];
+  // Statut 1 sans payload attendu : n == 0 est un succès.
+  return readResponse(buf, sizeof(buf)) >= 0;
+}
 
-  // Choix de la commande selon le module :
-  //   - EZO pH (0x63) : "RT,<tempC>" applique la compensation T° (Nernst) ET
-  //     retourne la valeur pH compensée en une seule commande (statut 1 + payload).
-  //   - EZO ORP (0x62) : "R" lecture standard. Le module ORP ACCEPTE la commande
-  //     "RT,<tempC>" (statut 1) mais NE RETOURNE PAS de payload (resp vide) car
-  //     il n'a pas de compensation T° à faire — l'ORP est potentiométrique direct.
-  //     Confirmé empiriquement 2026-05-10 (commande EZO manuelle) : RT,25.0 → status=1
-  //     resp="", R → status=1 resp="-369.2". Le firmware attendait un payload qui
-  //     ne venait jamais → fail streak → "bus I²C dégradé".
-  //
-  // Hotfix oscillation 2026-05-07 (PCB v2) : la séquence précédente envoyait
-  // RT,<t> puis R, ce qui causait une oscillation cyclique pH "1 sur 2"
-  // (~0.1 pH crête-à-crête, période 10 s). RT seul = une lecture stable.
-  char cmd[16];
-  if (_address == kEzoPhAddress) {
-    snprintf(cmd, sizeof(cmd), "RT,%.1f", tempC);
-  } else {
-    // EZO ORP : lecture simple, pas de compensation T°.
-    strncpy(cmd, "R", sizeof(cmd) - 1);
-    cmd[sizeof(cmd) - 1] = '\0';
-  }
+bool AtlasEzoSensor::startCalPointsQuery() {
+  return sendCmd("Cal,?");
+}
 
-  if (_sendCmdLocked(cmd)) {
-    // 900 ms : délai standard pour R/RT sur EZO (datasheet Atlas).
-    int n = _readResponseLocked(buf, sizeof(buf), kEzoReadDelayMs);
-    if (n > 0) {
-      // La réponse est une chaîne ASCII type "7.234" (pH) ou "650.0" (ORP).
-      char* endptr = nullptr;
-      float v = strtof(buf, &endptr);
-      if (endptr != buf) {
-        out = v;
-        ok = true;
-      } else {
-        systemLogger.warning(String(_name) + " : parse float échoué (\"" + String(buf) + "\")");
-      }
-    }
+int AtlasEzoSensor::collectCalPoints() {
+  char buf[kEzoReadBufLen];
+  if (readResponse(buf, sizeof(buf)) <= 0) return -1;
+  const int points = ezoParseCalPoints(buf);
+  if (points < 0) {
+    systemLogger.warning(String(_name) + " : Cal,? réponse inattendue (\"" + String(buf) + "\")");
   }
+  return points;
+}
 
-  xSemaphoreGive(i2cMutex);
-  return ok;
+bool AtlasEzoSensor::startSlopeQuery() {
+  return sendCmd("Slope,?");
 }
 
-bool AtlasEzoSensor::calibrate(const char* arg) {
-  if (arg == nullptr) return false;
+bool AtlasEzoSensor::collectSlope(PhSlopeInfo& out) {
+  char buf[kEzoReadBufLen];
+  if (readResponse(buf, sizeof(buf)) <= 0) return false;
+  // Trace brute en debug uniquement (toggle DEBUG via feature-017).
+  // Niveau warning évité : query auto toutes les 24h → spam HA si warning.
+  systemLogger.debug(String(_name) + " : Slope,? réponse brute = \"" + String(buf) + "\"");
+  if (ezoParseSlope(buf, out)) return true;
+  systemLogger.warning(String(_name) + " : Slope,? parsing échoué (\"" + String(buf) + "\")");
+  return false;
+}
 
-  if (xSemaphoreTake(i2cMutex, pdMS_TO_TICKS(kI2cMutexTimeoutMs)) != pdTRUE) {
-    systemLogger.warning(String(_name) + " : timeout mutex I²C (calibrate)");
-    return false;
-  }
+// =============================================================================
+// Méthodes publiques de haut niveau (transaction synchrone, module réservé)
+// =============================================================================
 
-  bool ok = false;
-  char cmd[32];
-  snprintf(cmd, sizeof(cmd), "Cal,%s", arg);
+struct AtlasEzoSensor::CommandCtx {
+  AtlasEzoSensor* self;
+  const char* cmd;
+  char* buf;
+  size_t bufLen;
+  int n;
+};
+
+// Étape 0 : émission ; étape 1 (après kEzoCalDelayMs) : relève.
+uint32_t AtlasEzoSensor::_commandStep(I2cTxn& txn) {
+  CommandCtx* c = static_cast<CommandCtx*>(txn.ctx);
+  if (txn.stage == 0) {
+    if (!c->self->sendCmd(c->cmd)) return 0;  // ok = false
+    txn.stage = 1;
+    return kEzoCalDelayMs;
+  }
+  c->n = c->self->readResponse(c->buf, c->bufLen);
+  txn.ok = true;
+  return 0;
+}
 
-  if (_sendCmdLocked(cmd)) {
-    char buf[kEzoReadBufLen];
-    int n = _readResponseLocked(buf, sizeof(buf), kEzoCalDelayMs);
-    // n >= 0 signifie que le module a répondu avec un statut valide
-    // (succès ou no-data sans erreur). Atlas renvoie statut=1 sans payload
-    // pour Cal,* — donc n peut valoir 0 légitimement.
-    ok = (n >= 0);
-    if (ok) {
-      systemLogger.info(String(_name) + " : calibration OK (" + String(arg) + ")");
-    } else {
-      systemLogger.error(String(_name) + " : calibration échouée (" + String(arg) + ")");
+int AtlasEzoSensor::_command(const char* cmd, char* buf, size_t bufLen,
+                             I2cPriority prio, const char* what) {
+  CommandCtx ctx{this, cmd, buf, bufLen, -1};
+  I2cTxn txn;
+  txn.devices = i2cDeviceBit(_device);
+  txn.priority = prio;
+  txn.timeoutMs = kI2cTxnTimeoutMs;
+  txn.step = &AtlasEzoSensor::_commandStep;
+  txn.ctx = &ctx;
+  if (!i2cBus.run(txn)) {
+    if (txn.state == I2cTxnState::Expired) {
+      systemLogger.warning(String(_name) + " : bus I²C indisponible (" + String(what) + ")");
     }
+    return -1;
   }
-
-  xSemaphoreGive(i2cMutex);
-  return ok;
-}
-
-bool AtlasEzoSensor::clearCalibration() {
-  return calibrate("clear");
+  return ctx.n;
 }
 
 int AtlasEzoSensor::queryCalPoints() {
-  if (xSemaphoreTake(i2cMutex, pdMS_TO_TICKS(kI2cMutexTimeoutMs)) != pdTRUE) {
-    systemLogger.warning(String(_name) + " : timeout mutex I²C (queryCalPoints)");
-    return -1;
-  }
-
   int points = -1;
-  if (_sendCmdLocked("Cal,?")) {
-    char buf[kEzoReadBufLen];
-    int n = _readResponseLocked(buf, sizeof(buf), kEzoCalDelayMs);
-    if (n > 0) {
-      // Réponse Atlas : "?CAL,N" — on cherche la dernière virgule et on lit le nombre.
-      const char* comma = strrchr(buf, ',');
-      if (comma != nullptr && *(comma + 1) != '\0') {
-        char digit = *(comma + 1);
-        if (digit >= '0' && digit <= '3') {
-          points = digit - '0';
-        }
-      }
-      if (points < 0) {
-        systemLogger.warning(String(_name) + " : Cal,? réponse inattendue (\"" + String(buf) + "\")");
-      }
+  char buf[kEzoReadBufLen];
+  int n = _command("Cal,?", buf, sizeof(buf), I2cPriority::OnDemand, "queryCalPoints");
+  if (n > 0) {
+    points = ezoParseCalPoints(buf);
+    if (points < 0) {
+      systemLogger.warning(String(_name) + " : Cal,? réponse inattendue (\"" + String(buf) + "\")");
     }
   }
-
-  xSemaphoreGive(i2cMutex);
   return points;
 }
 
-bool AtlasEzoSensor::querySlope(PhSlopeInfo& out) {
-  if (xSemaphoreTake(i2cMutex, pdMS_TO_TICKS(kI2cMutexTimeoutMs)) != pdTRUE) {
-    systemLogger.warning(String(_name) + " : timeout mutex I²C (querySlope)");
-    return false;
-  }
-
-  bool ok = false;
-  if (_sendCmdLocked("Slope,?")) {
-    char buf[kEzoReadBufLen];
-    int n = _readResponseLocked(buf, sizeof(buf), kEzoCalDelayMs);
-    if (n > 0) {
-      // Réponse Atlas EZO pH attendue : "?Slope,<acid>,<base>[,<zero>]".
-      // Trace brute en debug uniquement (toggle DEBUG via feature-017).
-      // Niveau warning évité : query auto toutes les 24h → spam HA si warning.
-      systemLogger.debug(String(_name) + " : Slope,? réponse brute = \"" +
-                         String(buf) + "\"");
-
-      // Recherche de la 1ʳᵉ virgule (après "?Slope") puis parsing séquentiel.
-      const char* p = strchr(buf, ',');
-      if (p != nullptr) {
-        ++p;  // après la virgule
-        char* endptr = nullptr;
-        float acid = strtof(p, &endptr);
-        if (endptr != p && *endptr == ',') {
-          const char* p2 = endptr + 1;
-          float base = strtof(p2, &endptr);
-          if (endptr != p2) {
-            // 2 floats valides au minimum (acide + base).
-            out.acidPct = acid;
-            out.basePct = base;
-            // 3ᵉ float optionnel : décalage zéro en mV si présent.
-            if (*endptr == ',') {
-              const char* p3 = endptr + 1;
-              float zero = strtof(p3, &endptr);
-              if (endptr != p3) {
-                out.zeroOffsetMv = zero;
-              } else {
-                out.zeroOffsetMv = NAN;
-              }
-            } else {
-              // Firmware EZO ancien : pas de 3ᵉ valeur.
-              out.zeroOffsetMv = NAN;
-            }
-            ok = true;
-          }
-        }
-      }
-      if (!ok) {
-        systemLogger.warning(String(_name) + " : Slope,? parsing échoué (\"" +
-                             String(buf) + "\")");
-      }
-    }
-  }
-
-  xSemaphoreGive(i2cMutex);
-  return ok;
-}
-
-bool AtlasEzoSensor::readInfo(String& fw) {
-  if (xSemaphoreTake(i2cMutex, pdMS_TO_TICKS(kI2cMutexTimeoutMs)) != pdTRUE) {
-    systemLogger.warning(String(_name) + " : timeout mutex I²C (readInfo)");
-    return false;
-  }
-
-  bool ok = false;
-  if (_sendCmdLocked("I")) {
-    char buf[kEzoReadBufLen];
-    int n = _readResponseLocked(buf, sizeof(buf), kEzoCalDelayMs);
-    if (n > 0) {
-      fw = String(buf);
-      ok = true;
-    }
-  }
-
-  xSemaphoreGive(i2cMutex);
-  return ok;
+bool AtlasEzoSensor::identify(char* buf, size_t len) {
+  if (buf == nullptr || len == 0) return false;
+  buf[0] = '\0';
+  char resp[kEzoReadBufLen];
+  if (_command("I", resp, sizeof(resp), I2cPriority::OnDemand, "identify") <= 0) return false;
+  strlcpy(buf, resp, len);
+  return true;
 }
@@ -4,104 +4,101 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include "constants.h"
+#include "i2c_sched_logic.h"
+#include "sensor_channel.h"
+
+struct I2cTxn;
 
 // =============================================================================
 // AtlasEzoSensor — Mini-classe pilote pour modules Atlas Scientific EZO Embedded
 // =============================================================================
 //
 // Encapsule la communication I²C avec un module EZO (pH ou ORP) :
-//  - commandes ASCII (R, RT,<t>, Cal,*, Cal,?, I)
-//  - timing requis par le firmware EZO (600/900 ms entre cmd et lecture)
+//  - commandes ASCII (R, T,<t>, Cal,*, Cal,?, I)
+//  - timing requis par le firmware EZO (300/900 ms entre cmd et lecture)
 //  - parsing du code de statut Atlas (1=OK, 2=err, 254=pas prêt, 255=no data)
 //
-// Concurrence : le bus I²C est partagé avec le DS3231 et autres périphériques.
-// Le mutex global `i2cMutex` (déclaré dans config.h) doit être pris pour TOUTE
-// séquence cohérente. Les méthodes publiques de haut niveau (readSingle,
-// calibrate, clearCalibration, queryCalPoints, readInfo) prennent le mutex en
-// interne et le tiennent pendant TOUTE la séquence cmd+delay+read pour garantir
-// l'atomicité (cf. pool-chemistry condition #6).
+// Concurrence : le bus I²C est partagé avec le DS3231 ; seule i2cTask y
+// accède (i2c_bus, ADR-0028). Les primitives d'étape (sendCmd, readResponse,
+// startRead, collectReading, startCalPointsQuery…) n'attendent jamais : elles
+// s'appellent depuis une fonction d'étape I2cTxn (i2cTask), pour composer des
+// séquences comme le cycle pH/ORP de SensorManager.
+//
+// La calibration n'a pas de méthode dédiée : SensorManager soumet une
+// transaction Urgent asynchrone (Cal,<arg> puis Cal,? et Slope,? via ces
+// primitives), le module restant réservé pendant toute la séquence
+// (atomicité, cf. pool-chemistry condition #6) mais le bus libre pendant les
+// attentes ; loopTask n'attend pas, elle relève le bilan.
+//
+// Seules queryCalPoints et identify restent des transactions synchrones
+// (OnDemand) : boot et routes de diagnostic, hors chemin chaud.
 //
-// Les méthodes "bas niveau" sendCmd / readResponse sont publiques pour permettre
-// des séquences personnalisées, mais l'appelant doit alors tenir le mutex
-// lui-même.
+// Pilote de voie (SensorDriver, sensor_channel.h) : R en deux temps,
+// identification "I" et Cal,? — le cycle d'acquisition ne connaît que
+// l'interface.
 //
 // Voir spec : specs/features/doing/feature-021-migration-atlas-ezo.md
 // =============================================================================
 
-// Informations de pente d'une sonde pH (feature-024).
-// Renvoyées par la commande Atlas "Slope,?" sur l'EZO pH.
-// Réponse type firmware EZO pH 2.x : "?Slope,99.7,100.3,-0.89"
-//  - acidPct      : pente côté acide (point pH 4) en % de la pente théorique Nernst
-//  - basePct      : pente côté base (point pH 10) en % de la pente théorique Nernst
-//  - zeroOffsetMv : décalage du point isopotentiel (pH 7) en mV ; NaN si firmware
-//                   EZO ancien ne le rapporte pas (réponse à 2 floats seulement)
-struct PhSlopeInfo {
-  float acidPct;
-  float basePct;
-  float zeroOffsetMv;
-};
-
-class AtlasEzoSensor {
+class AtlasEzoSensor : public SensorDriver {
 public:
-  // Construit le pilote. `name` est utilisé uniquement pour les logs (ex. "EZO pH").
-  AtlasEzoSensor(uint8_t i2cAddress, const char* name);
+  // Construit le pilote. `device` identifie le module auprès de l'ordonnanceur
+  // du bus, `name` est utilisé uniquement pour les logs (ex. "EZO pH").
+  AtlasEzoSensor(uint8_t i2cAddress, I2cDevice device, const char* name);
 
-  // Envoie une commande ASCII au module (ex. "R", "RT,25.5", "Cal,mid,7.00").
-  // ATTENTION : le mutex I²C doit déjà être pris par l'appelant.
+  // --- Primitives d'étape (i2cTask uniquement, aucune attente interne) ---
+  // Envoie une commande ASCII au module (ex. "R", "T,25.5", "Cal,mid,7.00").
   // Retourne true si la transaction Wire a abouti (Wire.endTransmission == 0).
   bool sendCmd(const char* cmd);
 
-  // Lit la réponse du module après attente du délai approprié.
-  // ATTENTION : le mutex I²C doit déjà être pris par l'appelant.
+  // Relève la réponse du module ; le délai de traitement EZO doit être écoulé.
   // `bufLen` doit être >= 32 octets. La fonction termine `buf` par un '\0'.
   // Retourne le nombre d'octets utiles copiés dans `buf` (sans le code statut),
   // 0 si pas de données utiles, ou -1 si erreur (statut != 1).
-  int readResponse(char* buf, size_t bufLen, uint32_t delayMs);
-
-  // Lecture d'une valeur scalaire (pH ou ORP) avec compensation T° préalable.
-  // Séquence interne : RT,<tempC> + delay + R + delay + parse float.
-  // Prend le mutex I²C en interne pour toute la séquence.
-  // Retourne true si lecture valide (out contient la valeur). Sinon out est inchangé.
-  bool readSingle(float& out, float tempC);
-
-  // Lance une commande de calibration ("Cal,<arg>").
-  // Exemples d'arguments : "mid,7.00", "low,4.00", "high,10.00", "470".
-  // Prend le mutex I²C en interne. Retourne true si statut EZO = 1.
-  bool calibrate(const char* arg);
-
-  // Efface toute la calibration mémorisée dans l'EZO ("Cal,clear").
-  // Prend le mutex I²C en interne. Retourne true si succès.
-  bool clearCalibration();
+  int readResponse(char* buf, size_t bufLen);
+
+  // Lecture en deux temps : émission, puis relève après kEzoReadDelayMs (R)
+  // / kEzoTempCompDelayMs (T). Aucune autre commande ne doit viser le module
+  // entre les deux (transaction qui le réserve). Retournent false sur erreur
+  // Wire / statut EZO.
+  bool startRead() override;                 // "R"
+  bool startTempCompensation(float tempC);   // "T,<tempC>"
+  bool collectReading(float& out) override;  // relève R + parse float
+  bool collectAck();                         // relève T (statut 1, sans payload)
+  // Requêtes en deux temps, relève après kEzoCalDelayMs (même contrat).
+  bool startCalPointsQuery() override;       // "Cal,?"
+  int collectCalPoints() override;           // 0..3, -1 si erreur / réponse inattendue
+  bool startSlopeQuery();                    // "Slope,?" (EZO pH)
+  bool collectSlope(PhSlopeInfo& out);       // ezoParseSlope, false si erreur (out inchangé)
 
   // Interroge le nombre de points de calibration mémorisés ("Cal,?").
   // Réponse Atlas : "?CAL,N" avec N entre 0 et 3.
-  // Prend le mutex I²C en interne.
+  // Transaction OnDemand.
   // Retourne -1 si EZO injoignable / parsing échoué, 0..3 sinon.
-  int queryCalPoints();
+  int queryCalPoints() override;
 
   // Lit la version firmware du module ("I" command).
   // Réponse type : "?I,pH,2.10" ou "?I,ORP,2.10".
-  // Prend le mutex I²C en interne. Place la chaîne brute dans `fw` et retourne true si succès.
-  bool readInfo(String& fw);
-
-  // Lit la pente de la sonde pH ("Slope,?" command) — feature-024.
-  // Réponse Atlas : "?Slope,<acid>,<base>[,<zero>]" — tolérante 2 ou 3 floats.
-  // Si seulement 2 floats parsés (firmware EZO ancien) → out.zeroOffsetMv = NaN.
-  // Prend le mutex I²C en interne pour toute la séquence (cmd + delay + read).
-  // Retourne true si parsing OK (au moins acide+base), false sinon (out inchangé).
-  bool querySlope(PhSlopeInfo& out);
+  // Transaction OnDemand. Chaîne brute tronquée dans `buf` (toujours
+  // terminée) ; retourne true si succès.
+  bool identify(char* buf, size_t len) override;
 
   // Accesseurs simples
   uint8_t address() const { return _address; }
-  const char* name() const { return _name; }
+  I2cDevice device() const override { return _device; }
+  const char* name() const override { return _name; }
 
 private:
+  struct CommandCtx;
+
   uint8_t _address;
+  I2cDevice _device;
   const char* _name;
 
-  // Helpers internes (mutex I²C doit être pris par l'appelant).
-  bool _sendCmdLocked(const char* cmd);
-  int  _readResponseLocked(char* buf, size_t bufLen, uint32_t delayMs);
+  // Commande de haut niveau : cmd, attente kEzoCalDelayMs, relève dans `buf`.
+  // Retourne comme readResponse(), -1 aussi si le bus est resté indisponible.
+  int _command(const char* cmd, char* buf, size_t bufLen, I2cPriority prio, const char* what);
+  static uint32_t _commandStep(I2cTxn& txn);
 };
 
 #endif  // ATLAS_EZO_H
@@ -1,8 +1,10 @@
 #include "config.h"
 #include "constants.h"
 #include "logger.h"
+#include "mqtt_topics.h"
 #include <Preferences.h>
 #include <time.h>
+#include <atomic>
 
 // Définition des variables globales
 MqttConfig mqttCfg;
@@ -19,13 +21,22 @@ BoostState boostState;
 
 // Mutex pour protection concurrence
 SemaphoreHandle_t configMutex = nullptr;
-SemaphoreHandle_t i2cMutex = nullptr;
+
+// Part de 1 : une génération 0 désigne un slot de cache jamais rempli.
+static std::atomic<uint32_t> sConfigGeneration{1};
+
+void bumpConfigGeneration() {
+  sConfigGeneration.fetch_add(1, std::memory_order_release);
+}
+
+uint32_t getConfigGeneration() {
+  return sConfigGeneration.load(std::memory_order_acquire);
+}
 
 void initConfigMutexes() {
   configMutex = xSemaphoreCreateRecursiveMutex();  // Récursif : saveConfig() peut être appelé dans une section déjà sous mutex
-  i2cMutex = xSemaphoreCreateMutex();
 
-  if (configMutex == nullptr || i2cMutex == nullptr) {
+  if (configMutex == nullptr) {
     systemLogger.critical("Échec création mutex!");
   } else {
     systemLogger.info("Mutex de concurrence initialisés");
@@ -95,6 +106,9 @@ void sanitizePumpSelection() {
 }
 
 void saveMqttConfig() {
+  // Invalide le cache de représentation avant la prise du mutex : même en cas de
+  // timeout (persistance perdue), la config RAM a changé et doit être re-servie.
+  bumpConfigGeneration();
   // feature-027 : prise bornée (miroir de saveDailyCounters). Timeout → config RAM
   // appliquée mais persistance NVS perdue — signalé en error (throttlé 1/min).
   if (configMutex && xSemaphoreTakeRecursive(configMutex, pdMS_TO_TICKS(kConfigMutexTimeoutMs)) != pdTRUE) {
@@ -120,6 +134,9 @@ void saveMqttConfig() {
   prefs.putString("mqtt_user", mqttCfg.username);
   prefs.putString("mqtt_pass", mqttCfg.password);
   prefs.putBool("mqtt_enabled", mqttCfg.enabled);
+  prefs.putBool("mqtt_json", mqttCfg.stateJson);
+  prefs.putBool("mqtt_tls", mqttCfg.tls);
+  prefs.putString("mqtt_tls_pin", mqttCfg.tlsFingerprint);
 
   // Régulation pH
   prefs.putFloat("ph_target", mqttCfg.phTarget);
@@ -208,9 +225,21 @@ void loadMqttConfig() {
   mqttCfg.server = prefs.getString("mqtt_server", mqttCfg.server);
   mqttCfg.port = prefs.getInt("mqtt_port", mqttCfg.port);
   mqttCfg.topic = prefs.getString("mqtt_topic", mqttCfg.topic);
+  // Base héritée d'un firmware sans borne : tronquée ici, visiblement (log +
+  // formulaire), plutôt qu'une autre base silencieusement à l'exécution.
+  const char* topicStart = nullptr;
+  const size_t topicLen = mqttTopicNormalizeBase(mqttCfg.topic.c_str(), &topicStart);
+  if (topicLen > kMqttMaxBaseLen) {
+    mqttCfg.topic = String(topicStart).substring(0, kMqttMaxBaseLen);
+    systemLogger.warning("MQTT: topic de base > " + String(kMqttMaxBaseLen) +
+                         " caractères — tronqué en '" + mqttCfg.topic + "'");
+  }
   mqttCfg.username = prefs.getString("mqtt_user", "");
   mqttCfg.password = prefs.getString("mqtt_pass", "");
   mqttCfg.enabled = prefs.getBool("mqtt_enabled", mqttCfg.enabled);
+  mqttCfg.stateJson = prefs.getBool("mqtt_json", mqttCfg.stateJson);
+  mqttCfg.tls = prefs.getBool("mqtt_tls", mqttCfg.tls);
+  mqttCfg.tlsFingerprint = prefs.getString("mqtt_tls_pin", "");
 
   // Régulation pH
   mqttCfg.phTarget = prefs.getFloat("ph_target", mqttCfg.phTarget);
@@ -32,6 +32,14 @@ struct MqttConfig {
   String username = "";
   String password = "";
   bool enabled = false;
+  // Publie tout l'état sur un seul topic JSON {base}/state (entités HA via
+  // value_template) au lieu d'un topic retain par valeur. Voir mqtt_state_doc.h.
+  bool stateJson = false;
+  // Connexion chiffrée (TLS, port usuel 8883) via MqttTlsClient, avec reprise
+  // de session. tlsFingerprint : SHA-256 du certificat du broker
+  // ("AA:BB:…", mqtt_tls_logic.h) ; vide = chiffrement sans épinglage.
+  bool tls = false;
+  String tlsFingerprint = "";
   float phTarget = 7.2f;
   float orpTarget = 650.0f;
   bool phEnabled = false;
@@ -61,8 +69,8 @@ struct MqttConfig {
   String timezoneId = "europe_paris";
 
   // feature-021 (Pass 4a) : calibration pH/ORP entièrement déléguée aux modules
-  // Atlas EZO (commande Cal,? + cache _phCalCachedPoints / _orpCalCachedPoints
-  // dans SensorManager). Aucun champ de calibration pH/ORP n'est plus persisté
+  // Atlas EZO (commande Cal,? + cache des voies pH / ORP
+  // de SensorManager). Aucun champ de calibration pH/ORP n'est plus persisté
   // en NVS côté ESP32. Les anciens champs phCalibrationDate/Temp,
   // orpCalibrationOffset/Slope/Date/Reference/Temp ont été supprimés.
 
@@ -218,8 +226,14 @@ void tickBoostExpiry(time_t now);
 // ==== Mutex pour protection concurrence ====
 // Protège l'accès aux configurations partagées entre loop() et handlers async
 extern SemaphoreHandle_t configMutex;
-// Protège l'accès au bus I2C partagé entre sensors.update() et calibrations
-extern SemaphoreHandle_t i2cMutex;
+// Bus I2C / 1-Wire : plus de mutex, propriété de i2cTask (i2c_bus.h, ADR-0028).
+
+// ==== Génération de configuration ====
+// Compteur monotone incrémenté à chaque mutation de la config exposée aux clients
+// (saveMqttConfig, requestConfigBroadcast, éclairage manuel, planning auto,
+// événements WiFi). config_cache l'utilise pour invalider ses sérialisations.
+void bumpConfigGeneration();
+uint32_t getConfigGeneration();
 
 // ==== Fonctions de gestion ====
 void initConfigMutexes();  // Initialise les mutex (à appeler dans setup())
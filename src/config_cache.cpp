@@ -0,0 +1,298 @@
+#include "config_cache.h"
+#include <WiFi.h>
+#include <time.h>
+#include "config.h"
+#include "constants.h"
+#include "logger.h"
+#include "sensors.h"
+#include "filtration.h"
+#include "mqtt_manager.h"
+#include "web_helpers.h"
+#include "json_compat.h"
+
+ConfigCache configCache;
+
+namespace {
+
+// FNV-1a 32 bits : suffisant pour un validateur HTTP (pas d'usage cryptographique).
+uint32_t fnv1a(const char* data, size_t len, uint32_t h = 2166136261u) {
+  for (size_t i = 0; i < len; ++i) {
+    h ^= static_cast<uint8_t>(data[i]);
+    h *= 16777619u;
+  }
+  return h;
+}
+
+// Sérialise `doc` dans `out` sans les accolades englobantes (fragment concaténable).
+void appendMembers(JsonDocument& doc, String& out) {
+  String tmp;
+  serializeJson(doc, tmp);
+  if (tmp.length() >= 2) {
+    out.concat(tmp.c_str() + 1, tmp.length() - 2);
+  }
+}
+
+void warnTimeout(unsigned long& lastWarnMs, const char* site) {
+  unsigned long nowMs = millis();
+  if (lastWarnMs == 0 || nowMs - lastWarnMs >= kMutexTimeoutWarnThrottleMs) {
+    systemLogger.warning(String("[ConfigCache] ") + site + ": timeout mutex");
+    lastWarnMs = nowMs;
+  }
+}
+
+}  // namespace
+
+void ConfigCache::begin() {
+  if (_mutex == nullptr) {
+    _mutex = xSemaphoreCreateMutex();
+  }
+}
+
+uint32_t ConfigCache::cachedGeneration(ConfigView view) const {
+  return _slots[static_cast<size_t>(view)].generation;
+}
+
+void ConfigCache::render(ConfigView view, bool authenticated, String& out, String* etag) {
+  uint32_t generation = 0;
+  out += '{';
+
+  static unsigned long sWarnCacheMs = 0;
+  if (_mutex && xSemaphoreTake(_mutex, pdMS_TO_TICKS(kConfigMutexTimeoutMs)) == pdTRUE) {
+    _refreshLocked(view);
+    const Slot& slot = _slots[static_cast<size_t>(view)];
+    generation = slot.generation;
+    out += slot.fragment;
+    xSemaphoreGive(_mutex);
+  } else {
+    // Cache indisponible : rendu direct, sans mémorisation (ETag forcé à changer).
+    warnTimeout(sWarnCacheMs, "render");
+    if (view == ConfigView::Web) _buildWebStable(out);
+    else                         _buildUartStable(out);
+  }
+
+  String vol;
+  vol.reserve(512);
+  if (view == ConfigView::Web) _buildWebVolatile(authenticated, vol);
+  else                         _buildUartVolatile(vol);
+  out += ',';
+  out += vol;
+
+  if (view == ConfigView::Web) {
+    // time_current hors du document volatil : seul son préfixe minute entre dans l'ETag.
+    String now = getCurrentTimeISO();
+    out += ",\"time_current\":\"";
+    out += now;
+    out += '"';
+    if (etag) {
+      uint32_t h = fnv1a(vol.c_str(), vol.length());
+      h = fnv1a(now.c_str(), now.length() > 16 ? 16 : now.length(), h);  // "YYYY-MM-DDTHH:MM"
+      char buf[32];
+      snprintf(buf, sizeof(buf), "W/\"%lx-%08lx\"", (unsigned long)generation, (unsigned long)h);
+      *etag = buf;
+    }
+  }
+  out += '}';
+}
+
+void ConfigCache::_refreshLocked(ConfigView view) {
+  Slot& slot = _slots[static_cast<size_t>(view)];
+  // Génération lue AVANT la construction : une mutation concurrente la fait
+  // avancer et le prochain rendu reconstruit — jamais de fragment périmé marqué frais.
+  uint32_t gen = getConfigGeneration();
+  if (slot.generation == gen && slot.fragment.length() > 0) return;
+
+  static unsigned long sWarnConfigMs = 0;
+  bool locked = configMutex &&
+                xSemaphoreTakeRecursive(configMutex, pdMS_TO_TICKS(kConfigMutexTimeoutMs)) == pdTRUE;
+  if (!locked && slot.fragment.length() > 0) {
+    // Config en cours d'écriture : on ressert le fragment précédent, la
+    // génération inchangée du slot provoquera un nouvel essai au prochain rendu.
+    warnTimeout(sWarnConfigMs, "refresh");
+    return;
+  }
+
+  String fragment;
+  fragment.reserve(view == ConfigView::Web ? 1600 : 768);
+  if (view == ConfigView::Web) _buildWebStable(fragment);
+  else                         _buildUartStable(fragment);
+  if (locked) xSemaphoreGiveRecursive(configMutex);
+
+  slot.fragment = std::move(fragment);
+  slot.generation = locked ? gen : 0;  // Construit sans mutex → à reconstruire
+}
+
+void ConfigCache::_buildWebStable(String& out) const {
+  // Document heap : l'appel peut venir de la tâche AsyncTCP (~8 KB stack).
+  JsonDocument doc;
+  doc["server"] = mqttCfg.server;
+  doc["port"] = mqttCfg.port;
+  doc["topic"] = mqttCfg.topic;
+  doc["username"] = mqttCfg.username;
+  // SÉCURITÉ: Ne jamais envoyer les mots de passe en clair (même si authentifié)
+  doc["password"] = mqttCfg.password.length() > 0 ? "******" : "";
+  doc["enabled"] = mqttCfg.enabled;
+  doc["state_json"] = mqttCfg.stateJson;
+  doc["tls"] = mqttCfg.tls;
+  doc["tls_fingerprint"] = mqttCfg.tlsFingerprint;  // empreinte publique, pas un secret
+  doc["ph_target"] = roundf(mqttCfg.phTarget * 100.0f) / 100.0f;
+  doc["orp_target"] = roundf(mqttCfg.orpTarget);
+  doc["ph_enabled"] = mqttCfg.phEnabled;
+  doc["ph_regulation_mode"] = mqttCfg.phRegulationMode;
+  doc["ph_daily_target_ml"] = mqttCfg.phDailyTargetMl;
+  doc["ph_pump"] = mqttCfg.phPump;
+  doc["orp_enabled"] = mqttCfg.orpEnabled;  // miroir : true si orpRegulationMode != manual
+  doc["orp_regulation_mode"] = mqttCfg.orpRegulationMode;
+  doc["orp_daily_target_ml"] = mqttCfg.orpDailyTargetMl;
+  doc["max_orp_ml_per_day"] = safetyLimits.maxChlorineMlPerDay;
+  doc["orp_pump"] = mqttCfg.orpPump;
+  doc["pump1_max_duty_pct"] = mqttCfg.pump1MaxDutyPct;
+  doc["pump2_max_duty_pct"] = mqttCfg.pump2MaxDutyPct;
+  doc["pump_max_flow_ml_per_min"] = mqttCfg.pumpMaxFlowMlPerMin;
+  doc["ph_limit_minutes"] = mqttCfg.phInjectionLimitMinutes;
+  doc["orp_limit_minutes"] = mqttCfg.orpInjectionLimitMinutes;
+  doc["install_mode"] = installModeToString(mqttCfg.installMode);  // feature-056
+  doc["stabilization_delay_min"] = mqttCfg.stabilizationDelayMin;
+  doc["regulation_speed"] = mqttCfg.regulationSpeed;
+  doc["ph_correction_type"] = mqttCfg.phCorrectionType;
+  doc["time_use_ntp"] = mqttCfg.timeUseNtp;
+  doc["ntp_server"] = mqttCfg.ntpServer;
+  doc["manual_time"] = mqttCfg.manualTimeIso;
+  doc["timezone_id"] = mqttCfg.timezoneId;
+  doc["filtration_mode"] = filtrationCfg.mode;  // feature-056 : filtration_enabled → install_mode
+  doc["filtration_start"] = filtrationCfg.start;
+  doc["filtration_end"] = filtrationCfg.end;
+  doc["lighting_feature_enabled"] = lightingCfg.featureEnabled;
+  doc["lighting_enabled"] = lightingCfg.enabled;
+  doc["lighting_brightness"] = lightingCfg.brightness;
+  doc["lighting_schedule_enabled"] = lightingCfg.scheduleEnabled;
+  doc["lighting_start_time"] = lightingCfg.startTime;
+  doc["lighting_end_time"] = lightingCfg.endTime;
+
+  // WiFi : invalidé par les événements GOT_IP / LOST_IP / AP_START / AP_STOP (main.cpp).
+  doc["wifi_ssid"] = WiFi.SSID();
+  wifi_mode_t mode = WiFi.getMode();
+  String ipAddress;
+  if (mode == WIFI_MODE_AP) {
+    // En mode AP uniquement, afficher l'IP de l'AP
+    ipAddress = WiFi.softAPIP().toString();
+  } else if (mode == WIFI_MODE_APSTA) {
+    // En mode AP+STA, afficher l'IP STA si connecté, sinon l'IP AP
+    ipAddress = WiFi.isConnected() ? WiFi.localIP().toString() : WiFi.softAPIP().toString();
+  } else {
+    ipAddress = WiFi.localIP().toString();
+  }
+  doc["wifi_ip"] = ipAddress;
+  doc["wifi_mode"] = mode == WIFI_MODE_AP ? "AP" : (mode == WIFI_MODE_APSTA ? "AP+STA" : "STA");
+  doc["mdns_host"] = kMdnsFullHost;
+
+  doc["max_ph_ml_per_day"] = safetyLimits.maxPhMlPerDay;
+  doc["max_chlorine_ml_per_day"] = safetyLimits.maxChlorineMlPerDay;
+
+  // Données de calibration Température (offset utilisateur DS18B20)
+  doc["temp_calibration_offset"] = mqttCfg.tempCalibrationOffset;
+  doc["temp_calibration_date"] = mqttCfg.tempCalibrationDate;
+  doc["temperature_enabled"] = mqttCfg.temperatureEnabled;
+
+  doc["auth_enabled"] = authCfg.enabled;
+  doc["sensor_logs_enabled"] = authCfg.sensorLogsEnabled;
+  doc["debug_logs_enabled"] = authCfg.debugLogsEnabled;
+  doc["screen_enabled"] = authCfg.screenEnabled;
+
+  appendMembers(doc, out);
+}
+
+void ConfigCache::_buildWebVolatile(bool authenticated, String& out) const {
+  StaticJson<768> doc;
+  doc["mqtt_connected"] = mqttManager.isConnected();
+  doc["filtration_running"] = filtration.isRunning();
+
+  // feature-021 : statut calibration EZO depuis le cache Cal,? (lecture sans I²C).
+  int phPoints = sensors.getPhCalibrationPointsCached();
+  int orpPoints = sensors.getOrpCalibrationPointsCached();
+  doc["ph_cal_valid"] = phPoints >= 1;
+  doc["ph_cal_points"] = phPoints;
+  doc["orp_cal_valid"] = orpPoints >= 1;
+  doc["orp_cal_points"] = orpPoints;
+
+  // SÉCURITÉ: Masquer les credentials si non authentifié
+  if (authenticated) {
+    doc["auth_password"] = authCfg.adminPassword.length() > 0 ? "******" : "";
+    doc["auth_token"] = authCfg.apiToken.length() > 8 ? (authCfg.apiToken.substring(0, 8) + "...") : "";
+  } else {
+    // Ne pas révéler si des credentials sont configurés
+    doc["auth_password"] = "******";
+    doc["auth_token"] = "********...";
+  }
+
+  // Suivi volumes produits (totaux incrémentés pendant l'injection)
+  float phRemaining = max(0.0f, productCfg.phContainerVolumeMl - productCfg.phTotalInjectedMl);
+  float orpRemaining = max(0.0f, productCfg.orpContainerVolumeMl - productCfg.orpTotalInjectedMl);
+  doc["ph_tracking_enabled"] = productCfg.phTrackingEnabled;
+  doc["ph_container_ml"] = productCfg.phContainerVolumeMl;
+  doc["ph_total_injected_ml"] = productCfg.phTotalInjectedMl;
+  doc["ph_remaining_ml"] = phRemaining;
+  doc["ph_alert_threshold_ml"] = productCfg.phAlertThresholdMl;
+  doc["orp_tracking_enabled"] = productCfg.orpTrackingEnabled;
+  doc["orp_container_ml"] = productCfg.orpContainerVolumeMl;
+  doc["orp_total_injected_ml"] = productCfg.orpTotalInjectedMl;
+  doc["orp_remaining_ml"] = orpRemaining;
+  doc["orp_alert_threshold_ml"] = productCfg.orpAlertThresholdMl;
+
+  // feature-053 : Mode Boost (état effectif + epoch d'expiration, 0 si inactif).
+  doc["boost_active"] = isBoostActive(time(nullptr));
+  doc["boost_until"] = (long)boostState.untilEpoch;
+
+  appendMembers(doc, out);
+}
+
+void ConfigCache::_buildUartStable(String& out) const {
+  JsonDocument doc;
+  // Régulation
+  doc["ph_target"] = mqttCfg.phTarget;
+  doc["orp_target"] = mqttCfg.orpTarget;
+  doc["ph_enabled"] = mqttCfg.phEnabled;
+  doc["orp_enabled"] = mqttCfg.orpEnabled;
+  doc["ph_pump"] = mqttCfg.phPump;
+  doc["orp_pump"] = mqttCfg.orpPump;
+  doc["install_mode"] = installModeToString(mqttCfg.installMode);  // feature-056
+  doc["ph_correction_type"] = mqttCfg.phCorrectionType;
+  doc["ph_injection_limit_min"] = mqttCfg.phInjectionLimitMinutes;
+  doc["orp_injection_limit_min"] = mqttCfg.orpInjectionLimitMinutes;
+
+  // Filtration (feature-056 : filtration_enabled → install_mode)
+  doc["filtration_mode"] = filtrationCfg.mode;
+  doc["filtration_start"] = filtrationCfg.start;
+  doc["filtration_end"] = filtrationCfg.end;
+
+  // Éclairage
+  doc["lighting_feature_enabled"] = lightingCfg.featureEnabled;
+  doc["lighting_enabled"] = lightingCfg.enabled;
+  doc["lighting_brightness"] = lightingCfg.brightness;
+  doc["lighting_schedule_enabled"] = lightingCfg.scheduleEnabled;
+  doc["lighting_start_time"] = lightingCfg.startTime;
+  doc["lighting_end_time"] = lightingCfg.endTime;
+
+  // Limites de sécurité
+  doc["max_ph_ml_per_day"] = safetyLimits.maxPhMlPerDay;
+  doc["max_chlorine_ml_per_day"] = safetyLimits.maxChlorineMlPerDay;
+
+  // Temps / NTP
+  doc["time_use_ntp"] = mqttCfg.timeUseNtp;
+  doc["ntp_server"] = mqttCfg.ntpServer;
+  doc["timezone_id"] = mqttCfg.timezoneId;
+
+  // Température DS18B20 (offset utilisateur, conservé)
+  doc["temp_calibration_date"] = mqttCfg.tempCalibrationDate;
+  doc["temp_calibration_offset"] = mqttCfg.tempCalibrationOffset;
+  doc["temperature_enabled"] = mqttCfg.temperatureEnabled;
+
+  appendMembers(doc, out);
+}
+
+void ConfigCache::_buildUartVolatile(String& out) const {
+  StaticJson<96> doc;
+  // pH/ORP : nb de points de calibration mémorisés en cache (-1 si EZO injoignable)
+  doc["ph_cal_points"] = sensors.getPhCalibrationPointsCached();
+  doc["orp_cal_points"] = sensors.getOrpCalibrationPointsCached();
+  appendMembers(doc, out);
+}
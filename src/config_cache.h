@@ -0,0 +1,54 @@
+#ifndef CONFIG_CACHE_H
+#define CONFIG_CACHE_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// Cache versionné de la représentation JSON de la configuration.
+//
+// Les champs "stables" (config NVS, WiFi) ne changent que sur mutation : ils sont
+// sérialisés une seule fois par génération (getConfigGeneration(), config.h) et le
+// fragment est réutilisé par /get-config, le message WS "config" et get_config UART.
+// Les champs volatils (état runtime, heure, boost, volumes produits, cache Cal,?,
+// masquage auth) sont recalculés à chaque rendu — quelques dizaines d'octets.
+enum class ConfigView : uint8_t {
+  Web = 0,  // /get-config + WS {"type":"config"} (même objet, même ordre de champs)
+  Uart,     // get_config UART : jeu de champs réduit de l'écran
+  Count
+};
+
+class ConfigCache {
+public:
+  void begin();  // Crée le mutex du cache (à appeler dans setup(), après initConfigMutexes)
+
+  // Ajoute à `out` l'objet JSON complet "{...}" de la vue. `authenticated` ne
+  // concerne que la vue Web (masquage auth_password/auth_token).
+  // Si `etag` est fourni, y écrit un validateur faible W/"<gen>-<hash>" : le hash
+  // couvre les champs volatils avec time_current tronqué à la minute (résolution
+  // affichée par l'UI), donc deux requêtes dans la même minute sans changement
+  // d'état produisent le même ETag.
+  void render(ConfigView view, bool authenticated, String& out, String* etag = nullptr);
+
+  // Génération du fragment actuellement en cache pour la vue (0 = jamais construit).
+  uint32_t cachedGeneration(ConfigView view) const;
+
+private:
+  struct Slot {
+    uint32_t generation = 0;
+    String fragment;  // Membres JSON sans accolades : "\"server\":\"...\",..."
+  };
+
+  Slot _slots[static_cast<size_t>(ConfigView::Count)];
+  SemaphoreHandle_t _mutex = nullptr;
+
+  void _refreshLocked(ConfigView view);
+  void _buildWebStable(String& out) const;
+  void _buildUartStable(String& out) const;
+  void _buildWebVolatile(bool authenticated, String& out) const;
+  void _buildUartVolatile(String& out) const;
+};
+
+extern ConfigCache configCache;
+
+#endif // CONFIG_CACHE_H
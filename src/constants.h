@@ -42,24 +42,38 @@ constexpr unsigned long kOtaYieldDelayMs = 1;             // Délai yield() pend
 constexpr unsigned long kWatchdogTimeoutSec = 30;         // Timeout watchdog en secondes
 
 // Intervalles de mise à jour
-constexpr unsigned long kMqttPublishIntervalMs = 10000;   // 10s - Publication état MQTT
+constexpr unsigned long kMqttPublishIntervalMs = 2000;    // 2s - Échantillonnage états MQTT (cadence par métrique : mqtt_cadence.h)
 constexpr unsigned long kHealthCheckIntervalMs = 60000;   // 60s - Vérification santé système
 constexpr unsigned long kDiagnosticPublishIntervalMs = 300000; // 5min - Publication diagnostic MQTT
 
 // Tâche dédiée MQTT (cf. ADR-0011) — isole les blocages réseau (TCP retransmits, DNS lwip)
 // de la régulation pH/ORP et de la filtration. Voir docs/subsystems/mqtt-manager.md.
-constexpr uint32_t kMqttTaskStackSize       = 8192;       // 8 KB - publishDiscovery() sérialise 17 JSON consécutifs
+constexpr uint32_t kMqttTaskStackSize       = 12288;      // 12 KB - handshake TLS mbedTLS (ECDHE/RSA, ~4 KB) + logs String + snapshots ; configs discovery HA sérialisées hors pile (mqtt_discovery)
 constexpr uint32_t kMqttTaskPriority        = 2;          // Bas, > IDLE, < tiT (lwip) et async_tcp
 constexpr int      kMqttTaskCore            = 0;          // Core 0 (loopTask sur core 1) — répartit la charge réseau
-constexpr uint32_t kMqttOutQueueLength      = 32;         // File sortante (publish) — ~3s de débit nominal
-constexpr uint32_t kMqttInQueueLength       = 16;         // File entrante (commandes HA)
-constexpr uint32_t kMqttTaskLoopTimeoutMs   = 100;        // Timeout xQueueReceive dans mqttTask (cadence mqtt.loop())
+// kMqttOutQueueLength / kMqttInQueueLength / kMqttTaskLoopTimeoutMs : mqtt_pipeline.h (partagés avec le banc natif)
 constexpr uint32_t kMqttOfflineFlushMs      = 1000;       // Timeout flush "status=offline" avant ESP.restart() (OTA)
 constexpr uint32_t kMqttClientConnectTimeoutSec = 2;      // WiFiClient::setTimeout attend des SECONDES (Arduino-ESP32 6.9.0 — WiFiClient.cpp:327, _timeout = seconds*1000). 2 s borne SO_SNDTIMEO/SO_RCVTIMEO sur le client TCP de PubSubClient.
+constexpr uint16_t kMqttBufferSize          = 1152;       // Tampon PubSubClient (en-tête + topic + payload) — diagnostic JSON ~950 c, discovery HA ~750 c
+constexpr uint16_t kMqttStateDocBufferSize  = 2304;       // Idem en mode document d'état : kMqttStateDocMax (2048, mqtt_state_doc.h) + en-tête/topic
+constexpr uint32_t kHaBirthGraceMs          = 5000;       // Birth HA (homeassistant/status) ignoré pendant 5 s après connexion (retain rejoué par le broker)
+constexpr uint32_t kMqttTlsHandshakeTimeoutMs = 10000;   // Handshake TLS complet (≈1-3 s à 240 MHz selon la clé du broker), < watchdog 30 s — wdt réarmé entre les étapes
 constexpr uint32_t kMqttSocketSendTimeoutMs = 500;        // SO_SNDTIMEO socket TCP — borne write() à 500 ms (PINGREQ ~100 ms suffit, publish massif borné). Voir feature-014 IT5 / ADR-0011.
 
+// Tâche propriétaire du bus capteurs (cf. ADR-0028) — I²C (EZO pH/ORP, DS3231) + 1-Wire (DS18B20).
+// Plus de mutex : toute trame passe par une transaction ordonnancée (i2c_bus / i2c_sched_logic).
+constexpr uint32_t kI2cTaskStackSize        = 5120;       // 5 KB - Wire + DallasTemperature + logs String des pilotes
+constexpr uint32_t kI2cTaskPriority         = 2;          // > loopTask (1) : une transaction due passe dès que loopTask attend
+constexpr int      kI2cTaskCore             = 1;          // Core 1, comme les accès capteurs historiques de loopTask
+constexpr uint32_t kI2cSubmitQueueLength    = 8;          // File de soumission (pointeurs I2cTxn) = capacité de l'ordonnanceur
+constexpr uint32_t kI2cTaskIdleMaxMs        = 1000;       // Réveil max de la tâche sans événement
+constexpr uint32_t kI2cTxnTimeoutMs         = 2000;       // 2s - Échéance de démarrage : commandes EZO, RTC (ex-timeout mutex I2C)
+constexpr uint32_t kDs18b20TxnTimeoutMs     = 50;         // Échéance lecture/requête DS18B20 (retentée au tour suivant)
+constexpr uint32_t kEzoPeriodicSpacingMs    = 1000;       // Espacement min. de deux cycles périodiques EZO (relance après expiration)
+constexpr uint32_t kOneWirePeriodicSpacingMs = 250;       // Espacement min. de deux transactions périodiques DS18B20
+
 // Intervalles capteurs (voir aussi sensors.cpp pour détails internes)
-constexpr unsigned long kTempSensorIntervalMs = 2000;     // 2s - Lecture température DS18B20
+constexpr unsigned long kTempSensorIntervalMs = 2000;     // 2s - Lecture température DS18B20 (sonde eau)
 constexpr unsigned long kPhOrpSensorIntervalMs = 5000;    // 5s - Lecture pH/ORP
 
 // Délais de redémarrage
@@ -67,7 +81,6 @@ constexpr unsigned long kRestartAfterOtaDelayMs = 3000;   // 3s - Attente avant
 constexpr unsigned long kRestartApModeDelayMs = 1000;     // 1s - Attente avant restart en mode AP
 
 // Timeouts mutex
-constexpr unsigned long kI2cMutexTimeoutMs = 2000;        // 2s - Timeout acquisition mutex I2C
 constexpr unsigned long kConfigMutexTimeoutMs = 1000;     // 1s - Timeout acquisition mutex config
 // feature-027 : bornage des prises de mutex (plus aucun portMAX_DELAY applicatif)
 constexpr unsigned long kHistoryMutexTimeoutMs = 2000;    // 2s - Pire détenteur : consolidation + saveToFile LittleFS (~1-1,5 s)
@@ -126,6 +139,14 @@ constexpr unsigned long kAds1115ThreeSamplesMs = 375;     // Temps pour 3 échan
 constexpr size_t kMaxDs18b20Sondes = 2;                   // 2 sondes : eau piscine + circuit interne
 constexpr size_t kSondeAddrLen = 8;                       // Adresse ROM 1-Wire 64 bits
 
+// Acquisition par sonde (ds18b20_logic) : résolution et cadence selon le rôle.
+// Une sonde non identifiée est traitée comme la sonde eau (fallback de getTemperature()).
+constexpr uint8_t kDs18b20WaterResolutionBits = 12;       // 0,0625 °C - compensation pH, epsilon figé kTempFrozenEpsilonC
+constexpr uint8_t kDs18b20CircuitResolutionBits = 10;     // 0,25 °C - T° boîtier, conversion 188 ms
+constexpr unsigned long kDs18b20CircuitIntervalMs = 10000; // 10s - Sonde circuit (sonde eau : kTempSensorIntervalMs)
+constexpr uint32_t kDs18b20PollIntervalMs = 20;           // Scrutation du bit « conversion terminée »
+constexpr uint32_t kDs18b20ConvMarginMs = 50;             // Marge sur le maximum datasheet avant relève forcée
+
 // Clés NVS pour les adresses ROM des sondes (8 octets binaires, putBytes/getBytes)
 // Stockées dans le namespace "poolctrl" comme le reste de la config.
 constexpr const char* kNvsKeyOwWaterAddr = "ow_water_addr";    // Adresse sonde eau piscine
@@ -147,10 +168,17 @@ constexpr uint8_t  kEzoPhAddress              = 0x63;     // EZO pH I²C address
 constexpr uint8_t  kEzoOrpAddress             = 0x62;     // EZO ORP I²C address (default Atlas)
 constexpr uint32_t kEzoReadDelayMs            = 900;      // Délai après commande R (lecture)
 constexpr uint32_t kEzoCalDelayMs             = 900;      // Délai après commande Cal,*
-constexpr uint32_t kEzoRtDelayMs              = 600;      // Délai après commande RT,<temp>
+constexpr uint32_t kEzoTempCompDelayMs        = 300;      // Délai après commande T,<temp> (compensation pH)
 constexpr uint32_t kSensorStaleTimeoutMs      = 20000;    // 20 s : timeout lecture pH/ORP stale (pool-chemistry condition #1)
 constexpr int      kEzoBusFailMaxConsecutive  = 2;        // 2 échecs consécutifs I²C → blocage dosage (pool-chemistry condition #5)
 constexpr unsigned long kPhSlopeQueryIntervalMs = 86400000UL; // 24h - re-query Slope,? auto (feature-024 pente sonde pH)
+// Calibration non bloquante (ezo_cal_logic) : Cal émise dès que les dernières
+// lectures du cycle périodique tiennent dans la bande ; suivi continu, une
+// sonde posée depuis assez longtemps dans la solution n'attend pas.
+constexpr uint8_t  kEzoCalStableSamples       = 4;        // Lectures consécutives dans la bande (≈ 15 s à 5 s)
+constexpr float    kEzoCalStableBandPh        = 0.02f;    // Largeur de bande pH
+constexpr float    kEzoCalStableBandOrp       = 5.0f;     // Largeur de bande ORP (mV)
+constexpr uint32_t kEzoCalStabilityTimeoutMs  = 120000;   // Sans stabilité : échec "unstable" (forçage possible)
 
 // ============================================================================
 // SENSOR FILTER CONSTANTS - Lissage mesures pH/ORP (feature-025)
@@ -159,9 +187,30 @@ constexpr unsigned long kPhSlopeQueryIntervalMs = 86400000UL; // 24h - re-query
 // Centralisé ici pour ajustement terrain. Buffer FIXE (pas d'alloc dynamique).
 // Validation pool-chemistry feature-025 (conditions non négociables).
 
-constexpr uint8_t kSensorFilterMedianWindow      = 7;        // Taille buffer médian (impair, FIXE)
+constexpr uint8_t kSensorFilterMedianWindow      = 7;        // Fenêtre médiane par défaut (alias SensorFilter)
+// Capacité de la fenêtre médiane par capteur (paramètre de template de
+// WindowedSensorFilter, impair, < kSensorFilterResyncRejects vérifié à la compilation).
+constexpr uint8_t kPhFilterMedianWindow          = 7;        // Fenêtre médiane pH
+constexpr uint8_t kOrpFilterMedianWindow         = 7;        // Fenêtre médiane ORP
 constexpr float   kPhEmaAlpha                    = 0.10f;    // Coefficient EMA pH (lissage lent)
 constexpr float   kOrpEmaAlpha                   = 0.08f;    // Coefficient EMA ORP (lissage lent)
+// Étage final alternatif : Kalman niveau + tendance (sensor_estimator.h).
+// Réglage à indice de poursuite λ = σa·T²/σv ≈ 0,003 (T = 5 s) : bruit de sortie
+// équivalent à l'EMA ci-dessus, sans retard permanent sur une rampe. Désactivé
+// par défaut : basculer après comparaison sur traces réelles
+// (tools/trace_replay.sh --ph-estimator kalman).
+constexpr bool    kPhFilterUseKalman             = false;    // Étage final pH : false = EMA
+constexpr bool    kOrpFilterUseKalman            = false;    // Étage final ORP : false = EMA
+constexpr float   kPhKalmanMeasStd               = 0.01f;    // σv pH (bruit médiane EZO)
+constexpr float   kPhKalmanAccelStd              = 1.2e-6f;  // σa pH/s² (λ = σa·25/σv ≈ 0,003)
+constexpr float   kOrpKalmanMeasStd              = 1.0f;     // σv ORP (mV)
+constexpr float   kOrpKalmanAccelStd             = 1.2e-4f;  // σa mV/s² (même λ)
+constexpr float   kSensorKalmanDoseGain          = 10.0f;    // σa ×10 pendant la pause mélange (λ ≈ 0,03)
+// Projection de l'erreur par la tendance au DÉMARRAGE d'un dosage (étage
+// Kalman) : une mesure qui revient déjà vers la cible assez vite pour l'atteindre
+// dans l'horizon ne relance pas de dose. Unilatérale : n'augmente jamais l'erreur.
+constexpr float   kPhTrendHorizonMin             = 5.0f;     // Horizon de projection pH (min)
+constexpr float   kOrpTrendHorizonMin            = 5.0f;     // Horizon de projection ORP (min)
 constexpr float   kPhFilterMaxStep               = 0.15f;    // Saut max pH/lecture (rejet au-delà)
 constexpr float   kOrpFilterMaxStep              = 50.0f;    // Saut max ORP/lecture (mV, rejet au-delà)
 constexpr float   kPhFilterMin                   = 0.0f;     // Plage plausible pH min
@@ -174,7 +223,7 @@ constexpr uint8_t kSensorFilterMaxConsecutiveRejects = 10;   // Rejets consécut
 // figer le filtre indéfiniment. Au-delà de ce seuil de rejets consécutifs, on conclut
 // à un vrai changement et on ré-amorce le filtre sur la médiane des derniers bruts rejetés.
 // 12 cycles × 5 s/cycle ≈ 60 s. STRICTEMENT > kSensorFilterMaxConsecutiveRejects (10, seuil "instable")
-// ET > kSensorFilterMedianWindow (7) pour garantir un mini-buffer de rejets plein → médiane d'amorçage fiable.
+// ET > fenêtre médiane (7, static_assert dans WindowedSensorFilter) pour garantir un mini-buffer de rejets plein → médiane d'amorçage fiable.
 // Le dosage est de toute façon bloqué dès 10 rejets (unstable) puis pendant le re-warmup (ready=false).
 constexpr uint8_t  kSensorFilterResyncRejects     = 12;      // Rejets consécutifs → re-sync (≈60 s, feature-033)
 // Anti-boucle : un capteur qui re-sync en boucle = défaut EMI, pas un vrai changement.
@@ -220,6 +269,44 @@ constexpr float    kSensorFrozenEpsilonOrp = 0.05f;   // ½ LSB EZO ORP (résolu
 constexpr uint16_t kTempFrozenSamples  = 900;   // 900 lectures valides à 2 s = 30 min
 constexpr float    kTempFrozenEpsilonC = 0.03f; // < ½ LSB DS18B20 12 bits (0.0625/2)
 
+// ============================================================================
+// SENSOR HEALTH — Statistiques de bruit et score de santé pH/ORP
+// ============================================================================
+// Indicateurs glissants (sensor_health_logic.h), exponentiels à mémoire
+// ~kSensorHealthWindowSamples lectures (≈ 10 min à 5 s) : une sonde qui se
+// dégrade ou une source EMI se voit bien avant que unstable() ne latche.
+// Limites = valeur à laquelle l'indicateur coûte sa pondération pleine dans
+// le score (0-100). Bruit : écart-type estimé sur les différences successives
+// des lectures acceptées (insensible à une dérive lente du bassin).
+constexpr uint16_t kSensorHealthWindowSamples   = 120;     // Mémoire des moyennes exponentielles
+constexpr float    kSensorHealthNoiseLimitPh    = 0.02f;   // σ pH (≈ 20 LSB EZO)
+constexpr float    kSensorHealthNoiseLimitOrp   = 5.0f;    // σ ORP (mV)
+constexpr float    kSensorHealthSpikeRateLimit  = 0.10f;   // 10 % de lectures rejetées
+constexpr float    kSensorHealthFailRateLimit   = 0.10f;   // 10 % d'échecs I²C
+constexpr uint32_t kSensorHealthLatencyLimitMs  = 3000;    // p95 soumission → relève (nominal ≈ 1 s)
+
+// ============================================================================
+// SENSOR CHANNELS — Table des voies analogiques (sensor_channel.h)
+// ============================================================================
+// Capacité de la table fixée à la compilation (aucune allocation par voie).
+// pH + ORP aujourd'hui ; marge pour une voie EZO de plus (conductivité,
+// 2ᵉ bassin) — au-delà, i2c_sched_logic ne connaît pas d'autre EZO.
+constexpr size_t kSensorChannelCapacity = 4;
+
+// ============================================================================
+// SENSOR TRACE — Enregistreur de trace capteurs (relecture sur PC)
+// ============================================================================
+// Anneau fixe sur la partition history (64 Ko, partagée avec l'historique et
+// les logs persistants, budget quasi plein) : 16 o + 127 × 32 o = 4080 o, soit
+// UN bloc LittleFS de 4 Ko, ~10 min à 5 s/cycle. Fichier créé à l'armement,
+// supprimé par DELETE /sensor-trace. Captures plus longues : télécharger
+// plusieurs fois, l'outil fusionne par seq.
+constexpr uint16_t kSensorTraceCapacity       = 127;        // Slots de l'anneau (1 bloc)
+constexpr uint8_t  kSensorTraceFlushRecords   = 16;         // Attente RAM avant écriture (≈80 s)
+constexpr uint32_t kSensorTraceDefaultArmMs   = 3600000UL;  // 1 h si durée non précisée
+constexpr uint32_t kSensorTraceMaxArmMs       = 86400000UL; // 24 h max (usure flash bornée)
+constexpr unsigned long kSensorTraceMutexTimeoutMs = 100;   // Attente RAM + écriture d'un paquet 512 o
+
 // ============================================================================
 // FILTRATION CONSTANTS - Paramètres filtration
 // ============================================================================
@@ -138,6 +138,13 @@ bool shouldStartDosingPure(float error, float startThreshold,
   return error > startThreshold;
 }
 
+float projectErrorWithTrend(float error, float errorTrendPerMin, float horizonMin) {
+  if (isnan(errorTrendPerMin) || !(horizonMin > 0.0f) || errorTrendPerMin >= 0.0f) {
+    return error;
+  }
+  return error + errorTrendPerMin * horizonMin;
+}
+
 bool shouldContinueDosingPure(float error, float stopThreshold,
                               unsigned long runTimeMs, unsigned long minInjectionTimeMs) {
   // 1. Forcer le temps minimum d'injection.
@@ -141,6 +141,12 @@ DoseDecision evaluateDose(const DoseInputs& in);
 bool shouldStartDosingPure(float error, float startThreshold,
                            unsigned int cyclesToday, unsigned int maxCyclesPerDay);
 
+// Erreur projetée à horizonMin par la tendance de l'ERREUR (unités/min,
+// négative = l'erreur se résorbe), pour la décision de démarrage uniquement.
+// Unilatérale : une tendance qui aggrave l'erreur est ignorée (pas de dose
+// anticipée sur du bruit de pente). Tendance NaN (étage EMA) → erreur inchangée.
+float projectErrorWithTrend(float error, float errorTrendPerMin, float horizonMin);
+
 // Hystérésis de poursuite (extrait pur de shouldContinueDosing).
 // true si runTimeMs < minInjectionTimeMs (force poursuite — temps minimum
 // d'injection) OU error > stopThreshold.
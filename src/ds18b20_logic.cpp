@@ -0,0 +1,113 @@
+#include "ds18b20_logic.h"
+
+// =============================================================================
+// ds18b20_logic — implémentation PURE
+// =============================================================================
+
+namespace {
+
+uint8_t clampResolution(uint8_t bits) {
+  if (bits < kDs18b20MinResolution) return kDs18b20MinResolution;
+  if (bits > kDs18b20MaxResolution) return kDs18b20MaxResolution;
+  return bits;
+}
+
+}  // namespace
+
+uint16_t ds18b20ConversionMs(uint8_t resolutionBits) {
+  switch (clampResolution(resolutionBits)) {
+    case 9:  return 94;
+    case 10: return 188;
+    case 11: return 375;
+    case 12:
+    default: return 750;
+  }
+}
+
+// R1 R0 aux bits 6-5, bits 4-0 à 1, bit 7 à 0 (datasheet).
+uint8_t ds18b20ConfigByte(uint8_t resolutionBits) {
+  return (uint8_t)(((clampResolution(resolutionBits) - kDs18b20MinResolution) << 5) | 0x1F);
+}
+
+uint8_t ds18b20ResolutionFromConfig(uint8_t config) {
+  return (uint8_t)(kDs18b20MinResolution + ((config >> 5) & 0x03));
+}
+
+uint8_t ds18b20Crc8(const uint8_t* data, size_t len) {
+  uint8_t crc = 0;
+  for (size_t i = 0; i < len; ++i) {
+    uint8_t b = data[i];
+    for (uint8_t bit = 0; bit < 8; ++bit) {
+      const uint8_t mix = (crc ^ b) & 0x01;
+      crc >>= 1;
+      if (mix) crc ^= 0x8C;
+      b >>= 1;
+    }
+  }
+  return crc;
+}
+
+Ds18b20ReadStatus ds18b20DecodeScratchpad(const uint8_t sp[kDs18b20ScratchpadLen],
+                                          float* tempC, uint8_t* resolutionBits) {
+  bool allZero = true;
+  for (size_t i = 0; i < kDs18b20ScratchpadLen; ++i) {
+    if (sp[i] != 0) {
+      allZero = false;
+      break;
+    }
+  }
+  if (allZero) return Ds18b20ReadStatus::AllZero;
+  if (ds18b20Crc8(sp, kDs18b20ScratchpadLen - 1) != sp[kDs18b20ScratchpadLen - 1]) {
+    return Ds18b20ReadStatus::BadCrc;
+  }
+
+  const uint8_t bits = ds18b20ResolutionFromConfig(sp[4]);
+  if (resolutionBits) *resolutionBits = bits;
+
+  int16_t raw = (int16_t)(((uint16_t)sp[1] << 8) | sp[0]);
+  if (raw == 0x0550) return Ds18b20ReadStatus::PowerOnReset;  // 85,0 °C
+  // Sous 12 bits, les bits de poids faible ne sont pas définis.
+  raw = (int16_t)(raw & ~((1 << (kDs18b20MaxResolution - bits)) - 1));
+  if (tempC) *tempC = raw / 16.0f;
+  return Ds18b20ReadStatus::Ok;
+}
+
+uint32_t Ds18b20Conversion::start(uint32_t nowMs, uint8_t maxBits, bool canPoll) {
+  const uint32_t convMs = ds18b20ConversionMs(maxBits);
+  _issuedMs = nowMs;
+  _limitMs = convMs + _marginMs;
+  _canPoll = canPoll;
+  _timedOut = false;
+  if (!canPoll) return _limitMs;
+  // Une conversion réelle prend l'essentiel du maximum : pas de scrutation
+  // avant le quart, puis toutes les pollIntervalMs.
+  const uint32_t first = convMs / 4;
+  return first > _pollMs ? first : _pollMs;
+}
+
+uint32_t Ds18b20Conversion::onPoll(uint32_t nowMs, bool done) {
+  const uint32_t elapsed = nowMs - _issuedMs;
+  if (_canPoll && done) {
+    close(elapsed);
+    return 0;
+  }
+  if (elapsed >= _limitMs) {
+    // Sans scrutation l'échéance est la fin attendue ; avec, la sonde n'a
+    // jamais signalé la fin : relève quand même, le décodage tranche.
+    if (_canPoll) {
+      _timedOut = true;
+      _timeouts++;
+    }
+    close(elapsed);
+    return 0;
+  }
+  const uint32_t left = _limitMs - elapsed;
+  if (!_canPoll) return left;
+  return left < _pollMs ? left : _pollMs;
+}
+
+void Ds18b20Conversion::close(uint32_t elapsedMs) {
+  _count++;
+  _lastMs = elapsedMs;
+  if (elapsedMs > _maxMs) _maxMs = elapsedMs;
+}
@@ -0,0 +1,137 @@
+#ifndef DS18B20_LOGIC_H
+#define DS18B20_LOGIC_H
+
+// =============================================================================
+// ds18b20_logic — Acquisition DS18B20 par sonde, PURE
+// =============================================================================
+// Chaque sonde a sa résolution (registre de configuration, 9 à 12 bits) et sa
+// cadence : la sonde "eau", qui sert à la compensation pH, en 12 bits toutes
+// les 2 s ; la sonde "circuit" (boîtier) en 10 bits, plus rarement.
+//
+// Cycle (transaction 1-Wire de SensorManager, étapes dans i2cTask) :
+//
+//   Idle ──dueMask≠0──► Convert T (skip ROM si toutes dues, sinon match ROM)
+//        ──► scrutation du bit « conversion terminée » ──► lecture des
+//            scratchpads par adresse ROM mémorisée (jamais de recherche) ──► Idle
+//
+// La fin de conversion est détectée en lisant un time slot (la sonde répond 0
+// tant qu'elle convertit) au lieu d'attendre le maximum datasheet + marge. Sur
+// plusieurs sondes le bus est un ET câblé : 1 quand toutes ont fini. En
+// alimentation parasite la sonde ne peut pas répondre : attente fixe du
+// maximum, comme avant.
+//
+// Scratchpad : CRC Maxim vérifié, bits non définis de la résolution masqués,
+// 85 °C (valeur de mise sous tension) et scratchpad tout à zéro rejetés.
+// Le registre de configuration relu signale une sonde revenue à sa résolution
+// EEPROM (coupure d'alimentation) : la coquille la reprogramme.
+//
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <stddef.h>
+#include <stdint.h>
+
+constexpr uint8_t kDs18b20MinResolution = 9;
+constexpr uint8_t kDs18b20MaxResolution = 12;
+constexpr size_t kDs18b20ScratchpadLen = 9;
+constexpr uint8_t kDs18b20CmdConvertT = 0x44;
+
+// Temps de conversion maximal datasheet (ms) : 94 / 188 / 375 / 750.
+uint16_t ds18b20ConversionMs(uint8_t resolutionBits);
+
+// Registre de configuration (octet 4 du scratchpad) ↔ résolution.
+uint8_t ds18b20ConfigByte(uint8_t resolutionBits);
+uint8_t ds18b20ResolutionFromConfig(uint8_t config);
+
+// CRC-8 Maxim (polynôme 0x31 réfléchi), celui du ROM et du scratchpad.
+uint8_t ds18b20Crc8(const uint8_t* data, size_t len);
+
+enum class Ds18b20ReadStatus : uint8_t {
+  Ok,
+  BadCrc,     // Trame corrompue, ou sonde absente (bus tiré à 1)
+  AllZero,    // Bus court-circuité à la masse : CRC nul trompeusement valide
+  PowerOnReset,  // 85 °C : conversion non faite (sonde réinitialisée)
+};
+
+// Décode un scratchpad. *tempC n'est écrit que si Ok ; *resolutionBits (si
+// non nul) reçoit la résolution relue dès que le CRC est valide.
+Ds18b20ReadStatus ds18b20DecodeScratchpad(const uint8_t sp[kDs18b20ScratchpadLen],
+                                          float* tempC, uint8_t* resolutionBits);
+
+// Cadence par sonde (index = rang dans SensorManager::_sondes).
+template <uint8_t N>
+class Ds18b20Schedule {
+public:
+  void setInterval(uint8_t i, uint32_t ms) {
+    if (i < N) _intervalMs[i] = ms;
+  }
+
+  // Bit i levé si la sonde i (< count) n'a jamais été convertie ou si son
+  // intervalle est écoulé depuis la dernière demande.
+  uint8_t dueMask(uint32_t nowMs, uint8_t count) const {
+    uint8_t mask = 0;
+    for (uint8_t i = 0; i < count && i < N; ++i) {
+      if (!_seen[i] || nowMs - _lastMs[i] >= _intervalMs[i]) mask |= (uint8_t)(1u << i);
+    }
+    return mask;
+  }
+
+  void requested(uint8_t mask, uint32_t nowMs) {
+    for (uint8_t i = 0; i < N; ++i) {
+      if (!(mask & (1u << i))) continue;
+      _lastMs[i] = nowMs;
+      _seen[i] = true;
+    }
+  }
+
+  // Sonde à reconvertir au prochain tour (rôle ou résolution changés).
+  void forget(uint8_t i) {
+    if (i < N) _seen[i] = false;
+  }
+
+private:
+  uint32_t _intervalMs[N] = {};
+  uint32_t _lastMs[N] = {};
+  bool _seen[N] = {};
+};
+
+// Attente d'une conversion. Utilisée dans i2cTask : chaque étape de la
+// transaction lit le bit et rend l'attente jusqu'à la suivante.
+class Ds18b20Conversion {
+public:
+  Ds18b20Conversion(uint32_t pollIntervalMs, uint32_t marginMs)
+      : _pollMs(pollIntervalMs), _marginMs(marginMs) {}
+
+  // Convert T émis à nowMs ; maxBits = plus haute résolution convertie.
+  // Retourne l'attente avant la 1ʳᵉ scrutation (avant la relève si !canPoll).
+  uint32_t start(uint32_t nowMs, uint8_t maxBits, bool canPoll);
+
+  // Bit lu à nowMs (done = 1). Retourne l'attente avant la prochaine
+  // scrutation, 0 = relever les scratchpads maintenant (fin ou échéance).
+  uint32_t onPoll(uint32_t nowMs, bool done);
+
+  bool timedOut() const { return _timedOut; }
+
+  uint32_t conversionCount() const { return _count; }
+  uint32_t lastConversionMs() const { return _lastMs; }
+  uint32_t maxConversionMs() const { return _maxMs; }
+  uint32_t timeoutCount() const { return _timeouts; }
+
+private:
+  void close(uint32_t elapsedMs);
+
+  uint32_t _pollMs;
+  uint32_t _marginMs;
+
+  uint32_t _issuedMs = 0;
+  uint32_t _limitMs = 0;    // Maximum datasheet + marge
+  bool _canPoll = false;
+  bool _timedOut = false;
+
+  uint32_t _count = 0;
+  uint32_t _lastMs = 0;
+  uint32_t _maxMs = 0;
+  uint32_t _timeouts = 0;
+};
+
+#endif // DS18B20_LOGIC_H
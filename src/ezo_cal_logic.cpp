@@ -0,0 +1,131 @@
+#include "ezo_cal_logic.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// =============================================================================
+// ezo_cal_logic — implémentation PURE
+// =============================================================================
+
+const char* ezoCalStateName(EzoCalState s) {
+  switch (s) {
+    case EzoCalState::Stabilizing: return "stabilizing";
+    case EzoCalState::Running:     return "running";
+    case EzoCalState::Done:        return "done";
+    case EzoCalState::Failed:      return "failed";
+    case EzoCalState::Idle:
+    default:                       return "idle";
+  }
+}
+
+const char* ezoCalErrorName(EzoCalError e) {
+  switch (e) {
+    case EzoCalError::Unstable: return "unstable";
+    case EzoCalError::Bus:      return "bus";
+    case EzoCalError::Rejected: return "rejected";
+    case EzoCalError::None:
+    default:                    return nullptr;
+  }
+}
+
+int ezoParseCalPoints(const char* resp) {
+  if (resp == nullptr) return -1;
+  // Réponse Atlas : "?CAL,N" — on lit le chiffre après la dernière virgule.
+  const char* comma = strrchr(resp, ',');
+  if (comma == nullptr) return -1;
+  const char digit = comma[1];
+  if (digit < '0' || digit > '3') return -1;
+  return digit - '0';
+}
+
+bool ezoParseSlope(const char* resp, PhSlopeInfo& out) {
+  if (resp == nullptr) return false;
+  // Recherche de la 1ʳᵉ virgule (après "?Slope") puis parsing séquentiel.
+  const char* p = strchr(resp, ',');
+  if (p == nullptr) return false;
+  ++p;
+  char* endptr = nullptr;
+  const float acid = strtof(p, &endptr);
+  if (endptr == p || *endptr != ',') return false;
+  const char* p2 = endptr + 1;
+  const float base = strtof(p2, &endptr);
+  if (endptr == p2) return false;
+  // 2 floats valides au minimum (acide + base) ; 3ᵉ optionnel : zéro en mV.
+  float zero = NAN;
+  if (*endptr == ',') {
+    const char* p3 = endptr + 1;
+    const float z = strtof(p3, &endptr);
+    if (endptr != p3) zero = z;
+  }
+  out.acidPct = acid;
+  out.basePct = base;
+  out.zeroOffsetMv = zero;
+  return true;
+}
+
+void EzoStability::add(float value) {
+  _seq++;
+  if (isnan(value)) {  // Traité comme une lecture en échec
+    _run = 0;
+    return;
+  }
+  if (_run == 0) {
+    _min = _max = value;
+    _run = 1;
+    return;
+  }
+  const float lo = value < _min ? value : _min;
+  const float hi = value > _max ? value : _max;
+  if (hi - lo > _band) {
+    // Hors bande : la sonde bouge encore, nouveau run ancré ici.
+    _min = _max = value;
+    _run = 1;
+    return;
+  }
+  _min = lo;
+  _max = hi;
+  if (_run < 255) _run++;
+}
+
+void EzoCalFlow::start(bool waitStable, uint32_t nowMs) {
+  _state = EzoCalState::Stabilizing;
+  _error = EzoCalError::None;
+  _waitStable = waitStable;
+  _startMs = nowMs;
+  _durationMs = 0;
+  _waitedMs = 0;
+}
+
+EzoCalStep EzoCalFlow::poll(bool stable, uint32_t nowMs) {
+  if (_state != EzoCalState::Stabilizing) return EzoCalStep::None;
+  const uint32_t waited = nowMs - _startMs;
+  if (!_waitStable || stable) {
+    _waitedMs = _waitStable ? waited : 0;
+    _state = EzoCalState::Running;
+    return EzoCalStep::Issue;
+  }
+  if (waited >= _timeoutMs) {
+    _waitedMs = waited;
+    end(EzoCalState::Failed, EzoCalError::Unstable, nowMs);
+    return EzoCalStep::TimedOut;
+  }
+  return EzoCalStep::None;
+}
+
+void EzoCalFlow::finished(bool sent, bool ok, uint32_t nowMs) {
+  if (_state != EzoCalState::Running) return;
+  if (!sent) {
+    end(EzoCalState::Failed, EzoCalError::Bus, nowMs);
+  } else if (!ok) {
+    end(EzoCalState::Failed, EzoCalError::Rejected, nowMs);
+  } else {
+    end(EzoCalState::Done, EzoCalError::None, nowMs);
+  }
+}
+
+void EzoCalFlow::end(EzoCalState s, EzoCalError e, uint32_t nowMs) {
+  _state = s;
+  _error = e;
+  _durationMs = nowMs - _startMs;
+}
@@ -0,0 +1,134 @@
+#ifndef EZO_CAL_LOGIC_H
+#define EZO_CAL_LOGIC_H
+
+// =============================================================================
+// ezo_cal_logic — Déroulé d'une calibration EZO non bloquante, PURE
+// =============================================================================
+// Une calibration (Cal,mid / Cal,low / Cal,<mV> / Cal,clear) passe par :
+//
+//   Idle ──start()──► Stabilizing ──stable──► Running ──finished()──► Done
+//                        │                       └──(bus / refus)──► Failed
+//                        └──échéance sans stabilité──────────────► Failed
+//
+//   - Stabilizing : la coquille interroge poll() à chaque tour de loopTask
+//     avec le verdict de stabilité de la voie (EzoStability, alimentée par
+//     les lectures du cycle périodique). Sans attente (Cal,clear, forçage),
+//     poll() rend Issue au premier tour.
+//   - Running : la coquille a soumis la transaction Cal + Cal,? (i2cTask,
+//     Urgent) ; loopTask n'attend pas, elle reprend au bilan.
+//
+// EzoStability : run de lectures consécutives contenues dans une bande de
+// largeur `band` (min/max courants, ré-ancré sur la lecture qui en sort),
+// stable dès `samples` lectures. Alimentée en continu : une sonde déjà posée
+// dans la solution depuis assez longtemps se calibre dès la lecture suivant
+// la demande. La coquille exige cette lecture (seq() a bougé depuis start()) :
+// une sonde changée de bain juste avant le clic sort de la bande et relance
+// le run au lieu d'hériter de la stabilité de l'ancien bain.
+//
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <stdint.h>
+
+enum class EzoCalState : uint8_t {
+  Idle,
+  Stabilizing,  // Attente de lectures stables
+  Running,      // Cal émise (transaction en cours)
+  Done,
+  Failed,
+};
+
+enum class EzoCalError : uint8_t {
+  None,
+  Unstable,  // Lectures jamais stables avant l'échéance
+  Bus,       // Commande non émise (NACK, bus saturé)
+  Rejected,  // Module a répondu en erreur
+};
+
+enum class EzoCalStep : uint8_t {
+  None,      // Rien à faire à ce tour
+  Issue,     // Émettre la commande maintenant (état → Running)
+  TimedOut,  // Échéance de stabilisation (état → Failed / Unstable)
+};
+
+const char* ezoCalStateName(EzoCalState s);  // "idle", "stabilizing", …
+const char* ezoCalErrorName(EzoCalError e);  // nullptr si None
+
+// Réponse "?CAL,N" (Cal,?) → N (0-3), -1 si inattendue.
+int ezoParseCalPoints(const char* resp);
+
+// Informations de pente d'une sonde pH (feature-024).
+// Renvoyées par la commande Atlas "Slope,?" sur l'EZO pH.
+// Réponse type firmware EZO pH 2.x : "?Slope,99.7,100.3,-0.89"
+//  - acidPct      : pente côté acide (point pH 4) en % de la pente théorique Nernst
+//  - basePct      : pente côté base (point pH 10) en % de la pente théorique Nernst
+//  - zeroOffsetMv : décalage du point isopotentiel (pH 7) en mV ; NaN si firmware
+//                   EZO ancien ne le rapporte pas (réponse à 2 floats seulement)
+struct PhSlopeInfo {
+  float acidPct;
+  float basePct;
+  float zeroOffsetMv;
+};
+
+// Réponse "?Slope,<acid>,<base>[,<zero>]" (Slope,?) → `out`. Tolérante 2 ou
+// 3 floats (zéro à NaN si absent). false si moins de 2 floats (out inchangé).
+bool ezoParseSlope(const char* resp, PhSlopeInfo& out);
+
+class EzoStability {
+public:
+  EzoStability(uint8_t samples, float band) : _samples(samples), _band(band) {}
+
+  void add(float value);
+  void interrupt() {  // Lecture en échec : le run repart de zéro
+    _run = 0;
+    _seq++;
+  }
+
+  bool stable() const { return _samples > 0 && _run >= _samples; }
+  uint8_t run() const { return _run; }
+  uint32_t seq() const { return _seq; }  // +1 par add() / interrupt()
+  uint8_t required() const { return _samples; }
+  float spread() const { return _run ? _max - _min : 0.0f; }
+
+private:
+  uint8_t _samples;
+  float _band;
+  uint8_t _run = 0;
+  uint32_t _seq = 0;
+  float _min = 0.0f;
+  float _max = 0.0f;
+};
+
+class EzoCalFlow {
+public:
+  explicit EzoCalFlow(uint32_t stabilityTimeoutMs) : _timeoutMs(stabilityTimeoutMs) {}
+
+  // Nouvelle calibration (depuis Idle, Done ou Failed).
+  void start(bool waitStable, uint32_t nowMs);
+  // Stabilizing uniquement : Issue si stable (ou sans attente), TimedOut à
+  // l'échéance ; None sinon et dans tout autre état.
+  EzoCalStep poll(bool stable, uint32_t nowMs);
+  // Bilan de la transaction : sent = commande émise, ok = statut EZO 1.
+  void finished(bool sent, bool ok, uint32_t nowMs);
+
+  EzoCalState state() const { return _state; }
+  EzoCalError error() const { return _error; }
+  bool busy() const { return _state == EzoCalState::Stabilizing || _state == EzoCalState::Running; }
+  // Depuis start() ; figé à la fin.
+  uint32_t elapsedMs(uint32_t nowMs) const { return busy() ? nowMs - _startMs : _durationMs; }
+  // Attente de stabilité effectivement subie (0 sans attente).
+  uint32_t waitedMs() const { return _waitedMs; }
+
+private:
+  void end(EzoCalState s, EzoCalError e, uint32_t nowMs);
+
+  uint32_t _timeoutMs;
+  EzoCalState _state = EzoCalState::Idle;
+  EzoCalError _error = EzoCalError::None;
+  bool _waitStable = false;
+  uint32_t _startMs = 0;
+  uint32_t _durationMs = 0;
+  uint32_t _waitedMs = 0;
+};
+
+#endif // EZO_CAL_LOGIC_H
@@ -0,0 +1,38 @@
+#include "ezo_comp_logic.h"
+
+#include <math.h>
+#include <stdio.h>
+
+// =============================================================================
+// ezo_comp_logic — implémentation PURE
+// =============================================================================
+
+float ezoQuantizeTemp(float tempC) {
+  return roundf(tempC * 10.0f) / 10.0f;
+}
+
+size_t ezoFormatTempCmd(float tempC, char* buf, size_t cap) {
+  if (buf == nullptr || cap == 0) return 0;
+  const int n = snprintf(buf, cap, "T,%.1f", ezoQuantizeTemp(tempC));
+  if (n < 0 || static_cast<size_t>(n) >= cap) {
+    buf[0] = '\0';
+    return 0;
+  }
+  return static_cast<size_t>(n);
+}
+
+bool EzoTempCompPolicy::shouldPush(float tempC, uint32_t nowMs) const {
+  if (isnan(tempC)) return false;
+  if (!_valid) return true;
+  if (nowMs - _pushedAtMs >= kEzoTempCompRefreshMs) return true;
+  // Écarts multiples de 0,1 : comparaison à un demi-pas sous le seuil pour que
+  // 0,3 °C ne bascule pas selon l'arrondi flottant de la soustraction.
+  return fabsf(ezoQuantizeTemp(tempC) - _appliedC) > kEzoTempCompThresholdC - 0.05f;
+}
+
+void EzoTempCompPolicy::pushed(float tempC, uint32_t nowMs) {
+  _appliedC = ezoQuantizeTemp(tempC);
+  _pushedAtMs = nowMs;
+  _valid = true;
+  _pushes++;
+}
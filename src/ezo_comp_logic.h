@@ -0,0 +1,58 @@
+#ifndef EZO_COMP_LOGIC_H
+#define EZO_COMP_LOGIC_H
+
+// =============================================================================
+// ezo_comp_logic — Compensation T° persistante de l'EZO pH, PURE
+// =============================================================================
+// L'EZO pH garde la température de compensation réglée par `T,<t>` : chaque `R`
+// ultérieur est compensé avec cette valeur. Plutôt que de la renvoyer à chaque
+// lecture (`RT,<t>`), SensorManager ne la pousse que lorsqu'elle a bougé :
+//   - jamais poussée, ou invalidée (lecture en échec → reset EZO possible) ;
+//   - écart ≥ kEzoTempCompThresholdC avec la valeur en vigueur sur le module ;
+//   - rafraîchissement périodique (kEzoTempCompRefreshMs) : une coupure
+//     d'alimentation du seul module EZO, sans échec I²C observé, ramène T à sa
+//     valeur par défaut — borne la durée d'une compensation erronée.
+// Les températures sont quantifiées au 0,1 °C (format de la commande `T,%.1f`)
+// avant comparaison : pas de renvoi sur un bruit sous la résolution envoyée.
+//
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 0,3 °C < 0,001 pH d'erreur de compensation à pH 7,4 (Nernst) : sous la
+// résolution de l'EZO. La T° eau bouge de quelques centièmes par heure.
+constexpr float    kEzoTempCompThresholdC = 0.3f;
+constexpr uint32_t kEzoTempCompRefreshMs  = 900000UL;  // 15 min
+
+// Quantification au 0,1 °C (arrondi au plus proche, symétrique).
+float ezoQuantizeTemp(float tempC);
+
+// Écrit "T,<t>" (1 décimale) dans buf. Retourne la longueur, 0 si cap trop petit.
+size_t ezoFormatTempCmd(float tempC, char* buf, size_t cap);
+
+class EzoTempCompPolicy {
+public:
+  // true si `T,<t>` doit précéder la prochaine lecture. tempC NaN → false
+  // (l'appelant applique son fallback avant).
+  bool shouldPush(float tempC, uint32_t nowMs) const;
+
+  // `T,<t>` acquitté (statut 1) par le module.
+  void pushed(float tempC, uint32_t nowMs);
+
+  // Valeur sur le module inconnue (échec de lecture, reset présumé).
+  void invalidate() { _valid = false; }
+
+  bool valid() const { return _valid; }
+  float appliedTemp() const { return _appliedC; }
+  uint32_t pushCount() const { return _pushes; }
+
+private:
+  bool _valid = false;
+  float _appliedC = 0.0f;
+  uint32_t _pushedAtMs = 0;
+  uint32_t _pushes = 0;
+};
+
+#endif // EZO_COMP_LOGIC_H
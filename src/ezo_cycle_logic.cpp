@@ -0,0 +1,49 @@
+#include "ezo_cycle_logic.h"
+
+// =============================================================================
+// ezo_cycle_logic — implémentation PURE
+// =============================================================================
+
+EzoCycleStep EzoReadCycle::poll(uint32_t nowMs) const {
+  switch (_phase) {
+    case Phase::Temp:
+      return nowMs - _issuedMs >= _tempDelayMs ? EzoCycleStep::CollectTemp : EzoCycleStep::None;
+    case Phase::Converting:
+      return nowMs - _issuedMs >= _readDelayMs ? EzoCycleStep::Collect : EzoCycleStep::None;
+    case Phase::Idle:
+    default:
+      // 1er cycle dès le boot ; ensuite cadence mesurée de début à début.
+      if (!_everStarted || nowMs - _startMs >= _intervalMs) return EzoCycleStep::Start;
+      return EzoCycleStep::None;
+  }
+}
+
+void EzoReadCycle::beginIfIdle(uint32_t nowMs) {
+  if (_phase != Phase::Idle) return;
+  _startMs = nowMs;
+  _everStarted = true;
+  _holdUs = 0;
+}
+
+void EzoReadCycle::tempIssued(uint32_t nowMs) {
+  beginIfIdle(nowMs);
+  _phase = Phase::Temp;
+  _issuedMs = nowMs;
+}
+
+void EzoReadCycle::readsIssued(uint32_t nowMs) {
+  beginIfIdle(nowMs);
+  _phase = Phase::Converting;
+  _issuedMs = nowMs;
+}
+
+void EzoReadCycle::finished(uint32_t nowMs) {
+  beginIfIdle(nowMs);  // abandon dès Start : cycle de durée nulle, cadence préservée
+  const uint32_t ms = nowMs - _startMs;
+  _phase = Phase::Idle;
+  _cycles++;
+  _lastMs = ms;
+  _sumMs += ms;
+  if (ms > _maxMs) _maxMs = ms;
+  _lastHoldUs = _holdUs;
+}
@@ -0,0 +1,84 @@
+#ifndef EZO_CYCLE_LOGIC_H
+#define EZO_CYCLE_LOGIC_H
+
+// =============================================================================
+// ezo_cycle_logic — Cycle de lecture pH + ORP en parallèle, PURE
+// =============================================================================
+// Les deux EZO convertissent indépendamment : `R` est émis aux deux modules
+// l'un après l'autre, une seule attente de conversion, puis les deux réponses
+// sont relevées. La coquille (SensorManager) en fait une transaction du bus
+// (i2c_bus) : loopTask la soumet quand poll() rend Start, puis ses étapes,
+// exécutées dans i2cTask, interrogent poll() pour enchaîner. Le bus n'est
+// occupé que le temps des trames, pas pendant les 900 ms de conversion.
+//
+//   Idle ──Start──► [T,<t> émis] ──CollectTemp──► R émis ×2 ──Collect──► Idle
+//                  └───────────── (pas de T) ─────┘
+//
+// Échéances, mesurées depuis l'émission de la commande en attente :
+//   - CollectTemp : tempDelayMs (300 ms, T,<t> sur l'EZO pH) ;
+//   - Collect     : readDelayMs (900 ms, R).
+// Un cycle démarre toutes les intervalMs, comptées d'un début de cycle au
+// suivant (cadence inchangée par la durée du cycle).
+//
+// Aucune autre commande ne doit viser un EZO entre l'émission et la relève :
+// la transaction réserve les deux modules pendant tout le cycle.
+//
+// Statistiques : durée de cycle (début → relève, dernière / moyenne / max)
+// et occupation du bus cumulée par cycle, en µs.
+//
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <stdint.h>
+
+enum class EzoCycleStep : uint8_t {
+  None,         // Rien à faire à ce tour
+  Start,        // Cycle dû : émettre T (si besoin) ou R aux deux modules
+  CollectTemp,  // Relever l'acquittement de T, puis émettre R
+  Collect,      // Relever les deux conversions
+};
+
+class EzoReadCycle {
+public:
+  EzoReadCycle(uint32_t intervalMs, uint32_t tempDelayMs, uint32_t readDelayMs)
+      : _intervalMs(intervalMs), _tempDelayMs(tempDelayMs), _readDelayMs(readDelayMs) {}
+
+  EzoCycleStep poll(uint32_t nowMs) const;
+
+  // Transitions, appelées par la coquille après avoir agi sur le bus.
+  void tempIssued(uint32_t nowMs);    // Start → attente T
+  void readsIssued(uint32_t nowMs);   // Start / CollectTemp → attente conversion
+  void finished(uint32_t nowMs);      // Collect (ou abandon) → Idle
+  void addBusHoldUs(uint32_t us) { _holdUs += us; }
+
+  bool busy() const { return _phase != Phase::Idle; }
+
+  uint32_t cycleCount() const { return _cycles; }
+  uint32_t lastCycleMs() const { return _lastMs; }
+  uint32_t maxCycleMs() const { return _maxMs; }
+  uint32_t avgCycleMs() const { return _cycles ? static_cast<uint32_t>(_sumMs / _cycles) : 0; }
+  uint32_t lastBusHoldUs() const { return _lastHoldUs; }
+
+private:
+  enum class Phase : uint8_t { Idle, Temp, Converting };
+
+  void beginIfIdle(uint32_t nowMs);
+
+  uint32_t _intervalMs;
+  uint32_t _tempDelayMs;
+  uint32_t _readDelayMs;
+
+  Phase _phase = Phase::Idle;
+  bool _everStarted = false;
+  uint32_t _startMs = 0;    // Début du cycle courant / dernier
+  uint32_t _issuedMs = 0;   // Émission de la commande en attente
+  uint32_t _holdUs = 0;     // Occupation bus du cycle courant
+
+  uint32_t _cycles = 0;
+  uint32_t _lastMs = 0;
+  uint32_t _maxMs = 0;
+  uint64_t _sumMs = 0;
+  uint32_t _lastHoldUs = 0;
+};
+
+#endif // EZO_CYCLE_LOGIC_H
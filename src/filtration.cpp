@@ -94,6 +94,7 @@ void FiltrationManager::computeAutoSchedule() {
   filtrationCfg.start = minutesToTimeString(w.startMin);
   filtrationCfg.end = minutesToTimeString(w.endMin);
   ensureTimesValid();
+  bumpConfigGeneration();  // filtration_start/end exposés par /get-config
   _lastScheduledTemp = referenceTemp;
   systemLogger.info("Planning auto: " + String(referenceTemp, 1) + "°C → " + filtrationCfg.start + "-" + filtrationCfg.end);
 }
@@ -0,0 +1,88 @@
+#include "fixed_format.h"
+
+#include <math.h>
+
+// =============================================================================
+// fixed_format — implémentation PURE
+// =============================================================================
+
+namespace {
+
+constexpr double kScale[] = {1.0, 10.0, 100.0, 1000.0};
+constexpr uint32_t kPow10[] = {1, 10, 100, 1000};
+
+uint8_t clampDecimals(uint8_t decimals) {
+  return decimals > kFixedMaxDecimals ? kFixedMaxDecimals : decimals;
+}
+
+// Arrondi au plus proche, égalités au pair (conversion décimale de printf).
+double roundHalfEven(double p) {
+  const double f = floor(p);
+  const double diff = p - f;
+  if (diff > 0.5) return f + 1.0;
+  if (diff < 0.5) return f;
+  return fmod(f, 2.0) == 0.0 ? f : f + 1.0;
+}
+
+size_t formatSigned(char* buf, size_t cap, bool negative, uint32_t mag, uint8_t decimals) {
+  char digits[12];
+  size_t n = 0;
+  uint32_t ip = mag / kPow10[decimals];
+  uint32_t fp = mag % kPow10[decimals];
+  do {
+    digits[n++] = static_cast<char>('0' + ip % 10);
+    ip /= 10;
+  } while (ip != 0);
+
+  const size_t len = (negative ? 1 : 0) + n + (decimals ? 1 + decimals : 0);
+  if (buf == nullptr || cap == 0) return 0;
+  if (len + 1 > cap) {
+    buf[0] = '\0';
+    return 0;
+  }
+  size_t o = 0;
+  if (negative) buf[o++] = '-';
+  while (n > 0) buf[o++] = digits[--n];
+  if (decimals) {
+    buf[o++] = '.';
+    for (uint8_t i = decimals; i > 0; --i) {
+      buf[o++] = static_cast<char>('0' + (fp / kPow10[i - 1]) % 10);
+    }
+  }
+  buf[o] = '\0';
+  return o;
+}
+
+}  // namespace
+
+int32_t fixedFromFloat(float value, uint8_t decimals) {
+  if (isnan(value)) return 0;
+  const double p = roundHalfEven(static_cast<double>(value) * kScale[clampDecimals(decimals)]);
+  if (p >= 2147483647.0) return INT32_MAX;
+  if (p <= -2147483648.0) return INT32_MIN;
+  return static_cast<int32_t>(p);
+}
+
+float fixedRound(float value, uint8_t decimals) {
+  if (!isfinite(value)) return value;
+  decimals = clampDecimals(decimals);
+  return static_cast<float>(fixedFromFloat(value, decimals) / kScale[decimals]);
+}
+
+size_t formatFixed(char* buf, size_t cap, int32_t scaled, uint8_t decimals) {
+  // |INT32_MIN| ne tient pas en int32 : magnitude calculée en 64 bits.
+  const int64_t s = scaled;
+  return formatSigned(buf, cap, s < 0, static_cast<uint32_t>(s < 0 ? -s : s), clampDecimals(decimals));
+}
+
+size_t formatFloatFixed(char* buf, size_t cap, float value, uint8_t decimals) {
+  if (!isfinite(value)) {
+    if (buf != nullptr && cap > 0) buf[0] = '\0';
+    return 0;
+  }
+  decimals = clampDecimals(decimals);
+  const int32_t scaled = fixedFromFloat(value, decimals);
+  const int64_t s = scaled;
+  // signbit : printf écrit "-0.0" pour une valeur négative arrondie à zéro.
+  return formatSigned(buf, cap, signbit(value) != 0, static_cast<uint32_t>(s < 0 ? -s : s), decimals);
+}
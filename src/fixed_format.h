@@ -0,0 +1,64 @@
+#ifndef FIXED_FORMAT_H
+#define FIXED_FORMAT_H
+
+// =============================================================================
+// fixed_format — Formatage numérique en virgule fixe sans tas, PURE
+// =============================================================================
+// Remplace String(value, n) / snprintf("%.*f") sur les chemins chauds (MQTT,
+// UART, WebSocket) : le texte est écrit dans un tampon fourni par l'appelant,
+// sans allocation ni printf flottant (pile de mqttTask : 8 Ko).
+//
+//   Métrique     | Virgule fixe | Exemple
+//   -------------|--------------|---------
+//   pH           | ×1000        | "7.235"
+//   ORP          | entier (mV)  | "650"
+//   Température  | ×10          | "26.4"
+//
+// Arrondi IDENTIQUE à printf("%.*f") / String(value, n) : le produit
+// value × 10^décimales est exact en double (mantisse float 24 bits + ≤ 10 bits),
+// puis arrondi au plus proche, égalités au pair — comme la conversion décimale
+// exacte de printf. Le zéro négatif garde son signe ("-0.0"), comme printf.
+// La valeur en virgule fixe sert aussi de clé de dédup (mqtt_dedup) : texte
+// publié et valeur mémorisée ne peuvent pas diverger.
+//
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Décimales prises en charge : 0..3 (au-delà : ramené à 3).
+constexpr uint8_t kFixedMaxDecimals = 3;
+// Tampon suffisant pour toute valeur int32 formatée ("-2147483.648" + NUL).
+constexpr size_t kFixedFormatMax = 16;
+
+constexpr uint8_t kFixedPhDecimals   = 3;  // pH ×1000
+constexpr uint8_t kFixedOrpDecimals  = 0;  // ORP en mV
+constexpr uint8_t kFixedTempDecimals = 1;  // Température ×10
+
+// value × 10^decimals arrondi comme printf, borné à int32. NaN → 0.
+int32_t fixedFromFloat(float value, uint8_t decimals);
+
+// Valeur arrondie à `decimals` décimales, pour les sérialiseurs numériques
+// (ArduinoJson) : même arrondi que le texte MQTT.
+float fixedRound(float value, uint8_t decimals);
+
+// Écrit scaled / 10^decimals ("7.235", "-0.5", "650") dans buf, NUL compris.
+// Retourne la longueur écrite ; 0 (buf vide) si cap est insuffisant.
+size_t formatFixed(char* buf, size_t cap, int32_t scaled, uint8_t decimals);
+
+// Raccourci float → texte, sortie identique à snprintf("%.*f", decimals, value)
+// pour toute valeur finie dans la plage int32. NaN / infini → 0 (buf vide).
+size_t formatFloatFixed(char* buf, size_t cap, float value, uint8_t decimals);
+
+inline size_t formatPh(char* buf, size_t cap, float ph) {
+  return formatFloatFixed(buf, cap, ph, kFixedPhDecimals);
+}
+inline size_t formatOrp(char* buf, size_t cap, float orpMv) {
+  return formatFloatFixed(buf, cap, orpMv, kFixedOrpDecimals);
+}
+inline size_t formatTemperature(char* buf, size_t cap, float celsius) {
+  return formatFloatFixed(buf, cap, celsius, kFixedTempDecimals);
+}
+
+#endif // FIXED_FORMAT_H
@@ -5,6 +5,7 @@
 #include "sensors.h"
 #include "filtration.h"
 #include "pump_controller.h"
+#include "sensor_trace.h"
 #include <ArduinoJson.h>
 #include <map>
 #include <algorithm>
@@ -150,6 +151,7 @@ void HistoryManager::begin() {
     }
 
     systemLogger.setPersistenceFs(&historyFs);
+    sensorTrace.setStorageFs(&historyFs);
   }
   else {
     systemLogger.error("Partition historique absente ou échec montage — logs persistants et historique désactivés");
@@ -0,0 +1,156 @@
+#include "i2c_bus.h"
+
+#include <Wire.h>
+#include <esp_task_wdt.h>
+
+#include "constants.h"
+#include "logger.h"
+
+I2cBus i2cBus;
+
+void I2cBus::begin() {
+  // Bus I²C partagé : DS3231 + EZO pH + EZO ORP (cf. constants.h kI2cSdaPin/kI2cSclPin)
+  Wire.begin();
+
+  // Lectures périodiques espacées par périphérique : un cycle EZO relancé
+  // après expiration ne rafale pas le module.
+  _sched.setPeriodicSpacing(I2cDevice::EzoPh, kEzoPeriodicSpacingMs);
+  _sched.setPeriodicSpacing(I2cDevice::EzoOrp, kEzoPeriodicSpacingMs);
+  _sched.setPeriodicSpacing(I2cDevice::OneWire, kOneWirePeriodicSpacingMs);
+
+  _submitQueue = xQueueCreate(kI2cSubmitQueueLength, sizeof(I2cTxn*));
+  if (_submitQueue == nullptr) {
+    systemLogger.critical("I2C : échec création queue de soumission — accès capteurs en ligne");
+    return;
+  }
+
+  BaseType_t ok = xTaskCreatePinnedToCore(
+      &I2cBus::taskFunction,
+      "i2cTask",
+      kI2cTaskStackSize,
+      this,
+      kI2cTaskPriority,
+      &_task,
+      kI2cTaskCore);
+  if (ok != pdPASS) {
+    systemLogger.critical("I2C : échec xTaskCreatePinnedToCore (i2cTask) — accès capteurs en ligne");
+    _task = nullptr;
+    return;
+  }
+
+  systemLogger.info("Bus capteurs initialisé (i2cTask core=" + String(kI2cTaskCore) +
+                    " prio=" + String(kI2cTaskPriority) +
+                    " stack=" + String(kI2cTaskStackSize) + ")");
+}
+
+bool I2cBus::submit(I2cTxn& txn) {
+  // Sans tâche (avant begin() ou échec de création) : exécution en ligne,
+  // l'appelant relève Done au tour suivant comme en régime établi.
+  if (_task == nullptr) {
+    runInline(txn);
+    return true;
+  }
+  txn.stage = 0;
+  txn.ok = false;
+  txn.state = I2cTxnState::Pending;
+  I2cTxn* ptr = &txn;
+  if (xQueueSend(_submitQueue, &ptr, 0) != pdTRUE) {
+    txn.state = I2cTxnState::Expired;
+    return false;
+  }
+  return true;
+}
+
+bool I2cBus::run(I2cTxn& txn) {
+  if (_task == nullptr || xTaskGetCurrentTaskHandle() == _task) {
+    return runInline(txn);
+  }
+  txn.waiter = xTaskGetCurrentTaskHandle();
+  if (!submit(txn)) {
+    txn.waiter = nullptr;
+    return false;
+  }
+  // Réveil garanti : i2cTask notifie à la fin comme à l'expiration.
+  while (txn.state == I2cTxnState::Pending) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+  txn.waiter = nullptr;
+  return txn.state == I2cTxnState::Done && txn.ok;
+}
+
+bool I2cBus::runInline(I2cTxn& txn) {
+  // Boot (avant begin()) ou appel depuis i2cTask : pas d'ordonnancement,
+  // le bus n'a pas d'autre client.
+  txn.stage = 0;
+  txn.ok = false;
+  txn.state = I2cTxnState::Pending;
+  for (;;) {
+    const uint32_t waitMs = txn.step(txn);
+    if (waitMs == 0) break;
+    delay(waitMs);
+  }
+  txn.state = I2cTxnState::Done;
+  return txn.ok;
+}
+
+void I2cBus::taskFunction(void* param) {
+  I2cBus* self = static_cast<I2cBus*>(param);
+  esp_task_wdt_add(NULL);
+  self->taskLoop();
+}
+
+void I2cBus::taskLoop() {
+  for (;;) {
+    esp_task_wdt_reset();
+
+    // Attente bornée au prochain événement de l'ordonnanceur (étape due,
+    // démarrage possible, expiration) ; une soumission réveille plus tôt.
+    const uint32_t waitMs = _sched.idleMs(millis(), kI2cTaskIdleMaxMs);
+    I2cTxn* txn = nullptr;
+    if (xQueueReceive(_submitQueue, &txn, pdMS_TO_TICKS(waitMs)) == pdTRUE) {
+      accept(txn);
+      while (xQueueReceive(_submitQueue, &txn, 0) == pdTRUE) accept(txn);
+    }
+
+    const uint32_t now = millis();
+    int slot;
+    while ((slot = _sched.popExpired(now)) >= 0) {
+      I2cTxn* expired = _slots[slot];
+      _slots[slot] = nullptr;
+      complete(expired, I2cTxnState::Expired);
+    }
+
+    slot = _sched.next(now);
+    if (slot >= 0) runStep(slot);
+  }
+}
+
+void I2cBus::accept(I2cTxn* txn) {
+  const int slot = _sched.enqueue(txn->devices, txn->priority, millis(), txn->timeoutMs);
+  if (slot < 0) {
+    // File pleine (ou masque vide) : refus immédiat, traité comme une expiration.
+    complete(txn, I2cTxnState::Expired);
+    return;
+  }
+  _slots[slot] = txn;
+}
+
+void I2cBus::runStep(int slot) {
+  I2cTxn* txn = _slots[slot];
+  const uint32_t t0 = micros();
+  const uint32_t waitMs = txn->step(*txn);
+  const uint32_t stepUs = micros() - t0;
+  _sched.stepDone(slot, millis(), stepUs, waitMs);
+  if (waitMs == 0) {
+    _slots[slot] = nullptr;
+    complete(txn, I2cTxnState::Done);
+  }
+}
+
+void I2cBus::complete(I2cTxn* txn, I2cTxnState state) {
+  // waiter lu AVANT la publication de l'état : un run() réveillé peut
+  // retourner et libérer la transaction (pile) aussitôt après.
+  TaskHandle_t waiter = txn->waiter;
+  txn->state = state;
+  if (waiter != nullptr) xTaskNotifyGive(waiter);
+}
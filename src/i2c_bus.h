@@ -0,0 +1,98 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+// =============================================================================
+// i2c_bus — Tâche propriétaire du bus capteurs (i2cTask)
+// =============================================================================
+// Seule i2cTask touche Wire (EZO pH/ORP, DS3231) et le 1-Wire (DS18B20). Les
+// autres tâches soumettent des transactions ; l'ordre d'exécution est décidé
+// par I2cScheduler (i2c_sched_logic) : priorité, réservation par
+// périphérique, espacement des lectures périodiques, échéance de démarrage.
+// Voir ADR-0028.
+//
+// Une transaction (I2cTxn) est une fonction d'étape rappelée dans i2cTask :
+//   - elle exécute quelques trames (jamais de delay()) ;
+//   - elle retourne 0 si elle est terminée, sinon l'attente en ms avant
+//     l'étape suivante (conversion EZO) — ses périphériques restent réservés,
+//     le bus sert les autres transactions entre-temps ;
+//   - `stage` (remis à 0 à la soumission) est à sa disposition pour
+//     enchaîner les étapes ; `ok` porte le résultat.
+//
+// Deux modes :
+//   - run()    : synchrone, l'appelant est suspendu jusqu'à la fin (ou
+//                l'expiration). La transaction peut vivre sur sa pile.
+//   - submit() : asynchrone, l'appelant relève `state` plus tard (Done /
+//                Expired). La transaction doit survivre jusque-là.
+// Sans tâche (avant begin(), échec de création) run() et submit() exécutent
+// les étapes en ligne avec delay() — de même run() depuis i2cTask : même
+// code au boot qu'en régime établi.
+//
+// Une fonction d'étape ne doit JAMAIS appeler run() (elle s'exécute dans
+// i2cTask : interblocage). Les pilotes (AtlasEzoSensor, RtcManager) passent
+// par run() dans leurs méthodes publiques et exposent des étapes pour les
+// séquences composées (cycle EZO de SensorManager).
+// =============================================================================
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "i2c_sched_logic.h"
+
+enum class I2cTxnState : uint8_t {
+  Idle,     // Jamais soumise / résultat relevé
+  Pending,  // En file ou en cours dans i2cTask
+  Done,     // Terminée (voir `ok`)
+  Expired,  // Échéance passée avant démarrage, ou file pleine
+};
+
+struct I2cTxn {
+  uint8_t devices = 0;                          // Masque i2cDeviceBit()
+  I2cPriority priority = I2cPriority::OnDemand;
+  uint32_t timeoutMs = 0;                       // Échéance de démarrage
+  uint32_t (*step)(I2cTxn& txn) = nullptr;      // Retourne 0 = fin, sinon attente ms
+  void* ctx = nullptr;
+
+  uint8_t stage = 0;
+  bool ok = false;
+  // Écrit par i2cTask, lu par le soumetteur : volatile suffit sur ESP32
+  // (accès volatiles sérialisés par memw, écritures du résultat avant).
+  volatile I2cTxnState state = I2cTxnState::Idle;
+  TaskHandle_t waiter = nullptr;                // run() : tâche à réveiller
+};
+
+class I2cBus {
+public:
+  // Wire.begin() + création de i2cTask. Avant tout accès capteur.
+  void begin();
+
+  // Synchrone. Retourne true si la transaction a été exécutée et a posé ok.
+  bool run(I2cTxn& txn);
+
+  // Asynchrone. false si la file de soumission est pleine (state = Expired).
+  // La transaction doit rester valide tant que state == Pending.
+  bool submit(I2cTxn& txn);
+
+  // Instrumentation (lecture depuis une autre tâche : valeurs 32 bits
+  // indépendantes, cohérence champ à champ seulement).
+  const I2cDeviceStats& stats(I2cDevice d) const { return _sched.stats(d); }
+  uint8_t peakPending() const { return _sched.peakPending(); }
+  bool started() const { return _task != nullptr; }
+
+private:
+  static void taskFunction(void* param);
+  void taskLoop();
+  void accept(I2cTxn* txn);
+  void runStep(int slot);
+  void complete(I2cTxn* txn, I2cTxnState state);
+  bool runInline(I2cTxn& txn);
+
+  I2cScheduler _sched;
+  I2cTxn* _slots[kI2cSchedCapacity] = {};
+  QueueHandle_t _submitQueue = nullptr;
+  TaskHandle_t _task = nullptr;
+};
+
+extern I2cBus i2cBus;
+
+#endif // I2C_BUS_H
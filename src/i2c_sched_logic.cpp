@@ -0,0 +1,170 @@
+#include "i2c_sched_logic.h"
+
+// Comparaisons d'instants tolérantes au rebouclage de millis() (~49 jours).
+static bool reached(uint32_t nowMs, uint32_t atMs) {
+  return static_cast<int32_t>(nowMs - atMs) >= 0;
+}
+
+const char* i2cDeviceName(I2cDevice d) {
+  switch (d) {
+    case I2cDevice::EzoPh:   return "ezo_ph";
+    case I2cDevice::EzoOrp:  return "ezo_orp";
+    case I2cDevice::Rtc:     return "rtc";
+    case I2cDevice::OneWire: return "onewire";
+    default:                 return "?";
+  }
+}
+
+int I2cScheduler::enqueue(uint8_t devices, I2cPriority prio, uint32_t nowMs, uint32_t timeoutMs) {
+  const uint8_t validMask = static_cast<uint8_t>((1u << kI2cDeviceCount) - 1);
+  if ((devices & validMask) == 0) return -1;
+  for (uint8_t i = 0; i < kI2cSchedCapacity; ++i) {
+    Slot& s = _slots[i];
+    if (s.state != State::Free) continue;
+    s.state = State::Queued;
+    s.devices = devices & validMask;
+    s.prio = prio;
+    s.seq = _seq++;
+    s.enqMs = nowMs;
+    s.timeoutMs = timeoutMs;
+    s.startMs = 0;
+    s.resumeMs = 0;
+    const uint8_t n = pending();
+    if (n > _peak) _peak = n;
+    return i;
+  }
+  return -1;
+}
+
+uint32_t I2cScheduler::spacingLeftMs(const Slot& s, uint32_t nowMs) const {
+  if (s.prio != I2cPriority::Periodic) return 0;
+  uint32_t left = 0;
+  for (uint8_t d = 0; d < kI2cDeviceCount; ++d) {
+    if (!(s.devices & (1u << d)) || !_periodicSeen[d] || _spacingMs[d] == 0) continue;
+    const uint32_t elapsed = nowMs - _lastPeriodicMs[d];
+    if (elapsed < _spacingMs[d] && _spacingMs[d] - elapsed > left) {
+      left = _spacingMs[d] - elapsed;
+    }
+  }
+  return left;
+}
+
+bool I2cScheduler::canStart(const Slot& s, uint32_t nowMs) const {
+  return (s.devices & _reserved) == 0 && spacingLeftMs(s, nowMs) == 0;
+}
+
+int I2cScheduler::next(uint32_t nowMs) {
+  // 1) Reprise d'une séquence commencée : la plus en retard d'abord.
+  int best = -1;
+  for (uint8_t i = 0; i < kI2cSchedCapacity; ++i) {
+    const Slot& s = _slots[i];
+    if (s.state != State::Active || !reached(nowMs, s.resumeMs)) continue;
+    if (best < 0 || static_cast<int32_t>(s.resumeMs - _slots[best].resumeMs) < 0) best = i;
+  }
+  if (best >= 0) return best;
+
+  // 2) Démarrage : priorité, puis ancienneté, parmi celles dont les
+  //    périphériques sont libres et l'espacement périodique respecté.
+  for (uint8_t i = 0; i < kI2cSchedCapacity; ++i) {
+    const Slot& s = _slots[i];
+    if (s.state != State::Queued || !canStart(s, nowMs)) continue;
+    if (best < 0) { best = i; continue; }
+    const Slot& b = _slots[best];
+    if (s.prio < b.prio || (s.prio == b.prio && static_cast<int32_t>(s.seq - b.seq) < 0)) best = i;
+  }
+  if (best < 0) return -1;
+
+  Slot& s = _slots[best];
+  s.state = State::Active;
+  s.startMs = nowMs;
+  s.resumeMs = nowMs;
+  _reserved |= s.devices;
+  const uint32_t waitMs = nowMs - s.enqMs;
+  for (uint8_t d = 0; d < kI2cDeviceCount; ++d) {
+    if (!(s.devices & (1u << d))) continue;
+    I2cDeviceStats& st = _stats[d];
+    st.waitStarts++;
+    st.waitLastMs = waitMs;
+    st.waitSumMs += waitMs;
+    if (waitMs > st.waitMaxMs) st.waitMaxMs = waitMs;
+    if (s.prio == I2cPriority::Periodic) {
+      _lastPeriodicMs[d] = nowMs;
+      _periodicSeen[d] = true;
+    }
+  }
+  return best;
+}
+
+void I2cScheduler::stepDone(int slot, uint32_t nowMs, uint32_t stepUs, uint32_t waitMs) {
+  if (slot < 0 || slot >= kI2cSchedCapacity) return;
+  Slot& s = _slots[slot];
+  if (s.state != State::Active) return;
+
+  for (uint8_t d = 0; d < kI2cDeviceCount; ++d) {
+    if (s.devices & (1u << d)) _stats[d].busUs += stepUs;
+  }
+  if (waitMs != 0) {
+    s.resumeMs = nowMs + waitMs;
+    return;
+  }
+
+  const uint32_t holdMs = nowMs - s.startMs;
+  const bool late = (nowMs - s.enqMs) > s.timeoutMs;
+  for (uint8_t d = 0; d < kI2cDeviceCount; ++d) {
+    if (!(s.devices & (1u << d))) continue;
+    I2cDeviceStats& st = _stats[d];
+    st.txns++;
+    st.holdLastMs = holdMs;
+    st.holdSumMs += holdMs;
+    if (holdMs > st.holdMaxMs) st.holdMaxMs = holdMs;
+    if (late) st.late++;
+  }
+  _reserved &= static_cast<uint8_t>(~s.devices);
+  s.state = State::Free;
+}
+
+int I2cScheduler::popExpired(uint32_t nowMs) {
+  for (uint8_t i = 0; i < kI2cSchedCapacity; ++i) {
+    Slot& s = _slots[i];
+    if (s.state != State::Queued || (nowMs - s.enqMs) < s.timeoutMs) continue;
+    for (uint8_t d = 0; d < kI2cDeviceCount; ++d) {
+      if (s.devices & (1u << d)) _stats[d].expired++;
+    }
+    s.state = State::Free;
+    return i;
+  }
+  return -1;
+}
+
+uint32_t I2cScheduler::idleMs(uint32_t nowMs, uint32_t capMs) const {
+  uint32_t best = capMs;
+  for (uint8_t i = 0; i < kI2cSchedCapacity && best > 0; ++i) {
+    const Slot& s = _slots[i];
+    uint32_t due = capMs;
+    if (s.state == State::Active) {
+      due = reached(nowMs, s.resumeMs) ? 0 : s.resumeMs - nowMs;
+    } else if (s.state == State::Queued) {
+      const uint32_t age = nowMs - s.enqMs;
+      const uint32_t expireIn = (age >= s.timeoutMs) ? 0 : s.timeoutMs - age;
+      // Bloquée par une réservation : réveil à l'expiration au plus tard ;
+      // la fin de la transaction qui réserve est elle-même un événement.
+      due = ((s.devices & _reserved) == 0) ? spacingLeftMs(s, nowMs) : expireIn;
+      if (expireIn < due) due = expireIn;
+    }
+    if (due < best) best = due;
+  }
+  return best;
+}
+
+void I2cScheduler::setPeriodicSpacing(I2cDevice d, uint32_t ms) {
+  if (d >= I2cDevice::Count) return;
+  _spacingMs[static_cast<uint8_t>(d)] = ms;
+}
+
+uint8_t I2cScheduler::pending() const {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < kI2cSchedCapacity; ++i) {
+    if (_slots[i].state != State::Free) n++;
+  }
+  return n;
+}
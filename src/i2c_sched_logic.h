@@ -0,0 +1,138 @@
+#ifndef I2C_SCHED_LOGIC_H
+#define I2C_SCHED_LOGIC_H
+
+// =============================================================================
+// i2c_sched_logic — Ordonnanceur de transactions du bus capteurs, PURE
+// =============================================================================
+// Décide, pour la tâche propriétaire du bus (i2c_bus, i2cTask), QUELLE
+// transaction exécuter et QUAND. Une transaction réserve un ou plusieurs
+// périphériques (masque I2cDevice) et s'exécute en étapes : entre deux étapes
+// elle peut demander une attente (conversion EZO 300/900 ms) pendant laquelle
+// ses périphériques restent réservés mais le bus sert les autres.
+//
+// Règles de choix (next()) :
+//   1. Une transaction active dont l'attente est échue passe en premier
+//      (la plus en retard d'abord) — une séquence commencée se termine.
+//   2. Sinon, la transaction en file de plus haute priorité (Urgent >
+//      OnDemand > Periodic), à priorité égale la plus ancienne, dont aucun
+//      périphérique n'est réservé.
+//   3. Les transactions Periodic sont espacées : au moins spacing(device) ms
+//      entre deux démarrages périodiques sur un même périphérique.
+//
+// Échéance : chaque transaction porte un délai maximal de démarrage. Passé ce
+// délai sans avoir démarré, elle est retirée (popExpired) — une lecture
+// périodique obsolète ne vaut pas la peine d'occuper le bus. Une transaction
+// démarrée va toujours au bout ; si elle finit après l'échéance, elle est
+// comptée « en retard ».
+//
+// Statistiques par périphérique : attente (file → démarrage) et tenue
+// (démarrage → fin, attentes de conversion comprises), dernière / moyenne /
+// max en ms, temps bus effectif cumulé en µs, expirations et retards.
+//
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <stdint.h>
+
+enum class I2cDevice : uint8_t {
+  EzoPh,    // Atlas EZO pH (0x63)
+  EzoOrp,   // Atlas EZO ORP (0x62)
+  Rtc,      // DS3231 (0x68)
+  OneWire,  // DS18B20 (GPIO 5) — bus distinct, même propriétaire
+  Count,
+};
+
+constexpr uint8_t kI2cDeviceCount = static_cast<uint8_t>(I2cDevice::Count);
+
+constexpr uint8_t i2cDeviceBit(I2cDevice d) {
+  return static_cast<uint8_t>(1u << static_cast<uint8_t>(d));
+}
+
+enum class I2cPriority : uint8_t {
+  Urgent,    // Action utilisateur : calibration, réglage de l'heure
+  OnDemand,  // Requête ponctuelle : lecture RTC, Cal,?, Slope,?
+  Periodic,  // Lecture périodique : cycle EZO, DS18B20
+};
+
+constexpr uint8_t kI2cSchedCapacity = 8;
+
+const char* i2cDeviceName(I2cDevice d);
+
+struct I2cDeviceStats {
+  uint32_t txns = 0;       // Transactions terminées
+  uint32_t expired = 0;    // Retirées de la file avant démarrage
+  uint32_t late = 0;       // Terminées après leur échéance
+  uint32_t waitLastMs = 0;
+  uint32_t waitMaxMs = 0;
+  uint32_t holdLastMs = 0;
+  uint32_t holdMaxMs = 0;
+  uint32_t busUs = 0;      // Temps d'exécution des étapes (reboucle ~71 min)
+  uint64_t waitSumMs = 0;
+  uint64_t holdSumMs = 0;
+  uint32_t waitStarts = 0;  // Démarrages (base de la moyenne d'attente)
+
+  uint32_t avgWaitMs() const { return waitStarts ? static_cast<uint32_t>(waitSumMs / waitStarts) : 0; }
+  uint32_t avgHoldMs() const { return txns ? static_cast<uint32_t>(holdSumMs / txns) : 0; }
+};
+
+class I2cScheduler {
+public:
+  // Place une transaction en file. Retourne son emplacement (0..capacité-1),
+  // -1 si la file est pleine ou le masque vide. timeoutMs = délai maximal
+  // avant démarrage.
+  int enqueue(uint8_t devices, I2cPriority prio, uint32_t nowMs, uint32_t timeoutMs);
+
+  // Emplacement dont la prochaine étape est à exécuter maintenant, -1 sinon.
+  // Une transaction en file choisie passe active (périphériques réservés).
+  int next(uint32_t nowMs);
+
+  // Étape exécutée : stepUs = durée mesurée, waitMs = attente avant l'étape
+  // suivante, 0 = transaction terminée (emplacement libéré).
+  void stepDone(int slot, uint32_t nowMs, uint32_t stepUs, uint32_t waitMs);
+
+  // Retire une transaction en file dont l'échéance est passée ; retourne son
+  // emplacement, -1 s'il n'y en a pas. À appeler en boucle.
+  int popExpired(uint32_t nowMs);
+
+  // Délai jusqu'au prochain événement (étape due, démarrage possible,
+  // expiration), borné à capMs. 0 = travail immédiat.
+  uint32_t idleMs(uint32_t nowMs, uint32_t capMs) const;
+
+  // Espacement minimal entre deux démarrages Periodic sur un périphérique.
+  void setPeriodicSpacing(I2cDevice d, uint32_t ms);
+
+  const I2cDeviceStats& stats(I2cDevice d) const { return _stats[static_cast<uint8_t>(d)]; }
+  uint8_t reserved() const { return _reserved; }
+  uint8_t pending() const;                       // En file ou actives
+  uint8_t peakPending() const { return _peak; }
+
+private:
+  enum class State : uint8_t { Free, Queued, Active };
+
+  struct Slot {
+    State state = State::Free;
+    uint8_t devices = 0;
+    I2cPriority prio = I2cPriority::Periodic;
+    uint32_t seq = 0;
+    uint32_t enqMs = 0;
+    uint32_t timeoutMs = 0;
+    uint32_t startMs = 0;
+    uint32_t resumeMs = 0;  // Active : prochaine étape due à cet instant
+  };
+
+  bool canStart(const Slot& s, uint32_t nowMs) const;
+  uint32_t spacingLeftMs(const Slot& s, uint32_t nowMs) const;
+
+  Slot _slots[kI2cSchedCapacity];
+  uint32_t _seq = 0;
+  uint8_t _reserved = 0;
+  uint8_t _peak = 0;
+
+  uint32_t _spacingMs[kI2cDeviceCount] = {};
+  uint32_t _lastPeriodicMs[kI2cDeviceCount] = {};
+  bool _periodicSeen[kI2cDeviceCount] = {};
+
+  I2cDeviceStats _stats[kI2cDeviceCount];
+};
+
+#endif // I2C_SCHED_LOGIC_H
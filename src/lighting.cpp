@@ -42,6 +42,7 @@ void LightingManager::setManualOn() {
   state.manualOverride = true;
   state.manualSetAtMs = millis();
   systemLogger.info("Éclairage manuel: ON");
+  bumpConfigGeneration();  // lighting_enabled fait partie de la config exposée
   publishState();
 }
 
@@ -50,6 +51,7 @@ void LightingManager::setManualOff() {
   state.manualOverride = true;
   state.manualSetAtMs = millis();
   systemLogger.info("Éclairage manuel: OFF");
+  bumpConfigGeneration();  // lighting_enabled fait partie de la config exposée
   publishState();
 }
 
@@ -25,10 +25,6 @@ void Logger::log(LogLevel level, const String& message) {
   entry.level = level;
   entry.message = message;
 
-  // Capture du callback hors section critique pour éviter un deadlock
-  // si le callback tente lui-même de logger.
-  std::function<void(const LogEntry&)> cb = nullptr;
-
   // feature-027 : prise bornée. Timeout → entrée perdue (politique silencieuse :
   // JAMAIS de systemLogger dans les chemins d'échec — récursion). Serial reste exécuté.
   const bool locked = (_mutex == nullptr) ||
@@ -41,7 +37,8 @@ void Logger::log(LogLevel level, const String& message) {
       currentIndex = (currentIndex + 1) % MAX_LOGS;
       bufferFull = true;
     }
-    cb = _logCallback;
+    // Publié sous mutex : getLogsSince() ne voit jamais une séquence en avance sur le buffer.
+    _sequence.fetch_add(1, std::memory_order_relaxed);
 
     // Bufferiser pour la persistance (hors DEBUG)
     if (_persistEnabled && level != LogLevel::DEBUG) {
@@ -65,9 +62,6 @@ void Logger::log(LogLevel level, const String& message) {
     _droppedLogs++;  // Entrée perdue (buffer RAM + persistance)
   }
 
-  // Push WebSocket temps réel (si callback enregistré) — hors mutex
-  if (cb) cb(entry);
-
   // Flush immédiat sur ERROR/CRITICAL pour survivre aux crashes imminents
   if (_persistEnabled && (level == LogLevel::ERROR || level == LogLevel::CRITICAL)) {
     flushToDisk();
@@ -141,6 +135,36 @@ std::vector<LogEntry> Logger::getRecentLogs(size_t count) {
   return result;
 }
 
+size_t Logger::getLogsSince(uint32_t& cursor, std::vector<LogEntry>& out, size_t maxCount) {
+  // Timeout → rien de copié, curseur inchangé (le lot partira au tour suivant)
+  if (_mutex && xSemaphoreTake(_mutex, pdMS_TO_TICKS(kLoggerMutexTimeoutMs)) != pdTRUE) {
+    return 0;
+  }
+
+  const uint32_t seq = _sequence.load(std::memory_order_relaxed);
+  const size_t stored = bufferFull ? MAX_LOGS : logs.size();
+  uint32_t pending = seq - cursor;
+  // Retard supérieur au contenu du buffer (rafale > MAX_LOGS ou clear()) : les entrées
+  // manquantes sont perdues pour le streaming, on repart de la plus ancienne disponible.
+  if (pending > stored) {
+    cursor = seq - stored;
+    pending = stored;
+  }
+  const size_t n = pending < maxCount ? pending : maxCount;
+
+  // Index de la plus ancienne entrée en attente : `pending` positions avant la fin du buffer
+  const size_t end = bufferFull ? currentIndex : logs.size();
+  size_t idx = (end + MAX_LOGS - pending) % MAX_LOGS;
+  for (size_t i = 0; i < n; i++) {
+    out.push_back(logs[idx]);
+    idx = (idx + 1) % MAX_LOGS;
+  }
+  cursor += n;
+
+  if (_mutex) xSemaphoreGive(_mutex);
+  return n;
+}
+
 void Logger::clear() {
   // feature-027 : timeout → no-op silencieux (rien n'est perdu : l'utilisateur
   // peut simplement re-cliquer — _droppedLogs ne compte que les entrées perdues)
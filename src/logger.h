@@ -3,7 +3,7 @@
 
 #include <Arduino.h>
 #include <vector>
-#include <functional>
+#include <atomic>
 #include <freertos/semphr.h>
 #include <FS.h>
 #include "constants.h"
@@ -28,8 +28,11 @@ private:
   std::vector<LogEntry> logs;
   size_t currentIndex = 0;
   bool bufferFull = false;
-  std::function<void(const LogEntry&)> _logCallback = nullptr;
   SemaphoreHandle_t _mutex = nullptr;
+  // Numéro de séquence de la dernière entrée insérée (monotone, non remis à zéro par
+  // clear()). Sert de curseur au streaming WS : le consommateur tire les entrées
+  // depuis loopTask au lieu d'être rappelé dans le contexte du producteur.
+  std::atomic<uint32_t> _sequence{0};
   // feature-027 : compteur d'entrées perdues sur timeout mutex (diagnostic, best-effort)
   uint32_t _droppedLogs = 0;
 
@@ -54,8 +57,11 @@ public:
   void error(const String& message);
   void critical(const String& message);
 
-  // Callback appelé à chaque nouveau log (utilisé par WsManager pour le push temps réel)
-  void setLogCallback(std::function<void(const LogEntry&)> cb) { _logCallback = cb; }
+  // Streaming temps réel (WsManager) : lecture incrémentale par curseur de séquence.
+  uint32_t getSequence() const { return _sequence.load(std::memory_order_relaxed); }
+  // Copie dans `out` au plus `maxCount` entrées postérieures à `cursor` (ordre chronologique)
+  // et avance `cursor`. Les entrées déjà écrasées par le buffer circulaire sont sautées.
+  size_t getLogsSince(uint32_t& cursor, std::vector<LogEntry>& out, size_t maxCount);
 
   String getLevelString(LogLevel level);
   std::vector<LogEntry> getRecentLogs(size_t count = 50);
@@ -9,6 +9,7 @@
 #include <nvs_flash.h>
 
 #include "config.h"
+#include "config_cache.h"
 #include "constants.h"
 #include "logger.h"
 #include "auth.h"
@@ -21,6 +22,7 @@
 #include "web_routes_config.h"
 #include "web_routes_control.h"
 #include "history.h"
+#include "i2c_bus.h"
 #include "version.h"
 #include "rtc_manager.h"
 #include "uart_transport.h"
@@ -69,6 +71,7 @@ void setup() {
 
   // Initialisation des mutex de protection concurrence
   initConfigMutexes();
+  configCache.begin();
 
   // Chargement configuration
   loadMqttConfig();
@@ -96,9 +99,11 @@ void setup() {
   }
 
   // Initialisation des modules
-  sensors.begin();  // Initialise aussi Wire (I2C)
+  // Bus capteurs (Wire + i2cTask) avant tout accès EZO / DS3231 / DS18B20 — ADR-0028.
+  i2cBus.begin();
+  sensors.begin();
 
-  // Initialisation RTC DS1307 (après sensors.begin() qui initialise I2C)
+  // Initialisation RTC DS3231 (transactions sur i2cBus)
   if (rtcManager.begin()) {
     // Si le RTC a une heure valide, l'appliquer au système
     // Cela donne une heure approximative avant que NTP ne soit disponible
@@ -312,9 +317,15 @@ bool setupWiFi() {
       case ARDUINO_EVENT_WIFI_STA_GOT_IP:
         systemLogger.info("WiFi IP obtenue: " + WiFi.localIP().toString() +
                           " RSSI=" + String(WiFi.RSSI()) + "dBm");
+        bumpConfigGeneration();  // wifi_ip / wifi_ssid du cache config
         break;
       case ARDUINO_EVENT_WIFI_STA_LOST_IP:
         systemLogger.warning("WiFi IP perdue");
+        bumpConfigGeneration();
+        break;
+      case ARDUINO_EVENT_WIFI_AP_START:
+      case ARDUINO_EVENT_WIFI_AP_STOP:
+        bumpConfigGeneration();  // wifi_mode / wifi_ip (AP) du cache config
         break;
       default:
         break;
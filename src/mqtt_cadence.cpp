@@ -0,0 +1,113 @@
+#include "mqtt_cadence.h"
+
+// =============================================================================
+// mqtt_cadence — implémentation PURE
+// =============================================================================
+
+namespace {
+
+// Intervalles par défaut (ms), indexés [groupe][phase Idle, Filtering, Dosing].
+constexpr uint32_t kDefaultIntervals[kMqttMetricGroupCount][kMqttPhaseCount] = {
+    {0, 0, 0},                  // None : comportement historique
+    {120000, 30000, 2000},      // Chemistry : pH / ORP (brut, médiane, filtré)
+    {300000, 60000, 30000},     // Temperature : eau, circuit
+    {60000, 30000, 2000},       // Volume : cumuls journaliers injectés
+};
+
+int32_t defaultImmediateBand(MqttTopicId id) {
+  switch (id) {
+    case MqttTopicId::PhState:
+    case MqttTopicId::PhRawState:
+    case MqttTopicId::PhMedianState:
+    case MqttTopicId::PhFilteredState:
+      return kMqttImmediatePhMilli;
+    case MqttTopicId::OrpState:
+    case MqttTopicId::OrpRawState:
+    case MqttTopicId::OrpMedianState:
+    case MqttTopicId::OrpFilteredState:
+      return kMqttImmediateOrpMv;
+    case MqttTopicId::TemperatureState:
+    case MqttTopicId::TemperatureCircuitState:
+      return kMqttImmediateTempDeci;
+    case MqttTopicId::PhDailyMlState:
+    case MqttTopicId::OrpDailyMlState:
+      return kMqttImmediateVolumeDeci;
+    default:
+      return 0;
+  }
+}
+
+}  // namespace
+
+MqttProcessPhase mqttProcessPhase(bool dosingOrMixing, bool filtrationRunning) {
+  if (dosingOrMixing) return MqttProcessPhase::Dosing;
+  return filtrationRunning ? MqttProcessPhase::Filtering : MqttProcessPhase::Idle;
+}
+
+MqttMetricGroup mqttMetricGroup(MqttTopicId id) {
+  switch (id) {
+    case MqttTopicId::PhState:
+    case MqttTopicId::PhRawState:
+    case MqttTopicId::PhMedianState:
+    case MqttTopicId::PhFilteredState:
+    case MqttTopicId::OrpState:
+    case MqttTopicId::OrpRawState:
+    case MqttTopicId::OrpMedianState:
+    case MqttTopicId::OrpFilteredState:
+      return MqttMetricGroup::Chemistry;
+    case MqttTopicId::TemperatureState:
+    case MqttTopicId::TemperatureCircuitState:
+      return MqttMetricGroup::Temperature;
+    case MqttTopicId::PhDailyMlState:
+    case MqttTopicId::OrpDailyMlState:
+      return MqttMetricGroup::Volume;
+    default:
+      return MqttMetricGroup::None;
+  }
+}
+
+MqttCadence::MqttCadence() {
+  for (uint8_t g = 0; g < kMqttMetricGroupCount; ++g) {
+    for (uint8_t p = 0; p < kMqttPhaseCount; ++p) {
+      _intervals[g][p] = kDefaultIntervals[g][p];
+    }
+  }
+  for (size_t i = 0; i < kMqttTopicCount; ++i) {
+    _immediate[i] = defaultImmediateBand(static_cast<MqttTopicId>(i));
+  }
+}
+
+void MqttCadence::setPhase(MqttProcessPhase phase) {
+  if (phase >= MqttProcessPhase::Count) return;
+  _phase = phase;
+}
+
+uint32_t MqttCadence::intervalMs(MqttTopicId id) const {
+  const uint8_t g = static_cast<uint8_t>(mqttMetricGroup(id));
+  return _intervals[g][static_cast<uint8_t>(_phase)];
+}
+
+void MqttCadence::setInterval(MqttMetricGroup group, MqttProcessPhase phase, uint32_t ms) {
+  if (group >= MqttMetricGroup::Count || group == MqttMetricGroup::None) return;
+  if (phase >= MqttProcessPhase::Count) return;
+  _intervals[static_cast<uint8_t>(group)][static_cast<uint8_t>(phase)] = ms;
+}
+
+int32_t MqttCadence::immediateBand(MqttTopicId id) const {
+  if (id >= MqttTopicId::Count) return 0;
+  return _immediate[static_cast<size_t>(id)];
+}
+
+void MqttCadence::setImmediateBand(MqttTopicId id, int32_t band) {
+  if (id >= MqttTopicId::Count) return;
+  _immediate[static_cast<size_t>(id)] = band < 0 ? 0 : band;
+}
+
+bool MqttCadence::due(MqttTopicId id, int64_t delta, uint32_t sinceMs) const {
+  const uint32_t interval = intervalMs(id);
+  if (interval == 0) return true;
+  const int64_t band = immediateBand(id);
+  const int64_t mag = delta < 0 ? -delta : delta;
+  if (band > 0 && mag >= band) return true;
+  return sinceMs >= interval;
+}
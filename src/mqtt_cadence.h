@@ -0,0 +1,82 @@
+#ifndef MQTT_CADENCE_H
+#define MQTT_CADENCE_H
+
+// =============================================================================
+// mqtt_cadence — Cadence de publication MQTT selon la dynamique du process, PURE
+// =============================================================================
+// Complète la dédup (mqtt_dedup) : la bande morte de MqttDedup devient la
+// RÉSOLUTION (plus petit écart publié) et la cadence décide QUAND un écart
+// plus petit que la bande « immédiate » peut partir.
+//
+//   Phase     | Condition                               | Chimie | Temp.  | Volumes
+//   ----------|-----------------------------------------|--------|--------|--------
+//   Dosing    | pompe en injection ou pause de mélange  | 2 s    | 30 s   | 2 s
+//   Filtering | filtration en marche                    | 30 s   | 60 s   | 30 s
+//   Idle      | filtration arrêtée, aucune injection    | 120 s  | 300 s  | 60 s
+//
+// Décision pour un topic cadencé dont la valeur a bougé d'au moins la résolution :
+//   - |Δ| ≥ bande immédiate          → publié tout de suite (transition franche) ;
+//   - sinon, si l'intervalle de la phase est échu depuis la dernière
+//     publication                    → publié (suivi fin pendant le dosage) ;
+//   - sinon                          → retenu (bruit de mesure au repos).
+// Les topics hors métriques cadencées (intervalle 0) gardent le comportement
+// historique : tout écart ≥ résolution part aussitôt.
+//
+// La phase est posée par la coquille (mqttTask) avant chaque cycle d'états.
+// Intervalles et bandes immédiates sont des constantes de compilation : le
+// firmware n'appelle pas setInterval() / setImmediateBand() (ni NVS, ni
+// /save-config), seuls les bancs natifs s'en servent.
+//
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <stdint.h>
+#include "mqtt_topics.h"
+
+enum class MqttProcessPhase : uint8_t { Idle, Filtering, Dosing, Count };
+
+// Groupe de métriques partageant une table d'intervalles.
+enum class MqttMetricGroup : uint8_t { None, Chemistry, Temperature, Volume, Count };
+
+constexpr uint8_t kMqttPhaseCount = static_cast<uint8_t>(MqttProcessPhase::Count);
+constexpr uint8_t kMqttMetricGroupCount = static_cast<uint8_t>(MqttMetricGroup::Count);
+
+// Bandes immédiates par défaut, dans l'unité de la virgule fixe publiée.
+constexpr int32_t kMqttImmediatePhMilli  = 50;   // pH ×1000 : 0,05 pH
+constexpr int32_t kMqttImmediateOrpMv    = 15;   // ORP en mV
+constexpr int32_t kMqttImmediateTempDeci = 5;    // Température ×10 : 0,5 °C
+constexpr int32_t kMqttImmediateVolumeDeci = 100; // Volume ×10 : 10 mL
+
+// Phase courante : l'injection (ou sa pause de mélange) prime sur la filtration.
+MqttProcessPhase mqttProcessPhase(bool dosingOrMixing, bool filtrationRunning);
+
+// Groupe d'un topic (None = non cadencé).
+MqttMetricGroup mqttMetricGroup(MqttTopicId id);
+
+class MqttCadence {
+public:
+  MqttCadence();
+
+  void setPhase(MqttProcessPhase phase);
+  MqttProcessPhase phase() const { return _phase; }
+
+  // Intervalle minimal (ms) entre deux publications sous la bande immédiate,
+  // pour la phase courante. 0 = non cadencé.
+  uint32_t intervalMs(MqttTopicId id) const;
+  void setInterval(MqttMetricGroup group, MqttProcessPhase phase, uint32_t ms);
+
+  // Bande immédiate d'un topic (0 = désactivée : tout passe par l'intervalle).
+  int32_t immediateBand(MqttTopicId id) const;
+  void setImmediateBand(MqttTopicId id, int32_t band);
+
+  // true si un écart |delta| (déjà ≥ résolution), observé `sinceMs` après la
+  // dernière publication du topic, doit être publié maintenant.
+  bool due(MqttTopicId id, int64_t delta, uint32_t sinceMs) const;
+
+private:
+  MqttProcessPhase _phase = MqttProcessPhase::Idle;
+  uint32_t _intervals[kMqttMetricGroupCount][kMqttPhaseCount];
+  int32_t _immediate[kMqttTopicCount];
+};
+
+#endif // MQTT_CADENCE_H
@@ -0,0 +1,185 @@
+#include "mqtt_commands.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "schedule_logic.h"
+
+// =============================================================================
+// mqtt_commands — implémentation PURE
+// =============================================================================
+
+namespace {
+
+enum class Case : uint8_t { Keep, Lower, Upper };
+
+// Équivalent String(payload) + trim() + toLowerCase()/toUpperCase() Arduino.
+void normalize(const char* in, char* out, size_t cap, Case c) {
+  const char* p = in ? in : "";
+  while (*p != '\0' && isspace(static_cast<unsigned char>(*p))) ++p;
+  size_t n = strlen(p);
+  while (n > 0 && isspace(static_cast<unsigned char>(p[n - 1]))) --n;
+  if (n > cap - 1) n = cap - 1;
+  for (size_t i = 0; i < n; ++i) {
+    const unsigned char ch = static_cast<unsigned char>(p[i]);
+    out[i] = c == Case::Lower ? static_cast<char>(tolower(ch))
+           : c == Case::Upper ? static_cast<char>(toupper(ch))
+                              : static_cast<char>(ch);
+  }
+  out[n] = '\0';
+}
+
+bool oneOf(const char* s, const char* a, const char* b, const char* c, const char* d = nullptr) {
+  return strcmp(s, a) == 0 || strcmp(s, b) == 0 || strcmp(s, c) == 0 ||
+         (d != nullptr && strcmp(s, d) == 0);
+}
+
+void parseOnOff(MqttCommandArgs& a) {
+  a.on = strcmp(a.text, "ON") == 0;
+  a.valid = a.on || strcmp(a.text, "OFF") == 0;
+}
+
+void parseRange(MqttCommandArgs& a, float lo, float hi) {
+  // String::toFloat() : atof, préfixe numérique ("7.2abc" → 7.2, "abc" → 0).
+  a.number = static_cast<float>(atof(a.text));
+  a.valid = a.number >= lo && a.number <= hi;
+}
+
+void parseDaily(MqttCommandArgs& a) {
+  a.valid = mqttIsNumericPayload(a.text);
+  if (!a.valid) return;
+  // String::toInt() : atol, partie entière ("150.0" → 150).
+  a.integer = static_cast<int>(atol(a.text));
+  if (a.integer < 0) a.integer = 0;  // clamp négatif → 0 (0 = désactivé)
+}
+
+}  // namespace
+
+bool mqttCommandFor(MqttTopicId id, MqttCommand& out) {
+  switch (id) {
+    case MqttTopicId::FiltrationModeCommand:    out = MqttCommand::FiltrationMode; return true;
+    case MqttTopicId::FiltrationCommand:        out = MqttCommand::FiltrationOnOff; return true;
+    case MqttTopicId::LightingCommand:          out = MqttCommand::Lighting; return true;
+    case MqttTopicId::PhTargetCommand:          out = MqttCommand::PhTarget; return true;
+    case MqttTopicId::OrpTargetCommand:         out = MqttCommand::OrpTarget; return true;
+    case MqttTopicId::PhRegulationModeCommand:  out = MqttCommand::PhRegulationMode; return true;
+    case MqttTopicId::OrpRegulationModeCommand: out = MqttCommand::OrpRegulationMode; return true;
+    case MqttTopicId::PhDailyTargetMlCommand:   out = MqttCommand::PhDailyTarget; return true;
+    case MqttTopicId::OrpDailyTargetMlCommand:  out = MqttCommand::OrpDailyTarget; return true;
+    case MqttTopicId::RebootCommand:            out = MqttCommand::Reboot; return true;
+    case MqttTopicId::FiltrationStartCommand:   out = MqttCommand::FiltrationStart; return true;
+    case MqttTopicId::FiltrationEndCommand:     out = MqttCommand::FiltrationEnd; return true;
+    case MqttTopicId::LightingScheduleCommand:  out = MqttCommand::LightingSchedule; return true;
+    case MqttTopicId::LightingStartCommand:     out = MqttCommand::LightingStart; return true;
+    case MqttTopicId::LightingEndCommand:       out = MqttCommand::LightingEnd; return true;
+    case MqttTopicId::BoostCommand:             out = MqttCommand::Boost; return true;
+    case MqttTopicId::InstallModeCommand:       out = MqttCommand::InstallMode; return true;
+    case MqttTopicId::FiltrationExternalStateCommand: out = MqttCommand::FiltrationExternalState; return true;
+    default: return false;
+  }
+}
+
+MqttCommandArgs parseMqttCommand(MqttCommand type, const char* payload) {
+  MqttCommandArgs a;
+  switch (type) {
+    case MqttCommand::FiltrationMode:
+      normalize(payload, a.text, sizeof(a.text), Case::Lower);
+      a.valid = oneOf(a.text, "auto", "manual", "force", "off");
+      break;
+    case MqttCommand::FiltrationOnOff:
+    case MqttCommand::Lighting:
+    case MqttCommand::LightingSchedule:
+    case MqttCommand::Boost:
+    case MqttCommand::FiltrationExternalState:
+      normalize(payload, a.text, sizeof(a.text), Case::Upper);
+      parseOnOff(a);
+      break;
+    case MqttCommand::PhTarget:
+      normalize(payload, a.text, sizeof(a.text), Case::Keep);
+      parseRange(a, 6.0f, 8.5f);
+      break;
+    case MqttCommand::OrpTarget:
+      normalize(payload, a.text, sizeof(a.text), Case::Keep);
+      parseRange(a, 400.0f, 900.0f);
+      break;
+    case MqttCommand::PhRegulationMode:
+    case MqttCommand::OrpRegulationMode:
+      normalize(payload, a.text, sizeof(a.text), Case::Lower);
+      a.valid = oneOf(a.text, "automatic", "scheduled", "manual");
+      break;
+    case MqttCommand::PhDailyTarget:
+    case MqttCommand::OrpDailyTarget:
+      normalize(payload, a.text, sizeof(a.text), Case::Keep);
+      parseDaily(a);
+      break;
+    case MqttCommand::Reboot:
+      normalize(payload, a.text, sizeof(a.text), Case::Keep);
+      a.valid = true;
+      break;
+    case MqttCommand::FiltrationStart:
+    case MqttCommand::FiltrationEnd:
+    case MqttCommand::LightingStart:
+    case MqttCommand::LightingEnd:
+      normalize(payload, a.text, sizeof(a.text), Case::Keep);
+      a.valid = timeStringToMinutes(a.text) >= 0;
+      break;
+    case MqttCommand::InstallMode:
+      // Mêmes chaînes que installModeToString() (config.h).
+      normalize(payload, a.text, sizeof(a.text), Case::Lower);
+      a.valid = oneOf(a.text, "managed", "powered", "external");
+      break;
+  }
+  return a;
+}
+
+bool mqttIsNumericPayload(const char* s) {
+  if (s == nullptr || *s == '\0') return false;
+  size_t i = (s[0] == '-' || s[0] == '+') ? 1u : 0u;
+  bool digitSeen = false;
+  for (; s[i] != '\0'; ++i) {
+    if (s[i] >= '0' && s[i] <= '9') { digitSeen = true; continue; }
+    if (s[i] == '.') continue;
+    return false;
+  }
+  return digitSeen;
+}
+
+bool mqttCommandWritesConfig(MqttCommand type) {
+  switch (type) {
+    case MqttCommand::Lighting:
+    case MqttCommand::Reboot:
+    case MqttCommand::Boost:
+    case MqttCommand::FiltrationExternalState:
+      return false;
+    default:
+      return true;
+  }
+}
+
+MqttCommandBatch::AddResult MqttCommandBatch::add(MqttCommand type, const char* payload) {
+  const size_t t = static_cast<size_t>(type);
+  if (t >= kMqttCommandCount) return AddResult::Ignored;
+  MqttCommandArgs args = parseMqttCommand(type, payload);
+
+  if (!_present[t]) {
+    _args[t] = args;
+    _present[t] = true;
+    _order[_count++] = static_cast<uint8_t>(t);
+    return AddResult::Added;
+  }
+
+  _coalesced++;
+  if (!args.valid && _args[t].valid) return AddResult::Ignored;
+  _args[t] = args;
+  // Déplacé en fin de lot : ordre de la dernière occurrence.
+  size_t i = 0;
+  while (_order[i] != t) ++i;
+  for (; i + 1 < _count; ++i) _order[i] = _order[i + 1];
+  _order[_count - 1] = static_cast<uint8_t>(t);
+  return AddResult::Coalesced;
+}
+
+void MqttCommandBatch::clear() {
+  for (size_t i = 0; i < _count; ++i) _present[_order[i]] = false;
+  _count = 0;
+}
@@ -0,0 +1,103 @@
+#ifndef MQTT_COMMANDS_H
+#define MQTT_COMMANDS_H
+
+// =============================================================================
+// mqtt_commands — Décodage des commandes Home Assistant, PURE
+// =============================================================================
+// Topic de commande → MqttCommand (messageCallback, mqttTask), puis payload →
+// arguments validés (drainCommandQueue, loopTask). Extrait de mqtt_manager.cpp
+// pour être testé en natif, y compris de bout en bout avec un broker simulé
+// (test_native_mqtt_pipeline).
+//
+// INVARIANT : reproduit EXACTEMENT la validation d'origine (trim, casse
+// normalisée, bornes des consignes, payload numérique strict des volumes,
+// HH:MM via timeStringToMinutes). Prise de configMutex, écriture de la config,
+// persistance et republication restent dans la coquille.
+//
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mqtt_topics.h"
+
+enum class MqttCommand : uint8_t {
+  FiltrationMode,    // payload = "auto"|"manual"|"force"|"off"
+  FiltrationOnOff,   // payload = "ON"|"OFF"
+  Lighting,          // payload = "ON"|"OFF"
+  PhTarget,          // payload = "7.2"
+  OrpTarget,         // payload = "650"
+  PhRegulationMode,  // payload = "automatic"|"scheduled"|"manual" (feature-009)
+  OrpRegulationMode, // payload = "automatic"|"scheduled"|"manual" (feature-009)
+  PhDailyTarget,     // payload = "150" (mL, entier — feature-050)
+  OrpDailyTarget,    // payload = "500" (mL, entier — feature-050)
+  Reboot,            // payload = "PRESS" (tout payload accepté — feature-050)
+  FiltrationStart,   // payload = "08:00" (HH:MM — feature-051)
+  FiltrationEnd,     // payload = "20:00" (HH:MM — feature-051)
+  LightingSchedule,  // payload = "ON"|"OFF" (feature-052)
+  LightingStart,     // payload = "20:00" (HH:MM — feature-052)
+  LightingEnd,       // payload = "23:00" (HH:MM — feature-052)
+  Boost,             // payload = "ON"|"OFF" (feature-053 : Mode Boost)
+  FiltrationExternalState,  // payload = "ON"|"OFF" (feature-056 : signal filtration externe)
+  InstallMode,       // payload = "managed"|"powered"|"external" (feature-056)
+};
+
+constexpr size_t kMqttCommandCount = static_cast<size_t>(MqttCommand::InstallMode) + 1;
+
+// Taille du payload transporté (InboundCmd), NUL compris.
+constexpr size_t kMqttCommandPayloadMax = 64;
+
+// Commande associée à un topic `.../set`. false pour tout autre topic.
+bool mqttCommandFor(MqttTopicId id, MqttCommand& out);
+
+// Payload décodé. `text` est le payload rogné, en minuscules pour les modes, en
+// majuscules pour ON/OFF (c'est la valeur écrite dans la config et loggée).
+struct MqttCommandArgs {
+  char text[kMqttCommandPayloadMax] = {};
+  bool valid = false;   // Conforme au type (sinon : warning + resync côté coquille)
+  bool on = false;      // Commandes ON/OFF
+  float number = 0.0f;  // PhTarget / OrpTarget
+  int integer = 0;      // Volumes quotidiens, négatif ramené à 0
+};
+
+MqttCommandArgs parseMqttCommand(MqttCommand type, const char* payload);
+
+// true si la commande modifie la config (configMutex + persistance NVS) ;
+// false pour les actions directes (éclairage manuel, boost, signal externe, reboot).
+bool mqttCommandWritesConfig(MqttCommand type);
+
+// -----------------------------------------------------------------------------
+// Lot de commandes drainées en une passe (drainCommandQueue)
+// -----------------------------------------------------------------------------
+// Une entrée par type : la dernière commande VALIDE reçue gagne. Une commande
+// invalide ne remplace pas une commande valide du même type déjà dans le lot
+// (appliquées une par une, la valide aurait été appliquée puis l'invalide
+// rejetée) ; seule, elle est conservée pour que la coquille logge et resynchronise.
+// Les entrées sont rendues dans l'ordre de réception de leur dernière occurrence.
+class MqttCommandBatch {
+public:
+  enum class AddResult : uint8_t { Added, Coalesced, Ignored };
+
+  AddResult add(MqttCommand type, const char* payload);
+  void clear();
+
+  size_t size() const { return _count; }
+  MqttCommand type(size_t i) const { return static_cast<MqttCommand>(_order[i]); }
+  const MqttCommandArgs& args(size_t i) const { return _args[_order[i]]; }
+
+  // Commandes remplacées ou ignorées depuis le boot (diagnostic).
+  uint32_t coalescedCount() const { return _coalesced; }
+
+private:
+  MqttCommandArgs _args[kMqttCommandCount];
+  uint8_t _order[kMqttCommandCount] = {};
+  bool _present[kMqttCommandCount] = {};
+  size_t _count = 0;
+  uint32_t _coalesced = 0;
+};
+
+// feature-050 : validation stricte d'un payload numérique. Accepte "150",
+// "150.0", "-5" (HA number publie str(float) → "150.0") ; refuse "", "abc", "12a".
+bool mqttIsNumericPayload(const char* s);
+
+#endif // MQTT_COMMANDS_H
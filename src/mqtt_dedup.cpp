@@ -0,0 +1,121 @@
+#include "mqtt_dedup.h"
+#include "mqtt_cadence.h"
+
+#include <string.h>
+
+// =============================================================================
+// mqtt_dedup — implémentation PURE
+// =============================================================================
+
+namespace {
+
+int32_t defaultDeadband(MqttTopicId id) {
+  switch (id) {
+    case MqttTopicId::PhState:
+    case MqttTopicId::PhRawState:
+    case MqttTopicId::PhMedianState:
+    case MqttTopicId::PhFilteredState:
+      return kMqttDeadbandPhMilli;
+    case MqttTopicId::OrpState:
+    case MqttTopicId::OrpRawState:
+    case MqttTopicId::OrpMedianState:
+    case MqttTopicId::OrpFilteredState:
+      return kMqttDeadbandOrpMv;
+    case MqttTopicId::TemperatureState:
+    case MqttTopicId::TemperatureCircuitState:
+      return kMqttDeadbandTempDeci;
+    default:
+      return 0;
+  }
+}
+
+}  // namespace
+
+uint32_t MqttDedup::textHash(const char* payload) {
+  const char* p = payload ? payload : "";
+  return mqttTopicHash(p, strlen(p));
+}
+
+MqttDedup::MqttDedup() {
+  for (size_t i = 0; i < kMqttTopicCount; ++i) {
+    _deadbands[i] = defaultDeadband(static_cast<MqttTopicId>(i));
+  }
+}
+
+bool MqttDedup::isDeduplicated(MqttTopicId id) {
+  switch (id) {
+    case MqttTopicId::Alerts:
+    case MqttTopicId::Logs:
+    case MqttTopicId::Status:
+    case MqttTopicId::Diagnostic:
+    case MqttTopicId::SensorHealth:
+    case MqttTopicId::AlertsCalibration:
+    case MqttTopicId::AlertsSensorStale:
+    case MqttTopicId::AlertsSensorFrozen:
+    case MqttTopicId::History:
+    case MqttTopicId::StateDocument:
+      return false;
+    default:
+      return id < MqttTopicId::Count && mqttTopicKind(id) == MqttTopicKind::State;
+  }
+}
+
+bool MqttDedup::_refreshDue(const Entry& e, uint32_t nowMs) const {
+  return nowMs - e.publishedMs >= kMqttDedupRefreshMs;
+}
+
+bool MqttDedup::valueDue(MqttTopicId id, int32_t value, uint32_t nowMs) const {
+  if (!isDeduplicated(id)) return true;
+  const size_t i = static_cast<size_t>(id);
+  const Entry& e = _entries[i];
+  if (e.kind != Kind::Value || _refreshDue(e, nowMs)) return true;
+
+  const int64_t delta = static_cast<int64_t>(value) - static_cast<int32_t>(e.key);
+  if (delta == 0) return false;
+  const int64_t band = _deadbands[i];
+  if (band > 0 && delta < band && -delta < band) return false;
+  return _cadence == nullptr || _cadence->due(id, delta, nowMs - e.publishedMs);
+}
+
+bool MqttDedup::textDue(MqttTopicId id, const char* payload, uint32_t nowMs) const {
+  if (!isDeduplicated(id)) return true;
+  const Entry& e = _entries[static_cast<size_t>(id)];
+  if (e.kind != Kind::Text || _refreshDue(e, nowMs)) return true;
+  return e.key != textHash(payload);
+}
+
+void MqttDedup::markValue(MqttTopicId id, int32_t value, uint32_t nowMs) {
+  if (!isDeduplicated(id)) return;
+  Entry& e = _entries[static_cast<size_t>(id)];
+  e.key = static_cast<uint32_t>(value);
+  e.publishedMs = nowMs;
+  e.kind = Kind::Value;
+}
+
+void MqttDedup::markText(MqttTopicId id, const char* payload, uint32_t nowMs) {
+  markTextHash(id, textHash(payload), nowMs);
+}
+
+void MqttDedup::markTextHash(MqttTopicId id, uint32_t hash, uint32_t nowMs) {
+  if (!isDeduplicated(id)) return;
+  Entry& e = _entries[static_cast<size_t>(id)];
+  e.key = hash;
+  e.publishedMs = nowMs;
+  e.kind = Kind::Text;
+}
+
+void MqttDedup::reset() {
+  for (size_t i = 0; i < kMqttTopicCount; ++i) {
+    _entries[i] = Entry();
+  }
+}
+
+void MqttDedup::setDeadband(MqttTopicId id, int32_t deadband) {
+  if (id >= MqttTopicId::Count) return;
+  _deadbands[static_cast<size_t>(id)] = deadband < 0 ? 0 : deadband;
+}
+
+int32_t MqttDedup::deadband(MqttTopicId id) const {
+  if (id >= MqttTopicId::Count) return 0;
+  return _deadbands[static_cast<size_t>(id)];
+}
@@ -0,0 +1,96 @@
+#ifndef MQTT_DEDUP_H
+#define MQTT_DEDUP_H
+
+// =============================================================================
+// mqtt_dedup — Publication « sur changement » des topics d'état MQTT, PURE
+// =============================================================================
+// Une entrée compacte par MqttTopicId (12 octets) mémorise la dernière valeur
+// PUBLIÉE : soit une valeur en virgule fixe (capteurs, volumes, compteurs),
+// soit le hash FNV-1a du payload texte (ON/OFF, modes, heures HH:MM).
+// Un topic n'est republié que si :
+//   - il n'a jamais été publié dans la session (reset() à chaque connexion) ;
+//   - la valeur a franchi la bande morte du topic (|Δ| ≥ deadband, unités de
+//     la virgule fixe ; deadband 0 = tout changement) ou le texte a changé ;
+//   - ou le rafraîchissement forcé kMqttDedupRefreshMs est échu (retain perdu
+//     côté broker, abonné arrivé sans retain…).
+// Si une cadence est attachée (setCadence, mqtt_cadence.h), un écart franchissant
+// la bande morte doit en plus être jugé dû par la cadence de la phase courante :
+// la bande morte sert alors de résolution, la bande immédiate de la cadence
+// déclenche la publication sans attendre.
+// Les topics événementiels (alerts, logs, status, diagnostic, history) et le
+// document d'état unique (dédupliqué champ par champ, mqtt_state_doc) sont en
+// pass-through : toujours dus, jamais mémorisés.
+//
+// La coquille mqtt_manager.cpp interroge valueDue()/textDue() avant publish et
+// ne valide (mark*) qu'après un publish réussi. mqttTask uniquement.
+//
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <stdint.h>
+#include "mqtt_topics.h"
+
+class MqttCadence;
+
+// Rafraîchissement forcé d'un topic inchangé.
+constexpr uint32_t kMqttDedupRefreshMs = 600000;  // 10 min
+
+// Bandes mortes par défaut, dans l'unité de la virgule fixe publiée.
+constexpr int32_t kMqttDeadbandPhMilli   = 10;  // pH ×1000 : 0,01 pH
+constexpr int32_t kMqttDeadbandOrpMv     = 3;   // ORP en mV
+constexpr int32_t kMqttDeadbandTempDeci  = 2;   // Température ×10 : 0,2 °C
+
+class MqttDedup {
+public:
+  MqttDedup();
+
+  // true si le topic doit être publié avec cette valeur / ce payload à `nowMs`.
+  bool valueDue(MqttTopicId id, int32_t value, uint32_t nowMs) const;
+  bool textDue(MqttTopicId id, const char* payload, uint32_t nowMs) const;
+
+  // Mémorise la valeur effectivement publiée (à appeler après succès).
+  void markValue(MqttTopicId id, int32_t value, uint32_t nowMs);
+  void markText(MqttTopicId id, const char* payload, uint32_t nowMs);
+  // Variante de markText quand seul le hash est conservé (textHash()).
+  void markTextHash(MqttTopicId id, uint32_t hash, uint32_t nowMs);
+
+  // Hash FNV-1a d'un payload texte, tel que mémorisé par markText().
+  static uint32_t textHash(const char* payload);
+
+  // Oublie toutes les valeurs publiées (nouvelle session broker). Conserve les
+  // bandes mortes et les compteurs.
+  void reset();
+
+  // Bande morte d'un topic (défauts : voir mqtt_dedup.cpp). Constantes de
+  // compilation côté firmware : setDeadband() ne sert qu'aux bancs natifs.
+  void setDeadband(MqttTopicId id, int32_t deadband);
+  int32_t deadband(MqttTopicId id) const;
+
+  // Cadence par phase de process (nullptr = bande morte seule). Non possédée.
+  void setCadence(const MqttCadence* cadence) { _cadence = cadence; }
+
+  // Topic soumis à la dédup (false = pass-through).
+  static bool isDeduplicated(MqttTopicId id);
+
+  // Compteur de publications évitées depuis le boot (diagnostic).
+  uint32_t suppressedCount() const { return _suppressed; }
+  void noteSuppressed() { _suppressed++; }
+
+private:
+  enum class Kind : uint8_t { Empty, Value, Text };
+
+  struct Entry {
+    uint32_t key = 0;         // Valeur (int32 reinterprété) ou hash du texte
+    uint32_t publishedMs = 0; // Instant de la dernière publication
+    Kind kind = Kind::Empty;
+  };
+
+  Entry _entries[kMqttTopicCount];
+  int32_t _deadbands[kMqttTopicCount];
+  uint32_t _suppressed = 0;
+  const MqttCadence* _cadence = nullptr;
+
+  bool _refreshDue(const Entry& e, uint32_t nowMs) const;
+};
+
+#endif // MQTT_DEDUP_H
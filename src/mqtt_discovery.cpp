@@ -0,0 +1,449 @@
+#include "mqtt_discovery.h"
+
+#include <string.h>
+#include "mqtt_state_doc.h"
+
+// =============================================================================
+// mqtt_discovery — implémentation PURE
+// =============================================================================
+
+namespace {
+
+constexpr MqttTopicId kNone = MqttTopicId::Count;
+
+// Constructeurs de lignes : un par forme d'entité, champs inutilisés à nullptr.
+constexpr HaEntity sensor(const char* obj, const char* name, MqttTopicId st, const char* unit,
+                          const char* icon, bool measurement = false,
+                          const char* deviceClass = nullptr) {
+  return HaEntity{HaComponent::Sensor, obj, name, st, kNone, HaPayloads::None, deviceClass,
+                  unit, icon, measurement, nullptr, nullptr, nullptr, nullptr, nullptr,
+                  nullptr, nullptr, false};
+}
+
+constexpr HaEntity binarySensor(const char* obj, const char* name, MqttTopicId st,
+                                const char* icon, const char* deviceClass = nullptr,
+                                HaPayloads payloads = HaPayloads::OnOff) {
+  return HaEntity{HaComponent::BinarySensor, obj, name, st, kNone, payloads, deviceClass,
+                  nullptr, icon, false, nullptr, nullptr, nullptr, nullptr, nullptr,
+                  nullptr, nullptr, false};
+}
+
+// st = kNone : switch optimiste (assumed_state côté HA).
+constexpr HaEntity switchEntity(const char* obj, const char* name, MqttTopicId st,
+                                MqttTopicId cmd, const char* icon) {
+  return HaEntity{HaComponent::Switch, obj, name, st, cmd,
+                  st == kNone ? HaPayloads::OnOff : HaPayloads::OnOffState, nullptr, nullptr,
+                  icon, false, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                  false};
+}
+
+constexpr HaEntity select(const char* obj, const char* name, MqttTopicId st, MqttTopicId cmd,
+                          const char* icon, const char* options, const char* valueTpl,
+                          const char* commandTpl) {
+  return HaEntity{HaComponent::Select, obj, name, st, cmd, HaPayloads::None, nullptr, nullptr,
+                  icon, false, options, valueTpl, commandTpl, nullptr, nullptr, nullptr,
+                  nullptr, false};
+}
+
+// Heure éditable HH:MM (5 caractères exactement).
+constexpr HaEntity timeText(const char* obj, const char* name, MqttTopicId st, MqttTopicId cmd,
+                            const char* icon) {
+  return HaEntity{HaComponent::Text, obj, name, st, cmd, HaPayloads::None, nullptr, nullptr,
+                  icon, false, nullptr, nullptr, nullptr, "5", "5", nullptr,
+                  "^([01][0-9]|2[0-3]):[0-5][0-9]$", false};
+}
+
+constexpr HaEntity number(const char* obj, const char* name, MqttTopicId st, MqttTopicId cmd,
+                          const char* min, const char* max, const char* step, const char* unit,
+                          const char* icon, bool boxMode = false) {
+  return HaEntity{HaComponent::Number, obj, name, st, cmd, HaPayloads::None, nullptr, unit,
+                  icon, false, nullptr, nullptr, nullptr, min, max, step, nullptr, boxMode};
+}
+
+constexpr HaEntity button(const char* obj, const char* name, MqttTopicId cmd,
+                          const char* deviceClass) {
+  return HaEntity{HaComponent::Button, obj, name, kNone, cmd, HaPayloads::Press, deviceClass,
+                  nullptr, nullptr, false, nullptr, nullptr, nullptr, nullptr, nullptr,
+                  nullptr, nullptr, false};
+}
+
+// Ancienne entité à retirer de HA : config retain vide.
+constexpr HaEntity removed(HaComponent component, const char* obj) {
+  return HaEntity{component, obj, nullptr, kNone, kNone, HaPayloads::None, nullptr, nullptr,
+                  nullptr, false, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                  nullptr, false};
+}
+
+using T = MqttTopicId;
+
+}  // namespace
+
+// Ordre = ordre de publication. Ajouter une entité = une ligne ; le hash
+// inclut le topic de config, un réordonnancement republie simplement la table.
+const HaEntity kHaEntities[] = {
+  sensor("temperature", "Piscine Température", T::TemperatureState, "°C", nullptr, true, "temperature"),
+  // feature-020 : 2ᵉ sonde DS18B20 sur PCB v2
+  sensor("temperature_circuit", "Piscine Température Circuit", T::TemperatureCircuitState, "°C",
+         "mdi:chip", true, "temperature"),
+  sensor("ph", "Piscine pH", T::PhState, "pH", "mdi:water", true),
+  sensor("orp", "Piscine ORP", T::OrpState, "mV", "mdi:flash", true),
+  binarySensor("filtration", "Filtration Active", T::FiltrationState, "mdi:water-pump", "running"),
+
+  // bug-ha-filtration-mode-labels : libellés français dans HA, protocole MQTT
+  // inchangé sur le fil (auto/manual/force/off). manual = « Programmation »
+  // (créneau à heures fixées), force = « Manuel » (ON/OFF sans planning).
+  select("filtration_mode", "Mode Filtration", T::FiltrationModeState, T::FiltrationModeCommand,
+         "mdi:water-pump", "Auto|Programmation|Manuel|Désactivé",
+         "{{ {'auto':'Auto','manual':'Programmation','force':'Manuel','off':'Désactivé'}.get(value, value) }}",
+         "{{ {'Auto':'auto','Programmation':'manual','Manuel':'force','Désactivé':'off'}[value] }}"),
+  // feature-051 : heures de filtration (effet réel en mode Programmation)
+  timeText("filtration_start", "Filtration début", T::FiltrationStartState,
+           T::FiltrationStartCommand, "mdi:clock-start"),
+  timeText("filtration_end", "Filtration fin", T::FiltrationEndState, T::FiltrationEndCommand,
+           "mdi:clock-end"),
+
+  // bug-ha-regulation-mode-labels : libellés français (automatic/scheduled/manual sur le fil)
+  select("ph_regulation_mode", "Mode Régulation pH", T::PhRegulationModeState,
+         T::PhRegulationModeCommand, "mdi:ph", "Automatique|Programmée|Manuelle",
+         "{{ {'automatic':'Automatique','scheduled':'Programmée','manual':'Manuelle'}.get(value, value) }}",
+         "{{ {'Automatique':'automatic','Programmée':'scheduled','Manuelle':'manual'}[value] }}"),
+  select("orp_regulation_mode", "Mode Régulation ORP", T::OrpRegulationModeState,
+         T::OrpRegulationModeCommand, "mdi:flash", "Automatique|Programmée|Manuelle",
+         "{{ {'automatic':'Automatique','scheduled':'Programmée','manual':'Manuelle'}.get(value, value) }}",
+         "{{ {'Automatique':'automatic','Programmée':'scheduled','Manuelle':'manual'}[value] }}"),
+
+  switchEntity("filtration_switch", "Filtration Marche/Arrêt", T::FiltrationState,
+               T::FiltrationCommand, "mdi:water-pump"),
+  switchEntity("lighting", "Éclairage Piscine", T::LightingState, T::LightingCommand, "mdi:pool"),
+  // feature-053 : Mode Boost (surchloration du jour, auto-off à minuit)
+  switchEntity("boost", "Boost", T::BoostState, T::BoostCommand, "mdi:rocket-launch"),
+
+  // feature-056 : mode d'installation (managed/powered/external sur le fil)
+  select("install_mode", "Mode d'installation", T::InstallModeState, T::InstallModeCommand,
+         "mdi:pipe-valve", "PoolController pilote|Alimenté par filtration|Filtration externe",
+         "{{ {'managed':'PoolController pilote','powered':'Alimenté par filtration','external':'Filtration externe'}.get(value, value) }}",
+         "{{ {'PoolController pilote':'managed','Alimenté par filtration':'powered','Filtration externe':'external'}[value] }}"),
+  // feature-056 : signal d'état de la filtration EXTERNE, switch optimiste
+  // (une automation HA signale l'état réel ; garde présence d'eau côté contrôleur).
+  switchEntity("filtration_external", "Signal filtration externe", kNone,
+               T::FiltrationExternalStateCommand, "mdi:water-sync"),
+
+  // bug-ha-eclairage-select : l'ancien switch feature-052 est retiré de HA,
+  // remplacé par un select Programmation/Désactivé (ON/OFF sur le fil).
+  removed(HaComponent::Switch, "lighting_schedule"),
+  select("lighting_schedule", "Mode Éclairage", T::LightingScheduleState,
+         T::LightingScheduleCommand, "mdi:calendar-clock", "Programmation|Désactivé",
+         "{{ {'ON':'Programmation','OFF':'Désactivé'}.get(value, value) }}",
+         "{{ {'Programmation':'ON','Désactivé':'OFF'}[value] }}"),
+  // feature-052 : heures d'éclairage
+  timeText("lighting_start", "Éclairage début", T::LightingStartState, T::LightingStartCommand,
+           "mdi:clock-start"),
+  timeText("lighting_end", "Éclairage fin", T::LightingEndState, T::LightingEndCommand,
+           "mdi:clock-end"),
+
+  binarySensor("ph_dosing", "Dosage pH Actif", T::PhDosingState, "mdi:water-plus"),
+  binarySensor("orp_dosing", "Dosage Chlore Actif", T::OrpDosingState, "mdi:flask"),
+  binarySensor("ph_limit", "Limite Journalière pH", T::PhLimitState, "mdi:alert", "problem"),
+  binarySensor("orp_limit", "Limite Journalière Chlore", T::OrpLimitState, "mdi:alert", "problem"),
+  // feature-022 : problème capteur (stale OU figé)
+  binarySensor("ph_sensor_problem", "Capteur pH — problème", T::PhSensorProblemState,
+               "mdi:alert", "problem"),
+  binarySensor("orp_sensor_problem", "Capteur ORP — problème", T::OrpSensorProblemState,
+               "mdi:alert", "problem"),
+  binarySensor("ph_stock_low", "Stock pH Faible", T::PhStockLowState,
+               "mdi:bottle-tonic-outline", "problem"),
+  binarySensor("orp_stock_low", "Stock Chlore Faible", T::OrpStockLowState,
+               "mdi:bottle-tonic-outline", "problem"),
+  sensor("ph_remaining", "Volume pH Restant", T::PhRemainingState, "mL", "mdi:cup-water"),
+  sensor("orp_remaining", "Volume Chlore Restant", T::OrpRemainingState, "mL", "mdi:cup-water"),
+  // feature-050 : cumuls injectés du jour (retombent à 0 à minuit)
+  sensor("ph_daily_ml", "Dosage pH aujourd'hui", T::PhDailyMlState, "mL", "mdi:beaker-outline", true),
+  sensor("orp_daily_ml", "Dosage Chlore aujourd'hui", T::OrpDailyMlState, "mL",
+         "mdi:beaker-outline", true),
+
+  number("ph_target", "Consigne pH", T::PhTargetState, T::PhTargetCommand, "6.0", "8.5", "0.1",
+         "pH", "mdi:water"),
+  number("orp_target", "Consigne ORP", T::OrpTargetState, T::OrpTargetCommand, "400", "900", "10",
+         "mV", "mdi:flash"),
+  // feature-050 : volumes quotidiens programmés. Borne haute discovery 2000 mL ;
+  // la limite vive maxPh/OrpMlPerDay est revalidée au drain de la commande.
+  number("ph_daily_target", "Volume quotidien pH", T::PhDailyTargetMlState,
+         T::PhDailyTargetMlCommand, "0", "2000", "10", "mL", "mdi:beaker-plus-outline", true),
+  number("orp_daily_target", "Volume quotidien Chlore", T::OrpDailyTargetMlState,
+         T::OrpDailyTargetMlCommand, "0", "2000", "10", "mL", "mdi:beaker-plus-outline", true),
+  // feature-050 : redémarrage (séquence propre — cf. drainCommandQueue)
+  button("reboot", "Redémarrer", T::RebootCommand, "restart"),
+
+  binarySensor("status", "Contrôleur Status", T::Status, "mdi:wifi-check", "connectivity",
+               HaPayloads::OnlineOffline),
+
+  // feature-021 : points de calibration EZO (-1 = EZO injoignable)
+  sensor("ph_cal_points", "Piscine pH Points Calibrés", T::PhCalPointsState, nullptr, "mdi:numeric"),
+  sensor("orp_cal_points", "Piscine ORP Points Calibrés", T::OrpCalPointsState, nullptr, "mdi:numeric"),
+  // feature-024 : pente sonde pH (idéal 100 % / 0 mV)
+  sensor("ph_slope_acid", "Piscine pH Pente Acide", T::PhSlopeAcidState, "%", "mdi:angle-acute", true),
+  sensor("ph_slope_base", "Piscine pH Pente Base", T::PhSlopeBaseState, "%", "mdi:angle-obtuse", true),
+  sensor("ph_slope_zero", "Piscine pH Décalage Zéro", T::PhSlopeZeroState, "mV", "mdi:sine-wave", true),
+  // feature-025 : chaîne de filtrage (brut = diagnostic EMI, filtré = régulation)
+  sensor("ph_raw", "Piscine pH Brut", T::PhRawState, "pH", "mdi:water-outline", true),
+  sensor("ph_filtered", "Piscine pH Filtré", T::PhFilteredState, "pH", "mdi:water-check", true),
+  sensor("orp_raw", "Piscine ORP Brut", T::OrpRawState, "mV", "mdi:flash-outline", true),
+  sensor("orp_filtered", "Piscine ORP Filtré", T::OrpFilteredState, "mV", "mdi:flash-alert", true),
+  binarySensor("ph_filter_ready", "Piscine Filtre pH Prêt", T::PhFilterReadyState, "mdi:filter-check"),
+  binarySensor("orp_filter_ready", "Piscine Filtre ORP Prêt", T::OrpFilterReadyState, "mdi:filter-check"),
+};
+
+const size_t kHaEntityCount = sizeof(kHaEntities) / sizeof(kHaEntities[0]);
+
+static_assert(sizeof(kHaEntities) / sizeof(kHaEntities[0]) <= HaDiscoveryCache::kSlots,
+              "HaDiscoveryCache::kSlots trop petit pour kHaEntities");
+
+// -----------------------------------------------------------------------------
+// Sérialisation
+// -----------------------------------------------------------------------------
+
+namespace {
+
+const char* componentName(HaComponent c) {
+  switch (c) {
+    case HaComponent::Sensor:       return "sensor";
+    case HaComponent::BinarySensor: return "binary_sensor";
+    case HaComponent::Switch:       return "switch";
+    case HaComponent::Select:       return "select";
+    case HaComponent::Text:         return "text";
+    case HaComponent::Number:       return "number";
+    case HaComponent::Button:       return "button";
+  }
+  return "sensor";
+}
+
+// Écriture bornée dans un tampon, une place toujours réservée au NUL.
+class Writer {
+public:
+  Writer(char* buf, size_t cap) : _buf(buf), _cap(cap) {
+    if (_cap == 0) _overflow = true;
+    else _buf[0] = '\0';
+  }
+
+  void put(char c) {
+    if (_overflow || _len + 1 >= _cap) {
+      _overflow = true;
+      return;
+    }
+    _buf[_len++] = c;
+    _buf[_len] = '\0';
+  }
+  void raw(const char* s) {
+    while (*s != '\0' && !_overflow) put(*s++);
+  }
+  void escaped(const char* s) {
+    static const char kHex[] = "0123456789abcdef";
+    for (; *s != '\0' && !_overflow; ++s) {
+      const unsigned char u = static_cast<unsigned char>(*s);
+      if (u == '"' || u == '\\') {
+        put('\\');
+        put(static_cast<char>(u));
+      } else if (u < 0x20) {
+        raw("\\u00");
+        put(kHex[u >> 4]);
+        put(kHex[u & 0x0F]);
+      } else {
+        put(static_cast<char>(u));
+      }
+    }
+  }
+
+  // "clé":
+  void key(const char* k) {
+    if (!_first) put(',');
+    _first = false;
+    put('"');
+    raw(k);
+    raw("\":");
+  }
+  void str(const char* k, const char* v) {
+    if (v == nullptr) return;
+    key(k);
+    put('"');
+    escaped(v);
+    put('"');
+  }
+  // Valeur JSON littérale (nombre, booléen).
+  void lit(const char* k, const char* v) {
+    if (v == nullptr) return;
+    key(k);
+    raw(v);
+  }
+  void open() { put('{'); _first = true; }
+  void close() { put('}'); _first = false; }
+
+  size_t length() const { return _overflow ? 0 : _len; }
+
+private:
+  char* _buf;
+  size_t _cap;
+  size_t _len = 0;
+  bool _overflow = false;
+  bool _first = true;
+};
+
+}  // namespace
+
+size_t haDiscoveryTopic(const HaEntity& e, const HaDiscoveryContext& ctx, char* out, size_t cap) {
+  Writer w(out, cap);
+  w.raw(ctx.prefix);
+  w.put('/');
+  w.raw(componentName(e.component));
+  w.put('/');
+  w.raw(ctx.deviceId);
+  w.put('_');
+  w.raw(e.objectId);
+  w.raw("/config");
+  return w.length();
+}
+
+size_t haDiscoveryPayload(const HaEntity& e, const HaDiscoveryContext& ctx, char* out, size_t cap) {
+  if (e.name == nullptr) {
+    // Entité retirée : config retain vide (HA supprime l'entité).
+    if (cap == 0) return 0;
+    out[0] = '\0';
+    return 0;
+  }
+
+  Writer w(out, cap);
+  w.open();
+  w.str("name", e.name);
+  w.key("unique_id");
+  w.put('"');
+  w.raw(ctx.deviceId);
+  w.put('_');
+  w.raw(e.objectId);
+  w.put('"');
+
+  if (e.state != MqttTopicId::Count) {
+    // Mode document d'état : l'entité lit sa clé dans {base}/state (champs du
+    // document uniquement — la disponibilité reste sur {base}/status). Les
+    // selects extraient d'abord `value`, leur template de libellés s'applique
+    // ensuite tel quel. default('') : clé absente (NaN omis) ignorée par HA.
+    const bool fromDoc = ctx.stateJson && MqttStateDoc::isDocumentField(e.state);
+    w.str("state_topic", ctx.topics->get(fromDoc ? MqttTopicId::StateDocument : e.state));
+    if (fromDoc) {
+      w.key("value_template");
+      w.put('"');
+      w.raw(e.valueTemplate ? "{% set value = value_json." : "{{ value_json.");
+      w.raw(mqttTopicSuffix(e.state));
+      w.raw(e.valueTemplate ? " | default('') %}" : " | default('') }}");
+      if (e.valueTemplate) w.escaped(e.valueTemplate);
+      w.put('"');
+    } else {
+      w.str("value_template", e.valueTemplate);
+    }
+  }
+  if (e.command != MqttTopicId::Count) {
+    w.str("command_topic", ctx.topics->get(e.command));
+  }
+  w.str("command_template", e.commandTemplate);
+  w.str("device_class", e.deviceClass);
+  w.str("unit_of_measurement", e.unit);
+  if (e.measurement) w.str("state_class", "measurement");
+  w.str("icon", e.icon);
+
+  switch (e.payloads) {
+    case HaPayloads::OnOff:
+      w.str("payload_on", "ON");
+      w.str("payload_off", "OFF");
+      break;
+    case HaPayloads::OnOffState:
+      w.str("payload_on", "ON");
+      w.str("payload_off", "OFF");
+      w.str("state_on", "ON");
+      w.str("state_off", "OFF");
+      break;
+    case HaPayloads::OnlineOffline:
+      w.str("payload_on", "online");
+      w.str("payload_off", "offline");
+      break;
+    case HaPayloads::Press:
+      w.str("payload_press", "PRESS");
+      break;
+    case HaPayloads::None:
+      break;
+  }
+  if (e.component == HaComponent::Switch && e.state == MqttTopicId::Count) {
+    w.lit("optimistic", "true");
+  }
+
+  if (e.options != nullptr) {
+    w.key("options");
+    w.put('[');
+    w.put('"');
+    for (const char* p = e.options; *p != '\0'; ++p) {
+      if (*p == '|') {
+        w.raw("\",\"");
+      } else {
+        const char one[2] = {*p, '\0'};
+        w.escaped(one);
+      }
+    }
+    w.put('"');
+    w.put(']');
+  }
+  w.str("pattern", e.pattern);
+  w.lit("min", e.min);
+  w.lit("max", e.max);
+  w.lit("step", e.step);
+  if (e.boxMode) w.str("mode", "box");
+
+  w.key("device");
+  w.open();
+  w.str("name", ctx.deviceName);
+  w.str("manufacturer", "ESP32");
+  w.str("model", "Pool Controller");
+  w.key("identifiers");
+  w.put('[');
+  w.put('"');
+  w.escaped(ctx.deviceId);
+  w.put('"');
+  w.put(']');
+  w.close();
+
+  w.close();
+  return w.length();
+}
+
+uint32_t haDiscoveryHash(const char* topic, const char* payload) {
+  // FNV-1a 32 bits sur topic, séparateur NUL, payload.
+  uint32_t h = 2166136261u;
+  for (const char* p = topic; *p != '\0'; ++p) {
+    h ^= static_cast<uint8_t>(*p);
+    h *= 16777619u;
+  }
+  h *= 16777619u;  // séparateur (octet 0)
+  for (const char* p = payload; *p != '\0'; ++p) {
+    h ^= static_cast<uint8_t>(*p);
+    h *= 16777619u;
+  }
+  return h == 0 ? 1 : h;
+}
+
+// -----------------------------------------------------------------------------
+// Cache des hashes publiés
+// -----------------------------------------------------------------------------
+
+void HaDiscoveryCache::markPublished(size_t i, uint32_t hash) {
+  if (i >= kSlots || _hashes[i] == hash) return;
+  _hashes[i] = hash;
+  _dirty = true;
+}
+
+void HaDiscoveryCache::invalidate() {
+  for (size_t i = 0; i < kSlots; ++i) _hashes[i] = 0;
+  _dirty = true;
+}
+
+bool HaDiscoveryCache::load(const void* blob, size_t len) {
+  if (blob == nullptr || len != dataSize()) return false;
+  memcpy(_hashes, blob, dataSize());
+  _dirty = false;
+  return true;
+}
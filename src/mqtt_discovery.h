@@ -0,0 +1,123 @@
+#ifndef MQTT_DISCOVERY_H
+#define MQTT_DISCOVERY_H
+
+// =============================================================================
+// mqtt_discovery — Auto-discovery Home Assistant incrémentale, PURE
+// =============================================================================
+// Les entités HA sont décrites par une table statique (kHaEntities, dans
+// mqtt_discovery.cpp) au lieu de ~46 blocs JsonDocument codés à la main.
+// Pour chaque entrée :
+//   - haDiscoveryTopic()   : homeassistant/<composant>/<device>_<objet>/config
+//   - haDiscoveryPayload() : JSON compact écrit en flux dans un tampon fourni
+//                            (ni JsonDocument ni String) ;
+//   - haDiscoveryHash()    : FNV-1a topic + payload.
+// HaDiscoveryCache mémorise le hash du dernier payload PUBLIÉ par entité ; la
+// coquille (mqtt_manager.cpp) le persiste en NVS. Après une reconnexion, seules
+// les entités dont le payload a changé (base de topic, mode document d'état,
+// nouvelle version du firmware…) sont republiées, et la passe est étalée sur
+// plusieurs itérations de mqttTask (voir docs/subsystems/mqtt-manager.md).
+//
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mqtt_topics.h"
+
+// Topic de config le plus long + NUL (préfixe, composant, device, objet).
+constexpr size_t kHaDiscoveryTopicMax = 96;
+// Payload de config le plus long + NUL — vérifié pour toutes les entités, base
+// de topic maximale et mode document d'état (test_native_mqtt_discovery).
+constexpr size_t kHaDiscoveryPayloadMax = 896;
+// Passe étalée : publications et sérialisations par itération de mqttTask.
+constexpr size_t kHaDiscoveryPublishBurst = 2;
+constexpr size_t kHaDiscoveryEvalBurst = 16;
+
+enum class HaComponent : uint8_t {
+  Sensor,
+  BinarySensor,
+  Switch,
+  Select,
+  Text,
+  Number,
+  Button,
+};
+
+// Paires de payloads des entités binaires / boutons.
+enum class HaPayloads : uint8_t {
+  None,
+  OnOff,          // payload_on/off "ON"/"OFF" (binary_sensor, switch optimiste)
+  OnOffState,     // + state_on/off "ON"/"OFF" (switch avec retour d'état)
+  OnlineOffline,  // payload_on/off "online"/"offline" (disponibilité)
+  Press,          // payload_press "PRESS" (button)
+};
+
+struct HaEntity {
+  HaComponent component;
+  const char* objectId;        // Suffixe de unique_id et du topic de config
+  const char* name;            // nullptr : entité retirée (config vide publiée)
+  MqttTopicId state;           // Count : pas de state_topic (switch optimiste)
+  MqttTopicId command;         // Count : entité en lecture seule
+  HaPayloads payloads;
+  const char* deviceClass;
+  const char* unit;
+  const char* icon;
+  bool measurement;            // state_class "measurement"
+  const char* options;         // select : libellés séparés par '|'
+  const char* valueTemplate;   // select : traduction état brut → libellé
+  const char* commandTemplate; // select : traduction libellé → commande brute
+  const char* min;             // number (valeur) / text (longueur), littéral JSON
+  const char* max;
+  const char* step;
+  const char* pattern;         // text : regex de validation
+  bool boxMode;                // number : champ de saisie ("mode":"box")
+};
+
+extern const HaEntity kHaEntities[];
+extern const size_t kHaEntityCount;
+
+// Contexte de sérialisation : topics résolus, mode document d'état, device.
+struct HaDiscoveryContext {
+  const MqttTopicTable* topics;
+  bool stateJson;
+  const char* prefix;          // "homeassistant"
+  const char* deviceId;        // "poolcontroller"
+  const char* deviceName;      // "Pool Controller"
+};
+
+// Topic de config de `e`. Retourne la longueur, 0 si `cap` insuffisant.
+size_t haDiscoveryTopic(const HaEntity& e, const HaDiscoveryContext& ctx, char* out, size_t cap);
+// Payload JSON de `e` ("" pour une entité retirée). Retourne la longueur,
+// 0 si `cap` insuffisant (out reste une chaîne valide tronquée).
+size_t haDiscoveryPayload(const HaEntity& e, const HaDiscoveryContext& ctx, char* out, size_t cap);
+// Empreinte d'une config (topic + payload) ; jamais 0 (0 = « non publiée »).
+uint32_t haDiscoveryHash(const char* topic, const char* payload);
+
+class HaDiscoveryCache {
+public:
+  static constexpr size_t kSlots = 64;
+
+  HaDiscoveryCache() { invalidate(); }
+
+  // true si l'entité `i` a déjà été publiée avec ce hash.
+  bool isPublished(size_t i, uint32_t hash) const {
+    return i < kSlots && hash != 0 && _hashes[i] == hash;
+  }
+  void markPublished(size_t i, uint32_t hash);
+  // Tout republier (HA redémarré : birth message homeassistant/status).
+  void invalidate();
+
+  // Image persistée (NVS) : kSlots hashes. load() refuse une taille différente.
+  const uint32_t* data() const { return _hashes; }
+  static constexpr size_t dataSize() { return sizeof(uint32_t) * kSlots; }
+  bool load(const void* blob, size_t len);
+
+  bool dirty() const { return _dirty; }
+  void clearDirty() { _dirty = false; }
+
+private:
+  uint32_t _hashes[kSlots];
+  bool _dirty = false;
+};
+
+#endif // MQTT_DISCOVERY_H
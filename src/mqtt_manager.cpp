@@ -8,17 +8,30 @@
 #include "version.h"
 #include "pump_controller.h"
 #include "ws_manager.h"  // feature bug-sync-ws-config : notifier l'UI d'un changement config via MQTT
-#include "schedule_logic.h"  // feature-051 : validation HH:MM (timeStringToMinutes)
+#include "mqtt_commands.h"
+#include "fixed_format.h"
 #include <ArduinoJson.h>
+#include <LittleFS.h>
+#include <Preferences.h>
 #include <esp_task_wdt.h>
 #include <WiFi.h>
 #include <lwip/sockets.h>
 #include <errno.h>
 
-using mqtt_internal::OutboundMsg;
 using mqtt_internal::InboundCmd;
 using mqtt_internal::InboundCmdType;
 
+// Le document d'état (mqtt_state_doc.h) + en-tête MQTT + topic doivent tenir
+// dans le tampon PubSubClient du mode document.
+static_assert(kMqttStateDocBufferSize >= kMqttStateDocMax + 5 + 2 + kMqttMaxBaseLen + sizeof("/state"),
+              "kMqttStateDocBufferSize trop petit pour kMqttStateDocMax");
+// Idem pour la plus longue config discovery HA dans le tampon nominal.
+static_assert(kMqttBufferSize >= kHaDiscoveryPayloadMax + 5 + 2 + kHaDiscoveryTopicMax,
+              "kMqttBufferSize trop petit pour kHaDiscoveryPayloadMax");
+// Et pour le plus gros record du pool sortant (diagnostic), topic applicatif compris.
+static_assert(kMqttBufferSize >= kMqttSlabPayloadMax + 5 + 2 + kHaDiscoveryTopicMax,
+              "kMqttBufferSize trop petit pour kMqttSlabPayloadMax");
+
 namespace {
 // feature-027 : warn throttlé (max 1/min par site — lastWarnMs = statique locale du site)
 // sur timeout de prise du configMutex.
@@ -30,25 +43,204 @@ void warnConfigMutexTimeout(unsigned long& lastWarnMs, const char* site) {
   }
 }
 
-// feature-050 : validation stricte d'un payload numérique (pattern 009 : payload
-// vide/texte → warning + ignore côté appelant). Accepte "150", "150.0", "-5"
-// (HA number publie str(float) → "150.0") ; refuse "", "abc", "12a".
-bool isNumericPayload(const String& s) {
-  if (s.length() == 0) return false;
-  unsigned int i = (s[0] == '-' || s[0] == '+') ? 1u : 0u;
-  bool digitSeen = false;
-  for (; i < s.length(); ++i) {
-    if (s[i] >= '0' && s[i] <= '9') { digitSeen = true; continue; }
-    if (s[i] == '.') continue;
+
+// Spill flash de la boîte d'envoi (mqtt_outbox.h) : fichier LittleFS en ajout
+// seul, rejoué depuis une position de lecture en RAM, supprimé une fois vidé.
+// En-tête de fichier : "MQOB", version, nombre de topics (un firmware dont la
+// table MQTT_TOPIC_LIST diffère ignore le fichier au lieu de mal router).
+// Record : en-tête kMqttOutboxRecordHeaderBytes (flags = classe | retain<<7) + payload.
+// Un reboot pendant le rejeu rejoue le fichier depuis le début (au moins une fois).
+// mqttTask uniquement (begin() depuis loopTask avant la création de la tâche).
+class LittleFsSpillStore : public MqttSpillStore {
+public:
+  void begin() {
+    _size = 0;
+    _readPos = 0;
+    _lastSeq = 0;
+    _cached = false;
+    if (!LittleFS.exists(kPath)) return;
+
+    File f = LittleFS.open(kPath, "r");
+    if (!f) return;
+    uint8_t hdr[kFileHeaderBytes];
+    bool ok = f.read(hdr, sizeof(hdr)) == sizeof(hdr) && memcmp(hdr, kMagic, 4) == 0 &&
+              hdr[4] == kVersion && hdr[5] == kMqttTopicCount;
+    size_t pos = kFileHeaderBytes;
+    size_t pending = 0;
+    const size_t fileSize = f.size();
+    MqttOutboxRecord rec;
+    while (ok && pos < fileSize) {
+      if (!readRecordAt(f, pos, rec)) { ok = false; break; }
+      pos += rec.storedSize();
+      _lastSeq = rec.seq;
+      pending++;
+    }
+    f.close();
+
+    if (!ok) {
+      // En-tête étranger ou record tronqué (coupure pendant une écriture).
+      LittleFS.remove(kPath);
+      _lastSeq = 0;
+      systemLogger.warning("MQTT: spill outbox illisible — fichier supprimé");
+      return;
+    }
+    _size = fileSize;
+    _readPos = kFileHeaderBytes;
+    if (pending > 0) {
+      systemLogger.info("MQTT: " + String(pending) + " message(s) hors-ligne en attente de rejeu");
+    }
+  }
+
+  bool append(const MqttOutboxRecord& rec) override {
+    bool fresh = _size == 0;
+    File f = LittleFS.open(kPath, fresh ? "w" : "a");
+    if (!f) return false;
+    bool ok = true;
+    if (fresh) {
+      uint8_t hdr[kFileHeaderBytes] = {kMagic[0], kMagic[1], kMagic[2], kMagic[3],
+                                       kVersion, static_cast<uint8_t>(kMqttTopicCount), 0, 0};
+      ok = f.write(hdr, sizeof(hdr)) == sizeof(hdr);
+    }
+    uint8_t rh[kMqttOutboxRecordHeaderBytes];
+    memcpy(rh, &rec.seq, 4);
+    memcpy(rh + 4, &rec.epoch, 4);
+    rh[8] = static_cast<uint8_t>(rec.topic);
+    rh[9] = static_cast<uint8_t>(rec.cls) | (rec.retain ? 0x80 : 0x00);
+    memcpy(rh + 10, &rec.len, 2);
+    ok = ok && f.write(rh, sizeof(rh)) == sizeof(rh);
+    ok = ok && f.write(reinterpret_cast<const uint8_t*>(rec.payload), rec.len) == rec.len;
+    f.close();
+    if (!ok) {
+      // Écriture partielle (FS plein) : le fichier n'est plus relisible.
+      clear();
+      return false;
+    }
+    if (fresh) {
+      _size = kFileHeaderBytes;
+      _readPos = kFileHeaderBytes;
+    }
+    _size += rec.storedSize();
+    _lastSeq = rec.seq;
+    return true;
+  }
+
+  bool peek(MqttOutboxRecord& out) override {
+    if (empty()) return false;
+    if (!_cached) {
+      File f = LittleFS.open(kPath, "r");
+      bool ok = f && readRecordAt(f, _readPos, _cache);
+      if (f) f.close();
+      if (!ok) {
+        systemLogger.warning("MQTT: lecture spill outbox impossible — fichier supprimé");
+        clear();
+        return false;
+      }
+      _cached = true;
+    }
+    out = _cache;
+    return true;
+  }
+
+  void pop() override {
+    if (!_cached && !peek(_cache)) return;
+    _readPos += _cache.storedSize();
+    _cached = false;
+    if (_readPos >= _size) clear();
+  }
+
+  bool empty() const override { return _readPos >= _size; }
+  size_t usedBytes() const override { return _size; }
+  uint32_t lastSeq() const override { return _lastSeq; }
+
+private:
+  static constexpr const char* kPath = "/mqtt_outbox.bin";
+  static constexpr uint8_t kMagic[4] = {'M', 'Q', 'O', 'B'};
+  static constexpr uint8_t kVersion = 1;
+  static constexpr size_t kFileHeaderBytes = 8;
+
+  size_t _size = 0;      // Taille du fichier (0 = absent)
+  size_t _readPos = 0;   // Prochain record à rejouer
+  uint32_t _lastSeq = 0;
+  MqttOutboxRecord _cache;
+  bool _cached = false;
+
+  void clear() {
+    LittleFS.remove(kPath);
+    _size = 0;
+    _readPos = 0;
+    _cached = false;
+  }
+
+  static bool readRecordAt(File& f, size_t pos, MqttOutboxRecord& rec) {
+    uint8_t rh[kMqttOutboxRecordHeaderBytes];
+    if (!f.seek(pos) || f.read(rh, sizeof(rh)) != sizeof(rh)) return false;
+    memcpy(&rec.seq, rh, 4);
+    memcpy(&rec.epoch, rh + 4, 4);
+    uint16_t len;
+    memcpy(&len, rh + 10, 2);
+    const uint8_t cls = rh[9] & 0x7F;
+    if (rh[8] >= kMqttTopicCount || cls > static_cast<uint8_t>(MqttMsgClass::Sample) ||
+        len >= kMqttOutboxPayloadMax) {
+      return false;
+    }
+    rec.topic = static_cast<MqttTopicId>(rh[8]);
+    rec.cls = static_cast<MqttMsgClass>(cls);
+    rec.retain = (rh[9] & 0x80) != 0;
+    rec.len = len;
+    if (f.read(reinterpret_cast<uint8_t*>(rec.payload), len) != len) return false;
+    rec.payload[len] = '\0';
+    return true;
+  }
+};
+
+LittleFsSpillStore outboxSpill;
+
+// Files du pipeline (mqtt_pipeline.h) sur les queues FreeRTOS, sans attente :
+// un producteur de loopTask ne bloque jamais sur mqttTask.
+template <typename T>
+class FreeRtosQueue : public MqttQueue<T> {
+public:
+  QueueHandle_t handle = nullptr;
+  bool send(const T& item) override {
+    return handle != nullptr && xQueueSend(handle, &item, 0) == pdTRUE;
+  }
+  bool receive(T& out) override {
+    return handle != nullptr && xQueueReceive(handle, &out, 0) == pdTRUE;
+  }
+};
+
+// Client du pipeline : PubSubClient, watchdog rafraîchi avant chaque publish
+// (send borné par SO_SNDTIMEO, cf. safePublish). mqttTask uniquement.
+class PubSubPublisher : public MqttPublisher {
+public:
+  PubSubClient* client = nullptr;
+  bool connected() override { return client != nullptr && client->connected(); }
+  bool publish(const char* topic, const char* payload, bool retain) override {
+    esp_task_wdt_reset();
+    if (!connected()) return false;
+    if (client->publish(topic, payload, retain)) return true;
+    // Peut devenir bruyant en cas de coupure réseau, debug-level approprié.
+    systemLogger.debug("MQTT publish échoué: " + String(topic));
     return false;
   }
-  return digitSeen;
+};
+
+FreeRtosQueue<MqttSlabHandle> outQueuePort;
+FreeRtosQueue<InboundCmd> inQueuePort;
+PubSubPublisher mqttPublisher;
+
+// Epoch courant, 0 tant que l'horloge n'est pas synchronisée (NTP/RTC).
+uint32_t epochOrZero() {
+  time_t now = time(nullptr);
+  return now >= kMinValidEpoch ? static_cast<uint32_t>(now) : 0;
 }
 }  // namespace
 
 MqttManager mqttManager;
 
-MqttManager::MqttManager() : mqtt(wifiClient) {}
+MqttManager::MqttManager() : mqtt(wifiClient) {
+  _dedup.setCadence(&_cadence);
+}
 
 // ============================================================================
 // Initialisation
@@ -61,17 +253,27 @@ void MqttManager::begin() {
   });
   mqtt.setSocketTimeout(2);  // 2s max de gel par tentative ratée — voir ADR-0010
   mqtt.setKeepAlive(60);     // Mosquitto applique 1.5×keepalive = 90s de tolérance
-  mqtt.setBufferSize(1024);
+  mqtt.setBufferSize(kMqttBufferSize);
   wifiClient.setTimeout(kMqttClientConnectTimeoutSec);  // unité = secondes (cf. constants.h)
+  tlsClient.setTimeouts(kMqttClientConnectTimeoutSec * 1000UL, kMqttTlsHandshakeTimeoutMs);
   refreshTopics();
+  loadDiscoveryCache();
+
+  // Spill flash de l'outbox : reprend les messages hors-ligne d'un boot précédent.
+  outboxSpill.begin();
+  _outbox.attachSpill(&outboxSpill);
 
   // Création des queues — allouées une fois, jamais libérées (cycle de vie = vie du firmware)
-  outQueue = xQueueCreate(kMqttOutQueueLength, sizeof(OutboundMsg));
+  outQueue = xQueueCreate(kMqttOutQueueLength, sizeof(MqttSlabHandle));
   inQueue  = xQueueCreate(kMqttInQueueLength,  sizeof(InboundCmd));
   if (outQueue == nullptr || inQueue == nullptr) {
     systemLogger.critical("MQTT: échec création queues FreeRTOS");
     return;
   }
+  outQueuePort.handle = outQueue;
+  inQueuePort.handle = inQueue;
+  mqttPublisher.client = &mqtt;
+  _pipeline.attach(&outQueuePort, &inQueuePort, &mqttPublisher);
 
   // Création de la tâche dédiée — voir ADR-0011
   // Pinned core 0 : loopTask est sur core 1, on répartit la charge réseau.
@@ -95,100 +297,19 @@ void MqttManager::begin() {
 }
 
 void MqttManager::refreshTopics() {
-  String base = mqttCfg.topic;
-  base.trim();
-  if (base.length() == 0) base = "pool/sensors";
-  while (base.endsWith("/")) base.remove(base.length() - 1);
-  if (base.length() == 0) base = "pool/sensors";
-
-  topics.base = base;
-  topics.temperatureState = base + "/temperature";
-  topics.temperatureCircuitState = base + "/temperature_circuit";  // feature-020
-  topics.phState = base + "/ph";
-  topics.orpState = base + "/orp";
-  topics.filtrationState = base + "/filtration_state";
-  topics.filtrationModeState = base + "/filtration_mode";
-  topics.filtrationModeCommand = base + "/filtration_mode/set";
-  topics.filtrationCommand = base + "/filtration/set";
-  topics.filtrationStartState = base + "/filtration_start";       // feature-051
-  topics.filtrationEndState = base + "/filtration_end";           // feature-051
-  topics.filtrationStartCommand = base + "/filtration_start/set"; // feature-051
-  topics.filtrationEndCommand = base + "/filtration_end/set";     // feature-051
-  topics.lightingState = base + "/lighting_state";
-  topics.lightingCommand = base + "/lighting/set";
-  topics.lightingScheduleState = base + "/lighting_schedule";        // feature-052
-  topics.lightingScheduleCommand = base + "/lighting_schedule/set";  // feature-052
-  topics.lightingStartState = base + "/lighting_start";             // feature-052
-  topics.lightingEndState = base + "/lighting_end";                 // feature-052
-  topics.lightingStartCommand = base + "/lighting_start/set";       // feature-052
-  topics.lightingEndCommand = base + "/lighting_end/set";           // feature-052
-  topics.phDosageState = base + "/ph_dosage";
-  topics.orpDosageState = base + "/orp_dosage";
-  topics.phDosingState = base + "/ph_dosing";
-  topics.orpDosingState = base + "/orp_dosing";
-  topics.phLimitState = base + "/ph_limit";
-  topics.orpLimitState = base + "/orp_limit";
-  topics.phStockLowState = base + "/ph_stock_low";
-  topics.orpStockLowState = base + "/orp_stock_low";
-  topics.phRemainingState = base + "/ph_remaining_ml";
-  topics.orpRemainingState = base + "/orp_remaining_ml";
-  topics.phTargetState = base + "/ph_target";
-  topics.orpTargetState = base + "/orp_target";
-  topics.phTargetCommand = base + "/ph_target/set";
-  topics.orpTargetCommand = base + "/orp_target/set";
-  topics.phRegulationModeState  = base + "/ph_regulation_mode";
-  topics.phDailyTargetMlState   = base + "/ph_daily_target_ml";
-  topics.orpRegulationModeState = base + "/orp_regulation_mode";
-  topics.orpDailyTargetMlState  = base + "/orp_daily_target_ml";
-  // feature-009 : commandes HA de changement de mode de régulation
-  topics.phRegulationModeCommand  = base + "/ph_regulation_mode/set";
-  topics.orpRegulationModeCommand = base + "/orp_regulation_mode/set";
-  topics.alertsTopic = base + "/alerts";
-  topics.logsTopic = base + "/logs";
-  topics.statusTopic = base + "/status";
-  topics.diagnosticTopic = base + "/diagnostic";
-  // feature-021 : alertes calibration / capteur stale + états cal points
-  topics.alertsCalibrationTopic = base + "/alerts/calibration_required";
-  topics.alertsSensorStaleTopic = base + "/alerts/sensor_stale";
-  // feature-022 : alerte capteur pH/ORP figé (variance nulle)
-  topics.alertsSensorFrozenTopic = base + "/alerts/sensor_frozen";
-  // feature-022 Passe 1 : états binaires ON/OFF par capteur (stale OU figé)
-  topics.phSensorProblemState  = base + "/ph_sensor_problem";
-  topics.orpSensorProblemState = base + "/orp_sensor_problem";
-  topics.phCalPointsState       = base + "/ph_cal_points";
-  topics.orpCalPointsState      = base + "/orp_cal_points";
-  // feature-024 : pente sonde pH (3 topics retain).
-  topics.phSlopeAcidState       = base + "/ph_slope_acid";
-  topics.phSlopeBaseState       = base + "/ph_slope_base";
-  topics.phSlopeZeroState       = base + "/ph_slope_zero";
-  // feature-025 : chaîne de filtrage pH/ORP (médiane + EMA + rejet pics).
-  topics.phRawState                 = base + "/ph_raw";
-  topics.phMedianState              = base + "/ph_median";
-  topics.phFilteredState            = base + "/ph_filtered";
-  topics.phFilterReadyState         = base + "/ph_filter_ready";
-  topics.phFilterUnstableState      = base + "/ph_filter_unstable";
-  topics.phRejectedCountState       = base + "/ph_rejected_count";
-  topics.orpRawState                = base + "/orp_raw";
-  topics.orpMedianState             = base + "/orp_median";
-  topics.orpFilteredState           = base + "/orp_filtered";
-  topics.orpFilterReadyState        = base + "/orp_filter_ready";
-  topics.orpFilterUnstableState     = base + "/orp_filter_unstable";
-  topics.orpRejectedCountState      = base + "/orp_rejected_count";
-  topics.phMixingDelayActiveState   = base + "/ph_mixing_delay_active";
-  topics.orpMixingDelayActiveState  = base + "/orp_mixing_delay_active";
-  // feature-050 : cumuls journaliers injectés + commandes volume quotidien + reboot.
-  topics.phDailyMlState             = base + "/ph_daily_ml";
-  topics.orpDailyMlState            = base + "/orp_daily_ml";
-  topics.phDailyTargetMlCommand     = base + "/ph_daily_target_ml/set";
-  topics.orpDailyTargetMlCommand    = base + "/orp_daily_target_ml/set";
-  topics.rebootCommand              = base + "/reboot/set";
-  // feature-053 : Mode Boost (switch ON/OFF).
-  topics.boostState                 = base + "/boost";
-  topics.boostCommand               = base + "/boost/set";
-  // feature-056 : mode d'installation + signal filtration externe.
-  topics.installModeState           = base + "/install_mode";
-  topics.installModeCommand         = base + "/install_mode/set";
-  topics.filtrationExternalStateCommand = base + "/filtration_external_state/set";
+  // Arène reconstruite uniquement si la base normalisée change (cf. mqtt_topics.h).
+  // Appelée depuis mqttTask (connectInTask) et begin() : les producteurs loopTask
+  // n'enfilent que des MqttTopicId, jamais de pointeur vers l'arène.
+  MqttTopicBuildResult r = topics.build(mqttCfg.topic.c_str());
+  if (r == MqttTopicBuildResult::TooLong) {
+    if (!_topicBaseWarned) {
+      systemLogger.warning("MQTT: topic de base > " + String(kMqttMaxBaseLen) +
+                           " caractères — tronqué en '" + String(topics.base()) + "'");
+      _topicBaseWarned = true;
+    }
+  } else {
+    _topicBaseWarned = false;
+  }
 }
 
 // ============================================================================
@@ -242,22 +363,32 @@ void MqttManager::taskLoop() {
     //    On lit/snapshot les états sous configMutex DANS la tâche pour éviter
     //    que loopTask n'attende sur un mutex pendant qu'on publie ~15 messages.
     if (publishStatesRequested.exchange(false, std::memory_order_relaxed)) {
-      publishAllStatesInternal();
+      if (mqtt.connected()) {
+        publishAllStatesInternal();
+      } else if (mqttCfg.enabled) {
+        captureOfflineInternal();
+      }
     }
     if (publishDiagnosticRequested.exchange(false, std::memory_order_relaxed)) {
       publishDiagnosticInternal();
     }
 
-    // 3) Drainer la queue sortante (publish unitaires depuis publishAlert/publishStatus/etc.)
+    // 3) Drainer la file sortante (publish unitaires depuis publishAlert/publishStatus/etc.)
+    //    vers l'outbox, puis publier depuis l'outbox (voies pondérées, rejeu cadencé).
     drainOutQueue();
+    if (_stateDocDirty && mqtt.connected()) {
+      _stateDocDirty = false;
+      publishStateDocumentInternal();
+    }
+    flushOutbox();
+    // Passe discovery HA en cours : quelques entités par tour, pour que
+    // mqtt.loop() continue de servir les commandes entrantes entre deux lots.
+    publishDiscoveryStep();
 
     // 4) Attente courte avant la prochaine itération.
-    //    Pas de vTaskDelay direct : on attend sur la queue sortante avec timeout
-    //    pour réveiller la tâche dès qu'un nouveau message est posté.
-    OutboundMsg peek;
-    if (xQueuePeek(outQueue, &peek, pdMS_TO_TICKS(kMqttTaskLoopTimeoutMs)) == pdTRUE) {
-      // Message disponible — la prochaine itération drainera. Pas de pop ici.
-    }
+    //    Pas de vTaskDelay direct : enqueueOutbound() notifie la tâche, qui se
+    //    réveille dès qu'un message est posté sur outQueue.
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(kMqttTaskLoopTimeoutMs));
   }
 }
 
@@ -288,9 +419,35 @@ void MqttManager::connectInTask() {
   }
   mqtt.setServer(brokerIp, mqttCfg.port);
 
+  // Transport : TCP simple ou TLS. Empreinte absente ou illisible (config
+  // antérieure, NVS altérée) : pas de CA embarquée, donc jamais de connexion
+  // TLS non épinglée — les identifiants partiraient vers un broker non
+  // authentifié.
+  if (mqttCfg.tls) {
+    uint8_t pin[kMqttTlsPinLen];
+    if (!mqttTlsParsePin(mqttCfg.tlsFingerprint.c_str(), pin)) {
+      systemLogger.error(mqttCfg.tlsFingerprint.length() > 0
+                             ? "MQTT TLS : empreinte du broker invalide — connexion refusée"
+                             : "MQTT TLS : empreinte du broker absente — connexion refusée");
+      return;
+    }
+    tlsClient.setHostname(mqttCfg.server.c_str());
+    tlsClient.setPin(pin);
+    mqtt.setClient(tlsClient);
+  } else {
+    mqtt.setClient(wifiClient);
+  }
+
+  // Document d'état unique : un seul publish de ~1,3 Ko, au-delà du tampon
+  // nominal. Ajusté ici (socket fermé) pour suivre un changement de mode.
+  if (!mqtt.setBufferSize(mqttCfg.stateJson ? kMqttStateDocBufferSize : kMqttBufferSize)) {
+    systemLogger.error("MQTT: échec allocation tampon PubSubClient");
+    return;
+  }
+
   esp_task_wdt_reset();  // juste avant l'appel bloquant
 
-  const char* lwtTopic = topics.statusTopic.c_str();
+  const char* lwtTopic = topics.get(MqttTopicId::Status);
   const char* lwtMessage = "offline";
   uint8_t lwtQos = 1;
   bool lwtRetain = true;
@@ -313,7 +470,7 @@ void MqttManager::connectInTask() {
     // Borne le write() TCP à kMqttSocketSendTimeoutMs (500 ms) — le PINGREQ keepalive
     // a le temps de partir (vs IT4 O_NONBLOCK qui pouvait le faire échouer silencieusement
     // si le send buffer était plein → broker exceeded_timeout).
-    int fd = wifiClient.fd();
+    int fd = mqttCfg.tls ? tlsClient.fd() : wifiClient.fd();
     if (fd >= 0) {
       struct timeval tv;
       tv.tv_sec = kMqttSocketSendTimeoutMs / 1000;
@@ -325,49 +482,62 @@ void MqttManager::connectInTask() {
 
     connectedAtomic.store(true, std::memory_order_relaxed);
     systemLogger.info("MQTT connecté !");
+    if (mqttCfg.tls) logTlsHandshake();
 
     // Status online : direct (on est dans la tâche) — court-circuite outQueue
-    safePublish(topics.statusTopic.c_str(), "online", true);
-
-    mqtt.subscribe(topics.filtrationModeCommand.c_str());
-    mqtt.subscribe(topics.filtrationCommand.c_str());
-    mqtt.subscribe(topics.lightingCommand.c_str());
-    mqtt.subscribe(topics.phTargetCommand.c_str());
-    mqtt.subscribe(topics.orpTargetCommand.c_str());
-    mqtt.subscribe(topics.phRegulationModeCommand.c_str());
-    mqtt.subscribe(topics.orpRegulationModeCommand.c_str());
-    // feature-050 : volume quotidien programmé (pH/ORP) + bouton reboot
-    mqtt.subscribe(topics.phDailyTargetMlCommand.c_str());
-    mqtt.subscribe(topics.orpDailyTargetMlCommand.c_str());
-    mqtt.subscribe(topics.rebootCommand.c_str());
-    // feature-051 : heures de filtration
-    mqtt.subscribe(topics.filtrationStartCommand.c_str());
-    mqtt.subscribe(topics.filtrationEndCommand.c_str());
-    // feature-052 : programmation + heures d'éclairage
-    mqtt.subscribe(topics.lightingScheduleCommand.c_str());
-    mqtt.subscribe(topics.lightingStartCommand.c_str());
-    mqtt.subscribe(topics.lightingEndCommand.c_str());
-    mqtt.subscribe(topics.boostCommand.c_str());  // feature-053
-    // feature-056 : mode d'installation + signal filtration externe
-    mqtt.subscribe(topics.installModeCommand.c_str());
-    mqtt.subscribe(topics.filtrationExternalStateCommand.c_str());
-
-    discoveryPublished = false;
-    esp_task_wdt_reset();
-    publishDiscovery();              // ~34 publish — long si CPL lossy
+    safePublish(topics.get(MqttTopicId::Status), "online", true);
+
+    // Toutes les commandes de la table (Kind = Command) : filtration, éclairage,
+    // consignes, modes de régulation, volumes quotidiens, reboot, boost, mode
+    // d'installation, signal filtration externe.
+    for (size_t i = 0; i < kMqttTopicCount; ++i) {
+      MqttTopicId id = static_cast<MqttTopicId>(i);
+      if (mqttTopicKind(id) == MqttTopicKind::Command) mqtt.subscribe(topics.get(id));
+    }
+    // Birth message HA ("online" à chaque démarrage de HA) : republication complète.
+    char haStatus[kHaDiscoveryTopicMax];
+    snprintf(haStatus, sizeof(haStatus), "%s/status", HA_DISCOVERY_PREFIX);
+    mqtt.subscribe(haStatus);
+
+    _connectedAtMs = millis();
+    _offlineSampleTaken = false;     // prochaine coupure : échantillon immédiat
+    _publishedConfigGen = 0;         // session neuve : republier aussi les topics de config
+    _stateDocDirty = false;
+    _dedup.reset();                  // et tous les états (broker possiblement sans retain)
+    startDiscovery();                // passe étalée, entités inchangées sautées
     esp_task_wdt_reset();
     publishAllStatesInternal();      // ~15 publish
     esp_task_wdt_reset();
-    publishDiagnosticInternal();     // 1 publish JSON ~400c
+    publishDiagnosticInternal();     // 1 record JSON ~950c + santé capteurs via outQueue
     esp_task_wdt_reset();
   } else {
     constexpr unsigned long kMqttMaxReconnectDelayMs = 120000UL;
     _reconnectDelay = min(_reconnectDelay * 2, kMqttMaxReconnectDelayMs);
     systemLogger.error("MQTT échec, code=" + String(mqtt.state()) +
                        " — prochaine tentative dans " + String(_reconnectDelay / 1000) + "s");
+    if (mqttCfg.tls && tlsClient.lastError() != 0) {
+      if (tlsClient.lastPinRejected()) {
+        systemLogger.error("MQTT TLS : certificat du broker différent de l'empreinte épinglée");
+      } else {
+        char code[12];
+        snprintf(code, sizeof(code), "-0x%04X", static_cast<unsigned>(-tlsClient.lastError()));
+        systemLogger.error(String("MQTT TLS : échec handshake/transport (mbedTLS ") + code + ")");
+      }
+    }
   }
 }
 
+// Coût du handshake qui vient d'aboutir (durée hors TCP, pic et résident du
+// tas) : la même mesure est cumulée dans le diagnostic (mqtt_tls).
+void MqttManager::logTlsHandshake() {
+  const MqttTlsStats& s = tlsClient.stats();
+  char line[128];
+  snprintf(line, sizeof(line), "MQTT TLS : session %s, handshake %u ms, tas pic %u o / résident %u o",
+           tlsClient.lastResumed() ? "reprise" : "complète", static_cast<unsigned>(s.lastMs()),
+           static_cast<unsigned>(s.lastHeapPeak()), static_cast<unsigned>(s.lastHeapHeld()));
+  systemLogger.info(line);
+}
+
 // Wrapper unique pour tout mqtt.publish() depuis mqttTask. Reset wdt + check
 // mqtt.connected() + délégation. Le socket TCP est configuré avec SO_SNDTIMEO=500ms
 // (cf. connectInTask, kMqttSocketSendTimeoutMs), donc mqtt.publish() retourne false
@@ -375,35 +545,26 @@ void MqttManager::connectInTask() {
 // keepalive PINGREQ PubSubClient redevient fiable (vs IT4 O_NONBLOCK où EAGAIN
 // silencieux pouvait le perdre → broker exceeded_timeout). Voir feature-014 IT5 / ADR-0011.
 bool MqttManager::safePublish(const char* topic, const char* payload, bool retain) {
-  esp_task_wdt_reset();
-  if (!mqtt.connected()) return false;
-  return mqtt.publish(topic, payload, retain);
+  return mqttPublisher.publish(topic, payload, retain);
 }
 
 void MqttManager::drainOutQueue() {
-  // Limite le nombre de publish par itération pour laisser respirer mqtt.loop()
-  // et la consommation des sockets entrantes (callbacks HA).
-  constexpr int kMaxPublishPerIter = 8;
-  if (outQueue == nullptr) return;
-
-  for (int i = 0; i < kMaxPublishPerIter; ++i) {
-    OutboundMsg msg;
-    if (xQueueReceive(outQueue, &msg, 0) != pdTRUE) {
-      return;  // queue vide
-    }
-    if (!mqtt.connected()) {
-      // On drop silencieusement : impossible de publier sans connexion.
-      // Les états seront republiés au prochain publishAllStatesInternal()
-      // lors de la reconnexion.
-      continue;
-    }
-    if (!safePublish(msg.topic, msg.payload, msg.retain)) {
-      // Peut devenir bruyant en cas de coupure réseau, debug-level approprié.
-      systemLogger.debug("MQTT publish drop: " + String(msg.topic));
-    }
+  // Classement, dédup et passage à l'outbox : mqtt_pipeline.h. Seul le mode
+  // document d'état revient ici (reconstruction dans l'itération).
+  if (_pipeline.drainOutQueue(millis(), epochOrZero(), mqttCfg.enabled, mqttCfg.stateJson)) {
+    _stateDocDirty = true;
   }
 }
 
+void MqttManager::queueOutbox(MqttTopicId id, const char* payload, bool retain) {
+  _pipeline.queueOutbox(id, payload, retain, epochOrZero());
+}
+
+void MqttManager::flushOutbox() {
+  // Budget borné par itération (rejeu cadencé du backlog) : mqtt_pipeline.h.
+  _pipeline.flushOutbox(millis());
+}
+
 // ============================================================================
 // Update legacy — no-op (toute la logique vit dans mqttTask)
 // ============================================================================
@@ -436,23 +597,23 @@ void MqttManager::disconnect() {
 // Producteurs (depuis loopTask) — non-bloquants
 // ============================================================================
 
-void MqttManager::enqueueOutbound(const String& topic, const String& payload, bool retain) {
-  if (outQueue == nullptr || topic.length() == 0) return;
-  OutboundMsg msg;
-  // Tronque si dépassement (les payloads MQTT sont bornés à kMaxPayloadLen=384).
-  // En pratique aucun topic ne dépasse ~80c, aucun payload ~300c (publishDiagnostic).
-  strlcpy(msg.topic,   topic.c_str(),   sizeof(msg.topic));
-  strlcpy(msg.payload, payload.c_str(), sizeof(msg.payload));
-  msg.retain = retain;
-
-  if (xQueueSend(outQueue, &msg, 0) != pdTRUE) {
-    // Queue pleine : drop le plus ancien (best-effort) et retente.
-    OutboundMsg dropped;
-    if (xQueueReceive(outQueue, &dropped, 0) == pdTRUE) {
-      noteDropEdgeTriggered();
-    }
-    xQueueSend(outQueue, &msg, 0);  // si ça échoue à nouveau, on perd ce message
-  }
+void MqttManager::enqueueOutbound(MqttTopicId topic, const String& payload, bool retain) {
+  enqueueOutbound(topic, payload.c_str(), retain);
+}
+
+void MqttManager::enqueueOutbound(MqttTopicId topic, const char* payload, bool retain) {
+  // Payload copié une fois dans un bloc du pool, seule la poignée traverse
+  // outQueue ; pool épuisé → drop du plus ancien (mqtt_pipeline.h).
+  notePosted(_pipeline.enqueue(topic, payload, retain));
+}
+
+void MqttManager::postOutbound(MqttSlabHandle h) {
+  notePosted(_pipeline.post(h));
+}
+
+void MqttManager::notePosted(const MqttPostResult& res) {
+  for (uint8_t i = 0; i < res.dropped; ++i) noteDropEdgeTriggered();
+  if (res.posted && taskHandle != nullptr) xTaskNotifyGive(taskHandle);
 }
 
 void MqttManager::noteDropEdgeTriggered() {
@@ -460,14 +621,14 @@ void MqttManager::noteDropEdgeTriggered() {
   droppedSinceLastWarn++;
   unsigned long now = millis();
   if (now - lastDropWarnMs >= 5000) {
-    systemLogger.warning("MQTT outQueue saturée — " + String(droppedSinceLastWarn) +
+    systemLogger.warning("MQTT file sortante saturée — " + String(droppedSinceLastWarn) +
                          " message(s) abandonné(s)");
     droppedSinceLastWarn = 0;
     lastDropWarnMs = now;
   }
 }
 
-void MqttManager::publishSensorState(const String& topic, const String& payload, bool retain) {
+void MqttManager::publishSensorState(MqttTopicId topic, const String& payload, bool retain) {
   // Devient un producteur — non-bloquant. Le check connected() est fait DANS mqttTask
   // pour éviter une race entre l'enqueue et la déconnexion : dropper côté consommateur
   // si pas connecté est plus simple et thread-safe.
@@ -488,32 +649,32 @@ void MqttManager::publishDiagnostic() {
 // depuis loopTask : elles enfilent directement le message dans outQueue.
 // Elles peuvent aussi être appelées depuis mqttTask (lors de la reconnexion par exemple).
 void MqttManager::publishFiltrationState() {
-  enqueueOutbound(topics.filtrationModeState, filtrationCfg.mode, true);
-  enqueueOutbound(topics.filtrationState, filtration.isRunning() ? "ON" : "OFF", true);
+  enqueueOutbound(MqttTopicId::FiltrationModeState, filtrationCfg.mode, true);
+  enqueueOutbound(MqttTopicId::FiltrationState, filtration.isRunning() ? "ON" : "OFF", true);
   // feature-051 : heures courantes (recalculées par la température en mode auto)
-  enqueueOutbound(topics.filtrationStartState, filtrationCfg.start, true);
-  enqueueOutbound(topics.filtrationEndState, filtrationCfg.end, true);
+  enqueueOutbound(MqttTopicId::FiltrationStartState, filtrationCfg.start, true);
+  enqueueOutbound(MqttTopicId::FiltrationEndState, filtrationCfg.end, true);
 }
 
 void MqttManager::publishLightingState() {
-  enqueueOutbound(topics.lightingState, lighting.isOn() ? "ON" : "OFF", true);
+  enqueueOutbound(MqttTopicId::LightingState, lighting.isOn() ? "ON" : "OFF", true);
   // feature-052 : programmation + heures d'éclairage (miroir filtration)
-  enqueueOutbound(topics.lightingScheduleState, lightingCfg.scheduleEnabled ? "ON" : "OFF", true);
-  enqueueOutbound(topics.lightingStartState, lightingCfg.startTime, true);
-  enqueueOutbound(topics.lightingEndState, lightingCfg.endTime, true);
+  enqueueOutbound(MqttTopicId::LightingScheduleState, lightingCfg.scheduleEnabled ? "ON" : "OFF", true);
+  enqueueOutbound(MqttTopicId::LightingStartState, lightingCfg.startTime, true);
+  enqueueOutbound(MqttTopicId::LightingEndState, lightingCfg.endTime, true);
 }
 
 void MqttManager::publishDosingState() {
-  enqueueOutbound(topics.phDosingState,  PumpController.isPhDosing()  ? "ON" : "OFF", true);
-  enqueueOutbound(topics.orpDosingState, PumpController.isOrpDosing() ? "ON" : "OFF", true);
-  enqueueOutbound(topics.phLimitState,   safetyLimits.phLimitReached  ? "ON" : "OFF", true);
-  enqueueOutbound(topics.orpLimitState,  safetyLimits.orpLimitReached ? "ON" : "OFF", true);
+  enqueueOutbound(MqttTopicId::PhDosingState,  PumpController.isPhDosing()  ? "ON" : "OFF", true);
+  enqueueOutbound(MqttTopicId::OrpDosingState, PumpController.isOrpDosing() ? "ON" : "OFF", true);
+  enqueueOutbound(MqttTopicId::PhLimitState,   safetyLimits.phLimitReached  ? "ON" : "OFF", true);
+  enqueueOutbound(MqttTopicId::OrpLimitState,  safetyLimits.orpLimitReached ? "ON" : "OFF", true);
 }
 
 void MqttManager::publishBoostState() {
   // feature-053 : reflète l'état effectif du Boost (isBoostActive expire à minuit
   // même si le flag persisté n'a pas encore été nettoyé). Retain pour HA.
-  enqueueOutbound(topics.boostState, isBoostActive(time(nullptr)) ? "ON" : "OFF", true);
+  enqueueOutbound(MqttTopicId::BoostState, isBoostActive(time(nullptr)) ? "ON" : "OFF", true);
 }
 
 void MqttManager::publishProductState() {
@@ -529,10 +690,13 @@ void MqttManager::publishProductState() {
   bool orpStockLow = productCfg.orpTrackingEnabled && productCfg.orpAlertThresholdMl > 0 && orpRemaining <= productCfg.orpAlertThresholdMl;
   if (configMutex) xSemaphoreGiveRecursive(configMutex);
 
-  enqueueOutbound(topics.phStockLowState,   phStockLow  ? "ON" : "OFF", true);
-  enqueueOutbound(topics.orpStockLowState,  orpStockLow ? "ON" : "OFF", true);
-  enqueueOutbound(topics.phRemainingState,  String(phRemaining,  0), true);
-  enqueueOutbound(topics.orpRemainingState, String(orpRemaining, 0), true);
+  enqueueOutbound(MqttTopicId::PhStockLowState,   phStockLow  ? "ON" : "OFF", true);
+  enqueueOutbound(MqttTopicId::OrpStockLowState,  orpStockLow ? "ON" : "OFF", true);
+  char text[kFixedFormatMax];
+  formatFloatFixed(text, sizeof(text), phRemaining, 0);
+  enqueueOutbound(MqttTopicId::PhRemainingState, text, true);
+  formatFloatFixed(text, sizeof(text), orpRemaining, 0);
+  enqueueOutbound(MqttTopicId::OrpRemainingState, text, true);
 }
 
 void MqttManager::publishTargetState() {
@@ -550,12 +714,17 @@ void MqttManager::publishTargetState() {
   int orpDaily = mqttCfg.orpDailyTargetMl;
   if (configMutex) xSemaphoreGiveRecursive(configMutex);
 
-  enqueueOutbound(topics.phTargetState,  String(phT,  1), true);
-  enqueueOutbound(topics.orpTargetState, String(orpT, 0), true);
-  enqueueOutbound(topics.phRegulationModeState,  phMode, true);
-  enqueueOutbound(topics.phDailyTargetMlState,   String(phDaily), true);
-  enqueueOutbound(topics.orpRegulationModeState, orpMode, true);
-  enqueueOutbound(topics.orpDailyTargetMlState,  String(orpDaily), true);
+  char text[kFixedFormatMax];
+  formatFloatFixed(text, sizeof(text), phT, 1);
+  enqueueOutbound(MqttTopicId::PhTargetState, text, true);
+  formatFloatFixed(text, sizeof(text), orpT, 0);
+  enqueueOutbound(MqttTopicId::OrpTargetState, text, true);
+  enqueueOutbound(MqttTopicId::PhRegulationModeState,  phMode, true);
+  formatFixed(text, sizeof(text), phDaily, 0);
+  enqueueOutbound(MqttTopicId::PhDailyTargetMlState, text, true);
+  enqueueOutbound(MqttTopicId::OrpRegulationModeState, orpMode, true);
+  formatFixed(text, sizeof(text), orpDaily, 0);
+  enqueueOutbound(MqttTopicId::OrpDailyTargetMlState, text, true);
 }
 
 void MqttManager::publishAlert(const String& alertType, const String& message) {
@@ -563,18 +732,20 @@ void MqttManager::publishAlert(const String& alertType, const String& message) {
   doc["type"] = alertType;
   doc["message"] = message;
   doc["timestamp"] = millis();
+  // Heure réelle si synchronisée : une alerte rejouée après coupure reste datable.
+  if (uint32_t epoch = epochOrZero()) doc["epoch"] = epoch;
   String payload;
   serializeJson(doc, payload);
-  enqueueOutbound(topics.alertsTopic, payload, false);
+  enqueueOutbound(MqttTopicId::Alerts, payload, false);
   systemLogger.warning("Alerte: " + alertType + " - " + message);
 }
 
 void MqttManager::publishLog(const String& logMessage) {
-  enqueueOutbound(topics.logsTopic, logMessage, false);
+  enqueueOutbound(MqttTopicId::Logs, logMessage, false);
 }
 
 void MqttManager::publishStatus(const String& status) {
-  enqueueOutbound(topics.statusTopic, status, true);
+  enqueueOutbound(MqttTopicId::Status, status, true);
   systemLogger.info("Status MQTT: " + status);
 }
 
@@ -585,56 +756,70 @@ void MqttManager::publishStatus(const String& status) {
 void MqttManager::publishAllStatesInternal() {
   if (!mqtt.connected()) return;
 
+  // Phase de process pour la cadence par métrique (mqtt_cadence.h) : suivi fin
+  // pendant une injection ou sa pause de mélange, espacé au repos.
+  const uint32_t phaseMs = millis();
+  _cadence.setPhase(mqttProcessPhase(
+      PumpController.isPhDosing() || PumpController.isOrpDosing() ||
+          PumpController.isPhMixingDelayActive(phaseMs) ||
+          PumpController.isOrpMixingDelayActive(phaseMs),
+      filtration.isRunning()));
+
+  if (mqttCfg.stateJson) {
+    // Mode document d'état : un seul publish pour tous les états, puis les
+    // alertes edge-triggered (topics dédiés, inchangés).
+    publishStateDocumentInternal();
+    publishCalibrationStatusInternal();
+    return;
+  }
+
   // Capteurs : lectures atomiques côté firmware (float scalaires)
   float t = sensors.getTemperature();
   float tCircuit = sensors.getCircuitTemperature();   // feature-020
   float ph = sensors.getPh();
   float orp = sensors.getOrp();
 
-  // Tous les publish passent par safePublish() : reset wdt + check connected interne.
-  // Plus besoin de garde-fous intermédiaires ni de wdt reset explicites — voir IT4 / ADR-0011.
-  if (!isnan(t)) {
-    String p = String(t, 1);
-    safePublish(topics.temperatureState.c_str(), p.c_str(), true);
-  }
-  if (!isnan(tCircuit)) {
-    String p = String(tCircuit, 1);
-    safePublish(topics.temperatureCircuitState.c_str(), p.c_str(), true);
-  }
+  // Tous les états passent par publishStateValue()/publishStateText() : dédup par
+  // topic (mqtt_dedup.h, bandes mortes + rafraîchissement forcé), puis safePublish()
+  // (reset wdt + check connected interne) — voir IT4 / ADR-0011.
+  // NaN : rien publié (le retain précédent reste valable côté HA).
+  publishStateValue(MqttTopicId::TemperatureState, t, 1);
+  publishStateValue(MqttTopicId::TemperatureCircuitState, tCircuit, 1);
   // feature-021 spec ligne 247 : pH publié avec 3 décimales (l'EZO rend 3 décimales fiables)
-  if (!isnan(ph)) {
-    String p = String(ph, 3);
-    safePublish(topics.phState.c_str(), p.c_str(), true);
-  }
-  if (!isnan(orp)) {
-    String p = String(orp, 0);  // ORP entier (mV)
-    safePublish(topics.orpState.c_str(), p.c_str(), true);
-  }
+  publishStateValue(MqttTopicId::PhState, ph, 3);
+  publishStateValue(MqttTopicId::OrpState, orp, 0);  // ORP entier (mV)
+
+  // Topics dérivés de la config (retain) : republiés seulement quand la génération
+  // de config a changé depuis le dernier cycle réussi, ou après (re)connexion
+  // (_publishedConfigGen remis à 0). Le broker conserve sinon la valeur retenue.
+  const uint32_t configGen = getConfigGeneration();
+  const bool configChanged = configGen != _publishedConfigGen;
 
   // Filtration / lighting / dosing
-  safePublish(topics.filtrationModeState.c_str(), filtrationCfg.mode.c_str(), true);
-  safePublish(topics.filtrationState.c_str(), filtration.isRunning() ? "ON" : "OFF", true);
-  safePublish(topics.filtrationStartState.c_str(), filtrationCfg.start.c_str(), true);  // feature-051
-  safePublish(topics.filtrationEndState.c_str(), filtrationCfg.end.c_str(), true);      // feature-051
-  safePublish(topics.lightingState.c_str(), lighting.isOn() ? "ON" : "OFF", true);
-  safePublish(topics.lightingScheduleState.c_str(), lightingCfg.scheduleEnabled ? "ON" : "OFF", true);  // feature-052
-  safePublish(topics.lightingStartState.c_str(), lightingCfg.startTime.c_str(), true);                  // feature-052
-  safePublish(topics.lightingEndState.c_str(), lightingCfg.endTime.c_str(), true);                      // feature-052
-
-  safePublish(topics.boostState.c_str(), isBoostActive(time(nullptr)) ? "ON" : "OFF", true);  // feature-053
-
-  // feature-056 : mode d'installation (managed/powered/external, retain)
-  safePublish(topics.installModeState.c_str(), installModeToString(mqttCfg.installMode), true);
-
-  safePublish(topics.phDosingState.c_str(),  PumpController.isPhDosing()  ? "ON" : "OFF", true);
-  safePublish(topics.orpDosingState.c_str(), PumpController.isOrpDosing() ? "ON" : "OFF", true);
-  safePublish(topics.phLimitState.c_str(),   safetyLimits.phLimitReached  ? "ON" : "OFF", true);
-  safePublish(topics.orpLimitState.c_str(),  safetyLimits.orpLimitReached ? "ON" : "OFF", true);
-
-  // feature-050 : cumuls journaliers injectés (mL, 1 décimale, retain, dédupliqués
-  // par valeur mémorisée — slots 14/15). Remis à 0 à minuit par le pump_controller.
-  safePublishDedup(14, topics.phDailyMlState.c_str(),  String(safetyLimits.dailyPhInjectedMl, 1));
-  safePublishDedup(15, topics.orpDailyMlState.c_str(), String(safetyLimits.dailyOrpInjectedMl, 1));
+  publishStateText(MqttTopicId::FiltrationState, filtration.isRunning() ? "ON" : "OFF");
+  publishStateText(MqttTopicId::LightingState, lighting.isOn() ? "ON" : "OFF");
+  if (configChanged) {
+    publishStateText(MqttTopicId::FiltrationModeState, filtrationCfg.mode.c_str());
+    publishStateText(MqttTopicId::FiltrationStartState, filtrationCfg.start.c_str());  // feature-051
+    publishStateText(MqttTopicId::FiltrationEndState, filtrationCfg.end.c_str());      // feature-051
+    publishStateText(MqttTopicId::LightingScheduleState, lightingCfg.scheduleEnabled ? "ON" : "OFF");  // feature-052
+    publishStateText(MqttTopicId::LightingStartState, lightingCfg.startTime.c_str());                  // feature-052
+    publishStateText(MqttTopicId::LightingEndState, lightingCfg.endTime.c_str());                      // feature-052
+    // feature-056 : mode d'installation (managed/powered/external, retain)
+    publishStateText(MqttTopicId::InstallModeState, installModeToString(mqttCfg.installMode));
+  }
+
+  publishStateText(MqttTopicId::BoostState, isBoostActive(time(nullptr)) ? "ON" : "OFF");  // feature-053
+
+  publishStateText(MqttTopicId::PhDosingState,  PumpController.isPhDosing()  ? "ON" : "OFF");
+  publishStateText(MqttTopicId::OrpDosingState, PumpController.isOrpDosing() ? "ON" : "OFF");
+  publishStateText(MqttTopicId::PhLimitState,   safetyLimits.phLimitReached  ? "ON" : "OFF");
+  publishStateText(MqttTopicId::OrpLimitState,  safetyLimits.orpLimitReached ? "ON" : "OFF");
+
+  // feature-050 : cumuls journaliers injectés (mL, 1 décimale, retain). Remis à 0
+  // à minuit par le pump_controller.
+  publishStateValue(MqttTopicId::PhDailyMlState,  safetyLimits.dailyPhInjectedMl, 1);
+  publishStateValue(MqttTopicId::OrpDailyMlState, safetyLimits.dailyOrpInjectedMl, 1);
 
   // Product / target sous configMutex — snapshot puis publish hors verrou.
   // feature-027 : snapshot atomique ou rien. Timeout → seul ce bloc est sauté
@@ -664,17 +849,33 @@ void MqttManager::publishAllStatesInternal() {
     orpDaily = mqttCfg.orpDailyTargetMl;
     if (configMutex) xSemaphoreGiveRecursive(configMutex);
 
-    safePublish(topics.phStockLowState.c_str(),   phStockLow  ? "ON" : "OFF", true);
-    safePublish(topics.orpStockLowState.c_str(),  orpStockLow ? "ON" : "OFF", true);
-    safePublish(topics.phRemainingState.c_str(),  String(phRemaining,  0).c_str(), true);
-    safePublish(topics.orpRemainingState.c_str(), String(orpRemaining, 0).c_str(), true);
-
-    safePublish(topics.phTargetState.c_str(),  String(phT,  1).c_str(), true);
-    safePublish(topics.orpTargetState.c_str(), String(orpT, 0).c_str(), true);
-    safePublish(topics.phRegulationModeState.c_str(),  phMode.c_str(), true);
-    safePublish(topics.phDailyTargetMlState.c_str(),   String(phDaily).c_str(), true);
-    safePublish(topics.orpRegulationModeState.c_str(), orpMode.c_str(), true);
-    safePublish(topics.orpDailyTargetMlState.c_str(),  String(orpDaily).c_str(), true);
+    // Payloads texte : mêmes topics que les producteurs publishProductState() /
+    // publishTargetState() (file sortante, dédup texte au drain) — un topic garde
+    // toujours la même nature d'entrée de dédup.
+    publishStateText(MqttTopicId::PhStockLowState,   phStockLow  ? "ON" : "OFF");
+    publishStateText(MqttTopicId::OrpStockLowState,  orpStockLow ? "ON" : "OFF");
+    // Nombres formatés en virgule fixe sur la pile (fixed_format.h) : pas de
+    // String temporaire dans mqttTask.
+    char text[kFixedFormatMax];
+    formatFloatFixed(text, sizeof(text), phRemaining, 0);
+    publishStateText(MqttTopicId::PhRemainingState, text);
+    formatFloatFixed(text, sizeof(text), orpRemaining, 0);
+    publishStateText(MqttTopicId::OrpRemainingState, text);
+
+    if (configChanged) {
+      formatFloatFixed(text, sizeof(text), phT, 1);
+      publishStateText(MqttTopicId::PhTargetState, text);
+      formatFloatFixed(text, sizeof(text), orpT, 0);
+      publishStateText(MqttTopicId::OrpTargetState, text);
+      publishStateText(MqttTopicId::PhRegulationModeState,  phMode.c_str());
+      formatFixed(text, sizeof(text), phDaily, 0);
+      publishStateText(MqttTopicId::PhDailyTargetMlState, text);
+      publishStateText(MqttTopicId::OrpRegulationModeState, orpMode.c_str());
+      formatFixed(text, sizeof(text), orpDaily, 0);
+      publishStateText(MqttTopicId::OrpDailyTargetMlState, text);
+      // Génération marquée publiée seulement si la session est restée ouverte.
+      if (mqtt.connected()) _publishedConfigGen = configGen;
+    }
   }
 
   // feature-021 : statut calibration EZO + alertes (cf. cond #4 pool-chemistry).
@@ -685,21 +886,174 @@ void MqttManager::publishAllStatesInternal() {
 }
 
 // =============================================================================
-// feature-025 : publication des états de la chaîne de filtrage pH/ORP
+// Mode document d'état : tous les états dans {base}/state (mqttTask uniquement)
 // =============================================================================
 //
-// Topics retain=true, dédupliqués (anti-spam) : on ne republie un topic que si
-// sa valeur arrondie a changé depuis la dernière publication (cache _lastFilterPub).
-// Suit le rythme MQTT existant (appelé depuis publishAllStatesInternal, cadencé par
-// publishStatesRequested toutes les kMqttPublishIntervalMs).
-// Valeurs NaN/indisponibles : non publiées (le retain précédent reste valable côté HA).
-void MqttManager::safePublishDedup(int cacheIdx, const char* topic, const String& payload) {
-  if (cacheIdx >= 0 && cacheIdx < kDedupCacheSlots && _lastFilterPub[cacheIdx] == payload) return;
-  if (safePublish(topic, payload.c_str(), true) && cacheIdx >= 0 && cacheIdx < kDedupCacheSlots) {
-    _lastFilterPub[cacheIdx] = payload;
+// Mêmes valeurs et mêmes précisions que les topics individuels ci-dessus, mais
+// sérialisées en flux dans _stateDoc (mqtt_state_doc.h) et envoyées en UN
+// publish retain. Dédup champ par champ via _dedup : le document n'est publié
+// que si un champ a franchi sa bande morte / changé, ou au rafraîchissement
+// forcé ; tous les champs sont alors mémorisés. Snapshot config atomique ou
+// rien (feature-027) : timeout → document sauté, repris au cycle suivant.
+void MqttManager::publishStateDocumentInternal() {
+  if (!mqtt.connected()) return;
+
+  if (configMutex && xSemaphoreTakeRecursive(configMutex, pdMS_TO_TICKS(kConfigMutexTimeoutMs)) != pdTRUE) {
+    static unsigned long sWarnStateDocMs = 0;
+    warnConfigMutexTimeout(sWarnStateDocMs, "publishStateDocumentInternal");
+    return;
+  }
+  const float phRemaining  = max(0.0f, productCfg.phContainerVolumeMl  - productCfg.phTotalInjectedMl);
+  const float orpRemaining = max(0.0f, productCfg.orpContainerVolumeMl - productCfg.orpTotalInjectedMl);
+  const bool phStockLow  = productCfg.phTrackingEnabled  && productCfg.phAlertThresholdMl  > 0 && phRemaining  <= productCfg.phAlertThresholdMl;
+  const bool orpStockLow = productCfg.orpTrackingEnabled && productCfg.orpAlertThresholdMl > 0 && orpRemaining <= productCfg.orpAlertThresholdMl;
+  const float phT = mqttCfg.phTarget;
+  const float orpT = mqttCfg.orpTarget;
+  const String phMode = mqttCfg.phRegulationMode;
+  const String orpMode = mqttCfg.orpRegulationMode;
+  const int phDaily = mqttCfg.phDailyTargetMl;
+  const int orpDaily = mqttCfg.orpDailyTargetMl;
+  const String filtrationMode = filtrationCfg.mode;
+  const String filtrationStart = filtrationCfg.start;
+  const String filtrationEnd = filtrationCfg.end;
+  const bool lightingSchedule = lightingCfg.scheduleEnabled;
+  const String lightingStart = lightingCfg.startTime;
+  const String lightingEnd = lightingCfg.endTime;
+  const InstallMode installMode = mqttCfg.installMode;
+  if (configMutex) xSemaphoreGiveRecursive(configMutex);
+
+  const uint32_t nowMs = millis();
+  const bool phStale  = isnan(sensors.getPh());
+  const bool orpStale = isnan(sensors.getOrp());
+  auto onOff = [](bool on) { return on ? "ON" : "OFF"; };
+
+  MqttStateDoc doc(_stateDoc, sizeof(_stateDoc), _dedup, nowMs);
+
+  // Capteurs
+  doc.value(MqttTopicId::TemperatureState, sensors.getTemperature(), 1);
+  doc.value(MqttTopicId::TemperatureCircuitState, sensors.getCircuitTemperature(), 1);
+  doc.value(MqttTopicId::PhState, sensors.getPh(), 3);
+  doc.value(MqttTopicId::OrpState, sensors.getOrp(), 0);
+
+  // Filtration / éclairage / boost / mode d'installation
+  doc.text(MqttTopicId::FiltrationState, onOff(filtration.isRunning()));
+  doc.text(MqttTopicId::FiltrationModeState, filtrationMode.c_str());
+  doc.text(MqttTopicId::FiltrationStartState, filtrationStart.c_str());
+  doc.text(MqttTopicId::FiltrationEndState, filtrationEnd.c_str());
+  doc.text(MqttTopicId::LightingState, onOff(lighting.isOn()));
+  doc.text(MqttTopicId::LightingScheduleState, onOff(lightingSchedule));
+  doc.text(MqttTopicId::LightingStartState, lightingStart.c_str());
+  doc.text(MqttTopicId::LightingEndState, lightingEnd.c_str());
+  doc.text(MqttTopicId::BoostState, onOff(isBoostActive(time(nullptr))));
+  doc.text(MqttTopicId::InstallModeState, installModeToString(installMode));
+
+  // Dosage, limites, cumuls journaliers, stock produits
+  doc.text(MqttTopicId::PhDosingState, onOff(PumpController.isPhDosing()));
+  doc.text(MqttTopicId::OrpDosingState, onOff(PumpController.isOrpDosing()));
+  doc.text(MqttTopicId::PhLimitState, onOff(safetyLimits.phLimitReached));
+  doc.text(MqttTopicId::OrpLimitState, onOff(safetyLimits.orpLimitReached));
+  doc.value(MqttTopicId::PhDailyMlState, safetyLimits.dailyPhInjectedMl, 1);
+  doc.value(MqttTopicId::OrpDailyMlState, safetyLimits.dailyOrpInjectedMl, 1);
+  doc.text(MqttTopicId::PhStockLowState, onOff(phStockLow));
+  doc.text(MqttTopicId::OrpStockLowState, onOff(orpStockLow));
+  doc.value(MqttTopicId::PhRemainingState, phRemaining, 0);
+  doc.value(MqttTopicId::OrpRemainingState, orpRemaining, 0);
+
+  // Consignes et modes de régulation
+  doc.value(MqttTopicId::PhTargetState, phT, 1);
+  doc.value(MqttTopicId::OrpTargetState, orpT, 0);
+  doc.text(MqttTopicId::PhRegulationModeState, phMode.c_str());
+  doc.value(MqttTopicId::PhDailyTargetMlState, static_cast<float>(phDaily), 0);
+  doc.text(MqttTopicId::OrpRegulationModeState, orpMode.c_str());
+  doc.value(MqttTopicId::OrpDailyTargetMlState, static_cast<float>(orpDaily), 0);
+
+  // Calibration EZO et santé capteurs (caches, pas d'I²C)
+  doc.value(MqttTopicId::PhCalPointsState, static_cast<float>(sensors.getPhCalibrationPointsCached()), 0);
+  doc.value(MqttTopicId::OrpCalPointsState, static_cast<float>(sensors.getOrpCalibrationPointsCached()), 0);
+  doc.text(MqttTopicId::PhSensorProblemState, onOff(phStale || sensors.isPhSensorFrozen()));
+  doc.text(MqttTopicId::OrpSensorProblemState, onOff(orpStale || sensors.isOrpSensorFrozen()));
+  doc.value(MqttTopicId::PhSlopeAcidState, sensors.getPhSlopeAcid(), 1);
+  doc.value(MqttTopicId::PhSlopeBaseState, sensors.getPhSlopeBase(), 1);
+  doc.value(MqttTopicId::PhSlopeZeroState, sensors.getPhSlopeZero(), 2);
+
+  // Chaîne de filtrage pH/ORP (feature-025)
+  doc.value(MqttTopicId::PhRawState, sensors.getPhRaw(), 3);
+  doc.value(MqttTopicId::PhMedianState, sensors.getPhMedian(), 3);
+  doc.value(MqttTopicId::PhFilteredState, sensors.getPhFiltered(), 3);
+  doc.text(MqttTopicId::PhFilterReadyState, onOff(sensors.isPhFilterReady()));
+  doc.text(MqttTopicId::PhFilterUnstableState, onOff(sensors.isPhFilterUnstable()));
+  doc.value(MqttTopicId::PhRejectedCountState, static_cast<float>(sensors.getPhRejectedCount()), 0);
+  doc.value(MqttTopicId::OrpRawState, sensors.getOrpRaw(), 0);
+  doc.value(MqttTopicId::OrpMedianState, sensors.getOrpMedian(), 0);
+  doc.value(MqttTopicId::OrpFilteredState, sensors.getOrpFiltered(), 0);
+  doc.text(MqttTopicId::OrpFilterReadyState, onOff(sensors.isOrpFilterReady()));
+  doc.text(MqttTopicId::OrpFilterUnstableState, onOff(sensors.isOrpFilterUnstable()));
+  doc.value(MqttTopicId::OrpRejectedCountState, static_cast<float>(sensors.getOrpRejectedCount()), 0);
+  doc.text(MqttTopicId::PhMixingDelayActiveState, onOff(PumpController.isPhMixingDelayActive(nowMs)));
+  doc.text(MqttTopicId::OrpMixingDelayActiveState, onOff(PumpController.isOrpMixingDelayActive(nowMs)));
+
+  if (!doc.finish()) {
+    // Dimensionné pour le pire cas (test natif) : ne devrait jamais arriver.
+    static unsigned long sWarnOverflowMs = 0;
+    unsigned long now = millis();
+    if (sWarnOverflowMs == 0 || now - sWarnOverflowMs >= 60000) {
+      systemLogger.error("MQTT: document d'état > " + String(kMqttStateDocMax) + " octets, non publié");
+      sWarnOverflowMs = now;
+    }
+    return;
+  }
+  if (!doc.due()) {
+    _dedup.noteSuppressed();
+    return;
+  }
+  if (safePublish(topics.get(MqttTopicId::StateDocument), doc.c_str(), true)) {
+    doc.commit(_dedup);
   }
 }
 
+// =============================================================================
+// Publication dédupliquée des topics d'état (mqttTask uniquement)
+// =============================================================================
+//
+// Retain=true. Le topic n'est publié que si MqttDedup le juge dû (valeur hors
+// bande morte, texte changé, 1ʳᵉ publication de la session ou rafraîchissement
+// forcé kMqttDedupRefreshMs). La valeur n'est mémorisée qu'après un publish réussi :
+// un échec réseau est retenté au cycle suivant.
+bool MqttManager::publishStateText(MqttTopicId id, const char* payload) {
+  const uint32_t nowMs = millis();
+  if (!_dedup.textDue(id, payload, nowMs)) {
+    _dedup.noteSuppressed();
+    return false;
+  }
+  if (!safePublish(topics.get(id), payload, true)) return false;
+  _dedup.markText(id, payload, nowMs);
+  return true;
+}
+
+bool MqttManager::publishStateValue(MqttTopicId id, float value, uint8_t decimals) {
+  if (!isfinite(value)) return false;
+  // Même virgule fixe pour la clé de dédup et le texte publié (fixed_format.h).
+  const int32_t fixed = fixedFromFloat(value, decimals);
+  const uint32_t nowMs = millis();
+  if (!_dedup.valueDue(id, fixed, nowMs)) {
+    _dedup.noteSuppressed();
+    return false;
+  }
+  char payload[kFixedFormatMax];
+  formatFloatFixed(payload, sizeof(payload), value, decimals);
+  if (!safePublish(topics.get(id), payload, true)) return false;
+  _dedup.markValue(id, fixed, nowMs);
+  return true;
+}
+
+// =============================================================================
+// feature-025 : publication des états de la chaîne de filtrage pH/ORP
+// =============================================================================
+//
+// Topics retain=true, dédupliqués par MqttDedup (bande morte pH/ORP identique aux
+// topics ph/orp). Suit le rythme MQTT existant (appelé depuis
+// publishAllStatesInternal, cadencé par publishStatesRequested toutes les
+// kMqttPublishIntervalMs). Valeurs NaN : non publiées.
 void MqttManager::publishFilterStatesInternal() {
   if (!mqtt.connected()) return;
 
@@ -712,25 +1066,25 @@ void MqttManager::publishFilterStatesInternal() {
   float orpFil = sensors.getOrpFiltered();
   uint32_t nowMs = millis();
 
-  // pH (3 décimales, alignement WS/REST) — uniquement si non NaN.
-  if (!isnan(phRaw)) safePublishDedup(0, topics.phRawState.c_str(),      String(phRaw, 3));
-  if (!isnan(phMed)) safePublishDedup(1, topics.phMedianState.c_str(),   String(phMed, 3));
-  if (!isnan(phFil)) safePublishDedup(2, topics.phFilteredState.c_str(), String(phFil, 3));
-  safePublishDedup(3, topics.phFilterReadyState.c_str(),    sensors.isPhFilterReady()    ? "ON" : "OFF");
-  safePublishDedup(4, topics.phFilterUnstableState.c_str(), sensors.isPhFilterUnstable() ? "ON" : "OFF");
-  safePublishDedup(5, topics.phRejectedCountState.c_str(),  String(sensors.getPhRejectedCount()));
-
-  // ORP (entier mV) — uniquement si non NaN.
-  if (!isnan(orpRaw)) safePublishDedup(6, topics.orpRawState.c_str(),      String(orpRaw, 0));
-  if (!isnan(orpMed)) safePublishDedup(7, topics.orpMedianState.c_str(),   String(orpMed, 0));
-  if (!isnan(orpFil)) safePublishDedup(8, topics.orpFilteredState.c_str(), String(orpFil, 0));
-  safePublishDedup(9,  topics.orpFilterReadyState.c_str(),    sensors.isOrpFilterReady()    ? "ON" : "OFF");
-  safePublishDedup(10, topics.orpFilterUnstableState.c_str(), sensors.isOrpFilterUnstable() ? "ON" : "OFF");
-  safePublishDedup(11, topics.orpRejectedCountState.c_str(),  String(sensors.getOrpRejectedCount()));
+  // pH (3 décimales, alignement WS/REST).
+  publishStateValue(MqttTopicId::PhRawState,      phRaw, 3);
+  publishStateValue(MqttTopicId::PhMedianState,   phMed, 3);
+  publishStateValue(MqttTopicId::PhFilteredState, phFil, 3);
+  publishStateText(MqttTopicId::PhFilterReadyState,    sensors.isPhFilterReady()    ? "ON" : "OFF");
+  publishStateText(MqttTopicId::PhFilterUnstableState, sensors.isPhFilterUnstable() ? "ON" : "OFF");
+  publishStateValue(MqttTopicId::PhRejectedCountState, static_cast<float>(sensors.getPhRejectedCount()), 0);
+
+  // ORP (entier mV).
+  publishStateValue(MqttTopicId::OrpRawState,      orpRaw, 0);
+  publishStateValue(MqttTopicId::OrpMedianState,   orpMed, 0);
+  publishStateValue(MqttTopicId::OrpFilteredState, orpFil, 0);
+  publishStateText(MqttTopicId::OrpFilterReadyState,    sensors.isOrpFilterReady()    ? "ON" : "OFF");
+  publishStateText(MqttTopicId::OrpFilterUnstableState, sensors.isOrpFilterUnstable() ? "ON" : "OFF");
+  publishStateValue(MqttTopicId::OrpRejectedCountState, static_cast<float>(sensors.getOrpRejectedCount()), 0);
 
   // Pause mélange hydraulique active (post-injection).
-  safePublishDedup(12, topics.phMixingDelayActiveState.c_str(),  PumpController.isPhMixingDelayActive(nowMs)  ? "ON" : "OFF");
-  safePublishDedup(13, topics.orpMixingDelayActiveState.c_str(), PumpController.isOrpMixingDelayActive(nowMs) ? "ON" : "OFF");
+  publishStateText(MqttTopicId::PhMixingDelayActiveState,  PumpController.isPhMixingDelayActive(nowMs)  ? "ON" : "OFF");
+  publishStateText(MqttTopicId::OrpMixingDelayActiveState, PumpController.isOrpMixingDelayActive(nowMs) ? "ON" : "OFF");
 }
 
 // =============================================================================
@@ -752,20 +1106,26 @@ void MqttManager::publishFilterStatesInternal() {
 //     posé toutes les kMqttPublishIntervalMs depuis loopTask).
 //   - Lors d'une (re)connexion MQTT (connectInTask) — état initial après reboot.
 void MqttManager::publishCalibrationStatusInternal() {
-  if (!mqtt.connected()) return;
+  // Pas de garde connected() : hors-ligne, les états ci-dessous échouent sans
+  // effet (safePublish) et les alertes sont rangées dans l'outbox pour rejeu.
 
   // Lectures via cache (mises à jour en begin() puis à chaque calibration EZO).
-  // Pas d'appel I²C ici : on évite ~1.8 s de bus monopolisé par cycle MQTT (10 s).
+  // Pas d'appel I²C ici : on évite ~1.8 s de bus monopolisé par cycle MQTT (2 s).
   // En cas de désynchro improbable cache vs réalité, le prochain cycle de
   // calibration ou un boot resync remettra les valeurs à jour.
   int phCal  = sensors.getPhCalibrationPointsCached();
   int orpCal = sensors.getOrpCalibrationPointsCached();
   bool phStale  = isnan(sensors.getPh());
   bool orpStale = isnan(sensors.getOrp());
-
-  // 1) États bruts cal points (toujours retain — HA peut filtrer -1)
-  safePublish(topics.phCalPointsState.c_str(),  String(phCal).c_str(),  true);
-  safePublish(topics.orpCalPointsState.c_str(), String(orpCal).c_str(), true);
+  // Mode document d'état : cal points, sensor_problem et pentes sont dans
+  // {base}/state (publishStateDocumentInternal) ; seules les alertes restent ici.
+  const bool perTopic = !mqttCfg.stateJson;
+
+  // 1) États bruts cal points (retain, dédupliqués — HA peut filtrer -1)
+  if (perTopic) {
+    publishStateValue(MqttTopicId::PhCalPointsState,  static_cast<float>(phCal),  0);
+    publishStateValue(MqttTopicId::OrpCalPointsState, static_cast<float>(orpCal), 0);
+  }
 
   // 2) Alerte calibration_required — edge-triggered sur transition cal points
   bool needsCal = (phCal < 2) || (orpCal < 1);
@@ -777,14 +1137,15 @@ void MqttManager::publishCalibrationStatusInternal() {
       doc["phCalPoints"]  = phCal;
       doc["orpCalPoints"] = orpCal;
       doc["timestamp"]    = millis();
+      if (uint32_t epoch = epochOrZero()) doc["epoch"] = epoch;
       String payload;
       serializeJson(doc, payload);
-      safePublish(topics.alertsCalibrationTopic.c_str(), payload.c_str(), true);
+      queueOutbox(MqttTopicId::AlertsCalibration, payload.c_str(), true);
       systemLogger.warning("MQTT alerte calibration_required publiée (pH=" +
                            String(phCal) + ", ORP=" + String(orpCal) + ")");
     } else {
       // Clear retain : payload vide
-      safePublish(topics.alertsCalibrationTopic.c_str(), "", true);
+      queueOutbox(MqttTopicId::AlertsCalibration, "", true);
       systemLogger.info("MQTT alerte calibration_required clearée (calibration OK)");
     }
     _lastPhCalPoints  = phCal;
@@ -800,14 +1161,15 @@ void MqttManager::publishCalibrationStatusInternal() {
       doc["phStale"]   = phStale;
       doc["orpStale"]  = orpStale;
       doc["timestamp"] = millis();
+      if (uint32_t epoch = epochOrZero()) doc["epoch"] = epoch;
       String payload;
       serializeJson(doc, payload);
-      safePublish(topics.alertsSensorStaleTopic.c_str(), payload.c_str(), true);
+      queueOutbox(MqttTopicId::AlertsSensorStale, payload.c_str(), true);
       systemLogger.warning(String("MQTT alerte sensor_stale publiée (pH=") +
                            (phStale ? "NaN" : "OK") + ", ORP=" +
                            (orpStale ? "NaN" : "OK") + ")");
     } else {
-      safePublish(topics.alertsSensorStaleTopic.c_str(), "", true);
+      queueOutbox(MqttTopicId::AlertsSensorStale, "", true);
       systemLogger.info("MQTT alerte sensor_stale clearée");
     }
     _lastSensorStale = isStale;
@@ -827,14 +1189,15 @@ void MqttManager::publishCalibrationStatusInternal() {
       doc["phFrozen"]  = phFrozen;
       doc["orpFrozen"] = orpFrozen;
       doc["timestamp"] = millis();
+      if (uint32_t epoch = epochOrZero()) doc["epoch"] = epoch;
       String payload;
       serializeJson(doc, payload);
-      safePublish(topics.alertsSensorFrozenTopic.c_str(), payload.c_str(), true);
+      queueOutbox(MqttTopicId::AlertsSensorFrozen, payload.c_str(), true);
       systemLogger.warning(String("MQTT alerte sensor_frozen publiée (pH=") +
                            (phFrozen ? "FIGÉ" : "OK") + ", ORP=" +
                            (orpFrozen ? "FIGÉ" : "OK") + ")");
     } else {
-      safePublish(topics.alertsSensorFrozenTopic.c_str(), "", true);
+      queueOutbox(MqttTopicId::AlertsSensorFrozen, "", true);
       systemLogger.info("MQTT alerte sensor_frozen clearée");
     }
     _lastSensorFrozen = isFrozen;
@@ -845,49 +1208,59 @@ void MqttManager::publishCalibrationStatusInternal() {
   // device_class "problem") sans parser les JSON d'alerte. Réutilise phStale/
   // orpStale (bloc 3) et phFrozen/orpFrozen (bloc 3bis). Dédupliqué par état
   // mémorisé (-1 = jamais publié → force la 1ʳᵉ publication), retain=true.
+  // Mémorisé seulement après un publish réussi : une transition survenue
+  // hors-ligne est publiée à la reconnexion.
   int8_t phProblem  = (phStale || phFrozen)   ? 1 : 0;
   int8_t orpProblem = (orpStale || orpFrozen) ? 1 : 0;
-  if (phProblem != _lastPhSensorProblem) {
-    safePublish(topics.phSensorProblemState.c_str(), phProblem ? "ON" : "OFF", true);
+  if (perTopic && phProblem != _lastPhSensorProblem &&
+      safePublish(topics.get(MqttTopicId::PhSensorProblemState), phProblem ? "ON" : "OFF", true)) {
     systemLogger.info(String("MQTT ph_sensor_problem → ") + (phProblem ? "ON" : "OFF"));
     _lastPhSensorProblem = phProblem;
   }
-  if (orpProblem != _lastOrpSensorProblem) {
-    safePublish(topics.orpSensorProblemState.c_str(), orpProblem ? "ON" : "OFF", true);
+  if (perTopic && orpProblem != _lastOrpSensorProblem &&
+      safePublish(topics.get(MqttTopicId::OrpSensorProblemState), orpProblem ? "ON" : "OFF", true)) {
     systemLogger.info(String("MQTT orp_sensor_problem → ") + (orpProblem ? "ON" : "OFF"));
     _lastOrpSensorProblem = orpProblem;
   }
 
-  // 4) feature-024 : pente sonde pH — publication edge-triggered.
-  // Publié UNIQUEMENT après la 1ʳᵉ query Slope,? réussie (NaN check).
-  // Chaque query réussie suivante (24h ou post-cal) re-publie si la valeur
-  // arrondie a changé — évite le bruit MQTT pour des oscillations <0.1%.
-  float slopeAcid = sensors.getPhSlopeAcid();
-  float slopeBase = sensors.getPhSlopeBase();
-  float slopeZero = sensors.getPhSlopeZero();
-  if (!isnan(slopeAcid)) {
-    float rounded = round(slopeAcid * 10.0f) / 10.0f;
-    if (isnan(_lastPhSlopeAcidPub) || rounded != _lastPhSlopeAcidPub) {
-      safePublish(topics.phSlopeAcidState.c_str(), String(rounded, 1).c_str(), true);
-      _lastPhSlopeAcidPub = rounded;
-    }
-  }
-  if (!isnan(slopeBase)) {
-    float rounded = round(slopeBase * 10.0f) / 10.0f;
-    if (isnan(_lastPhSlopeBasePub) || rounded != _lastPhSlopeBasePub) {
-      safePublish(topics.phSlopeBaseState.c_str(), String(rounded, 1).c_str(), true);
-      _lastPhSlopeBasePub = rounded;
-    }
-  }
-  if (!isnan(slopeZero)) {
-    float rounded = round(slopeZero * 100.0f) / 100.0f;
-    if (isnan(_lastPhSlopeZeroPub) || rounded != _lastPhSlopeZeroPub) {
-      safePublish(topics.phSlopeZeroState.c_str(), String(rounded, 2).c_str(), true);
-      _lastPhSlopeZeroPub = rounded;
-    }
+  // 4) feature-024 : pente sonde pH — publiée après la 1ʳᵉ query Slope,? réussie
+  // (NaN sinon), puis à chaque changement de la valeur arrondie (dédup valeur,
+  // bande morte nulle) — évite le bruit MQTT pour des oscillations < 0.1 %.
+  if (perTopic) {
+    publishStateValue(MqttTopicId::PhSlopeAcidState, sensors.getPhSlopeAcid(), 1);
+    publishStateValue(MqttTopicId::PhSlopeBaseState, sensors.getPhSlopeBase(), 1);
+    publishStateValue(MqttTopicId::PhSlopeZeroState, sensors.getPhSlopeZero(), 2);
   }
 }
 
+// Pendant une coupure (MQTT activé, broker injoignable), à la cadence de
+// publishStatesRequested : les alertes edge-triggered continuent d'être
+// détectées (publishCalibrationStatusInternal → outbox → spill flash) et un
+// échantillon capteurs daté est pris toutes les kMqttOfflineSampleIntervalMs
+// pour {base}/history, rejoué à la reconnexion.
+void MqttManager::captureOfflineInternal() {
+  publishCalibrationStatusInternal();
+
+  unsigned long now = millis();
+  if (_offlineSampleTaken && now - _lastOfflineSampleMs < kMqttOfflineSampleIntervalMs) return;
+  uint32_t epoch = epochOrZero();
+  if (epoch == 0) return;  // non daté : inexploitable pour combler un historique
+
+  float t = sensors.getTemperature();
+  float ph = sensors.getPh();
+  float orp = sensors.getOrp();
+  JsonDocument doc;
+  doc["epoch"] = epoch;
+  if (!isnan(t))   doc["temperature"] = round(t * 10.0f) / 10.0f;
+  if (!isnan(ph))  doc["ph"] = round(ph * 1000.0f) / 1000.0f;
+  if (!isnan(orp)) doc["orp"] = lroundf(orp);
+  String payload;
+  serializeJson(doc, payload);
+  queueOutbox(MqttTopicId::History, payload.c_str(), false);
+  _lastOfflineSampleMs = now;
+  _offlineSampleTaken = true;
+}
+
 void MqttManager::publishDiagnosticInternal() {
   if (!mqtt.connected()) return;
 
@@ -922,15 +1295,88 @@ void MqttManager::publishDiagnosticInternal() {
   doc["firmware_version"] = FIRMWARE_VERSION;
   doc["build_timestamp"] = __DATE__ " " __TIME__;
 
+  doc["mqtt_dedup_suppressed"] = _dedup.suppressedCount();
+  doc["mqtt_cmd_coalesced"] = _cmdBatch.coalescedCount();
+  static const char* const kPhaseNames[] = {"idle", "filtering", "dosing"};
+  doc["mqtt_cadence_phase"] = kPhaseNames[static_cast<uint8_t>(_cadence.phase())];
+  doc["mqtt_outbox_ram"] = _outbox.ramCount();
+  doc["mqtt_outbox_spill_bytes"] = _outbox.spillBytes();
+  doc["mqtt_outbox_sent"] = _outbox.sentCount();
+  doc["mqtt_outbox_spilled"] = _outbox.spilledCount();
+  doc["mqtt_outbox_dropped"] = _outbox.droppedCount();
+  doc["mqtt_outbox_coalesced"] = _outbox.coalescedCount();
+  // Par voie, dans l'ordre control / alert / telemetry : occupation RAM et drops.
+  JsonArray laneRam = doc["mqtt_outbox_lanes"].to<JsonArray>();
+  JsonArray laneDrops = doc["mqtt_outbox_lane_drops"].to<JsonArray>();
+  for (size_t i = 0; i < kMqttLaneCount; ++i) {
+    laneRam.add(_outbox.laneCount(static_cast<MqttLane>(i)));
+    laneDrops.add(_outbox.laneDroppedCount(static_cast<MqttLane>(i)));
+  }
+  // Pool des records sortants, par classe de bloc (32 / 160 / 1024 o) :
+  // occupation courante, pic depuis le boot, et allocations refusées.
+  JsonArray slabUsed = doc["mqtt_slab_used"].to<JsonArray>();
+  JsonArray slabPeak = doc["mqtt_slab_peak"].to<JsonArray>();
+  for (size_t c = 0; c < kMqttSlabClassCount; ++c) {
+    slabUsed.add(_slab.used(c));
+    slabPeak.add(_slab.peak(c));
+  }
+  doc["mqtt_slab_fail"] = _slab.failures();
+  // Handshakes TLS (si activé), tableau compact pour rester sous le bloc 1 Ko :
+  // [complets, repris, reprises refusées, échecs, moy. complet ms, moy. reprise ms,
+  //  max ms, pic tas max o, tas résident o]
+  if (mqttCfg.tls) {
+    const MqttTlsStats& tls = tlsClient.stats();
+    JsonArray t = doc["mqtt_tls"].to<JsonArray>();
+    t.add(tls.fullCount());
+    t.add(tls.resumedCount());
+    t.add(tls.resumeMissCount());
+    t.add(tls.failureCount());
+    t.add(tls.avgFullMs());
+    t.add(tls.avgResumedMs());
+    t.add(tls.maxMs());
+    t.add(tls.maxHeapPeak());
+    t.add(tls.lastHeapHeld());
+  }
+
   // Stack high-water-mark de la tâche (utile pour caler kMqttTaskStackSize en prod)
   if (taskHandle) {
     doc["mqtt_task_stack_hwm"] = uxTaskGetStackHighWaterMark(taskHandle);
   }
 
-  String payload;
-  serializeJson(doc, payload);
-  safePublish(topics.diagnosticTopic.c_str(), payload.c_str(), true);
+  // Même chemin que les autres producteurs : sérialisé directement dans un bloc
+  // du pool (pas de String intermédiaire), publié au drain de cette itération.
+  const size_t len = measureJson(doc);
+  const MqttSlabHandle h = _slab.alloc(len);
+  if (h == kMqttSlabNone) {
+    systemLogger.warning("Diagnostic MQTT non publié (" + String(len) + " o, pool sortant plein)");
+    return;
+  }
+  MqttSlabHeader& rec = _slab.header(h);
+  rec.topic = MqttTopicId::Diagnostic;
+  rec.retain = true;
+  rec.len = static_cast<uint16_t>(serializeJson(doc, _slab.payload(h), _slab.capacity(h)));
+  postOutbound(h);
   systemLogger.debug("Diagnostic publié");
+
+  publishSensorHealthInternal();
+}
+
+// Santé pH / ORP (même JSON que GET /sensors/health), à la cadence du
+// diagnostic : topic séparé, le diagnostic remplit déjà son bloc de 1 Ko.
+void MqttManager::publishSensorHealthInternal() {
+  JsonDocument doc;
+  sensors.fillHealthJson(doc.to<JsonObject>());
+  const size_t len = measureJson(doc);
+  const MqttSlabHandle h = _slab.alloc(len);
+  if (h == kMqttSlabNone) {
+    systemLogger.warning("Santé capteurs MQTT non publiée (" + String(len) + " o, pool sortant plein)");
+    return;
+  }
+  MqttSlabHeader& rec = _slab.header(h);
+  rec.topic = MqttTopicId::SensorHealth;
+  rec.retain = true;
+  rec.len = static_cast<uint16_t>(serializeJson(doc, _slab.payload(h), _slab.capacity(h)));
+  postOutbound(h);
 }
 
 // ============================================================================
@@ -939,47 +1385,70 @@ void MqttManager::publishDiagnosticInternal() {
 // ============================================================================
 
 void MqttManager::messageCallback(char* topic, byte* payload, unsigned int length) {
-  String topicStr(topic);
-  InboundCmd cmd;
-  cmd.payload[0] = '\0';
-
-  // Copie du payload tronqué
-  size_t copyLen = (length < sizeof(cmd.payload) - 1) ? length : sizeof(cmd.payload) - 1;
-  for (size_t i = 0; i < copyLen; ++i) {
-    cmd.payload[i] = static_cast<char>(payload[i]);
-  }
-  cmd.payload[copyLen] = '\0';
-
-  if      (topicStr == topics.filtrationModeCommand) cmd.type = InboundCmdType::FiltrationMode;
-  else if (topicStr == topics.filtrationCommand)     cmd.type = InboundCmdType::FiltrationOnOff;
-  else if (topicStr == topics.lightingCommand)       cmd.type = InboundCmdType::Lighting;
-  else if (topicStr == topics.phTargetCommand)       cmd.type = InboundCmdType::PhTarget;
-  else if (topicStr == topics.orpTargetCommand)      cmd.type = InboundCmdType::OrpTarget;
-  else if (topicStr == topics.phRegulationModeCommand)  cmd.type = InboundCmdType::PhRegulationMode;
-  else if (topicStr == topics.orpRegulationModeCommand) cmd.type = InboundCmdType::OrpRegulationMode;
-  else if (topicStr == topics.phDailyTargetMlCommand)   cmd.type = InboundCmdType::PhDailyTarget;
-  else if (topicStr == topics.orpDailyTargetMlCommand)  cmd.type = InboundCmdType::OrpDailyTarget;
-  else if (topicStr == topics.rebootCommand)            cmd.type = InboundCmdType::Reboot;
-  else if (topicStr == topics.filtrationStartCommand)   cmd.type = InboundCmdType::FiltrationStart;
-  else if (topicStr == topics.filtrationEndCommand)     cmd.type = InboundCmdType::FiltrationEnd;
-  else if (topicStr == topics.lightingScheduleCommand)  cmd.type = InboundCmdType::LightingSchedule;
-  else if (topicStr == topics.lightingStartCommand)     cmd.type = InboundCmdType::LightingStart;
-  else if (topicStr == topics.lightingEndCommand)       cmd.type = InboundCmdType::LightingEnd;
-  else if (topicStr == topics.boostCommand)             cmd.type = InboundCmdType::Boost;
-  else if (topicStr == topics.installModeCommand)       cmd.type = InboundCmdType::InstallMode;
-  else if (topicStr == topics.filtrationExternalStateCommand)   cmd.type = InboundCmdType::FiltrationExternalState;
-  else return;
-
-  if (inQueue == nullptr) return;
-  if (xQueueSend(inQueue, &cmd, 0) != pdTRUE) {
+  // Birth HA : HA (re)démarre → republication complète, au cas où le broker
+  // aurait perdu les configs retain (redémarré sans persistance) entre-temps.
+  // Un birth retain rejoué par le broker juste après la souscription est ignoré
+  // (kHaBirthGraceMs), sans quoi chaque reconnexion republierait toute la table.
+  const size_t prefixLen = strlen(HA_DISCOVERY_PREFIX);
+  if (strncmp(topic, HA_DISCOVERY_PREFIX, prefixLen) == 0 && strcmp(topic + prefixLen, "/status") == 0) {
+    if (length == 6 && memcmp(payload, "online", 6) == 0 &&
+        millis() - _connectedAtMs >= kHaBirthGraceMs) {
+      systemLogger.info("Home Assistant redémarré — republication discovery");
+      _discoveryCache.invalidate();
+      startDiscovery();
+    }
+    return;
+  }
+
+  // Dispatch O(1) sans allocation, payload tronqué copié dans inQueue (mqtt_pipeline.h).
+  if (_pipeline.onMessage(topic, payload, length) == MqttInboundResult::Dropped) {
     systemLogger.warning("MQTT inQueue saturée — commande HA abandonnée");
   }
 }
 
 // ============================================================================
 // Drainage des commandes HA — appelé depuis loopTask à chaque tour de loop()
-// Toutes les actions sur les actuateurs s'exécutent ici, sous configMutex.
 // ============================================================================
+// inQueue est vidée d'un coup dans un lot coalescé (mqtt_commands.h : une
+// entrée par type, la dernière valide gagne). Une restauration d'état HA ou une
+// automatisation qui enchaîne les `.../set` coûte alors UNE prise de
+// configMutex, UNE écriture NVS (saveMqttConfig) et UN broadcast WS par lot,
+// au lieu d'une par commande.
+//   1) Commandes de config, sous une seule prise de configMutex.
+//   2) Actions directes (éclairage manuel, boost, signal externe, reboot), hors
+//      mutex : elles prennent leurs propres verrous.
+//   3) Effets différés, une fois par lot : filtration/lighting.update() puis
+//      republication des états touchés.
+
+namespace {
+// États à republier en fin de lot (un bit par publishXxxState).
+enum : uint8_t {
+  kCmdPubFiltration  = 1 << 0,
+  kCmdPubLighting    = 1 << 1,
+  kCmdPubTarget      = 1 << 2,
+  kCmdPubBoost       = 1 << 3,
+  kCmdPubInstallMode = 1 << 4,
+};
+
+// État republié pour resynchroniser HA sur une commande de config non appliquée.
+uint8_t resyncBitFor(MqttCommand type) {
+  switch (type) {
+    case MqttCommand::FiltrationMode:
+    case MqttCommand::FiltrationOnOff:
+    case MqttCommand::FiltrationStart:
+    case MqttCommand::FiltrationEnd:
+      return kCmdPubFiltration;
+    case MqttCommand::LightingSchedule:
+    case MqttCommand::LightingStart:
+    case MqttCommand::LightingEnd:
+      return kCmdPubLighting;
+    case MqttCommand::InstallMode:
+      return kCmdPubInstallMode;
+    default:
+      return kCmdPubTarget;
+  }
+}
+}  // namespace
 
 void MqttManager::drainCommandQueue() {
   // feature-050 : redémarrage différé demandé via MQTT/HA — même séquence propre que
@@ -993,286 +1462,154 @@ void MqttManager::drainCommandQueue() {
     ESP.restart();
   }
 
-  if (inQueue == nullptr) return;
+  // Borné à la profondeur de la file : un producteur rapide ne retient pas loopTask.
+  bool configCmd = false;
+  _pipeline.collectCommands(_cmdBatch, configCmd);
+  if (_cmdBatch.size() == 0) return;
 
   // bug-sync-ws-config : une commande HA qui modifie la config doit notifier les
-  // clients WebSocket (sinon l'UI ne voit le changement qu'au reload). Le flag est
-  // posé pour toute commande traitée sauf Reboot, et consommé une fois en fin de
-  // drain (broadcast idempotent, coalescé). drainCommandQueue tourne sur loopTask,
-  // comme la consommation du flag WS → écriture du booléen sûre.
+  // clients WebSocket (sinon l'UI ne voit le changement qu'au reload). Posé pour
+  // toute commande traitée sauf Reboot, consommé une fois en fin de lot.
   bool needConfigBroadcast = false;
+  bool persist = false;            // saveMqttConfig() une fois, mutex encore tenu
+  bool updateFiltration = false;
+  bool updateLighting = false;
+  uint8_t publish = 0;
+
+  // --------------------------------------------------------------------------
+  // 1) Commandes de config — une seule prise de configMutex pour tout le lot.
+  // feature-027 : timeout → commandes de config abandonnées (rien modifié avant
+  // le take), resync HA sur l'état réel des entités concernées.
+  // --------------------------------------------------------------------------
+  const bool locked = configCmd &&
+      xSemaphoreTakeRecursive(configMutex, pdMS_TO_TICKS(kConfigMutexTimeoutMs)) == pdTRUE;
+  if (configCmd && !locked) {
+    static unsigned long sWarnCmdBatchMs = 0;
+    warnConfigMutexTimeout(sWarnCmdBatchMs, "cmd batch");
+  }
 
-  // Limite par tour pour éviter de saturer loopTask en cas de rafale.
-  constexpr int kMaxCmdPerIter = 8;
-  for (int i = 0; i < kMaxCmdPerIter; ++i) {
-    InboundCmd cmd;
-    if (xQueueReceive(inQueue, &cmd, 0) != pdTRUE) break;  // file vide → sortie unique
-
-    if (cmd.type != InboundCmdType::Reboot) needConfigBroadcast = true;
-
-    String payloadStr(cmd.payload);
-    payloadStr.trim();
-
-    switch (cmd.type) {
-      case InboundCmdType::FiltrationMode: {
-        payloadStr.toLowerCase();
-        if (payloadStr == "auto" || payloadStr == "manual" || payloadStr == "force" || payloadStr == "off") {
-          // feature-027 : timeout → commande abandonnée (rien modifié avant le take),
-          // resync HA sur l'état réel via publishFiltrationState().
-          if (xSemaphoreTakeRecursive(configMutex, pdMS_TO_TICKS(kConfigMutexTimeoutMs)) != pdTRUE) {
-            static unsigned long sWarnFiltModeMs = 0;
-            warnConfigMutexTimeout(sWarnFiltModeMs, "cmd filtration_mode");
-            publishFiltrationState();
-            break;
-          }
-          if (filtrationCfg.mode != payloadStr) {
-            filtrationCfg.mode = payloadStr;
-            filtration.ensureTimesValid();
-            if (filtrationCfg.mode == "auto") {
-              filtration.computeAutoSchedule();
-            }
-            saveMqttConfig();
-            systemLogger.info("Mode filtration changé: " + payloadStr);
+  for (size_t i = 0; i < _cmdBatch.size(); ++i) {
+    const MqttCommand type = _cmdBatch.type(i);
+    if (!mqttCommandWritesConfig(type)) continue;
+    needConfigBroadcast = true;
+
+    // Payload rogné, casse normalisée et validé selon la commande (mqtt_commands.h).
+    const MqttCommandArgs& args = _cmdBatch.args(i);
+    String payloadStr(args.text);
+
+    if (!locked) {
+      publish |= resyncBitFor(type);
+      continue;
+    }
+
+    switch (type) {
+      case MqttCommand::FiltrationMode: {
+        if (args.valid && filtrationCfg.mode != payloadStr) {
+          filtrationCfg.mode = payloadStr;
+          filtration.ensureTimesValid();
+          if (filtrationCfg.mode == "auto") {
+            filtration.computeAutoSchedule();
           }
-          xSemaphoreGiveRecursive(configMutex);
-          publishFiltrationState();
+          persist = true;
+          systemLogger.info("Mode filtration changé: " + payloadStr);
         }
+        if (args.valid) publish |= kCmdPubFiltration;
         break;
       }
-      case InboundCmdType::FiltrationOnOff: {
-        payloadStr.toUpperCase();
-        // feature-027 : timeout → commande abandonnée (rien modifié avant le take),
-        // resync HA sur l'état réel du relais.
-        if (xSemaphoreTakeRecursive(configMutex, pdMS_TO_TICKS(kConfigMutexTimeoutMs)) != pdTRUE) {
-          static unsigned long sWarnFiltOnOffMs = 0;
-          warnConfigMutexTimeout(sWarnFiltOnOffMs, "cmd filtration_onoff");
-          publishFiltrationState();
-          break;
-        }
-        if (payloadStr == "ON") {
+      case MqttCommand::FiltrationOnOff: {
+        if (args.valid && args.on) {
           filtrationCfg.forceOn = true;
           filtrationCfg.forceOff = false;
           systemLogger.info("Filtration forcée ON (MQTT)");
-        } else if (payloadStr == "OFF") {
+        } else if (args.valid) {
           filtrationCfg.forceOn = false;
           filtrationCfg.forceOff = true;
           systemLogger.info("Filtration forcée OFF (MQTT)");
         }
-        xSemaphoreGiveRecursive(configMutex);
         // Pas de publish ici : filtration.update() va publier après changement réel du relais.
         break;
       }
-      case InboundCmdType::Lighting: {
-        payloadStr.toUpperCase();
-        if (payloadStr == "ON") {
-          lighting.setManualOn();
-        } else if (payloadStr == "OFF") {
-          lighting.setManualOff();
-        }
-        publishLightingState();
-        break;
-      }
-      case InboundCmdType::PhTarget: {
-        float value = payloadStr.toFloat();
-        if (value >= 6.0f && value <= 8.5f) {
-          // feature-027 : timeout → commande abandonnée (rien modifié avant le take),
-          // resync HA sur la consigne réelle via publishTargetState().
-          if (xSemaphoreTakeRecursive(configMutex, pdMS_TO_TICKS(kConfigMutexTimeoutMs)) != pdTRUE) {
-            static unsigned long sWarnPhTargetMs = 0;
-            warnConfigMutexTimeout(sWarnPhTargetMs, "cmd ph_target");
-            publishTargetState();
-            break;
-          }
-          mqttCfg.phTarget = value;
-          saveMqttConfig();
-          xSemaphoreGiveRecursive(configMutex);
-          publishTargetState();
-          systemLogger.info("Consigne pH changée via MQTT: " + String(value, 1));
+      case MqttCommand::PhTarget: {
+        if (args.valid) {
+          mqttCfg.phTarget = args.number;
+          persist = true;
+          publish |= kCmdPubTarget;
+          systemLogger.info("Consigne pH changée via MQTT: " + String(args.number, 1));
         } else {
           systemLogger.warning("Consigne pH invalide (MQTT): " + payloadStr);
         }
         break;
       }
-      case InboundCmdType::OrpTarget: {
-        float value = payloadStr.toFloat();
-        if (value >= 400.0f && value <= 900.0f) {
-          // feature-027 : timeout → commande abandonnée (rien modifié avant le take),
-          // resync HA sur la consigne réelle via publishTargetState().
-          if (xSemaphoreTakeRecursive(configMutex, pdMS_TO_TICKS(kConfigMutexTimeoutMs)) != pdTRUE) {
-            static unsigned long sWarnOrpTargetMs = 0;
-            warnConfigMutexTimeout(sWarnOrpTargetMs, "cmd orp_target");
-            publishTargetState();
-            break;
-          }
-          mqttCfg.orpTarget = value;
-          saveMqttConfig();
-          xSemaphoreGiveRecursive(configMutex);
-          publishTargetState();
-          systemLogger.info("Consigne ORP changée via MQTT: " + String(value, 0));
+      case MqttCommand::OrpTarget: {
+        if (args.valid) {
+          mqttCfg.orpTarget = args.number;
+          persist = true;
+          publish |= kCmdPubTarget;
+          systemLogger.info("Consigne ORP changée via MQTT: " + String(args.number, 0));
         } else {
           systemLogger.warning("Consigne ORP invalide (MQTT): " + payloadStr);
         }
         break;
       }
-      case InboundCmdType::PhRegulationMode: {
+      case MqttCommand::PhRegulationMode:
+      case MqttCommand::OrpRegulationMode: {
         // feature-009 : miroir exact de la logique web_routes_config.cpp (ADR-0004 :
-        // phEnabled dérivé du mode — "manual" désactive la régulation).
-        payloadStr.toLowerCase();
-        if (payloadStr == "automatic" || payloadStr == "scheduled" || payloadStr == "manual") {
-          // feature-027 : timeout → commande abandonnée (rien modifié avant le take),
-          // resync HA sur le mode réel via publishTargetState().
-          if (xSemaphoreTakeRecursive(configMutex, pdMS_TO_TICKS(kConfigMutexTimeoutMs)) != pdTRUE) {
-            static unsigned long sWarnPhRegModeMs = 0;
-            warnConfigMutexTimeout(sWarnPhRegModeMs, "cmd ph_regulation_mode");
-            publishTargetState();
-            break;
-          }
-          const bool changed = (mqttCfg.phRegulationMode != payloadStr);
-          if (changed) {
-            mqttCfg.phRegulationMode = payloadStr;
-            mqttCfg.phEnabled = (payloadStr != "manual");
-            saveMqttConfig();
-          }
-          xSemaphoreGiveRecursive(configMutex);
-          publishTargetState();
-          if (changed) {
-            systemLogger.info("Mode régulation pH changé (MQTT): " + payloadStr);
-          }
-        } else {
-          systemLogger.warning("Mode régulation pH invalide (MQTT): " + payloadStr);
-        }
-        break;
-      }
-      case InboundCmdType::OrpRegulationMode: {
-        payloadStr.toLowerCase();
-        if (payloadStr == "automatic" || payloadStr == "scheduled" || payloadStr == "manual") {
-          // feature-027 : timeout → commande abandonnée (rien modifié avant le take),
-          // resync HA sur le mode réel via publishTargetState().
-          if (xSemaphoreTakeRecursive(configMutex, pdMS_TO_TICKS(kConfigMutexTimeoutMs)) != pdTRUE) {
-            static unsigned long sWarnOrpRegModeMs = 0;
-            warnConfigMutexTimeout(sWarnOrpRegModeMs, "cmd orp_regulation_mode");
-            publishTargetState();
-            break;
-          }
-          const bool changed = (mqttCfg.orpRegulationMode != payloadStr);
-          if (changed) {
-            mqttCfg.orpRegulationMode = payloadStr;
-            mqttCfg.orpEnabled = (payloadStr != "manual");
-            saveMqttConfig();
-          }
-          xSemaphoreGiveRecursive(configMutex);
-          publishTargetState();
-          if (changed) {
-            systemLogger.info("Mode régulation ORP changé (MQTT): " + payloadStr);
-          }
-        } else {
-          systemLogger.warning("Mode régulation ORP invalide (MQTT): " + payloadStr);
-        }
-        break;
-      }
-      case InboundCmdType::PhDailyTarget: {
-        // feature-050 : volume quotidien pH (mode programmée) — pattern PhTarget.
-        if (!isNumericPayload(payloadStr)) {
-          systemLogger.warning("Volume quotidien pH invalide (MQTT): " + payloadStr);
+        // enabled dérivé du mode — "manual" désactive la régulation).
+        const bool isPh = (type == MqttCommand::PhRegulationMode);
+        if (!args.valid) {
+          systemLogger.warning(String("Mode régulation ") + (isPh ? "pH" : "ORP") + " invalide (MQTT): " + payloadStr);
           break;
         }
-        int value = payloadStr.toInt();
-        if (value < 0) value = 0;  // clamp négatif → 0 (0 = désactivé)
-        // feature-027 : timeout → commande abandonnée (rien modifié avant le take),
-        // resync HA sur la valeur réelle via publishTargetState().
-        if (xSemaphoreTakeRecursive(configMutex, pdMS_TO_TICKS(kConfigMutexTimeoutMs)) != pdTRUE) {
-          static unsigned long sWarnPhDailyMs = 0;
-          warnConfigMutexTimeout(sWarnPhDailyMs, "cmd ph_daily_target_ml");
-          publishTargetState();
-          break;
-        }
-        // Condition pool-chemistry feature-050 : validation contre la limite VIVE
-        // (maxPhMlPerDay) lue au moment du drain — refuse toute cible au-dessus
-        // du plafond journalier de sécurité configuré.
-        const int maxMl = (int)safetyLimits.maxPhMlPerDay;
-        if (safetyLimits.maxPhMlPerDay > 0 && value > maxMl) {
-          xSemaphoreGiveRecursive(configMutex);
-          systemLogger.warning("Volume quotidien pH refusé (MQTT): " + String(value) +
-                               " mL > limite journalière " + String(maxMl) + " mL");
-          publishTargetState();  // resync HA sur la valeur réelle
-          break;
-        }
-        const bool changed = (mqttCfg.phDailyTargetMl != value);
-        if (changed) {
-          mqttCfg.phDailyTargetMl = value;
-          saveMqttConfig();
-        }
-        xSemaphoreGiveRecursive(configMutex);
-        publishTargetState();
-        if (changed) {
-          systemLogger.info("Volume quotidien pH changé (MQTT): " + String(value) + " mL");
+        String& mode = isPh ? mqttCfg.phRegulationMode : mqttCfg.orpRegulationMode;
+        if (mode != payloadStr) {
+          mode = payloadStr;
+          (isPh ? mqttCfg.phEnabled : mqttCfg.orpEnabled) = (payloadStr != "manual");
+          persist = true;
+          systemLogger.info(String("Mode régulation ") + (isPh ? "pH" : "ORP") + " changé (MQTT): " + payloadStr);
         }
+        publish |= kCmdPubTarget;
         break;
       }
-      case InboundCmdType::OrpDailyTarget: {
-        // feature-050 : volume quotidien ORP (mode programmée) — symétrique pH.
-        if (!isNumericPayload(payloadStr)) {
-          systemLogger.warning("Volume quotidien Chlore invalide (MQTT): " + payloadStr);
-          break;
-        }
-        int value = payloadStr.toInt();
-        if (value < 0) value = 0;  // clamp négatif → 0 (0 = désactivé)
-        if (xSemaphoreTakeRecursive(configMutex, pdMS_TO_TICKS(kConfigMutexTimeoutMs)) != pdTRUE) {
-          static unsigned long sWarnOrpDailyMs = 0;
-          warnConfigMutexTimeout(sWarnOrpDailyMs, "cmd orp_daily_target_ml");
-          publishTargetState();
+      case MqttCommand::PhDailyTarget:
+      case MqttCommand::OrpDailyTarget: {
+        // feature-050 : volume quotidien (mode programmée).
+        const bool isPh = (type == MqttCommand::PhDailyTarget);
+        const char* label = isPh ? "pH" : "Chlore";
+        if (!args.valid) {
+          systemLogger.warning(String("Volume quotidien ") + label + " invalide (MQTT): " + payloadStr);
           break;
         }
-        // Condition pool-chemistry feature-050 : limite VIVE maxChlorineMlPerDay
-        // lue au moment du drain.
-        const int maxMl = (int)safetyLimits.maxChlorineMlPerDay;
-        if (safetyLimits.maxChlorineMlPerDay > 0 && value > maxMl) {
-          xSemaphoreGiveRecursive(configMutex);
-          systemLogger.warning("Volume quotidien Chlore refusé (MQTT): " + String(value) +
+        const int value = args.integer;  // négatif déjà ramené à 0 (0 = désactivé)
+        publish |= kCmdPubTarget;        // resync HA sur la valeur réelle dans tous les cas
+        // Condition pool-chemistry feature-050 : validation contre la limite VIVE
+        // (maxPhMlPerDay / maxChlorineMlPerDay) lue au moment du drain — refuse
+        // toute cible au-dessus du plafond journalier de sécurité configuré.
+        const float limit = isPh ? safetyLimits.maxPhMlPerDay : safetyLimits.maxChlorineMlPerDay;
+        const int maxMl = (int)limit;
+        if (limit > 0 && value > maxMl) {
+          systemLogger.warning(String("Volume quotidien ") + label + " refusé (MQTT): " + String(value) +
                                " mL > limite journalière " + String(maxMl) + " mL");
-          publishTargetState();  // resync HA sur la valeur réelle
           break;
         }
-        const bool changed = (mqttCfg.orpDailyTargetMl != value);
-        if (changed) {
-          mqttCfg.orpDailyTargetMl = value;
-          saveMqttConfig();
-        }
-        xSemaphoreGiveRecursive(configMutex);
-        publishTargetState();
-        if (changed) {
-          systemLogger.info("Volume quotidien Chlore changé (MQTT): " + String(value) + " mL");
+        int& target = isPh ? mqttCfg.phDailyTargetMl : mqttCfg.orpDailyTargetMl;
+        if (target != value) {
+          target = value;
+          persist = true;
+          systemLogger.info(String("Volume quotidien ") + label + " changé (MQTT): " + String(value) + " mL");
         }
         break;
       }
-      case InboundCmdType::Reboot: {
-        // feature-050 : tout payload accepté (le bouton HA envoie "PRESS").
-        // Redémarrage DIFFÉRÉ : flag consommé en tête de drainCommandQueue au
-        // prochain tour de loop, après kRestartApModeDelayMs — même séquence
-        // propre que la route POST /reboot (flush MQTT offline puis restart).
-        systemLogger.warning("Redémarrage demandé via MQTT/HA");
-        _rebootPending = true;
-        _rebootRequestedAtMs = millis();
-        break;
-      }
-      case InboundCmdType::FiltrationStart:
-      case InboundCmdType::FiltrationEnd: {
-        // feature-051 : heure de filtration (HH:MM). Validation via timeStringToMinutes
-        // (-1 = format invalide). Écrit sous configMutex, efface les overrides manuels
-        // (comme /save-config quand le planning change), applique via filtration.update(),
-        // persiste, republie. En mode auto les heures seront recalculées par la
-        // température au prochain update() → l'état republié reflète la valeur réelle.
-        const bool isStart = (cmd.type == InboundCmdType::FiltrationStart);
+      case MqttCommand::FiltrationStart:
+      case MqttCommand::FiltrationEnd: {
+        // feature-051 : heure de filtration (HH:MM), validée par timeStringToMinutes
+        // (mqtt_commands). Efface les overrides manuels (comme /save-config quand le
+        // planning change) ; filtration.update() en fin de lot applique le planning
+        // (recalcul si mode auto) → l'état republié reflète la valeur réelle.
+        const bool isStart = (type == MqttCommand::FiltrationStart);
         const char* label = isStart ? "début" : "fin";
-        if (timeStringToMinutes(payloadStr.c_str()) < 0) {
+        publish |= kCmdPubFiltration;  // resync HA sur la valeur réelle dans tous les cas
+        if (!args.valid) {
           systemLogger.warning(String("Heure filtration ") + label + " invalide (MQTT): " + payloadStr);
-          publishFiltrationState();  // resync HA sur la valeur réelle
-          break;
-        }
-        if (xSemaphoreTakeRecursive(configMutex, pdMS_TO_TICKS(kConfigMutexTimeoutMs)) != pdTRUE) {
-          static unsigned long sWarnFiltTimeMs = 0;
-          warnConfigMutexTimeout(sWarnFiltTimeMs, "cmd filtration_start/end");
-          publishFiltrationState();
           break;
         }
         String& target = isStart ? filtrationCfg.start : filtrationCfg.end;
@@ -1280,135 +1617,153 @@ void MqttManager::drainCommandQueue() {
           target = payloadStr;
           filtrationCfg.forceOn = false;   // le planning reprend effet immédiatement
           filtrationCfg.forceOff = false;
-          saveMqttConfig();
+          persist = true;
           systemLogger.info(String("Heure filtration ") + label + " changée (MQTT): " + payloadStr);
         }
-        xSemaphoreGiveRecursive(configMutex);
-        filtration.update();          // applique le nouveau planning (recalcul si mode auto)
-        publishFiltrationState();
+        updateFiltration = true;
         break;
       }
-      case InboundCmdType::LightingSchedule: {
-        // feature-052 : programmation éclairage (ON/OFF). Miroir de FiltrationOnOff :
-        // écrit lightingCfg.scheduleEnabled sous configMutex, persiste, applique via
-        // lighting.update(), republie. Payload invalide → warning + resync HA.
-        payloadStr.toUpperCase();
-        if (payloadStr != "ON" && payloadStr != "OFF") {
+      case MqttCommand::LightingSchedule: {
+        // feature-052 : programmation éclairage (ON/OFF), appliquée par lighting.update().
+        publish |= kCmdPubLighting;
+        if (!args.valid) {
           systemLogger.warning("Programmation éclairage invalide (MQTT): " + payloadStr);
-          publishLightingState();  // resync HA sur la valeur réelle
           break;
         }
-        if (xSemaphoreTakeRecursive(configMutex, pdMS_TO_TICKS(kConfigMutexTimeoutMs)) != pdTRUE) {
-          static unsigned long sWarnLightSchedMs = 0;
-          warnConfigMutexTimeout(sWarnLightSchedMs, "cmd lighting_schedule");
-          publishLightingState();
-          break;
-        }
-        const bool wanted = (payloadStr == "ON");
-        if (lightingCfg.scheduleEnabled != wanted) {
-          lightingCfg.scheduleEnabled = wanted;
-          saveMqttConfig();
-          systemLogger.info(String("Programmation éclairage ") + (wanted ? "activée" : "désactivée") + " (MQTT)");
+        if (lightingCfg.scheduleEnabled != args.on) {
+          lightingCfg.scheduleEnabled = args.on;
+          persist = true;
+          systemLogger.info(String("Programmation éclairage ") + (args.on ? "activée" : "désactivée") + " (MQTT)");
         }
-        xSemaphoreGiveRecursive(configMutex);
-        lighting.update();
-        publishLightingState();
+        updateLighting = true;
         break;
       }
-      case InboundCmdType::LightingStart:
-      case InboundCmdType::LightingEnd: {
-        // feature-052 : heure d'éclairage (HH:MM). Miroir de FiltrationStart/End :
-        // validation via timeStringToMinutes (-1 = invalide), écriture sous configMutex,
-        // persistance, application via lighting.update(), republish.
-        const bool isStart = (cmd.type == InboundCmdType::LightingStart);
+      case MqttCommand::LightingStart:
+      case MqttCommand::LightingEnd: {
+        // feature-052 : heure d'éclairage (HH:MM). Miroir de FiltrationStart/End.
+        const bool isStart = (type == MqttCommand::LightingStart);
         const char* label = isStart ? "début" : "fin";
-        if (timeStringToMinutes(payloadStr.c_str()) < 0) {
+        publish |= kCmdPubLighting;
+        if (!args.valid) {
           systemLogger.warning(String("Heure éclairage ") + label + " invalide (MQTT): " + payloadStr);
-          publishLightingState();  // resync HA sur la valeur réelle
-          break;
-        }
-        if (xSemaphoreTakeRecursive(configMutex, pdMS_TO_TICKS(kConfigMutexTimeoutMs)) != pdTRUE) {
-          static unsigned long sWarnLightTimeMs = 0;
-          warnConfigMutexTimeout(sWarnLightTimeMs, "cmd lighting_start/end");
-          publishLightingState();
           break;
         }
         String& target = isStart ? lightingCfg.startTime : lightingCfg.endTime;
         if (target != payloadStr) {
           target = payloadStr;
-          saveMqttConfig();
+          persist = true;
           systemLogger.info(String("Heure éclairage ") + label + " changée (MQTT): " + payloadStr);
         }
-        xSemaphoreGiveRecursive(configMutex);
-        lighting.update();
-        publishLightingState();
+        updateLighting = true;
         break;
       }
-      case InboundCmdType::Boost: {
+      case MqttCommand::InstallMode: {
+        // feature-056 : mode d'installation (managed/powered/external). Miroir de la
+        // route /save-config : parse strict, persiste, republie.
+        publish |= kCmdPubInstallMode;
+        InstallMode parsed = installModeFromString(args.text, mqttCfg.installMode);
+        if (!args.valid || payloadStr != installModeToString(parsed)) {
+          systemLogger.warning("Mode d'installation invalide (MQTT): " + payloadStr);
+          break;
+        }
+        if (mqttCfg.installMode != parsed) {
+          mqttCfg.installMode = parsed;
+          persist = true;
+          updateFiltration = true;  // applique l'inertie du relais selon le nouveau mode
+          systemLogger.info("Mode d'installation changé (MQTT): " + payloadStr);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  if (locked) {
+    // saveMqttConfig() reprend configMutex (récursif) : écriture NVS atomique
+    // vis-à-vis des autres tâches, une seule fois pour tout le lot.
+    if (persist) saveMqttConfig();
+    xSemaphoreGiveRecursive(configMutex);
+  }
+
+  // --------------------------------------------------------------------------
+  // 2) Actions directes — hors configMutex.
+  // --------------------------------------------------------------------------
+  for (size_t i = 0; i < _cmdBatch.size(); ++i) {
+    const MqttCommand type = _cmdBatch.type(i);
+    if (mqttCommandWritesConfig(type)) continue;
+    const MqttCommandArgs& args = _cmdBatch.args(i);
+    String payloadStr(args.text);
+    if (type != MqttCommand::Reboot) needConfigBroadcast = true;
+
+    switch (type) {
+      case MqttCommand::Lighting: {
+        if (args.valid && args.on) {
+          lighting.setManualOn();
+        } else if (args.valid) {
+          lighting.setManualOff();
+        }
+        publish |= kCmdPubLighting;
+        break;
+      }
+      case MqttCommand::Reboot: {
+        // feature-050 : tout payload accepté (le bouton HA envoie "PRESS").
+        // Redémarrage DIFFÉRÉ : flag consommé en tête de drainCommandQueue au
+        // prochain tour de loop, après kRestartApModeDelayMs — même séquence
+        // propre que la route POST /reboot (flush MQTT offline puis restart).
+        systemLogger.warning("Redémarrage demandé via MQTT/HA");
+        _rebootPending = true;
+        _rebootRequestedAtMs = millis();
+        break;
+      }
+      case MqttCommand::Boost: {
         // feature-053 : Mode Boost (ON/OFF). start/stopBoost prennent configMutex en
-        // interne (saveBoostState) et s'exécutent ici sur loopTask — jamais d'appel
-        // MQTT direct. startBoost refuse si l'heure n'est pas synchronisée (log warning).
-        // Republication de l'état réel via publishBoostState (resync HA sur payload
-        // invalide ou refus). Le broadcast WS config est assuré par needConfigBroadcast.
-        payloadStr.toUpperCase();
-        if (payloadStr == "ON") {
+        // interne (saveBoostState) — jamais d'appel MQTT direct. startBoost refuse si
+        // l'heure n'est pas synchronisée (log warning). État réel republié en fin de
+        // lot (resync HA sur payload invalide ou refus).
+        if (args.valid && args.on) {
           startBoost();
           systemLogger.info("[Boost] Activé via MQTT/HA");
-        } else if (payloadStr == "OFF") {
+        } else if (args.valid) {
           stopBoost();
           systemLogger.info("[Boost] Désactivé via MQTT/HA");
         } else {
           systemLogger.warning("Commande Boost invalide (MQTT): " + payloadStr);
         }
-        publishBoostState();
+        publish |= kCmdPubBoost;
         break;
       }
-      case InboundCmdType::InstallMode: {
-        // feature-056 : mode d'installation (managed/powered/external). Miroir de la
-        // route /save-config : parse strict, écrit sous configMutex, persiste, republie.
-        payloadStr.toLowerCase();
-        InstallMode parsed = installModeFromString(payloadStr.c_str(), mqttCfg.installMode);
-        if (payloadStr != installModeToString(parsed)) {
-          systemLogger.warning("Mode d'installation invalide (MQTT): " + payloadStr);
-          enqueueOutbound(topics.installModeState, installModeToString(mqttCfg.installMode), true);
-          break;
-        }
-        if (xSemaphoreTakeRecursive(configMutex, pdMS_TO_TICKS(kConfigMutexTimeoutMs)) != pdTRUE) {
-          static unsigned long sWarnInstallModeMs = 0;
-          warnConfigMutexTimeout(sWarnInstallModeMs, "cmd install_mode");
-          enqueueOutbound(topics.installModeState, installModeToString(mqttCfg.installMode), true);
-          break;
-        }
-        const bool changed = (mqttCfg.installMode != parsed);
-        if (changed) {
-          mqttCfg.installMode = parsed;
-          saveMqttConfig();
-        }
-        xSemaphoreGiveRecursive(configMutex);
-        if (changed) {
-          filtration.update();  // applique l'inertie du relais selon le nouveau mode
-          systemLogger.info("Mode d'installation changé (MQTT): " + payloadStr);
-        }
-        enqueueOutbound(topics.installModeState, installModeToString(mqttCfg.installMode), true);
-        break;
-      }
-      case InboundCmdType::FiltrationExternalState: {
+      case MqttCommand::FiltrationExternalState: {
         // feature-056 : signal d'état de la filtration externe (mode ExternalFiltration).
         // Même effet que POST /filtration/external-state. setExternalState est thread-safe
         // (spinlock interne, horodatage millis()) — appel direct sûr depuis loopTask.
-        payloadStr.toUpperCase();
-        if (payloadStr == "ON") {
+        if (args.valid && args.on) {
           filtration.setExternalState(true);
-        } else if (payloadStr == "OFF") {
+        } else if (args.valid) {
           filtration.setExternalState(false);
         } else {
           systemLogger.warning("Signal filtration externe invalide (MQTT): " + payloadStr);
         }
         break;
       }
+      default:
+        break;
     }
   }
 
+  // --------------------------------------------------------------------------
+  // 3) Effets différés — une fois par lot.
+  // --------------------------------------------------------------------------
+  if (updateFiltration) filtration.update();
+  if (updateLighting) lighting.update();
+  if (publish & kCmdPubFiltration) publishFiltrationState();
+  if (publish & kCmdPubLighting) publishLightingState();
+  if (publish & kCmdPubTarget) publishTargetState();
+  if (publish & kCmdPubBoost) publishBoostState();
+  if (publish & kCmdPubInstallMode) {
+    enqueueOutbound(MqttTopicId::InstallModeState, installModeToString(mqttCfg.installMode), true);
+  }
+
   // bug-sync-ws-config : notifier l'UI web du changement de config appliqué via HA
   // (broadcast WS "config" au prochain cycle, ≤ 5 s). Sans ça, l'UI ne voit le
   // changement qu'au rechargement de page.
@@ -1428,7 +1783,7 @@ void MqttManager::shutdownForRestart() {
   // On ne peut PAS publier directement depuis loopTask sans risquer le blocage qu'on
   // cherche justement à éviter — donc on enfile dans outQueue, on laisse mqttTask
   // drainer pendant kMqttOfflineFlushMs, puis on stoppe la tâche proprement.
-  enqueueOutbound(topics.statusTopic, "offline", true);
+  enqueueOutbound(MqttTopicId::Status, "offline", true);
 
   unsigned long deadline = millis() + kMqttOfflineFlushMs;
   while (millis() < deadline) {
@@ -1447,648 +1802,105 @@ void MqttManager::shutdownForRestart() {
 }
 
 // ============================================================================
-// publishDiscovery — exécuté UNIQUEMENT depuis mqttTask (lors de la connect réussie)
+// Auto-discovery HA incrémentale — exécutée UNIQUEMENT depuis mqttTask
 // ============================================================================
+// Table d'entités, sérialisation et hash : mqtt_discovery.cpp (pur). Ici : cache
+// NVS, passe étalée sur les itérations de taskLoop, publication retain.
 
-void MqttManager::publishDiscovery() {
-  if (!mqtt.connected() || discoveryPublished) return;
+namespace {
+constexpr const char* kDiscoveryNvsNamespace = "mqtt_disc";
+
+// Empreinte du broker : des configs retain publiées sur un autre broker ne
+// comptent pas comme publiées sur celui-ci.
+uint32_t brokerFingerprint() {
+  char port[8];
+  snprintf(port, sizeof(port), "%u", static_cast<unsigned>(mqttCfg.port));
+  return haDiscoveryHash(mqttCfg.server.c_str(), port);
+}
+}  // namespace
 
-  JsonDocument doc;
-  const String discoveryBase = String(HA_DISCOVERY_PREFIX) + "/";
-
-  auto makeDevice = [&](JsonObject device) {
-    device["name"] = HA_DEVICE_NAME;
-    device["manufacturer"] = "ESP32";
-    device["model"] = "Pool Controller";
-    JsonArray ids = device["identifiers"].to<JsonArray>();
-    ids.add(HA_DEVICE_ID);
-  };
-
-  auto publishConfig = [&](const String& configTopic) {
-    // safePublish() retourne false silencieusement si déconnecté, et reset le wdt avant publish.
-    String payload;
-    serializeJson(doc, payload);
-    bool ok = safePublish(configTopic.c_str(), payload.c_str(), true);
-    systemLogger.info("Discovery " + configTopic + (ok ? " OK" : " FAILED"));
-    doc.clear();
-  };
-
-  // Température
-  String topic = discoveryBase + "sensor/" + HA_DEVICE_ID + "_temperature/config";
-  doc["name"] = "Piscine Température";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_temperature";
-  doc["state_topic"] = topics.temperatureState;
-  doc["device_class"] = "temperature";
-  doc["unit_of_measurement"] = "°C";
-  doc["state_class"] = "measurement";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // Température circuit (feature-020 : 2ᵉ sonde DS18B20 sur PCB v2)
-  topic = discoveryBase + "sensor/" + HA_DEVICE_ID + "_temperature_circuit/config";
-  doc["name"] = "Piscine Température Circuit";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_temperature_circuit";
-  doc["state_topic"] = topics.temperatureCircuitState;
-  doc["device_class"] = "temperature";
-  doc["unit_of_measurement"] = "°C";
-  doc["state_class"] = "measurement";
-  doc["icon"] = "mdi:chip";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // pH
-  topic = discoveryBase + "sensor/" + HA_DEVICE_ID + "_ph/config";
-  doc["name"] = "Piscine pH";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_ph";
-  doc["state_topic"] = topics.phState;
-  doc["unit_of_measurement"] = "pH";
-  doc["icon"] = "mdi:water";
-  doc["state_class"] = "measurement";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // ORP
-  topic = discoveryBase + "sensor/" + HA_DEVICE_ID + "_orp/config";
-  doc["name"] = "Piscine ORP";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_orp";
-  doc["state_topic"] = topics.orpState;
-  doc["unit_of_measurement"] = "mV";
-  doc["icon"] = "mdi:flash";
-  doc["state_class"] = "measurement";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // Filtration
-  topic = discoveryBase + "binary_sensor/" + HA_DEVICE_ID + "_filtration/config";
-  doc["name"] = "Filtration Active";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_filtration";
-  doc["state_topic"] = topics.filtrationState;
-  doc["payload_on"] = "ON";
-  doc["payload_off"] = "OFF";
-  doc["device_class"] = "running";
-  doc["icon"] = "mdi:water-pump";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // Mode filtration
-  topic = discoveryBase + "select/" + HA_DEVICE_ID + "_filtration_mode/config";
-  doc["name"] = "Mode Filtration";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_filtration_mode";
-  doc["state_topic"] = topics.filtrationModeState;
-  doc["command_topic"] = topics.filtrationModeCommand;
-  doc["icon"] = "mdi:water-pump";
-  // bug-ha-filtration-mode-labels : libellés français dans HA, protocole MQTT
-  // inchangé sur le fil. value_template traduit l'état brut publié → libellé ;
-  // command_template retraduit le libellé choisi → valeur brute envoyée au /set
-  // (le handler drainCommandQueue continue de recevoir auto/manual/force/off).
-  // Sémantique : manual = « Programmation » (créneau à heures fixées), force =
-  // « Manuel » (contrôle ON/OFF sans planning) — d'où la levée d'ambiguïté.
-  JsonArray options = doc["options"].to<JsonArray>();
-  options.add("Auto");
-  options.add("Programmation");
-  options.add("Manuel");
-  options.add("Désactivé");
-  doc["value_template"] =
-    "{{ {'auto':'Auto','manual':'Programmation','force':'Manuel','off':'Désactivé'}.get(value, value) }}";
-  doc["command_template"] =
-    "{{ {'Auto':'auto','Programmation':'manual','Manuel':'force','Désactivé':'off'}[value] }}";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);  // publishConfig fait doc.clear() → pas de fuite vers les blocs suivants
-
-  // feature-051 : heures de filtration (text éditable HH:MM). Effet réel en mode
-  // Programmation ; en mode Auto elles sont recalculées par la température.
-  topic = discoveryBase + "text/" + HA_DEVICE_ID + "_filtration_start/config";
-  doc["name"] = "Filtration début";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_filtration_start";
-  doc["state_topic"] = topics.filtrationStartState;
-  doc["command_topic"] = topics.filtrationStartCommand;
-  doc["pattern"] = "^([01][0-9]|2[0-3]):[0-5][0-9]$";
-  doc["min"] = 5;
-  doc["max"] = 5;
-  doc["icon"] = "mdi:clock-start";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  topic = discoveryBase + "text/" + HA_DEVICE_ID + "_filtration_end/config";
-  doc["name"] = "Filtration fin";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_filtration_end";
-  doc["state_topic"] = topics.filtrationEndState;
-  doc["command_topic"] = topics.filtrationEndCommand;
-  doc["pattern"] = "^([01][0-9]|2[0-3]):[0-5][0-9]$";
-  doc["min"] = 5;
-  doc["max"] = 5;
-  doc["icon"] = "mdi:clock-end";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // Mode régulation pH (feature-009)
-  topic = discoveryBase + "select/" + HA_DEVICE_ID + "_ph_regulation_mode/config";
-  doc["name"] = "Mode Régulation pH";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_ph_regulation_mode";
-  doc["state_topic"] = topics.phRegulationModeState;
-  doc["command_topic"] = topics.phRegulationModeCommand;
-  doc["icon"] = "mdi:ph";
-  // bug-ha-regulation-mode-labels : libellés français dans HA (comme le mode
-  // filtration), protocole sur le fil inchangé (automatic/scheduled/manual).
-  {
-    JsonArray phRegOptions = doc["options"].to<JsonArray>();
-    phRegOptions.add("Automatique");
-    phRegOptions.add("Programmée");
-    phRegOptions.add("Manuelle");
-  }
-  doc["value_template"] =
-    "{{ {'automatic':'Automatique','scheduled':'Programmée','manual':'Manuelle'}.get(value, value) }}";
-  doc["command_template"] =
-    "{{ {'Automatique':'automatic','Programmée':'scheduled','Manuelle':'manual'}[value] }}";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);  // publishConfig fait doc.clear() → pas de fuite value/command_template
-
-  // Mode régulation ORP (feature-009)
-  topic = discoveryBase + "select/" + HA_DEVICE_ID + "_orp_regulation_mode/config";
-  doc["name"] = "Mode Régulation ORP";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_orp_regulation_mode";
-  doc["state_topic"] = topics.orpRegulationModeState;
-  doc["command_topic"] = topics.orpRegulationModeCommand;
-  doc["icon"] = "mdi:flash";
-  // bug-ha-regulation-mode-labels : idem pH (protocole inchangé sur le fil)
-  {
-    JsonArray orpRegOptions = doc["options"].to<JsonArray>();
-    orpRegOptions.add("Automatique");
-    orpRegOptions.add("Programmée");
-    orpRegOptions.add("Manuelle");
-  }
-  doc["value_template"] =
-    "{{ {'automatic':'Automatique','scheduled':'Programmée','manual':'Manuelle'}.get(value, value) }}";
-  doc["command_template"] =
-    "{{ {'Automatique':'automatic','Programmée':'scheduled','Manuelle':'manual'}[value] }}";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);  // publishConfig fait doc.clear() → pas de fuite value/command_template
-
-  // Switch filtration ON/OFF
-  topic = discoveryBase + "switch/" + HA_DEVICE_ID + "_filtration_switch/config";
-  doc["name"] = "Filtration Marche/Arrêt";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_filtration_switch";
-  doc["state_topic"] = topics.filtrationState;
-  doc["command_topic"] = topics.filtrationCommand;
-  doc["payload_on"] = "ON";
-  doc["payload_off"] = "OFF";
-  doc["state_on"] = "ON";
-  doc["state_off"] = "OFF";
-  doc["icon"] = "mdi:water-pump";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // Switch éclairage ON/OFF
-  topic = discoveryBase + "switch/" + HA_DEVICE_ID + "_lighting/config";
-  doc["name"] = "Éclairage Piscine";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_lighting";
-  doc["state_topic"] = topics.lightingState;
-  doc["command_topic"] = topics.lightingCommand;
-  doc["payload_on"] = "ON";
-  doc["payload_off"] = "OFF";
-  doc["state_on"] = "ON";
-  doc["state_off"] = "OFF";
-  doc["icon"] = "mdi:pool";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // feature-053 : switch Mode Boost (surchloration temporaire du jour, auto-off à minuit)
-  topic = discoveryBase + "switch/" + HA_DEVICE_ID + "_boost/config";
-  doc["name"] = "Boost";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_boost";
-  doc["state_topic"] = topics.boostState;
-  doc["command_topic"] = topics.boostCommand;
-  doc["payload_on"] = "ON";
-  doc["payload_off"] = "OFF";
-  doc["state_on"] = "ON";
-  doc["state_off"] = "OFF";
-  doc["icon"] = "mdi:rocket-launch";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // feature-056 : Mode d'installation (select managed/powered/external). Libellés FR
-  // dans HA, protocole inchangé sur le fil (managed/powered/external) via
-  // value_template/command_template — même pattern que le select Mode Filtration.
-  topic = discoveryBase + "select/" + HA_DEVICE_ID + "_install_mode/config";
-  doc["name"] = "Mode d'installation";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_install_mode";
-  doc["state_topic"] = topics.installModeState;
-  doc["command_topic"] = topics.installModeCommand;
-  doc["icon"] = "mdi:pipe-valve";
-  {
-    JsonArray installOpts = doc["options"].to<JsonArray>();
-    installOpts.add("PoolController pilote");
-    installOpts.add("Alimenté par filtration");
-    installOpts.add("Filtration externe");
-  }
-  doc["value_template"] =
-    "{{ {'managed':'PoolController pilote','powered':'Alimenté par filtration','external':'Filtration externe'}.get(value, value) }}";
-  doc["command_template"] =
-    "{{ {'PoolController pilote':'managed','Alimenté par filtration':'powered','Filtration externe':'external'}[value] }}";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);  // publishConfig fait doc.clear() → pas de fuite value/command_template
-
-  // feature-056 : signal d'état de la filtration EXTERNE (mode ExternalFiltration).
-  // Switch optimiste (pas de state_topic → assumed_state) : permet à une automation
-  // HA de signaler l'état réel de la filtration tierce vers le contrôleur. Le
-  // contrôleur applique la garde « présence d'eau » sur ce signal (timeout fail-safe).
-  topic = discoveryBase + "switch/" + HA_DEVICE_ID + "_filtration_external/config";
-  doc["name"] = "Signal filtration externe";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_filtration_external";
-  doc["command_topic"] = topics.filtrationExternalStateCommand;
-  doc["payload_on"] = "ON";
-  doc["payload_off"] = "OFF";
-  doc["optimistic"] = true;
-  doc["icon"] = "mdi:water-sync";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // bug-ha-eclairage-select : programmation éclairage exposée en SELECT
-  // (Programmation/Désactivé) pour cohérence avec le select Mode Filtration.
-  // Protocole inchangé sur le fil (ON/OFF) : value_template/command_template
-  // traduisent seulement l'affichage HA. Backend booléen + handler LightingSchedule
-  // (reçoit ON/OFF) inchangés.
-  // Nettoyage migration : retirer l'ancien switch orphelin (feature-052) de HA.
-  safePublish((discoveryBase + "switch/" + HA_DEVICE_ID + "_lighting_schedule/config").c_str(), "", true);
-  topic = discoveryBase + "select/" + HA_DEVICE_ID + "_lighting_schedule/config";
-  doc["name"] = "Mode Éclairage";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_lighting_schedule";
-  doc["state_topic"] = topics.lightingScheduleState;
-  doc["command_topic"] = topics.lightingScheduleCommand;
-  doc["icon"] = "mdi:calendar-clock";
-  {
-    JsonArray lightOpts = doc["options"].to<JsonArray>();
-    lightOpts.add("Programmation");
-    lightOpts.add("Désactivé");
-  }
-  doc["value_template"] =
-    "{{ {'ON':'Programmation','OFF':'Désactivé'}.get(value, value) }}";
-  doc["command_template"] =
-    "{{ {'Programmation':'ON','Désactivé':'OFF'}[value] }}";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);  // publishConfig fait doc.clear() → pas de fuite value/command_template
-
-  // feature-052 : heures d'éclairage (text éditable HH:MM). Effet réel en mode Programmation.
-  topic = discoveryBase + "text/" + HA_DEVICE_ID + "_lighting_start/config";
-  doc["name"] = "Éclairage début";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_lighting_start";
-  doc["state_topic"] = topics.lightingStartState;
-  doc["command_topic"] = topics.lightingStartCommand;
-  doc["pattern"] = "^([01][0-9]|2[0-3]):[0-5][0-9]$";
-  doc["min"] = 5;
-  doc["max"] = 5;
-  doc["icon"] = "mdi:clock-start";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  topic = discoveryBase + "text/" + HA_DEVICE_ID + "_lighting_end/config";
-  doc["name"] = "Éclairage fin";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_lighting_end";
-  doc["state_topic"] = topics.lightingEndState;
-  doc["command_topic"] = topics.lightingEndCommand;
-  doc["pattern"] = "^([01][0-9]|2[0-3]):[0-5][0-9]$";
-  doc["min"] = 5;
-  doc["max"] = 5;
-  doc["icon"] = "mdi:clock-end";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // Dosage pH actif
-  topic = discoveryBase + "binary_sensor/" + HA_DEVICE_ID + "_ph_dosing/config";
-  doc["name"] = "Dosage pH Actif";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_ph_dosing";
-  doc["state_topic"] = topics.phDosingState;
-  doc["payload_on"] = "ON";
-  doc["payload_off"] = "OFF";
-  doc["icon"] = "mdi:water-plus";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // Dosage ORP actif
-  topic = discoveryBase + "binary_sensor/" + HA_DEVICE_ID + "_orp_dosing/config";
-  doc["name"] = "Dosage Chlore Actif";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_orp_dosing";
-  doc["state_topic"] = topics.orpDosingState;
-  doc["payload_on"] = "ON";
-  doc["payload_off"] = "OFF";
-  doc["icon"] = "mdi:flask";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // Limite pH atteinte
-  topic = discoveryBase + "binary_sensor/" + HA_DEVICE_ID + "_ph_limit/config";
-  doc["name"] = "Limite Journalière pH";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_ph_limit";
-  doc["state_topic"] = topics.phLimitState;
-  doc["payload_on"] = "ON";
-  doc["payload_off"] = "OFF";
-  doc["device_class"] = "problem";
-  doc["icon"] = "mdi:alert";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // Limite ORP atteinte
-  topic = discoveryBase + "binary_sensor/" + HA_DEVICE_ID + "_orp_limit/config";
-  doc["name"] = "Limite Journalière Chlore";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_orp_limit";
-  doc["state_topic"] = topics.orpLimitState;
-  doc["payload_on"] = "ON";
-  doc["payload_off"] = "OFF";
-  doc["device_class"] = "problem";
-  doc["icon"] = "mdi:alert";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // feature-022 : problème capteur pH (stale OU figé)
-  topic = discoveryBase + "binary_sensor/" + HA_DEVICE_ID + "_ph_sensor_problem/config";
-  doc["name"] = "Capteur pH — problème";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_ph_sensor_problem";
-  doc["state_topic"] = topics.phSensorProblemState;
-  doc["payload_on"] = "ON";
-  doc["payload_off"] = "OFF";
-  doc["device_class"] = "problem";
-  doc["icon"] = "mdi:alert";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // feature-022 : problème capteur ORP (stale OU figé)
-  topic = discoveryBase + "binary_sensor/" + HA_DEVICE_ID + "_orp_sensor_problem/config";
-  doc["name"] = "Capteur ORP — problème";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_orp_sensor_problem";
-  doc["state_topic"] = topics.orpSensorProblemState;
-  doc["payload_on"] = "ON";
-  doc["payload_off"] = "OFF";
-  doc["device_class"] = "problem";
-  doc["icon"] = "mdi:alert";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // Stock pH faible
-  topic = discoveryBase + "binary_sensor/" + HA_DEVICE_ID + "_ph_stock_low/config";
-  doc["name"] = "Stock pH Faible";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_ph_stock_low";
-  doc["state_topic"] = topics.phStockLowState;
-  doc["payload_on"] = "ON";
-  doc["payload_off"] = "OFF";
-  doc["device_class"] = "problem";
-  doc["icon"] = "mdi:bottle-tonic-outline";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // Stock ORP faible
-  topic = discoveryBase + "binary_sensor/" + HA_DEVICE_ID + "_orp_stock_low/config";
-  doc["name"] = "Stock Chlore Faible";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_orp_stock_low";
-  doc["state_topic"] = topics.orpStockLowState;
-  doc["payload_on"] = "ON";
-  doc["payload_off"] = "OFF";
-  doc["device_class"] = "problem";
-  doc["icon"] = "mdi:bottle-tonic-outline";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // Volume pH restant
-  topic = discoveryBase + "sensor/" + HA_DEVICE_ID + "_ph_remaining/config";
-  doc["name"] = "Volume pH Restant";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_ph_remaining";
-  doc["state_topic"] = topics.phRemainingState;
-  doc["unit_of_measurement"] = "mL";
-  doc["icon"] = "mdi:cup-water";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // Volume ORP restant
-  topic = discoveryBase + "sensor/" + HA_DEVICE_ID + "_orp_remaining/config";
-  doc["name"] = "Volume Chlore Restant";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_orp_remaining";
-  doc["state_topic"] = topics.orpRemainingState;
-  doc["unit_of_measurement"] = "mL";
-  doc["icon"] = "mdi:cup-water";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // feature-050 : cumul pH injecté aujourd'hui (mL — retombe à 0 à minuit)
-  topic = discoveryBase + "sensor/" + HA_DEVICE_ID + "_ph_daily_ml/config";
-  doc["name"] = "Dosage pH aujourd'hui";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_ph_daily_ml";
-  doc["state_topic"] = topics.phDailyMlState;
-  doc["unit_of_measurement"] = "mL";
-  doc["icon"] = "mdi:beaker-outline";
-  doc["state_class"] = "measurement";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // feature-050 : cumul chlore injecté aujourd'hui (mL — retombe à 0 à minuit)
-  topic = discoveryBase + "sensor/" + HA_DEVICE_ID + "_orp_daily_ml/config";
-  doc["name"] = "Dosage Chlore aujourd'hui";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_orp_daily_ml";
-  doc["state_topic"] = topics.orpDailyMlState;
-  doc["unit_of_measurement"] = "mL";
-  doc["icon"] = "mdi:beaker-outline";
-  doc["state_class"] = "measurement";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // Consigne pH
-  topic = discoveryBase + "number/" + HA_DEVICE_ID + "_ph_target/config";
-  doc["name"] = "Consigne pH";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_ph_target";
-  doc["state_topic"] = topics.phTargetState;
-  doc["command_topic"] = topics.phTargetCommand;
-  doc["min"] = 6.0;
-  doc["max"] = 8.5;
-  doc["step"] = 0.1;
-  doc["unit_of_measurement"] = "pH";
-  doc["icon"] = "mdi:water";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // Consigne ORP
-  topic = discoveryBase + "number/" + HA_DEVICE_ID + "_orp_target/config";
-  doc["name"] = "Consigne ORP";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_orp_target";
-  doc["state_topic"] = topics.orpTargetState;
-  doc["command_topic"] = topics.orpTargetCommand;
-  doc["min"] = 400;
-  doc["max"] = 900;
-  doc["step"] = 10;
-  doc["unit_of_measurement"] = "mV";
-  doc["icon"] = "mdi:flash";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // feature-050 : volume quotidien pH programmé (mode Programmée) — commandable.
-  // Borne haute discovery = 2000 mL ; la limite VIVE maxPhMlPerDay est revalidée
-  // au drain de la commande ET plafonne de toute façon le dosage en aval.
-  topic = discoveryBase + "number/" + HA_DEVICE_ID + "_ph_daily_target/config";
-  doc["name"] = "Volume quotidien pH";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_ph_daily_target";
-  doc["state_topic"] = topics.phDailyTargetMlState;
-  doc["command_topic"] = topics.phDailyTargetMlCommand;
-  doc["min"] = 0;
-  doc["max"] = 2000;
-  doc["step"] = 10;
-  doc["unit_of_measurement"] = "mL";
-  doc["mode"] = "box";
-  doc["icon"] = "mdi:beaker-plus-outline";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // feature-050 : volume quotidien Chlore programmé — symétrique pH.
-  topic = discoveryBase + "number/" + HA_DEVICE_ID + "_orp_daily_target/config";
-  doc["name"] = "Volume quotidien Chlore";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_orp_daily_target";
-  doc["state_topic"] = topics.orpDailyTargetMlState;
-  doc["command_topic"] = topics.orpDailyTargetMlCommand;
-  doc["min"] = 0;
-  doc["max"] = 2000;
-  doc["step"] = 10;
-  doc["unit_of_measurement"] = "mL";
-  doc["mode"] = "box";
-  doc["icon"] = "mdi:beaker-plus-outline";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // feature-050 : bouton redémarrage (séquence propre — cf. drainCommandQueue)
-  topic = discoveryBase + "button/" + HA_DEVICE_ID + "_reboot/config";
-  doc["name"] = "Redémarrer";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_reboot";
-  doc["command_topic"] = topics.rebootCommand;
-  doc["payload_press"] = "PRESS";
-  doc["device_class"] = "restart";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // Binary sensor status
-  topic = discoveryBase + "binary_sensor/" + HA_DEVICE_ID + "_status/config";
-  doc["name"] = "Contrôleur Status";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_status";
-  doc["state_topic"] = topics.statusTopic;
-  doc["payload_on"] = "online";
-  doc["payload_off"] = "offline";
-  doc["device_class"] = "connectivity";
-  doc["icon"] = "mdi:wifi-check";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // feature-021 : nb points calibration pH (entier -1..3, -1 = EZO injoignable)
-  topic = discoveryBase + "sensor/" + HA_DEVICE_ID + "_ph_cal_points/config";
-  doc["name"] = "Piscine pH Points Calibrés";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_ph_cal_points";
-  doc["state_topic"] = topics.phCalPointsState;
-  doc["icon"] = "mdi:numeric";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // feature-021 : nb points calibration ORP (entier -1..1)
-  topic = discoveryBase + "sensor/" + HA_DEVICE_ID + "_orp_cal_points/config";
-  doc["name"] = "Piscine ORP Points Calibrés";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_orp_cal_points";
-  doc["state_topic"] = topics.orpCalPointsState;
-  doc["icon"] = "mdi:numeric";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // feature-024 : pente sonde pH — % côté acide (idéal 100%)
-  topic = discoveryBase + "sensor/" + HA_DEVICE_ID + "_ph_slope_acid/config";
-  doc["name"] = "Piscine pH Pente Acide";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_ph_slope_acid";
-  doc["state_topic"] = topics.phSlopeAcidState;
-  doc["unit_of_measurement"] = "%";
-  doc["icon"] = "mdi:angle-acute";
-  doc["state_class"] = "measurement";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // feature-024 : pente sonde pH — % côté base (idéal 100%)
-  topic = discoveryBase + "sensor/" + HA_DEVICE_ID + "_ph_slope_base/config";
-  doc["name"] = "Piscine pH Pente Base";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_ph_slope_base";
-  doc["state_topic"] = topics.phSlopeBaseState;
-  doc["unit_of_measurement"] = "%";
-  doc["icon"] = "mdi:angle-obtuse";
-  doc["state_class"] = "measurement";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // feature-024 : pente sonde pH — décalage zéro en mV (idéal 0 mV).
-  // Peut rester NaN/non publié si le firmware EZO ne rapporte pas le 3ᵉ float.
-  topic = discoveryBase + "sensor/" + HA_DEVICE_ID + "_ph_slope_zero/config";
-  doc["name"] = "Piscine pH Décalage Zéro";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_ph_slope_zero";
-  doc["state_topic"] = topics.phSlopeZeroState;
-  doc["unit_of_measurement"] = "mV";
-  doc["icon"] = "mdi:sine-wave";
-  doc["state_class"] = "measurement";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // feature-025 : sonde pH brut (mesure Atlas non filtrée — diagnostic EMI)
-  topic = discoveryBase + "sensor/" + HA_DEVICE_ID + "_ph_raw/config";
-  doc["name"] = "Piscine pH Brut";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_ph_raw";
-  doc["state_topic"] = topics.phRawState;
-  doc["unit_of_measurement"] = "pH";
-  doc["icon"] = "mdi:water-outline";
-  doc["state_class"] = "measurement";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // feature-025 : sonde pH filtré (médiane + EMA — valeur de régulation)
-  topic = discoveryBase + "sensor/" + HA_DEVICE_ID + "_ph_filtered/config";
-  doc["name"] = "Piscine pH Filtré";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_ph_filtered";
-  doc["state_topic"] = topics.phFilteredState;
-  doc["unit_of_measurement"] = "pH";
-  doc["icon"] = "mdi:water-check";
-  doc["state_class"] = "measurement";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // feature-025 : sonde ORP brut (mV)
-  topic = discoveryBase + "sensor/" + HA_DEVICE_ID + "_orp_raw/config";
-  doc["name"] = "Piscine ORP Brut";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_orp_raw";
-  doc["state_topic"] = topics.orpRawState;
-  doc["unit_of_measurement"] = "mV";
-  doc["icon"] = "mdi:flash-outline";
-  doc["state_class"] = "measurement";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // feature-025 : sonde ORP filtré (mV — valeur de régulation)
-  topic = discoveryBase + "sensor/" + HA_DEVICE_ID + "_orp_filtered/config";
-  doc["name"] = "Piscine ORP Filtré";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_orp_filtered";
-  doc["state_topic"] = topics.orpFilteredState;
-  doc["unit_of_measurement"] = "mV";
-  doc["icon"] = "mdi:flash-alert";
-  doc["state_class"] = "measurement";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // feature-025 : binary_sensor Filtre pH prêt
-  topic = discoveryBase + "binary_sensor/" + HA_DEVICE_ID + "_ph_filter_ready/config";
-  doc["name"] = "Piscine Filtre pH Prêt";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_ph_filter_ready";
-  doc["state_topic"] = topics.phFilterReadyState;
-  doc["payload_on"] = "ON";
-  doc["payload_off"] = "OFF";
-  doc["icon"] = "mdi:filter-check";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  // feature-025 : binary_sensor Filtre ORP prêt
-  topic = discoveryBase + "binary_sensor/" + HA_DEVICE_ID + "_orp_filter_ready/config";
-  doc["name"] = "Piscine Filtre ORP Prêt";
-  doc["unique_id"] = String(HA_DEVICE_ID) + "_orp_filter_ready";
-  doc["state_topic"] = topics.orpFilterReadyState;
-  doc["payload_on"] = "ON";
-  doc["payload_off"] = "OFF";
-  doc["icon"] = "mdi:filter-check";
-  makeDevice(doc["device"].to<JsonObject>());
-  publishConfig(topic);
-
-  discoveryPublished = true;
-  systemLogger.info("Home Assistant discovery publié");
+void MqttManager::loadDiscoveryCache() {
+  Preferences prefs;
+  if (!prefs.begin(kDiscoveryNvsNamespace, true)) return;  // 1er boot : namespace absent
+  uint8_t blob[HaDiscoveryCache::dataSize()];
+  const size_t len = prefs.getBytesLength("hashes");
+  if (len == sizeof(blob) && prefs.getBytes("hashes", blob, sizeof(blob)) == sizeof(blob) &&
+      _discoveryCache.load(blob, len)) {
+    _discoveryBroker = prefs.getUInt("broker", 0);
+  }
+  prefs.end();
+}
+
+void MqttManager::saveDiscoveryCache() {
+  Preferences prefs;
+  if (!prefs.begin(kDiscoveryNvsNamespace, false)) {
+    systemLogger.warning("MQTT: NVS indisponible — cache discovery non sauvegardé");
+    return;
+  }
+  prefs.putUInt("broker", _discoveryBroker);
+  prefs.putBytes("hashes", _discoveryCache.data(), HaDiscoveryCache::dataSize());
+  prefs.end();
+  _discoveryCache.clearDirty();
+}
+
+void MqttManager::startDiscovery() {
+  const uint32_t broker = brokerFingerprint();
+  if (broker != _discoveryBroker) {
+    _discoveryCache.invalidate();
+    _discoveryBroker = broker;
+  }
+  _discoveryActive = true;
+  _discoveryCursor = 0;
+  _discoverySent = 0;
+  _discoverySkipped = 0;
+  _discoveryFailed = 0;
+}
+
+void MqttManager::publishDiscoveryStep() {
+  if (!_discoveryActive || !mqtt.connected()) return;
+
+  const HaDiscoveryContext ctx{&topics, mqttCfg.stateJson, HA_DISCOVERY_PREFIX, HA_DEVICE_ID,
+                               HA_DEVICE_NAME};
+  size_t published = 0;
+  for (size_t evaluated = 0;
+       evaluated < kHaDiscoveryEvalBurst && published < kHaDiscoveryPublishBurst &&
+       _discoveryCursor < kHaEntityCount;
+       ++evaluated) {
+    const size_t i = _discoveryCursor++;
+    const HaEntity& e = kHaEntities[i];
+    const bool built =
+        haDiscoveryTopic(e, ctx, _discoveryTopic, sizeof(_discoveryTopic)) > 0 &&
+        (haDiscoveryPayload(e, ctx, _discoveryPayload, sizeof(_discoveryPayload)) > 0 ||
+         e.name == nullptr);
+    if (!built) {
+      // Tampons dimensionnés par test_native_mqtt_discovery : ne doit pas arriver.
+      _discoveryFailed++;
+      continue;
+    }
+    const uint32_t hash = haDiscoveryHash(_discoveryTopic, _discoveryPayload);
+    if (_discoveryCache.isPublished(i, hash)) {
+      _discoverySkipped++;
+      continue;
+    }
+    // safePublish() retourne false si déconnecté, et reset le wdt avant publish.
+    if (safePublish(_discoveryTopic, _discoveryPayload, true)) {
+      _discoveryCache.markPublished(i, hash);
+      _discoverySent++;
+    } else {
+      _discoveryFailed++;  // Non mémorisée : retentée à la prochaine passe
+    }
+    published++;
+  }
+
+  if (_discoveryCursor < kHaEntityCount) return;
+
+  _discoveryActive = false;
+  const String summary = "Home Assistant discovery : " + String(_discoverySent) + " publiée(s), " +
+                         String(_discoverySkipped) + " inchangée(s)";
+  if (_discoveryFailed > 0) {
+    systemLogger.warning(summary + ", " + String(_discoveryFailed) + " échec(s)");
+  } else {
+    systemLogger.info(summary);
+  }
+  if (_discoveryCache.dirty()) saveDiscoveryCache();
 }
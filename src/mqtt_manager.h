@@ -8,97 +8,23 @@
 #include <freertos/queue.h>
 #include <freertos/task.h>
 #include <atomic>
-
-struct MqttTopics {
-  String base;
-  String temperatureState;
-  String temperatureCircuitState;  // feature-020 : T° circuit (2ᵉ sonde DS18B20)
-  String phState;
-  String orpState;
-  String filtrationState;
-  String filtrationModeState;
-  String filtrationModeCommand;
-  String filtrationCommand;    // ON/OFF switch command
-  String filtrationStartState;    // feature-051 : heure début (HH:MM)
-  String filtrationEndState;      // feature-051 : heure fin (HH:MM)
-  String filtrationStartCommand;  // feature-051 : .../filtration_start/set
-  String filtrationEndCommand;    // feature-051 : .../filtration_end/set
-  String lightingState;        // État éclairage
-  String lightingCommand;      // ON/OFF switch command
-  String lightingScheduleState;    // feature-052 : programmation éclairage (ON/OFF)
-  String lightingScheduleCommand;  // feature-052 : .../lighting_schedule/set
-  String lightingStartState;       // feature-052 : heure début éclairage (HH:MM)
-  String lightingEndState;         // feature-052 : heure fin éclairage (HH:MM)
-  String lightingStartCommand;     // feature-052 : .../lighting_start/set
-  String lightingEndCommand;       // feature-052 : .../lighting_end/set
-  String phDosageState;
-  String orpDosageState;
-  String phDosingState;        // Pompe pH active (ON/OFF)
-  String orpDosingState;       // Pompe ORP active (ON/OFF)
-  String phLimitState;         // Limite journalière pH atteinte (ON/OFF)
-  String orpLimitState;        // Limite journalière ORP atteinte (ON/OFF)
-  String phStockLowState;      // Stock pH faible (ON/OFF)
-  String orpStockLowState;     // Stock ORP faible (ON/OFF)
-  String phRemainingState;     // Volume pH restant (ml)
-  String orpRemainingState;    // Volume ORP restant (ml)
-  String phTargetState;        // Consigne pH (état)
-  String orpTargetState;       // Consigne ORP (état)
-  String phTargetCommand;      // Consigne pH (commande)
-  String orpTargetCommand;     // Consigne ORP (commande)
-  String phRegulationModeState;    // Mode de régulation pH (automatic/scheduled/manual)
-  String phDailyTargetMlState;     // Volume quotidien pH programmée (mL)
-  String orpRegulationModeState;   // Mode de régulation ORP (automatic/scheduled/manual)
-  String orpDailyTargetMlState;    // Volume quotidien ORP programmée (mL)
-  String phRegulationModeCommand;  // feature-009 : commande mode régulation pH
-  String orpRegulationModeCommand; // feature-009 : commande mode régulation ORP
-  String alertsTopic;
-  String logsTopic;
-  String statusTopic;          // LWT et status
-  String diagnosticTopic;      // Diagnostic détaillé
-  String alertsCalibrationTopic;  // feature-021 : alerte calibration EZO requise (retain)
-  String alertsSensorStaleTopic;  // feature-021 : alerte capteur stale > kSensorStaleTimeoutMs
-  String alertsSensorFrozenTopic; // feature-022 : alerte capteur pH/ORP figé (variance nulle, retain)
-  String phSensorProblemState;    // feature-022 : problème capteur pH (stale OU figé, ON/OFF retain)
-  String orpSensorProblemState;   // feature-022 : problème capteur ORP (stale OU figé, ON/OFF retain)
-  String phCalPointsState;        // feature-021 : nb points calibration pH (Cal,?)
-  String orpCalPointsState;       // feature-021 : nb points calibration ORP (Cal,?)
-  String phSlopeAcidState;        // feature-024 : % pente acide pH (Slope,?)
-  String phSlopeBaseState;        // feature-024 : % pente base pH (Slope,?)
-  String phSlopeZeroState;        // feature-024 : décalage zéro pH (mV)
-  // feature-025 : chaîne de filtrage pH/ORP (médiane + EMA + rejet pics)
-  String phRawState;              // pH brut Atlas
-  String phMedianState;           // pH médian
-  String phFilteredState;         // pH filtré (valeur PID)
-  String phFilterReadyState;      // ON/OFF filtre pH prêt
-  String phFilterUnstableState;   // ON/OFF capteur pH instable
-  String phRejectedCountState;    // nb rejets pH
-  String orpRawState;
-  String orpMedianState;
-  String orpFilteredState;
-  String orpFilterReadyState;
-  String orpFilterUnstableState;
-  String orpRejectedCountState;
-  String phMixingDelayActiveState;  // ON/OFF pause mélange pH
-  String orpMixingDelayActiveState; // ON/OFF pause mélange ORP
-  // feature-050 : cumuls journaliers injectés + commandes volume quotidien + reboot
-  String phDailyMlState;            // Cumul pH injecté aujourd'hui (mL, retain)
-  String orpDailyMlState;           // Cumul ORP injecté aujourd'hui (mL, retain)
-  String phDailyTargetMlCommand;    // Commande volume quotidien pH (mode programmée)
-  String orpDailyTargetMlCommand;   // Commande volume quotidien ORP (mode programmée)
-  String rebootCommand;             // Commande redémarrage (bouton HA)
-  String boostState;                // feature-053 : état Mode Boost (ON/OFF, retain)
-  String boostCommand;              // feature-053 : .../boost/set (ON/OFF)
-  // feature-056 : mode d'installation + signal filtration externe
-  String installModeState;          // Mode d'installation publié (managed/powered/external, retain)
-  String installModeCommand;        // .../install_mode/set (managed/powered/external)
-  String filtrationExternalStateCommand;  // .../filtration_external_state/set (ON/OFF, NON-retain) → setExternalState (signal filtration externe)
-};
+#include "mqtt_topics.h"
+#include "mqtt_dedup.h"
+#include "mqtt_cadence.h"
+#include "mqtt_outbox.h"
+#include "mqtt_state_doc.h"
+#include "mqtt_discovery.h"
+#include "mqtt_slab.h"
+#include "mqtt_commands.h"
+#include "mqtt_pipeline.h"
+#include "mqtt_tls_client.h"
 
 // Architecture producer/consumer (cf. ADR-0011) :
 //
 //   loopTask (core 1)                         mqttTask (core 0, prio 2, stack 8 KB)
 //   ──────────────────                       ─────────────────────────────────────
-//   publishXxx()       → outQueue ─────────→ drainOutQueue() → mqtt.publish()
+//   publishXxx()       → _slab + outQueue ─────→ drainOutQueue() → _outbox (3 voies, spill flash)
+//                        (poignées 2 o)      flushOutbox()    → mqtt.publish() (tourniquet pondéré)
 //                                            mqtt.loop()      ← messageCallback()
 //   drainCommandQueue() ← inQueue  ←──────── enqueueIncoming(cmd, payload)
 //
@@ -110,10 +36,15 @@ struct MqttTopics {
 class MqttManager {
 private:
   WiFiClient wifiClient;
+  // Transport TLS (mqttCfg.tls) : session mémorisée entre reconnexions,
+  // épinglage du certificat broker. Choisi à chaque connectInTask().
+  MqttTlsClient tlsClient;
   PubSubClient mqtt;
 
-  MqttTopics topics;
-  bool discoveryPublished = false;
+  // Topics applicatifs "{base}/{suffixe}" dans une arène fixe (mqtt_topics.h).
+  // Reconstruite par refreshTopics() depuis mqttTask uniquement.
+  MqttTopicTable topics;
+  bool _topicBaseWarned = false;  // Warning "base trop longue" déjà émis pour cette config
 
   // Reconnect/backoff — accédés UNIQUEMENT depuis mqttTask
   bool reconnectRequested = false;
@@ -122,7 +53,7 @@ private:
 
   // Tâche dédiée MQTT
   TaskHandle_t taskHandle = nullptr;
-  QueueHandle_t outQueue = nullptr;       // publish sortants (loopTask → mqttTask)
+  QueueHandle_t outQueue = nullptr;       // poignées MqttSlabHandle (loopTask/mqttTask → mqttTask)
   QueueHandle_t inQueue = nullptr;        // commandes HA reçues (mqttTask → loopTask)
   std::atomic<bool> taskShouldStop{false};
   std::atomic<bool> connectedAtomic{false};
@@ -133,7 +64,12 @@ private:
   std::atomic<bool> publishStatesRequested{false};
   std::atomic<bool> publishDiagnosticRequested{false};
 
-  // Compteur de drops sur outQueue (logs WARN edge-triggered)
+  // Records sortants à longueur variable (mqtt_slab.h) : le producteur écrit le
+  // payload une fois dans un bloc, seule la poignée traverse outQueue ; mqttTask
+  // libère le bloc après l'avoir passé à l'outbox. Sans verrou (masques atomiques).
+  MqttSlabPool _slab;
+
+  // Compteur de drops sur outQueue / pool épuisé (logs WARN edge-triggered)
   uint32_t droppedSinceLastWarn = 0;
   unsigned long lastDropWarnMs = 0;
 
@@ -144,9 +80,35 @@ private:
   bool _rebootPending = false;
   unsigned long _rebootRequestedAtMs = 0;
 
-  void publishDiscovery();
+  // Lot de commandes HA drainées en une passe (mqtt_commands.h) : une entrée par
+  // type, dernière valide gagne. Membre (≈1,4 Ko) plutôt que pile de loopTask.
+  // Écrit uniquement depuis loopTask (drainCommandQueue).
+  MqttCommandBatch _cmdBatch;
+
   void refreshTopics();
 
+  // Auto-discovery HA incrémentale (mqtt_discovery.h) : hash du dernier payload
+  // publié par entité, persisté en NVS avec l'empreinte du broker (server:port).
+  // Une passe démarre à chaque connexion (et au birth HA) puis avance de quelques
+  // entités par itération de mqttTask ; les entités inchangées ne sont pas
+  // republiées. mqttTask uniquement (chargement dans begin(), avant la tâche).
+  HaDiscoveryCache _discoveryCache;
+  uint32_t _discoveryBroker = 0;     // Empreinte server:port du cache, 0 = aucune
+  bool _discoveryActive = false;
+  size_t _discoveryCursor = 0;       // Prochaine entrée de kHaEntities à évaluer
+  uint16_t _discoverySent = 0;       // Compteurs de la passe (log de synthèse)
+  uint16_t _discoverySkipped = 0;
+  uint16_t _discoveryFailed = 0;
+  unsigned long _connectedAtMs = 0;
+  char _discoveryTopic[kHaDiscoveryTopicMax];
+  char _discoveryPayload[kHaDiscoveryPayloadMax];
+  void loadDiscoveryCache();
+  void saveDiscoveryCache();
+  // (Re)démarre une passe ; invalide le cache si le broker a changé.
+  void startDiscovery();
+  // Évalue ≤ kHaDiscoveryEvalBurst entités, en publie ≤ kHaDiscoveryPublishBurst.
+  void publishDiscoveryStep();
+
   // feature-021 : caches pour publication edge-triggered de l'alerte calibration
   // et des états cal points. Lus/écrits uniquement depuis mqttTask.
   int  _lastPhCalPoints  = -2;  // -2 = jamais publié, -1..3 = valeurs réelles
@@ -160,26 +122,52 @@ private:
   int8_t _lastPhSensorProblem  = -1;
   int8_t _lastOrpSensorProblem = -1;
 
-  // feature-024 : caches pour publication edge-triggered des 3 topics pente.
-  // Sentinelle NaN = "jamais publié" — la 1ʳᵉ query Slope,? réussie déclenchera
-  // la publication initiale, puis chaque query réussie suivante (24h ou post-cal)
-  // republiera les 3 topics. Lus/écrits uniquement depuis mqttTask.
-  float _lastPhSlopeAcidPub = NAN;
-  float _lastPhSlopeBasePub = NAN;
-  float _lastPhSlopeZeroPub = NAN;
-
-  // feature-025 : caches anti-spam pour les topics filtre pH/ORP. On ne republie
-  // un topic retain que si la valeur (déjà arrondie) a changé. Lus/écrits uniquement
-  // depuis mqttTask. Sentinelle vide = "jamais publié".
-  // feature-050 : slots 14/15 réservés aux cumuls journaliers ph_daily_ml/orp_daily_ml.
-  static constexpr int kDedupCacheSlots = 16;
-  String _lastFilterPub[kDedupCacheSlots];
-  // Publie `payload` sur `topic` uniquement si différent du dernier publié (slot `cacheIdx`).
-  void safePublishDedup(int cacheIdx, const char* topic, const String& payload);
-  // Publie l'ensemble des topics de la chaîne de filtrage (edge-triggered).
+  // Dédup "sur changement" de tous les topics d'état, indexée par MqttTopicId
+  // (mqtt_dedup.h) : dernière valeur publiée en virgule fixe ou hash du payload,
+  // bandes mortes par métrique, rafraîchissement forcé. Remise à zéro à chaque
+  // connexion. Lue/écrite uniquement depuis mqttTask.
+  MqttDedup _dedup;
+  // Cadence par métrique selon la phase de process (mqtt_cadence.h), attachée à
+  // _dedup. Phase posée à chaque cycle d'états. mqttTask uniquement.
+  MqttCadence _cadence;
+  // Génération de config (config.h) dont les topics retain de config ont été
+  // publiés pendant la session courante. 0 = à republier. mqttTask uniquement.
+  uint32_t _publishedConfigGen = 0;
+  // Publie un état retain si MqttDedup le juge dû ; true si publié.
+  bool publishStateText(MqttTopicId id, const char* payload);
+  // Idem pour une valeur numérique (NaN / infini ignorés), formatée avec `decimals`
+  // (0..3) et dédupliquée sur sa virgule fixe value×10^decimals (fixed_format.h).
+  bool publishStateValue(MqttTopicId id, float value, uint8_t decimals);
+  // Boîte d'envoi store-and-forward (mqtt_outbox.h) : tout message non
+  // périodique (outQueue, alertes edge-triggered, échantillons hors-ligne) y
+  // transite. Alertes et échantillons survivent aux coupures (spill LittleFS
+  // /mqtt_outbox.bin) et sont rejoués dans l'ordre, à débit borné, à la
+  // reconnexion. mqttTask uniquement.
+  MqttOutbox _outbox;
+  // Plomberie files ↔ _slab ↔ _dedup ↔ _outbox ↔ mqtt (mqtt_pipeline.h, pure,
+  // partagée avec le banc natif). Files et client branchés dans begin().
+  MqttPipeline _pipeline{topics, _slab, _dedup, _outbox};
+  unsigned long _lastOfflineSampleMs = 0;
+  bool _offlineSampleTaken = false;
+  // Range un message dans _outbox (classe déduite du topic, état courant du lien).
+  void queueOutbox(MqttTopicId id, const char* payload, bool retain);
+  // Publie depuis _outbox dans la limite de flushBudget() (dédup des états incluse).
+  void flushOutbox();
+  // Mode document d'état (mqttCfg.stateJson, mqtt_state_doc.h) : tampon de
+  // sérialisation réutilisé à chaque cycle, et drapeau posé par drainOutQueue()
+  // quand loopTask signale un changement d'état (publishFiltrationState…) —
+  // le document est alors reconstruit dans l'itération. mqttTask uniquement.
+  char _stateDoc[kMqttStateDocMax];
+  bool _stateDocDirty = false;
+  // Sérialise tous les états dans {base}/state si au moins un champ est dû.
+  void publishStateDocumentInternal();
+  // Hors-ligne : alertes edge-triggered + échantillon capteurs vers {base}/history.
+  void captureOfflineInternal();
+  // Publie l'ensemble des topics de la chaîne de filtrage (dédupliqués).
   void publishFilterStatesInternal();
   // Vérifie l'état de calibration et stale, publie/clear les alertes au besoin.
-  // Appelé depuis mqttTask (publishAllStatesInternal + connectInTask).
+  // Appelé depuis mqttTask (publishAllStatesInternal + connectInTask, et
+  // captureOfflineInternal hors-ligne : les alertes passent par _outbox).
   void publishCalibrationStatusInternal();
 
   // Internes — exécutées UNIQUEMENT depuis mqttTask
@@ -187,14 +175,21 @@ private:
   void taskLoop();
   void drainOutQueue();
   void connectInTask();
+  void logTlsHandshake();
   void publishAllStatesInternal();
   void publishDiagnosticInternal();
+  void publishSensorHealthInternal();
 
   // Wrapper unique pour tout mqtt.publish() depuis mqttTask. Voir feature-014 IT4 / ADR-0011.
   bool safePublish(const char* topic, const char* payload, bool retain);
 
   // Helpers de mise en file (depuis loopTask) — non-bloquants
-  void enqueueOutbound(const String& topic, const String& payload, bool retain);
+  void enqueueOutbound(MqttTopicId topic, const String& payload, bool retain);
+  void enqueueOutbound(MqttTopicId topic, const char* payload, bool retain);
+  // Enfile la poignée d'un record déjà rempli dans _slab (prise de possession).
+  void postOutbound(MqttSlabHandle h);
+  // Drops → WARN edge-triggered ; record posté → réveil de mqttTask.
+  void notePosted(const MqttPostResult& res);
   void noteDropEdgeTriggered();
 
 public:
@@ -207,8 +202,8 @@ public:
   void messageCallback(char* topic, byte* payload, unsigned int length);
 
   // Drainage des commandes HA reçues — à appeler depuis loopTask à chaque tour de loop().
-  // Les commandes (filtration/set, lighting/set, ph_target/set, orp_target/set) sont
-  // appliquées sous configMutex. Aucun appel MQTT n'est effectué ici.
+  // inQueue est vidée en un lot coalescé par type : une prise de configMutex, une
+  // écriture NVS et un broadcast WS par lot. Aucun appel MQTT n'est effectué ici.
   void drainCommandQueue();
 
   // Arrêt propre avant ESP.restart() — publie status=offline synchronement avec timeout
@@ -221,7 +216,7 @@ public:
   // Publication — API publique inchangée. Toutes ces méthodes sont des PRODUCTEURS
   // non-bloquants : elles enfilent un snapshot dans outQueue et retournent en < 1 ms.
   // Appelables depuis loopTask sans risque de blocage réseau.
-  void publishSensorState(const String& topic, const String& payload, bool retain = true);
+  void publishSensorState(MqttTopicId topic, const String& payload, bool retain = true);
   void publishAllStates();
   void publishFiltrationState();
   void publishLightingState();
@@ -235,7 +230,7 @@ public:
   void publishDiagnostic();
 
   // Getters
-  const MqttTopics& getTopics() const { return topics; }
+  const MqttTopicTable& getTopics() const { return topics; }
 };
 
 extern MqttManager mqttManager;
@@ -244,45 +239,16 @@ extern MqttManager mqttManager;
 // utilitaires (debug, tests) d'inspecter la profondeur de file si besoin.
 namespace mqtt_internal {
 
-// Topics MQTT applicatifs : ~50c max ("pool/sensors/orp_regulation_mode" = 33c).
-// Les topics discovery HA (~80c) ne passent JAMAIS par outQueue : ils sont publiés
-// directement depuis mqttTask dans publishDiscovery().
-constexpr size_t kMaxTopicLen   = 64;
-// Payloads en queue sont courts : "ON"/"OFF", floats stringifiés (≤8c), JSON alerts (~80c).
-// Le JSON diagnostic (~400c) ne passe PAS par outQueue : flag atomique → publish direct.
-constexpr size_t kMaxPayloadLen = 128;
-
-struct OutboundMsg {
-  char topic[kMaxTopicLen];
-  char payload[kMaxPayloadLen];
-  bool retain;
-};
-
-enum class InboundCmdType : uint8_t {
-  FiltrationMode,    // payload = "auto"|"manual"|"force"|"off"
-  FiltrationOnOff,   // payload = "ON"|"OFF"
-  Lighting,          // payload = "ON"|"OFF"
-  PhTarget,          // payload = "7.2"
-  OrpTarget,         // payload = "650"
-  PhRegulationMode,  // payload = "automatic"|"scheduled"|"manual" (feature-009)
-  OrpRegulationMode, // payload = "automatic"|"scheduled"|"manual" (feature-009)
-  PhDailyTarget,     // payload = "150" (mL, entier — feature-050)
-  OrpDailyTarget,    // payload = "500" (mL, entier — feature-050)
-  Reboot,            // payload = "PRESS" (tout payload accepté — feature-050)
-  FiltrationStart,   // payload = "08:00" (HH:MM — feature-051)
-  FiltrationEnd,     // payload = "20:00" (HH:MM — feature-051)
-  LightingSchedule,  // payload = "ON"|"OFF" (feature-052)
-  LightingStart,     // payload = "20:00" (HH:MM — feature-052)
-  LightingEnd,       // payload = "23:00" (HH:MM — feature-052)
-  Boost,             // payload = "ON"|"OFF" (feature-053 : Mode Boost)
-  FiltrationExternalState,  // payload = "ON"|"OFF" (feature-056 : signal filtration externe)
-  InstallMode,       // payload = "managed"|"powered"|"external" (feature-056)
-};
+// Les records sortants vivent dans MqttManager::_slab (mqtt_slab.h) : outQueue
+// ne transporte que des MqttSlabHandle. Le topic voyage par id (résolu par
+// mqttTask dans MqttTopicTable au drain). Les topics discovery HA ne passent
+// JAMAIS par outQueue : ils sont publiés directement depuis mqttTask dans
+// publishDiscoveryStep().
 
-struct InboundCmd {
-  InboundCmdType type;
-  char payload[64];
-};
+// Commandes HA : énumération et décodage dans mqtt_commands.h (pur), record
+// de file entrante dans mqtt_pipeline.h.
+using InboundCmdType = MqttCommand;
+using InboundCmd = MqttInboundCmd;
 
 }  // namespace mqtt_internal
 
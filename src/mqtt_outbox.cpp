@@ -0,0 +1,242 @@
+#include "mqtt_outbox.h"
+
+#include <string.h>
+
+// =============================================================================
+// mqtt_outbox — implémentation PURE
+// =============================================================================
+
+MqttMsgClass mqttMsgClassFor(MqttTopicId id) {
+  switch (id) {
+    case MqttTopicId::Alerts:
+    case MqttTopicId::AlertsCalibration:
+    case MqttTopicId::AlertsSensorStale:
+    case MqttTopicId::AlertsSensorFrozen:
+      return MqttMsgClass::Alert;
+    case MqttTopicId::Logs:
+      return MqttMsgClass::Event;
+    case MqttTopicId::History:
+      return MqttMsgClass::Sample;
+    default:
+      // États, status et diagnostic : seule la dernière valeur compte.
+      return MqttMsgClass::State;
+  }
+}
+
+MqttLane mqttLaneFor(MqttTopicId id) {
+  switch (id) {
+    case MqttTopicId::Alerts:
+    case MqttTopicId::AlertsCalibration:
+    case MqttTopicId::AlertsSensorStale:
+    case MqttTopicId::AlertsSensorFrozen:
+      return MqttLane::Alert;
+    // Disponibilité + états des entités pilotables : HA attend ce retour après
+    // une commande (switch, select, number, text).
+    case MqttTopicId::Status:
+    case MqttTopicId::FiltrationState:
+    case MqttTopicId::FiltrationModeState:
+    case MqttTopicId::FiltrationStartState:
+    case MqttTopicId::FiltrationEndState:
+    case MqttTopicId::LightingState:
+    case MqttTopicId::LightingScheduleState:
+    case MqttTopicId::LightingStartState:
+    case MqttTopicId::LightingEndState:
+    case MqttTopicId::PhTargetState:
+    case MqttTopicId::OrpTargetState:
+    case MqttTopicId::PhRegulationModeState:
+    case MqttTopicId::OrpRegulationModeState:
+    case MqttTopicId::PhDailyTargetMlState:
+    case MqttTopicId::OrpDailyTargetMlState:
+    case MqttTopicId::BoostState:
+    case MqttTopicId::InstallModeState:
+      return MqttLane::Control;
+    default:
+      return MqttLane::Telemetry;
+  }
+}
+
+void MqttOutboxRecord::set(MqttTopicId id, MqttMsgClass c, bool ret, const char* text,
+                           uint32_t epochNow) {
+  topic = id;
+  cls = c;
+  retain = ret;
+  epoch = epochNow;
+  const char* p = text ? text : "";
+  size_t n = strlen(p);
+  if (n > kMqttOutboxPayloadMax - 1) n = kMqttOutboxPayloadMax - 1;
+  memcpy(payload, p, n);
+  payload[n] = '\0';
+  len = static_cast<uint16_t>(n);
+}
+
+size_t MqttOutboxRecord::storedSize() const {
+  return kMqttOutboxRecordHeaderBytes + len;
+}
+
+MqttOutbox::MqttOutbox(MqttSpillStore* spill) : _spill(nullptr) {
+  size_t base = 0;
+  for (size_t i = 0; i < kMqttLaneCount; ++i) {
+    _lanes[i].base = base;
+    _lanes[i].cap = kMqttLaneSlots[i];
+    base += kMqttLaneSlots[i];
+    _credits[i] = kMqttLaneWeight[i];
+  }
+  attachSpill(spill);
+}
+
+void MqttOutbox::attachSpill(MqttSpillStore* spill) {
+  _spill = spill;
+  if (_spill != nullptr && _spill->lastSeq() >= _nextSeq) {
+    _nextSeq = _spill->lastSeq() + 1;
+  }
+}
+
+bool MqttOutbox::empty() const {
+  return _count == 0 && spillEmpty();
+}
+
+bool MqttOutbox::_spillAccepts(const MqttOutboxRecord& rec) const {
+  if (_spill == nullptr) return false;
+  const size_t limit = rec.cls == MqttMsgClass::Sample ? kMqttSpillSampleMaxBytes
+                                                       : kMqttSpillMaxBytes;
+  return _spill->usedBytes() + rec.storedSize() <= limit;
+}
+
+bool MqttOutbox::_trySpill(const MqttOutboxRecord& rec) {
+  if (!_spillAccepts(rec) || !_spill->append(rec)) return false;
+  _spilled++;
+  return true;
+}
+
+void MqttOutbox::_drop(Lane& lane) {
+  _dropped++;
+  lane.dropped++;
+}
+
+void MqttOutbox::_popRam(Lane& lane) {
+  lane.head = (lane.head + 1) % lane.cap;
+  lane.count--;
+  _count--;
+}
+
+void MqttOutbox::_evictHead(Lane& lane) {
+  // La tête est le plus ancien record de la voie : la déverser garde l'ordre du spill.
+  const MqttOutboxRecord& old = _headOf(lane);
+  if (!(mqttMsgIsPersistent(old.cls) && _trySpill(old))) {
+    _drop(lane);
+  }
+  _popRam(lane);
+}
+
+bool MqttOutbox::_coalesce(Lane& lane, const MqttOutboxRecord& rec) {
+  for (size_t i = 0; i < lane.count; ++i) {
+    MqttOutboxRecord& r = _ring[lane.base + (lane.head + i) % lane.cap];
+    if (r.cls != MqttMsgClass::State || r.topic != rec.topic) continue;
+    // Place et séquence conservées : seule la valeur publiée change.
+    const uint32_t seq = r.seq;
+    r = rec;
+    r.seq = seq;
+    _coalesced++;
+    return true;
+  }
+  return false;
+}
+
+MqttOutboxPush MqttOutbox::push(const MqttOutboxRecord& rec, bool connected) {
+  Lane& lane = _lanes[static_cast<size_t>(mqttLaneFor(rec.topic))];
+  if (!connected && rec.cls == MqttMsgClass::State) {
+    // Republié par publishAllStatesInternal() à la reconnexion (dédup remise à zéro).
+    _drop(lane);
+    return MqttOutboxPush::Dropped;
+  }
+  if (rec.cls == MqttMsgClass::State && _coalesce(lane, rec)) {
+    return MqttOutboxPush::Queued;
+  }
+
+  MqttOutboxRecord stamped = rec;
+  stamped.seq = _nextSeq++;
+
+  if (!connected && mqttMsgIsPersistent(stamped.cls) && _trySpill(stamped)) {
+    return MqttOutboxPush::Spilled;
+  }
+  if (stamped.cls == MqttMsgClass::Sample && !connected && _spill != nullptr) {
+    // Budget échantillons épuisé : on garde la place RAM pour les alertes.
+    _drop(lane);
+    return MqttOutboxPush::Dropped;
+  }
+
+  if (lane.count == lane.cap) {
+    _evictHead(lane);
+  }
+  _ring[lane.base + (lane.head + lane.count) % lane.cap] = stamped;
+  lane.count++;
+  _count++;
+  return MqttOutboxPush::Queued;
+}
+
+bool MqttOutbox::_laneFront(size_t lane, MqttOutboxRecord& out) {
+  Lane& l = _lanes[lane];
+  if (!spillEmpty() && _spill->peek(out) &&
+      static_cast<size_t>(mqttLaneFor(out.topic)) == lane) {
+    if (l.count == 0 || out.seq < _headOf(l).seq) {
+      _frontFromSpill = true;
+      return true;
+    }
+  }
+  if (l.count == 0) return false;
+  out = _headOf(l);
+  _frontFromSpill = false;
+  return true;
+}
+
+bool MqttOutbox::front(MqttOutboxRecord& out) {
+  // Tourniquet pondéré : dans un tour, chaque voie sert au plus kMqttLaneWeight
+  // records, par ordre de priorité. Aucune voie créditée n'a de travail → tour
+  // suivant (crédits rechargés) : le débit inutilisé profite aux autres voies.
+  for (int round = 0; round < 2; ++round) {
+    for (size_t lane = 0; lane < kMqttLaneCount; ++lane) {
+      if (_credits[lane] == 0 || !_laneFront(lane, out)) continue;
+      _frontLane = lane;
+      return true;
+    }
+    if (empty()) return false;
+    for (size_t lane = 0; lane < kMqttLaneCount; ++lane) _credits[lane] = kMqttLaneWeight[lane];
+  }
+  return false;
+}
+
+bool MqttOutbox::complete(bool published) {
+  if (_replayLeft > 0) _replayLeft--;
+  if (_credits[_frontLane] > 0) _credits[_frontLane]--;
+  Lane& lane = _lanes[_frontLane];
+  if (!published) {
+    const bool persistent =
+        _frontFromSpill || (lane.count > 0 && mqttMsgIsPersistent(_headOf(lane).cls));
+    if (persistent) return false;  // Retenté à la prochaine itération, ordre conservé
+    _drop(lane);
+  } else {
+    _sent++;
+  }
+  if (_frontFromSpill) {
+    _spill->pop();
+    _frontFromSpill = false;
+  } else if (lane.count > 0) {
+    _popRam(lane);
+  }
+  return true;
+}
+
+size_t MqttOutbox::flushBudget(uint32_t nowMs) {
+  if (spillEmpty() && _count <= kMqttOutboxLiveBurst) {
+    // Régime nominal : tout le backlog part dans l'itération.
+    _replayWindowOpen = false;
+    _replayLeft = 0;
+    return kMqttOutboxLiveBurst;
+  }
+  if (!_replayWindowOpen || nowMs - _replayWindowMs >= kMqttReplayIntervalMs) {
+    _replayWindowOpen = true;
+    _replayWindowMs = nowMs;
+    _replayLeft = kMqttReplayBurst;
+  }
+  return _replayLeft;
+}
@@ -0,0 +1,208 @@
+#ifndef MQTT_OUTBOX_H
+#define MQTT_OUTBOX_H
+
+// =============================================================================
+// mqtt_outbox — Boîte d'envoi MQTT « store-and-forward », PURE
+// =============================================================================
+// Tampon entre les producteurs (outQueue, diagnostic, alertes edge-triggered, échantillons
+// hors-ligne) et mqtt.publish(). Survit aux coupures Wi-Fi/broker :
+//
+//   Classe   | Connecté       | Déconnecté                       | Stockage
+//   ---------|----------------|----------------------------------|-----------
+//   State    | RAM → publish  | abandonné (republié à la reconnexion)
+//   Event    | RAM → publish  | RAM, le plus ancien évincé       | RAM
+//   Alert    | RAM → publish  | spill flash (RAM si spill plein) | flash
+//   Sample   | —              | spill flash (budget réduit)      | flash
+//
+// L'anneau RAM est découpé en trois voies (MqttLane), chacune avec sa
+// profondeur et sa politique de débordement :
+//
+//   Voie      | Topics                              | Places | Pleine
+//   ----------|-------------------------------------|--------|----------------------
+//   Control   | status, états pilotables par HA     | 6      | tête abandonnée
+//   Alert     | alerts, alerts/*                    | 8      | tête déversée en flash
+//   Telemetry | mesures, autres états, logs, history| 12     | tête abandonnée/déversée
+//
+// Un état (classe State) déjà en attente dans sa voie est remplacé sur place
+// par la nouvelle valeur (seule la dernière compte) : une rafale de télémétrie
+// ne consomme pas de places. front() sert les voies par tourniquet pondéré
+// (kMqttLaneWeight, un tour = kMqttOutboxLiveBurst publish) : sous charge
+// télémétrie, les alertes et les acquittements de commande gardent leur part
+// de chaque itération. Au sein d'une voie, l'ordre de production est conservé
+// (numéro de séquence) ; le spill, FIFO commun aux alertes et échantillons, est
+// fusionné avec la voie de son record de tête. Entre voies, la priorité prime.
+// Voie pleine : la tête est évincée — abandonnée si éphémère (State/Event),
+// déversée dans le spill si persistante (Alert/Sample).
+//
+// Le rejeu est cadencé par flushBudget() : débit normal tant que le backlog
+// tient dans une itération, sinon kMqttReplayBurst messages toutes les
+// kMqttReplayIntervalMs pour ne pas affamer mqtt.loop() (keepalive, commandes).
+//
+// Le stockage flash est abstrait (MqttSpillStore) : LittleFS dans la coquille
+// mqtt_manager.cpp, mémoire dans les tests. mqttTask uniquement, pas de verrou.
+//
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mqtt_topics.h"
+
+// Payload max d'un record, NUL compris (plus long : publié sans passer par l'outbox).
+constexpr size_t kMqttOutboxPayloadMax = 128;
+// En-tête d'un record sérialisé : seq(4) epoch(4) topic(1) flags(1) len(2).
+constexpr size_t kMqttOutboxRecordHeaderBytes = 12;
+// Publications par itération de mqttTask en régime nominal (ancien drainOutQueue).
+constexpr size_t kMqttOutboxLiveBurst = 8;
+// Rejeu d'un backlog : kMqttReplayBurst publish toutes les kMqttReplayIntervalMs.
+constexpr size_t kMqttReplayBurst = 4;
+constexpr uint32_t kMqttReplayIntervalMs = 250;
+// Spill flash : plafond total, et part maximale occupée par les échantillons
+// (le reste est réservé aux alertes).
+constexpr size_t kMqttSpillMaxBytes = 32768;
+constexpr size_t kMqttSpillSampleMaxBytes = 24576;
+// Cadence des échantillons capteurs pendant une coupure.
+constexpr uint32_t kMqttOfflineSampleIntervalMs = 300000;  // 5 min
+
+enum class MqttMsgClass : uint8_t {
+  State,   // État retain courant — republié de toute façon à la reconnexion
+  Event,   // Log / événement : best-effort, RAM uniquement
+  Alert,   // Alerte : persistante, rejouée dans l'ordre
+  Sample,  // Échantillon horodaté pris hors-ligne : persistant
+};
+
+inline bool mqttMsgIsPersistent(MqttMsgClass c) {
+  return c == MqttMsgClass::Alert || c == MqttMsgClass::Sample;
+}
+
+// Classe par défaut d'un message issu des files sortantes.
+MqttMsgClass mqttMsgClassFor(MqttTopicId id);
+
+// Voies de priorité de l'anneau RAM (ordre = priorité au sein d'un tour).
+enum class MqttLane : uint8_t {
+  Control,    // status + états des entités pilotables (acquittement des commandes HA)
+  Alert,      // alertes
+  Telemetry,  // mesures, autres états, logs, échantillons
+  Count
+};
+constexpr size_t kMqttLaneCount = static_cast<size_t>(MqttLane::Count);
+
+// Voie d'un topic.
+MqttLane mqttLaneFor(MqttTopicId id);
+
+// Places RAM par voie et poids du tourniquet (publish par tour), indexés par MqttLane.
+constexpr size_t kMqttLaneSlots[kMqttLaneCount] = {6, 8, 12};
+constexpr uint8_t kMqttLaneWeight[kMqttLaneCount] = {3, 3, 2};
+// Anneau RAM complet (~3,8 Ko).
+constexpr size_t kMqttOutboxRamSlots = kMqttLaneSlots[0] + kMqttLaneSlots[1] + kMqttLaneSlots[2];
+static_assert(kMqttLaneWeight[0] + kMqttLaneWeight[1] + kMqttLaneWeight[2] == kMqttOutboxLiveBurst,
+              "un tour du tourniquet = une itération nominale");
+
+struct MqttOutboxRecord {
+  uint32_t seq = 0;        // Ordre de production (attribué par MqttOutbox::push)
+  uint32_t epoch = 0;      // Heure de production (0 = horloge non synchronisée)
+  MqttTopicId topic = MqttTopicId::Count;
+  MqttMsgClass cls = MqttMsgClass::State;
+  bool retain = false;
+  uint16_t len = 0;        // Longueur du payload, NUL exclu
+  char payload[kMqttOutboxPayloadMax] = {};
+
+  // Renseigne topic/classe/retain/payload (tronqué, len recalculée).
+  void set(MqttTopicId id, MqttMsgClass c, bool ret, const char* text, uint32_t epochNow);
+  // Octets occupés une fois sérialisé en flash (en-tête + payload).
+  size_t storedSize() const;
+};
+
+// Stockage persistant FIFO des records déversés. append() refuse au-delà de la
+// capacité propre du store ; peek()/pop() consomment dans l'ordre d'écriture.
+class MqttSpillStore {
+public:
+  virtual ~MqttSpillStore() = default;
+  virtual bool append(const MqttOutboxRecord& rec) = 0;
+  virtual bool peek(MqttOutboxRecord& out) = 0;
+  virtual void pop() = 0;
+  virtual bool empty() const = 0;
+  virtual size_t usedBytes() const = 0;
+  // Plus grand seq présent (records d'un boot précédent), 0 si vide.
+  virtual uint32_t lastSeq() const = 0;
+};
+
+enum class MqttOutboxPush : uint8_t {
+  Queued,    // En RAM
+  Spilled,   // Écrit dans le spill
+  Dropped,   // Abandonné (State hors-ligne, spill plein…)
+};
+
+class MqttOutbox {
+public:
+  explicit MqttOutbox(MqttSpillStore* spill = nullptr);
+
+  // Branche le spill (peut être nullptr) et reprend la séquence après ses records.
+  void attachSpill(MqttSpillStore* spill);
+
+  // Range un record selon sa classe et l'état du lien (voir tableau ci-dessus).
+  MqttOutboxPush push(const MqttOutboxRecord& rec, bool connected);
+
+  // Prochain record à publier : voie élue par le tourniquet pondéré, puis plus
+  // ancien record de cette voie (spill ou RAM). false si rien en attente.
+  bool front(MqttOutboxRecord& out);
+  // Issue de la publication du record renvoyé par front(). Succès : retiré.
+  // Échec : un persistant reste en tête (retourne false → arrêter le flush de
+  // l'itération) ; un éphémère est abandonné (retourne true → continuer).
+  bool complete(bool published);
+
+  // Nombre de publish autorisés à cette itération (0 = attendre).
+  size_t flushBudget(uint32_t nowMs);
+
+  size_t ramCount() const { return _count; }
+  size_t laneCount(MqttLane lane) const { return _lanes[static_cast<size_t>(lane)].count; }
+  bool empty() const;
+  bool spillEmpty() const { return _spill == nullptr || _spill->empty(); }
+  size_t spillBytes() const { return _spill ? _spill->usedBytes() : 0; }
+
+  // Compteurs depuis le boot (diagnostic).
+  uint32_t sentCount() const { return _sent; }
+  uint32_t spilledCount() const { return _spilled; }
+  uint32_t droppedCount() const { return _dropped; }
+  uint32_t laneDroppedCount(MqttLane lane) const { return _lanes[static_cast<size_t>(lane)].dropped; }
+  // États remplacés sur place par une valeur plus récente (non comptés en drop).
+  uint32_t coalescedCount() const { return _coalesced; }
+
+private:
+  // Anneau d'une voie : tranche [base, base + cap) de _ring.
+  struct Lane {
+    size_t base = 0;
+    size_t cap = 0;
+    size_t head = 0;
+    size_t count = 0;
+    uint32_t dropped = 0;
+  };
+
+  MqttSpillStore* _spill;
+  MqttOutboxRecord _ring[kMqttOutboxRamSlots];
+  Lane _lanes[kMqttLaneCount];
+  uint8_t _credits[kMqttLaneCount];
+  size_t _count = 0;
+  uint32_t _nextSeq = 1;
+  size_t _frontLane = 0;
+  bool _frontFromSpill = false;
+  uint32_t _replayWindowMs = 0;
+  size_t _replayLeft = 0;
+  bool _replayWindowOpen = false;
+
+  uint32_t _sent = 0;
+  uint32_t _spilled = 0;
+  uint32_t _dropped = 0;
+  uint32_t _coalesced = 0;
+
+  MqttOutboxRecord& _headOf(Lane& lane) { return _ring[lane.base + lane.head]; }
+  bool _spillAccepts(const MqttOutboxRecord& rec) const;
+  bool _trySpill(const MqttOutboxRecord& rec);
+  bool _coalesce(Lane& lane, const MqttOutboxRecord& rec);
+  bool _laneFront(size_t lane, MqttOutboxRecord& out);
+  void _drop(Lane& lane);
+  void _evictHead(Lane& lane);
+  void _popRam(Lane& lane);
+};
+
+#endif // MQTT_OUTBOX_H
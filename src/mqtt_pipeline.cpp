@@ -0,0 +1,154 @@
+#include "mqtt_pipeline.h"
+
+#include <string.h>
+#include "mqtt_state_doc.h"
+
+// =============================================================================
+// mqtt_pipeline — implémentation PURE
+// =============================================================================
+
+MqttPipeline::MqttPipeline(const MqttTopicTable& topics, MqttSlabPool& slab, MqttDedup& dedup,
+                           MqttOutbox& outbox)
+    : _topics(topics), _slab(slab), _dedup(dedup), _outbox(outbox) {}
+
+void MqttPipeline::attach(MqttQueue<MqttSlabHandle>* outQueue, MqttQueue<MqttInboundCmd>* inQueue,
+                          MqttPublisher* publisher) {
+  _outQueue = outQueue;
+  _inQueue = inQueue;
+  _publisher = publisher;
+}
+
+// ----------------------------------------------------------------------------
+// Producteurs
+// ----------------------------------------------------------------------------
+
+MqttPostResult MqttPipeline::enqueue(MqttTopicId topic, const char* payload, bool retain) {
+  MqttPostResult res;
+  if (_outQueue == nullptr || topic >= MqttTopicId::Count) return res;
+  const size_t len = payload ? strlen(payload) : 0;
+  // Le topic voyage sous forme d'id : résolu dans l'arène par mqttTask au drain,
+  // ce qui évite toute lecture de l'arène depuis loopTask pendant une reconstruction.
+  MqttSlabHandle h = _slab.store(topic, retain, payload, len);
+  if (h == kMqttSlabNone) {
+    // Pool épuisé : drop du plus ancien (best-effort) et nouvel essai.
+    MqttSlabHandle oldest;
+    if (_outQueue->receive(oldest)) {
+      _slab.release(oldest);
+      res.dropped++;
+      h = _slab.store(topic, retain, payload, len);
+    }
+    if (h == kMqttSlabNone) {
+      res.dropped++;  // toujours rien : on perd ce message
+      return res;
+    }
+  }
+  const MqttPostResult posted = post(h);
+  res.posted = posted.posted;
+  res.dropped += posted.dropped;
+  return res;
+}
+
+MqttPostResult MqttPipeline::post(MqttSlabHandle h) {
+  // La file sortante a au moins autant d'entrées que le pool a de blocs :
+  // l'envoi ne peut échouer que si elle n'existe pas.
+  MqttPostResult res;
+  if (_outQueue == nullptr || !_outQueue->send(h)) {
+    _slab.release(h);
+    res.dropped = 1;
+    return res;
+  }
+  res.posted = true;
+  return res;
+}
+
+// ----------------------------------------------------------------------------
+// mqttTask
+// ----------------------------------------------------------------------------
+
+bool MqttPipeline::drainOutQueue(uint32_t nowMs, uint32_t epoch, bool enabled, bool stateDoc) {
+  // La file n'est qu'un canal inter-tâches : chaque record est lu en place dans
+  // le pool, transféré dans l'outbox, qui classe (voie, état / log / alerte),
+  // stocke hors-ligne et cadence le rejeu, puis le bloc est libéré.
+  if (_outQueue == nullptr || _publisher == nullptr) return false;
+
+  const bool connected = _publisher->connected();
+  bool docDirty = false;
+  MqttSlabHandle h;
+  while (_outQueue->receive(h)) {
+    const MqttSlabHeader& rec = _slab.header(h);
+    const char* payload = _slab.payload(h);
+    if (!enabled) {
+      // MQTT désactivé : rien à conserver
+    } else if (rec.len >= kMqttOutboxPayloadMax) {
+      // Trop long pour un record d'outbox (diagnostic JSON en pratique) : publié
+      // tel quel depuis le bloc. Un état n'a rien à conserver hors-ligne.
+      if (connected) _publisher->publish(_topics.get(rec.topic), payload, rec.retain);
+    } else if (stateDoc && MqttStateDoc::isDocumentField(rec.topic)) {
+      // Mode document d'état : les états postés par loopTask ne sont pas publiés
+      // topic par topic, ils déclenchent la reconstruction du document.
+      if (connected) docDirty = true;
+    } else if (connected && !_dedup.textDue(rec.topic, payload, nowMs)) {
+      // Même dédup que les publications périodiques : un état inchangé posté par
+      // loopTask n'est pas republié. Pass-through pour alerts/logs/status.
+      // Hors-ligne, l'outbox abandonne les états de toute façon.
+      _dedup.noteSuppressed();
+    } else {
+      queueOutbox(rec.topic, payload, rec.retain, epoch);
+    }
+    _slab.release(h);
+  }
+  return docDirty;
+}
+
+void MqttPipeline::queueOutbox(MqttTopicId id, const char* payload, bool retain, uint32_t epoch) {
+  MqttOutboxRecord rec;
+  rec.set(id, mqttMsgClassFor(id), retain, payload, epoch);
+  _outbox.push(rec, _publisher != nullptr && _publisher->connected());
+}
+
+void MqttPipeline::flushOutbox(uint32_t nowMs) {
+  if (_publisher == nullptr || !_publisher->connected()) return;
+
+  // Budget borné par itération : après une coupure, le backlog (spill compris)
+  // repart par rafales de kMqttReplayBurst pour laisser mqtt.loop() servir le
+  // keepalive et les commandes HA entre deux rafales.
+  size_t budget = _outbox.flushBudget(nowMs);
+  MqttOutboxRecord rec;
+  while (budget > 0 && _outbox.front(rec)) {
+    budget--;
+    const bool ok = _publisher->publish(_topics.get(rec.topic), rec.payload, rec.retain);
+    if (ok) _dedup.markText(rec.topic, rec.payload, nowMs);
+    // Alerte/échantillon non publié : reste en tête, retenté à l'itération suivante.
+    if (!_outbox.complete(ok)) break;
+  }
+}
+
+// ----------------------------------------------------------------------------
+// Commandes entrantes
+// ----------------------------------------------------------------------------
+
+MqttInboundResult MqttPipeline::onMessage(const char* topic, const uint8_t* payload, size_t length) {
+  // Dispatch O(1) sans allocation : hash du suffixe → MqttTopicId (mqtt_topics.h),
+  // puis commande associée (mqtt_commands.h).
+  MqttInboundCmd cmd;
+  if (!mqttCommandFor(_topics.matchCommand(topic), cmd.type)) return MqttInboundResult::Ignored;
+
+  const size_t copyLen = (length < sizeof(cmd.payload) - 1) ? length : sizeof(cmd.payload) - 1;
+  if (copyLen > 0) memcpy(cmd.payload, payload, copyLen);
+  cmd.payload[copyLen] = '\0';
+
+  if (_inQueue == nullptr || !_inQueue->send(cmd)) return MqttInboundResult::Dropped;
+  return MqttInboundResult::Queued;
+}
+
+void MqttPipeline::collectCommands(MqttCommandBatch& batch, bool& writesConfig) {
+  // Borné à la profondeur de la file : un producteur rapide ne retient pas loopTask.
+  batch.clear();
+  writesConfig = false;
+  if (_inQueue == nullptr) return;
+  MqttInboundCmd in;
+  for (uint32_t i = 0; i < kMqttInQueueLength && _inQueue->receive(in); ++i) {
+    batch.add(in.type, in.payload);
+    writesConfig = writesConfig || mqttCommandWritesConfig(in.type);
+  }
+}
@@ -0,0 +1,122 @@
+#ifndef MQTT_PIPELINE_H
+#define MQTT_PIPELINE_H
+
+// =============================================================================
+// mqtt_pipeline — Chaînage files ↔ pool ↔ dédup ↔ outbox ↔ client MQTT, PURE
+// =============================================================================
+// La plomberie entre loopTask et mqttTask (ADR-0011), sans FreeRTOS ni
+// PubSubClient : les files et le client sont des interfaces, branchées sur
+// xQueue / mqtt.publish() par mqtt_manager.cpp et sur des FIFO / un broker
+// simulé par le banc natif (test/test_native_mqtt_pipeline/).
+//
+//   producteur ── enqueue() ──→ _slab + file sortante (poignées)
+//   mqttTask   ── drainOutQueue() ──→ dédup → _outbox   (ou publish direct
+//                                                        des gros payloads)
+//              ── flushOutbox()   ──→ MqttPublisher (budget flushBudget())
+//   callback   ── onMessage() ──→ matchCommand → mqttCommandFor → file entrante
+//   loopTask   ── collectCommands() ──→ MqttCommandBatch (lot coalescé)
+//
+// Les effets applicatifs (configMutex, NVS, actuateurs, mode document d'état)
+// restent dans mqtt_manager.cpp : le pipeline ne fait que transporter.
+//
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mqtt_commands.h"
+#include "mqtt_dedup.h"
+#include "mqtt_outbox.h"
+#include "mqtt_slab.h"
+#include "mqtt_topics.h"
+
+// Dimensionnement des files et cadence de mqttTask — source unique pour le
+// firmware et le banc natif.
+constexpr uint32_t kMqttOutQueueLength    = 48;   // File sortante : poignées de records du pool mqtt_slab (2 o/entrée, ≥ nb de blocs)
+constexpr uint32_t kMqttInQueueLength     = 16;   // File entrante (commandes HA)
+constexpr uint32_t kMqttTaskLoopTimeoutMs = 100;  // Attente max d'une itération de mqttTask (cadence mqtt.loop())
+
+static_assert(kMqttOutQueueLength >= kMqttSlabBlockCount[0] + kMqttSlabBlockCount[1] + kMqttSlabBlockCount[2],
+              "outQueue doit pouvoir porter tous les blocs du pool");
+
+// Commande HA reçue, telle qu'elle traverse la file entrante.
+struct MqttInboundCmd {
+  MqttCommand type;
+  char payload[kMqttCommandPayloadMax];
+};
+
+// File inter-tâches non bloquante (xQueue* avec timeout 0 sur cible).
+template <typename T>
+class MqttQueue {
+public:
+  virtual ~MqttQueue() = default;
+  virtual bool send(const T& item) = 0;
+  virtual bool receive(T& out) = 0;
+};
+
+// Client MQTT vu du pipeline (PubSubClient sur cible).
+class MqttPublisher {
+public:
+  virtual ~MqttPublisher() = default;
+  virtual bool connected() = 0;
+  virtual bool publish(const char* topic, const char* payload, bool retain) = 0;
+};
+
+// Résultat d'une mise en file : posté ou non, et messages perdus (le plus
+// ancien évincé et/ou le nouveau) pour le WARN edge-triggered de l'appelant.
+struct MqttPostResult {
+  bool posted = false;
+  uint8_t dropped = 0;
+};
+
+enum class MqttInboundResult : uint8_t {
+  Ignored,  // Pas un topic de commande
+  Queued,
+  Dropped,  // File entrante pleine
+};
+
+class MqttPipeline {
+public:
+  MqttPipeline(const MqttTopicTable& topics, MqttSlabPool& slab, MqttDedup& dedup, MqttOutbox& outbox);
+
+  // Branche les files et le client (appelé une fois, avant tout usage).
+  void attach(MqttQueue<MqttSlabHandle>* outQueue, MqttQueue<MqttInboundCmd>* inQueue,
+              MqttPublisher* publisher);
+
+  // Producteurs (loopTask, mqttTask) : payload copié une fois dans le pool
+  // (tronqué au-delà de kMqttSlabPayloadMax), poignée postée. Pool épuisé :
+  // le plus ancien record en file est évincé, puis nouvel essai.
+  MqttPostResult enqueue(MqttTopicId topic, const char* payload, bool retain);
+  // Poste un record déjà rempli dans le pool (prise de possession).
+  MqttPostResult post(MqttSlabHandle h);
+
+  // mqttTask : vide la file sortante vers l'outbox et libère les blocs.
+  //   enabled  — false : records jetés (MQTT désactivé)
+  //   stateDoc — mode document d'état : les champs du document ne sont pas
+  //              routés, ils marquent le document à reconstruire
+  // Retourne true si le document d'état est à reconstruire (lien établi).
+  bool drainOutQueue(uint32_t nowMs, uint32_t epoch, bool enabled, bool stateDoc);
+  // Range un message dans l'outbox (classe déduite du topic, état du lien).
+  void queueOutbox(MqttTopicId id, const char* payload, bool retain, uint32_t epoch);
+  // Publie depuis l'outbox dans la limite de flushBudget() ; un état publié
+  // est noté dans la dédup. Sans effet hors-ligne.
+  void flushOutbox(uint32_t nowMs);
+
+  // mqttTask (callback PubSubClient) : topic de commande → file entrante,
+  // payload tronqué à kMqttCommandPayloadMax - 1.
+  MqttInboundResult onMessage(const char* topic, const uint8_t* payload, size_t length);
+  // loopTask : vide la file entrante (au plus kMqttInQueueLength commandes)
+  // dans `batch`. `writesConfig` : au moins une commande touche la config.
+  void collectCommands(MqttCommandBatch& batch, bool& writesConfig);
+
+private:
+  const MqttTopicTable& _topics;
+  MqttSlabPool& _slab;
+  MqttDedup& _dedup;
+  MqttOutbox& _outbox;
+  MqttQueue<MqttSlabHandle>* _outQueue = nullptr;
+  MqttQueue<MqttInboundCmd>* _inQueue = nullptr;
+  MqttPublisher* _publisher = nullptr;
+};
+
+#endif // MQTT_PIPELINE_H
@@ -0,0 +1,102 @@
+#include "mqtt_slab.h"
+
+#include <string.h>
+
+// =============================================================================
+// mqtt_slab — implémentation PURE
+// =============================================================================
+
+namespace {
+
+constexpr uint32_t fullMask(size_t n) {
+  return n >= 32 ? 0xFFFFFFFFu : ((1u << n) - 1u);
+}
+
+constexpr size_t classOffset(size_t cls) {
+  return cls == 0 ? 0 : classOffset(cls - 1) + kMqttSlabBlockSize[cls - 1] * kMqttSlabBlockCount[cls - 1];
+}
+
+inline size_t handleClass(MqttSlabHandle h) { return h >> 8; }
+inline size_t handleIndex(MqttSlabHandle h) { return h & 0xFF; }
+
+}  // namespace
+
+MqttSlabPool::MqttSlabPool() {
+  for (size_t c = 0; c < kMqttSlabClassCount; ++c) {
+    _free[c].store(fullMask(kMqttSlabBlockCount[c]), std::memory_order_relaxed);
+    _peak[c].store(0, std::memory_order_relaxed);
+  }
+}
+
+MqttSlabHandle MqttSlabPool::_take(size_t cls) {
+  uint32_t mask = _free[cls].load(std::memory_order_acquire);
+  while (mask != 0) {
+    const uint32_t bit = static_cast<uint32_t>(__builtin_ctz(mask));
+    if (_free[cls].compare_exchange_weak(mask, mask & ~(1u << bit), std::memory_order_acquire)) {
+      // Pic d'occupation : approximatif sous concurrence, exact en mono-producteur.
+      const uint8_t inUse = static_cast<uint8_t>(used(cls));
+      uint8_t prev = _peak[cls].load(std::memory_order_relaxed);
+      while (inUse > prev && !_peak[cls].compare_exchange_weak(prev, inUse, std::memory_order_relaxed)) {
+      }
+      return static_cast<MqttSlabHandle>((cls << 8) | bit);
+    }
+    // compare_exchange a rechargé mask : nouvel essai.
+  }
+  return kMqttSlabNone;
+}
+
+MqttSlabHandle MqttSlabPool::alloc(size_t payloadLen) {
+  const size_t need = sizeof(MqttSlabHeader) + payloadLen + 1;
+  for (size_t c = 0; c < kMqttSlabClassCount; ++c) {
+    if (need > kMqttSlabBlockSize[c]) continue;
+    MqttSlabHandle h = _take(c);
+    // Débordement vers la classe suivante, jamais vers la dernière (réservée).
+    if (h == kMqttSlabNone && c + 2 < kMqttSlabClassCount) h = _take(c + 1);
+    if (h != kMqttSlabNone) return h;
+    break;
+  }
+  _failures.fetch_add(1, std::memory_order_relaxed);
+  return kMqttSlabNone;
+}
+
+MqttSlabHandle MqttSlabPool::store(MqttTopicId topic, bool retain, const char* text, size_t len) {
+  if (text == nullptr) len = 0;
+  if (len > kMqttSlabPayloadMax) len = kMqttSlabPayloadMax;
+  const MqttSlabHandle h = alloc(len);
+  if (h == kMqttSlabNone) return h;
+  MqttSlabHeader& hdr = header(h);
+  hdr.topic = topic;
+  hdr.retain = retain;
+  hdr.len = static_cast<uint16_t>(len);
+  char* p = payload(h);
+  if (len > 0) memcpy(p, text, len);
+  p[len] = '\0';
+  return h;
+}
+
+void MqttSlabPool::release(MqttSlabHandle h) {
+  if (h == kMqttSlabNone) return;
+  _free[handleClass(h)].fetch_or(1u << handleIndex(h), std::memory_order_release);
+}
+
+uint8_t* MqttSlabPool::_block(MqttSlabHandle h) {
+  const size_t c = handleClass(h);
+  return _mem + classOffset(c) + handleIndex(h) * kMqttSlabBlockSize[c];
+}
+
+MqttSlabHeader& MqttSlabPool::header(MqttSlabHandle h) {
+  return *reinterpret_cast<MqttSlabHeader*>(_block(h));
+}
+
+char* MqttSlabPool::payload(MqttSlabHandle h) {
+  return reinterpret_cast<char*>(_block(h) + sizeof(MqttSlabHeader));
+}
+
+size_t MqttSlabPool::capacity(MqttSlabHandle h) const {
+  return kMqttSlabBlockSize[handleClass(h)] - sizeof(MqttSlabHeader);
+}
+
+size_t MqttSlabPool::used(size_t cls) const {
+  const uint32_t freeBits = _free[cls].load(std::memory_order_relaxed);
+  return kMqttSlabBlockCount[cls] - static_cast<size_t>(__builtin_popcount(freeBits));
+}
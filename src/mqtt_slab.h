@@ -0,0 +1,94 @@
+#ifndef MQTT_SLAB_H
+#define MQTT_SLAB_H
+
+// =============================================================================
+// mqtt_slab — Pool de records MQTT sortants à longueur variable, PURE
+// =============================================================================
+// Les producteurs (loopTask, et mqttTask pour le diagnostic) écrivent le
+// payload une seule fois dans un bloc du pool ; seule la poignée (2 octets)
+// traverse la file FreeRTOS. mqttTask lit le record en place puis le libère.
+//
+//   Classe | Bloc   | Blocs | Payload max | Usage type
+//   -------|--------|-------|-------------|-----------------------------------
+//   0      | 32 o   | 32    | 27 c        | états : "ON", nombres, HH:MM, modes
+//   1      | 160 o  | 8     | 155 c       | alertes JSON, logs
+//   2      | 1024 o | 2     | 1019 c      | diagnostic JSON
+//
+// Un record trop long pour sa classe prend un bloc de la classe suivante, sauf
+// la dernière : les gros blocs restent réservés aux gros payloads (une rafale
+// d'états ne prive pas le diagnostic). Au-delà de kMqttSlabPayloadMax, le
+// producteur tronque.
+//
+// Allocation sans verrou : un masque de blocs libres par classe (std::atomic,
+// compare-and-swap), utilisable depuis deux tâches sans mutex ni section
+// critique. Les compteurs (pic d'occupation, échecs) alimentent le diagnostic.
+//
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include "mqtt_topics.h"
+
+constexpr size_t kMqttSlabClassCount = 3;
+constexpr size_t kMqttSlabBlockSize[kMqttSlabClassCount] = {32, 160, 1024};
+constexpr size_t kMqttSlabBlockCount[kMqttSlabClassCount] = {32, 8, 2};
+
+// Poignée : classe << 8 | index du bloc. kMqttSlabNone = pas de bloc.
+using MqttSlabHandle = uint16_t;
+constexpr MqttSlabHandle kMqttSlabNone = 0xFFFF;
+
+// En-tête placé en début de bloc, suivi du payload (NUL compris).
+struct MqttSlabHeader {
+  MqttTopicId topic;
+  bool retain;
+  uint16_t len;  // Longueur du payload, NUL exclu
+};
+
+constexpr size_t kMqttSlabPayloadMax =
+    kMqttSlabBlockSize[kMqttSlabClassCount - 1] - sizeof(MqttSlabHeader) - 1;
+
+static_assert(kMqttSlabBlockCount[0] <= 32 && kMqttSlabBlockCount[1] <= 32 &&
+                  kMqttSlabBlockCount[2] <= 32,
+              "un masque 32 bits par classe");
+static_assert(kMqttSlabBlockSize[0] % 4 == 0 && kMqttSlabBlockSize[1] % 4 == 0 &&
+                  kMqttSlabBlockSize[2] % 4 == 0,
+              "blocs alignés sur 4 octets (en-tête)");
+
+class MqttSlabPool {
+public:
+  MqttSlabPool();
+
+  // Réserve un bloc pouvant contenir payloadLen caractères + NUL. kMqttSlabNone
+  // si trop long ou si les classes éligibles sont pleines (compté en échec).
+  MqttSlabHandle alloc(size_t payloadLen);
+  // Alloue et remplit un record (payload tronqué à kMqttSlabPayloadMax).
+  MqttSlabHandle store(MqttTopicId topic, bool retain, const char* text, size_t len);
+  // Rend le bloc au pool. kMqttSlabNone ignoré.
+  void release(MqttSlabHandle h);
+
+  // Accès au record d'une poignée valide (le propriétaire est l'unique lecteur).
+  MqttSlabHeader& header(MqttSlabHandle h);
+  char* payload(MqttSlabHandle h);
+  // Octets disponibles pour le payload, NUL compris.
+  size_t capacity(MqttSlabHandle h) const;
+
+  // Occupation (diagnostic).
+  size_t used(size_t cls) const;
+  size_t peak(size_t cls) const { return _peak[cls].load(std::memory_order_relaxed); }
+  uint32_t failures() const { return _failures.load(std::memory_order_relaxed); }
+
+private:
+  alignas(4) uint8_t _mem[kMqttSlabBlockSize[0] * kMqttSlabBlockCount[0] +
+                          kMqttSlabBlockSize[1] * kMqttSlabBlockCount[1] +
+                          kMqttSlabBlockSize[2] * kMqttSlabBlockCount[2]];
+  std::atomic<uint32_t> _free[kMqttSlabClassCount];
+  std::atomic<uint8_t> _peak[kMqttSlabClassCount];
+  std::atomic<uint32_t> _failures{0};
+
+  MqttSlabHandle _take(size_t cls);
+  uint8_t* _block(MqttSlabHandle h);
+};
+
+#endif // MQTT_SLAB_H
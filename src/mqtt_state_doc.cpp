@@ -0,0 +1,109 @@
+#include "mqtt_state_doc.h"
+
+#include <math.h>
+#include "fixed_format.h"
+
+// =============================================================================
+// mqtt_state_doc — implémentation PURE
+// =============================================================================
+
+MqttStateDoc::MqttStateDoc(char* buf, size_t cap, const MqttDedup& dedup, uint32_t nowMs)
+    : _buf(buf), _cap(cap), _dedup(dedup), _nowMs(nowMs) {
+  if (_buf == nullptr || _cap == 0) {
+    _overflow = true;
+    return;
+  }
+  _buf[0] = '\0';
+  _put('{');
+}
+
+bool MqttStateDoc::isDocumentField(MqttTopicId id) {
+  return id != MqttTopicId::StateDocument && MqttDedup::isDeduplicated(id);
+}
+
+void MqttStateDoc::_put(char c) {
+  // Une place toujours réservée au NUL final.
+  if (_overflow || _len + 1 >= _cap) {
+    _overflow = true;
+    return;
+  }
+  _buf[_len++] = c;
+  _buf[_len] = '\0';
+}
+
+void MqttStateDoc::_puts(const char* s) {
+  while (*s != '\0' && !_overflow) _put(*s++);
+}
+
+void MqttStateDoc::_key(MqttTopicId id) {
+  if (!_first) _put(',');
+  _first = false;
+  _put('"');
+  _puts(mqttTopicSuffix(id));  // Suffixes ASCII sans guillemets : pas d'échappement
+  _put('"');
+  _put(':');
+}
+
+void MqttStateDoc::_fixed(int32_t scaled, uint8_t decimals) {
+  char text[kFixedFormatMax];
+  formatFixed(text, sizeof(text), scaled, decimals);
+  _puts(text);
+}
+
+void MqttStateDoc::_mark(MqttTopicId id, bool isText, uint32_t key) {
+  if (_markCount < kMqttTopicCount) {
+    _marks[_markCount++] = Mark{id, isText, key};
+  }
+}
+
+void MqttStateDoc::value(MqttTopicId id, float v, uint8_t decimals) {
+  if (!isfinite(v) || id >= MqttTopicId::Count) return;
+  if (decimals > kFixedMaxDecimals) decimals = kFixedMaxDecimals;
+  // Même virgule fixe que MqttManager::publishStateValue (entrées de dédup
+  // interchangeables, valeur publiée = valeur mémorisée).
+  const int32_t fixed = fixedFromFloat(v, decimals);
+  if (_dedup.valueDue(id, fixed, _nowMs)) _due = true;
+  _key(id);
+  _fixed(fixed, decimals);
+  _mark(id, false, static_cast<uint32_t>(fixed));
+}
+
+void MqttStateDoc::text(MqttTopicId id, const char* s) {
+  if (id >= MqttTopicId::Count) return;
+  const char* p = s ? s : "";
+  if (_dedup.textDue(id, p, _nowMs)) _due = true;
+  _key(id);
+  _put('"');
+  static const char kHex[] = "0123456789abcdef";
+  for (const char* c = p; *c != '\0' && !_overflow; ++c) {
+    const unsigned char u = static_cast<unsigned char>(*c);
+    if (u == '"' || u == '\\') {
+      _put('\\');
+      _put(static_cast<char>(u));
+    } else if (u < 0x20) {
+      _puts("\\u00");
+      _put(kHex[u >> 4]);
+      _put(kHex[u & 0x0F]);
+    } else {
+      _put(static_cast<char>(u));  // UTF-8 transmis tel quel
+    }
+  }
+  _put('"');
+  _mark(id, true, MqttDedup::textHash(p));
+}
+
+bool MqttStateDoc::finish() {
+  _put('}');
+  return !_overflow;
+}
+
+void MqttStateDoc::commit(MqttDedup& dedup) const {
+  for (size_t i = 0; i < _markCount; ++i) {
+    const Mark& m = _marks[i];
+    if (m.isText) {
+      dedup.markTextHash(m.id, m.key, _nowMs);
+    } else {
+      dedup.markValue(m.id, static_cast<int32_t>(m.key), _nowMs);
+    }
+  }
+}
@@ -0,0 +1,86 @@
+#ifndef MQTT_STATE_DOC_H
+#define MQTT_STATE_DOC_H
+
+// =============================================================================
+// mqtt_state_doc — Document d'état JSON unique {base}/state, PURE
+// =============================================================================
+// Mode « document d'état » (mqttCfg.stateJson) : au lieu d'un publish retain
+// par topic d'état (~55 allers-retours TCP par cycle sur un lien CPL/Wi-Fi
+// lent), tout l'état est sérialisé en un seul objet JSON compact publié sur
+// {base}/state. Les clés sont les suffixes de topic (mqtt_topics.h) :
+//   {"temperature":26.4,"ph":7.215,"orp":682,"filtration_state":"ON",…}
+// Home Assistant lit chaque entité via value_template (value_json.<clé>).
+//
+// MqttStateDoc écrit en flux dans un tampon fourni par l'appelant (réutilisé
+// d'un cycle à l'autre : ni JsonDocument, ni String, ni allocation) :
+//   - nombres formatés depuis leur virgule fixe value×10^décimales (pas de
+//     printf flottant) ; NaN → clé omise (HA garde la dernière valeur) ;
+//   - textes échappés JSON.
+// La dédup par champ réutilise MqttDedup : le document n'est dû que si au
+// moins un champ l'est (bande morte franchie, texte changé, rafraîchissement
+// forcé) ; commit() mémorise alors TOUS les champs publiés.
+//
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mqtt_topics.h"
+#include "mqtt_dedup.h"
+
+// Taille du tampon document : couvre le pire cas (tous les champs, valeurs
+// les plus longues) — vérifié par test_native_mqtt_state_doc.
+constexpr size_t kMqttStateDocMax = 2048;
+
+class MqttStateDoc {
+public:
+  MqttStateDoc(char* buf, size_t cap, const MqttDedup& dedup, uint32_t nowMs);
+
+  // Champ numérique (virgule fixe, `decimals` 0..3). NaN : omis.
+  void value(MqttTopicId id, float v, uint8_t decimals);
+  // Champ texte (ON/OFF, modes, heures…). nullptr = "".
+  void text(MqttTopicId id, const char* s);
+
+  // Ferme l'objet. false si le tampon a débordé (document inutilisable).
+  bool finish();
+
+  const char* c_str() const { return _buf; }
+  size_t length() const { return _len; }
+  bool overflowed() const { return _overflow; }
+  // Au moins un champ dû au sens de MqttDedup.
+  bool due() const { return _due; }
+  size_t fieldCount() const { return _markCount; }
+
+  // Mémorise dans `dedup` la valeur de chaque champ écrit (après publish réussi).
+  void commit(MqttDedup& dedup) const;
+
+  // Topics portés par le document : états dédupliqués (hors alerts, logs,
+  // status, diagnostic, history et le topic state lui-même).
+  static bool isDocumentField(MqttTopicId id);
+
+private:
+  struct Mark {
+    MqttTopicId id;
+    bool isText;
+    uint32_t key;  // virgule fixe (int32 réinterprété) ou hash texte
+  };
+
+  char* _buf;
+  size_t _cap;
+  size_t _len = 0;
+  bool _overflow = false;
+  bool _due = false;
+  bool _first = true;
+  const MqttDedup& _dedup;
+  uint32_t _nowMs;
+  Mark _marks[kMqttTopicCount];
+  size_t _markCount = 0;
+
+  void _put(char c);
+  void _puts(const char* s);
+  void _key(MqttTopicId id);
+  void _fixed(int32_t scaled, uint8_t decimals);
+  void _mark(MqttTopicId id, bool isText, uint32_t key);
+};
+
+#endif // MQTT_STATE_DOC_H
@@ -0,0 +1,420 @@
+#include "mqtt_tls_client.h"
+
+#include <WiFi.h>
+#include <esp_task_wdt.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <lwip/sockets.h>
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/sha256.h>
+#include <mbedtls/ssl.h>
+#include <string.h>
+#include <new>
+#include "ota_integrity_logic.h"
+
+// Contexte mbedTLS, alloué au premier connect TLS. API mbedTLS 2.28 (IDF 4.4).
+struct MqttTlsContext {
+  mbedtls_entropy_context entropy;
+  mbedtls_ctr_drbg_context drbg;
+  mbedtls_ssl_config conf;
+  mbedtls_ssl_context ssl;
+  mbedtls_ssl_session session;  // session du dernier handshake réussi
+};
+
+namespace {
+
+constexpr uint32_t kHandshakeSelectMs = 50;  // attente socket entre deux étapes
+
+bool isIpLiteral(const char* host) {
+  IPAddress ip;
+  return ip.fromString(host);
+}
+
+// Session reprenable : le broker a émis un ticket ou un identifiant.
+bool sessionResumable(const mbedtls_ssl_session& s) {
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+  if (s.ticket != nullptr && s.ticket_len > 0) return true;
+#endif
+  return s.id_len > 0;
+}
+
+}  // namespace
+
+MqttTlsClient::~MqttTlsClient() {
+  teardown(false);
+  if (_ctx) {
+    mbedtls_ssl_session_free(&_ctx->session);
+    mbedtls_ssl_config_free(&_ctx->conf);
+    mbedtls_ctr_drbg_free(&_ctx->drbg);
+    mbedtls_entropy_free(&_ctx->entropy);
+    delete _ctx;
+  }
+}
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+void MqttTlsClient::setHostname(const char* host) {
+  strlcpy(_host, host ? host : "", sizeof(_host));
+}
+
+void MqttTlsClient::setPin(const uint8_t* pin) {
+  _pinned = pin != nullptr;
+  if (_pinned) memcpy(_pin, pin, kMqttTlsPinLen);
+}
+
+void MqttTlsClient::setTimeouts(uint32_t connectMs, uint32_t handshakeMs) {
+  _connectTimeoutMs = connectMs;
+  _handshakeTimeoutMs = handshakeMs;
+}
+
+void MqttTlsClient::forgetSession() {
+  _policy.invalidate();
+}
+
+bool MqttTlsClient::ensureContext() {
+  if (_ctx) return true;
+  MqttTlsContext* c = new (std::nothrow) MqttTlsContext;
+  if (c == nullptr) return false;
+  mbedtls_entropy_init(&c->entropy);
+  mbedtls_ctr_drbg_init(&c->drbg);
+  mbedtls_ssl_config_init(&c->conf);
+  mbedtls_ssl_session_init(&c->session);
+
+  static const char kPers[] = "pool-mqtt-tls";
+  int ret = mbedtls_ctr_drbg_seed(&c->drbg, mbedtls_entropy_func, &c->entropy,
+                                  reinterpret_cast<const unsigned char*>(kPers), sizeof(kPers) - 1);
+  if (ret == 0) {
+    ret = mbedtls_ssl_config_defaults(&c->conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                      MBEDTLS_SSL_PRESET_DEFAULT);
+  }
+  if (ret != 0) {
+    _lastError = ret;
+    mbedtls_ssl_session_free(&c->session);
+    mbedtls_ssl_config_free(&c->conf);
+    mbedtls_ctr_drbg_free(&c->drbg);
+    mbedtls_entropy_free(&c->entropy);
+    delete c;
+    return false;
+  }
+  mbedtls_ssl_conf_rng(&c->conf, mbedtls_ctr_drbg_random, &c->drbg);
+  // OPTIONAL sans CA : la chaîne n'est pas validée (pas de magasin embarqué),
+  // la confiance repose sur l'épinglage, obligatoire (cf. connect) ; le rappel
+  // voit le certificat feuille → épinglage + détection reprise (aucun
+  // certificat reçu = session reprise).
+  mbedtls_ssl_conf_authmode(&c->conf, MBEDTLS_SSL_VERIFY_OPTIONAL);
+  mbedtls_ssl_conf_verify(&c->conf, verifyCert, this);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+  mbedtls_ssl_conf_session_tickets(&c->conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+  _ctx = c;
+  return true;
+}
+
+// ============================================================================
+// Connexion
+// ============================================================================
+
+int MqttTlsClient::connect(const char* host, uint16_t port) {
+  IPAddress ip;
+  if (!WiFi.hostByName(host, ip)) {
+    _lastError = MBEDTLS_ERR_NET_UNKNOWN_HOST;
+    return 0;
+  }
+  if (_host[0] == '\0') setHostname(host);
+  return connect(ip, port);
+}
+
+int MqttTlsClient::connect(IPAddress ip, uint16_t port) {
+  teardown(false);
+  _lastError = 0;
+  _pinRejected = false;
+  _lastResumed = false;
+  if (!ensureContext()) {
+    if (_lastError == 0) _lastError = MBEDTLS_ERR_SSL_ALLOC_FAILED;
+    _stats.recordFailure();
+    return 0;
+  }
+
+  const uint32_t heapBefore = ESP.getFreeHeap();
+  _fd = openSocket(ip, port);
+  if (_fd < 0) {
+    _lastError = MBEDTLS_ERR_NET_CONNECT_FAILED;
+    return 0;  // échec TCP : ni handshake ni statistique TLS
+  }
+
+  mbedtls_ssl_init(&_ctx->ssl);
+  _sslActive = true;
+  int ret = mbedtls_ssl_setup(&_ctx->ssl, &_ctx->conf);
+  if (ret == 0 && _host[0] != '\0' && !isIpLiteral(_host)) {
+    ret = mbedtls_ssl_set_hostname(&_ctx->ssl, _host);
+  }
+  if (ret != 0) {
+    _lastError = ret;
+    _stats.recordFailure();
+    teardown(false);
+    return 0;
+  }
+  mbedtls_ssl_set_bio(&_ctx->ssl, this, bioSend, bioRecv, nullptr);
+
+  const uint32_t key = mqttTlsSessionKey(_host, port, _pinned ? _pin : nullptr);
+  const bool offer = _policy.shouldResume(key, millis()) &&
+                     mbedtls_ssl_set_session(&_ctx->ssl, &_ctx->session) == 0;
+
+  MqttTlsHandshakeSample sample{};
+  ret = handshake(offer, heapBefore, sample);
+  // Tout handshake complet doit avoir présenté le certificat épinglé : sans
+  // empreinte, ou sans certificat vu, pas de repli non authentifié. Seule une
+  // session reprise (négociée sous la même empreinte, cf. clé) en est dispensée.
+  if (ret == 0 && !sample.resumed && !_pinMatched) {
+    _pinRejected = true;
+    ret = MBEDTLS_ERR_X509_CERT_VERIFY_FAILED;
+  }
+  if (ret != 0) {
+    _lastError = ret;
+    _policy.failed(offer);
+    _stats.recordFailure();
+    teardown(_pinRejected);  // empreinte refusée : handshake abouti, close_notify
+    return 0;
+  }
+
+  _lastResumed = sample.resumed;
+  _stats.record(sample);
+
+  // Recopie la session (ticket éventuellement renouvelé par le broker).
+  mbedtls_ssl_session_free(&_ctx->session);
+  mbedtls_ssl_session_init(&_ctx->session);
+  if (mbedtls_ssl_get_session(&_ctx->ssl, &_ctx->session) == 0 && sessionResumable(_ctx->session)) {
+    _policy.stored(key, millis(), sample.resumed);
+  } else {
+    _policy.invalidate();
+  }
+
+  _connected = true;
+  return 1;
+}
+
+int MqttTlsClient::openSocket(IPAddress ip, uint16_t port) {
+  int fd = lwip_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (fd < 0) return -1;
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = static_cast<uint32_t>(ip);
+  addr.sin_port = htons(port);
+
+  // Connect non bloquant borné par select() (même schéma que WiFiClient).
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  int res = lwip_connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+  if (res < 0 && errno != EINPROGRESS) {
+    lwip_close(fd);
+    return -1;
+  }
+  if (res < 0) {
+    fd_set wfds;
+    FD_ZERO(&wfds);
+    FD_SET(fd, &wfds);
+    struct timeval tv;
+    tv.tv_sec = _connectTimeoutMs / 1000;
+    tv.tv_usec = (_connectTimeoutMs % 1000) * 1000;
+    int sockErr = 0;
+    socklen_t errLen = sizeof(sockErr);
+    if (lwip_select(fd + 1, nullptr, &wfds, nullptr, &tv) <= 0 ||
+        lwip_getsockopt(fd, SOL_SOCKET, SO_ERROR, &sockErr, &errLen) < 0 || sockErr != 0) {
+      lwip_close(fd);
+      return -1;
+    }
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) & ~O_NONBLOCK);
+
+  // Écritures bloquantes bornées (MqttManager resserre à kMqttSocketSendTimeoutMs
+  // une fois connecté) ; lectures en MSG_DONTWAIT dans bioRecv.
+  struct timeval stv;
+  stv.tv_sec = _connectTimeoutMs / 1000;
+  stv.tv_usec = (_connectTimeoutMs % 1000) * 1000;
+  lwip_setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &stv, sizeof(stv));
+  int one = 1;
+  lwip_setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  lwip_setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+  return fd;
+}
+
+// Handshake pas à pas : le tas libre est relevé entre chaque étape pour
+// estimer le pic (tampons d'enregistrement + calculs ECDHE/RSA).
+int MqttTlsClient::handshake(bool offerSession, uint32_t heapBefore, MqttTlsHandshakeSample& sample) {
+  _certSeen = false;
+  _pinMatched = false;
+  const uint32_t minFreeBefore = ESP.getMinFreeHeap();
+  uint32_t heapMin = heapBefore;
+  const uint32_t startMs = millis();
+  int ret = 0;
+
+  while (_ctx->ssl.state != MBEDTLS_SSL_HANDSHAKE_OVER) {
+    ret = mbedtls_ssl_handshake_step(&_ctx->ssl);
+    const uint32_t freeNow = ESP.getFreeHeap();
+    if (freeNow < heapMin) heapMin = freeNow;
+    if (ret == 0) continue;
+    if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) break;
+    if (millis() - startMs >= _handshakeTimeoutMs) {
+      ret = MBEDTLS_ERR_SSL_TIMEOUT;
+      break;
+    }
+    esp_task_wdt_reset();
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(_fd, &fds);
+    struct timeval tv = {0, static_cast<long>(kHandshakeSelectMs * 1000)};
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ) {
+      lwip_select(_fd + 1, &fds, nullptr, nullptr, &tv);
+    } else {
+      lwip_select(_fd + 1, nullptr, &fds, nullptr, &tv);
+    }
+    ret = 0;
+  }
+  if (ret != 0) return ret;
+
+  // Le plancher global du tas a baissé pendant le handshake : c'est le vrai
+  // minimum (plus fin que l'échantillonnage entre étapes).
+  const uint32_t minFreeAfter = ESP.getMinFreeHeap();
+  if (minFreeAfter < minFreeBefore && minFreeAfter < heapMin) heapMin = minFreeAfter;
+  const uint32_t heapAfter = ESP.getFreeHeap();
+
+  sample.durationMs = millis() - startMs;
+  sample.resumeOffered = offerSession;
+  sample.resumed = offerSession && !_certSeen;
+  sample.heapPeakBytes = heapBefore > heapMin ? heapBefore - heapMin : 0;
+  sample.heapHeldBytes = heapBefore > heapAfter ? heapBefore - heapAfter : 0;
+  return 0;
+}
+
+void MqttTlsClient::teardown(bool notifyPeer) {
+  if (_sslActive) {
+    if (notifyPeer && _fd >= 0) mbedtls_ssl_close_notify(&_ctx->ssl);
+    mbedtls_ssl_free(&_ctx->ssl);  // libère les tampons d'enregistrement
+    _sslActive = false;
+  }
+  if (_fd >= 0) {
+    lwip_close(_fd);
+    _fd = -1;
+  }
+  _connected = false;
+  _peeked = -1;
+}
+
+void MqttTlsClient::stop() {
+  teardown(_connected);
+}
+
+uint8_t MqttTlsClient::connected() {
+  if (_connected) available();  // détecte close_notify / RST sans bloquer
+  return _connected ? 1 : 0;
+}
+
+// ============================================================================
+// E/S
+// ============================================================================
+
+size_t MqttTlsClient::write(uint8_t b) {
+  return write(&b, 1);
+}
+
+size_t MqttTlsClient::write(const uint8_t* buf, size_t size) {
+  if (!_connected) return 0;
+  size_t done = 0;
+  while (done < size) {
+    const int ret = mbedtls_ssl_write(&_ctx->ssl, buf + done, size - done);
+    if (ret > 0) {
+      done += static_cast<size_t>(ret);
+      continue;
+    }
+    // WANT_WRITE = SO_SNDTIMEO échu. Un enregistrement TLS à moitié émis ne
+    // peut pas être abandonné puis repris avec d'autres données : la connexion
+    // est fermée, la reconnexion (reprise de session) est le chemin de repli.
+    teardown(false);
+    break;
+  }
+  return done;
+}
+
+int MqttTlsClient::available() {
+  if (!_connected) return 0;
+  const int pending = (_peeked >= 0 ? 1 : 0) + static_cast<int>(mbedtls_ssl_get_bytes_avail(&_ctx->ssl));
+  if (pending > 0) return pending;
+  // Traite les enregistrements en attente sur le socket (sans bloquer).
+  const int ret = mbedtls_ssl_read(&_ctx->ssl, nullptr, 0);
+  if (ret < 0 && ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+    teardown(false);
+    return 0;
+  }
+  return static_cast<int>(mbedtls_ssl_get_bytes_avail(&_ctx->ssl));
+}
+
+int MqttTlsClient::read() {
+  uint8_t b;
+  return read(&b, 1) == 1 ? b : -1;
+}
+
+int MqttTlsClient::read(uint8_t* buf, size_t size) {
+  if (size == 0) return 0;
+  size_t off = 0;
+  if (_peeked >= 0) {
+    buf[off++] = static_cast<uint8_t>(_peeked);
+    _peeked = -1;
+    if (off == size) return 1;
+  }
+  if (!_connected) return off > 0 ? static_cast<int>(off) : -1;
+  const int ret = mbedtls_ssl_read(&_ctx->ssl, buf + off, size - off);
+  if (ret > 0) return static_cast<int>(off) + ret;
+  if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) teardown(false);
+  return off > 0 ? static_cast<int>(off) : -1;
+}
+
+int MqttTlsClient::peek() {
+  if (_peeked < 0) {
+    uint8_t b;
+    if (read(&b, 1) == 1) _peeked = b;
+  }
+  return _peeked;
+}
+
+// ============================================================================
+// Rappels mbedTLS
+// ============================================================================
+
+int MqttTlsClient::bioSend(void* self, const unsigned char* buf, size_t len) {
+  const int fd = static_cast<MqttTlsClient*>(self)->_fd;
+  const int ret = lwip_send(fd, buf, len, 0);
+  if (ret >= 0) return ret;
+  if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return MBEDTLS_ERR_SSL_WANT_WRITE;
+  if (errno == EPIPE || errno == ECONNRESET) return MBEDTLS_ERR_NET_CONN_RESET;
+  return MBEDTLS_ERR_NET_SEND_FAILED;
+}
+
+int MqttTlsClient::bioRecv(void* self, unsigned char* buf, size_t len) {
+  const int fd = static_cast<MqttTlsClient*>(self)->_fd;
+  const int ret = lwip_recv(fd, buf, len, MSG_DONTWAIT);
+  if (ret >= 0) return ret;  // 0 = fin de flux (MBEDTLS_ERR_SSL_CONN_EOF)
+  if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return MBEDTLS_ERR_SSL_WANT_READ;
+  if (errno == EPIPE || errno == ECONNRESET) return MBEDTLS_ERR_NET_CONN_RESET;
+  return MBEDTLS_ERR_NET_RECV_FAILED;
+}
+
+// Appelé pour chaque certificat de la chaîne reçue, donc uniquement lors d'un
+// handshake complet. Seul le certificat feuille (depth 0) est épinglé.
+int MqttTlsClient::verifyCert(void* self, mbedtls_x509_crt* crt, int depth, uint32_t* flags) {
+  (void)flags;  // chaîne non validée (VERIFY_OPTIONAL sans CA), cf. ensureContext
+  MqttTlsClient* c = static_cast<MqttTlsClient*>(self);
+  if (depth != 0) return 0;
+  c->_certSeen = true;
+  if (c->_pinned) {
+    uint8_t digest[32];
+    if (mbedtls_sha256_ret(crt->raw.p, crt->raw.len, digest, 0) == 0) {
+      c->_pinMatched = sha256Equal(digest, c->_pin);
+    }
+  }
+  return 0;
+}
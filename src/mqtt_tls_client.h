@@ -0,0 +1,109 @@
+#ifndef MQTT_TLS_CLIENT_H
+#define MQTT_TLS_CLIENT_H
+
+// =============================================================================
+// mqtt_tls_client — Transport TLS de PubSubClient avec reprise de session
+// =============================================================================
+// Client Arduino (interface Client) sur mbedTLS + socket lwip, utilisé par
+// MqttManager quand mqttCfg.tls est actif. Remplace WiFiClientSecure : le
+// ssl_client d'Arduino-ESP32 2.0.17 enchaîne setup + handshake en un seul
+// appel, sans point d'entrée pour mbedtls_ssl_set_session — donc sans reprise.
+//
+//   - Reprise de session (ticket RFC 5077 ou ID) : la session du dernier
+//     handshake est gardée en RAM (survit à stop()) et reproposée au broker ;
+//     politique dans mqtt_tls_logic (clé hôte:port + empreinte, durée de vie).
+//   - Épinglage obligatoire : SHA-256 du certificat feuille comparé à
+//     l'empreinte configurée (pas de CA embarquée). Un handshake complet sans
+//     empreinte, ou dont le certificat ne correspond pas, est refusé.
+//   - Instrumentation : durée du handshake, pic et coût résident du tas
+//     (MqttTlsStats), exposés dans le diagnostic MQTT.
+//
+// Contexte mbedTLS (~2,5 Ko) alloué au premier connect TLS seulement : aucun
+// coût RAM tant que l'option est désactivée. Les tampons d'enregistrement
+// (~20 Ko) sont libérés à chaque stop().
+//
+// Thread-safety : utilisé UNIQUEMENT depuis mqttTask (comme wifiClient).
+// =============================================================================
+
+#include <Arduino.h>
+#include <Client.h>
+#include "mqtt_tls_logic.h"
+
+struct MqttTlsContext;  // mbedTLS, défini dans mqtt_tls_client.cpp
+
+class MqttTlsClient : public Client {
+public:
+  MqttTlsClient() = default;
+  ~MqttTlsClient() override;
+  MqttTlsClient(const MqttTlsClient&) = delete;
+  MqttTlsClient& operator=(const MqttTlsClient&) = delete;
+
+  // Configuration — socket fermé, avant connect().
+  // Nom du broker tel que configuré : SNI (sauf IP littérale) + clé de session.
+  void setHostname(const char* host);
+  // Empreinte SHA-256 attendue ; nullptr = aucune, tout handshake complet refusé.
+  void setPin(const uint8_t* pin);
+  void setTimeouts(uint32_t connectMs, uint32_t handshakeMs);
+  // Jette la session mémorisée (prochain handshake complet).
+  void forgetSession();
+
+  // Interface Client (appelée par PubSubClient)
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(const char* host, uint16_t port) override;
+  size_t write(uint8_t b) override;
+  size_t write(const uint8_t* buf, size_t size) override;
+  int available() override;
+  int read() override;
+  int read(uint8_t* buf, size_t size) override;
+  int peek() override;
+  void flush() override {}
+  void stop() override;
+  uint8_t connected() override;
+  operator bool() override { return _connected; }
+
+  // Descripteur du socket (SO_SNDTIMEO posé par MqttManager), -1 si fermé.
+  int fd() const { return _fd; }
+
+  // Dernier connect() : code d'erreur mbedTLS/lwip (0 = succès), empreinte
+  // refusée, session reprise.
+  int lastError() const { return _lastError; }
+  bool lastPinRejected() const { return _pinRejected; }
+  bool lastResumed() const { return _lastResumed; }
+  bool sessionCached() const { return _policy.valid(); }
+  const MqttTlsStats& stats() const { return _stats; }
+
+private:
+  bool ensureContext();
+  int openSocket(IPAddress ip, uint16_t port);
+  int handshake(bool offerSession, uint32_t heapBefore, MqttTlsHandshakeSample& sample);
+  void teardown(bool notifyPeer);
+
+  static int bioSend(void* self, const unsigned char* buf, size_t len);
+  static int bioRecv(void* self, unsigned char* buf, size_t len);
+  static int verifyCert(void* self, struct mbedtls_x509_crt* crt, int depth, uint32_t* flags);
+
+  MqttTlsContext* _ctx = nullptr;
+  int _fd = -1;
+  bool _connected = false;
+  bool _sslActive = false;  // _ctx->ssl initialisé pour la connexion courante
+  int _peeked = -1;
+
+  char _host[64] = "";
+  uint8_t _pin[kMqttTlsPinLen] = {};
+  bool _pinned = false;
+  uint32_t _connectTimeoutMs = 2000;
+  uint32_t _handshakeTimeoutMs = 10000;
+
+  // Rempli par verifyCert pendant le handshake en cours.
+  bool _certSeen = false;
+  bool _pinMatched = false;
+
+  int _lastError = 0;
+  bool _pinRejected = false;
+  bool _lastResumed = false;
+
+  MqttTlsSessionPolicy _policy;
+  MqttTlsStats _stats;
+};
+
+#endif // MQTT_TLS_CLIENT_H
@@ -0,0 +1,120 @@
+#include "mqtt_tls_logic.h"
+
+#include <string.h>
+
+// =============================================================================
+// mqtt_tls_logic — implémentation PURE
+// =============================================================================
+
+namespace {
+
+int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+constexpr uint32_t kFnvOffset = 2166136261u;
+constexpr uint32_t kFnvPrime = 16777619u;
+
+uint32_t fnv1a(uint32_t h, const uint8_t* data, size_t len) {
+  for (size_t i = 0; i < len; ++i) {
+    h ^= data[i];
+    h *= kFnvPrime;
+  }
+  return h;
+}
+
+}  // namespace
+
+bool mqttTlsParsePin(const char* text, uint8_t out[kMqttTlsPinLen]) {
+  if (text == nullptr || out == nullptr) return false;
+  // Sortie d'openssl : "sha256 Fingerprint=AA:BB:…" → on garde ce qui suit '='.
+  const char* eq = strrchr(text, '=');
+  const char* p = eq ? eq + 1 : text;
+
+  uint8_t tmp[kMqttTlsPinLen];
+  size_t nibbles = 0;
+  for (; *p != '\0'; ++p) {
+    if (*p == ':' || *p == '-' || *p == ' ') continue;
+    const int v = hexValue(*p);
+    if (v < 0 || nibbles >= 2 * kMqttTlsPinLen) return false;
+    if (nibbles % 2 == 0) {
+      tmp[nibbles / 2] = static_cast<uint8_t>(v << 4);
+    } else {
+      tmp[nibbles / 2] |= static_cast<uint8_t>(v);
+    }
+    nibbles++;
+  }
+  if (nibbles != 2 * kMqttTlsPinLen) return false;
+  memcpy(out, tmp, kMqttTlsPinLen);
+  return true;
+}
+
+size_t mqttTlsFormatPin(const uint8_t pin[kMqttTlsPinLen], char* buf, size_t cap) {
+  static const char kHex[] = "0123456789ABCDEF";
+  if (buf == nullptr || cap == 0) return 0;
+  if (pin == nullptr || cap < kMqttTlsPinTextMax) {
+    buf[0] = '\0';
+    return 0;
+  }
+  size_t o = 0;
+  for (size_t i = 0; i < kMqttTlsPinLen; ++i) {
+    if (i > 0) buf[o++] = ':';
+    buf[o++] = kHex[pin[i] >> 4];
+    buf[o++] = kHex[pin[i] & 0x0F];
+  }
+  buf[o] = '\0';
+  return o;
+}
+
+uint32_t mqttTlsSessionKey(const char* host, uint16_t port, const uint8_t* pin) {
+  uint32_t h = kFnvOffset;
+  if (host != nullptr) h = fnv1a(h, reinterpret_cast<const uint8_t*>(host), strlen(host));
+  const uint8_t portBytes[3] = {':', static_cast<uint8_t>(port >> 8), static_cast<uint8_t>(port & 0xFF)};
+  h = fnv1a(h, portBytes, sizeof(portBytes));
+  // Marqueur distinct : « sans épinglage » ne doit pas coïncider avec une empreinte.
+  const uint8_t pinned = pin != nullptr ? 1 : 0;
+  h = fnv1a(h, &pinned, 1);
+  if (pin != nullptr) h = fnv1a(h, pin, kMqttTlsPinLen);
+  return h;
+}
+
+// -----------------------------------------------------------------------------
+// MqttTlsSessionPolicy
+// -----------------------------------------------------------------------------
+
+bool MqttTlsSessionPolicy::shouldResume(uint32_t key, uint32_t nowMs) const {
+  return _valid && key == _key && nowMs - _fullAtMs < _lifetimeMs;
+}
+
+void MqttTlsSessionPolicy::stored(uint32_t key, uint32_t nowMs, bool resumed) {
+  if (!(resumed && _valid && key == _key)) _fullAtMs = nowMs;
+  _key = key;
+  _valid = true;
+}
+
+void MqttTlsSessionPolicy::failed(bool resumeOffered) {
+  if (resumeOffered) _valid = false;
+}
+
+// -----------------------------------------------------------------------------
+// MqttTlsStats
+// -----------------------------------------------------------------------------
+
+void MqttTlsStats::record(const MqttTlsHandshakeSample& s) {
+  if (s.resumed) {
+    _resumed++;
+    _resumedMsSum += s.durationMs;
+  } else {
+    _full++;
+    _fullMsSum += s.durationMs;
+    if (s.resumeOffered) _resumeMiss++;
+  }
+  _lastMs = s.durationMs;
+  if (s.durationMs > _maxMs) _maxMs = s.durationMs;
+  _lastHeapPeak = s.heapPeakBytes;
+  if (s.heapPeakBytes > _maxHeapPeak) _maxHeapPeak = s.heapPeakBytes;
+  _lastHeapHeld = s.heapHeldBytes;
+}
@@ -0,0 +1,117 @@
+#ifndef MQTT_TLS_LOGIC_H
+#define MQTT_TLS_LOGIC_H
+
+// =============================================================================
+// mqtt_tls_logic — Politique TLS du client MQTT (épinglage, reprise), PURE
+// =============================================================================
+// Décisions de la coquille mqtt_tls_client (mbedTLS + socket lwip), isolées
+// pour être testées en natif :
+//
+//   - ÉPINGLAGE : empreinte SHA-256 du certificat feuille du broker (DER),
+//     saisie dans l'UI au format d'openssl
+//     (`openssl x509 -noout -fingerprint -sha256` → "AA:BB:…:FF") ; les
+//     séparateurs ':' '-' ' ' et un préfixe "…Fingerprint=" sont tolérés.
+//   - REPRISE DE SESSION : une seule session mémorisée en RAM (ticket RFC 5077
+//     ou identifiant de session), rattachée à une clé hôte:port + empreinte.
+//     Reprise proposée tant que la clé est inchangée et que la session a moins
+//     de kMqttTlsSessionLifetimeMs depuis son handshake COMPLET ; un échec de
+//     handshake avec reprise proposée jette la session (ticket refusé, clé
+//     serveur changée…) : la tentative suivante repart sur un handshake complet.
+//   - STATISTIQUES : handshakes complets / repris / ratés, durées, coût tas.
+//
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <stddef.h>
+#include <stdint.h>
+
+constexpr size_t kMqttTlsPinLen = 32;
+// "AA:BB:…:FF" (32 × 2 hex + 31 ':') + NUL.
+constexpr size_t kMqttTlsPinTextMax = 96;
+// Durée de vie locale d'une session : en deçà du lifetime hint usuel des
+// tickets (mosquitto/OpenSSL : 2 h). Au-delà, le broker l'aurait refusée.
+constexpr uint32_t kMqttTlsSessionLifetimeMs = 2UL * 3600UL * 1000UL;
+
+// Parse une empreinte SHA-256 texte vers 32 octets. Casse indifférente,
+// séparateurs ':' '-' ' ' ignorés, préfixe jusqu'au dernier '=' ignoré.
+// Refuse : nul/vide, autre caractère, nombre de chiffres != 64.
+bool mqttTlsParsePin(const char* text, uint8_t out[kMqttTlsPinLen]);
+
+// Formate 32 octets en "AA:BB:…:FF" (majuscules, comme openssl).
+// Retourne la longueur écrite ; 0 (buf vide) si cap < kMqttTlsPinTextMax.
+size_t mqttTlsFormatPin(const uint8_t pin[kMqttTlsPinLen], char* buf, size_t cap);
+
+// Clé de session (FNV-1a) : hôte, port et empreinte (nullptr = sans épinglage).
+// Changer l'un des trois interdit la reprise de l'ancienne session.
+uint32_t mqttTlsSessionKey(const char* host, uint16_t port, const uint8_t* pin);
+
+// Politique de reprise — la session mbedTLS elle-même vit dans la coquille.
+class MqttTlsSessionPolicy {
+public:
+  explicit MqttTlsSessionPolicy(uint32_t lifetimeMs = kMqttTlsSessionLifetimeMs)
+      : _lifetimeMs(lifetimeMs) {}
+
+  // Vrai si la session mémorisée peut être proposée au broker.
+  bool shouldResume(uint32_t key, uint32_t nowMs) const;
+
+  // Handshake réussi, session recopiée par la coquille. Une reprise sous la
+  // même clé ne prolonge pas la durée de vie (horloge du handshake complet).
+  void stored(uint32_t key, uint32_t nowMs, bool resumed);
+
+  // Handshake raté : la session proposée est suspecte, on la jette.
+  void failed(bool resumeOffered);
+
+  void invalidate() { _valid = false; }
+  bool valid() const { return _valid; }
+
+private:
+  uint32_t _lifetimeMs;
+  uint32_t _key = 0;
+  uint32_t _fullAtMs = 0;
+  bool _valid = false;
+};
+
+// Mesure d'un handshake réussi, relevée par la coquille.
+struct MqttTlsHandshakeSample {
+  uint32_t durationMs;     // socket connecté → handshake terminé (hors TCP)
+  bool resumeOffered;      // session proposée au broker
+  bool resumed;            // broker l'a acceptée (pas de certificat reçu)
+  uint32_t heapPeakBytes;  // tas libre avant − minimum observé pendant le handshake
+  uint32_t heapHeldBytes;  // tas libre avant − après : coût résident de la connexion
+};
+
+class MqttTlsStats {
+public:
+  void record(const MqttTlsHandshakeSample& s);
+  void recordFailure() { _failures++; }
+
+  uint32_t fullCount() const { return _full; }
+  uint32_t resumedCount() const { return _resumed; }
+  // Reprise proposée mais refusée par le broker (handshake complet à la place).
+  uint32_t resumeMissCount() const { return _resumeMiss; }
+  uint32_t failureCount() const { return _failures; }
+
+  uint32_t lastMs() const { return _lastMs; }
+  uint32_t maxMs() const { return _maxMs; }
+  uint32_t avgFullMs() const { return _full ? static_cast<uint32_t>(_fullMsSum / _full) : 0; }
+  uint32_t avgResumedMs() const { return _resumed ? static_cast<uint32_t>(_resumedMsSum / _resumed) : 0; }
+
+  uint32_t lastHeapPeak() const { return _lastHeapPeak; }
+  uint32_t maxHeapPeak() const { return _maxHeapPeak; }
+  uint32_t lastHeapHeld() const { return _lastHeapHeld; }
+
+private:
+  uint32_t _full = 0;
+  uint32_t _resumed = 0;
+  uint32_t _resumeMiss = 0;
+  uint32_t _failures = 0;
+  uint64_t _fullMsSum = 0;
+  uint64_t _resumedMsSum = 0;
+  uint32_t _lastMs = 0;
+  uint32_t _maxMs = 0;
+  uint32_t _lastHeapPeak = 0;
+  uint32_t _maxHeapPeak = 0;
+  uint32_t _lastHeapHeld = 0;
+};
+
+#endif // MQTT_TLS_LOGIC_H
@@ -0,0 +1,152 @@
+#include "mqtt_topics.h"
+
+#include <string.h>
+
+// =============================================================================
+// mqtt_topics — implémentation PURE
+// =============================================================================
+
+namespace {
+
+constexpr const char* kSuffixes[kMqttTopicCount] = {
+#define MQTT_TOPIC_SUFFIX(id, suffix, kind) suffix,
+  MQTT_TOPIC_LIST(MQTT_TOPIC_SUFFIX)
+#undef MQTT_TOPIC_SUFFIX
+};
+
+constexpr MqttTopicKind kKinds[kMqttTopicCount] = {
+#define MQTT_TOPIC_KIND(id, suffix, kind) MqttTopicKind::kind,
+  MQTT_TOPIC_LIST(MQTT_TOPIC_KIND)
+#undef MQTT_TOPIC_KIND
+};
+
+constexpr size_t cstrLen(const char* s) {
+  size_t n = 0;
+  while (s[n] != '\0') ++n;
+  return n;
+}
+
+// Index de dispatch des commandes : table ouverte (puissance de 2, taux de
+// remplissage < 1/3), clé = hash du suffixe, valeur = MqttTopicId. Construit à
+// la compilation ; la comparaison finale strcmp lève toute collision de hash.
+constexpr size_t kIndexSize = 64;
+constexpr uint8_t kIndexEmpty = 0xFF;
+
+struct CommandIndex {
+  uint8_t slots[kIndexSize];
+  size_t commandCount;
+  size_t maxProbe;  // Plus longue séquence de sondage (coût pire cas d'un lookup)
+};
+
+constexpr CommandIndex buildCommandIndex() {
+  CommandIndex idx{};
+  for (size_t i = 0; i < kIndexSize; ++i) idx.slots[i] = kIndexEmpty;
+  for (size_t id = 0; id < kMqttTopicCount; ++id) {
+    if (kKinds[id] != MqttTopicKind::Command) continue;
+    size_t pos = mqttTopicHash(kSuffixes[id], cstrLen(kSuffixes[id])) & (kIndexSize - 1);
+    size_t probe = 1;
+    while (idx.slots[pos] != kIndexEmpty) {
+      pos = (pos + 1) & (kIndexSize - 1);
+      ++probe;
+    }
+    idx.slots[pos] = static_cast<uint8_t>(id);
+    idx.commandCount++;
+    if (probe > idx.maxProbe) idx.maxProbe = probe;
+  }
+  return idx;
+}
+
+constexpr CommandIndex kCommandIndex = buildCommandIndex();
+
+static_assert(kMqttTopicCount < kIndexEmpty, "MqttTopicId doit tenir sous la sentinelle d'index");
+static_assert(kCommandIndex.commandCount * 3 < kIndexSize, "Index commandes trop rempli");
+static_assert(kCommandIndex.maxProbe <= 3, "Trop de collisions dans l'index commandes");
+static_assert(MqttTopicTable::kArenaSize <= 0xFFFF, "Offsets d'arène sur 16 bits");
+
+bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+}  // namespace
+
+const char* mqttTopicSuffix(MqttTopicId id) {
+  return kSuffixes[static_cast<size_t>(id)];
+}
+
+MqttTopicKind mqttTopicKind(MqttTopicId id) {
+  return kKinds[static_cast<size_t>(id)];
+}
+
+MqttTopicTable::MqttTopicTable() {
+  _layout(kMqttDefaultBase, cstrLen(kMqttDefaultBase));
+}
+
+size_t mqttTopicNormalizeBase(const char* base, const char** start) {
+  // Normalisation identique à l'ancien refreshTopics() : trim, '/' finaux retirés,
+  // vide → défaut.
+  const char* s = base ? base : "";
+  while (*s && isSpace(*s)) ++s;
+  size_t len = strlen(s);
+  while (len > 0 && isSpace(s[len - 1])) --len;
+  while (len > 0 && s[len - 1] == '/') --len;
+  if (len == 0) {
+    s = kMqttDefaultBase;
+    len = cstrLen(kMqttDefaultBase);
+  }
+  *start = s;
+  return len;
+}
+
+MqttTopicBuildResult MqttTopicTable::build(const char* base) {
+  const char* start = nullptr;
+  size_t len = mqttTopicNormalizeBase(base, &start);
+
+  MqttTopicBuildResult result = MqttTopicBuildResult::Rebuilt;
+  if (len > kMqttMaxBaseLen) {
+    // Même troncature que loadMqttConfig() : la base publiée reste celle que
+    // la configuration affiche, jamais kMqttDefaultBase.
+    len = kMqttMaxBaseLen;
+    result = MqttTopicBuildResult::TooLong;
+  }
+
+  if (len == _baseLen && memcmp(_arena, start, len) == 0) {
+    return result == MqttTopicBuildResult::TooLong ? result : MqttTopicBuildResult::Unchanged;
+  }
+  _layout(start, len);
+  return result;
+}
+
+void MqttTopicTable::_layout(const char* base, size_t len) {
+  // `base` peut pointer hors de l'arène uniquement (build() ne passe jamais
+  // _arena) : copie directe sans recouvrement.
+  memcpy(_arena, base, len);
+  _arena[len] = '\0';
+  _baseLen = len;
+
+  size_t pos = len + 1;
+  for (size_t id = 0; id < kMqttTopicCount; ++id) {
+    _offsets[id] = static_cast<uint16_t>(pos);
+    memcpy(_arena + pos, base, len);
+    pos += len;
+    _arena[pos++] = '/';
+    const size_t n = cstrLen(kSuffixes[id]);
+    memcpy(_arena + pos, kSuffixes[id], n + 1);
+    pos += n + 1;
+  }
+}
+
+MqttTopicId MqttTopicTable::matchCommand(const char* topic) const {
+  if (topic == nullptr) return MqttTopicId::Count;
+  if (strncmp(topic, _arena, _baseLen) != 0 || topic[_baseLen] != '/') {
+    return MqttTopicId::Count;
+  }
+  const char* suffix = topic + _baseLen + 1;
+  size_t pos = mqttTopicHash(suffix, strlen(suffix)) & (kIndexSize - 1);
+  for (size_t probe = 0; probe < kCommandIndex.maxProbe; ++probe) {
+    const uint8_t id = kCommandIndex.slots[pos];
+    if (id == kIndexEmpty) break;
+    if (strcmp(suffix, kSuffixes[id]) == 0) return static_cast<MqttTopicId>(id);
+    pos = (pos + 1) & (kIndexSize - 1);
+  }
+  return MqttTopicId::Count;
+}
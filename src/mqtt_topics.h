@@ -0,0 +1,197 @@
+#ifndef MQTT_TOPICS_H
+#define MQTT_TOPICS_H
+
+// =============================================================================
+// mqtt_topics — Table des topics MQTT applicatifs, PURE
+// =============================================================================
+// Les suffixes de topic sont déclarés UNE fois (MQTT_TOPIC_LIST, X-macro) et
+// donnent à la fois l'énumération MqttTopicId, la table constexpr des suffixes
+// et l'index de dispatch entrant des commandes (hash FNV-1a du suffixe, sondage
+// linéaire, calculé à la compilation).
+//
+// MqttTopicTable matérialise les topics complets "{base}/{suffixe}" dans une
+// arène de caractères dimensionnée à la compilation pour kMqttMaxBaseLen : aucun
+// String, aucune allocation heap, reconstruction uniquement si la base change.
+// La coquille mqtt_manager.cpp publie via get(id) et résout les commandes HA
+// reçues via matchCommand(topic) — O(1), sans allocation par message.
+//
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <stddef.h>
+#include <stdint.h>
+
+// X(Id, "suffixe", Kind) — Kind : State (publié par le firmware) ou Command
+// (souscrit, reçu depuis HA). L'ordre fixe la valeur de MqttTopicId.
+#define MQTT_TOPIC_LIST(X)                                                    \
+  X(TemperatureState,             "temperature",                   State)     \
+  X(TemperatureCircuitState,      "temperature_circuit",           State)     \
+  X(PhState,                      "ph",                            State)     \
+  X(OrpState,                     "orp",                           State)     \
+  X(FiltrationState,              "filtration_state",              State)     \
+  X(FiltrationModeState,          "filtration_mode",               State)     \
+  X(FiltrationModeCommand,        "filtration_mode/set",           Command)   \
+  X(FiltrationCommand,            "filtration/set",                Command)   \
+  X(FiltrationStartState,         "filtration_start",              State)     \
+  X(FiltrationEndState,           "filtration_end",                State)     \
+  X(FiltrationStartCommand,       "filtration_start/set",          Command)   \
+  X(FiltrationEndCommand,         "filtration_end/set",            Command)   \
+  X(LightingState,                "lighting_state",                State)     \
+  X(LightingCommand,              "lighting/set",                  Command)   \
+  X(LightingScheduleState,        "lighting_schedule",             State)     \
+  X(LightingScheduleCommand,      "lighting_schedule/set",         Command)   \
+  X(LightingStartState,           "lighting_start",                State)     \
+  X(LightingEndState,             "lighting_end",                  State)     \
+  X(LightingStartCommand,         "lighting_start/set",            Command)   \
+  X(LightingEndCommand,           "lighting_end/set",              Command)   \
+  X(PhDosageState,                "ph_dosage",                     State)     \
+  X(OrpDosageState,               "orp_dosage",                    State)     \
+  X(PhDosingState,                "ph_dosing",                     State)     \
+  X(OrpDosingState,               "orp_dosing",                    State)     \
+  X(PhLimitState,                 "ph_limit",                      State)     \
+  X(OrpLimitState,                "orp_limit",                     State)     \
+  X(PhStockLowState,              "ph_stock_low",                  State)     \
+  X(OrpStockLowState,             "orp_stock_low",                 State)     \
+  X(PhRemainingState,             "ph_remaining_ml",               State)     \
+  X(OrpRemainingState,            "orp_remaining_ml",              State)     \
+  X(PhTargetState,                "ph_target",                     State)     \
+  X(OrpTargetState,               "orp_target",                    State)     \
+  X(PhTargetCommand,              "ph_target/set",                 Command)   \
+  X(OrpTargetCommand,             "orp_target/set",                Command)   \
+  X(PhRegulationModeState,        "ph_regulation_mode",            State)     \
+  X(PhDailyTargetMlState,         "ph_daily_target_ml",            State)     \
+  X(OrpRegulationModeState,       "orp_regulation_mode",           State)     \
+  X(OrpDailyTargetMlState,        "orp_daily_target_ml",           State)     \
+  X(PhRegulationModeCommand,      "ph_regulation_mode/set",        Command)   \
+  X(OrpRegulationModeCommand,     "orp_regulation_mode/set",       Command)   \
+  X(Alerts,                       "alerts",                        State)     \
+  X(Logs,                         "logs",                          State)     \
+  X(Status,                       "status",                        State)     \
+  X(Diagnostic,                   "diagnostic",                    State)     \
+  X(AlertsCalibration,            "alerts/calibration_required",   State)     \
+  X(AlertsSensorStale,            "alerts/sensor_stale",           State)     \
+  X(AlertsSensorFrozen,           "alerts/sensor_frozen",          State)     \
+  X(History,                      "history",                       State)     \
+  X(StateDocument,                "state",                         State)     \
+  X(PhSensorProblemState,         "ph_sensor_problem",             State)     \
+  X(OrpSensorProblemState,        "orp_sensor_problem",            State)     \
+  X(PhCalPointsState,             "ph_cal_points",                 State)     \
+  X(OrpCalPointsState,            "orp_cal_points",                State)     \
+  X(PhSlopeAcidState,             "ph_slope_acid",                 State)     \
+  X(PhSlopeBaseState,             "ph_slope_base",                 State)     \
+  X(PhSlopeZeroState,             "ph_slope_zero",                 State)     \
+  X(PhRawState,                   "ph_raw",                        State)     \
+  X(PhMedianState,                "ph_median",                     State)     \
+  X(PhFilteredState,              "ph_filtered",                   State)     \
+  X(PhFilterReadyState,           "ph_filter_ready",               State)     \
+  X(PhFilterUnstableState,        "ph_filter_unstable",            State)     \
+  X(PhRejectedCountState,         "ph_rejected_count",             State)     \
+  X(OrpRawState,                  "orp_raw",                       State)     \
+  X(OrpMedianState,               "orp_median",                    State)     \
+  X(OrpFilteredState,             "orp_filtered",                  State)     \
+  X(OrpFilterReadyState,          "orp_filter_ready",              State)     \
+  X(OrpFilterUnstableState,       "orp_filter_unstable",           State)     \
+  X(OrpRejectedCountState,        "orp_rejected_count",            State)     \
+  X(PhMixingDelayActiveState,     "ph_mixing_delay_active",        State)     \
+  X(OrpMixingDelayActiveState,    "orp_mixing_delay_active",       State)     \
+  X(PhDailyMlState,               "ph_daily_ml",                   State)     \
+  X(OrpDailyMlState,              "orp_daily_ml",                  State)     \
+  X(PhDailyTargetMlCommand,       "ph_daily_target_ml/set",        Command)   \
+  X(OrpDailyTargetMlCommand,      "orp_daily_target_ml/set",       Command)   \
+  X(RebootCommand,                "reboot/set",                    Command)   \
+  X(BoostState,                   "boost",                         State)     \
+  X(BoostCommand,                 "boost/set",                     Command)   \
+  X(InstallModeState,             "install_mode",                  State)     \
+  X(InstallModeCommand,           "install_mode/set",              Command)   \
+  X(FiltrationExternalStateCommand, "filtration_external_state/set", Command) \
+  X(SensorHealth,                 "sensor_health",                 State)
+
+enum class MqttTopicId : uint8_t {
+#define MQTT_TOPIC_ENUM(id, suffix, kind) id,
+  MQTT_TOPIC_LIST(MQTT_TOPIC_ENUM)
+#undef MQTT_TOPIC_ENUM
+  Count
+};
+
+enum class MqttTopicKind : uint8_t { State, Command };
+
+constexpr size_t kMqttTopicCount = static_cast<size_t>(MqttTopicId::Count);
+
+// Base par défaut (config vide) et longueur maximale acceptée. Borne imposée à
+// la configuration : /save-config refuse au-delà (400), une base plus longue
+// héritée de la NVS est tronquée au chargement (log warning). L'arène est
+// dimensionnée pour elle : aucun repli sur une autre base à l'exécution.
+constexpr const char* kMqttDefaultBase = "pool/sensors";
+constexpr size_t kMqttMaxBaseLen = 64;
+
+// Normalisation de la base (espaces de bord et '/' finaux retirés, vide →
+// kMqttDefaultBase) : début dans *start, longueur retournée, NON bornée à
+// kMqttMaxBaseLen — partagée par build(), la validation et le chargement config.
+size_t mqttTopicNormalizeBase(const char* base, const char** start);
+
+// Suffixe / nature d'un topic (tables constexpr, indexées par MqttTopicId).
+const char* mqttTopicSuffix(MqttTopicId id);
+MqttTopicKind mqttTopicKind(MqttTopicId id);
+
+// FNV-1a 32 bits sur `len` octets — sert à l'index de dispatch des commandes.
+constexpr uint32_t mqttTopicHash(const char* s, size_t len) {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < len; ++i) {
+    h ^= static_cast<uint8_t>(s[i]);
+    h *= 16777619u;
+  }
+  return h;
+}
+
+enum class MqttTopicBuildResult : uint8_t {
+  Unchanged,  // Base identique à la précédente : arène conservée
+  Rebuilt,    // Arène reconstruite pour la nouvelle base
+  TooLong,    // Base > kMqttMaxBaseLen : arène construite sur ses kMqttMaxBaseLen
+              // premiers caractères (troncature du chargement config)
+};
+
+class MqttTopicTable {
+public:
+  MqttTopicTable();
+
+  // Normalise `base` (espaces de bord et '/' finaux retirés, vide → défaut) puis
+  // reconstruit l'arène si la base normalisée diffère de la base courante.
+  MqttTopicBuildResult build(const char* base);
+
+  const char* base() const { return _arena; }
+  size_t baseLength() const { return _baseLen; }
+
+  // Topic complet "{base}/{suffixe}" — pointeur stable jusqu'au prochain Rebuilt.
+  const char* get(MqttTopicId id) const {
+    return _arena + _offsets[static_cast<size_t>(id)];
+  }
+
+  // Résout un topic reçu en commande : "{base}/{suffixe Command}" → id, sinon
+  // MqttTopicId::Count (base différente, topic d'état, suffixe inconnu).
+  MqttTopicId matchCommand(const char* topic) const;
+
+  // Taille de l'arène : base + NUL, puis pour chaque topic base + '/' + suffixe + NUL.
+  static constexpr size_t kArenaSize = []() constexpr {
+    size_t total = kMqttMaxBaseLen + 1;
+    const char* suffixes[] = {
+#define MQTT_TOPIC_SUFFIX(id, suffix, kind) suffix,
+      MQTT_TOPIC_LIST(MQTT_TOPIC_SUFFIX)
+#undef MQTT_TOPIC_SUFFIX
+    };
+    for (const char* s : suffixes) {
+      size_t n = 0;
+      while (s[n] != '\0') ++n;
+      total += kMqttMaxBaseLen + 1 + n + 1;
+    }
+    return total;
+  }();
+
+private:
+  char _arena[kArenaSize];
+  uint16_t _offsets[kMqttTopicCount];
+  size_t _baseLen = 0;
+
+  void _layout(const char* base, size_t len);
+};
+
+#endif // MQTT_TOPICS_H
@@ -904,8 +904,12 @@ void PumpControllerClass::update() {
       // Déjà en cours : vérifier si on continue
       shouldDose = shouldContinueDosing(error, pumpProtection.phStopThreshold, phDosingState, now);
     } else {
-      // Arrêté : vérifier si on démarre
-      shouldDose = shouldStartDosing(error, pumpProtection.phStartThreshold, phDosingState, now);
+      // Arrêté : vérifier si on démarre. Étage Kalman : erreur projetée par la
+      // tendance (un pH qui revient déjà vers la cible ne relance pas de dose).
+      float errorTrend = sensors.getPhTrendPerMin();
+      if (mqttCfg.phCorrectionType == "ph_plus") errorTrend = -errorTrend;
+      const float startError = projectErrorWithTrend(error, errorTrend, kPhTrendHorizonMin);
+      shouldDose = shouldStartDosing(startError, pumpProtection.phStartThreshold, phDosingState, now);
 
       if (shouldDose) {
         // Démarrage d'un nouveau cycle
@@ -1177,8 +1181,10 @@ void PumpControllerClass::update() {
       // Déjà en cours : vérifier si on continue
       shouldDose = shouldContinueDosing(error, pumpProtection.orpStopThreshold, orpDosingState, now);
     } else {
-      // Arrêté : vérifier si on démarre
-      shouldDose = shouldStartDosing(error, pumpProtection.orpStartThreshold, orpDosingState, now);
+      // Arrêté : vérifier si on démarre (erreur projetée, cf. branche pH).
+      const float startError = projectErrorWithTrend(error, -sensors.getOrpTrendPerMin(),
+                                                     kOrpTrendHorizonMin);
+      shouldDose = shouldStartDosing(startError, pumpProtection.orpStartThreshold, orpDosingState, now);
 
       if (shouldDose) {
         // Démarrage d'un nouveau cycle
@@ -1448,6 +1454,7 @@ void PumpControllerClass::update() {
   bool orpManualActive = manualMode[orpIdx] && pumpDuty[orpIdx] > 0;
 
   if (phActive || phManualActive) {
+    sensors.notePhDosing((uint32_t)now);
     if (phDosingState.lastSafetyTimestamp == 0) {
       phDosingState.lastSafetyTimestamp = now;
     }
@@ -1462,6 +1469,7 @@ void PumpControllerClass::update() {
   }
 
   if (orpActive || orpManualActive) {
+    sensors.noteOrpDosing((uint32_t)now);
     if (orpDosingState.lastSafetyTimestamp == 0) {
       orpDosingState.lastSafetyTimestamp = now;
     }
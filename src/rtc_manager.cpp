@@ -1,8 +1,7 @@
 #include "rtc_manager.h"
-#include "config.h"
 #include "constants.h"
+#include "i2c_bus.h"
 #include "logger.h"
-#include <Wire.h>
 #include <time.h>
 #include <sys/time.h>
 
@@ -18,34 +17,58 @@ static String formatDateTime(const DateTime& dt) {
   return String(buf);
 }
 
+// Transaction synchrone sur le DS3231 : une seule étape, quelques trames.
+// Lecture OnDemand ; réglage de l'heure (NTP, utilisateur) Urgent.
+bool RtcManager::_transact(I2cPriority prio, uint32_t (*step)(I2cTxn&), void* ctx) {
+  I2cTxn txn;
+  txn.devices = i2cDeviceBit(I2cDevice::Rtc);
+  txn.priority = prio;
+  txn.timeoutMs = kI2cTxnTimeoutMs;
+  txn.step = step;
+  txn.ctx = ctx;
+  return i2cBus.run(txn);
+}
+
 bool RtcManager::begin() {
-  // Prendre le mutex I2C
-  if (xSemaphoreTake(i2cMutex, pdMS_TO_TICKS(kI2cMutexTimeoutMs)) != pdTRUE) {
-    systemLogger.warning("RTC: Impossible d'acquérir le mutex I2C");
+  struct Probe {
+    RTC_DS3231* rtc;
+    bool found;
+    bool lostPower;
+    DateTime now;
+  } probe{&rtc, false, false, DateTime()};
+
+  const bool done = _transact(I2cPriority::OnDemand, [](I2cTxn& t) -> uint32_t {
+    Probe* p = static_cast<Probe*>(t.ctx);
+    p->found = p->rtc->begin();
+    if (p->found) {
+      // Batterie vide ou première utilisation : démarrer l'horloge avec une
+      // date par défaut.
+      p->lostPower = p->rtc->lostPower();
+      if (p->lostPower) p->rtc->adjust(DateTime(2021, 1, 1, 0, 0, 0));
+      p->now = p->rtc->now();
+    }
+    t.ok = true;
+    return 0;
+  }, &probe);
+
+  if (!done) {
+    systemLogger.warning("RTC: bus I2C indisponible");
     return false;
   }
 
-  rtcAvailable = rtc.begin();
-
-  xSemaphoreGive(i2cMutex);
-
+  rtcAvailable = probe.found;
   if (!rtcAvailable) {
     systemLogger.warning("RTC DS3231 non détecté sur le bus I2C (adresse 0x68)");
     return false;
   }
 
   // Vérifier si le RTC a perdu l'alimentation (batterie vide ou première utilisation)
-  if (rtc.lostPower()) {
-    rtcLostPower = true;
+  rtcLostPower = probe.lostPower;
+  if (rtcLostPower) {
     systemLogger.warning("RTC: L'horloge était arrêtée (batterie vide ou première utilisation)");
-    // Démarrer l'horloge avec une date par défaut
-    rtc.adjust(DateTime(2021, 1, 1, 0, 0, 0));
-  } else {
-    rtcLostPower = false;
   }
 
-  DateTime now = rtc.now();
-  systemLogger.info("RTC DS3231 initialisé - Heure: " + formatDateTime(now));
+  systemLogger.info("RTC DS3231 initialisé - Heure: " + formatDateTime(probe.now));
 
   return true;
 }
@@ -55,16 +78,21 @@ DateTime RtcManager::now() {
     return DateTime();  // DateTime invalide
   }
 
-  // Prendre le mutex I2C
-  if (xSemaphoreTake(i2cMutex, pdMS_TO_TICKS(kI2cMutexTimeoutMs)) != pdTRUE) {
+  struct Read {
+    RTC_DS3231* rtc;
+    DateTime dt;
+  } read{&rtc, DateTime()};
+
+  if (!_transact(I2cPriority::OnDemand, [](I2cTxn& t) -> uint32_t {
+        Read* r = static_cast<Read*>(t.ctx);
+        r->dt = r->rtc->now();
+        t.ok = true;
+        return 0;
+      }, &read)) {
     return DateTime();
   }
 
-  DateTime dt = rtc.now();
-
-  xSemaphoreGive(i2cMutex);
-
-  return dt;
+  return read.dt;
 }
 
 bool RtcManager::isTimeValid() {
@@ -95,17 +123,23 @@ bool RtcManager::syncFromSystem() {
 bool RtcManager::setTime(const DateTime& dt) {
   if (!rtcAvailable) return false;
 
-  // Prendre le mutex I2C
-  if (xSemaphoreTake(i2cMutex, pdMS_TO_TICKS(kI2cMutexTimeoutMs)) != pdTRUE) {
-    systemLogger.warning("RTC: Impossible d'acquérir le mutex I2C pour setTime");
+  struct Write {
+    RTC_DS3231* rtc;
+    DateTime dt;
+  } write{&rtc, dt};
+
+  if (!_transact(I2cPriority::Urgent, [](I2cTxn& t) -> uint32_t {
+        Write* w = static_cast<Write*>(t.ctx);
+        w->rtc->adjust(w->dt);
+        t.ok = true;
+        return 0;
+      }, &write)) {
+    systemLogger.warning("RTC: bus I2C indisponible pour setTime");
     return false;
   }
 
-  rtc.adjust(dt);
   rtcLostPower = false;  // L'heure est maintenant valide
 
-  xSemaphoreGive(i2cMutex);
-
   systemLogger.info("RTC mis à jour: " + formatDateTime(dt));
 
   return true;
@@ -3,6 +3,9 @@
 
 #include <Arduino.h>
 #include <RTClib.h>
+#include "i2c_sched_logic.h"
+
+struct I2cTxn;
 
 /**
  * Gestionnaire du module RTC DS3231
@@ -14,6 +17,9 @@
  *
  * Le RTC est mis à jour automatiquement quand NTP se synchronise
  * ou quand l'utilisateur règle l'heure manuellement.
+ *
+ * Accès I2C : transactions synchrones via i2cBus (ADR-0028), appelables
+ * depuis n'importe quelle tâche sauf i2cTask.
  */
 class RtcManager {
 private:
@@ -23,10 +29,12 @@ private:
 
   static constexpr uint32_t MIN_VALID_YEAR = 2021;
 
+  bool _transact(I2cPriority prio, uint32_t (*step)(I2cTxn&), void* ctx);
+
 public:
   /**
    * Initialise le RTC sur le bus I2C
-   * Doit être appelé après Wire.begin()
+   * Doit être appelé après i2cBus.begin()
    * @return true si le RTC est détecté et fonctionnel
    */
   bool begin();
@@ -55,7 +63,6 @@ public:
 
   /**
    * Met à jour le RTC avec l'heure système actuelle (après sync NTP)
-   * Utilise le mutex I2C pour éviter les conflits
    * @return true si mise à jour réussie
    */
   bool syncFromSystem();
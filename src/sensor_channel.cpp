@@ -0,0 +1,74 @@
+#include "sensor_channel.h"
+
+#include "constants.h"
+
+// =============================================================================
+// sensor_channel — implémentation PURE
+// =============================================================================
+
+SensorChannel::SensorChannel(const SensorChannelInfo& info, SensorDriver& driver,
+                             SensorFilterCore& filter)
+    : _info(info),
+      _driver(driver),
+      _filter(filter),
+      _health(SensorHealthConfig{kSensorHealthWindowSamples, info.noiseLimit,
+                                 kSensorHealthSpikeRateLimit, kSensorHealthFailRateLimit,
+                                 kSensorHealthLatencyLimitMs, kSensorFilterMaxAgeMs}),
+      _stability(kEzoCalStableSamples, info.stableBand) {}
+
+SensorChannelUpdate SensorChannel::apply(bool ok, float value, uint32_t nowMs) {
+  SensorChannelUpdate up;
+  _lastAccepted = false;
+  if (ok) {
+    _last = value;
+    _lastMs = nowMs;
+    _failStreak = 0;
+    // En fail-streak (ci-dessous) le filtre n'est PAS alimenté : il devient
+    // non prêt par âge (kSensorFilterMaxAgeMs) et canDose() bloque.
+    _lastAccepted = _filter.addSample(value, nowMs);
+    _stability.add(value);
+    _staleLogged = false;
+    _degradedLogged = false;
+    return up;
+  }
+
+  _failStreak++;
+  _stability.interrupt();
+  up.failThreshold = (_failStreak == kEzoBusFailMaxConsecutive);
+  if (_failStreak >= kEzoBusFailMaxConsecutive) {
+    // Bus dégradé : sans invalidation, valueAt() rendrait une valeur
+    // « fraîche » pendant la fenêtre stale (20 s), et les points de
+    // calibration pourraient dater d'avant un Cal,clear fait pendant la coupure.
+    _last = NAN;
+    _calPoints = -1;
+    if (!_degradedLogged) {
+      _degradedLogged = true;
+      up.degraded = true;
+    }
+  }
+  return up;
+}
+
+bool SensorChannel::staleEdge(uint32_t nowMs) {
+  if (isnan(_last) || _staleLogged || nowMs - _lastMs <= kSensorStaleTimeoutMs) return false;
+  _staleLogged = true;
+  return true;
+}
+
+SensorChannelEdge SensorChannel::frozenEdge() {
+  const bool frozen = _filter.frozen();
+  if (frozen == _frozenLogged) return SensorChannelEdge::None;
+  _frozenLogged = frozen;
+  return frozen ? SensorChannelEdge::Raised : SensorChannelEdge::Cleared;
+}
+
+float SensorChannel::valueAt(uint32_t nowMs) const {
+  if (isnan(_last)) return NAN;
+  if (nowMs - _lastMs > kSensorStaleTimeoutMs) return NAN;
+  return _last;
+}
+
+uint32_t SensorChannel::ageMs(uint32_t nowMs) const {
+  if (_lastMs == 0) return UINT32_MAX;
+  return nowMs - _lastMs;
+}
@@ -0,0 +1,171 @@
+#ifndef SENSOR_CHANNEL_H
+#define SENSOR_CHANNEL_H
+
+// =============================================================================
+// sensor_channel — Voie de mesure analogique générique, PURE
+// =============================================================================
+// Une voie = pilote (SensorDriver) + filtre (SensorFilterCore, détecteur figé
+// compris) + santé (SensorHealth) + stabilité avant calibration (EzoStability)
+// + métadonnées (SensorChannelInfo) + état courant (dernière lecture valide,
+// fail-streak, points de calibration, fronts de log).
+//
+// SensorChannelTable<N> : table à capacité fixée à la compilation, sans
+// allocation. Elle référence des voies dont le stockage (pilote, filtre à
+// fenêtre templatée, voie) est membre de la coquille. Le cycle d'acquisition,
+// les sorties WS / santé et les logs parcourent la table : ajouter une voie
+// de même protocole (EZO conductivité, 2ᵉ bassin…) = déclarer ces trois
+// membres et l'ajouter à la table, sans copier de code.
+//
+// Pilote : lecture en deux temps, appelée depuis une étape de transaction du
+// bus (i2cTask) — émission, puis relève une fois la conversion écoulée. Les
+// voies d'une même table partagent la cadence et le délai de conversion du
+// cycle qui les sert (cycle EZO : R + 900 ms).
+//
+// Contrat fail-closed (pool-chemistry #5) porté ici pour toutes les voies :
+// kEzoBusFailMaxConsecutive échecs consécutifs → lecture invalidée (NaN) et
+// points de calibration à -1 jusqu'au retour du bus.
+//
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ezo_cal_logic.h"
+#include "i2c_sched_logic.h"
+#include "sensor_filter.h"
+#include "sensor_health_logic.h"
+
+class SensorDriver {
+public:
+  // --- Étapes (i2cTask, aucune attente interne) ---
+  virtual bool startRead() = 0;                  // Émission de la lecture
+  virtual bool collectReading(float& out) = 0;   // Relève après conversion
+  virtual bool startCalPointsQuery() = 0;        // Émission de Cal,?
+  virtual int collectCalPoints() = 0;            // Relève, -1 si erreur
+  // --- Transactions synchrones (loopTask, boot) ---
+  virtual bool identify(char* buf, size_t len) = 0;  // Présence + version
+  virtual int queryCalPoints() = 0;                  // -1 si injoignable
+  // --- Identité ---
+  virtual I2cDevice device() const = 0;
+  virtual const char* name() const = 0;          // Préfixe des logs ("EZO pH")
+
+protected:
+  ~SensorDriver() = default;  // Jamais détruit via l'interface
+};
+
+struct SensorChannelInfo {
+  const char* key;     // Clé stable : objet santé, préfixe des champs WS (phRaw…)
+  const char* label;   // Libellé des logs ("pH")
+  const char* unit;    // Unité des logs, "" si sans unité
+  uint8_t decimals;    // Arrondi de publication (fixed_format)
+  float noiseLimit;    // σ de bruit → pénalité de santé pleine
+  float stableBand;    // Bande de stabilité avant calibration
+  bool gatesDosing;    // La voie conditionne un dosage (libellé des logs)
+};
+
+// Bilan d'une lecture appliquée, pour les logs de la coquille.
+struct SensorChannelUpdate {
+  bool failThreshold = false;  // Le fail-streak vient d'atteindre le seuil
+  bool degraded = false;       // 1ʳᵉ invalidation de la série (bus dégradé)
+};
+
+enum class SensorChannelEdge : uint8_t { None, Raised, Cleared };
+
+class SensorChannel {
+public:
+  SensorChannel(const SensorChannelInfo& info, SensorDriver& driver, SensorFilterCore& filter);
+
+  // Cycle en cours : écrit par i2cTask pendant la transaction, relu par
+  // loopTask au bilan.
+  struct Cycle {
+    bool issued = false;  // Lecture émise
+    bool ok = false;      // Relève valide
+    float value = 0.0f;
+  } cycle;
+
+  // Bilan d'une lecture (loopTask) : cache, filtre, stabilité, fail-streak,
+  // invalidation en bus dégradé. La santé est alimentée à part (latence).
+  SensorChannelUpdate apply(bool ok, float value, uint32_t nowMs);
+
+  // Front montant unique quand la dernière lecture valide dépasse
+  // kSensorStaleTimeoutMs ; réarmé par la lecture valide suivante.
+  bool staleEdge(uint32_t nowMs);
+  // Fronts du détecteur figé du filtre (montée, levée).
+  SensorChannelEdge frozenEdge();
+
+  // Dernière lecture valide, NaN au-delà de kSensorStaleTimeoutMs ou en bus dégradé.
+  float valueAt(uint32_t nowMs) const;
+  float last() const { return _last; }
+  uint32_t ageMs(uint32_t nowMs) const;  // UINT32_MAX si aucune lecture valide
+  int failStreak() const { return _failStreak; }
+  bool lastAccepted() const { return _lastAccepted; }  // Verdict filtre du dernier bilan
+
+  // Points de calibration (cache, -1 = inconnu / bus dégradé).
+  int calPoints() const { return _calPoints; }
+  void setCalPoints(int points) { _calPoints = points; }
+
+  const SensorChannelInfo& info() const { return _info; }
+  SensorDriver& driver() const { return _driver; }
+  SensorFilterCore& filter() { return _filter; }
+  const SensorFilterCore& filter() const { return _filter; }
+  SensorHealth& health() { return _health; }
+  const SensorHealth& health() const { return _health; }
+  EzoStability& stability() { return _stability; }
+  const EzoStability& stability() const { return _stability; }
+
+private:
+  SensorChannelInfo _info;
+  SensorDriver& _driver;
+  SensorFilterCore& _filter;
+  SensorHealth _health;
+  EzoStability _stability;
+
+  float _last = NAN;  // Aucune lecture valide
+  uint32_t _lastMs = 0;
+  int _failStreak = 0;
+  bool _lastAccepted = false;
+  int _calPoints = -1;
+  bool _staleLogged = false;
+  bool _degradedLogged = false;
+  bool _frozenLogged = false;
+};
+
+template <size_t N>
+class SensorChannelTable {
+public:
+  // false si la table est pleine ou la clé déjà prise.
+  bool add(SensorChannel& ch) {
+    if (_n >= N || find(ch.info().key) != nullptr) return false;
+    _ch[_n++] = &ch;
+    return true;
+  }
+
+  size_t size() const { return _n; }
+  static constexpr size_t capacity() { return N; }
+  SensorChannel& operator[](size_t i) { return *_ch[i]; }
+  const SensorChannel& operator[](size_t i) const { return *_ch[i]; }
+
+  SensorChannel* find(const char* key) const {
+    if (key == nullptr) return nullptr;
+    for (size_t i = 0; i < _n; ++i) {
+      if (strcmp(_ch[i]->info().key, key) == 0) return _ch[i];
+    }
+    return nullptr;
+  }
+
+  // Masque i2cDeviceBit() de tous les pilotes (réservation du cycle).
+  uint8_t devices() const {
+    uint8_t mask = 0;
+    for (size_t i = 0; i < _n; ++i) mask |= i2cDeviceBit(_ch[i]->driver().device());
+    return mask;
+  }
+
+private:
+  SensorChannel* _ch[N] = {};
+  size_t _n = 0;
+};
+
+#endif // SENSOR_CHANNEL_H
@@ -0,0 +1,74 @@
+#include "sensor_estimator.h"
+
+#include <math.h>
+
+void KalmanTrend::reset() {
+  _primed = false;
+  _lastMs = 0;
+  _x = 0.0f;
+  _v = 0.0f;
+  _p00 = _p01 = _p11 = 0.0f;
+  _doseActive = false;
+  _doseUntilMs = 0;
+}
+
+void KalmanTrend::noteDose(uint32_t nowMs) {
+  _doseActive = true;
+  _doseUntilMs = nowMs + _cfg.doseBoostMs;
+}
+
+bool KalmanTrend::boosted(uint32_t nowMs) const {
+  // Comparaison signée : robuste au wrap de millis().
+  return _doseActive && (int32_t)(_doseUntilMs - nowMs) > 0;
+}
+
+float KalmanTrend::level() const { return _primed ? _x : NAN; }
+
+float KalmanTrend::trendPerMin() const { return _primed ? _v * 60.0f : NAN; }
+
+float KalmanTrend::update(float z, uint32_t nowMs) {
+  const float r = _cfg.measStd * _cfg.measStd;
+  if (!_primed) {
+    _x = z;
+    _v = 0.0f;
+    // Pente inconnue : incertitude large (σ = σv par seconde), résorbée en
+    // quelques mesures.
+    _p00 = r;
+    _p01 = 0.0f;
+    _p11 = r;
+    _lastMs = nowMs;
+    _primed = true;
+    return _x;
+  }
+
+  // --- Prédiction (vitesse constante, accélération = bruit blanc discret) ---
+  const float dt = (nowMs - _lastMs) / 1000.0f;
+  _lastMs = nowMs;
+  if (dt > 0.0f) {
+    float sa = _cfg.accelStd;
+    if (boosted(nowMs) && _cfg.doseGain > 1.0f) sa *= _cfg.doseGain;
+    if (!boosted(nowMs)) _doseActive = false;
+    const float q = sa * sa;
+    const float dt2 = dt * dt;
+    _x += _v * dt;
+    _p00 += dt * (2.0f * _p01 + dt * _p11) + q * dt2 * dt2 * 0.25f;
+    _p01 += dt * _p11 + q * dt2 * dt * 0.5f;
+    _p11 += q * dt2;
+  }
+
+  // --- Correction ---
+  const float s = _p00 + r;
+  const float k0 = _p00 / s;
+  const float k1 = _p01 / s;
+  const float y = z - _x;
+  _x += k0 * y;
+  _v += k1 * y;
+  const float p01 = _p01;
+  _p00 -= k0 * _p00;
+  _p01 -= k0 * p01;
+  _p11 -= k1 * p01;
+  // Garde numérique float : une variance ne peut être négative.
+  if (_p11 < 0.0f) _p11 = 0.0f;
+  if (_p00 < 0.0f) _p00 = 0.0f;
+  return _x;
+}
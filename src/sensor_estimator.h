@@ -0,0 +1,77 @@
+#ifndef SENSOR_ESTIMATOR_H
+#define SENSOR_ESTIMATOR_H
+
+// =============================================================================
+// sensor_estimator — Estimateur niveau + tendance (Kalman 1-D), PURE
+// =============================================================================
+// Étage optionnel de SensorFilter, à la place de l'EMA : filtre de Kalman à
+// deux états (niveau, pente) sur la médiane, modèle à vitesse constante et
+// accélération aléatoire (bruit de processus σa), mesure bruitée (σv).
+//
+// En régime établi c'est un filtre alpha-bêta dont les gains sont fixés par
+// l'indice de poursuite λ = σa·T²/σv (T = période d'échantillonnage). Réglé à
+// λ ≈ 0,003, son bruit de sortie égale celui de l'EMA α = 0,1 mais il suit une
+// rampe SANS retard permanent (l'EMA traîne de (1-α)/α·T ≈ 45 s sur une
+// rampe) : après une dose, le niveau suit la descente du pH au lieu de
+// continuer à glisser pendant des minutes.
+//
+// Couplage au dosage : noteDose() multiplie σa par doseGain pendant
+// doseBoostMs (la pause mélange) — un mouvement est ATTENDU, l'estimateur le
+// suit plus vite. Le bruit de sortie plus élevé pendant cette fenêtre ne
+// déclenche rien : le dosage y est bloqué par la garde MixingActive.
+//
+// trendPerMin() : pente estimée (unités/min), NaN tant que non amorcé.
+//
+// Arithmétique float (FPU ESP32), O(1), aucune allocation.
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <stdint.h>
+
+enum class SensorEstimator : uint8_t {
+  Ema = 0,     // Historique (feature-025) — valeur par défaut d'une config courte
+  Kalman = 1,  // Niveau + tendance (ce module)
+};
+
+// Champs en fin de SensorFilterConfig : une init agrégat plus courte les met
+// à zéro → Ema, comportement historique inchangé.
+struct SensorEstimatorConfig {
+  SensorEstimator mode;
+  float accelStd;         // σa : accélération aléatoire du vrai niveau (unités/s²)
+  float measStd;          // σv : bruit de la médiane (unités)
+  float doseGain;         // Facteur sur σa après une dose (<= 1 : sans effet)
+  uint32_t doseBoostMs;   // Durée de l'effet d'une dose (pause mélange)
+};
+
+class KalmanTrend {
+public:
+  explicit KalmanTrend(const SensorEstimatorConfig& cfg) : _cfg(cfg) {}
+
+  void reset();
+
+  // Intègre une mesure (médiane) à nowMs et retourne le niveau estimé. La
+  // première mesure amorce (niveau = z, pente nulle, incertitude large).
+  float update(float z, uint32_t nowMs);
+
+  // Dose en cours à nowMs : bruit de processus relevé jusqu'à nowMs + doseBoostMs.
+  void noteDose(uint32_t nowMs);
+
+  bool primed() const { return _primed; }
+  float level() const;
+  float trendPerMin() const;
+  bool boosted(uint32_t nowMs) const;
+
+private:
+  SensorEstimatorConfig _cfg;
+  bool _primed = false;
+  uint32_t _lastMs = 0;
+  float _x = 0.0f;     // Niveau
+  float _v = 0.0f;     // Pente (unités/s)
+  float _p00 = 0.0f;   // Covariance (symétrique)
+  float _p01 = 0.0f;
+  float _p11 = 0.0f;
+  bool _doseActive = false;
+  uint32_t _doseUntilMs = 0;
+};
+
+#endif // SENSOR_ESTIMATOR_H
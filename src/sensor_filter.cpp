@@ -35,26 +35,85 @@ void FrozenDetector::addSample(float x) {
   }
 }
 
+// =============================================================================
+// SlidingMedian — implémentation
+// =============================================================================
+
+void SlidingMedian::setWindow(uint8_t window) {
+  if (window == 0) window = 1;
+  if (window > _capacity) window = _capacity;
+  _window = window;
+  clear();
+}
+
+uint8_t SlidingMedian::_lowerBound(float x) const {
+  uint8_t lo = 0;
+  uint8_t hi = _count;
+  while (lo < hi) {
+    const uint8_t mid = static_cast<uint8_t>((lo + hi) / 2);
+    if (_sorted[mid] < x) {
+      lo = static_cast<uint8_t>(mid + 1);
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+void SlidingMedian::push(float x) {
+  if (_count == _window) {
+    // Fenêtre pleine : le slot d'écriture contient le plus ancien, présent
+    // dans _sorted → retrait à sa position (premier élément égal).
+    uint8_t pos = _lowerBound(_ring[_idx]);
+    for (; pos + 1 < _count; ++pos) _sorted[pos] = _sorted[pos + 1];
+    --_count;
+  }
+
+  uint8_t pos = _count;
+  const uint8_t at = _lowerBound(x);
+  for (; pos > at; --pos) _sorted[pos] = _sorted[pos - 1];
+  _sorted[at] = x;
+  ++_count;
+
+  _ring[_idx] = x;
+  _idx = static_cast<uint8_t>((_idx + 1) % _window);
+}
+
+float SlidingMedian::median() const {
+  if (_count == 0) return NAN;
+  if (_count & 1) {
+    return _sorted[_count / 2];
+  }
+  return 0.5f * (_sorted[_count / 2 - 1] + _sorted[_count / 2]);
+}
+
 // =============================================================================
 // SensorFilter — implémentation (feature-025)
 // =============================================================================
 
-SensorFilter::SensorFilter(const Config& config)
-    : _cfg(config), _frozenDetector(config.frozenSamples, config.frozenEpsilon) {
+SensorFilterCore::SensorFilterCore(const Config& config, uint8_t capacity,
+                                   float* ring, float* sorted,
+                                   float* rejRing, float* rejSorted)
+    : _cfg(config),
+      _window(ring, sorted, capacity),
+      _kalman(config.estimator),
+      _rejWindow(rejRing, rejSorted, capacity),
+      _frozenDetector(config.frozenSamples, config.frozenEpsilon) {
   // Borne la fenêtre médiane à la capacité physique du buffer (sécurité).
   if (_cfg.medianWindow == 0) _cfg.medianWindow = 1;
-  if (_cfg.medianWindow > kSensorFilterMedianWindow) {
-    _cfg.medianWindow = kSensorFilterMedianWindow;
+  if (_cfg.medianWindow > capacity) {
+    _cfg.medianWindow = capacity;
   }
+  _window.setWindow(_cfg.medianWindow);
+  _rejWindow.setWindow(_cfg.medianWindow);
   reset();
 }
 
-void SensorFilter::reset() {
-  for (uint8_t i = 0; i < kSensorFilterMedianWindow; ++i) _buffer[i] = NAN;
-  _bufIdx = 0;
-  _bufCount = 0;
+void SensorFilterCore::reset() {
+  _window.clear();
   _raw = NAN;
   _filtered = NAN;
+  _kalman.reset();
   _validCount = 0;
   _rejectedCount = 0;
   _consecutiveRejects = 0;
@@ -62,9 +121,7 @@ void SensorFilter::reset() {
   _hasValid = false;
 
   // Re-sync : mini-buffer de bruts rejetés + état anti-boucle latché.
-  for (uint8_t i = 0; i < kSensorFilterMedianWindow; ++i) _rejBuffer[i] = NAN;
-  _rejIdx = 0;
-  _rejCount = 0;
+  _rejWindow.clear();
   for (uint8_t i = 0; i < kSensorFilterMaxResyncPerWindow; ++i) _resyncTimestamps[i] = 0;
   _resyncCount = 0;
   _unstableLatched = false;
@@ -73,7 +130,7 @@ void SensorFilter::reset() {
   _frozenDetector.reset();
 }
 
-bool SensorFilter::addSample(float raw, uint32_t nowMs) {
+bool SensorFilterCore::addSample(float raw, uint32_t nowMs) {
   _raw = raw;
 
   // En warmup tant que le nombre de mesures valides n'a pas atteint le seuil.
@@ -102,15 +159,14 @@ bool SensorFilter::addSample(float raw, uint32_t nowMs) {
       if (_consecutiveRejects < 255) ++_consecutiveRejects;
 
       // Mémorise ce brut rejeté (mini-buffer circulaire) pour l'amorçage de re-sync.
-      _rejBuffer[_rejIdx] = raw;
-      _rejIdx = (_rejIdx + 1) % _cfg.medianWindow;
-      if (_rejCount < _cfg.medianWindow) ++_rejCount;
+      _rejWindow.push(raw);
 
       // Saut DURABLE : au-delà du seuil de re-sync, on conclut à un vrai changement
       // (et non un pic isolé) et on ré-amorce le filtre. Ré-amorçage sur la MÉDIANE
       // des derniers bruts rejetés afin d'ignorer un éventuel pic final.
       if (_consecutiveRejects >= kSensorFilterResyncRejects) {
-        const float seed = _computeRejectedMedian();
+        // Fallback sur l'échantillon courant si aucun rejeté mémorisé.
+        const float seed = (_rejWindow.count() > 0) ? _rejWindow.median() : _raw;
         const float oldFiltered = _filtered;
 
         // Comptabilise la re-sync sur la fenêtre glissante (anti-boucle EMI).
@@ -133,16 +189,13 @@ bool SensorFilter::addSample(float raw, uint32_t nowMs) {
         }
 
         // Ré-amorçage : retour warmup autour de la médiane des bruts rejetés.
-        for (uint8_t i = 0; i < kSensorFilterMedianWindow; ++i) _buffer[i] = NAN;
-        _bufIdx = 0;
-        _bufCount = 0;
+        _window.clear();
         _filtered = NAN;
+        _kalman.reset();
         _validCount = 0;          // → repasse en warmup (les cycles suivants ignorent maxStep)
         _consecutiveRejects = 0;  // reset des consécutifs, mais _rejectedCount conservé
         // Le mini-buffer de rejetés est purgé : il a servi à l'amorçage.
-        for (uint8_t i = 0; i < kSensorFilterMedianWindow; ++i) _rejBuffer[i] = NAN;
-        _rejIdx = 0;
-        _rejCount = 0;
+        _rejWindow.clear();
 
         systemLogger.warning(String("[SensorFilter] re-sync : changement durable détecté, ") +
                              "ancienne valeur=" + String(oldFiltered, 3) +
@@ -171,14 +224,14 @@ bool SensorFilter::addSample(float raw, uint32_t nowMs) {
   //    une rafale de rejets, pool-chemistry condition #4).
   _frozenDetector.addSample(raw);
 
-  // 1) Buffer circulaire pour la médiane.
-  _buffer[_bufIdx] = raw;
-  _bufIdx = (_bufIdx + 1) % _cfg.medianWindow;
-  if (_bufCount < _cfg.medianWindow) ++_bufCount;
+  // 1) Fenêtre médiane glissante (retrait du plus ancien, insertion triée).
+  _window.push(raw);
 
-  // 2) EMA sur la médiane courante (la médiane absorbe déjà un pic isolé).
-  float med = _computeMedian();
-  if (isnan(_filtered)) {
+  // 2) EMA (ou Kalman) sur la médiane courante (la médiane absorbe déjà un pic isolé).
+  float med = _window.median();
+  if (_cfg.estimator.mode == SensorEstimator::Kalman) {
+    _filtered = _kalman.update(med, nowMs);
+  } else if (isnan(_filtered)) {
     _filtered = med;  // amorçage à la 1ʳᵉ médiane disponible
   } else {
     _filtered = _cfg.emaAlpha * med + (1.0f - _cfg.emaAlpha) * _filtered;
@@ -190,59 +243,22 @@ bool SensorFilter::addSample(float raw, uint32_t nowMs) {
   return true;
 }
 
-float SensorFilter::_computeMedian() const {
-  if (_bufCount == 0) return NAN;
+float SensorFilterCore::raw() const { return _raw; }
 
-  // Copie locale (sur la pile) des échantillons valides puis tri par insertion.
-  // Capacité bornée par kSensorFilterMedianWindow → aucune alloc dynamique.
-  float tmp[kSensorFilterMedianWindow];
-  for (uint8_t i = 0; i < _bufCount; ++i) tmp[i] = _buffer[i];
+float SensorFilterCore::median() const { return _window.median(); }
 
-  for (uint8_t i = 1; i < _bufCount; ++i) {
-    float key = tmp[i];
-    int j = (int)i - 1;
-    while (j >= 0 && tmp[j] > key) {
-      tmp[j + 1] = tmp[j];
-      --j;
-    }
-    tmp[j + 1] = key;
-  }
+float SensorFilterCore::filtered() const { return _filtered; }
 
-  if (_bufCount & 1) {
-    return tmp[_bufCount / 2];
-  }
-  return 0.5f * (tmp[_bufCount / 2 - 1] + tmp[_bufCount / 2]);
+float SensorFilterCore::trendPerMin() const {
+  if (_cfg.estimator.mode != SensorEstimator::Kalman) return NAN;
+  return _kalman.trendPerMin();
 }
 
-float SensorFilter::_computeRejectedMedian() const {
-  if (_rejCount == 0) return _raw;  // fallback : échantillon courant si aucun rejeté mémorisé
-
-  float tmp[kSensorFilterMedianWindow];
-  for (uint8_t i = 0; i < _rejCount; ++i) tmp[i] = _rejBuffer[i];
-
-  for (uint8_t i = 1; i < _rejCount; ++i) {
-    float key = tmp[i];
-    int j = (int)i - 1;
-    while (j >= 0 && tmp[j] > key) {
-      tmp[j + 1] = tmp[j];
-      --j;
-    }
-    tmp[j + 1] = key;
-  }
-
-  if (_rejCount & 1) {
-    return tmp[_rejCount / 2];
-  }
-  return 0.5f * (tmp[_rejCount / 2 - 1] + tmp[_rejCount / 2]);
+void SensorFilterCore::noteDose(uint32_t nowMs) {
+  if (_cfg.estimator.mode == SensorEstimator::Kalman) _kalman.noteDose(nowMs);
 }
 
-float SensorFilter::raw() const { return _raw; }
-
-float SensorFilter::median() const { return _computeMedian(); }
-
-float SensorFilter::filtered() const { return _filtered; }
-
-bool SensorFilter::ready(uint32_t nowMs) const {
+bool SensorFilterCore::ready(uint32_t nowMs) const {
   // Warmup atteint ET au moins une mesure valide ET mesure récente ET non figé.
   if (_validCount < _cfg.warmupSamples) return false;
   if (!_hasValid) return false;
@@ -253,22 +269,22 @@ bool SensorFilter::ready(uint32_t nowMs) const {
   return true;
 }
 
-bool SensorFilter::frozen() const { return _frozenDetector.frozen(); }
+bool SensorFilterCore::frozen() const { return _frozenDetector.frozen(); }
 
-bool SensorFilter::unstable() const {
+bool SensorFilterCore::unstable() const {
   // Instable si trop de rejets consécutifs OU latch anti-boucle EMI posé.
   return (_consecutiveRejects >= _cfg.maxConsecutiveRejects) || _unstableLatched;
 }
 
-uint8_t SensorFilter::rejectedCount() const { return _rejectedCount; }
+uint8_t SensorFilterCore::rejectedCount() const { return _rejectedCount; }
 
-uint8_t SensorFilter::consecutiveRejects() const { return _consecutiveRejects; }
+uint8_t SensorFilterCore::consecutiveRejects() const { return _consecutiveRejects; }
 
-uint8_t SensorFilter::resyncCount() const { return _resyncCount; }
+uint8_t SensorFilterCore::resyncCount() const { return _resyncCount; }
 
-bool SensorFilter::unstableLatched() const { return _unstableLatched; }
+bool SensorFilterCore::unstableLatched() const { return _unstableLatched; }
 
-uint32_t SensorFilter::ageMs(uint32_t nowMs) const {
+uint32_t SensorFilterCore::ageMs(uint32_t nowMs) const {
   if (!_hasValid) return UINT32_MAX;
   // Arithmétique non signée : gère correctement le wrap millis() (~49.7 j).
   return nowMs - _lastValidMs;
@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include "constants.h"
+#include "sensor_estimator.h"
 
 // =============================================================================
 // SensorFilter — Lissage robuste d'une mesure scalaire (pH ou ORP) (feature-025)
@@ -11,10 +12,16 @@
 // Chaîne de filtrage déterministe, testable hors matériel Atlas :
 //   mesure brute → rejet aberrant (NaN / hors plage / saut) → médiane courte → EMA
 //
+// Étage final sélectionnable (config.estimator) : EMA (défaut) ou estimateur
+// de Kalman niveau + tendance (sensor_estimator.h), moins de retard sur une
+// rampe, couplé aux doses par noteDose().
+//
 // Contraintes :
-//   - ZÉRO allocation dynamique : buffer FIXE float[kSensorFilterMedianWindow].
+//   - ZÉRO allocation dynamique : fenêtre médiane FIXE, capacité N paramètre de
+//     template (WindowedSensorFilter<N>), médiane glissante incrémentale.
 //   - Pas de membre statique : 1 instance par capteur.
-//   - Lecture/écriture dans le SEUL contexte loopTask (comme _lastPh/_lastOrp).
+//   - Lecture/écriture dans le SEUL contexte loopTask (comme le cache de voie,
+//     cf. sensor_channel.h).
 //     addSample() écrit, les getters lisent — pas de mutex interne nécessaire si
 //     l'appelant respecte ce contrat (cf. SensorManager).
 //
@@ -89,26 +96,78 @@ private:
   uint16_t _runCount = 0;   // Longueur du run courant (saturé à UINT16_MAX)
 };
 
-class SensorFilter {
+// =============================================================================
+// SlidingMedian — Médiane glissante incrémentale
+// =============================================================================
+//
+// Fenêtre circulaire (ordre d'arrivée) + copie TRIÉE maintenue à chaque
+// échantillon : on retire le plus ancien (recherche dichotomique) et on insère
+// le nouveau à sa place (recherche dichotomique + décalage d'au plus `window`
+// floats). La médiane est lue en O(1) — plus de copie ni de tri par insertion
+// à chaque mesure.
+//
+// Résultat identique à l'ancien calcul (tri de la fenêtre puis élément central,
+// ou demi-somme des deux centraux si pair) : même multiensemble trié, même
+// formule. Seule nuance théorique : +0.0 et -0.0 sont égaux pour le tri, leur
+// ordre relatif peut différer (aucun capteur ne produit -0.0).
+//
+// Stockage FOURNI par le propriétaire (2 tableaux de `capacity` floats) :
+// aucune allocation, taille fixée à la compilation par WindowedSensorFilter<N>.
+// NaN interdit en entrée (SensorFilter rejette NaN en amont).
+class SlidingMedian {
 public:
-  struct Config {
-    float minValue;                  // Borne basse plage plausible
-    float maxValue;                  // Borne haute plage plausible
-    float maxStep;                   // Saut max toléré entre 2 lectures (hors warmup)
-    float emaAlpha;                  // Coefficient EMA (0..1, plus petit = plus lent)
-    uint8_t medianWindow;            // Taille fenêtre médiane (<= kSensorFilterMedianWindow)
-    uint8_t warmupSamples;           // Mesures valides avant ready()
-    uint8_t maxConsecutiveRejects;   // Seuil de déclaration "instable"
-    uint32_t maxAgeMs;               // Âge max dernière mesure valide pour ready()
-    // feature-022 : détection capteur figé. Champs en FIN de struct pour préserver
-    // l'init positionnelle existante (tests natifs) : une init agrégat plus courte
-    // value-initialise ces champs à 0 → détection désactivée. Pas d'initialiseur
-    // par défaut ici (gnu++11 côté ESP32 : la struct doit rester un agrégat).
-    uint16_t frozenSamples;          // N échantillons acceptés dans la bande → figé (0 = off)
-    float frozenEpsilon;             // Largeur de bande (½ LSB capteur)
-  };
-
-  explicit SensorFilter(const Config& config);
+  SlidingMedian(float* ring, float* sorted, uint8_t capacity)
+      : _ring(ring), _sorted(sorted), _capacity(capacity) {}
+
+  // Fenêtre logique, bornée à [1, capacity]. Vide la fenêtre.
+  void setWindow(uint8_t window);
+  void clear() { _idx = 0; _count = 0; }
+  void push(float x);
+
+  uint8_t count() const { return _count; }
+  // Médiane courante, NAN si vide.
+  float median() const;
+
+private:
+  // Premier indice de _sorted[0.._count) dont la valeur n'est pas < x.
+  uint8_t _lowerBound(float x) const;
+
+  float* _ring;        // Ordre d'arrivée (slot _idx = plus ancien quand plein)
+  float* _sorted;      // Mêmes valeurs, triées croissantes
+  uint8_t _capacity;
+  uint8_t _window = 1;
+  uint8_t _idx = 0;    // Prochain slot d'écriture dans _ring
+  uint8_t _count = 0;  // Échantillons présents (<= _window)
+};
+
+struct SensorFilterConfig {
+  float minValue;                  // Borne basse plage plausible
+  float maxValue;                  // Borne haute plage plausible
+  float maxStep;                   // Saut max toléré entre 2 lectures (hors warmup)
+  float emaAlpha;                  // Coefficient EMA (0..1, plus petit = plus lent)
+  uint8_t medianWindow;            // Taille fenêtre médiane (<= capacité N du filtre)
+  uint8_t warmupSamples;           // Mesures valides avant ready()
+  uint8_t maxConsecutiveRejects;   // Seuil de déclaration "instable"
+  uint32_t maxAgeMs;               // Âge max dernière mesure valide pour ready()
+  // feature-022 : détection capteur figé. Champs en FIN de struct pour préserver
+  // l'init positionnelle existante (tests natifs) : une init agrégat plus courte
+  // value-initialise ces champs à 0 → détection désactivée. Pas d'initialiseur
+  // par défaut ici (gnu++11 côté ESP32 : la struct doit rester un agrégat).
+  uint16_t frozenSamples;          // N échantillons acceptés dans la bande → figé (0 = off)
+  float frozenEpsilon;             // Largeur de bande (½ LSB capteur)
+  // Étage final (même règle : absent d'une init courte → Ema).
+  SensorEstimatorConfig estimator;
+};
+
+// Logique complète du filtre, indépendante de la capacité : les fenêtres
+// médianes travaillent sur le stockage fourni par WindowedSensorFilter<N>.
+// Non copiable (les fenêtres pointent dans l'objet qui la contient).
+class SensorFilterCore {
+public:
+  using Config = SensorFilterConfig;
+
+  SensorFilterCore(const SensorFilterCore&) = delete;
+  SensorFilterCore& operator=(const SensorFilterCore&) = delete;
 
   // Soumet une mesure brute. Retourne true si elle a été ACCEPTÉE (filtre alimenté),
   // false si rejetée (NaN / hors plage / saut excessif). nowMs = millis() de la lecture.
@@ -119,7 +178,13 @@ public:
 
   float raw() const;        // Dernière valeur brute soumise (NaN si aucune)
   float median() const;     // Médiane courante (NaN si pas encore de donnée)
-  float filtered() const;   // Valeur filtrée EMA (NaN tant que warmup pas amorcé)
+  float filtered() const;   // Valeur filtrée EMA ou Kalman (NaN tant que warmup pas amorcé)
+  // Pente estimée (unités/min) — étage Kalman uniquement, NaN sinon ou non amorcé.
+  float trendPerMin() const;
+  // Dose en cours (pompe active) : l'étage Kalman attend un mouvement et le suit
+  // plus vite pendant la pause mélange. Sans effet avec l'EMA.
+  void noteDose(uint32_t nowMs);
+  SensorEstimator estimator() const { return _cfg.estimator.mode; }
   bool ready(uint32_t nowMs) const;   // Warmup atteint ET mesure récente valide ET non figé
   bool unstable() const;    // Trop de rejets consécutifs → capteur instable
   bool frozen() const;      // Capteur figé : N échantillons acceptés dans une bande < epsilon (feature-022)
@@ -128,18 +193,26 @@ public:
   uint8_t resyncCount() const;          // Nb re-sync dans la fenêtre glissante courante
   bool unstableLatched() const;         // Latch anti-boucle EMI posé (jusqu'à reset())
   uint32_t ageMs(uint32_t nowMs) const; // Âge dernière mesure valide (UINT32_MAX si aucune)
+  uint8_t medianWindow() const { return _cfg.medianWindow; }  // Fenêtre effective (bornée)
+  float frozenEpsilon() const { return _cfg.frozenEpsilon; }  // Bande du détecteur figé
+
+protected:
+  // ring/sorted : fenêtre des acceptés ; rejRing/rejSorted : mini-buffer des
+  // bruts rejetés pour saut. Chacun `capacity` floats, vivant aussi longtemps
+  // que le filtre.
+  SensorFilterCore(const Config& config, uint8_t capacity,
+                   float* ring, float* sorted, float* rejRing, float* rejSorted);
 
 private:
   Config _cfg;
 
-  // Buffer circulaire FIXE pour la médiane (taille physique = kSensorFilterMedianWindow,
-  // taille logique = _cfg.medianWindow bornée à la capacité physique).
-  float _buffer[kSensorFilterMedianWindow];
-  uint8_t _bufIdx = 0;        // Prochain slot d'écriture
-  uint8_t _bufCount = 0;      // Nombre d'échantillons valides dans le buffer
+  // Fenêtre médiane des acceptés (taille logique = _cfg.medianWindow bornée à
+  // la capacité N).
+  SlidingMedian _window;
 
   float _raw = NAN;           // Dernière brute soumise
-  float _filtered = NAN;      // Valeur EMA
+  float _filtered = NAN;      // Valeur EMA ou niveau Kalman
+  KalmanTrend _kalman;        // Étage final si _cfg.estimator.mode == Kalman
   uint8_t _validCount = 0;    // Nombre de mesures valides depuis reset (sature à 255)
   uint8_t _rejectedCount = 0; // Compteur de rejets (sature à 255)
   uint8_t _consecutiveRejects = 0;
@@ -147,12 +220,10 @@ private:
   bool _hasValid = false;     // true dès la 1ʳᵉ mesure acceptée
 
   // --- Re-synchronisation (anti latch-up) ---
-  // Mini-buffer FIXE des derniers bruts rejetés par "saut excessif" (réutilise la
-  // capacité physique kSensorFilterMedianWindow → aucune alloc dynamique). Sert à
-  // calculer la médiane d'amorçage lors d'une re-sync (ignore un éventuel pic final).
-  float _rejBuffer[kSensorFilterMedianWindow];
-  uint8_t _rejIdx = 0;        // Prochain slot d'écriture
-  uint8_t _rejCount = 0;      // Nombre d'échantillons valides dans _rejBuffer
+  // Mini-buffer FIXE des derniers bruts rejetés par "saut excessif" (même
+  // capacité N → aucune alloc dynamique). Sa médiane amorce une re-sync
+  // (ignore un éventuel pic final).
+  SlidingMedian _rejWindow;
 
   // --- Anti-boucle latché ---
   // Timestamps des re-sync (fenêtre glissante kSensorFilterResyncWindowMs).
@@ -164,12 +235,35 @@ private:
   // Alimenté UNIQUEMENT par les échantillons bruts ACCEPTÉS dans addSample()
   // (condition #4 : les rejets ne l'alimentent pas → frozen persiste).
   FrozenDetector _frozenDetector;
+};
+
+// Stockage des deux fenêtres, classe de base placée AVANT SensorFilterCore :
+// construit en premier, il est valide quand le constructeur du cœur appelle reset().
+template <uint8_t N>
+struct SensorFilterStorage {
+  float ring[N];
+  float sorted[N];
+  float rejRing[N];
+  float rejSorted[N];
+};
 
-  // Calcule la médiane des _bufCount premiers échantillons par tri sur copie locale.
-  float _computeMedian() const;
+// Filtre à fenêtre médiane de capacité N, fixée à la compilation (une par
+// capteur : kPhFilterMedianWindow, kOrpFilterMedianWindow).
+template <uint8_t N>
+class WindowedSensorFilter : private SensorFilterStorage<N>, public SensorFilterCore {
+  static_assert(N >= 1, "fenetre mediane vide");
+  // Le mini-buffer de rejets doit être plein au déclenchement d'une re-sync
+  // (médiane d'amorçage fiable).
+  static_assert(N < kSensorFilterResyncRejects,
+                "fenetre mediane >= kSensorFilterResyncRejects");
 
-  // Médiane du mini-buffer de bruts rejetés (amorçage de re-sync). NAN si vide.
-  float _computeRejectedMedian() const;
+public:
+  explicit WindowedSensorFilter(const Config& config)
+      : SensorFilterStorage<N>(),
+        SensorFilterCore(config, N, this->ring, this->sorted, this->rejRing, this->rejSorted) {}
 };
 
+// Fenêtre historique (7), utilisée par les tests et les outils natifs.
+using SensorFilter = WindowedSensorFilter<kSensorFilterMedianWindow>;
+
 #endif // SENSOR_FILTER_H
@@ -0,0 +1,110 @@
+#include "sensor_health_logic.h"
+
+#include <math.h>
+
+// =============================================================================
+// sensor_health_logic — implémentation PURE
+// =============================================================================
+
+namespace {
+
+// Pondérations du score (somme 1).
+constexpr float kWeightNoise = 0.30f;
+constexpr float kWeightSpike = 0.30f;
+constexpr float kWeightFail = 0.25f;
+constexpr float kWeightLatency = 0.15f;
+
+// Part de pénalité d'un indicateur : nulle jusqu'à la moitié de la limite
+// (régime nominal, ex. latence ≈ 1 s pour 3 s), pleine à la limite.
+float penaltyPart(float value, float limit) {
+  if (!(limit > 0.0f) || isnan(value)) return 0.0f;
+  const float r = 2.0f * value / limit - 1.0f;
+  if (r <= 0.0f) return 0.0f;
+  return r > 1.0f ? 1.0f : r;
+}
+
+}  // namespace
+
+float SensorHealth::alphaFor(uint32_t n) const {
+  const uint32_t w = _cfg.windowSamples ? _cfg.windowSamples : 1;
+  return 1.0f / (float)(n < w ? n : w);
+}
+
+void SensorHealth::onRead(bool ok, bool accepted, float value, uint32_t latencyMs,
+                          uint32_t nowMs) {
+  _reads++;
+  _failRate += alphaFor(_reads) * ((ok ? 0.0f : 1.0f) - _failRate);
+  if (latencyMs != kSensorHealthNoLatency) addLatency(latencyMs);
+  if (!ok) return;
+
+  _everOk = true;
+  _lastOkMs = nowMs;
+  _valid++;
+  _spikeRate += alphaFor(_valid) * ((accepted ? 0.0f : 1.0f) - _spikeRate);
+  if (!accepted) return;
+
+  if (_accepted > 0) {
+    const float d = value - _prevAccepted;
+    _diffSq += alphaFor(_accepted) * (d * d - _diffSq);
+  }
+  _prevAccepted = value;
+  _accepted++;
+}
+
+float SensorHealth::noiseStd() const {
+  if (_accepted < 2) return NAN;
+  return sqrtf(_diffSq * 0.5f);
+}
+
+void SensorHealth::addLatency(uint32_t ms) {
+  size_t b = 0;
+  while (b < kSensorHealthLatencyBuckets - 1 && ms > kSensorHealthLatencyBoundsMs[b]) ++b;
+  _latency[b]++;
+  _latencyTotal++;
+  if (ms > _latencyMaxMs) _latencyMaxMs = ms;
+  if (_latencyTotal < kSensorHealthLatencyDecayTotal) return;
+  // Oubli : les anciennes mesures pèsent deux fois moins à chaque passage.
+  _latencyTotal = 0;
+  for (size_t i = 0; i < kSensorHealthLatencyBuckets; ++i) {
+    _latency[i] = (uint16_t)((_latency[i] + 1) / 2);
+    _latencyTotal = (uint16_t)(_latencyTotal + _latency[i]);
+  }
+}
+
+uint32_t SensorHealth::latencyPercentileMs(uint8_t pct) const {
+  if (_latencyTotal == 0) return 0;
+  if (pct < 1) pct = 1;
+  if (pct > 100) pct = 100;
+  // Rang du percentile, arrondi au-dessus (p95 sur 20 mesures = 19ᵉ).
+  const uint32_t rank = ((uint32_t)_latencyTotal * pct + 99) / 100;
+  uint32_t seen = 0;
+  for (size_t i = 0; i < kSensorHealthLatencyBuckets - 1; ++i) {
+    seen += _latency[i];
+    if (seen >= rank) {
+      const uint32_t bound = kSensorHealthLatencyBoundsMs[i];
+      return bound < _latencyMaxMs ? bound : _latencyMaxMs;
+    }
+  }
+  return _latencyMaxMs;
+}
+
+uint32_t SensorHealth::sampleAgeMs(uint32_t nowMs) const {
+  if (!_everOk) return UINT32_MAX;
+  return nowMs - _lastOkMs;
+}
+
+uint8_t SensorHealth::score(uint32_t nowMs) const {
+  if (sampleAgeMs(nowMs) > _cfg.maxAgeMs) return 0;
+  const float penalty =
+      kWeightNoise * penaltyPart(noiseStd(), _cfg.noiseLimit) +
+      kWeightSpike * penaltyPart(_spikeRate, _cfg.spikeRateLimit) +
+      kWeightFail * penaltyPart(_failRate, _cfg.failRateLimit) +
+      kWeightLatency * penaltyPart((float)latencyPercentileMs(95), (float)_cfg.latencyLimitMs);
+  const float s = 100.0f * (1.0f - penalty);
+  return (uint8_t)(s <= 0.0f ? 0 : (uint8_t)(s + 0.5f));
+}
+
+void SensorHealth::reset() {
+  const SensorHealthConfig cfg = _cfg;
+  *this = SensorHealth(cfg);
+}
@@ -0,0 +1,103 @@
+#ifndef SENSOR_HEALTH_LOGIC_H
+#define SENSOR_HEALTH_LOGIC_H
+
+// =============================================================================
+// sensor_health_logic — Santé d'une voie pH / ORP, PURE
+// =============================================================================
+// Statistiques glissantes d'une voie capteur, mises à jour à chaque cycle de
+// lecture, mémoire O(1) (aucun historique d'échantillons) :
+//
+//   - bruit       : variance exponentielle des différences successives des
+//                   lectures ACCEPTÉES par SensorFilter ; σ = √(E[d²]/2).
+//                   Une dérive lente du bassin n'y contribue presque pas, un
+//                   bruit blanc y apparaît intégralement ;
+//   - pics        : part des lectures valides rejetées par le filtre ;
+//   - échecs I²C  : part des cycles sans lecture ;
+//   - latence     : soumission du cycle → relève, histogramme à bornes fixes
+//                   dont les comptes sont divisés par deux périodiquement
+//                   (oubli exponentiel) → percentiles approchés par borne ;
+//   - âge         : dernière lecture valide.
+//
+// Moyennes exponentielles de poids α = 1/window, amorcées par α = 1/n tant
+// que n < window (moyenne arithmétique exacte au démarrage).
+//
+// score(now) ∈ [0, 100] : 100 − Σ poids × pénalité, chaque pénalité nulle
+// sous la moitié de sa limite et pleine à la limite (linéaire entre les deux).
+// Une voie muette (aucune lecture valide depuis maxAgeMs) vaut 0.
+//
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Latence non mesurée (cycle jamais démarré) : pas d'entrée d'histogramme.
+constexpr uint32_t kSensorHealthNoLatency = UINT32_MAX;
+
+// Bornes supérieures (ms) des classes de latence ; une classe de plus au-delà.
+constexpr uint32_t kSensorHealthLatencyBoundsMs[] = {250,  500,  750,  1000, 1250,
+                                                     1500, 2000, 3000, 5000, 10000};
+constexpr size_t kSensorHealthLatencyBuckets =
+    sizeof(kSensorHealthLatencyBoundsMs) / sizeof(kSensorHealthLatencyBoundsMs[0]) + 1;
+// Total de l'histogramme qui déclenche la division par deux.
+constexpr uint16_t kSensorHealthLatencyDecayTotal = 256;
+
+struct SensorHealthConfig {
+  uint16_t windowSamples;    // Mémoire des moyennes exponentielles (lectures)
+  float noiseLimit;          // σ de bruit (unité capteur) → pénalité pleine
+  float spikeRateLimit;      // Part de rejets → pénalité pleine
+  float failRateLimit;       // Part d'échecs I²C → pénalité pleine
+  uint32_t latencyLimitMs;   // p95 de latence → pénalité pleine
+  uint32_t maxAgeMs;         // Au-delà, voie muette : score 0
+};
+
+class SensorHealth {
+public:
+  explicit SensorHealth(const SensorHealthConfig& cfg) : _cfg(cfg) {}
+
+  // Un cycle de lecture. ok : trame valide reçue (value significatif) ;
+  // accepted : admise par SensorFilter ; latencyMs : kSensorHealthNoLatency
+  // si le cycle n'a pas démarré.
+  void onRead(bool ok, bool accepted, float value, uint32_t latencyMs, uint32_t nowMs);
+
+  float noiseStd() const;            // NaN avant 2 lectures acceptées
+  float spikeRate() const { return _spikeRate; }
+  float failRate() const { return _failRate; }
+  // Percentile (1-100) : borne supérieure de la classe ; classe ouverte →
+  // plus grande latence vue. 0 si aucune mesure.
+  uint32_t latencyPercentileMs(uint8_t pct) const;
+  uint32_t latencyMaxMs() const { return _latencyMaxMs; }
+  uint32_t sampleAgeMs(uint32_t nowMs) const;  // UINT32_MAX si aucune lecture valide
+
+  uint32_t reads() const { return _reads; }
+  uint32_t acceptedCount() const { return _accepted; }
+
+  uint8_t score(uint32_t nowMs) const;
+
+  // Après recalibration ou échange de sonde : l'historique ne décrit plus la voie.
+  void reset();
+
+private:
+  float alphaFor(uint32_t n) const;
+  void addLatency(uint32_t ms);
+
+  SensorHealthConfig _cfg;
+
+  float _diffSq = 0.0f;      // E[d²] exponentielle
+  float _prevAccepted = 0.0f;
+  uint32_t _accepted = 0;
+
+  float _spikeRate = 0.0f;
+  uint32_t _valid = 0;       // Lectures ok (dénominateur des pics)
+  float _failRate = 0.0f;
+  uint32_t _reads = 0;
+
+  uint16_t _latency[kSensorHealthLatencyBuckets] = {};
+  uint16_t _latencyTotal = 0;
+  uint32_t _latencyMaxMs = 0;
+
+  uint32_t _lastOkMs = 0;
+  bool _everOk = false;
+};
+
+#endif // SENSOR_HEALTH_LOGIC_H
@@ -0,0 +1,143 @@
+#include "sensor_replay_logic.h"
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include "sensor_trace_logic.h"
+
+ReplayChannel::ReplayChannel(const ReplayChannelParams& params)
+    : _p(params), _filter(params.filter) {}
+
+void ReplayChannel::restart() {
+  _filter.reset();
+  _active = false;
+  _startMs = 0;
+  _cyclesToday = 0;
+  _dayStarted = false;
+  _integral = 0.0f;
+  _lastError = 0.0f;
+  _lastPidMs = 0;
+  _pidPrimed = false;
+}
+
+ReplayStep ReplayChannel::step(bool sampled, float raw, uint32_t nowMs) {
+  ReplayStep s = {};
+  s.accepted = sampled ? _filter.addSample(raw, nowMs) : false;
+  s.ready = _filter.ready(nowMs);
+  s.unstable = _filter.unstable();
+  s.frozen = _filter.frozen();
+  s.filtered = _filter.filtered();
+
+  // Gardes capteur réelles, gardes pompe neutralisées (cf. en-tête).
+  DoseInputs in = {};
+  in.watchdogActive = true;
+  in.waterPresent = true;
+  in.reading = s.filtered;
+  in.filterReady = s.ready;
+  in.filterUnstable = s.unstable;
+  in.calPoints = 2;
+  in.requiredPoints = 1;
+  in.modeAutomatic = true;
+  in.maxDailyMl = FLT_MAX;
+  in.maxCyclesPerDay = UINT32_MAX;
+  in.maxCyclesPerMin = INT32_MAX;
+  in.maxCyclesPer15Min = INT32_MAX;
+  s.refusal = evaluateDose(in).cause;
+
+  if (s.refusal != DoseRefusal::None) {
+    _active = false;
+    return s;
+  }
+
+  const float error = _p.errorAboveTarget ? (s.filtered - _p.target) : (_p.target - s.filtered);
+
+  // Compteur de cycles journalier (coquille shouldStartDosing()).
+  if (!_dayStarted || nowMs - _dayStartMs >= 86400000UL) {
+    _cyclesToday = 0;
+    _dayStartMs = nowMs;
+    _dayStarted = true;
+  }
+
+  bool shouldDose;
+  if (_active) {
+    shouldDose = shouldContinueDosingPure(error, _p.stopThreshold, nowMs - _startMs,
+                                          _p.minInjectionTimeMs);
+  } else {
+    // Erreur projetée par la tendance (étage Kalman ; NaN → inchangée).
+    const float trend = _filter.trendPerMin();
+    const float startError = projectErrorWithTrend(
+        error, _p.errorAboveTarget ? trend : -trend, _p.trendHorizonMin);
+    shouldDose = shouldStartDosingPure(startError, _p.startThreshold, _cyclesToday,
+                                       _p.maxCyclesPerDay);
+    if (shouldDose) {
+      _startMs = nowMs;
+      _cyclesToday++;
+    }
+  }
+
+  if (!shouldDose) {
+    _active = false;
+    if (error < -_p.stopThreshold) {
+      _integral = 0.0f;
+      _lastError = 0.0f;
+      _pidPrimed = false;
+    }
+    return s;
+  }
+
+  // Coquille computePID() : 1er appel amorce, dt aberrant ignoré.
+  float flow = 0.0f;
+  if (!_pidPrimed) {
+    _pidPrimed = true;
+    _lastPidMs = nowMs;
+    _lastError = error;
+  } else {
+    const float dt = (nowMs - _lastPidMs) / 1000.0f;
+    if (dt <= 0.0f || dt > 10.0f) {
+      _lastPidMs = nowMs;
+    } else {
+      const bool saturated = (_p.kp * error >= _p.maxFlow);
+      const PidResult r = computePidPure(_p.kp, _p.ki, _p.kd, error, _lastError, _integral,
+                                         dt, _p.integralMax, _p.startThreshold,
+                                         _p.minFlow, _p.maxFlow, saturated);
+      _integral = r.integral;
+      _lastError = r.lastError;
+      _lastPidMs = nowMs;
+      flow = r.flow;
+    }
+  }
+
+  s.flow = flow;
+  s.dosing = flow > 0.0f;
+  _active = s.dosing;  // phDosingState.active = phActive (flow > 0) en fin de tick
+  if (s.dosing) _filter.noteDose(nowMs);  // sensors.notePhDosing() en fin de tick
+  return s;
+}
+
+void replayDiffAdd(ReplayDiff& d, const ReplayStep& ref, const ReplayStep& cand) {
+  const bool decisionDiff = (ref.refusal != cand.refusal) || (ref.dosing != cand.dosing);
+  if (ref.ready != cand.ready) d.readyDiffs++;
+  if (ref.refusal != cand.refusal) d.refusalDiffs++;
+  if (ref.dosing != cand.dosing) d.dosingDiffs++;
+  if (ref.dosing) d.dosingStepsRef++;
+  if (cand.dosing) d.dosingStepsCand++;
+  if (!isnan(ref.filtered) && !isnan(cand.filtered)) {
+    const float delta = fabsf(ref.filtered - cand.filtered);
+    if (delta > d.maxFilteredDelta) d.maxFilteredDelta = delta;
+  }
+  const float flowDelta = fabsf(ref.flow - cand.flow);
+  if (flowDelta > d.maxFlowDelta) d.maxFlowDelta = flowDelta;
+  if (decisionDiff && d.firstDiff < 0) d.firstDiff = static_cast<int32_t>(d.steps);
+  d.steps++;
+}
+
+bool replayMatchesRecorded(const ReplayStep& s, uint8_t recordedFlags, float recordedFiltered) {
+  const uint8_t mask = kTraceAccepted | kTraceReady | kTraceUnstable | kTraceFrozen;
+  const uint8_t replayed = sensorTraceFlags(false, s.accepted, s.ready, s.unstable, s.frozen);
+  if ((recordedFlags & mask) != replayed) return false;
+  if (isnan(recordedFiltered) || isnan(s.filtered)) {
+    return isnan(recordedFiltered) && isnan(s.filtered);
+  }
+  return memcmp(&recordedFiltered, &s.filtered, sizeof(float)) == 0;
+}
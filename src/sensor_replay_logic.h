@@ -0,0 +1,109 @@
+#ifndef SENSOR_REPLAY_LOGIC_H
+#define SENSOR_REPLAY_LOGIC_H
+
+// =============================================================================
+// sensor_replay_logic — Relecture d'une trace capteurs jusqu'à la décision de dosage
+// =============================================================================
+// Rejoue, enregistrement par enregistrement (sensor_trace_logic.h), la chaîne
+// du firmware pour UNE voie (pH ou ORP) :
+//
+//   brute → SensorFilter (rejets, médiane, EMA ou Kalman, FrozenDetector composé)
+//         → evaluateDose() → hystérésis start/continue (erreur projetée par la
+//           tendance au démarrage) → computePidPure()
+//
+// et compare deux configurations (référence / candidate) pas à pas. Sert à
+// valider une modification de filtre ou de régulation sur des données de
+// bassin réelles (pics EMI, creux de calibration) — outil tools/trace_replay.
+//
+// Simplifications assumées (le sujet est le chemin capteur → décision) :
+//   - un pas de régulation par enregistrement (cadence capteurs, 5 s) ;
+//   - gardes liées aux pompes neutralisées : watchdog, présence d'eau,
+//     calibration, stabilisation, mélange, limites jour/heure, anti-rafale ;
+//   - la coquille computePID() est reproduite (1er appel amorce, dt > 10 s
+//     ignoré), de même que la RAZ du PID sur erreur < -stopThreshold ;
+//   - seules les doses automatiques alimentent noteDose() (pas de manuelles).
+//
+// CONTRAINTE : pas de FreeRTOS ; Arduino.h uniquement via sensor_filter.h
+// (shim en natif). Compilé en natif (env:native).
+// =============================================================================
+
+#include <stdint.h>
+
+#include "dosing_logic.h"
+#include "sensor_filter.h"
+
+// Capacité de fenêtre médiane offerte à la relecture (essais de fenêtres plus
+// longues que celles du firmware).
+constexpr uint8_t kReplayMaxMedianWindow = 11;
+
+struct ReplayChannelParams {
+  SensorFilterConfig filter;
+  float target;
+  bool errorAboveTarget;     // true : erreur = mesure - cible (pH-) ; false : cible - mesure (pH+, ORP)
+  float startThreshold;      // pumpProtection.ph/orpStartThreshold (aussi zone morte PID)
+  float stopThreshold;       // pumpProtection.ph/orpStopThreshold
+  uint32_t minInjectionTimeMs;
+  unsigned int maxCyclesPerDay;
+  float kp, ki, kd, integralMax;
+  float minFlow, maxFlow;    // ml/min
+  float trendHorizonMin;     // kPh/kOrpTrendHorizonMin (sans effet avec l'étage EMA)
+};
+
+struct ReplayStep {
+  bool accepted;             // brute acceptée par le filtre
+  bool ready;
+  bool unstable;
+  bool frozen;
+  float filtered;            // NaN tant que non amorcé
+  DoseRefusal refusal;       // verdict evaluateDose()
+  bool dosing;               // pompe en marche après ce pas
+  float flow;                // débit commandé (0 à l'arrêt)
+};
+
+class ReplayChannel {
+public:
+  explicit ReplayChannel(const ReplayChannelParams& params);
+
+  // Un cycle capteur. sampled=false : lecture EZO ratée (le filtre n'est pas
+  // alimenté, comme _apply*Reading()).
+  ReplayStep step(bool sampled, float raw, uint32_t nowMs);
+
+  // Redémarrage du contrôleur (changement de session dans la trace).
+  void restart();
+
+  const SensorFilterCore& filter() const { return _filter; }
+
+private:
+  ReplayChannelParams _p;
+  WindowedSensorFilter<kReplayMaxMedianWindow> _filter;
+  bool _active = false;
+  uint32_t _startMs = 0;
+  unsigned int _cyclesToday = 0;
+  uint32_t _dayStartMs = 0;
+  bool _dayStarted = false;
+  float _integral = 0.0f;
+  float _lastError = 0.0f;
+  uint32_t _lastPidMs = 0;
+  bool _pidPrimed = false;
+};
+
+// Comparaison pas à pas de deux relectures (référence vs candidate).
+struct ReplayDiff {
+  uint32_t steps = 0;
+  uint32_t readyDiffs = 0;       // ready() différent
+  uint32_t refusalDiffs = 0;     // cause evaluateDose() différente
+  uint32_t dosingDiffs = 0;      // pompe en marche d'un côté seulement
+  uint32_t dosingStepsRef = 0;
+  uint32_t dosingStepsCand = 0;
+  float maxFilteredDelta = 0.0f; // |filtré ref - filtré cand| max (deux amorcés)
+  float maxFlowDelta = 0.0f;
+  int32_t firstDiff = -1;        // index du 1er pas divergent (décision), -1 si aucun
+};
+
+void replayDiffAdd(ReplayDiff& d, const ReplayStep& ref, const ReplayStep& cand);
+
+// Écart entre l'état enregistré par le firmware et une relecture (dérive de
+// version ou trace incohérente) : flags sampled exclus, filtré comparé au bit.
+bool replayMatchesRecorded(const ReplayStep& s, uint8_t recordedFlags, float recordedFiltered);
+
+#endif // SENSOR_REPLAY_LOGIC_H
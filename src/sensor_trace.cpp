@@ -0,0 +1,226 @@
+#include "sensor_trace.h"
+
+#include "logger.h"
+
+SensorTraceRecorder sensorTrace;
+
+namespace {
+const char* kTracePath = "/sensor_trace.bin";
+}
+
+void SensorTraceRecorder::setStorageFs(fs::FS* fs) {
+  if (!_mutex) {
+    _mutex = xSemaphoreCreateMutex();
+  }
+  _fs = fs;
+  _countersLoaded = false;
+}
+
+bool SensorTraceRecorder::_lock() {
+  return _mutex && xSemaphoreTake(_mutex, pdMS_TO_TICKS(kSensorTraceMutexTimeoutMs)) == pdTRUE;
+}
+
+void SensorTraceRecorder::_unlock() {
+  xSemaphoreGive(_mutex);
+}
+
+// Crée le fichier (en-tête + slots vides) s'il est absent, d'une autre
+// capacité ou d'un autre format. Taille fixe ensuite : plus jamais réalloué.
+bool SensorTraceRecorder::_ensureFile() {
+  if (!_fs) return false;
+  if (_fs->exists(kTracePath)) {
+    File f = _fs->open(kTracePath, "r");
+    if (f) {
+      SensorTraceHeader h;
+      const bool ok = f.size() == sensorTraceFileSize(kSensorTraceCapacity) &&
+                      f.read(reinterpret_cast<uint8_t*>(&h), sizeof(h)) == sizeof(h) &&
+                      sensorTraceHeaderValid(h, kSensorTraceCapacity);
+      f.close();
+      if (ok) return true;
+    }
+    systemLogger.warning("Trace capteurs : fichier invalide, recréé");
+  }
+
+  File f = _fs->open(kTracePath, "w");
+  if (!f) return false;
+  const SensorTraceHeader h = sensorTraceMakeHeader(kSensorTraceCapacity);
+  bool ok = f.write(reinterpret_cast<const uint8_t*>(&h), sizeof(h)) == sizeof(h);
+  SensorTraceRecord empty[kSensorTraceFlushRecords] = {};
+  for (uint16_t i = 0; ok && i < kSensorTraceCapacity; i += kSensorTraceFlushRecords) {
+    const uint16_t n = (kSensorTraceCapacity - i < kSensorTraceFlushRecords)
+                           ? kSensorTraceCapacity - i : kSensorTraceFlushRecords;
+    const size_t bytes = n * sizeof(SensorTraceRecord);
+    ok = f.write(reinterpret_cast<const uint8_t*>(empty), bytes) == bytes;
+  }
+  f.close();
+  if (!ok) {
+    _fs->remove(kTracePath);
+    return false;
+  }
+  _seq = 0;
+  _session = 0;
+  _countersLoaded = true;
+  return true;
+}
+
+// Reprise après redémarrage : seq et session continuent après le contenu du
+// fichier (lecture par paquets, pas de copie complète de l'anneau en RAM).
+bool SensorTraceRecorder::_resumeCounters() {
+  if (_countersLoaded) return true;
+  File f = _fs->open(kTracePath, "r");
+  if (!f) return false;
+  f.seek(sizeof(SensorTraceHeader));
+  SensorTraceRecord chunk[kSensorTraceFlushRecords];
+  uint32_t maxSeq = 0;
+  uint16_t maxSession = 0;
+  size_t got;
+  while ((got = f.read(reinterpret_cast<uint8_t*>(chunk), sizeof(chunk))) >= sizeof(SensorTraceRecord)) {
+    uint32_t s;
+    uint16_t sess;
+    sensorTraceScan(chunk, got / sizeof(SensorTraceRecord), &s, &sess);
+    if (s > maxSeq) maxSeq = s;
+    if (sess > maxSession) maxSession = sess;
+  }
+  f.close();
+  _seq = maxSeq;
+  _session = maxSession;
+  _countersLoaded = true;
+  return true;
+}
+
+bool SensorTraceRecorder::start(uint32_t durationMs) {
+  if (!_fs) return false;
+  if (durationMs == 0) durationMs = kSensorTraceDefaultArmMs;
+  if (durationMs > kSensorTraceMaxArmMs) durationMs = kSensorTraceMaxArmMs;
+  if (!_lock()) return false;
+  bool ok = _flushLocked() && _ensureFile() && _resumeCounters();
+  if (ok) {
+    _session++;
+    _armedAtMs = millis();
+    _durationMs = durationMs;
+    _active = true;
+  }
+  _unlock();
+  if (ok) {
+    systemLogger.info("Trace capteurs armée (session " + String(_session) + ", " +
+                      String(durationMs / 60000UL) + " min)");
+  } else {
+    systemLogger.error("Trace capteurs : armement impossible (fichier)");
+  }
+  return ok;
+}
+
+void SensorTraceRecorder::stop() {
+  if (!_lock()) return;
+  const bool wasActive = _active;
+  _active = false;
+  _flushLocked();
+  _unlock();
+  if (wasActive) systemLogger.info("Trace capteurs arrêtée (seq " + String(_seq) + ")");
+}
+
+bool SensorTraceRecorder::clear() {
+  if (!_fs || !_lock()) return false;
+  _active = false;
+  _pendingCount = 0;
+  const bool ok = !_fs->exists(kTracePath) || _fs->remove(kTracePath);
+  _seq = 0;
+  _session = 0;
+  _countersLoaded = ok;
+  _dropped = 0;
+  _unlock();
+  return ok;
+}
+
+uint32_t SensorTraceRecorder::remainingMs() const {
+  if (!_active) return 0;
+  const uint32_t elapsed = millis() - _armedAtMs;
+  return elapsed >= _durationMs ? 0 : _durationMs - elapsed;
+}
+
+void SensorTraceRecorder::record(const SensorTraceRecord& rec) {
+  if (!_active) return;
+  if (!_lock()) {
+    _dropped++;
+    return;
+  }
+  if (millis() - _armedAtMs >= _durationMs) {
+    _active = false;
+    _flushLocked();
+    _unlock();
+    systemLogger.info("Trace capteurs : durée écoulée, capture terminée (seq " + String(_seq) + ")");
+    return;
+  }
+  SensorTraceRecord& slot = _pending[_pendingCount++];
+  slot = rec;
+  slot.seq = ++_seq;
+  slot.session = _session;
+  if (_pendingCount >= kSensorTraceFlushRecords) {
+    _flushLocked();
+  }
+  _unlock();
+}
+
+bool SensorTraceRecorder::flush() {
+  if (!_lock()) return false;
+  const bool ok = _flushLocked();
+  _unlock();
+  return ok;
+}
+
+// Mutex tenu. Chaque enregistrement va à son slot ; l'attente est contiguë en
+// seq, donc au plus deux écritures (repli de l'anneau en milieu de paquet).
+bool SensorTraceRecorder::_flushLocked() {
+  if (_pendingCount == 0) return true;
+  bool ok = false;
+  File f = _fs ? _fs->open(kTracePath, "r+") : File();
+  if (f) {
+    ok = true;
+    uint8_t i = 0;
+    while (ok && i < _pendingCount) {
+      const uint32_t firstSeq = _pending[i].seq;
+      const uint16_t slot = (firstSeq - 1) % kSensorTraceCapacity;
+      uint8_t run = _pendingCount - i;
+      if (slot + run > kSensorTraceCapacity) run = kSensorTraceCapacity - slot;
+      const size_t bytes = run * sizeof(SensorTraceRecord);
+      ok = f.seek(sensorTraceOffset(firstSeq, kSensorTraceCapacity)) &&
+           f.write(reinterpret_cast<const uint8_t*>(&_pending[i]), bytes) == bytes;
+      i += run;
+    }
+    f.close();
+  }
+  if (!ok) {
+    _dropped += _pendingCount;
+    static uint32_t sLastErrMs = 0;
+    const uint32_t nowMs = millis();
+    if (sLastErrMs == 0 || nowMs - sLastErrMs >= kMutexTimeoutWarnThrottleMs) {
+      sLastErrMs = nowMs;
+      systemLogger.error("Trace capteurs : écriture échouée, enregistrements perdus");
+    }
+  }
+  _pendingCount = 0;
+  return ok;
+}
+
+size_t SensorTraceRecorder::prepareDownload() {
+  if (!_fs || !_lock()) return 0;
+  size_t size = 0;
+  if (_flushLocked() && _fs->exists(kTracePath)) {
+    size = sensorTraceFileSize(kSensorTraceCapacity);
+  }
+  _unlock();
+  return size;
+}
+
+bool SensorTraceRecorder::readAt(size_t offset, uint8_t* buf, size_t len, size_t& got) {
+  got = 0;
+  if (!_fs) return true;
+  if (!_lock()) return false;
+  File f = _fs->open(kTracePath, "r");
+  if (f) {
+    if (f.seek(offset)) got = f.read(buf, len);
+    f.close();
+  }
+  _unlock();
+  return true;
+}
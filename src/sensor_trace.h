@@ -0,0 +1,86 @@
+#ifndef SENSOR_TRACE_H
+#define SENSOR_TRACE_H
+
+// =============================================================================
+// sensor_trace — Enregistreur de trace capteurs (partition history)
+// =============================================================================
+// Capture, pendant une durée armée depuis l'API, un enregistrement par cycle
+// pH/ORP (bruts EZO, T° de compensation, état des filtres) dans un anneau de
+// taille fixe /sensor_trace.bin sur la partition history. Format et ordre de
+// relecture : sensor_trace_logic.h ; relecture sur PC : tools/trace_replay.sh.
+//
+// Écritures groupées : les enregistrements sont mis en attente en RAM et
+// écrits par paquets de kSensorTraceFlushRecords (usure flash bornée, un
+// paquet ≈ 80 s de capture). Désarmé par défaut ; l'armement expire seul.
+// Le fichier n'existe qu'entre le premier armement et clear() (budget de la
+// partition history).
+//
+// Concurrence : record() depuis loopTask, routes HTTP depuis async_tcp →
+// mutex interne sur l'attente RAM et les accès fichier.
+// =============================================================================
+
+#include <Arduino.h>
+#include <FS.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "constants.h"
+#include "sensor_trace_logic.h"
+
+class SensorTraceRecorder {
+public:
+  // Appelé par HistoryManager::begin() une fois la partition history montée.
+  // Sans appel (partition absente), l'enregistreur reste inerte.
+  void setStorageFs(fs::FS* fs);
+  bool available() const { return _fs != nullptr; }
+
+  // Arme la capture pour durationMs (borné à kSensorTraceMaxArmMs). Nouvelle
+  // session ; la numérotation reprend après les enregistrements existants.
+  bool start(uint32_t durationMs);
+  void stop();
+  // Supprime le fichier (recréé au prochain armement). Désarme.
+  bool clear();
+
+  // loopTask, fin de cycle pH/ORP. Sans effet si désarmé ; désarme à échéance.
+  void record(const SensorTraceRecord& rec);
+
+  // Écrit les enregistrements en attente. Retourne false si le fichier est
+  // inaccessible (enregistrements perdus, comptés dans dropped()).
+  bool flush();
+
+  // Téléchargement : taille du fichier après flush (0 si absent), puis
+  // lecture par blocs. readAt() retourne false si le mutex est occupé (bloc
+  // à redemander, `got` non significatif) ; sinon `got` octets lus (0 =
+  // fichier illisible).
+  size_t prepareDownload();
+  bool readAt(size_t offset, uint8_t* buf, size_t len, size_t& got);
+
+  bool active() const { return _active; }
+  uint32_t remainingMs() const;
+  uint32_t lastSeq() const { return _seq; }
+  uint16_t session() const { return _session; }
+  uint32_t dropped() const { return _dropped; }
+
+private:
+  bool _lock();
+  void _unlock();
+  bool _ensureFile();
+  bool _resumeCounters();
+  bool _flushLocked();
+
+  fs::FS* _fs = nullptr;
+  SemaphoreHandle_t _mutex = nullptr;
+  volatile bool _active = false;
+  uint32_t _armedAtMs = 0;
+  uint32_t _durationMs = 0;
+  uint32_t _seq = 0;            // Dernier seq attribué
+  uint16_t _session = 0;
+  bool _countersLoaded = false;
+  uint32_t _dropped = 0;
+  SensorTraceRecord _pending[kSensorTraceFlushRecords];
+  uint8_t _pendingCount = 0;
+};
+
+extern SensorTraceRecorder sensorTrace;
+
+#endif // SENSOR_TRACE_H
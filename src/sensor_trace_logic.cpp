@@ -0,0 +1,64 @@
+#include "sensor_trace_logic.h"
+
+uint8_t sensorTraceFlags(bool sampled, bool accepted, bool ready, bool unstable, bool frozen) {
+  uint8_t f = 0;
+  if (sampled)  f |= kTraceSampled;
+  if (accepted) f |= kTraceAccepted;
+  if (ready)    f |= kTraceReady;
+  if (unstable) f |= kTraceUnstable;
+  if (frozen)   f |= kTraceFrozen;
+  return f;
+}
+
+SensorTraceHeader sensorTraceMakeHeader(uint16_t capacity) {
+  SensorTraceHeader h = {};
+  h.magic = kSensorTraceMagic;
+  h.version = kSensorTraceVersion;
+  h.recordSize = sizeof(SensorTraceRecord);
+  h.capacity = capacity;
+  return h;
+}
+
+bool sensorTraceHeaderValid(const SensorTraceHeader& h, uint16_t capacity) {
+  return h.magic == kSensorTraceMagic && h.version == kSensorTraceVersion &&
+         h.recordSize == sizeof(SensorTraceRecord) && h.capacity == capacity &&
+         capacity > 0;
+}
+
+size_t sensorTraceFileSize(uint16_t capacity) {
+  return sizeof(SensorTraceHeader) + static_cast<size_t>(capacity) * sizeof(SensorTraceRecord);
+}
+
+size_t sensorTraceOffset(uint32_t seq, uint16_t capacity) {
+  if (capacity == 0 || seq == 0) return sizeof(SensorTraceHeader);
+  return sizeof(SensorTraceHeader) + ((seq - 1) % capacity) * sizeof(SensorTraceRecord);
+}
+
+void sensorTraceScan(const SensorTraceRecord* slots, size_t count,
+                     uint32_t* maxSeq, uint16_t* maxSession) {
+  uint32_t seq = 0;
+  uint16_t session = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if (slots[i].seq > seq) seq = slots[i].seq;
+    if (slots[i].seq != 0 && slots[i].session > session) session = slots[i].session;
+  }
+  if (maxSeq) *maxSeq = seq;
+  if (maxSession) *maxSession = session;
+}
+
+size_t sensorTraceOrder(const SensorTraceRecord* slots, size_t count, uint16_t* order) {
+  // Tri par insertion sur les indices : l'anneau est déjà ordonné à une
+  // rotation près, l'insertion y est quasi linéaire.
+  size_t n = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if (slots[i].seq == 0) continue;
+    size_t j = n;
+    while (j > 0 && slots[order[j - 1]].seq > slots[i].seq) {
+      order[j] = order[j - 1];
+      --j;
+    }
+    order[j] = static_cast<uint16_t>(i);
+    ++n;
+  }
+  return n;
+}
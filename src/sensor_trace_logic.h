@@ -0,0 +1,84 @@
+#ifndef SENSOR_TRACE_LOGIC_H
+#define SENSOR_TRACE_LOGIC_H
+
+// =============================================================================
+// sensor_trace_logic — Format de la trace capteurs (enregistreur + relecture), PURE
+// =============================================================================
+// Un enregistrement par cycle pH/ORP : bruts EZO, T° de compensation, et état
+// des filtres tel que le firmware l'a calculé. Le fichier (partition history)
+// est un anneau de taille FIXE :
+//
+//   [SensorTraceHeader 16 o][capacity × SensorTraceRecord 32 o]
+//
+// L'enregistrement de rang `seq` (1, 2, …) occupe le slot (seq-1) % capacity ;
+// seq = 0 marque un slot vide. Pas de tête de lecture dans l'en-tête : l'ordre
+// chronologique se reconstruit par seq croissant, ce qui rend le fichier
+// cohérent même s'il est lu pendant une écriture (un slot est écrit d'un bloc).
+// `session` s'incrémente à chaque armement : la relecture réinitialise ses
+// filtres au changement de session, comme le redémarrage du contrôleur.
+//
+// Structures en petit-boutiste, champs alignés sans bourrage : le binaire
+// téléchargé se relit tel quel sur PC (x86 / ARM).
+//
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <stddef.h>
+#include <stdint.h>
+
+constexpr uint32_t kSensorTraceMagic   = 0x43525453UL;  // "STRC"
+constexpr uint16_t kSensorTraceVersion = 1;
+
+struct SensorTraceHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t recordSize;
+  uint16_t capacity;
+  uint16_t reserved0;
+  uint32_t reserved1;
+};
+
+// Bits de SensorTraceRecord::phFlags / orpFlags.
+enum SensorTraceFlag : uint8_t {
+  kTraceSampled  = 1u << 0,  // Lecture EZO réussie → soumise au filtre
+  kTraceAccepted = 1u << 1,  // addSample() a accepté la brute
+  kTraceReady    = 1u << 2,  // ready() après le cycle
+  kTraceUnstable = 1u << 3,  // unstable() après le cycle
+  kTraceFrozen   = 1u << 4,  // frozen() après le cycle
+};
+
+struct SensorTraceRecord {
+  uint32_t seq;          // Rang 1.. (0 = slot vide)
+  uint32_t ms;           // millis() de fin de cycle
+  float phRaw;           // Brute pH (NaN si lecture ratée)
+  float orpRaw;          // Brute ORP mV (NaN si lecture ratée)
+  float tempC;           // T° de compensation envoyée à l'EZO pH
+  float phFiltered;      // SensorFilter::filtered() pH après le cycle
+  float orpFiltered;     // idem ORP
+  uint8_t phFlags;       // SensorTraceFlag
+  uint8_t orpFlags;
+  uint16_t session;      // Numéro d'armement (1..)
+};
+
+static_assert(sizeof(SensorTraceHeader) == 16, "en-tete trace : 16 octets");
+static_assert(sizeof(SensorTraceRecord) == 32, "enregistrement trace : 32 octets");
+
+uint8_t sensorTraceFlags(bool sampled, bool accepted, bool ready, bool unstable, bool frozen);
+
+// En-tête d'un fichier neuf / contrôle d'un fichier existant.
+SensorTraceHeader sensorTraceMakeHeader(uint16_t capacity);
+bool sensorTraceHeaderValid(const SensorTraceHeader& h, uint16_t capacity);
+
+// Taille totale du fichier et position de l'enregistrement `seq` (>= 1).
+size_t sensorTraceFileSize(uint16_t capacity);
+size_t sensorTraceOffset(uint32_t seq, uint16_t capacity);
+
+// Reprise après redémarrage : plus grands seq et session présents (0 si vide).
+void sensorTraceScan(const SensorTraceRecord* slots, size_t count,
+                     uint32_t* maxSeq, uint16_t* maxSession);
+
+// Indices des slots non vides par seq croissant (ordre chronologique) dans
+// `order` (capacité >= count). Retourne le nombre d'indices écrits.
+size_t sensorTraceOrder(const SensorTraceRecord* slots, size_t count, uint16_t* order);
+
+#endif // SENSOR_TRACE_LOGIC_H
@@ -1,39 +1,21 @@
 #include "sensors.h"
 
 #include <Preferences.h>
-#include <Wire.h>
-#include <esp_task_wdt.h>
 
 #include "config.h"
 #include "constants.h"
 #include "logger.h"
 #include "pump_controller.h"  // armStabilizationTimer() après calibration EZO
+#include "sensor_trace.h"
 
 SensorManager sensors;
 
 namespace {
 
 // =============================================================================
-// Helpers DS18B20 — Conservés tels quels (feature-020)
+// Helpers DS18B20 (feature-020)
 // =============================================================================
 
-// DS18B20 conversion time depends on resolution.
-// Typical max conversion times (datasheet):
-// 9-bit: 93.75ms, 10-bit: 187.5ms, 11-bit: 375ms, 12-bit: 750ms
-uint16_t ds18b20ConversionTimeMsForResolution(uint8_t resolutionBits) {
-  switch (resolutionBits) {
-    case 9:  return 94;
-    case 10: return 188;
-    case 11: return 375;
-    case 12:
-    default: return 750;
-  }
-}
-
-// Defaults (set in begin())
-uint8_t g_ds18b20ResolutionBits = 12;
-uint16_t g_ds18b20ConversionMs = 750;
-
 // Helper local : formate une adresse ROM 1-Wire en hex majuscule sans séparateur.
 // Doublon léger avec web_helpers::formatRomHex pour rester autoportant côté logs.
 String romHex(const uint8_t addr[kSondeAddrLen]) {
@@ -71,6 +53,8 @@ SensorManager::SensorManager() : oneWire(kTempSensorPin), tempSensor(&oneWire) {
     _sondes[i].present = false;
     _sondes[i].role = SondeRole::Unknown;
   }
+  _channels.add(_ph);
+  _channels.add(_orp);
 }
 
 SensorManager::~SensorManager() {
@@ -84,9 +68,45 @@ SensorManager::~SensorManager() {
 // begin() — Initialisation matériel
 // =============================================================================
 
+// Transaction synchrone sur le 1-Wire (DS18B20) : une étape, appelant suspendu.
+bool SensorManager::_runOneWire(uint32_t (*step)(I2cTxn&), void* ctx,
+                                I2cPriority prio, uint32_t timeoutMs) {
+  I2cTxn txn;
+  txn.devices = i2cDeviceBit(I2cDevice::OneWire);
+  txn.priority = prio;
+  txn.timeoutMs = timeoutMs;
+  txn.step = step;
+  txn.ctx = ctx;
+  return i2cBus.run(txn);
+}
+
+// Énumération 1-Wire (i2cTask, appelant suspendu) : remplit _sondes, sans log.
+void SensorManager::_probeDs18b20s() {
+  tempSensor.begin();
+  _ds18b20BusCount = tempSensor.getDeviceCount();
+
+  tempSensor.setWaitForConversion(false);
+  _dsParasite = tempSensor.isParasitePowerMode();
+  // Résolution par sonde : programmée au 1er cycle (_applySondeRoles()), par
+  // adresse — le setResolution() global relancerait une recherche du bus.
+
+  _detectedCount = 0;
+  uint8_t scanLimit = (_ds18b20BusCount > kMaxDs18b20Sondes) ? (uint8_t)kMaxDs18b20Sondes : _ds18b20BusCount;
+  for (uint8_t i = 0; i < scanLimit; ++i) {
+    uint8_t addr[kSondeAddrLen];
+    if (tempSensor.getAddress(addr, i)) {
+      memcpy(_sondes[_detectedCount].addr, addr, kSondeAddrLen);
+      _sondes[_detectedCount].lastTempRaw = NAN;
+      _sondes[_detectedCount].present = true;
+      _sondes[_detectedCount].role = SondeRole::Unknown;
+      _detectedCount++;
+    }
+  }
+}
+
 void SensorManager::begin() {
-  // Bus I²C partagé : DS3231 + EZO pH + EZO ORP (cf. constants.h kI2cSdaPin/kI2cSclPin)
-  Wire.begin();
+  // Bus I²C / 1-Wire : initialisés par i2cBus.begin() (main.cpp), tous les
+  // accès ci-dessous sont des transactions (ADR-0028).
 
   // Création de la queue FreeRTOS pour les commandes longues (calibration).
   _ezoQueue = xQueueCreate(kEzoQueueLen, sizeof(EzoCmdRequest));
@@ -95,9 +115,13 @@ void SensorManager::begin() {
   }
 
   // ----- DS18B20 (inchangé feature-020) -----
-  tempSensor.begin();
+  _runOneWire([](I2cTxn& t) -> uint32_t {
+    static_cast<SensorManager*>(t.ctx)->_probeDs18b20s();
+    t.ok = true;
+    return 0;
+  }, this, I2cPriority::OnDemand, kI2cTxnTimeoutMs);
+  const uint8_t deviceCount = _ds18b20BusCount;
 
-  uint8_t deviceCount = tempSensor.getDeviceCount();
   if (deviceCount == 0) {
     systemLogger.warning("DS18B20 non détecté sur GPIO " + String(kTempSensorPin) +
                          " - vérifier câblage et résistance pull-up 4.7kΩ");
@@ -109,28 +133,14 @@ void SensorManager::begin() {
                            ") - seules les " + String(kMaxDs18b20Sondes) + " premières seront prises en compte");
     }
   }
-
-  tempSensor.setWaitForConversion(false);
-  g_ds18b20ResolutionBits = 12;
-  tempSensor.setResolution(g_ds18b20ResolutionBits);
-  g_ds18b20ConversionMs = ds18b20ConversionTimeMsForResolution(g_ds18b20ResolutionBits);
-
-  _detectedCount = 0;
-  uint8_t scanLimit = (deviceCount > kMaxDs18b20Sondes) ? (uint8_t)kMaxDs18b20Sondes : deviceCount;
-  for (uint8_t i = 0; i < scanLimit; ++i) {
-    uint8_t addr[kSondeAddrLen];
-    if (tempSensor.getAddress(addr, i)) {
-      memcpy(_sondes[_detectedCount].addr, addr, kSondeAddrLen);
-      _sondes[_detectedCount].lastTempRaw = NAN;
-      _sondes[_detectedCount].present = true;
-      _sondes[_detectedCount].role = SondeRole::Unknown;
-      _detectedCount++;
-    } else {
-      systemLogger.warning("DS18B20 index " + String(i) + " : impossible de lire l'adresse ROM");
-    }
+  const uint8_t scanLimit = (deviceCount > kMaxDs18b20Sondes) ? (uint8_t)kMaxDs18b20Sondes : deviceCount;
+  if (_detectedCount < scanLimit) {
+    systemLogger.warning("DS18B20 : " + String(scanLimit - _detectedCount) +
+                         " adresse(s) ROM illisible(s)");
   }
 
   _loadSondeIdentificationFromNvs();
+  _applySondeRoles();
 
   for (uint8_t i = 0; i < _detectedCount; ++i) {
     systemLogger.info("  - sonde[" + String(i) + "] = " + romHex(_sondes[i].addr) +
@@ -138,48 +148,40 @@ void SensorManager::begin() {
   }
 
   systemLogger.info("Capteur de température DS18B20 initialisé sur GPIO " + String(kTempSensorPin) +
-                    " (" + String(g_ds18b20ResolutionBits) + "-bit, conv=" +
-                    String(g_ds18b20ConversionMs) + "ms)");
+                    " (eau " + String(kDs18b20WaterResolutionBits) + "-bit, circuit " +
+                    String(kDs18b20CircuitResolutionBits) + "-bit, " +
+                    (_dsParasite ? "alimentation parasite : attente fixe" : "fin de conversion scrutée") + ")");
 
-  // ----- Atlas EZO pH / ORP -----
+  // ----- Voies Atlas EZO (pH, ORP) -----
   // AC5 (résilience EZO débranché) : on ne bloque pas le boot si un EZO est muet.
   // Une simple lecture I (info) suffit à confirmer la présence du module.
-  String fwInfo;
-  if (_phEzo.readInfo(fwInfo)) {
-    systemLogger.info("EZO pH détecté : " + fwInfo);
-    _ezoEverResponded = true;
-    // feature-024 : 1ʳᵉ query Slope,? différée via la queue EZO.
-    // Sera traitée au prochain tick _processEzoQueue() — n'allonge pas le boot.
-    enqueuePhSlopeQuery();
-  } else {
-    systemLogger.warning("EZO pH non détecté à l'adresse 0x" + String(kEzoPhAddress, HEX) +
-                         " - lectures pH désactivées tant que la sonde n'est pas connectée");
-  }
-
-  if (_orpEzo.readInfo(fwInfo)) {
-    systemLogger.info("EZO ORP détecté : " + fwInfo);
-    _ezoEverResponded = true;
-  } else {
-    systemLogger.warning("EZO ORP non détecté à l'adresse 0x" + String(kEzoOrpAddress, HEX) +
-                         " - lectures ORP désactivées tant que la sonde n'est pas connectée");
-  }
-
-  // Lecture initiale du nombre de points de calibration (cache).
-  // pool-chemistry condition #2 : si Cal,? injoignable → -1 → régulation auto inhibée.
-  _phCalCachedPoints = _phEzo.queryCalPoints();
-  _orpCalCachedPoints = _orpEzo.queryCalPoints();
+  for (size_t i = 0; i < _channels.size(); ++i) {
+    SensorChannel& ch = _channels[i];
+    const String name = ch.driver().name();
+    const String label = ch.info().label;
+    char fwInfo[32];
+    if (ch.driver().identify(fwInfo, sizeof(fwInfo))) {
+      systemLogger.info(name + " détecté : " + fwInfo);
+      _ezoEverResponded = true;
+      // feature-024 : 1ʳᵉ query Slope,? différée via la queue EZO.
+      // Sera traitée au prochain tick _processEzoQueue() — n'allonge pas le boot.
+      if (&ch == &_ph) enqueuePhSlopeQuery();
+    } else {
+      systemLogger.warning(name + " non détecté - lectures " + label +
+                           " désactivées tant que la sonde n'est pas connectée");
+    }
 
-  if (_phCalCachedPoints <= 0) {
-    systemLogger.critical("EZO pH non calibré (Cal,?=" + String(_phCalCachedPoints) +
-                          ") — régulation pH automatique inhibée jusqu'à calibration");
-  } else {
-    systemLogger.info("EZO pH calibration : " + String(_phCalCachedPoints) + " point(s)");
-  }
-  if (_orpCalCachedPoints <= 0) {
-    systemLogger.critical("EZO ORP non calibré (Cal,?=" + String(_orpCalCachedPoints) +
-                          ") — régulation ORP automatique inhibée jusqu'à calibration");
-  } else {
-    systemLogger.info("EZO ORP calibration : " + String(_orpCalCachedPoints) + " point(s)");
+    // Lecture initiale du nombre de points de calibration (cache).
+    // pool-chemistry condition #2 : si Cal,? injoignable → -1 → régulation auto inhibée.
+    const int points = ch.driver().queryCalPoints();
+    ch.setCalPoints(points);
+    if (points <= 0) {
+      systemLogger.critical(name + " non calibré (Cal,?=" + String(points) +
+                            ") — régulation " + label +
+                            " automatique inhibée jusqu'à calibration");
+    } else {
+      systemLogger.info(name + " calibration : " + String(points) + " point(s)");
+    }
   }
 
   systemLogger.info("Gestionnaire de capteurs initialisé (DS18B20 + Atlas EZO)");
@@ -190,19 +192,12 @@ void SensorManager::begin() {
 // =============================================================================
 
 void SensorManager::update() {
-  // 1) Lecture DS18B20 (gère son propre timing de conversion)
-  _readDs18b20s();
+  // 1) Cycle DS18B20 (transaction asynchrone, fin de conversion scrutée)
+  _stepDs18b20Cycle();
 
-  // 2) Lecture pH/ORP via EZO (cadencée à kPhOrpSensorIntervalMs = 5 s)
-  static unsigned long lastEzoRead = 0;
-  unsigned long now = millis();
-  if (now - lastEzoRead >= kPhOrpSensorIntervalMs) {
-    lastEzoRead = now;
-    // Compensation T° : sonde "eau" si identifiée, sinon fallback 25 °C (cf. spec).
-    float tempC = getWaterTemperature();
-    if (isnan(tempC)) tempC = kEzoFallbackTempC;
-    _readEzoSensors(tempC);
-  }
+  // 2) Lecture pH/ORP via EZO (cycle démarré toutes les kPhOrpSensorIntervalMs
+  //    = 5 s, non bloquant : le bus est libre pendant la conversion).
+  _stepEzoCycle();
 
   // 3) Détection de stale (log critical une fois à la transition)
   _checkStaleAndLog();
@@ -210,18 +205,23 @@ void SensorManager::update() {
   // 3bis) feature-022 : détection capteur figé (logs edge-triggered)
   _checkFrozenAndLog();
 
-  // 4) Traitement d'au plus 1 commande EZO de la queue (calibration ~1-2 s)
+  // 4) Traitement d'au plus 1 commande EZO de la queue. Une calibration ne
+  //    fait qu'entrer dans _calFlow ; Slope,? part en transaction soumise.
   _processEzoQueue();
+  _stepEzoQuery();
+
+  // 4bis) Calibration en cours : attente de stabilité, puis transaction
+  //    Urgent (passe devant le prochain cycle de lecture ; un cycle déjà en
+  //    conversion garde les EZO réservés jusqu'à la relève). Non bloquant.
+  _stepCalibration();
 
   // 5) feature-024 : re-query Slope,? automatique toutes les 24h.
   // Conditions : 1ʳᵉ query déjà réussie (_phSlopeQueriedMs != 0), pas de query
   // en attente (_phSlopeQueryPending=false), et délai écoulé.
   //
-  // BUG FIX : `now` doit être rafraîchi APRÈS _processEzoQueue() qui peut bloquer
-  // ~900 ms sur une commande I²C. Sans ce rafraîchissement, si le handler met à
-  // jour _phSlopeQueriedMs = millis() à T+900ms, on a now=T < _phSlopeQueriedMs
-  // → underflow uint32_t sur (now - _phSlopeQueriedMs) → ~4.3 milliards → >= 24h
-  // → ré-enqueue immédiate → boucle infinie de query Slope toutes les ~secondes.
+  // `now` relu APRÈS les bilans de requête qui posent _phSlopeQueriedMs = millis() :
+  // un `now` antérieur donnerait un underflow uint32_t sur (now - _phSlopeQueriedMs)
+  // → ~4.3 milliards → >= 24h → ré-enqueue immédiate en boucle.
   unsigned long nowAfterQueue = millis();
   if (_phSlopeQueriedMs != 0 && !_phSlopeQueryPending &&
       nowAfterQueue >= _phSlopeQueriedMs &&  // garde anti-underflow
@@ -231,221 +231,441 @@ void SensorManager::update() {
 }
 
 // =============================================================================
-// Lecture DS18B20 (multi-sondes feature-020) — Logique inchangée
+// Lecture DS18B20 (multi-sondes feature-020) — cycle asynchrone par sonde
 // =============================================================================
 
-void SensorManager::_readDs18b20s() {
-  unsigned long now = millis();
-  static unsigned long lastTempDebugLog = 0;
-  static unsigned long lastTempRequest = 0;
-  static bool tempRequested = false;
-  static unsigned long lastTempRead = 0;
-
-  const unsigned long TEMP_CONVERSION_MS = (unsigned long)g_ds18b20ConversionMs + 50;
-  const unsigned long TEMP_REQUEST_INTERVAL_MS = 2000;
-
-  // 1) Lancer une conversion si aucune n'est en cours et si l'intervalle est passé.
-  //    On prend le mutex I²C uniquement le temps de l'envoi (la conversion se fait
-  //    en arrière-plan côté DS18B20, pas besoin de tenir le bus).
-  if (!tempRequested && (now - lastTempRequest >= TEMP_REQUEST_INTERVAL_MS)) {
-    if (xSemaphoreTake(i2cMutex, pdMS_TO_TICKS(50)) == pdTRUE) {
-      tempSensor.requestTemperatures();
-      xSemaphoreGive(i2cMutex);
-      tempRequested = true;
-      lastTempRequest = now;
-    }
+// Résolution et cadence selon le rôle (ds18b20_logic). Appelée au boot, puis
+// par loopTask après un changement d'identification (_dsRolesChanged, posé
+// par les routes web) : la résolution est reprogrammée et la sonde relue dès
+// le prochain tour.
+void SensorManager::_applySondeRoles() {
+  for (uint8_t i = 0; i < _detectedCount; ++i) {
+    const bool circuit = _sondes[i].role == SondeRole::Circuit;
+    _dsSchedule.setInterval(i, circuit ? kDs18b20CircuitIntervalMs : kTempSensorIntervalMs);
+    _dsSchedule.forget(i);
+    _dsResDirty |= (uint8_t)(1u << i);
   }
+}
 
-  // 2) Lecture après le délai de conversion. Multi-sondes par adresse ROM.
-  if (tempRequested && (now - lastTempRequest >= TEMP_CONVERSION_MS)) {
-    if (xSemaphoreTake(i2cMutex, pdMS_TO_TICKS(50)) == pdTRUE) {
-      bool anyValidRead = false;
-      for (uint8_t i = 0; i < _detectedCount; ++i) {
-        float measuredTemp = tempSensor.getTempC(_sondes[i].addr);
-        // 85.0 °C = power-on reset value DS18B20 (conversion incomplète).
-        bool valid = (measuredTemp != DEVICE_DISCONNECTED_C &&
-                      measuredTemp > -55.0f && measuredTemp < 125.0f &&
-                      measuredTemp != 85.0f);
-        if (valid) {
-          _sondes[i].lastTempRaw = roundf(measuredTemp * 10.0f) / 10.0f;
-          anyValidRead = true;
-          // feature-022 : alimente le détecteur figé T° eau avec la valeur BRUTE
-          // (non arrondie au 0.1 °C — l'epsilon 0.03 °C est < ½ LSB DS18B20 0.0625,
-          // le bruit de quantification d'une sonde vivante doit casser le run).
-          // Seules les lectures VALIDES alimentent le détecteur (frozen persiste
-          // pendant une rafale de lectures invalides — cohérent condition #4).
-          if (_sondes[i].role == SondeRole::Water) {
-            _waterTempFrozen.addSample(measuredTemp);
-          }
-        } else {
-          _sondes[i].lastTempRaw = NAN;
-          if (authCfg.sensorLogsEnabled) {
-            systemLogger.warning("DS18B20 " + romHex(_sondes[i].addr) +
-                                 " : lecture invalide (déconnectée ou T° hors plage)");
-          }
-        }
-      }
-      xSemaphoreGive(i2cMutex);
-
-      // Mise à jour des champs rétrocompat tempRawValue/tempValue (alias eau).
-      int waterIdx = _findSondeIndexByRole(SondeRole::Water);
-      if (waterIdx >= 0 && !isnan(_sondes[waterIdx].lastTempRaw)) {
-        tempRawValue = _sondes[waterIdx].lastTempRaw;
-        tempValue = tempRawValue + mqttCfg.tempCalibrationOffset;
-      } else {
-        // Fallback gracieux : 1ʳᵉ sonde présente sans offset (rôle inconnu).
-        tempRawValue = NAN;
-        tempValue = NAN;
-        for (uint8_t i = 0; i < _detectedCount; ++i) {
-          if (!isnan(_sondes[i].lastTempRaw)) {
-            tempRawValue = _sondes[i].lastTempRaw;
-            tempValue = tempRawValue;
-            break;
-          }
-        }
-      }
-
-      if (!anyValidRead && _detectedCount > 0 && authCfg.sensorLogsEnabled) {
-        systemLogger.warning("Aucune sonde DS18B20 n'a fourni de lecture valide ce cycle");
-      }
-
-      tempRequested = false;
-      lastTempRead = now;
-    }
+// Cycle DS18B20 = une transaction périodique sur le 1-Wire, soumise quand une
+// sonde est due. Le bus I²C reste libre pendant la conversion ; le 1-Wire
+// n'est occupé que le temps des trames (Convert T, bit de fin, scratchpads).
+void SensorManager::_stepDs18b20Cycle() {
+  const uint32_t now = millis();
+  const I2cTxnState state = _dsTxn.state;
+  if (state == I2cTxnState::Done || state == I2cTxnState::Expired) {
+    _dsTxn.state = I2cTxnState::Idle;
+    _finishDs18b20Cycle(state == I2cTxnState::Done, now);
   }
 
   // Debug température (toutes les 5 s, si activé)
+  static unsigned long lastTempDebugLog = 0;
   if (authCfg.sensorLogsEnabled && now - lastTempDebugLog >= 5000) {
     char logMsg[150];
     if (!isnan(tempValue)) {
       snprintf(logMsg, sizeof(logMsg),
-               "Temp: %.2f°C | res=%dbit | age=%lums",
-               tempValue, (int)g_ds18b20ResolutionBits, (unsigned long)(now - lastTempRead));
+               "Temp: %.2f°C | conv=%lums (max %lums) | age=%lums",
+               tempValue, (unsigned long)_dsConv.lastConversionMs(),
+               (unsigned long)_dsConv.maxConversionMs(), (unsigned long)(now - _waterTempMs));
       systemLogger.debug(logMsg);
     } else {
       snprintf(logMsg, sizeof(logMsg),
-               "Temp: NaN | res=%dbit | conversion=%s",
-               (int)g_ds18b20ResolutionBits, tempRequested ? "EN COURS" : "IDLE");
+               "Temp: NaN | conversion=%s | échéances=%lu",
+               _dsTxn.state == I2cTxnState::Pending ? "EN COURS" : "IDLE",
+               (unsigned long)_dsConv.timeoutCount());
       systemLogger.warning(logMsg);
     }
     lastTempDebugLog = now;
   }
+
+  if (_dsTxn.state == I2cTxnState::Pending) return;
+  if (_dsRolesChanged) {
+    _dsRolesChanged = false;
+    _applySondeRoles();
+  }
+  uint8_t due = _dsSchedule.dueMask(now, _detectedCount);
+  if (due == 0) return;
+  // Alimentation parasite : la conversion d'une sonde est coupée par la trame
+  // suivante, une seule Convert T pour toutes.
+  if (_dsParasite) due = (uint8_t)((1u << _detectedCount) - 1);
+
+  _dsJob = Ds18b20Job{};
+  _dsJob.mask = due;
+  _dsJob.resMask = _dsResDirty & due;
+  for (uint8_t i = 0; i < _detectedCount; ++i) {
+    _dsJob.bits[i] = (_sondes[i].role == SondeRole::Circuit) ? kDs18b20CircuitResolutionBits
+                                                              : kDs18b20WaterResolutionBits;
+  }
+
+  _dsTxn.devices = i2cDeviceBit(I2cDevice::OneWire);
+  _dsTxn.priority = I2cPriority::Periodic;
+  _dsTxn.timeoutMs = kDs18b20TxnTimeoutMs;  // Retentée au tour suivant
+  _dsTxn.step = &SensorManager::_ds18b20CycleStep;
+  _dsTxn.ctx = this;
+  if (!i2cBus.submit(_dsTxn)) {
+    _dsTxn.state = I2cTxnState::Idle;
+  }
 }
 
-// =============================================================================
-// Lecture pH / ORP via Atlas EZO
-// =============================================================================
+// i2cTask. Étape 0 : résolutions à reprogrammer puis Convert T (skip ROM si
+// toutes les sondes sont dues, sinon par adresse). Étapes suivantes : bit de
+// fin de conversion, puis relève des scratchpads par adresse ROM mémorisée.
+uint32_t SensorManager::_ds18b20CycleStep(I2cTxn& txn) {
+  SensorManager* self = static_cast<SensorManager*>(txn.ctx);
+  Ds18b20Job& job = self->_dsJob;
+  OneWire& ow = self->oneWire;
+  const uint32_t now = millis();
+  const uint8_t all = (uint8_t)((1u << self->_detectedCount) - 1);
+
+  if (txn.stage == 0) {
+    uint8_t maxBits = kDs18b20MinResolution;
+    for (uint8_t i = 0; i < self->_detectedCount; ++i) {
+      const uint8_t bit = (uint8_t)(1u << i);
+      if (!(job.mask & bit)) continue;
+      // Écrit seulement si le registre diffère ; pas de recherche du bus.
+      if ((job.resMask & bit) &&
+          !self->tempSensor.setResolution(self->_sondes[i].addr, job.bits[i], true)) {
+        job.resMask &= (uint8_t)~bit;
+      }
+      if (job.bits[i] > maxBits) maxBits = job.bits[i];
+    }
 
-void SensorManager::_readEzoSensors(float tempC) {
-  unsigned long now = millis();
-
-  // ----- pH -----
-  float ph = NAN;
-  if (_phEzo.readSingle(ph, tempC)) {
-    _lastPh = ph;
-    _lastPhMs = now;
-    _phI2cFailStreak = 0;
-    // feature-025 : alimenter le filtre pH (médiane + EMA + rejet pics).
-    // En cas de fail-streak I²C ci-dessous, on N'alimente PAS → le filtre devient
-    // non prêt par âge (kSensorFilterMaxAgeMs) et canDose() bloque (fail-closed).
-    _phFilter.addSample(ph, (uint32_t)now);
-    _phStaleLogged = false;
-    _phI2cDegradedLogged = false;
-    _ezoEverResponded = true;
-    // Correctif Pass 3.5 (pool-chemistry) : si le cache cal_points a été invalidé
-    // à -1 par une période de bus dégradé (ou n'a jamais été initialisé), on le
-    // rafraîchit dès qu'un retour de bus est confirmé. Strictement borné à -1 →
-    // un seul Cal,? est émis (et non chaque cycle, ce qui gèlerait loopTask 900 ms).
-    if (_phCalCachedPoints == -1) {
-      int pts = _phEzo.queryCalPoints();
-      if (pts >= 0) {
-        _phCalCachedPoints = pts;
-        systemLogger.info("EZO pH : cache calibration rafraîchi (points=" +
-                          String(pts) + ")");
+    bool present = false;
+    if (job.mask == all) {
+      if (ow.reset()) {
+        ow.skip();
+        ow.write(kDs18b20CmdConvertT, self->_dsParasite ? 1 : 0);
+        present = true;
+      }
+    } else {
+      for (uint8_t i = 0; i < self->_detectedCount; ++i) {
+        if (!(job.mask & (1u << i)) || !ow.reset()) continue;
+        ow.select(self->_sondes[i].addr);
+        ow.write(kDs18b20CmdConvertT, 0);
+        present = true;
       }
     }
+    if (!present) {
+      txn.ok = false;  // Aucune présence sur le bus : relève inutile
+      return 0;
+    }
+    txn.stage = 1;
+    return self->_dsConv.start(now, maxBits, !self->_dsParasite);
+  }
+
+  const bool done = !self->_dsParasite && self->tempSensor.isConversionComplete();
+  const uint32_t waitMs = self->_dsConv.onPoll(now, done);
+  if (waitMs > 0) return waitMs;
+
+  for (uint8_t i = 0; i < self->_detectedCount; ++i) {
+    if (!(job.mask & (1u << i))) continue;
+    uint8_t sp[kDs18b20ScratchpadLen];
+    if (!self->tempSensor.readScratchPad(self->_sondes[i].addr, sp)) {
+      memset(sp, 0xFF, sizeof(sp));  // Pas de présence : décodé en CRC invalide
+    }
+    job.status[i] = ds18b20DecodeScratchpad(sp, &job.temps[i], &job.readBits[i]);
+  }
+  job.read = true;
+  txn.ok = true;
+  return 0;
+}
+
+// Bilan du cycle (loopTask). ran=false : la transaction n'a pas démarré avant
+// son échéance — rien n'est consommé, les sondes restent dues.
+void SensorManager::_finishDs18b20Cycle(bool ran, uint32_t now) {
+  if (!ran) return;
+  _dsSchedule.requested(_dsJob.mask, now);
+  if (!_dsJob.read) {
+    for (uint8_t i = 0; i < _detectedCount; ++i) {
+      if (_dsJob.mask & (1u << i)) _sondes[i].lastTempRaw = NAN;
+    }
     if (authCfg.sensorLogsEnabled) {
-      char buf[80];
-      snprintf(buf, sizeof(buf), "EZO pH: %.2f (T=%.1f°C)", ph, tempC);
-      systemLogger.debug(buf);
+      systemLogger.warning("DS18B20 : aucune présence sur le bus 1-Wire");
     }
-  } else {
-    _phI2cFailStreak++;
-    if (_phI2cFailStreak == kEzoBusFailMaxConsecutive) {
-      // Logger une seule fois quand on franchit le seuil — au-delà, silence
-      // pour ne pas inonder les logs en cas de débranchement durable.
-      systemLogger.warning("EZO pH : " + String(_phI2cFailStreak) +
-                           " échecs I²C consécutifs — dosage pH bloqué");
+  }
+
+  bool anyValidRead = false;
+  for (uint8_t i = 0; _dsJob.read && i < _detectedCount; ++i) {
+    const uint8_t bit = (uint8_t)(1u << i);
+    if (!(_dsJob.mask & bit)) continue;
+    const Ds18b20ReadStatus st = _dsJob.status[i];
+    if (st != Ds18b20ReadStatus::BadCrc && st != Ds18b20ReadStatus::AllZero) {
+      // Registre relu : une sonde réinitialisée (coupure) reprend sa
+      // résolution EEPROM → reprogrammée au prochain cycle.
+      if (_dsJob.readBits[i] == _dsJob.bits[i]) {
+        _dsResDirty &= (uint8_t)~bit;
+      } else {
+        _dsResDirty |= bit;
+      }
     }
-    // Cond #5 pool-chemistry : invalider explicitement la lecture si bus dégradé.
-    // Sans ça, getPh() pourrait retourner une valeur "fraîche" pendant la fenêtre
-    // stale (20 s) alors que le bus I²C est en panne durable. canDose() doit
-    // bloquer immédiatement → on fait passer _lastPh à NaN.
-    if (_phI2cFailStreak >= kEzoBusFailMaxConsecutive) {
-      _lastPh = NAN;
-      // Correctif Pass 3.5 (pool-chemistry) : invalider aussi le cache cal_points.
-      // Sinon, après une coupure I²C transitoire, canDose() pourrait reposer sur
-      // un cache obsolète (ex. cal effacée pendant la coupure côté EZO). On
-      // remet -1 → canDose() bloque jusqu'à un Cal,? réussi au retour de bus.
-      _phCalCachedPoints = -1;
-      // feature-024 : cohérence avec _phCalCachedPoints — invalider aussi le
-      // cache pente. La pente n'a aucun sens tant que le bus EZO pH est dégradé.
-      _phSlopeAcid = NAN;
-      _phSlopeBase = NAN;
-      _phSlopeZero = NAN;
-      if (!_phI2cDegradedLogged) {
-        systemLogger.critical("EZO pH : bus I²C dégradé (" + String(_phI2cFailStreak) +
-                              " échecs) — lecture invalidée, régulation auto inhibée");
-        _phI2cDegradedLogged = true;
+    const float measuredTemp = _dsJob.temps[i];
+    const bool valid = st == Ds18b20ReadStatus::Ok &&
+                       measuredTemp > -55.0f && measuredTemp < 125.0f;
+    if (valid) {
+      _sondes[i].lastTempRaw = roundf(measuredTemp * 10.0f) / 10.0f;
+      anyValidRead = true;
+      // feature-022 : alimente le détecteur figé T° eau avec la valeur BRUTE
+      // (non arrondie au 0.1 °C — l'epsilon 0.03 °C est < ½ LSB DS18B20 0.0625,
+      // le bruit de quantification d'une sonde vivante doit casser le run).
+      // Seules les lectures VALIDES alimentent le détecteur (frozen persiste
+      // pendant une rafale de lectures invalides — cohérent condition #4).
+      if (_sondes[i].role == SondeRole::Water) {
+        _waterTempFrozen.addSample(measuredTemp);
+      }
+    } else {
+      _sondes[i].lastTempRaw = NAN;
+      if (authCfg.sensorLogsEnabled) {
+        systemLogger.warning("DS18B20 " + romHex(_sondes[i].addr) + " : lecture invalide (" +
+                             (st == Ds18b20ReadStatus::PowerOnReset ? "85 °C, sonde réinitialisée"
+                              : st == Ds18b20ReadStatus::Ok         ? "T° hors plage"
+                                                                    : "déconnectée ou CRC") + ")");
       }
     }
   }
 
-  // ----- ORP -----
-  float orp = NAN;
-  if (_orpEzo.readSingle(orp, tempC)) {
-    _lastOrp = orp;
-    _lastOrpMs = now;
-    _orpI2cFailStreak = 0;
-    // feature-025 : alimenter le filtre ORP (cf. commentaire pH ci-dessus).
-    _orpFilter.addSample(orp, (uint32_t)now);
-    _orpStaleLogged = false;
-    _orpI2cDegradedLogged = false;
-    _ezoEverResponded = true;
-    // Correctif Pass 3.5 : rafraîchissement borné du cache cal_points ORP
-    // (idem pH, cf. commentaire ci-dessus).
-    if (_orpCalCachedPoints == -1) {
-      int pts = _orpEzo.queryCalPoints();
-      if (pts >= 0) {
-        _orpCalCachedPoints = pts;
-        systemLogger.info("EZO ORP : cache calibration rafraîchi (points=" +
-                          String(pts) + ")");
+  // Mise à jour des champs rétrocompat tempRawValue/tempValue (alias eau).
+  int waterIdx = _findSondeIndexByRole(SondeRole::Water);
+  if (waterIdx >= 0 && !isnan(_sondes[waterIdx].lastTempRaw)) {
+    tempRawValue = _sondes[waterIdx].lastTempRaw;
+    tempValue = tempRawValue + mqttCfg.tempCalibrationOffset;
+  } else {
+    // Fallback gracieux : 1ʳᵉ sonde présente sans offset (rôle inconnu).
+    tempRawValue = NAN;
+    tempValue = NAN;
+    for (uint8_t i = 0; i < _detectedCount; ++i) {
+      if (!isnan(_sondes[i].lastTempRaw)) {
+        tempRawValue = _sondes[i].lastTempRaw;
+        tempValue = tempRawValue;
+        break;
       }
     }
+  }
+  if (waterIdx >= 0 && (_dsJob.mask & (1u << waterIdx)) && !isnan(_sondes[waterIdx].lastTempRaw)) {
+    _waterTempMs = now;
+  }
+
+  if (_dsJob.read && !anyValidRead && _detectedCount > 0 && authCfg.sensorLogsEnabled) {
+    systemLogger.warning("Aucune sonde DS18B20 n'a fourni de lecture valide ce cycle");
+  }
+}
+
+uint32_t SensorManager::getWaterTempAgeMs() const {
+  if (_waterTempMs == 0) return UINT32_MAX;
+  return millis() - _waterTempMs;
+}
+
+// =============================================================================
+// Lecture pH / ORP via Atlas EZO
+// =============================================================================
+
+// Cycle pH/ORP = une transaction périodique qui réserve les deux EZO. Ses
+// étapes (i2cTask) n'occupent le bus que le temps des trames ; pendant les
+// 300 ms (T) / 900 ms (R) de traitement EZO, l'ordonnanceur sert le RTC et le
+// DS18B20, et une calibration en file passe juste après la relève. pH et ORP
+// convertissent en même temps : une seule attente de 900 ms au lieu de deux.
+void SensorManager::_stepEzoCycle() {
+  const I2cTxnState state = _ezoTxn.state;
+  if (state == I2cTxnState::Pending) return;
+
+  const uint32_t now = millis();
+  if (state == I2cTxnState::Done || state == I2cTxnState::Expired) {
+    _ezoTxn.state = I2cTxnState::Idle;
+    _finishEzoCycle(state == I2cTxnState::Done, now);
+  }
+
+  if (_ezoCycle.poll(now) != EzoCycleStep::Start) return;
+
+  // Compensation T° : sonde "eau" si identifiée, sinon fallback 25 °C (cf. spec).
+  float tempC = getWaterTemperature();
+  if (isnan(tempC)) tempC = kEzoFallbackTempC;
+  // "T,<t>" seulement si la T° eau a bougé (ou module à resynchroniser).
+  // Non acquitté : retenté au cycle suivant ; la lecture part quand même,
+  // compensée avec la dernière T° acceptée par le module.
+  _ezoJob = EzoCycleJob{};
+  _ezoJob.tempC = tempC;
+  _ezoJob.pushTemp = _phTempComp.shouldPush(tempC, now);
+
+  for (size_t i = 0; i < _channels.size(); ++i) _channels[i].cycle = SensorChannel::Cycle{};
+  _ezoTxn.devices = _channels.devices();
+  _ezoTxn.priority = I2cPriority::Periodic;
+  _ezoTxn.timeoutMs = kPhOrpSensorIntervalMs;  // Obsolète au cycle suivant
+  _ezoTxn.step = &SensorManager::_ezoCycleStep;
+  _ezoTxn.ctx = this;
+  _ezoSubmitMs = now;
+  if (!i2cBus.submit(_ezoTxn)) {
+    _ezoTxn.state = I2cTxnState::Idle;
+    _finishEzoCycle(false, now);
+  }
+}
+
+// Bilan du cycle (loopTask). ran=false : la transaction n'a pas démarré
+// (bus saturé jusqu'à l'échéance) — échec de toutes les voies, comme une
+// lecture ratée : alimente les fail-streaks (condition #5).
+void SensorManager::_finishEzoCycle(bool ran, uint32_t now) {
+  if (!ran) {
+    // Cycle jamais démarré : clos ici pour garder la cadence.
+    _ezoCycle.finished(now);
+    for (size_t i = 0; i < _channels.size(); ++i) {
+      SensorChannel& ch = _channels[i];
+      _applyReading(ch, false, NAN, now);
+      ch.health().onRead(false, false, NAN, kSensorHealthNoLatency, now);
+    }
+    _recordTrace(NAN, now);
+    return;
+  }
+  if (_ezoJob.tempAcked) {
+    _phTempComp.pushed(_ezoJob.tempC, now);
     if (authCfg.sensorLogsEnabled) {
-      char buf[80];
-      snprintf(buf, sizeof(buf), "EZO ORP: %.0f mV", orp);
+      char buf[64];
+      snprintf(buf, sizeof(buf), "EZO pH : compensation T=%.1f°C", _phTempComp.appliedTemp());
       systemLogger.debug(buf);
     }
-  } else {
-    _orpI2cFailStreak++;
-    if (_orpI2cFailStreak == kEzoBusFailMaxConsecutive) {
-      systemLogger.warning("EZO ORP : " + String(_orpI2cFailStreak) +
-                           " échecs I²C consécutifs — dosage ORP bloqué");
+  }
+  // Cycle déjà clos par i2cTask : un Cal,? émis par _applyReading()
+  // (rafraîchissement de cache) ne croise pas de conversion.
+  // Latence vue de l'application : attente en file + conversion + bilan.
+  const uint32_t latencyMs = now - _ezoSubmitMs;
+  for (size_t i = 0; i < _channels.size(); ++i) {
+    SensorChannel& ch = _channels[i];
+    const SensorChannel::Cycle c = ch.cycle;
+    _applyReading(ch, c.ok, c.value, now);
+    ch.health().onRead(c.ok, ch.lastAccepted(), c.value, latencyMs, now);
+  }
+  _recordTrace(_ezoJob.tempC, now);
+}
+
+// Trace capteurs (sensor_trace.h) : entrée brute du filtre et état qu'il en a
+// tiré, de quoi rejouer la chaîne hors ligne. Sans effet si non armée.
+// Format d'enregistrement fixe (pH, ORP, T°) : lu sur les voies pH / ORP.
+void SensorManager::_recordTrace(float tempC, uint32_t now) {
+  if (!sensorTrace.active()) return;
+  SensorTraceRecord rec = {};
+  rec.ms = now;
+  rec.phRaw = _ph.cycle.ok ? _ph.cycle.value : NAN;
+  rec.orpRaw = _orp.cycle.ok ? _orp.cycle.value : NAN;
+  rec.tempC = tempC;
+  rec.phFiltered = _phFilter.filtered();
+  rec.orpFiltered = _orpFilter.filtered();
+  rec.phFlags = sensorTraceFlags(_ph.cycle.ok, _ph.lastAccepted(), _phFilter.ready(now),
+                                 _phFilter.unstable(), _phFilter.frozen());
+  rec.orpFlags = sensorTraceFlags(_orp.cycle.ok, _orp.lastAccepted(), _orpFilter.ready(now),
+                                  _orpFilter.unstable(), _orpFilter.frozen());
+  sensorTrace.record(rec);
+}
+
+uint32_t SensorManager::_ezoCycleStep(I2cTxn& txn) {
+  SensorManager* self = static_cast<SensorManager*>(txn.ctx);
+  EzoCycleJob& job = self->_ezoJob;
+  EzoReadCycle& cycle = self->_ezoCycle;
+  const uint32_t t0 = micros();
+  const uint32_t now = millis();
+  uint32_t waitMs = 0;
+
+  // 1ʳᵉ étape : le cycle démarre ici (après l'attente éventuelle en file).
+  const EzoCycleStep step = cycle.busy() ? cycle.poll(now) : EzoCycleStep::Start;
+  switch (step) {
+    case EzoCycleStep::Start:
+      if (job.pushTemp && self->_phEzo.startTempCompensation(job.tempC)) {
+        cycle.tempIssued(now);
+        waitMs = kEzoTempCompDelayMs;
+      } else {
+        waitMs = self->_ezoIssueReads();
+      }
+      break;
+    case EzoCycleStep::CollectTemp:
+      job.tempAcked = self->_phEzo.collectAck();
+      waitMs = self->_ezoIssueReads();
+      break;
+    case EzoCycleStep::Collect:
+      for (size_t i = 0; i < self->_channels.size(); ++i) {
+        SensorChannel::Cycle& c = self->_channels[i].cycle;
+        if (c.issued) c.ok = self->_channels[i].driver().collectReading(c.value);
+      }
+      break;
+    case EzoCycleStep::None:
+    default:
+      // Reprise un poil en avance sur l'échéance EZO (arrondi des ticks).
+      waitMs = 1;
+      break;
+  }
+
+  cycle.addBusHoldUs(micros() - t0);
+  if (waitMs == 0) {
+    cycle.finished(millis());
+    txn.ok = true;
+  }
+  return waitMs;
+}
+
+uint32_t SensorManager::_ezoIssueReads() {
+  // Back-to-back : les modules convertissent en parallèle.
+  bool any = false;
+  for (size_t i = 0; i < _channels.size(); ++i) {
+    SensorChannel& ch = _channels[i];
+    ch.cycle.issued = ch.driver().startRead();
+    any = any || ch.cycle.issued;
+  }
+  if (any) {
+    // Échéance comptée après la dernière émission : ≥ 900 ms pour tous les modules.
+    _ezoCycle.readsIssued(millis());
+    return kEzoReadDelayMs;
+  }
+  // Rien d'émis (bus HS) : fin du cycle, échec de toutes les voies au bilan.
+  return 0;
+}
+
+// Bilan d'une lecture de voie : SensorChannel::apply() (cache, filtre,
+// stabilité, fail-streak, invalidation) puis effets de la coquille — logs,
+// rafraîchissement du cache Cal,?, particularités pH (compensation T°, pente).
+void SensorManager::_applyReading(SensorChannel& ch, bool ok, float value, uint32_t now) {
+  const SensorChannelUpdate up = ch.apply(ok, value, now);
+  const char* name = ch.driver().name();
+  const SensorChannelInfo& info = ch.info();
+  const bool isPh = &ch == &_ph;
+
+  if (ok) {
+    _ezoEverResponded = true;
+    // Correctif Pass 3.5 (pool-chemistry) : si le cache cal_points a été invalidé
+    // à -1 par une période de bus dégradé, n'a jamais été initialisé ou n'a pas
+    // été relu au bilan d'une calibration, on le rafraîchit dès qu'un retour de
+    // bus est confirmé. Cal,? soumis (bilan dans _stepEzoQuery), jamais attendu
+    // depuis loopTask ; une requête à la fois, pas pendant une calibration.
+    if (ch.calPoints() == -1 && _queryTxn.state == I2cTxnState::Idle &&
+        _calFlow.state() != EzoCalState::Running) {
+      _submitEzoQuery(&ch);
     }
-    // Cond #5 pool-chemistry : invalider la lecture ORP en cas de bus dégradé.
-    if (_orpI2cFailStreak >= kEzoBusFailMaxConsecutive) {
-      _lastOrp = NAN;
-      // Correctif Pass 3.5 (pool-chemistry) : invalider aussi le cache cal_points
-      // ORP. Cohérent avec pH ci-dessus → canDose() refuse jusqu'à un Cal,?
-      // réussi au retour de bus.
-      _orpCalCachedPoints = -1;
-      if (!_orpI2cDegradedLogged) {
-        systemLogger.critical("EZO ORP : bus I²C dégradé (" + String(_orpI2cFailStreak) +
-                              " échecs) — lecture invalidée, régulation auto inhibée");
-        _orpI2cDegradedLogged = true;
+    if (authCfg.sensorLogsEnabled) {
+      char buf[80];
+      if (isPh) {
+        snprintf(buf, sizeof(buf), "%s: %.2f (T=%.1f°C)", name, value,
+                 _phTempComp.appliedTemp());
+      } else {
+        snprintf(buf, sizeof(buf), "%s: %.*f%s%s", name, (int)info.decimals, value,
+                 info.unit[0] ? " " : "", info.unit);
       }
+      systemLogger.debug(buf);
     }
+    return;
+  }
+
+  // Lecture pH en échec : reset du module possible → "T,<t>" renvoyé.
+  if (isPh) _phTempComp.invalidate();
+  if (up.failThreshold) {
+    // Logger une seule fois quand on franchit le seuil — au-delà, silence
+    // pour ne pas inonder les logs en cas de débranchement durable.
+    systemLogger.warning(String(name) + " : " + String(ch.failStreak()) +
+                         " échecs I²C consécutifs" +
+                         (info.gatesDosing ? String(" — dosage ") + info.label + " bloqué" : ""));
+  }
+  // feature-024 : pente invalidée comme le cache cal_points (bus EZO pH dégradé).
+  if (isPh && ch.failStreak() >= kEzoBusFailMaxConsecutive) {
+    _phSlopeAcid = NAN;
+    _phSlopeBase = NAN;
+    _phSlopeZero = NAN;
+  }
+  if (up.degraded) {
+    systemLogger.critical(String(name) + " : bus I²C dégradé (" + String(ch.failStreak()) +
+                          " échecs) — lecture invalidée, régulation auto inhibée");
   }
 }
 
@@ -454,24 +674,14 @@ void SensorManager::_readEzoSensors(float tempC) {
 // =============================================================================
 
 void SensorManager::_checkStaleAndLog() {
-  uint32_t now = millis();
-
-  // pH : log critical UNE FOIS quand la dernière lecture valide dépasse le seuil
-  if (!isnan(_lastPh) && !_phStaleLogged &&
-      (now - _lastPhMs > kSensorStaleTimeoutMs)) {
-    systemLogger.critical("EZO pH : lectures stale > " +
-                          String(kSensorStaleTimeoutMs / 1000) +
-                          "s — régulation auto inhibée");
-    _phStaleLogged = true;
-  }
-
-  // ORP idem
-  if (!isnan(_lastOrp) && !_orpStaleLogged &&
-      (now - _lastOrpMs > kSensorStaleTimeoutMs)) {
-    systemLogger.critical("EZO ORP : lectures stale > " +
+  const uint32_t now = millis();
+  // Log critical UNE FOIS quand la dernière lecture valide dépasse le seuil
+  for (size_t i = 0; i < _channels.size(); ++i) {
+    SensorChannel& ch = _channels[i];
+    if (!ch.staleEdge(now)) continue;
+    systemLogger.critical(String(ch.driver().name()) + " : lectures stale > " +
                           String(kSensorStaleTimeoutMs / 1000) +
                           "s — régulation auto inhibée");
-    _orpStaleLogged = true;
   }
 }
 
@@ -484,32 +694,27 @@ void SensorManager::_checkStaleAndLog() {
 // warning pour la température (aucun impact dosage). Log info à la levée.
 
 void SensorManager::_checkFrozenAndLog() {
-  // pH — transition vers figé → critical, levée → info
-  const bool phFrozen = _phFilter.frozen();
-  if (phFrozen && !_phFrozenLogged) {
-    systemLogger.critical("[SENSOR_FROZEN] Capteur pH figé : " +
-                          String(kSensorFrozenSamples) + " lectures dans une bande < " +
-                          String(kSensorFrozenEpsilonPh, 4) + " autour de " +
-                          String(_phFilter.raw(), 3) +
-                          " — régulation pH auto inhibée (filtre non prêt)");
-    _phFrozenLogged = true;
-  } else if (!phFrozen && _phFrozenLogged) {
-    systemLogger.info("[SENSOR_FROZEN] Capteur pH à nouveau vivant — détection figée levée");
-    _phFrozenLogged = false;
-  }
-
-  // ORP — idem
-  const bool orpFrozen = _orpFilter.frozen();
-  if (orpFrozen && !_orpFrozenLogged) {
-    systemLogger.critical("[SENSOR_FROZEN] Capteur ORP figé : " +
-                          String(kSensorFrozenSamples) + " lectures dans une bande < " +
-                          String(kSensorFrozenEpsilonOrp, 2) + " mV autour de " +
-                          String(_orpFilter.raw(), 1) + " mV" +
-                          " — régulation ORP auto inhibée (filtre non prêt)");
-    _orpFrozenLogged = true;
-  } else if (!orpFrozen && _orpFrozenLogged) {
-    systemLogger.info("[SENSOR_FROZEN] Capteur ORP à nouveau vivant — détection figée levée");
-    _orpFrozenLogged = false;
+  // Voies — transition vers figé → critical, levée → info
+  for (size_t i = 0; i < _channels.size(); ++i) {
+    SensorChannel& ch = _channels[i];
+    const SensorChannelInfo& info = ch.info();
+    const String unit = info.unit[0] ? String(" ") + info.unit : String();
+    switch (ch.frozenEdge()) {
+      case SensorChannelEdge::Raised:
+        systemLogger.critical(String("[SENSOR_FROZEN] Capteur ") + info.label + " figé : " +
+                              String(kSensorFrozenSamples) + " lectures dans une bande < " +
+                              String(ch.filter().frozenEpsilon(), info.decimals + 1) + unit +
+                              " autour de " + String(ch.filter().raw(), info.decimals) + unit +
+                              " — régulation " + info.label + " auto inhibée (filtre non prêt)");
+        break;
+      case SensorChannelEdge::Cleared:
+        systemLogger.info(String("[SENSOR_FROZEN] Capteur ") + info.label +
+                          " à nouveau vivant — détection figée levée");
+        break;
+      case SensorChannelEdge::None:
+      default:
+        break;
+    }
   }
 
   // Température eau — warning-only (aucun impact dosage)
@@ -533,146 +738,326 @@ void SensorManager::_checkFrozenAndLog() {
 
 void SensorManager::_processEzoQueue() {
   if (_ezoQueue == nullptr) return;
+  // Calibration ou requête en cours : la commande suivante attend son bilan.
+  if (_calFlow.busy() || _queryTxn.state != I2cTxnState::Idle) return;
 
   EzoCmdRequest req;
-  // Réception non bloquante : 0 tick. Au plus 1 commande par cycle pour ne pas
-  // monopoliser loopTask (chaque commande peut prendre 900 ms côté I²C).
+  // Réception non bloquante : 0 tick. Au plus 1 commande par cycle.
   if (xQueueReceive(_ezoQueue, &req, 0) != pdTRUE) {
     return;
   }
 
-  _executeEzoCmd(req);
+  if (req.kind == EzoCmdKind::QueryPhSlope) {
+    // feature-024 — re-query Slope,? sur l'EZO pH. Flag levé dès la soumission
+    // pour permettre une nouvelle demande sans attendre le bilan.
+    _phSlopeQueryPending = false;
+    if (!_submitEzoQuery(nullptr)) _applyPhSlope(false, PhSlopeInfo{NAN, NAN, NAN});
+  } else {
+    _startCalibration(req);
+  }
+}
 
-  // Watchdog : la commande de calibration peut bloquer ~1 s (delay 900 ms +
-  // wire transactions). On reset après pour rester dans la fenêtre 30 s.
-  esp_task_wdt_reset();
+// Requête ponctuelle (Slope,? pH si ch == nullptr, sinon Cal,? de la voie).
+// false si le bus ne l'a pas prise (file i2c pleine).
+bool SensorManager::_submitEzoQuery(SensorChannel* ch) {
+  _queryJob = EzoQueryJob{};
+  _queryJob.ch = ch;
+  _queryTxn.devices = i2cDeviceBit(ch != nullptr ? ch->driver().device() : _phEzo.device());
+  _queryTxn.priority = I2cPriority::OnDemand;
+  _queryTxn.timeoutMs = kI2cTxnTimeoutMs;
+  _queryTxn.step = &SensorManager::_queryStep;
+  _queryTxn.ctx = this;
+  if (i2cBus.submit(_queryTxn)) return true;
+  _queryTxn.state = I2cTxnState::Idle;
+  return false;
 }
 
-void SensorManager::_executeEzoCmd(const EzoCmdRequest& req) {
-  bool ok = false;
-  switch (req.kind) {
-    case EzoCmdKind::CalibratePhMid: {
-      systemLogger.info("EZO pH : calibration point milieu (pH 7.00) en cours...");
-      ok = _phEzo.calibrate("mid,7.00");
-      if (ok) {
-        _phCalCachedPoints = _phEzo.queryCalPoints();
-        PumpController.armStabilizationTimer(0);  // Stabilisation pH post-cal
-        resetPhFilter();  // feature-025 : warmup obligatoire après cal réussie
-        systemLogger.info("EZO pH : calibration mid OK (points=" + String(_phCalCachedPoints) + ")");
-        // feature-024 : refresh pente post-calibration.
-        enqueuePhSlopeQuery();
-      } else {
-        systemLogger.error("EZO pH : calibration mid échouée");
-      }
-      break;
+// Étape 0 : commande ; 1 (après kEzoCalDelayMs) : relève.
+uint32_t SensorManager::_queryStep(I2cTxn& txn) {
+  SensorManager* self = static_cast<SensorManager*>(txn.ctx);
+  EzoQueryJob& job = self->_queryJob;
+  if (txn.stage == 0) {
+    const bool sent = job.ch != nullptr ? job.ch->driver().startCalPointsQuery()
+                                        : self->_phEzo.startSlopeQuery();
+    if (!sent) return 0;  // ok = false
+    txn.stage = 1;
+    return kEzoCalDelayMs;
+  }
+  if (job.ch != nullptr) {
+    job.points = job.ch->driver().collectCalPoints();
+  } else {
+    job.slopeOk = self->_phEzo.collectSlope(job.slope);
+  }
+  txn.ok = true;
+  return 0;
+}
+
+void SensorManager::_stepEzoQuery() {
+  const I2cTxnState state = _queryTxn.state;
+  if (state == I2cTxnState::Idle || state == I2cTxnState::Pending) return;
+  _queryTxn.state = I2cTxnState::Idle;
+  const bool done = state == I2cTxnState::Done && _queryTxn.ok;
+
+  SensorChannel* ch = _queryJob.ch;
+  if (ch == nullptr) {
+    _applyPhSlope(done && _queryJob.slopeOk, _queryJob.slope);
+    return;
+  }
+  // Une calibration a pu réécrire le cache entre-temps : son bilan fait foi.
+  if (done && _queryJob.points >= 0 && ch->calPoints() == -1) {
+    ch->setCalPoints(_queryJob.points);
+    systemLogger.info(String(ch->driver().name()) + " : cache calibration rafraîchi (points=" +
+                      String(_queryJob.points) + ")");
+  }
+}
+
+// Bilan d'un Slope,? (requête de la file ou fin de calibration pH).
+void SensorManager::_applyPhSlope(bool ok, const PhSlopeInfo& info) {
+  if (ok) {
+    _phSlopeAcid = info.acidPct;
+    _phSlopeBase = info.basePct;
+    _phSlopeZero = info.zeroOffsetMv;
+    _phSlopeQueriedMs = millis();
+    _phSlopeFailStreak = 0;
+    systemLogger.info("EZO pH slope : acide=" + String(info.acidPct, 1) +
+                      "% base=" + String(info.basePct, 1) + "% zéro=" +
+                      (isnan(info.zeroOffsetMv) ? String("N/A")
+                                                : String(info.zeroOffsetMv, 2) + "mV"));
+    return;
+  }
+  _phSlopeFailStreak++;
+  if (_phSlopeFailStreak >= kEzoBusFailMaxConsecutive) {
+    // Cohérence avec le cache Cal,? de la voie : invalider à NaN après seuil.
+    _phSlopeAcid = NAN;
+    _phSlopeBase = NAN;
+    _phSlopeZero = NAN;
+    // _phSlopeQueriedMs reste à sa dernière valeur — l'âge sera détecté
+    // comme stale par l'UI (Pass B), inutile de remettre à 0 ici.
+    systemLogger.warning("EZO pH slope : " + String(_phSlopeFailStreak) +
+                         " échecs Slope,? consécutifs — cache invalidé");
+  }
+}
+
+// =============================================================================
+// Calibration non bloquante (ezo_cal_logic)
+// =============================================================================
+// Demande → Stabilizing (lectures du cycle périodique dans la bande) →
+// Running (transaction Cal + Cal,? [+ Slope,? en pH] soumise, loopTask
+// repart aussitôt) →
+// Done / Failed au bilan. Les effets de bord d'une calibration réussie
+// (cache points, stabilisation pompe, warmup filtre, Slope,?) sont ceux de
+// l'ancienne exécution synchrone, appliqués au bilan.
+
+bool SensorManager::_isPhCal(EzoCmdKind k) {
+  return k == EzoCmdKind::CalibratePhMid || k == EzoCmdKind::CalibratePhLow ||
+         k == EzoCmdKind::ClearPhCal;
+}
+
+SensorChannel& SensorManager::_calChannel() {
+  return _isPhCal(_calReq.kind) ? _ph : _orp;
+}
+
+void SensorManager::_startCalibration(const EzoCmdRequest& req) {
+  _calReq = req;
+  const bool clear = req.kind == EzoCmdKind::ClearPhCal || req.kind == EzoCmdKind::ClearOrpCal;
+  // Cal,clear ne dépend pas de la solution : pas d'attente.
+  const bool waitStable = !clear && !req.force;
+  EzoStability& st = _calChannel().stability();
+  _calSeqAtStart = st.seq();
+  _calLastRun = st.run();
+  _calFlow.start(waitStable, millis());
+  _calGen++;
+  if (waitStable) {
+    systemLogger.info(String(_calChannel().driver().name()) +
+                      " : calibration demandée, attente de lectures stables...");
+  }
+}
+
+void SensorManager::_stepCalibration() {
+  const EzoCalState state = _calFlow.state();
+  const uint32_t now = millis();
+
+  if (state == EzoCalState::Stabilizing) {
+    EzoStability& st = _calChannel().stability();
+    if (st.run() != _calLastRun) {
+      _calLastRun = st.run();
+      _calGen++;  // Progression "n/N" vers l'UI
     }
-    case EzoCmdKind::CalibratePhLow: {
-      systemLogger.info("EZO pH : calibration point bas (pH 4.00) en cours...");
-      ok = _phEzo.calibrate("low,4.00");
-      if (ok) {
-        _phCalCachedPoints = _phEzo.queryCalPoints();
-        PumpController.armStabilizationTimer(0);  // Stabilisation pH post-cal
-        resetPhFilter();  // feature-025 : warmup obligatoire après cal réussie
-        systemLogger.info("EZO pH : calibration low OK (points=" + String(_phCalCachedPoints) + ")");
-        // feature-024 : refresh pente post-calibration.
-        enqueuePhSlopeQuery();
-      } else {
-        systemLogger.error("EZO pH : calibration low échouée");
-      }
-      break;
+    // Verdict porté par une lecture postérieure à la demande (cf. ezo_cal_logic.h).
+    const bool stable = st.stable() && st.seq() != _calSeqAtStart;
+    switch (_calFlow.poll(stable, now)) {
+      case EzoCalStep::Issue:
+        _submitCalibration(now);
+        break;
+      case EzoCalStep::TimedOut:
+        _calGen++;
+        systemLogger.error(String(_calChannel().driver().name()) +
+                           " : calibration abandonnée, lectures instables depuis " +
+                           String(kEzoCalStabilityTimeoutMs / 1000) + " s");
+        break;
+      case EzoCalStep::None:
+      default:
+        break;
     }
-    case EzoCmdKind::CalibrateOrp: {
+    return;
+  }
+
+  if (state != EzoCalState::Running) return;
+  const I2cTxnState txnState = _calTxn.state;
+  if (txnState == I2cTxnState::Pending) return;
+  _calTxn.state = I2cTxnState::Idle;
+  _finishCalibration(txnState == I2cTxnState::Done, now);
+}
+
+void SensorManager::_submitCalibration(uint32_t now) {
+  _calJob = EzoCalJob{};
+  switch (_calReq.kind) {
+    case EzoCmdKind::CalibratePhMid:
+      _calJob.ezo = &_phEzo;
+      strlcpy(_calJob.cmd, "Cal,mid,7.00", sizeof(_calJob.cmd));
+      break;
+    case EzoCmdKind::CalibratePhLow:
+      _calJob.ezo = &_phEzo;
+      strlcpy(_calJob.cmd, "Cal,low,4.00", sizeof(_calJob.cmd));
+      break;
+    case EzoCmdKind::CalibrateOrp:
       // Cal,<ref> sur EZO ORP attend la valeur de référence en mV (entier).
-      char arg[16];
-      snprintf(arg, sizeof(arg), "%d", (int)roundf(req.arg));
-      systemLogger.info("EZO ORP : calibration référence " + String(arg) + " mV en cours...");
-      ok = _orpEzo.calibrate(arg);
-      if (ok) {
-        _orpCalCachedPoints = _orpEzo.queryCalPoints();
-        PumpController.armStabilizationTimer(1);  // Stabilisation ORP post-cal
-        resetOrpFilter();  // feature-025 : warmup obligatoire après cal réussie
-        systemLogger.info("EZO ORP : calibration OK (points=" + String(_orpCalCachedPoints) + ")");
-      } else {
-        systemLogger.error("EZO ORP : calibration échouée");
-      }
+      _calJob.ezo = &_orpEzo;
+      snprintf(_calJob.cmd, sizeof(_calJob.cmd), "Cal,%d", (int)roundf(_calReq.arg));
       break;
-    }
-    case EzoCmdKind::ClearPhCal: {
-      systemLogger.info("EZO pH : effacement calibration en cours...");
-      ok = _phEzo.clearCalibration();
-      if (ok) {
-        _phCalCachedPoints = _phEzo.queryCalPoints();
-        resetPhFilter();  // feature-025 : warmup obligatoire après clear réussi
-        systemLogger.info("EZO pH : calibration effacée (points=" + String(_phCalCachedPoints) + ")");
-        // feature-024 : la pente n'a plus de sens après un Cal,clear — refresh
-        // pour récupérer les valeurs par défaut EZO (typiquement 100/100/0).
-        enqueuePhSlopeQuery();
-      } else {
-        systemLogger.error("EZO pH : effacement calibration échoué");
-      }
+    case EzoCmdKind::ClearPhCal:
+      _calJob.ezo = &_phEzo;
+      strlcpy(_calJob.cmd, "Cal,clear", sizeof(_calJob.cmd));
       break;
-    }
-    case EzoCmdKind::ClearOrpCal: {
-      systemLogger.info("EZO ORP : effacement calibration en cours...");
-      ok = _orpEzo.clearCalibration();
-      if (ok) {
-        _orpCalCachedPoints = _orpEzo.queryCalPoints();
-        resetOrpFilter();  // feature-025 : warmup obligatoire après clear réussi
-        systemLogger.info("EZO ORP : calibration effacée (points=" + String(_orpCalCachedPoints) + ")");
-      } else {
-        systemLogger.error("EZO ORP : effacement calibration échoué");
-      }
+    case EzoCmdKind::ClearOrpCal:
+    default:
+      _calJob.ezo = &_orpEzo;
+      strlcpy(_calJob.cmd, "Cal,clear", sizeof(_calJob.cmd));
       break;
-    }
-    case EzoCmdKind::QueryPhSlope: {
-      // feature-024 — re-query Slope,? sur l'EZO pH.
-      // Le flag _phSlopeQueryPending est levé en début de handler pour permettre
-      // une nouvelle demande de re-query sans attendre la fin du traitement.
-      _phSlopeQueryPending = false;
-      PhSlopeInfo info{NAN, NAN, NAN};
-      if (_phEzo.querySlope(info)) {
-        _phSlopeAcid = info.acidPct;
-        _phSlopeBase = info.basePct;
-        _phSlopeZero = info.zeroOffsetMv;
-        _phSlopeQueriedMs = millis();
-        _phSlopeFailStreak = 0;
-        systemLogger.info("EZO pH slope : acide=" + String(info.acidPct, 1) +
-                          "% base=" + String(info.basePct, 1) + "% zéro=" +
-                          (isnan(info.zeroOffsetMv) ? String("N/A")
-                                                    : String(info.zeroOffsetMv, 2) + "mV"));
-      } else {
-        _phSlopeFailStreak++;
-        if (_phSlopeFailStreak >= kEzoBusFailMaxConsecutive) {
-          // Cohérence avec _phCalCachedPoints : invalider à NaN après seuil.
-          _phSlopeAcid = NAN;
-          _phSlopeBase = NAN;
-          _phSlopeZero = NAN;
-          // _phSlopeQueriedMs reste à sa dernière valeur — l'âge sera détecté
-          // comme stale par l'UI (Pass B), inutile de remettre à 0 ici.
-          systemLogger.warning("EZO pH slope : " + String(_phSlopeFailStreak) +
-                               " échecs Slope,? consécutifs — cache invalidé");
-        }
-      }
+  }
+  // feature-024 : pente relue après toute calibration pH réussie (après
+  // Cal,clear : valeurs par défaut EZO, typiquement 100/100/0).
+  _calJob.wantSlope = _isPhCal(_calReq.kind);
+  systemLogger.info(String(_calJob.ezo->name()) + " : " + String(_calJob.cmd) + " en cours...");
+
+  _calTxn.devices = i2cDeviceBit(_calJob.ezo->device());
+  _calTxn.priority = I2cPriority::Urgent;
+  _calTxn.timeoutMs = kI2cTxnTimeoutMs;
+  _calTxn.step = &SensorManager::_calStep;
+  _calTxn.ctx = this;
+  _calGen++;
+  if (!i2cBus.submit(_calTxn)) {
+    _calTxn.state = I2cTxnState::Idle;
+    _finishCalibration(false, now);
+  }
+}
+
+// Étape 0 : Cal ; 1 (après kEzoCalDelayMs) : statut puis Cal,? ; 2 : points,
+// puis Slope,? en pH ; 3 : pente.
+uint32_t SensorManager::_calStep(I2cTxn& txn) {
+  SensorManager* self = static_cast<SensorManager*>(txn.ctx);
+  EzoCalJob& job = self->_calJob;
+  char buf[32];  // readResponse() exige ≥ 32 octets
+  switch (txn.stage) {
+    case 0:
+      job.sent = job.ezo->sendCmd(job.cmd);
+      if (!job.sent) break;
+      txn.stage = 1;
+      return kEzoCalDelayMs;
+    case 1:
+      // Atlas renvoie statut=1 sans payload pour Cal,* : n == 0 est un succès.
+      job.answered = job.ezo->readResponse(buf, sizeof(buf)) >= 0;
+      if (!job.answered || !job.ezo->startCalPointsQuery()) break;
+      txn.stage = 2;
+      return kEzoCalDelayMs;
+    case 2:
+      job.points = job.ezo->collectCalPoints();
+      if (!job.wantSlope || !job.ezo->startSlopeQuery()) break;
+      txn.stage = 3;
+      return kEzoCalDelayMs;
+    default:
+      job.slopeOk = job.ezo->collectSlope(job.slope);
       break;
+  }
+  txn.ok = true;
+  return 0;
+}
+
+// Bilan (loopTask). ran=false : transaction jamais démarrée (bus saturé).
+void SensorManager::_finishCalibration(bool ran, uint32_t now) {
+  _calFlow.finished(ran && _calJob.sent, _calJob.answered, now);
+  _calGen++;
+  const bool ph = _isPhCal(_calReq.kind);
+  const char* name = _calChannel().driver().name();
+  if (_calFlow.state() != EzoCalState::Done) {
+    systemLogger.error(String(name) + " : " + String(_calJob.cmd) + " échouée (" +
+                       String(ezoCalErrorName(_calFlow.error())) + ")");
+    return;
+  }
+
+  const bool clear = _calReq.kind == EzoCmdKind::ClearPhCal ||
+                     _calReq.kind == EzoCmdKind::ClearOrpCal;
+  // -1 (Cal,? non relu) : régulation inhibée, Cal,? asynchrone soumis à la
+  // prochaine lecture réussie (_applyReading) — l'ancien nombre de points ne
+  // vaut plus après une calibration.
+  _calChannel().setCalPoints(_calJob.points);
+  if (ph) {
+    if (!clear) PumpController.armStabilizationTimer(0);  // Stabilisation pH post-cal
+    resetPhFilter();  // feature-025 : warmup obligatoire après cal / clear réussi
+    // feature-024 : pente relue dans la transaction de calibration ; module
+    // muet sur Slope,? → nouvelle requête soumise via la file (asynchrone).
+    if (_calJob.slopeOk) {
+      _applyPhSlope(true, _calJob.slope);
+    } else {
+      enqueuePhSlopeQuery();
     }
+  } else {
+    if (!clear) PumpController.armStabilizationTimer(1);  // Stabilisation ORP post-cal
+    resetOrpFilter();  // feature-025 : warmup obligatoire après cal / clear réussi
+  }
+  systemLogger.info(String(name) + " : " + String(_calJob.cmd) + " OK (points=" +
+                    String(_calJob.points) + ", stabilité " +
+                    String(_calFlow.waitedMs() / 1000) + " s, total " +
+                    String(_calFlow.elapsedMs(now)) + " ms)");
+}
+
+void SensorManager::fillCalibrationJson(JsonObject out) const {
+  const EzoCalState state = _calFlow.state();
+  out["state"] = ezoCalStateName(state);
+  if (state == EzoCalState::Idle) return;  // Aucune calibration depuis le boot
+
+  const bool ph = _isPhCal(_calReq.kind);
+  out["sensor"] = ph ? "ph" : "orp";
+  switch (_calReq.kind) {
+    case EzoCmdKind::CalibratePhMid: out["step"] = "mid"; break;
+    case EzoCmdKind::CalibratePhLow: out["step"] = "low"; break;
+    case EzoCmdKind::CalibrateOrp:
+      out["step"] = "cal";
+      out["reference_mv"] = (int)roundf(_calReq.arg);
+      break;
+    default: out["step"] = "clear"; break;
   }
+  const char* err = ezoCalErrorName(_calFlow.error());
+  if (err != nullptr) out["error"] = err;
+  else out["error"] = nullptr;
+
+  const SensorChannel& ch = ph ? _ph : _orp;
+  const EzoStability& st = ch.stability();
+  const float scale = ph ? 1000.0f : 10.0f;
+  out["stable_run"] = st.run();
+  out["stable_required"] = st.required();
+  out["spread"] = round(st.spread() * scale) / scale;
+  out["elapsed_ms"] = _calFlow.elapsedMs(millis());
+  out["waited_ms"] = _calFlow.waitedMs();
+  if (state == EzoCalState::Done) out["points"] = ch.calPoints();
 }
 
 // =============================================================================
 // Getters publics — pH / ORP (avec fenêtre stale)
 // =============================================================================
 
-float SensorManager::getPh() const {
-  if (isnan(_lastPh)) return NAN;
-  if (millis() - _lastPhMs > kSensorStaleTimeoutMs) return NAN;
-  return _lastPh;
-}
-
-float SensorManager::getOrp() const {
-  if (isnan(_lastOrp)) return NAN;
-  if (millis() - _lastOrpMs > kSensorStaleTimeoutMs) return NAN;
-  return _lastOrp;
-}
+float SensorManager::getPh() const { return _ph.valueAt(millis()); }
+float SensorManager::getOrp() const { return _orp.valueAt(millis()); }
 
 // =============================================================================
 // feature-025 — Getters filtre pH / ORP (lock-free, contexte loopTask)
@@ -694,6 +1079,12 @@ bool SensorManager::isOrpFilterReady() const { return _orpFilter.ready(millis())
 bool SensorManager::isOrpFilterUnstable() const { return _orpFilter.unstable(); }
 uint8_t SensorManager::getOrpRejectedCount() const { return _orpFilter.rejectedCount(); }
 
+// Tendance (étage Kalman) et couplage aux doses — loopTask (pump_controller).
+float SensorManager::getPhTrendPerMin() const { return _phFilter.trendPerMin(); }
+float SensorManager::getOrpTrendPerMin() const { return _orpFilter.trendPerMin(); }
+void SensorManager::notePhDosing(uint32_t nowMs) { _phFilter.noteDose(nowMs); }
+void SensorManager::noteOrpDosing(uint32_t nowMs) { _orpFilter.noteDose(nowMs); }
+
 // feature-022 Passe 2 — getters capteur figé (lock-free : simple comparaison
 // d'entiers 16 bits, même contrat de concurrence que is*FilterUnstable()).
 bool SensorManager::isPhSensorFrozen() const { return _phFilter.frozen(); }
@@ -712,11 +1103,11 @@ void SensorManager::resetOrpFilter() {
 
 int SensorManager::getPhCalibrationPoints() {
   // Rafraîchit à la demande pour les routes de diagnostic (peut prendre ~900 ms).
-  // La régulation s'appuie sur le cache `_phCalCachedPoints` mis à jour en begin()
+  // La régulation s'appuie sur le cache de la voie mis à jour en begin()
   // et après chaque calibration → pas de lecture I²C dans le chemin chaud.
   int pts = _phEzo.queryCalPoints();
   if (pts >= 0) {
-    _phCalCachedPoints = pts;
+    _ph.setCalPoints(pts);
   }
   return pts;
 }
@@ -724,36 +1115,40 @@ int SensorManager::getPhCalibrationPoints() {
 int SensorManager::getOrpCalibrationPoints() {
   int pts = _orpEzo.queryCalPoints();
   if (pts >= 0) {
-    _orpCalCachedPoints = pts;
+    _orp.setCalPoints(pts);
   }
   return pts;
 }
 
 bool SensorManager::isInitialized() const {
   // Considéré initialisé si au moins un EZO a déjà répondu (boot ou lecture)
-  // ET qu'au moins une lecture pH ou ORP valide est en cache.
-  return _ezoEverResponded && (!isnan(_lastPh) || !isnan(_lastOrp));
+  // ET qu'au moins une voie a une lecture valide en cache.
+  if (!_ezoEverResponded) return false;
+  for (size_t i = 0; i < _channels.size(); ++i) {
+    if (!isnan(_channels[i].last())) return true;
+  }
+  return false;
 }
 
 // =============================================================================
 // Enqueue de commandes — appelé par handlers async (Pass 4) ou UART (uart_commands)
 // =============================================================================
 
-bool SensorManager::enqueueCalibratePhMid() {
+bool SensorManager::enqueueCalibratePhMid(bool force) {
   if (_ezoQueue == nullptr) return false;
-  EzoCmdRequest req{EzoCmdKind::CalibratePhMid, 0.0f};
+  EzoCmdRequest req{EzoCmdKind::CalibratePhMid, 0.0f, force};
   return xQueueSend(_ezoQueue, &req, 0) == pdTRUE;
 }
 
-bool SensorManager::enqueueCalibratePhLow() {
+bool SensorManager::enqueueCalibratePhLow(bool force) {
   if (_ezoQueue == nullptr) return false;
-  EzoCmdRequest req{EzoCmdKind::CalibratePhLow, 0.0f};
+  EzoCmdRequest req{EzoCmdKind::CalibratePhLow, 0.0f, force};
   return xQueueSend(_ezoQueue, &req, 0) == pdTRUE;
 }
 
-bool SensorManager::enqueueCalibrateOrp(float referenceMv) {
+bool SensorManager::enqueueCalibrateOrp(float referenceMv, bool force) {
   if (_ezoQueue == nullptr) return false;
-  EzoCmdRequest req{EzoCmdKind::CalibrateOrp, referenceMv};
+  EzoCmdRequest req{EzoCmdKind::CalibrateOrp, referenceMv, force};
   return xQueueSend(_ezoQueue, &req, 0) == pdTRUE;
 }
 
@@ -790,6 +1185,53 @@ float SensorManager::getPhSlopeAcid() const { return _phSlopeAcid; }
 float SensorManager::getPhSlopeBase() const { return _phSlopeBase; }
 float SensorManager::getPhSlopeZero() const { return _phSlopeZero; }
 
+uint32_t SensorManager::getPhSampleAgeMs() const {
+  return _ph.ageMs(millis());
+}
+
+uint32_t SensorManager::getOrpSampleAgeMs() const {
+  return _orp.ageMs(millis());
+}
+
+namespace {
+
+void fillChannelHealth(JsonObject o, const SensorChannel& ch, uint32_t now) {
+  const SensorHealth& h = ch.health();
+  const SensorFilterCore& f = ch.filter();
+  o["score"] = h.score(now);
+  // Bruit : deux décimales de plus que la valeur publiée, plafonné à 4.
+  const uint8_t noiseDecimals = ch.info().decimals + 2 < 4 ? ch.info().decimals + 2 : 4;
+  const float noise = h.noiseStd();
+  if (!isnan(noise)) o["noise_std"] = fixedRound(noise, noiseDecimals);
+  else o["noise_std"] = nullptr;
+  o["spike_rate"] = round(h.spikeRate() * 1000.0f) / 1000.0f;
+  o["i2c_fail_rate"] = round(h.failRate() * 1000.0f) / 1000.0f;
+  o["i2c_fail_streak"] = ch.failStreak();
+  o["latency_p50_ms"] = h.latencyPercentileMs(50);
+  o["latency_p95_ms"] = h.latencyPercentileMs(95);
+  o["latency_max_ms"] = h.latencyMaxMs();
+  const uint32_t age = h.sampleAgeMs(now);
+  if (age != UINT32_MAX) o["age_ms"] = age;
+  else o["age_ms"] = nullptr;
+  o["reads"] = h.reads();
+  o["rejected"] = f.rejectedCount();
+  o["consecutive_rejects"] = f.consecutiveRejects();
+  o["resyncs"] = f.resyncCount();
+  o["unstable"] = f.unstable();
+}
+
+}  // namespace
+
+// Appelée hors loopTask (handler HTTP, mqttTask) : lectures de scalaires
+// 32 bits, un indicateur peut dater d'un cycle de plus qu'un autre.
+void SensorManager::fillHealthJson(JsonObject out) const {
+  const uint32_t now = millis();
+  for (size_t i = 0; i < _channels.size(); ++i) {
+    const SensorChannel& ch = _channels[i];
+    fillChannelHealth(out[ch.info().key].to<JsonObject>(), ch, now);
+  }
+}
+
 uint32_t SensorManager::getPhSlopeAgeMs() const {
   if (_phSlopeQueriedMs == 0) return UINT32_MAX;
   uint32_t now = millis();
@@ -942,6 +1384,7 @@ bool SensorManager::identifySonde(const uint8_t addr[kSondeAddrLen], bool isWate
   if (!_saveSondeAddrToNvs(newKey, addr)) {
     return false;
   }
+  _dsRolesChanged = true;
   systemLogger.info("Sonde " + romHex(addr) + " identifiée comme " + String(sondeRoleLabel(newRole)));
   return true;
 }
@@ -959,5 +1402,6 @@ void SensorManager::resetSondeIdentification() {
   for (uint8_t i = 0; i < _detectedCount; ++i) {
     _sondes[i].role = SondeRole::Unknown;
   }
+  _dsRolesChanged = true;
   systemLogger.info("Identification des sondes DS18B20 réinitialisée (NVS effacé)");
 }
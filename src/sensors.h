@@ -9,7 +9,15 @@
 #include <DallasTemperature.h>
 #include "atlas_ezo.h"
 #include "constants.h"
+#include "ezo_cal_logic.h"
+#include "ezo_comp_logic.h"
+#include "ezo_cycle_logic.h"
+#include "fixed_format.h"
+#include "ds18b20_logic.h"
+#include "i2c_bus.h"
+#include "sensor_channel.h"
 #include "sensor_filter.h"
+#include "sensor_health_logic.h"
 
 // Rôle attribué à une sonde DS18B20 (feature-020)
 enum class SondeRole : uint8_t {
@@ -31,21 +39,29 @@ struct SondeInfo {
 // =============================================================================
 //
 // Architecture (feature-021) :
-//   - DS18B20 : multi-sondes (eau + circuit), inchangé feature-020
+//   - DS18B20 : multi-sondes (eau + circuit, feature-020), résolution et cadence
+//     par rôle, fin de conversion scrutée (ds18b20_logic)
 //   - pH / ORP : modules Atlas EZO Embedded I²C (kEzoPhAddress / kEzoOrpAddress)
+//     portés chacun par une voie générique (SensorChannel : pilote + filtre +
+//     santé + état) rangée dans une table à capacité fixe (_channels) que
+//     parcourent le cycle d'acquisition, les logs et les sorties WS / santé.
 //     Calibration stockée DANS le module EZO (NVS interne), pas en NVS ESP32.
-//     Compensation T° envoyée via "RT,<temp>" avant chaque "R" (cf. AtlasEzoSensor).
+//     Compensation T° pH mémorisée par le module ("T,<temp>"), poussée seulement
+//     quand la T° eau bouge (ezo_comp_logic) ; lectures par "R" simple.
 //
 // Concurrence :
 //   - update() est appelé depuis loopTask (core 1).
 //   - getPh() / getOrp() peuvent être appelés depuis loopTask (pump_controller)
-//     ou des handlers async (core 0). Les caches `_lastPh` / `_lastOrp` sont
-//     des `float` 32 bits alignés : lecture/écriture atomique sur ESP32 (Xtensa
+//     ou des handlers async (core 0). Les caches de voie (SensorChannel::last())
+//     sont des `float` 32 bits alignés : lecture/écriture atomique sur ESP32 (Xtensa
 //     LX6) — pas de mutex dédié nécessaire pour ces variables scalaires.
 //   - Les commandes longues (calibration, ~1-2 s par appel I²C) sont
 //     sérialisées via une queue FreeRTOS (`_ezoQueue`) traitée dans update().
 //     Les handlers async appellent `enqueue*()` (< 1 ms) et l'UI observe la
 //     transition via WS.
+//   - Calibration (ezo_cal_logic) : attente de lectures stables puis
+//     transaction Cal + Cal,? asynchrone (Urgent) ; loopTask ne s'y bloque
+//     jamais, la progression est poussée en WS ({"type":"calibration"}).
 // =============================================================================
 
 class SensorManager {
@@ -63,7 +79,8 @@ public:
   // Requête de commande EZO posée par les handlers async, traitée par update()
   struct EzoCmdRequest {
     EzoCmdKind kind;
-    float arg;  // Pour CalibrateOrp : valeur de référence en mV. Sinon ignoré.
+    float arg;           // Pour CalibrateOrp : valeur de référence en mV. Sinon ignoré.
+    bool force = false;  // Calibration : Cal émise sans attendre la stabilité
   };
 
   SensorManager();
@@ -83,7 +100,7 @@ public:
   // getPh()/getOrp() restent VOLONTAIREMENT bruts (rétrocompat affichage/MQTT/scheduled).
   // Le PID auto consomme getPhFiltered()/getOrpFiltered() et exige isPhFilterReady()/
   // isOrpFilterReady() avant tout dosage (fail-closed warmup / EZO injoignable / instable).
-  // Tous les getters sont lock-free (lecture dans le SEUL contexte loopTask, comme _lastPh).
+  // Tous les getters sont lock-free (lecture dans le SEUL contexte loopTask, comme getPh()).
   float getPhRaw() const;             // Dernière brute pH (= getPh() brut, NaN si stale)
   float getPhMedian() const;          // Médiane courante pH (NaN si pas de donnée)
   float getPhFiltered() const;        // pH filtré EMA — valeur PID (NaN si non amorcé)
@@ -98,6 +115,14 @@ public:
   bool isOrpFilterUnstable() const;
   uint8_t getOrpRejectedCount() const;
 
+  // Étage Kalman (kPh/kOrpFilterUseKalman) : pente estimée en unités/min, NaN
+  // avec l'étage EMA ou filtre non amorcé. note*Dosing() : pompe active (auto,
+  // programmée ou manuelle) → l'estimateur suit plus vite pendant la pause mélange.
+  float getPhTrendPerMin() const;
+  float getOrpTrendPerMin() const;
+  void notePhDosing(uint32_t nowMs);
+  void noteOrpDosing(uint32_t nowMs);
+
   // ===== feature-022 Passe 2 : détection capteur figé (variance nulle) =====
   // true si kSensorFrozenSamples lectures ACCEPTÉES consécutives sont contenues
   // dans une bande < ½ LSB (kSensorFrozenEpsilonPh/Orp). Un capteur figé rend
@@ -120,26 +145,37 @@ public:
   // 0..3 sinon (Atlas pH supporte 1pt/2pts/3pts, ORP 1pt seul).
   // ⚠️ Lecture I²C bloquante (~900 ms) — réservé aux routes HTTP de diagnostic
   // et à mqttTask. Pour les chemins chauds (loopTask: ws_manager, pump_controller),
-  // utiliser `getPhCalibrationPointsCached()` qui retourne `_phCalCachedPoints`
+  // utiliser `getPhCalibrationPointsCached()` qui retourne le cache de la voie
   // sans accès au bus.
   int getPhCalibrationPoints();
   int getOrpCalibrationPoints();
 
   // Variantes "cache only" — pas d'accès I²C, retourne la dernière valeur connue
-  // (mise à jour en begin() puis à chaque calibration via _processEzoQueue).
+  // (mise à jour en begin(), au bilan de chaque calibration, puis par un Cal,?
+  // asynchrone tant qu'elle vaut -1).
   // Utilisable depuis n'importe quel contexte temps réel.
-  int getPhCalibrationPointsCached() const { return _phCalCachedPoints; }
-  int getOrpCalibrationPointsCached() const { return _orpCalCachedPoints; }
+  int getPhCalibrationPointsCached() const { return _ph.calPoints(); }
+  int getOrpCalibrationPointsCached() const { return _orp.calPoints(); }
 
   // ===== Enqueue de commandes longues (handlers async safe, < 1 ms) =====
   // Renvoient true si la commande a été placée dans la queue, false sinon
   // (queue pleine ou non initialisée).
-  bool enqueueCalibratePhMid();         // Calibration point milieu (pH 7.00)
-  bool enqueueCalibratePhLow();         // Calibration point bas (pH 4.00)
-  bool enqueueCalibrateOrp(float referenceMv);  // Calibration ORP (référence en mV)
+  // force : Cal émise sans attendre des lectures stables (sinon échec
+  // "unstable" après kEzoCalStabilityTimeoutMs si la sonde ne se pose pas).
+  bool enqueueCalibratePhMid(bool force = false);   // Calibration point milieu (pH 7.00)
+  bool enqueueCalibratePhLow(bool force = false);   // Calibration point bas (pH 4.00)
+  bool enqueueCalibrateOrp(float referenceMv, bool force = false);  // Calibration ORP (mV)
   bool enqueueClearPhCalibration();
   bool enqueueClearOrpCalibration();
 
+  // ===== Calibration en cours (loopTask uniquement) =====
+  // Génération incrémentée à chaque changement visible (état, progression
+  // de la stabilité) : WsManager pousse {"type":"calibration"} quand elle bouge.
+  uint32_t calibrationGeneration() const { return _calGen; }
+  bool isCalibrating() const { return _calFlow.busy(); }
+  // Dernière calibration : sensor, step, state, error, stabilité, points, durées.
+  void fillCalibrationJson(JsonObject out) const;
+
   // ===== feature-024 : pente sonde pH =====
   // Acide / base : % de la pente Nernst théorique (idéal 100%).
   // Zero offset : décalage du point isopotentiel en mV (idéal 0).
@@ -164,7 +200,30 @@ public:
   // ou ORP valide est disponible (cohérent avec gestion fallback EZO débranché).
   bool isInitialized() const;
 
-  // ===== API DS18B20 — Température (feature-020, inchangé) =====
+  // Âge de la dernière lecture pH / ORP valide (millis() - relève).
+  // UINT32_MAX si aucune depuis le boot.
+  uint32_t getPhSampleAgeMs() const;
+  uint32_t getOrpSampleAgeMs() const;
+  // Cycle de lecture pH + ORP parallèle : durée (début → relève) dernière /
+  // max, occupation bus (µs) du dernier cycle. Lecture seule, valeurs 32 bits.
+  const EzoReadCycle& ezoCycle() const { return _ezoCycle; }
+  // Santé glissante des voies pH / ORP (bruit, pics, échecs I²C, latence,
+  // score), alimentée à chaque bilan de cycle. Lecture seule depuis loopTask ;
+  // les routes HTTP lisent des scalaires 32 bits (au pire d'un cycle à l'autre).
+  const SensorHealth& phHealth() const { return _ph.health(); }
+  const SensorHealth& orpHealth() const { return _orp.health(); }
+  // {"ph":{…},"orp":{…}} : un objet par voie de la table (clé de voie),
+  // indicateurs de santé + compteurs du filtre, même forme pour
+  // GET /sensors/health et le topic MQTT sensor_health.
+  void fillHealthJson(JsonObject out) const;
+
+  // Table des voies analogiques (ordre d'ajout : pH, ORP), lecture seule
+  // depuis loopTask — WsManager en tire les champs <clé>Raw, <clé>Median…
+  size_t channelCount() const { return _channels.size(); }
+  const SensorChannel& channel(size_t i) const { return _channels[i]; }
+  const SensorChannel* findChannel(const char* key) const { return _channels.find(key); }
+
+  // ===== API DS18B20 — Température (feature-020) =====
   // Alias rétrocompat de la T° eau, avec fallback gracieux sur la 1ʳᵉ sonde
   // présente tant que l'identification utilisateur n'a pas été faite.
   float getTemperature() const;
@@ -190,6 +249,9 @@ public:
   float getSondeTempRaw(uint8_t index) const {
     return (index < kMaxDs18b20Sondes) ? _sondes[index].lastTempRaw : NAN;
   }
+  // Âge de la dernière lecture valide de la sonde "eau" (UINT32_MAX si aucune).
+  uint32_t getWaterTempAgeMs() const;
+  const Ds18b20Conversion& ds18b20Conversion() const { return _dsConv; }
 
 private:
   // ===== Capteurs DS18B20 =====
@@ -198,73 +260,105 @@ private:
 
   SondeInfo _sondes[kMaxDs18b20Sondes];
   uint8_t _detectedCount = 0;
+  uint8_t _ds18b20BusCount = 0;  // Sondes annoncées par le bus au boot (≥ _detectedCount)
 
-  // Cache rétrocompat eau (alimenté par readDs18b20s())
+  // Cache rétrocompat eau (alimenté par _finishDs18b20Cycle())
   float tempValue = NAN;
   float tempRawValue = NAN;
+  uint32_t _waterTempMs = 0;     // millis() de la dernière lecture eau valide (0 = jamais)
+
+  // Cycle DS18B20 : transaction périodique asynchrone sur le 1-Wire, comme le
+  // cycle EZO. loopTask choisit les sondes dues et la soumet ; ses étapes
+  // (i2cTask) lancent la conversion, scrutent le bit de fin, relèvent les
+  // scratchpads. _dsJob n'est écrit par i2cTask que pendant la transaction.
+  Ds18b20Schedule<kMaxDs18b20Sondes> _dsSchedule;
+  Ds18b20Conversion _dsConv{kDs18b20PollIntervalMs, kDs18b20ConvMarginMs};
+  I2cTxn _dsTxn;
+  struct Ds18b20Job {
+    uint8_t mask = 0;          // Sondes converties ce cycle
+    uint8_t resMask = 0;       // Sondes dont la résolution est à (re)programmer
+    uint8_t bits[kMaxDs18b20Sondes] = {};  // Résolution visée
+    Ds18b20ReadStatus status[kMaxDs18b20Sondes] = {};
+    float temps[kMaxDs18b20Sondes] = {};
+    uint8_t readBits[kMaxDs18b20Sondes] = {};  // Résolution relue (registre de config)
+    bool read = false;         // Relève faite (sinon : sondes absentes du bus)
+  } _dsJob;
+  uint8_t _dsResDirty = 0;     // Résolution à reprogrammer (boot, rôle changé, sonde réinitialisée)
+  bool _dsParasite = false;    // Alimentation parasite : pas de scrutation possible
+  volatile bool _dsRolesChanged = false;  // Posé par identifySonde() (tâche web), consommé par loopTask
 
   // ===== Capteurs Atlas EZO =====
-  AtlasEzoSensor _phEzo{kEzoPhAddress, "EZO pH"};
-  AtlasEzoSensor _orpEzo{kEzoOrpAddress, "EZO ORP"};
-
-  // Cache des dernières lectures valides — accédés sans mutex.
-  // Atomique CHAMP PAR CHAMP (float 32 bits aligné, instructions L32I/S32I single-cycle
-  // sur Xtensa LX6) mais PAS atomique sur la paire (_lastPh, _lastPhMs) : un getter peut
-  // lire la valeur récente avec l'horodatage précédent (ou inverse) pendant 1 cycle si
-  // _readEzoSensors() écrit entre les 2 lectures. Impact maximal : 1 cycle (~5 s) de
-  // fausse alerte stale ou inverse — fail-safe acceptable pour la régulation chimique.
-  float _lastPh = NAN;
-  float _lastOrp = NAN;
-  uint32_t _lastPhMs = 0;
-  uint32_t _lastOrpMs = 0;
+  AtlasEzoSensor _phEzo{kEzoPhAddress, I2cDevice::EzoPh, "EZO pH"};
+  AtlasEzoSensor _orpEzo{kEzoOrpAddress, I2cDevice::EzoOrp, "EZO ORP"};
 
   // ===== feature-025 : filtres pH / ORP =====
-  // Alimentés dans _readEzoSensors() à chaque lecture EZO valide (contexte loopTask).
+  // Alimentés par SensorChannel::apply() à chaque lecture EZO valide (contexte loopTask).
   // Lus par les getters get*Filtered()/is*FilterReady() depuis loopTask uniquement
   // (pump_controller, ws_manager côté loop). Pas de mutex : cf. contrat SensorFilter.
-  SensorFilter _phFilter{SensorFilter::Config{
+  // Fenêtre médiane propre à chaque capteur (capacité = paramètre de template).
+  WindowedSensorFilter<kPhFilterMedianWindow> _phFilter{SensorFilterConfig{
       kPhFilterMin, kPhFilterMax, kPhFilterMaxStep, kPhEmaAlpha,
-      kSensorFilterMedianWindow, kSensorFilterWarmupSamples,
+      kPhFilterMedianWindow, kSensorFilterWarmupSamples,
       kSensorFilterMaxConsecutiveRejects, kSensorFilterMaxAgeMs,
-      kSensorFrozenSamples, kSensorFrozenEpsilonPh}};
-  SensorFilter _orpFilter{SensorFilter::Config{
+      kSensorFrozenSamples, kSensorFrozenEpsilonPh,
+      SensorEstimatorConfig{
+          kPhFilterUseKalman ? SensorEstimator::Kalman : SensorEstimator::Ema,
+          kPhKalmanAccelStd, kPhKalmanMeasStd, kSensorKalmanDoseGain,
+          (uint32_t)kPhMixingDelayMs}}};
+  WindowedSensorFilter<kOrpFilterMedianWindow> _orpFilter{SensorFilterConfig{
       kOrpFilterMin, kOrpFilterMax, kOrpFilterMaxStep, kOrpEmaAlpha,
-      kSensorFilterMedianWindow, kSensorFilterWarmupSamples,
+      kOrpFilterMedianWindow, kSensorFilterWarmupSamples,
       kSensorFilterMaxConsecutiveRejects, kSensorFilterMaxAgeMs,
-      kSensorFrozenSamples, kSensorFrozenEpsilonOrp}};
+      kSensorFrozenSamples, kSensorFrozenEpsilonOrp,
+      SensorEstimatorConfig{
+          kOrpFilterUseKalman ? SensorEstimator::Kalman : SensorEstimator::Ema,
+          kOrpKalmanAccelStd, kOrpKalmanMeasStd, kSensorKalmanDoseGain,
+          (uint32_t)kOrpMixingDelayMs}}};
+
+  // ===== Voies pH / ORP (sensor_channel.h) =====
+  // Pilote + filtre ci-dessus, santé (sensor_health_logic.h), stabilité avant
+  // calibration et état courant : dernière lecture valide, fail-streak
+  // (pool-chemistry condition #5), cache Cal,?, fronts de log. Cache de
+  // lecture accédé sans mutex : atomique CHAMP PAR CHAMP (float 32 bits
+  // aligné) mais pas sur la paire (valeur, horodatage) — au pire 1 cycle
+  // (~5 s) de fausse alerte stale ou inverse, fail-safe pour la régulation.
+  // Points de calibration : -1 = EZO injoignable ou bus dégradé → canDose()
+  // bloque (condition #2/#5) ; rafraîchis à la 1ʳᵉ lecture réussie suivante.
+  SensorChannel _ph{SensorChannelInfo{"ph", "pH", "", kFixedPhDecimals,
+                                      kSensorHealthNoiseLimitPh, kEzoCalStableBandPh, true},
+                    _phEzo, _phFilter};
+  SensorChannel _orp{SensorChannelInfo{"orp", "ORP", "mV", kFixedOrpDecimals,
+                                       kSensorHealthNoiseLimitOrp, kEzoCalStableBandOrp, true},
+                     _orpEzo, _orpFilter};
+  // Remplie dans le constructeur ; toutes les voies partagent le cycle EZO.
+  SensorChannelTable<kSensorChannelCapacity> _channels;
+  uint32_t _ezoSubmitMs = 0;  // Soumission du cycle en cours (latence santé)
 
   // ===== feature-022 Passe 2 : détecteur figé dédié température =====
   // Alimenté par les lectures DS18B20 VALIDES (brutes, NON arrondies) de la
-  // sonde "eau" dans _readDs18b20s(). 900 lectures à 2 s = 30 min.
+  // sonde "eau" dans _finishDs18b20Cycle(). 900 lectures à 2 s = 30 min.
   FrozenDetector _waterTempFrozen{kTempFrozenSamples, kTempFrozenEpsilonC};
 
-  // Flags edge-triggered pour les logs SENSOR_FROZEN (une seule transition loggée)
-  bool _phFrozenLogged = false;
-  bool _orpFrozenLogged = false;
+  // Flag edge-triggered du log SENSOR_FROZEN température (voies : SensorChannel)
   bool _tempFrozenLogged = false;
 
-  // Compteurs d'échecs I²C consécutifs (pool-chemistry condition #5)
-  int _phI2cFailStreak = 0;
-  int _orpI2cFailStreak = 0;
-
-  // Flags pour ne logger critical qu'à la transition vers stale
-  bool _phStaleLogged = false;
-  bool _orpStaleLogged = false;
-
-  // Flags pour ne logger critical qu'une seule fois quand le bus I²C franchit
-  // le seuil `kEzoBusFailMaxConsecutive` (pool-chemistry condition #5).
-  // Remis à false dès la 1ʳᵉ lecture réussie suivante.
-  bool _phI2cDegradedLogged = false;
-  bool _orpI2cDegradedLogged = false;
-
-  // Cache des points de calibration EZO (mis à jour en begin() puis après chaque
-  // calibration). Permet à getPhCalibrationPointsCached() / getOrpCalibrationPointsCached()
-  // d'être appelés sans bloquer le bus I²C dans le chemin chaud (loopTask, WS).
-  // Valeur -1 : EZO injoignable ou bus I²C dégradé (fail-streak ≥ kEzoBusFailMaxConsecutive).
-  // canDose(int) bloque le dosage tant que la valeur reste -1 (pool-chemistry condition #2/#5).
-  // Le cache est rafraîchi opportunément à la 1ʳᵉ lecture réussie suivante.
-  int _phCalCachedPoints = -1;   // -1 = bus down/inconnu, 0..3 sinon
-  int _orpCalCachedPoints = -1;  // -1 = bus down/inconnu, 0..1 sinon
+  // Cycle de lecture pH + ORP (kPhOrpSensorIntervalMs) : transaction
+  // périodique asynchrone qui réserve les deux EZO. Ses étapes s'exécutent
+  // dans i2cTask (T, R ×2, attente de conversion, relève) ; loopTask la
+  // soumet et applique le bilan quand elle n'est plus Pending. _ezoCycle et
+  // _ezoJob ne sont écrits par i2cTask que pendant la transaction.
+  EzoReadCycle _ezoCycle{kPhOrpSensorIntervalMs, kEzoTempCompDelayMs, kEzoReadDelayMs};
+  I2cTxn _ezoTxn;
+  struct EzoCycleJob {
+    float tempC = NAN;        // T° de compensation visée
+    bool pushTemp = false;    // "T,<t>" à émettre ce cycle
+    bool tempAcked = false;   // T acquittée par l'EZO pH
+  } _ezoJob;                  // Lectures : SensorChannel::cycle de chaque voie
+
+  // Compensation T° en vigueur sur l'EZO pH : "T,<t>" poussé avant la lecture
+  // quand la T° eau a bougé ; invalidée à chaque lecture pH en échec (reset
+  // du module possible) → renvoyée au cycle suivant.
+  EzoTempCompPolicy _phTempComp;
 
   // True si au moins un EZO a répondu (au moins une fois) — utilisé par isInitialized()
   bool _ezoEverResponded = false;
@@ -277,18 +371,73 @@ private:
   float _phSlopeBase = NAN;     // % pente base
   float _phSlopeZero = NAN;     // mV zéro (NaN si firmware EZO ne le rapporte pas)
   uint32_t _phSlopeQueriedMs = 0;     // 0 = jamais ; sinon millis() de la dernière query OK
-  bool _phSlopeQueryPending = false;  // anti-doublon enqueue → handler lève le flag
+  bool _phSlopeQueryPending = false;  // anti-doublon enqueue → levé à la soumission
   int _phSlopeFailStreak = 0;         // ≥ kEzoBusFailMaxConsecutive → invalider cache à NaN
 
   // ===== Queue FreeRTOS pour commandes longues =====
   static constexpr UBaseType_t kEzoQueueLen = 4;
   QueueHandle_t _ezoQueue = nullptr;
 
+  // ===== Calibration non bloquante (ezo_cal_logic) =====
+  // Stabilité (SensorChannel::stability()) alimentée à chaque bilan de cycle,
+  // calibration en cours ou non. La file n'est plus dépilée tant que _calFlow
+  // est occupé : une seule calibration à la fois, les suivantes attendent leur tour.
+  EzoCalFlow _calFlow{kEzoCalStabilityTimeoutMs};
+  EzoCmdRequest _calReq{EzoCmdKind::CalibratePhMid, 0.0f};
+  uint32_t _calSeqAtStart = 0;  // seq() de la stabilité à la demande
+  uint8_t _calLastRun = 0;      // Progression déjà publiée
+  uint32_t _calGen = 0;
+  // Cal,<arg>, Cal,? puis (pH) Slope,? dans la même transaction (module
+  // réservé). Écrit par i2cTask pendant la transaction, relu par loopTask une
+  // fois Done/Expired.
+  I2cTxn _calTxn;
+  struct EzoCalJob {
+    AtlasEzoSensor* ezo = nullptr;
+    char cmd[24] = {};
+    bool sent = false;      // Cal acceptée par le bus
+    bool answered = false;  // Statut EZO 1
+    int points = -1;        // Cal,? ; -1 si non relu
+    bool wantSlope = false; // Calibration pH : pente relue dans la foulée
+    bool slopeOk = false;
+    PhSlopeInfo slope{NAN, NAN, NAN};
+  } _calJob;
+
+  // Requête ponctuelle hors calibration : Slope,? (file EZO : boot, 24 h,
+  // debug) ou Cal,? d'une voie dont le cache est à -1. Transaction OnDemand
+  // soumise, bilan appliqué par loopTask (_stepEzoQuery) ; une à la fois.
+  I2cTxn _queryTxn;
+  struct EzoQueryJob {
+    SensorChannel* ch = nullptr;  // Cal,? de cette voie ; nullptr = Slope,? pH
+    int points = -1;
+    bool slopeOk = false;
+    PhSlopeInfo slope{NAN, NAN, NAN};
+  } _queryJob;
+
   // ===== Helpers privés =====
-  void _readEzoSensors(float tempC);   // Lecture pH puis ORP, mise à jour caches
-  void _readDs18b20s();                // Lecture multi-sondes DS18B20
+  void _stepEzoCycle();                // loopTask : soumet le cycle pH/ORP, applique le bilan
+  void _finishEzoCycle(bool ran, uint32_t now);
+  static uint32_t _ezoCycleStep(I2cTxn& txn);  // i2cTask : étapes du cycle
+  uint32_t _ezoIssueReads();                   // i2cTask : R à toutes les voies
+  void _applyReading(SensorChannel& ch, bool ok, float value, uint32_t now);  // Bilan + logs
+  void _recordTrace(float tempC, uint32_t now);
+  bool _runOneWire(uint32_t (*step)(I2cTxn&), void* ctx, I2cPriority prio, uint32_t timeoutMs);
+  void _probeDs18b20s();               // i2cTask : énumération au boot
+  void _stepDs18b20Cycle();            // loopTask : soumet le cycle DS18B20, applique le bilan
+  void _finishDs18b20Cycle(bool ran, uint32_t now);
+  static uint32_t _ds18b20CycleStep(I2cTxn& txn);  // i2cTask : étapes du cycle
+  void _applySondeRoles();             // Résolution + cadence selon le rôle
   void _processEzoQueue();             // Dépile au plus 1 commande par cycle
-  void _executeEzoCmd(const EzoCmdRequest& req);
+  bool _submitEzoQuery(SensorChannel* ch);  // Slope,? (nullptr) ou Cal,? de `ch`
+  void _stepEzoQuery();                // loopTask : bilan de la requête en cours
+  static uint32_t _queryStep(I2cTxn& txn);  // i2cTask : commande puis relève
+  void _applyPhSlope(bool ok, const PhSlopeInfo& info);  // Cache pente + fail streak
+  void _startCalibration(const EzoCmdRequest& req);  // Entrée de _calFlow
+  void _stepCalibration();             // loopTask : stabilité → soumission → bilan
+  void _submitCalibration(uint32_t now);
+  void _finishCalibration(bool ran, uint32_t now);
+  static uint32_t _calStep(I2cTxn& txn);  // i2cTask : Cal, Cal,? puis Slope,? (pH)
+  SensorChannel& _calChannel();        // Voie de la calibration en cours
+  static bool _isPhCal(EzoCmdKind k);
   void _checkStaleAndLog();            // Détection stale → log critical (1 fois)
   void _checkFrozenAndLog();           // feature-022 : logs SENSOR_FROZEN edge-triggered
 
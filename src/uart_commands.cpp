@@ -10,6 +10,8 @@
 #include "mqtt_manager.h"
 #include "auth.h"
 #include "version.h"
+#include "config_cache.h"
+#include "fixed_format.h"
 #include <WiFi.h>
 #include <time.h>
 
@@ -88,17 +90,17 @@ void UartCommands::handleGetStatus() {
   float temp = sensors.getTemperature();
 
   if (!isnan(ph)) {
-    d["ph"] = round(ph * 10.0f) / 10.0f;
+    d["ph"] = fixedRound(ph, 1);
   } else {
     d["ph"] = nullptr;
   }
   if (!isnan(orp)) {
-    d["orp"] = round(orp);
+    d["orp"] = fixedRound(orp, kFixedOrpDecimals);
   } else {
     d["orp"] = nullptr;
   }
   if (!isnan(temp)) {
-    d["temperature"] = round(temp * 10.0f) / 10.0f;
+    d["temperature"] = fixedRound(temp, kFixedTempDecimals);
   } else {
     d["temperature"] = nullptr;
   }
@@ -149,55 +151,14 @@ void UartCommands::handleGetStatus() {
 }
 
 void UartCommands::handleGetConfig() {
-  // Document dynamique : ~35 champs
-  JsonDocument doc;
-  doc["type"] = "config";
-  JsonObject d = doc["data"].to<JsonObject>();
-
-  // Régulation
-  d["ph_target"] = mqttCfg.phTarget;
-  d["orp_target"] = mqttCfg.orpTarget;
-  d["ph_enabled"] = mqttCfg.phEnabled;
-  d["orp_enabled"] = mqttCfg.orpEnabled;
-  d["ph_pump"] = mqttCfg.phPump;
-  d["orp_pump"] = mqttCfg.orpPump;
-  d["install_mode"] = installModeToString(mqttCfg.installMode);  // feature-056
-  d["ph_correction_type"] = mqttCfg.phCorrectionType;
-  d["ph_injection_limit_min"] = mqttCfg.phInjectionLimitMinutes;
-  d["orp_injection_limit_min"] = mqttCfg.orpInjectionLimitMinutes;
-
-  // Filtration (feature-056 : filtration_enabled → install_mode)
-  d["filtration_mode"] = filtrationCfg.mode;
-  d["filtration_start"] = filtrationCfg.start;
-  d["filtration_end"] = filtrationCfg.end;
-
-  // Éclairage
-  d["lighting_feature_enabled"] = lightingCfg.featureEnabled;
-  d["lighting_enabled"] = lightingCfg.enabled;
-  d["lighting_brightness"] = lightingCfg.brightness;
-  d["lighting_schedule_enabled"] = lightingCfg.scheduleEnabled;
-  d["lighting_start_time"] = lightingCfg.startTime;
-  d["lighting_end_time"] = lightingCfg.endTime;
-
-  // Limites de sécurité
-  d["max_ph_ml_per_day"] = safetyLimits.maxPhMlPerDay;
-  d["max_chlorine_ml_per_day"] = safetyLimits.maxChlorineMlPerDay;
-
-  // Temps / NTP
-  d["time_use_ntp"] = mqttCfg.timeUseNtp;
-  d["ntp_server"] = mqttCfg.ntpServer;
-  d["timezone_id"] = mqttCfg.timezoneId;
-
-  // Calibration (feature-021 : Atlas EZO — calibration interne aux modules)
-  // pH/ORP : nb de points de calibration mémorisés en cache (-1 si EZO injoignable)
-  d["ph_cal_points"] = sensors.getPhCalibrationPointsCached();
-  d["orp_cal_points"] = sensors.getOrpCalibrationPointsCached();
-  // Température DS18B20 (offset utilisateur, conservé)
-  d["temp_calibration_date"] = mqttCfg.tempCalibrationDate;
-  d["temp_calibration_offset"] = mqttCfg.tempCalibrationOffset;
-  d["temperature_enabled"] = mqttCfg.temperatureEnabled;
-
-  uartProtocol.sendJson(doc);
+  // Vue UART du cache versionné (config_cache.h) : ~30 champs stables sérialisés
+  // une fois par génération, seuls les points de calibration EZO sont relus.
+  String line;
+  line.reserve(1024);
+  line += "{\"type\":\"config\",\"data\":";
+  configCache.render(ConfigView::Uart, true, line);
+  line += '}';
+  uartProtocol.sendRawJson(line);
 }
 
 void UartCommands::handleGetAlarms() {
@@ -221,20 +182,29 @@ void UartCommands::handleGetAlarms() {
   float orp = sensors.getOrp();
   float temp = sensors.getTemperature();
 
+  // Messages composés sur la pile (fixed_format.h), vivants jusqu'à l'envoi.
+  char num[kFixedFormatMax];
+  char phMsg[48], orpMsg[48], tempMsg[48];
   if (!isnan(ph) && (ph < 5.0f || ph > 9.0f)) {
     JsonObject a = arr.add<JsonObject>();
     a["code"] = "PH_ABNORMAL";
-    a["message"] = "Valeur pH anormale: " + String(ph, 1);
+    formatFloatFixed(num, sizeof(num), ph, 1);
+    snprintf(phMsg, sizeof(phMsg), "Valeur pH anormale: %s", num);
+    a["message"] = static_cast<const char*>(phMsg);
   }
   if (!isnan(orp) && (orp < 400.0f || orp > 900.0f)) {
     JsonObject a = arr.add<JsonObject>();
     a["code"] = "ORP_ABNORMAL";
-    a["message"] = "Valeur ORP anormale: " + String(orp, 0) + " mV";
+    formatOrp(num, sizeof(num), orp);
+    snprintf(orpMsg, sizeof(orpMsg), "Valeur ORP anormale: %s mV", num);
+    a["message"] = static_cast<const char*>(orpMsg);
   }
   if (!isnan(temp) && (temp < 5.0f || temp > 40.0f)) {
     JsonObject a = arr.add<JsonObject>();
     a["code"] = "TEMP_ABNORMAL";
-    a["message"] = "Température anormale: " + String(temp, 1) + " °C";
+    formatTemperature(num, sizeof(num), temp);
+    snprintf(tempMsg, sizeof(tempMsg), "Température anormale: %s °C", num);
+    a["message"] = static_cast<const char*>(tempMsg);
   }
 
   uartProtocol.sendJson(doc);
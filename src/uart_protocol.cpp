@@ -37,6 +37,10 @@ void UartProtocol::sendJson(JsonDocument& doc) {
   uartTransport.sendLine(out);
 }
 
+void UartProtocol::sendRawJson(const String& json) {
+  uartTransport.sendLine(json);
+}
+
 void UartProtocol::sendAck(const String& cmd) {
   StaticJson<64> doc;
   doc["type"] = "ack";
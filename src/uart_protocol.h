@@ -20,6 +20,8 @@ public:
 
   // Envoi d'un document JSON quelconque
   void sendJson(JsonDocument& doc);
+  // Envoi d'une ligne JSON déjà sérialisée (ex. rendu config_cache)
+  void sendRawJson(const String& json);
 
   // Envoi d'un événement asynchrone vers l'écran
   // type   : "event" ou "alarm"
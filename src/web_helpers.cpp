@@ -7,7 +7,8 @@
 // renvoyer un String à buffer null et planter en LoadProhibited.
 // Le shared_ptr<String> garde le contenu vivant jusqu'à la fin du transfert,
 // et Content-Length permet à lwIP de fermer le socket dès le dernier octet.
-static void sendJsonBuffered(AsyncWebServerRequest* request, int code, std::shared_ptr<String> json) {
+static void sendJsonBuffered(AsyncWebServerRequest* request, int code, std::shared_ptr<String> json,
+                             const char* etag = nullptr) {
   size_t len = json->length();
   AsyncWebServerResponse* response = request->beginResponse(
     "application/json", len,
@@ -18,6 +19,12 @@ static void sendJsonBuffered(AsyncWebServerRequest* request, int code, std::shar
       return toCopy;
     });
   if (code != 200) response->setCode(code);
+  if (etag) {
+    // no-cache : le navigateur garde la réponse mais revalide à chaque fetch
+    // (If-None-Match) — jamais de config périmée servie depuis son cache.
+    response->addHeader("ETag", etag);
+    response->addHeader("Cache-Control", "no-cache");
+  }
   request->send(response);
 }
 
@@ -27,6 +34,21 @@ void sendRawJsonResponse(AsyncWebServerRequest* request, String& json) {
   sendJsonBuffered(request, 200, ptr);
 }
 
+void sendRawJsonResponseWithEtag(AsyncWebServerRequest* request, String& json, const String& etag) {
+  auto ptr = std::make_shared<String>(std::move(json));
+  sendJsonBuffered(request, 200, ptr, etag.c_str());
+}
+
+bool handleIfNoneMatch(AsyncWebServerRequest* request, const String& etag) {
+  if (!request->hasHeader("If-None-Match")) return false;
+  if (request->getHeader("If-None-Match")->value() != etag) return false;
+  AsyncWebServerResponse* response = request->beginResponse(304);
+  response->addHeader("ETag", etag);
+  response->addHeader("Cache-Control", "no-cache");
+  request->send(response);
+  return true;
+}
+
 void sendJsonResponse(AsyncWebServerRequest* request, JsonDocument& doc) {
   auto json = std::make_shared<String>();
   serializeJson(doc, *json);
@@ -9,6 +9,11 @@
 void sendJsonResponse(AsyncWebServerRequest* request, JsonDocument& doc);
 void sendErrorResponse(AsyncWebServerRequest* request, int code, const String& message);
 void sendRawJsonResponse(AsyncWebServerRequest* request, String& json);
+// Variante avec validateur HTTP : ajoute ETag + Cache-Control: no-cache.
+void sendRawJsonResponseWithEtag(AsyncWebServerRequest* request, String& json, const String& etag);
+// Répond 304 Not Modified si l'en-tête If-None-Match du client correspond à `etag`.
+// Renvoie true si la réponse a été envoyée (le handler doit alors s'arrêter).
+bool handleIfNoneMatch(AsyncWebServerRequest* request, const String& etag);
 String getCurrentTimeISO();
 
 // Helpers adresse ROM 1-Wire 64 bits (feature-020)
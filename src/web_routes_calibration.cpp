@@ -11,10 +11,11 @@
 // Routes de calibration capteurs Atlas EZO (feature-021 — Pass 4a)
 // =============================================================================
 // Toutes les routes répondent immédiatement (< 1 ms) en plaçant la commande
-// dans la queue FreeRTOS de SensorManager. La commande est exécutée par
-// loopTask via _processEzoQueue() en ~900 ms (transaction I²C bloquante).
-// L'UI observe l'avancement via les champs WS phCalPoints / orpCalPoints
-// rafraîchis à chaque cycle (cf. ws_manager.cpp).
+// dans la queue FreeRTOS de SensorManager. loopTask la dépile et la déroule
+// sans bloquer (ezo_cal_logic) : attente de lectures stables (sauf Cal,clear
+// ou "force": true), puis transaction Cal + Cal,? asynchrone (~1,8 s).
+// L'UI suit l'avancement via le message WS {"type":"calibration"} ; les
+// champs phCalPoints / orpCalPoints restent publiés (cf. ws_manager.cpp).
 // =============================================================================
 
 namespace {
@@ -33,9 +34,10 @@ void notifyScreenCalibrationQueued(const char* sensor) {
 
 void setupCalibrationRoutes(AsyncWebServer* server) {
   // ===========================================================================
-  // POST /calibrate_ph — payload {"step": "mid" | "low"}
+  // POST /calibrate_ph — payload {"step": "mid" | "low", "force": bool?}
   // ===========================================================================
   // Met en file une commande Cal,mid,7.00 ou Cal,low,4.00 vers l'EZO pH.
+  // force (défaut false) : Cal émise sans attendre la stabilité des lectures.
   // Réponse 200 immédiate avec {success:true, queued:true, step}.
   // 400 si payload invalide, 503 si queue saturée.
   server->on(
@@ -65,12 +67,13 @@ void setupCalibrationRoutes(AsyncWebServer* server) {
         }
 
         const char* step = doc["step"] | "";
+        const bool force = doc["force"] | false;
         bool ok = false;
         if (strcmp(step, "mid") == 0) {
-          ok = sensors.enqueueCalibratePhMid();
+          ok = sensors.enqueueCalibratePhMid(force);
           if (ok) notifyScreenCalibrationQueued("ph_mid");
         } else if (strcmp(step, "low") == 0) {
-          ok = sensors.enqueueCalibratePhLow();
+          ok = sensors.enqueueCalibratePhLow(force);
           if (ok) notifyScreenCalibrationQueued("ph_low");
         } else {
           sendErrorResponse(req, 400, "step must be 'mid' or 'low'");
@@ -90,9 +93,9 @@ void setupCalibrationRoutes(AsyncWebServer* server) {
       });
 
   // ===========================================================================
-  // POST /calibrate_orp — payload {"reference": <mV float>}
+  // POST /calibrate_orp — payload {"reference": <mV float>, "force": bool?}
   // ===========================================================================
-  // Met en file une commande Cal,<ref> vers l'EZO ORP.
+  // Met en file une commande Cal,<ref> vers l'EZO ORP (force : cf. /calibrate_ph).
   // Plage acceptée : 0..1000 mV (couvre les standards usuels 225 / 470 / 650 et les kits 0 mV).
   server->on(
       "/calibrate_orp", HTTP_POST,
@@ -119,7 +122,8 @@ void setupCalibrationRoutes(AsyncWebServer* server) {
           return;
         }
 
-        bool ok = sensors.enqueueCalibrateOrp(referenceMv);
+        const bool force = doc["force"] | false;
+        bool ok = sensors.enqueueCalibrateOrp(referenceMv, force);
         if (!ok) {
           sendErrorResponse(req, 503, "calibration queue saturée — réessayer dans 1s");
           return;
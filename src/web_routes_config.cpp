@@ -8,11 +8,15 @@
 #include "filtration.h"
 #include "lighting.h"
 #include "mqtt_manager.h"
+#include "mqtt_tls_logic.h"
+#include "mqtt_topics.h"
 #include "pump_controller.h"
 #include "logger.h"
 #include "version.h"
 #include "json_compat.h"
 #include "rtc_manager.h"
+#include "config_cache.h"
+#include "i2c_bus.h"
 #include <sys/time.h>
 #include <WiFi.h>
 #include <esp_wifi.h>
@@ -60,131 +64,14 @@ static void handleGetConfig(AsyncWebServerRequest* request) {
   // On utilise checkTokenAuth/checkBasicAuth directement pour ne pas bloquer avec sendAuthRequired()
   bool isAuthenticated = authManager.checkTokenAuth(request) || authManager.checkBasicAuth(request);
 
-  // Buffer statique : ~55 champs (configs MQTT, pH, ORP, calibration, WiFi, boost, etc.)
-  // feature-053 : +2 champs boost_active/boost_until → marge portée à 2304.
-  StaticJson<2304> doc;
-  doc["server"] = mqttCfg.server;
-  doc["port"] = mqttCfg.port;
-  doc["topic"] = mqttCfg.topic;
-  doc["username"] = mqttCfg.username;
-  // SÉCURITÉ: Ne jamais envoyer les mots de passe en clair (même si authentifié)
-  doc["password"] = mqttCfg.password.length() > 0 ? "******" : "";
-  doc["enabled"] = mqttCfg.enabled;
-  doc["mqtt_connected"] = mqttManager.isConnected();
-  doc["ph_target"] = roundf(mqttCfg.phTarget * 100.0f) / 100.0f;
-  doc["orp_target"] = roundf(mqttCfg.orpTarget);
-  doc["ph_enabled"] = mqttCfg.phEnabled;
-  doc["ph_regulation_mode"] = mqttCfg.phRegulationMode;
-  doc["ph_daily_target_ml"] = mqttCfg.phDailyTargetMl;
-  doc["ph_pump"] = mqttCfg.phPump;
-  doc["orp_enabled"] = mqttCfg.orpEnabled;  // miroir : true si orpRegulationMode != manual
-  doc["orp_regulation_mode"] = mqttCfg.orpRegulationMode;
-  doc["orp_daily_target_ml"] = mqttCfg.orpDailyTargetMl;
-  doc["max_orp_ml_per_day"] = safetyLimits.maxChlorineMlPerDay;
-  // feature-021 : orp_cal_valid dérivé du cache Cal,? EZO (plus de date NVS).
-  doc["orp_cal_valid"] = sensors.getOrpCalibrationPointsCached() >= 1;
-  doc["orp_pump"] = mqttCfg.orpPump;
-  doc["pump1_max_duty_pct"] = mqttCfg.pump1MaxDutyPct;
-  doc["pump2_max_duty_pct"] = mqttCfg.pump2MaxDutyPct;
-  doc["pump_max_flow_ml_per_min"] = mqttCfg.pumpMaxFlowMlPerMin;
-  doc["ph_limit_minutes"] = mqttCfg.phInjectionLimitMinutes;
-  doc["orp_limit_minutes"] = mqttCfg.orpInjectionLimitMinutes;
-  doc["install_mode"] = installModeToString(mqttCfg.installMode);  // feature-056
-  doc["stabilization_delay_min"] = mqttCfg.stabilizationDelayMin;
-  doc["regulation_speed"] = mqttCfg.regulationSpeed;
-  doc["ph_correction_type"] = mqttCfg.phCorrectionType;
-  doc["time_use_ntp"] = mqttCfg.timeUseNtp;
-  doc["ntp_server"] = mqttCfg.ntpServer;
-  doc["manual_time"] = mqttCfg.manualTimeIso;
-  doc["timezone_id"] = mqttCfg.timezoneId;
-  doc["filtration_mode"] = filtrationCfg.mode;  // feature-056 : filtration_enabled → install_mode
-  doc["filtration_start"] = filtrationCfg.start;
-  doc["filtration_end"] = filtrationCfg.end;
-  doc["filtration_running"] = filtration.isRunning();
-  doc["lighting_feature_enabled"] = lightingCfg.featureEnabled;
-  doc["lighting_enabled"] = lightingCfg.enabled;
-  doc["lighting_brightness"] = lightingCfg.brightness;
-  doc["lighting_schedule_enabled"] = lightingCfg.scheduleEnabled;
-  doc["lighting_start_time"] = lightingCfg.startTime;
-  doc["lighting_end_time"] = lightingCfg.endTime;
-  doc["wifi_ssid"] = WiFi.SSID();
-
-  // Déterminer l'IP à afficher selon le mode WiFi
-  wifi_mode_t mode = WiFi.getMode();
-  String ipAddress;
-  if (mode == WIFI_MODE_AP) {
-    // En mode AP uniquement, afficher l'IP de l'AP
-    ipAddress = WiFi.softAPIP().toString();
-  } else if (mode == WIFI_MODE_APSTA) {
-    // En mode AP+STA, afficher l'IP STA si connecté, sinon l'IP AP
-    if (WiFi.isConnected()) {
-      ipAddress = WiFi.localIP().toString();
-    } else {
-      ipAddress = WiFi.softAPIP().toString();
-    }
-  } else {
-    // En mode STA, afficher l'IP STA
-    ipAddress = WiFi.localIP().toString();
-  }
-  doc["wifi_ip"] = ipAddress;
-
-  doc["wifi_mode"] = mode == WIFI_MODE_AP ? "AP" : (mode == WIFI_MODE_APSTA ? "AP+STA" : "STA");
-  doc["mdns_host"] = kMdnsFullHost;
-  doc["max_ph_ml_per_day"] = safetyLimits.maxPhMlPerDay;
-  doc["max_chlorine_ml_per_day"] = safetyLimits.maxChlorineMlPerDay;
-  // feature-021 : Calibration capteurs Atlas EZO — stockée dans le module
-  // (NVS interne EZO), exposée ici via le cache Cal,?.
-  // Les champs voltage / offset / slope / date NVS legacy ont été supprimés.
-  doc["ph_cal_valid"]   = sensors.getPhCalibrationPointsCached() >= 1;
-  doc["ph_cal_points"]  = sensors.getPhCalibrationPointsCached();
-  doc["orp_cal_points"] = sensors.getOrpCalibrationPointsCached();
-
-  // Données de calibration Température (offset utilisateur DS18B20)
-  doc["temp_calibration_offset"] = mqttCfg.tempCalibrationOffset;
-  doc["temp_calibration_date"] = mqttCfg.tempCalibrationDate;
-  doc["temperature_enabled"] = mqttCfg.temperatureEnabled;
-
-  // Configuration d'authentification
-  doc["auth_enabled"] = authCfg.enabled;
-
-  // Options de développement
-  doc["sensor_logs_enabled"] = authCfg.sensorLogsEnabled;
-  doc["debug_logs_enabled"] = authCfg.debugLogsEnabled;
-  doc["screen_enabled"] = authCfg.screenEnabled;
-
-  // SÉCURITÉ: Masquer les credentials si non authentifié
-  if (isAuthenticated) {
-    // Utilisateur authentifié : montrer password et token masqués (indication qu'ils existent)
-    doc["auth_password"] = authCfg.adminPassword.length() > 0 ? "******" : "";
-    doc["auth_token"] = authCfg.apiToken.length() > 8 ? (authCfg.apiToken.substring(0, 8) + "...") : "";
-  } else {
-    // Utilisateur non authentifié : ne pas révéler si credentials sont configurés
-    doc["auth_password"] = "******";
-    doc["auth_token"] = "********...";
-  }
-
-  // Suivi volumes produits
-  float phRemaining = max(0.0f, productCfg.phContainerVolumeMl - productCfg.phTotalInjectedMl);
-  float orpRemaining = max(0.0f, productCfg.orpContainerVolumeMl - productCfg.orpTotalInjectedMl);
-  doc["ph_tracking_enabled"] = productCfg.phTrackingEnabled;
-  doc["ph_container_ml"] = productCfg.phContainerVolumeMl;
-  doc["ph_total_injected_ml"] = productCfg.phTotalInjectedMl;
-  doc["ph_remaining_ml"] = phRemaining;
-  doc["ph_alert_threshold_ml"] = productCfg.phAlertThresholdMl;
-  doc["orp_tracking_enabled"] = productCfg.orpTrackingEnabled;
-  doc["orp_container_ml"] = productCfg.orpContainerVolumeMl;
-  doc["orp_total_injected_ml"] = productCfg.orpTotalInjectedMl;
-  doc["orp_remaining_ml"] = orpRemaining;
-  doc["orp_alert_threshold_ml"] = productCfg.orpAlertThresholdMl;
-
-  // Heure actuelle (pour l'affichage dans la configuration)
-  doc["time_current"] = getCurrentTimeISO();
-
-  // feature-053 : Mode Boost (état effectif + epoch d'expiration, 0 si inactif).
-  doc["boost_active"] = isBoostActive(time(nullptr));
-  doc["boost_until"] = (long)boostState.untilEpoch;
-
-  sendJsonResponse(request, doc);
+  // Champs stables servis depuis le cache versionné (config_cache.h) ; seuls les
+  // champs volatils sont recalculés. 304 sans corps si l'ETag du client est à jour.
+  String json;
+  json.reserve(2304);
+  String etag;
+  configCache.render(ConfigView::Web, isAuthenticated, json, &etag);
+  if (handleIfNoneMatch(request, etag)) return;
+  sendRawJsonResponseWithEtag(request, json, etag);
 }
 
 static void handleSaveConfig(AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
@@ -255,6 +142,57 @@ static void handleSaveConfig(AsyncWebServerRequest* request, uint8_t* data, size
   const String oldMqttUsername = mqttCfg.username;
   const String oldMqttPassword = mqttCfg.password;
   const bool   oldMqttEnabled  = mqttCfg.enabled;
+  const bool   oldMqttStateJson = mqttCfg.stateJson;
+  const bool   oldMqttTls      = mqttCfg.tls;
+  const String oldMqttTlsPin   = mqttCfg.tlsFingerprint;
+
+  // Topic de base borné (arène mqtt_topics) : refus explicite plutôt qu'une
+  // base tronquée ou remplacée à l'exécution.
+  if (!doc["topic"].isNull()) {
+    const char* topicStart = nullptr;
+    if (mqttTopicNormalizeBase(doc["topic"].as<const char*>(), &topicStart) > kMqttMaxBaseLen) {
+      xSemaphoreGiveRecursive(configMutex);
+      request->send(400, "application/json",
+        "{\"error\":\"topic : " + String(kMqttMaxBaseLen) + " caract\\u00e8res maximum\"}");
+      g_configBuffers->erase(request);
+      g_configErrors->erase(request);
+      return;
+    }
+  }
+
+  // Empreinte TLS validée AVANT toute application : refus fail-closed (400)
+  // plutôt qu'une connexion silencieusement non épinglée. Stockée normalisée.
+  String tlsPin = mqttCfg.tlsFingerprint;
+  if (!doc["tls_fingerprint"].isNull()) {
+    String pinText = doc["tls_fingerprint"].as<String>();
+    pinText.trim();
+    char normalized[kMqttTlsPinTextMax] = "";
+    if (pinText.length() > 0) {
+      uint8_t pin[kMqttTlsPinLen];
+      if (!mqttTlsParsePin(pinText.c_str(), pin)) {
+        xSemaphoreGiveRecursive(configMutex);
+        request->send(400, "application/json",
+          "{\"error\":\"tls_fingerprint : empreinte SHA-256 invalide (64 hex)\"}");
+        g_configBuffers->erase(request);
+        g_configErrors->erase(request);
+        return;
+      }
+      mqttTlsFormatPin(pin, normalized, sizeof(normalized));
+    }
+    tlsPin = normalized;
+  }
+  // TLS sans empreinte : pas de CA embarquée, le broker ne serait pas
+  // authentifié (identifiants MQTT exposés à un intermédiaire) → refus.
+  const bool tlsRequested = doc["tls"].isNull() ? mqttCfg.tls : doc["tls"].as<bool>();
+  if (tlsRequested && tlsPin.length() == 0) {
+    xSemaphoreGiveRecursive(configMutex);
+    request->send(400, "application/json",
+      "{\"error\":\"tls_fingerprint : empreinte obligatoire en TLS\"}");
+    g_configBuffers->erase(request);
+    g_configErrors->erase(request);
+    return;
+  }
+  mqttCfg.tlsFingerprint = tlsPin;
 
   // Validation et application avec logs
   if (!doc["server"].isNull()) mqttCfg.server = doc["server"].as<String>();
@@ -271,6 +209,8 @@ static void handleSaveConfig(AsyncWebServerRequest* request, uint8_t* data, size
   }
 
   if (!doc["enabled"].isNull()) mqttCfg.enabled = doc["enabled"];
+  if (!doc["state_json"].isNull()) mqttCfg.stateJson = doc["state_json"];
+  if (!doc["tls"].isNull()) mqttCfg.tls = doc["tls"];
   if (!doc["ph_target"].isNull()) mqttCfg.phTarget = doc["ph_target"];
   if (!doc["orp_target"].isNull()) mqttCfg.orpTarget = doc["orp_target"];
   if (!doc["ph_enabled"].isNull()) mqttCfg.phEnabled = doc["ph_enabled"];
@@ -558,7 +498,12 @@ static void handleSaveConfig(AsyncWebServerRequest* request, uint8_t* data, size
                      (mqttCfg.topic    != oldMqttTopic)    ||
                      (mqttCfg.username != oldMqttUsername) ||
                      (mqttCfg.password != oldMqttPassword) ||
-                     (mqttCfg.enabled  != oldMqttEnabled);
+                     (mqttCfg.enabled  != oldMqttEnabled)  ||
+                     // Changement de mode de publication : nouvelle discovery HA
+                     (mqttCfg.stateJson != oldMqttStateJson) ||
+                     // Transport TLS / épinglage : nouvelle connexion (et nouvelle clé de session)
+                     (mqttCfg.tls != oldMqttTls) ||
+                     (mqttCfg.tlsFingerprint != oldMqttTlsPin);
   if (mqttChanged) {
     systemLogger.info("MQTT reconnect demandé (config MQTT modifiée)");
     mqttManager.requestReconnect();
@@ -566,7 +511,7 @@ static void handleSaveConfig(AsyncWebServerRequest* request, uint8_t* data, size
 
   // feature-021 : pH/ORP calibrés en interne par les modules EZO ; seul l'offset
   // température utilisateur est appliqué côté firmware (alias eau dans
-  // SensorManager::_readDs18b20s()). Pas besoin de recalcul global ici.
+  // SensorManager::_finishDs18b20Cycle()). Pas besoin de recalcul global ici.
 
   // Libérer le mutex
   xSemaphoreGiveRecursive(configMutex);
@@ -592,7 +537,7 @@ static void handleRebootAp(AsyncWebServerRequest* request);  // Forward declarat
 static void handleGetSystemInfo(AsyncWebServerRequest* request) {
   REQUIRE_AUTH(request, RouteProtection::WRITE);
 
-  // Buffer statique : ~24 champs (version, chip, memory, WiFi, uptime) = 1024 bytes
+  // Buffer statique : ~24 champs (version, chip, memory, WiFi, uptime) + 4 × 7 stats bus ≈ 1024 bytes
   StaticJson<1024> doc;
 
   // Version firmware
@@ -635,6 +580,22 @@ static void handleGetSystemInfo(AsyncWebServerRequest* request) {
   doc["uptime_hours"] = (uptime % 86400) / kSecondsPerHour;
   doc["uptime_minutes"] = (uptime % kSecondsPerHour) / kSecondsPerMinute;
 
+  // Bus capteurs (ADR-0028) : par périphérique
+  // [transactions, attente moy/max ms, tenue moy/max ms, expirées, en retard]
+  JsonObject bus = doc["i2c_bus"].to<JsonObject>();
+  for (uint8_t d = 0; d < kI2cDeviceCount; ++d) {
+    const I2cDeviceStats& st = i2cBus.stats(static_cast<I2cDevice>(d));
+    JsonArray a = bus[i2cDeviceName(static_cast<I2cDevice>(d))].to<JsonArray>();
+    a.add(st.txns);
+    a.add(st.avgWaitMs());
+    a.add(st.waitMaxMs);
+    a.add(st.avgHoldMs());
+    a.add(st.holdMaxMs);
+    a.add(st.expired);
+    a.add(st.late);
+  }
+  doc["i2c_bus_peak_pending"] = i2cBus.peakPending();
+
   sendJsonResponse(request, doc);
 }
 
@@ -817,9 +778,8 @@ void setupConfigRoutes(AsyncWebServer* server, bool* restartApRequested, unsigne
         req->send(400, "text/plain", "Invalid JSON configuration");
       } else {
         req->send(200, "text/plain", "OK");
-        // Exécuté en tâche AsyncTCP (~8 KB stack). _buildConfigJson() alloue
-        // un StaticJson<2048> sur la pile : on diffère le broadcast à la main
-        // loop pour éviter le PANIC stack overflow.
+        // Exécuté en tâche AsyncTCP (~8 KB stack) : on diffère le broadcast
+        // (rendu + textAll) à la main loop pour ne pas charger cette pile.
         wsManager.requestConfigBroadcast();
       }
     },
@@ -72,6 +72,19 @@ static void handleGetData(AsyncWebServerRequest* request) {
   doc["phCalPoints"]  = sensors.getPhCalibrationPointsCached();
   doc["orpCalPoints"] = sensors.getOrpCalibrationPointsCached();
 
+  // Fraîcheur des mesures + cycle de lecture pH/ORP (mêmes champs que le WS).
+  uint32_t phAge  = sensors.getPhSampleAgeMs();
+  uint32_t orpAge = sensors.getOrpSampleAgeMs();
+  if (phAge == UINT32_MAX)  doc["phAgeMs"] = nullptr;  else doc["phAgeMs"] = phAge;
+  if (orpAge == UINT32_MAX) doc["orpAgeMs"] = nullptr; else doc["orpAgeMs"] = orpAge;
+  const EzoReadCycle& ezo = sensors.ezoCycle();
+  doc["ezoCycleMs"]    = ezo.lastCycleMs();
+  doc["ezoCycleMaxMs"] = ezo.maxCycleMs();
+  doc["ezoBusHoldUs"]  = ezo.lastBusHoldUs();
+  uint32_t tempAge = sensors.getWaterTempAgeMs();
+  if (tempAge == UINT32_MAX) doc["tempAgeMs"] = nullptr; else doc["tempAgeMs"] = tempAge;
+  doc["ds18b20ConvMs"] = sensors.ds18b20Conversion().lastConversionMs();
+
   // Température (offset utilisateur appliqué dans getTemperature())
   if (!isnan(sensors.getTemperature())) {
     doc["temperature"] = sensors.getTemperature();
@@ -311,8 +324,18 @@ static void handleGetHistory(AsyncWebServerRequest* request) {
   sendRawJsonResponse(request, json);
 }
 
+// GET /sensors/health — santé glissante des voies pH / ORP (bruit, pics,
+// échecs I²C, latence, score 0-100), cf. sensor_health_logic.h.
+static void handleGetSensorHealth(AsyncWebServerRequest* request) {
+  REQUIRE_AUTH(request, RouteProtection::WRITE);
+  JsonDocument doc;
+  sensors.fillHealthJson(doc.to<JsonObject>());
+  sendJsonResponse(request, doc);
+}
+
 void setupDataRoutes(AsyncWebServer* server) {
   server->on("/data", HTTP_GET, handleGetData);
+  server->on("/sensors/health", HTTP_GET, handleGetSensorHealth);
   server->on("/get-logs", HTTP_GET, handleGetLogs);
   server->on("/download-logs", HTTP_GET, handleDownloadLogs);
   server->on("/logs", HTTP_DELETE, [](AsyncWebServerRequest* request) {
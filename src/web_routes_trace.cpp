@@ -0,0 +1,114 @@
+#include "web_routes_trace.h"
+#include "web_helpers.h"
+#include "auth.h"
+#include "logger.h"
+#include "sensor_trace.h"
+#include <ArduinoJson.h>
+
+static void fillTraceInfo(JsonDocument& doc) {
+  doc["available"]    = sensorTrace.available();
+  doc["active"]       = sensorTrace.active();
+  doc["remaining_s"]  = sensorTrace.remainingMs() / 1000UL;
+  doc["session"]      = sensorTrace.session();
+  doc["last_seq"]     = sensorTrace.lastSeq();
+  doc["dropped"]      = sensorTrace.dropped();
+  doc["capacity"]     = kSensorTraceCapacity;
+  doc["record_size"]  = static_cast<unsigned>(sizeof(SensorTraceRecord));
+}
+
+// POST /sensor-trace/start?minutes=N — arme la capture (défaut 60, max 1440)
+static void handleTraceStart(AsyncWebServerRequest* request) {
+  REQUIRE_AUTH(request, RouteProtection::WRITE);
+
+  if (!sensorTrace.available()) {
+    sendErrorResponse(request, 503, "Partition history indisponible");
+    return;
+  }
+  uint32_t durationMs = kSensorTraceDefaultArmMs;
+  if (request->hasParam("minutes")) {
+    const long minutes = request->getParam("minutes")->value().toInt();
+    if (minutes <= 0 || static_cast<uint32_t>(minutes) > kSensorTraceMaxArmMs / 60000UL) {
+      sendErrorResponse(request, 400, "minutes hors plage (1-" +
+                        String(kSensorTraceMaxArmMs / 60000UL) + ")");
+      return;
+    }
+    durationMs = static_cast<uint32_t>(minutes) * 60000UL;
+  }
+  if (!sensorTrace.start(durationMs)) {
+    sendErrorResponse(request, 500, "Armement de la trace impossible");
+    return;
+  }
+  JsonDocument doc;
+  doc["success"] = true;
+  fillTraceInfo(doc);
+  sendJsonResponse(request, doc);
+}
+
+// POST /sensor-trace/stop — désarme et écrit les enregistrements en attente
+static void handleTraceStop(AsyncWebServerRequest* request) {
+  REQUIRE_AUTH(request, RouteProtection::WRITE);
+
+  sensorTrace.stop();
+  JsonDocument doc;
+  doc["success"] = true;
+  fillTraceInfo(doc);
+  sendJsonResponse(request, doc);
+}
+
+// GET /sensor-trace/info — état de l'enregistreur
+static void handleTraceInfo(AsyncWebServerRequest* request) {
+  REQUIRE_AUTH(request, RouteProtection::WRITE);
+
+  JsonDocument doc;
+  fillTraceInfo(doc);
+  sendJsonResponse(request, doc);
+}
+
+// GET /sensor-trace/download — anneau brut (pour tools/trace_replay.sh)
+static void handleTraceDownload(AsyncWebServerRequest* request) {
+  REQUIRE_AUTH(request, RouteProtection::WRITE);
+
+  const size_t size = sensorTrace.prepareDownload();
+  if (size == 0) {
+    request->send(404, "text/plain", "Trace capteurs indisponible");
+    return;
+  }
+
+  // Lecture par blocs à la demande (pas de copie des ~4 Ko de l'anneau en
+  // RAM). Une capture armée peut écrire entre deux blocs : chaque slot reste
+  // cohérent, l'outil reconstruit l'ordre par seq. Mutex occupé : le bloc est
+  // redemandé (RESPONSE_TRY_AGAIN) plutôt que de renvoyer 0, qui tronquerait
+  // le flux sous un Content-Length complet.
+  AsyncWebServerResponse* response = request->beginResponse(
+    "application/octet-stream", size,
+    [](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+      size_t got = 0;
+      if (!sensorTrace.readAt(index, buffer, maxLen, got)) return RESPONSE_TRY_AGAIN;
+      return got;
+    });
+  response->addHeader("Content-Disposition", "attachment; filename=\"sensor_trace.bin\"");
+  request->send(response);
+  systemLogger.info("Trace capteurs téléchargée (seq " + String(sensorTrace.lastSeq()) + ")");
+}
+
+// DELETE /sensor-trace — efface l'anneau (désarme)
+static void handleTraceErase(AsyncWebServerRequest* request) {
+  REQUIRE_AUTH(request, RouteProtection::WRITE);
+
+  if (!sensorTrace.clear()) {
+    sendErrorResponse(request, 500, "Effacement de la trace impossible");
+    return;
+  }
+  systemLogger.info("Trace capteurs effacée");
+  JsonDocument doc;
+  doc["success"] = true;
+  sendJsonResponse(request, doc);
+}
+
+void setupTraceRoutes(AsyncWebServer* server) {
+  server->on("/sensor-trace/start",    HTTP_POST,   handleTraceStart);
+  server->on("/sensor-trace/stop",     HTTP_POST,   handleTraceStop);
+  server->on("/sensor-trace/info",     HTTP_GET,    handleTraceInfo);
+  server->on("/sensor-trace/download", HTTP_GET,    handleTraceDownload);
+  server->on("/sensor-trace",          HTTP_DELETE, handleTraceErase);
+}
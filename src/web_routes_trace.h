@@ -0,0 +1,8 @@
+#ifndef WEB_ROUTES_TRACE_H
+#define WEB_ROUTES_TRACE_H
+
+#include <ESPAsyncWebServer.h>
+
+void setupTraceRoutes(AsyncWebServer* server);
+
+#endif // WEB_ROUTES_TRACE_H
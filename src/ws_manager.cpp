@@ -13,6 +13,8 @@
 #include "lighting.h"
 #include "auth.h"
 #include "json_compat.h"
+#include "config_cache.h"
+#include "fixed_format.h"
 
 static const char* getResetReason() {
   switch (esp_reset_reason()) {
@@ -36,43 +38,53 @@ WsManager wsManager;
 // =============================================================================
 
 void WsManager::begin(AsyncWebServer* server) {
+  _clientsMutex = xSemaphoreCreateMutex();
   _ws = new AsyncWebSocket("/ws");
   _ws->onEvent([this](AsyncWebSocket* ws, AsyncWebSocketClient* client,
                        AwsEventType type, void* arg, uint8_t* data, size_t len) {
     _onEvent(ws, client, type, arg, data, len);
   });
   server->addHandler(_ws);
+  _logCursor = systemLogger.getSequence();
 
-  systemLogger.info("WebSocket démarré sur /ws (push capteurs toutes les 5s)");
+  systemLogger.info("WebSocket démarré sur /ws (push capteurs adaptatif 1-60s)");
 }
 
 void WsManager::update() {
   if (!_ws) return;
   _ws->cleanupClients(4);  // Max 4 clients WS simultanés pour préserver les sockets lwIP
 
-  if (_authenticatedClients.empty()) return;
+  bool noClient = true;
+  if (xSemaphoreTake(_clientsMutex, pdMS_TO_TICKS(kWsClientsMutexTimeoutMs)) == pdTRUE) {
+    noClient = _clients.empty();
+    xSemaphoreGive(_clientsMutex);
+  } else {
+    return;  // AsyncTCP modifie la table : on repasse au tour suivant
+  }
 
-  if (_pendingInitialPush) {
-    _pendingInitialPush = false;
-    _pendingConfigBroadcast = false;  // initial push couvre déjà la config
-    broadcastSensorData();
-    broadcastConfig();
-    _lastSensorPush = millis();
+  if (noClient) {
+    // Personne à servir : le curseur suit le Logger pour ne pas rejouer l'arriéré
+    // au prochain client (l'UI charge l'historique via /get-logs).
+    _logCursor = systemLogger.getSequence();
+    _logBatchOpen = false;
+    _calGenSent = sensors.calibrationGeneration();
     return;
   }
 
+  _flushLogBatch();
+  _pushCalibration();
+
   if (_pendingConfigBroadcast) {
     _pendingConfigBroadcast = false;
     broadcastConfig();
   }
 
-  if (millis() - _lastSensorPush >= kSensorPushIntervalMs) {
-    broadcastSensorData();
-    _lastSensorPush = millis();
-  }
+  _schedulePushes();
 }
 
 void WsManager::requestConfigBroadcast() {
+  // Toute demande de resync signale une mutation : invalide aussi le cache de config.
+  bumpConfigGeneration();
   _pendingConfigBroadcast = true;
 }
 
@@ -91,15 +103,20 @@ void WsManager::_onEvent(AsyncWebSocket* ws, AsyncWebSocketClient* client,
   } else if (type == WS_EVT_DATA) {
     _onData(client, data, len);
   } else if (type == WS_EVT_DISCONNECT) {
-    _authenticatedClients.erase(client->id());
+    if (xSemaphoreTake(_clientsMutex, portMAX_DELAY) == pdTRUE) {
+      _clients.erase(client->id());
+      xSemaphoreGive(_clientsMutex);
+    }
   }
 }
 
 void WsManager::_onClientConnect(AsyncWebSocketClient* client, AsyncWebServerRequest* request) {
   if (!authCfg.enabled) {
-    // Pas d'auth : client immédiatement autorisé
-    _authenticatedClients.insert(client->id());
-    _pendingInitialPush = true;
+    // Pas d'auth : client immédiatement autorisé (push initial au prochain update)
+    if (xSemaphoreTake(_clientsMutex, portMAX_DELAY) == pdTRUE) {
+      _clients[client->id()] = ClientState();
+      xSemaphoreGive(_clientsMutex);
+    }
   }
   // Si auth activée : attendre le message {"type":"auth","token":"..."} dans _onData
 }
@@ -107,7 +124,26 @@ void WsManager::_onClientConnect(AsyncWebSocketClient* client, AsyncWebServerReq
 void WsManager::_onData(AsyncWebSocketClient* client, uint8_t* data, size_t len) {
   StaticJson<256> doc;
   if (deserializeJson(doc, data, len) != DeserializationError::Ok) return;
-  if (doc["type"] != "auth") return;
+  const char* type = doc["type"] | "";
+
+  if (strcmp(type, "client_state") == 0) {
+    // Visibilité / vue live rapportées par l'UI — ignoré pour un client non authentifié.
+    if (xSemaphoreTake(_clientsMutex, portMAX_DELAY) != pdTRUE) return;
+    auto it = _clients.find(client->id());
+    if (it != _clients.end()) {
+      ClientState& st = it->second;
+      bool hidden = doc["hidden"] | false;
+      bool live = doc["live"] | false;
+      // Retour au premier plan ou ouverture d'une vue live : push immédiat.
+      if ((st.hidden && !hidden) || (!st.live && live)) st.lastPushMs = 0;
+      st.hidden = hidden;
+      st.live = live;
+    }
+    xSemaphoreGive(_clientsMutex);
+    return;
+  }
+
+  if (strcmp(type, "auth") != 0) return;
 
   String token = doc["token"] | "";
   // feature-028 : comparaison à temps constant (même exigence que l'auth HTTP)
@@ -116,8 +152,10 @@ void WsManager::_onData(AsyncWebSocketClient* client, uint8_t* data, size_t len)
     client->close();
     return;
   }
-  _authenticatedClients.insert(client->id());
-  _pendingInitialPush = true;
+  if (xSemaphoreTake(_clientsMutex, portMAX_DELAY) == pdTRUE) {
+    _clients[client->id()] = ClientState();
+    xSemaphoreGive(_clientsMutex);
+  }
 }
 
 // =============================================================================
@@ -126,7 +164,24 @@ void WsManager::_onData(AsyncWebSocketClient* client, uint8_t* data, size_t len)
 
 void WsManager::broadcastSensorData() {
   if (!_ws || _ws->count() == 0) return;
-  _ws->textAll(_buildSensorJson());
+
+  uint32_t ids[kMaxScheduledClients];
+  size_t n = 0;
+  const uint32_t now = millis();
+  if (xSemaphoreTake(_clientsMutex, pdMS_TO_TICKS(kWsClientsMutexTimeoutMs)) != pdTRUE) return;
+  for (auto& kv : _clients) {
+    if (n >= kMaxScheduledClients) break;
+    ids[n++] = kv.first;
+    kv.second.lastPushMs = now ? now : 1;  // recale le planificateur : pas de doublon au tour suivant
+  }
+  xSemaphoreGive(_clientsMutex);
+  if (n == 0) return;
+
+  String json = _buildSensorJson();
+  for (size_t i = 0; i < n; ++i) {
+    AsyncWebSocketClient* c = _ws->client(ids[i]);
+    if (c) c->text(json);
+  }
 }
 
 void WsManager::broadcastConfig() {
@@ -134,16 +189,119 @@ void WsManager::broadcastConfig() {
   _ws->textAll(_buildConfigJson());
 }
 
-void WsManager::broadcastLog(const LogEntry& entry) {
+// Planificateur sensor_data : pour chaque client authentifié, relève la file
+// d'envoi (latence du lien), calcule l'intervalle (wsPushIntervalMs) et pousse
+// si dû. Le JSON n'est construit qu'une fois par tour, et seulement si au moins
+// un client est servi. Trois passes pour ne jamais appeler l'API AsyncWebSocket
+// (verrou interne) en tenant _clientsMutex, lui-même pris depuis AsyncTCP.
+void WsManager::_schedulePushes() {
+  uint32_t ids[kMaxScheduledClients];
+  uint32_t queueLens[kMaxScheduledClients];
+  bool queueFull[kMaxScheduledClients];
+  bool due[kMaxScheduledClients];
+  bool initial[kMaxScheduledClients];
+  size_t n = 0;
+
+  if (xSemaphoreTake(_clientsMutex, pdMS_TO_TICKS(kWsClientsMutexTimeoutMs)) != pdTRUE) return;
+  for (const auto& kv : _clients) {
+    if (n >= kMaxScheduledClients) break;
+    ids[n++] = kv.first;
+  }
+  xSemaphoreGive(_clientsMutex);
+  if (n == 0) return;
+
+  for (size_t i = 0; i < n; ++i) {
+    AsyncWebSocketClient* c = _ws->client(ids[i]);
+    queueLens[i] = c ? c->queueLen() : 0;
+    queueFull[i] = !c || c->queueIsFull();
+  }
+
+  const uint32_t now = millis();
+  const bool active = PumpController.isPhDosing() || PumpController.isOrpDosing();
+  bool anyDue = false, anyInitial = false;
+  if (xSemaphoreTake(_clientsMutex, pdMS_TO_TICKS(kWsClientsMutexTimeoutMs)) != pdTRUE) return;
+  for (size_t i = 0; i < n; ++i) {
+    due[i] = initial[i] = false;
+    auto it = _clients.find(ids[i]);
+    if (it == _clients.end()) continue;  // déconnecté entre-temps
+    ClientState& st = it->second;
+    wsLinkObserve(st.link, queueLens[i], now);
+    if (queueFull[i]) continue;  // back-pressure : le lien n'absorbe plus, on saute ce tour
+    const WsPushPolicyInput in = {st.hidden, st.live, active, wsLinkLatencyMs(st.link, now)};
+    if (!st.needsInitial && !wsPushDue(st.lastPushMs, now, wsPushIntervalMs(in))) continue;
+    due[i] = true;
+    initial[i] = st.needsInitial;
+    st.needsInitial = false;
+    st.lastPushMs = now ? now : 1;
+    anyDue = true;
+    anyInitial |= initial[i];
+  }
+  xSemaphoreGive(_clientsMutex);
+  if (!anyDue) return;
+
+  const String sensorJson = _buildSensorJson();
+  const String configJson = anyInitial ? _buildConfigJson() : String();
+  for (size_t i = 0; i < n; ++i) {
+    if (!due[i]) continue;
+    AsyncWebSocketClient* c = _ws->client(ids[i]);
+    if (!c) continue;
+    if (initial[i]) c->text(configJson);  // push initial : config puis capteurs
+    c->text(sensorJson);
+  }
+}
+
+// Envoie les logs en attente en une seule trame. Appelé à chaque tour de loopTask :
+// le lot part quand la fenêtre kLogBatchWindowMs est écoulée depuis la 1re entrée
+// en attente, ou dès que kLogBatchMaxEntries entrées sont accumulées (rafale boot/défaut).
+void WsManager::_flushLogBatch() {
+  const uint32_t pending = systemLogger.getSequence() - _logCursor;
+  if (pending == 0) {
+    _logBatchOpen = false;
+    return;
+  }
+  unsigned long now = millis();
+  if (!_logBatchOpen) {
+    _logBatchOpen = true;
+    _logBatchOpenedAt = now;
+  }
+  if (pending < kLogBatchMaxEntries && now - _logBatchOpenedAt < kLogBatchWindowMs) return;
+
+  std::vector<LogEntry> entries;
+  entries.reserve(kLogBatchMaxEntries);
+  if (systemLogger.getLogsSince(_logCursor, entries, kLogBatchMaxEntries) == 0) return;
+  // Reste en attente (rafale > 1 trame) : nouvelle fenêtre ouverte au tour suivant
+  _logBatchOpen = false;
   if (!_ws || _ws->count() == 0) return;
-  StaticJson<192> doc;
-  doc["type"] = "log";
-  JsonObject d = doc["data"].to<JsonObject>();
-  d["timestamp"] = entry.timestamp;
-  d["level"] = systemLogger.getLevelString(entry.level);
-  d["message"] = entry.message;
+
+  // JsonDocument (heap) : taille variable selon la longueur des messages, libéré en fin de fonction
+  JsonDocument doc;
+  doc["type"] = "logs";
+  JsonArray arr = doc["data"].to<JsonArray>();
+  for (const LogEntry& entry : entries) {
+    JsonObject o = arr.add<JsonObject>();
+    o["timestamp"] = entry.timestamp;
+    o["level"] = systemLogger.getLevelString(entry.level);
+    o["message"] = entry.message;
+  }
+  String out;
+  out.reserve(entries.size() * 96 + 32);
+  serializeJson(doc, out);
+  _ws->textAll(out);
+}
+
+// Progression de calibration : poussée dès que SensorManager la fait évoluer
+// (loopTask, même tâche que update) → l'UI n'a plus à deviner la fin par
+// scrutation des points de calibration.
+void WsManager::_pushCalibration() {
+  const uint32_t gen = sensors.calibrationGeneration();
+  if (gen == _calGenSent) return;
+  _calGenSent = gen;
+  if (!_ws || _ws->count() == 0) return;
+
+  JsonDocument doc;
+  doc["type"] = "calibration";
+  sensors.fillCalibrationJson(doc["data"].to<JsonObject>());
   String out;
-  out.reserve(192);
   serializeJson(doc, out);
   _ws->textAll(out);
 }
@@ -174,38 +332,53 @@ String WsManager::_buildSensorJson() const {
   // bruts (rétrocompat scheduled/diagnostic), mais l'utilisateur affiche la mesure lissée.
   // Le brut reste exposé séparément via phRaw/orpRaw pour diagnostic EMI. Si le filtre n'est
   // pas encore amorcé (NaN filtré), on retombe sur le brut pour ne pas afficher "--" au boot.
-  // Lectures cachées en variables locales pour éviter une race entre le check `isnan` et le `round`.
-  float orpRaw = sensors.getOrpRaw();
-  float phRaw  = sensors.getPhRaw();
-  float orpFiltered = sensors.getOrpFiltered();
-  float phFiltered  = sensors.getPhFiltered();
-  float orpMedian = sensors.getOrpMedian();
-  float phMedian  = sensors.getPhMedian();
-  // Valeur principale = filtrée si disponible, sinon brut (warmup), sinon null.
-  float orpVal = !isnan(orpFiltered) ? orpFiltered : orpRaw;
-  float phVal  = !isnan(phFiltered)  ? phFiltered  : phRaw;
+  // Lectures cachées en variables locales pour éviter une race entre le check `isnan` et l'arrondi.
+  // Arrondis fixedRound (fixed_format.h) : mêmes valeurs que les payloads MQTT.
+  // Champs générés depuis la table des voies (sensor_channel.h), préfixés par
+  // la clé de voie : <clé>, <clé>Raw, <clé>Median, <clé>Filtered,
+  // <clé>FilterReady, <clé>FilterUnstable, <clé>RejectedCount, <clé>CalPoints
+  // (cache, pas d'I²C dans le chemin WS), <clé>AgeMs. Arrondi : décimales de la voie.
+  uint32_t nowMs = millis();
+  for (size_t i = 0; i < sensors.channelCount(); ++i) {
+    const SensorChannel& ch = sensors.channel(i);
+    const char* key = ch.info().key;
+    const uint8_t dec = ch.info().decimals;
+    const SensorFilterCore& f = ch.filter();
+    float raw = ch.valueAt(nowMs);
+    float median = f.median();
+    float filtered = f.filtered();
+    // Valeur principale = filtrée si disponible, sinon brut (warmup), sinon null.
+    float val = !isnan(filtered) ? filtered : raw;
+    // Clés composées : char[] non const → copiées par ArduinoJson.
+    char k[24];
+    if (!isnan(val)) d[key] = fixedRound(val, dec); else d[key] = nullptr;
+    // feature-025 : champs filtre — null si NaN/indisponible (EZO débranché → UI sans crash).
+    snprintf(k, sizeof(k), "%sRaw", key);
+    if (!isnan(raw)) d[k] = fixedRound(raw, dec); else d[k] = nullptr;
+    snprintf(k, sizeof(k), "%sMedian", key);
+    if (!isnan(median)) d[k] = fixedRound(median, dec); else d[k] = nullptr;
+    snprintf(k, sizeof(k), "%sFiltered", key);
+    if (!isnan(filtered)) d[k] = fixedRound(filtered, dec); else d[k] = nullptr;
+    snprintf(k, sizeof(k), "%sFilterReady", key);
+    d[k] = f.ready(nowMs);
+    snprintf(k, sizeof(k), "%sFilterUnstable", key);
+    d[k] = f.unstable();
+    snprintf(k, sizeof(k), "%sRejectedCount", key);
+    d[k] = f.rejectedCount();
+    // feature-021 : statut calibration EZO.
+    snprintf(k, sizeof(k), "%sCalPoints", key);
+    d[k] = ch.calPoints();
+    // Fraîcheur de la mesure.
+    const uint32_t age = ch.ageMs(nowMs);
+    snprintf(k, sizeof(k), "%sAgeMs", key);
+    if (age == UINT32_MAX) d[k] = nullptr; else d[k] = age;
+  }
   float tVal   = sensors.getTemperature();
   // T° eau brute (sans offset utilisateur) : exposée pour permettre à l'UI de calibration
   // de calculer un nouvel offset à partir d'une référence externe sans dépendre de la
   // formule firmware. NaN si sonde "eau" non identifiée.
   float tRawWater = sensors.getWaterTemperatureRaw();
-  if (!isnan(orpVal))     d["orp"] = orpVal;                                    else d["orp"] = nullptr;
-  if (!isnan(phVal))      d["ph"]  = round(phVal * 1000.0f) / 1000.0f;          else d["ph"] = nullptr;
-  // feature-025 : champs filtre — null si NaN/indisponible (EZO débranché → UI sans crash).
-  if (!isnan(phRaw))      d["phRaw"] = round(phRaw * 1000.0f) / 1000.0f;        else d["phRaw"] = nullptr;
-  if (!isnan(phMedian))   d["phMedian"] = round(phMedian * 1000.0f) / 1000.0f;  else d["phMedian"] = nullptr;
-  if (!isnan(phFiltered)) d["phFiltered"] = round(phFiltered * 1000.0f) / 1000.0f; else d["phFiltered"] = nullptr;
-  d["phFilterReady"]    = sensors.isPhFilterReady();
-  d["phFilterUnstable"] = sensors.isPhFilterUnstable();
-  d["phRejectedCount"]  = sensors.getPhRejectedCount();
-  if (!isnan(orpRaw))      d["orpRaw"] = round(orpRaw);                          else d["orpRaw"] = nullptr;
-  if (!isnan(orpMedian))   d["orpMedian"] = round(orpMedian);                    else d["orpMedian"] = nullptr;
-  if (!isnan(orpFiltered)) d["orpFiltered"] = round(orpFiltered);               else d["orpFiltered"] = nullptr;
-  d["orpFilterReady"]    = sensors.isOrpFilterReady();
-  d["orpFilterUnstable"] = sensors.isOrpFilterUnstable();
-  d["orpRejectedCount"]  = sensors.getOrpRejectedCount();
   // Pause mélange hydraulique active (post-injection) + raison de blocage dosage.
-  uint32_t nowMs = millis();
   d["phMixingDelayActive"]  = PumpController.isPhMixingDelayActive(nowMs);
   d["orpMixingDelayActive"] = PumpController.isOrpMixingDelayActive(nowMs);
   // Secondes restantes de pause mélange par pompe (observabilité widget dashboard).
@@ -216,31 +389,36 @@ String WsManager::_buildSensorJson() const {
   if (phBlocked.length() > 0)  d["phDoseBlockedReason"]  = phBlocked;  else d["phDoseBlockedReason"]  = nullptr;
   if (orpBlocked.length() > 0) d["orpDoseBlockedReason"] = orpBlocked; else d["orpDoseBlockedReason"] = nullptr;
   if (!isnan(tVal))       d["temperature"] = tVal;                              else d["temperature"] = nullptr;
-  if (!isnan(tRawWater))  d["temperature_raw"] = round(tRawWater * 100.0f) / 100.0f; else d["temperature_raw"] = nullptr;
+  if (!isnan(tRawWater))  d["temperature_raw"] = fixedRound(tRawWater, 2); else d["temperature_raw"] = nullptr;
   // feature-020 : 2ᵉ sonde DS18B20 "circuit" + indicateurs identification
   float tc = sensors.getCircuitTemperature();
-  if (!isnan(tc))                          d["temperature_circuit"] = round(tc * 10.0f) / 10.0f; else d["temperature_circuit"] = nullptr;
+  if (!isnan(tc))                          d["temperature_circuit"] = fixedRound(tc, kFixedTempDecimals); else d["temperature_circuit"] = nullptr;
   d["sondes_identified"] = sensors.areSondesIdentified();
   d["sondes_detected"]   = sensors.getDetectedSondeCount();
 
-  // feature-021 : statut calibration EZO (lecture cache, pas d'I²C dans le chemin WS).
-  d["phCalPoints"]  = sensors.getPhCalibrationPointsCached();
-  d["orpCalPoints"] = sensors.getOrpCalibrationPointsCached();
-
   // feature-024 : pente sonde pH (cache lu sans I²C).
   // Arrondis : pentes à 1 décimale (résolution EZO), zéro à 2 décimales (mV).
   // null si jamais lu OU bus dégradé (NaN), l'UI affiche alors "—".
   float slopeAcid = sensors.getPhSlopeAcid();
   float slopeBase = sensors.getPhSlopeBase();
   float slopeZero = sensors.getPhSlopeZero();
-  if (!isnan(slopeAcid))  d["phSlopeAcid"] = round(slopeAcid * 10.0f) / 10.0f;     else d["phSlopeAcid"] = nullptr;
-  if (!isnan(slopeBase))  d["phSlopeBase"] = round(slopeBase * 10.0f) / 10.0f;     else d["phSlopeBase"] = nullptr;
-  if (!isnan(slopeZero))  d["phSlopeZero"] = round(slopeZero * 100.0f) / 100.0f;   else d["phSlopeZero"] = nullptr;
+  if (!isnan(slopeAcid))  d["phSlopeAcid"] = fixedRound(slopeAcid, 1); else d["phSlopeAcid"] = nullptr;
+  if (!isnan(slopeBase))  d["phSlopeBase"] = fixedRound(slopeBase, 1); else d["phSlopeBase"] = nullptr;
+  if (!isnan(slopeZero))  d["phSlopeZero"] = fixedRound(slopeZero, 2); else d["phSlopeZero"] = nullptr;
   // phSlopeAgeMs : null si jamais lu (cohérent avec phSlope* nullables), sinon ms écoulés.
   uint32_t slopeAge = sensors.getPhSlopeAgeMs();
   if (slopeAge == UINT32_MAX) d["phSlopeAgeMs"] = nullptr;
   else                        d["phSlopeAgeMs"] = slopeAge;
 
+  // Cycle de lecture parallèle des voies EZO (cache, sans I²C).
+  const EzoReadCycle& ezo = sensors.ezoCycle();
+  d["ezoCycleMs"]    = ezo.lastCycleMs();
+  d["ezoCycleMaxMs"] = ezo.maxCycleMs();
+  d["ezoBusHoldUs"]  = ezo.lastBusHoldUs();
+  uint32_t tempAge = sensors.getWaterTempAgeMs();
+  if (tempAge == UINT32_MAX) d["tempAgeMs"] = nullptr; else d["tempAgeMs"] = tempAge;
+  d["ds18b20ConvMs"] = sensors.ds18b20Conversion().lastConversionMs();
+
   d["filtration_running"]  = filtration.isRunning();
   d["filtration_force_on"] = filtrationCfg.forceOn;
   d["filtration_force_off"] = filtrationCfg.forceOff;
@@ -336,83 +514,12 @@ String WsManager::_buildSensorJson() const {
 }
 
 String WsManager::_buildConfigJson() const {
-  // feature-053 : +2 champs boost_active/boost_until → marge portée à 2304.
-  StaticJson<2304> doc;
-  doc["type"] = "config";
-  JsonObject d = doc["data"].to<JsonObject>();
-
-  d["server"]           = mqttCfg.server;
-  d["port"]             = mqttCfg.port;
-  d["topic"]            = mqttCfg.topic;
-  d["username"]         = mqttCfg.username;
-  d["password"]         = mqttCfg.password.length() > 0 ? "******" : "";
-  d["enabled"]          = mqttCfg.enabled;
-  d["mqtt_connected"]   = mqttManager.isConnected();
-  d["ph_target"]        = mqttCfg.phTarget;
-  d["orp_target"]       = mqttCfg.orpTarget;
-  d["ph_enabled"]       = mqttCfg.phEnabled;  // dérivé : true si mode != manual
-  d["ph_regulation_mode"] = mqttCfg.phRegulationMode;
-  d["ph_daily_target_ml"] = mqttCfg.phDailyTargetMl;
-  d["ph_pump"]          = mqttCfg.phPump;
-  d["orp_enabled"]      = mqttCfg.orpEnabled;  // miroir : true si orpRegulationMode != manual
-  d["orp_regulation_mode"] = mqttCfg.orpRegulationMode;
-  d["orp_daily_target_ml"] = mqttCfg.orpDailyTargetMl;
-  d["max_orp_ml_per_day"]  = safetyLimits.maxChlorineMlPerDay;
-  // feature-021 : orp_cal_valid dérivé de Cal,? (cache) plutôt que d'une date NVS supprimée.
-  d["orp_cal_valid"]    = sensors.getOrpCalibrationPointsCached() >= 1;
-  d["orp_pump"]         = mqttCfg.orpPump;
-  d["pump1_max_duty_pct"] = mqttCfg.pump1MaxDutyPct;
-  d["pump2_max_duty_pct"] = mqttCfg.pump2MaxDutyPct;
-  d["ph_limit_minutes"] = mqttCfg.phInjectionLimitMinutes;
-  d["orp_limit_minutes"] = mqttCfg.orpInjectionLimitMinutes;
-  d["install_mode"]     = installModeToString(mqttCfg.installMode);  // feature-056
-  d["ph_correction_type"] = mqttCfg.phCorrectionType;
-  d["time_use_ntp"]     = mqttCfg.timeUseNtp;
-  d["ntp_server"]       = mqttCfg.ntpServer;
-  d["manual_time"]      = mqttCfg.manualTimeIso;
-  d["timezone_id"]      = mqttCfg.timezoneId;
-  d["filtration_mode"]  = filtrationCfg.mode;  // feature-056 : filtration_enabled → install_mode
-  d["filtration_start"] = filtrationCfg.start;
-  d["filtration_end"]   = filtrationCfg.end;
-  d["filtration_running"] = filtration.isRunning();
-  d["lighting_feature_enabled"] = lightingCfg.featureEnabled;
-  d["lighting_enabled"] = lightingCfg.enabled;
-  d["lighting_brightness"] = lightingCfg.brightness;
-  d["lighting_schedule_enabled"] = lightingCfg.scheduleEnabled;
-  d["lighting_start_time"] = lightingCfg.startTime;
-  d["lighting_end_time"]   = lightingCfg.endTime;
-  d["wifi_ssid"]        = WiFi.SSID();
-
-  wifi_mode_t mode = WiFi.getMode();
-  String ip;
-  if (mode == WIFI_MODE_AP)         ip = WiFi.softAPIP().toString();
-  else if (mode == WIFI_MODE_APSTA) ip = WiFi.isConnected() ? WiFi.localIP().toString() : WiFi.softAPIP().toString();
-  else                              ip = WiFi.localIP().toString();
-  d["wifi_ip"]          = ip;
-  d["wifi_mode"]        = mode == WIFI_MODE_AP ? "AP" : (mode == WIFI_MODE_APSTA ? "AP+STA" : "STA");
-  d["mdns_host"]        = kMdnsFullHost;
-  d["max_ph_ml_per_day"]      = safetyLimits.maxPhMlPerDay;
-  d["max_chlorine_ml_per_day"]= safetyLimits.maxChlorineMlPerDay;
-  // feature-021 : statut calibration EZO depuis le cache Cal,? (lecture sans I²C).
-  // ph_cal_valid = au moins 1 point calibré ; les détails (mid/low) sont dans phCalPoints.
-  d["ph_cal_valid"]     = sensors.getPhCalibrationPointsCached() >= 1;
-  d["ph_cal_points"]    = sensors.getPhCalibrationPointsCached();
-  d["orp_cal_points"]   = sensors.getOrpCalibrationPointsCached();
-  d["temp_calibration_offset"]   = mqttCfg.tempCalibrationOffset;
-  d["temp_calibration_date"]     = mqttCfg.tempCalibrationDate;
-  d["temperature_enabled"]       = mqttCfg.temperatureEnabled;
-  d["auth_enabled"]        = authCfg.enabled;
-  d["sensor_logs_enabled"] = authCfg.sensorLogsEnabled;
-  d["debug_logs_enabled"]  = authCfg.debugLogsEnabled;
-  d["auth_password"]       = authCfg.adminPassword.length() > 0 ? "******" : "";
-  d["auth_token"]          = authCfg.apiToken.length() > 8 ? (authCfg.apiToken.substring(0, 8) + "...") : "";
-  d["time_current"]        = getCurrentTimeISO();
-  // feature-053 : Mode Boost (état effectif + epoch d'expiration, 0 si inactif).
-  d["boost_active"]        = isBoostActive(time(nullptr));
-  d["boost_until"]         = (long)boostState.untilEpoch;
-
+  // Même représentation que /get-config (vue Web du cache versionné) : les champs
+  // stables ne sont re-sérialisés que si la génération de config a changé.
   String out;
-  out.reserve(2048);
-  serializeJson(doc, out);
+  out.reserve(2304);
+  out += "{\"type\":\"config\",\"data\":";
+  configCache.render(ConfigView::Web, true, out);
+  out += '}';
   return out;
 }
@@ -2,39 +2,72 @@
 #define WS_MANAGER_H
 
 #include <ESPAsyncWebServer.h>
-#include <set>
+#include <map>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include "logger.h"
+#include "ws_push_logic.h"
 
-// Gère le WebSocket /ws : authentification, push temps réel (capteurs, config, logs)
+// Gère le WebSocket /ws : authentification, push temps réel (capteurs, config, logs,
+// progression de calibration EZO)
 class WsManager {
 public:
   void begin(AsyncWebServer* server);
-  void update();  // À appeler dans loop() : cleanup + push capteurs toutes les 5s
+  void update();  // À appeler dans loop() : cleanup + push capteurs planifié par client + lots de logs
 
+  // Push immédiat à tous les clients authentifiés (recale leur planificateur).
   void broadcastSensorData();
   void broadcastConfig();
-  void broadcastLog(const LogEntry& entry);
 
   // À utiliser depuis un handler HTTP (tâche AsyncTCP) : marque le broadcast
-  // pour exécution dans la main loop. Évite l'allocation d'un StaticJson<2048>
-  // sur la pile de la tâche AsyncTCP qui a peu de stack.
+  // pour exécution dans la main loop (pile AsyncTCP limitée). Incrémente aussi
+  // la génération de config (invalidation du cache config_cache).
   void requestConfigBroadcast();
 
   bool hasClients() const;
 
 private:
   AsyncWebSocket* _ws = nullptr;
-  unsigned long _lastSensorPush = 0;
-  bool _pendingInitialPush = false;
   bool _pendingConfigBroadcast = false;
-  std::set<uint32_t> _authenticatedClients;
-  static constexpr unsigned long kSensorPushIntervalMs = 5000;
+
+  // Planificateur de push sensor_data par client (ws_push_logic.h). Les clients
+  // rapportent {"type":"client_state","hidden":bool,"live":bool} ; la latence
+  // est mesurée sur la file d'envoi AsyncWebSocket de chaque client.
+  struct ClientState {
+    bool hidden = false;         // Onglet masqué → heartbeat kWsPushHiddenMs
+    bool live = false;           // Vue de calibration ouverte → cadence active
+    bool needsInitial = true;    // Config + capteurs à envoyer dès le prochain tour
+    uint32_t lastPushMs = 0;     // 0 = push dû immédiatement
+    WsLinkState link;
+  };
+  // Clients authentifiés uniquement. Écrit depuis AsyncTCP (_onEvent/_onData)
+  // et loopTask (update) → protégé par _clientsMutex.
+  std::map<uint32_t, ClientState> _clients;
+  SemaphoreHandle_t _clientsMutex = nullptr;
+  static constexpr size_t kMaxScheduledClients = 8;              // > cleanupClients(4) : marge reconnexions
+  static constexpr unsigned long kWsClientsMutexTimeoutMs = 20;  // loopTask : on saute le tour si occupé
+
+  // Streaming logs par lots : les entrées sont tirées du Logger (curseur de séquence)
+  // depuis loopTask et regroupées en une trame {"type":"logs","data":[...]}.
+  uint32_t _logCursor = 0;
+  bool _logBatchOpen = false;
+  unsigned long _logBatchOpenedAt = 0;
+  static constexpr unsigned long kLogBatchWindowMs = 250;  // Fenêtre de regroupement
+  static constexpr size_t kLogBatchMaxEntries = 16;        // Envoi anticipé / taille max d'une trame
+
+  // Calibration EZO : {"type":"calibration"} à chaque changement de génération
+  // (SensorManager::calibrationGeneration), sans attendre le push capteurs.
+  uint32_t _calGenSent = 0;
 
   void _onEvent(AsyncWebSocket* ws, AsyncWebSocketClient* client,
                 AwsEventType type, void* arg, uint8_t* data, size_t len);
   void _onClientConnect(AsyncWebSocketClient* client, AsyncWebServerRequest* request);
   void _onData(AsyncWebSocketClient* client, uint8_t* data, size_t len);
 
+  void _flushLogBatch();
+  void _pushCalibration();
+  void _schedulePushes();
+
   String _buildSensorJson() const;
   String _buildConfigJson() const;
 };
@@ -0,0 +1,41 @@
+#include "ws_push_logic.h"
+
+// =============================================================================
+// ws_push_logic — implémentation PURE
+// =============================================================================
+
+void wsLinkObserve(WsLinkState& s, uint32_t queueLen, uint32_t nowMs) {
+  if (queueLen > 0) {
+    if (!s.busy) {
+      s.busy = true;
+      s.busySinceMs = nowMs;
+    }
+    return;
+  }
+  if (!s.busy) return;
+
+  const uint32_t sample = nowMs - s.busySinceMs;
+  s.latencyMs = s.hasSample ? (s.latencyMs * 3 + sample) / 4 : sample;
+  s.hasSample = true;
+  s.busy = false;
+}
+
+uint32_t wsLinkLatencyMs(const WsLinkState& s, uint32_t nowMs) {
+  if (!s.busy) return s.latencyMs;
+  const uint32_t backlog = nowMs - s.busySinceMs;
+  return backlog > s.latencyMs ? backlog : s.latencyMs;
+}
+
+uint32_t wsPushIntervalMs(const WsPushPolicyInput& in) {
+  if (in.hidden) return kWsPushHiddenMs;
+  const bool slow = in.latencyMs >= kWsSlowLinkLatencyMs;
+  if (in.systemActive || in.live) {
+    return slow ? kWsPushIdleMs : kWsPushActiveMs;
+  }
+  return slow ? kWsPushSlowLinkMs : kWsPushIdleMs;
+}
+
+bool wsPushDue(uint32_t lastPushMs, uint32_t nowMs, uint32_t intervalMs) {
+  if (lastPushMs == 0) return true;
+  return nowMs - lastPushMs >= intervalMs;
+}
@@ -0,0 +1,59 @@
+#ifndef WS_PUSH_LOGIC_H
+#define WS_PUSH_LOGIC_H
+
+// =============================================================================
+// ws_push_logic — Cadence de push WebSocket par client, PURE
+// =============================================================================
+// Décide, pour chaque client WS authentifié, l'intervalle entre deux pushs
+// `sensor_data` en fonction de :
+//   - la visibilité rapportée par le client (onglet masqué → heartbeat 60 s) ;
+//   - l'activité (injection en cours côté firmware, ou vue de calibration
+//     ouverte côté client — flag `live`) ;
+//   - la qualité du lien, estimée par le temps de vidage de la file d'envoi
+//     AsyncWebSocket du client (EWMA).
+// La coquille ws_manager.cpp relève queueLen() / millis() et applique la décision.
+//
+// CONTRAINTE : pas d'Arduino.h, pas de FreeRTOS (compilé en natif, env:native).
+// =============================================================================
+
+#include <stdint.h>
+
+constexpr uint32_t kWsPushActiveMs   = 1000;   // Visible + activité + bon lien
+constexpr uint32_t kWsPushIdleMs     = 5000;   // Visible, repos, bon lien (cadence historique)
+constexpr uint32_t kWsPushSlowLinkMs = 10000;  // Visible, repos, lien lent
+constexpr uint32_t kWsPushHiddenMs   = 60000;  // Onglet masqué : heartbeat seul
+// Au-delà, le lien est jugé lent : l'activité ne descend plus sous kWsPushIdleMs
+// et le repos passe à kWsPushSlowLinkMs.
+constexpr uint32_t kWsSlowLinkLatencyMs = 400;
+
+// Estimation de latence d'un client à partir de sa file d'envoi.
+struct WsLinkState {
+  bool busy = false;          // File non vide au dernier relevé
+  bool hasSample = false;     // Au moins un vidage complet mesuré
+  uint32_t busySinceMs = 0;   // Instant où la file a été vue non vide (si busy)
+  uint32_t latencyMs = 0;     // EWMA (α = 1/4) des durées de vidage
+};
+
+// À appeler à chaque tour de boucle avec la longueur courante de la file
+// (messages en attente d'ACK TCP). Un passage non vide → vide clôt un échantillon.
+void wsLinkObserve(WsLinkState& s, uint32_t queueLen, uint32_t nowMs);
+
+// Latence effective : max(EWMA, âge du backlog en cours) — un lien qui se
+// bloque est vu lent sans attendre que la file se vide.
+uint32_t wsLinkLatencyMs(const WsLinkState& s, uint32_t nowMs);
+
+struct WsPushPolicyInput {
+  bool hidden;          // Onglet masqué (rapporté par le client)
+  bool live;            // Vue de calibration ouverte (rapporté par le client)
+  bool systemActive;    // Injection pH/ORP en cours (firmware)
+  uint32_t latencyMs;   // wsLinkLatencyMs()
+};
+
+// Intervalle de push sensor_data pour ce client.
+uint32_t wsPushIntervalMs(const WsPushPolicyInput& in);
+
+// true si un push est dû (arithmétique non signée : robuste au wrap de millis()).
+// lastPushMs == 0 → dû immédiatement (client neuf ou réveillé).
+bool wsPushDue(uint32_t lastPushMs, uint32_t nowMs, uint32_t intervalMs);
+
+#endif // WS_PUSH_LOGIC_H
@@ -0,0 +1,20 @@
+#ifndef NATIVE_TEST_NOISE_H
+#define NATIVE_TEST_NOISE_H
+
+// =============================================================================
+// Générateur de bruit partagé par les bancs natifs (harness only).
+//
+// Bruit pseudo-aléatoire déterministe, uniforme ±amp (σ = amp/√3) : mêmes
+// échantillons d'une exécution à l'autre, sans dépendre de rand().
+// Utilisé par test_native_sensor_estimator et test_native_sensor_health.
+// =============================================================================
+
+#include <stdint.h>
+
+static inline float noise(uint32_t i, float amp) {
+  uint32_t x = i * 2654435761u;
+  x ^= x >> 13;
+  return ((x % 2001) / 1000.0f - 1.0f) * amp;
+}
+
+#endif  // NATIVE_TEST_NOISE_H
@@ -1454,6 +1454,31 @@ void test_F053_chlorine_boundary_near_hard_cap(void) {
   TEST_ASSERT_FLOAT_WITHIN(kFloatEps, 1000.0f, m);
 }
 
+// =============================================================================
+// Projection de l'erreur par la tendance (étage Kalman optionnel)
+// =============================================================================
+// Utilisée au seul démarrage d'une dose : une erreur déjà en train de se
+// résorber (tendance négative) est réduite, jamais amplifiée.
+
+void test_trend_projection_nan_trend_unchanged(void) {
+  // Étage EMA → tendance NaN : décision historique strictement inchangée.
+  TEST_ASSERT_FLOAT_WITHIN(kFloatEps, 0.20f, projectErrorWithTrend(0.20f, NAN, 5.0f));
+}
+
+void test_trend_projection_growing_error_ignored(void) {
+  // L'erreur croît : pas d'anticipation (ne déclenche jamais une dose plus tôt).
+  TEST_ASSERT_FLOAT_WITHIN(kFloatEps, 0.20f, projectErrorWithTrend(0.20f, 0.02f, 5.0f));
+}
+
+void test_trend_projection_decaying_error_reduced(void) {
+  // 0,20 qui se résorbe de 0,03/min sur 5 min → 0,05 : sous un seuil de 0,1.
+  TEST_ASSERT_FLOAT_WITHIN(kFloatEps, 0.05f, projectErrorWithTrend(0.20f, -0.03f, 5.0f));
+}
+
+void test_trend_projection_zero_horizon_unchanged(void) {
+  TEST_ASSERT_FLOAT_WITHIN(kFloatEps, 0.20f, projectErrorWithTrend(0.20f, -0.03f, 0.0f));
+}
+
 int main(int, char **) {
   UNITY_BEGIN();
   // T2 — hystérésis de démarrage.
@@ -1554,5 +1579,10 @@ int main(int, char **) {
   RUN_TEST(test_F053_chlorine_hard_cap);
   RUN_TEST(test_F053_chlorine_boost_on_non_automatic_unchanged);
   RUN_TEST(test_F053_chlorine_boundary_near_hard_cap);
+  // Projection par la tendance.
+  RUN_TEST(test_trend_projection_nan_trend_unchanged);
+  RUN_TEST(test_trend_projection_growing_error_ignored);
+  RUN_TEST(test_trend_projection_decaying_error_reduced);
+  RUN_TEST(test_trend_projection_zero_horizon_unchanged);
   return UNITY_END();
 }
@@ -0,0 +1,220 @@
+// =============================================================================
+// Tests unitaires natifs — ds18b20_logic (acquisition DS18B20 par sonde)
+// =============================================================================
+// Tournent sur PC (env:native, Unity), HORS matériel ESP32 / 1-Wire.
+// On teste :
+//   - résolution : temps de conversion, registre de configuration
+//   - scratchpad : CRC Maxim (vecteurs datasheet), décodage, masquage des
+//     bits non définis, 85 °C, bus à zéro
+//   - cadence par sonde : dues au boot, intervalles propres, wrap millis()
+//   - conversion : scrutation, échéance, alimentation parasite, stats
+// =============================================================================
+
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+#include "ds18b20_logic.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Scratchpad avec CRC correct : température brute, registre de config.
+static void makeScratchpad(uint8_t sp[kDs18b20ScratchpadLen], int16_t raw, uint8_t bits) {
+  sp[0] = (uint8_t)(raw & 0xFF);
+  sp[1] = (uint8_t)((uint16_t)raw >> 8);
+  sp[2] = 0x4B;
+  sp[3] = 0x46;
+  sp[4] = ds18b20ConfigByte(bits);
+  sp[5] = 0xFF;
+  sp[6] = 0x0C;
+  sp[7] = 0x10;
+  sp[8] = ds18b20Crc8(sp, 8);
+}
+
+void test_conversion_time_per_resolution(void) {
+  TEST_ASSERT_EQUAL_UINT16(94, ds18b20ConversionMs(9));
+  TEST_ASSERT_EQUAL_UINT16(188, ds18b20ConversionMs(10));
+  TEST_ASSERT_EQUAL_UINT16(375, ds18b20ConversionMs(11));
+  TEST_ASSERT_EQUAL_UINT16(750, ds18b20ConversionMs(12));
+  // Hors plage : bornée.
+  TEST_ASSERT_EQUAL_UINT16(94, ds18b20ConversionMs(4));
+  TEST_ASSERT_EQUAL_UINT16(750, ds18b20ConversionMs(16));
+}
+
+void test_config_byte_roundtrip(void) {
+  TEST_ASSERT_EQUAL_UINT8(0x1F, ds18b20ConfigByte(9));
+  TEST_ASSERT_EQUAL_UINT8(0x3F, ds18b20ConfigByte(10));
+  TEST_ASSERT_EQUAL_UINT8(0x5F, ds18b20ConfigByte(11));
+  TEST_ASSERT_EQUAL_UINT8(0x7F, ds18b20ConfigByte(12));
+  for (uint8_t bits = 9; bits <= 12; ++bits) {
+    TEST_ASSERT_EQUAL_UINT8(bits, ds18b20ResolutionFromConfig(ds18b20ConfigByte(bits)));
+  }
+}
+
+void test_crc_matches_datasheet_vectors(void) {
+  // Maxim AN27 : ROM 28-bit famille 02, CRC A2.
+  const uint8_t rom[] = {0x02, 0x1C, 0xB8, 0x01, 0x00, 0x00, 0x00};
+  TEST_ASSERT_EQUAL_UINT8(0xA2, ds18b20Crc8(rom, sizeof(rom)));
+  // Scratchpad de mise sous tension (85 °C, 12 bits), CRC 1C.
+  const uint8_t sp[] = {0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10};
+  TEST_ASSERT_EQUAL_UINT8(0x1C, ds18b20Crc8(sp, sizeof(sp)));
+}
+
+void test_decode_positive_and_negative(void) {
+  uint8_t sp[kDs18b20ScratchpadLen];
+  float t = 0.0f;
+  uint8_t bits = 0;
+  makeScratchpad(sp, 0x0191, 12);  // +25,0625 °C (datasheet)
+  TEST_ASSERT_EQUAL(Ds18b20ReadStatus::Ok, ds18b20DecodeScratchpad(sp, &t, &bits));
+  TEST_ASSERT_EQUAL_FLOAT(25.0625f, t);
+  TEST_ASSERT_EQUAL_UINT8(12, bits);
+
+  makeScratchpad(sp, (int16_t)0xFF5E, 12);  // -10,125 °C (datasheet)
+  TEST_ASSERT_EQUAL(Ds18b20ReadStatus::Ok, ds18b20DecodeScratchpad(sp, &t, nullptr));
+  TEST_ASSERT_EQUAL_FLOAT(-10.125f, t);
+}
+
+void test_decode_masks_undefined_bits(void) {
+  // 10 bits : les deux bits de poids faible ne sont pas définis.
+  uint8_t sp[kDs18b20ScratchpadLen];
+  float t = 0.0f;
+  uint8_t bits = 0;
+  makeScratchpad(sp, 0x0193, 10);
+  TEST_ASSERT_EQUAL(Ds18b20ReadStatus::Ok, ds18b20DecodeScratchpad(sp, &t, &bits));
+  TEST_ASSERT_EQUAL_FLOAT(25.0f, t);
+  TEST_ASSERT_EQUAL_UINT8(10, bits);
+  // 9 bits, négatif : arrondi vers -∞ sur la grille 0,5 °C.
+  makeScratchpad(sp, (int16_t)0xFF5E, 9);
+  TEST_ASSERT_EQUAL(Ds18b20ReadStatus::Ok, ds18b20DecodeScratchpad(sp, &t, nullptr));
+  TEST_ASSERT_EQUAL_FLOAT(-10.5f, t);
+}
+
+void test_decode_rejects_bad_frames(void) {
+  uint8_t sp[kDs18b20ScratchpadLen];
+  float t = 42.0f;
+  uint8_t bits = 0;
+
+  makeScratchpad(sp, 0x0191, 12);
+  sp[0] ^= 0x01;  // Bit corrompu
+  TEST_ASSERT_EQUAL(Ds18b20ReadStatus::BadCrc, ds18b20DecodeScratchpad(sp, &t, &bits));
+
+  memset(sp, 0xFF, sizeof(sp));  // Sonde absente
+  TEST_ASSERT_EQUAL(Ds18b20ReadStatus::BadCrc, ds18b20DecodeScratchpad(sp, &t, &bits));
+
+  memset(sp, 0x00, sizeof(sp));  // CRC nul valide, mais bus à la masse
+  TEST_ASSERT_EQUAL(Ds18b20ReadStatus::AllZero, ds18b20DecodeScratchpad(sp, &t, &bits));
+  TEST_ASSERT_EQUAL_FLOAT(42.0f, t);  // Non écrit
+  TEST_ASSERT_EQUAL_UINT8(0, bits);
+}
+
+void test_decode_power_on_reset_reports_resolution(void) {
+  // 85 °C : rejeté, mais le registre relu (12 bits EEPROM) est rendu pour
+  // que la coquille reprogramme une sonde circuit réinitialisée.
+  const uint8_t sp[] = {0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10, 0x1C};
+  float t = 42.0f;
+  uint8_t bits = 0;
+  TEST_ASSERT_EQUAL(Ds18b20ReadStatus::PowerOnReset, ds18b20DecodeScratchpad(sp, &t, &bits));
+  TEST_ASSERT_EQUAL_FLOAT(42.0f, t);
+  TEST_ASSERT_EQUAL_UINT8(12, bits);
+}
+
+void test_schedule_per_probe_intervals(void) {
+  Ds18b20Schedule<2> s;
+  s.setInterval(0, 2000);   // Eau
+  s.setInterval(1, 10000);  // Circuit
+  TEST_ASSERT_EQUAL_UINT8(0x03, s.dueMask(0, 2));   // Toutes dues au boot
+  TEST_ASSERT_EQUAL_UINT8(0x01, s.dueMask(0, 1));   // Limité aux sondes détectées
+  s.requested(0x03, 100);
+  TEST_ASSERT_EQUAL_UINT8(0x00, s.dueMask(2099, 2));
+  TEST_ASSERT_EQUAL_UINT8(0x01, s.dueMask(2100, 2));
+  s.requested(0x01, 2100);
+  TEST_ASSERT_EQUAL_UINT8(0x00, s.dueMask(4000, 2));
+  TEST_ASSERT_EQUAL_UINT8(0x03, s.dueMask(10100, 2));
+  s.forget(1);
+  TEST_ASSERT_EQUAL_UINT8(0x02, s.dueMask(2200, 2));
+}
+
+void test_schedule_survives_millis_wrap(void) {
+  Ds18b20Schedule<2> s;
+  s.setInterval(0, 2000);
+  s.requested(0x01, 0xFFFFFC00u);
+  TEST_ASSERT_EQUAL_UINT8(0x00, s.dueMask(0x00000100u, 1));
+  TEST_ASSERT_EQUAL_UINT8(0x01, s.dueMask(0x00000400u, 1));
+}
+
+void test_conversion_polls_until_done(void) {
+  Ds18b20Conversion c(20, 50);
+  // 12 bits : 1re scrutation au quart du maximum (187 ms), puis 20 ms.
+  TEST_ASSERT_EQUAL_UINT32(187, c.start(1000, 12, true));
+  TEST_ASSERT_EQUAL_UINT32(20, c.onPoll(1187, false));
+  TEST_ASSERT_EQUAL_UINT32(20, c.onPoll(1600, false));
+  TEST_ASSERT_EQUAL_UINT32(0, c.onPoll(1620, true));
+  TEST_ASSERT_FALSE(c.timedOut());
+  TEST_ASSERT_EQUAL_UINT32(620, c.lastConversionMs());
+  TEST_ASSERT_EQUAL_UINT32(1, c.conversionCount());
+  TEST_ASSERT_EQUAL_UINT32(0, c.timeoutCount());
+}
+
+void test_conversion_short_resolution_min_poll(void) {
+  // 9 bits : quart du maximum (23 ms) > intervalle de scrutation.
+  Ds18b20Conversion c(20, 50);
+  TEST_ASSERT_EQUAL_UINT32(23, c.start(0, 9, true));
+  // Intervalle plus long que le quart : l'intervalle prime.
+  Ds18b20Conversion slow(40, 50);
+  TEST_ASSERT_EQUAL_UINT32(40, slow.start(0, 9, true));
+}
+
+void test_conversion_timeout_forces_read(void) {
+  Ds18b20Conversion c(20, 50);
+  c.start(0, 10, true);  // Échéance 188 + 50 = 238 ms
+  TEST_ASSERT_EQUAL_UINT32(20, c.onPoll(200, false));
+  TEST_ASSERT_EQUAL_UINT32(8, c.onPoll(230, false));  // Dernière attente bornée à l'échéance
+  TEST_ASSERT_EQUAL_UINT32(0, c.onPoll(238, false));
+  TEST_ASSERT_TRUE(c.timedOut());
+  TEST_ASSERT_EQUAL_UINT32(1, c.timeoutCount());
+  // Conversion suivante : indicateur remis à zéro, compteur conservé.
+  c.start(1000, 10, true);
+  TEST_ASSERT_FALSE(c.timedOut());
+  TEST_ASSERT_EQUAL_UINT32(1, c.timeoutCount());
+}
+
+void test_conversion_parasite_fixed_wait(void) {
+  // Sans scrutation : une seule attente (maximum + marge), pas d'échéance comptée.
+  Ds18b20Conversion c(20, 50);
+  TEST_ASSERT_EQUAL_UINT32(800, c.start(0, 12, false));
+  TEST_ASSERT_EQUAL_UINT32(0, c.onPoll(800, true));  // Bit ignoré
+  TEST_ASSERT_FALSE(c.timedOut());
+  TEST_ASSERT_EQUAL_UINT32(0, c.timeoutCount());
+  TEST_ASSERT_EQUAL_UINT32(800, c.lastConversionMs());
+}
+
+void test_conversion_stats_across_wrap(void) {
+  Ds18b20Conversion c(20, 50);
+  c.start(0xFFFFFF00u, 12, true);
+  TEST_ASSERT_EQUAL_UINT32(0, c.onPoll(0x00000164u, true));  // 612 ms
+  TEST_ASSERT_EQUAL_UINT32(612, c.lastConversionMs());
+  c.start(5000, 12, true);
+  c.onPoll(5580, true);
+  TEST_ASSERT_EQUAL_UINT32(580, c.lastConversionMs());
+  TEST_ASSERT_EQUAL_UINT32(612, c.maxConversionMs());
+  TEST_ASSERT_EQUAL_UINT32(2, c.conversionCount());
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_conversion_time_per_resolution);
+  RUN_TEST(test_config_byte_roundtrip);
+  RUN_TEST(test_crc_matches_datasheet_vectors);
+  RUN_TEST(test_decode_positive_and_negative);
+  RUN_TEST(test_decode_masks_undefined_bits);
+  RUN_TEST(test_decode_rejects_bad_frames);
+  RUN_TEST(test_decode_power_on_reset_reports_resolution);
+  RUN_TEST(test_schedule_per_probe_intervals);
+  RUN_TEST(test_schedule_survives_millis_wrap);
+  RUN_TEST(test_conversion_polls_until_done);
+  RUN_TEST(test_conversion_short_resolution_min_poll);
+  RUN_TEST(test_conversion_timeout_forces_read);
+  RUN_TEST(test_conversion_parasite_fixed_wait);
+  RUN_TEST(test_conversion_stats_across_wrap);
+  return UNITY_END();
+}
@@ -0,0 +1,217 @@
+// =============================================================================
+// Tests unitaires natifs — ezo_cal_logic (calibration EZO non bloquante)
+// =============================================================================
+// Tournent sur PC (env:native, Unity), HORS matériel ESP32.
+// On teste :
+//   - parsing "?CAL,N" (Cal,?)
+//   - stabilité : run dans la bande, ré-ancrage hors bande, NaN / échec,
+//     dérive lente qui finit par sortir, compteur de séquence
+//   - déroulé : attente → émission, sans attente, échéance "unstable",
+//     bilans bus / refus / succès, durées figées, passage de millis()
+// =============================================================================
+
+#include <unity.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include "constants.h"
+#include "ezo_cal_logic.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_parse_cal_points(void) {
+  TEST_ASSERT_EQUAL_INT(0, ezoParseCalPoints("?CAL,0"));
+  TEST_ASSERT_EQUAL_INT(2, ezoParseCalPoints("?CAL,2"));
+  TEST_ASSERT_EQUAL_INT(3, ezoParseCalPoints("?Cal,3"));
+  TEST_ASSERT_EQUAL_INT(-1, ezoParseCalPoints("?CAL,"));
+  TEST_ASSERT_EQUAL_INT(-1, ezoParseCalPoints("?CAL,7"));
+  TEST_ASSERT_EQUAL_INT(-1, ezoParseCalPoints("?CAL"));
+  TEST_ASSERT_EQUAL_INT(-1, ezoParseCalPoints(nullptr));
+}
+
+void test_parse_slope(void) {
+  PhSlopeInfo info{NAN, NAN, NAN};
+  TEST_ASSERT_TRUE(ezoParseSlope("?Slope,99.7,100.3,-0.89", info));
+  TEST_ASSERT_EQUAL_FLOAT(99.7f, info.acidPct);
+  TEST_ASSERT_EQUAL_FLOAT(100.3f, info.basePct);
+  TEST_ASSERT_EQUAL_FLOAT(-0.89f, info.zeroOffsetMv);
+
+  // Firmware EZO ancien : 2 valeurs, zéro à NaN.
+  TEST_ASSERT_TRUE(ezoParseSlope("?Slope,98.2,101.0", info));
+  TEST_ASSERT_EQUAL_FLOAT(98.2f, info.acidPct);
+  TEST_ASSERT_TRUE(isnan(info.zeroOffsetMv));
+
+  // Moins de 2 valeurs : échec, `out` inchangé.
+  TEST_ASSERT_FALSE(ezoParseSlope("?Slope,97.0", info));
+  TEST_ASSERT_FALSE(ezoParseSlope("?Slope", info));
+  TEST_ASSERT_FALSE(ezoParseSlope("?Slope,abc,1.0", info));
+  TEST_ASSERT_FALSE(ezoParseSlope(nullptr, info));
+  TEST_ASSERT_EQUAL_FLOAT(98.2f, info.acidPct);
+}
+
+void test_names(void) {
+  TEST_ASSERT_EQUAL_STRING("idle", ezoCalStateName(EzoCalState::Idle));
+  TEST_ASSERT_EQUAL_STRING("stabilizing", ezoCalStateName(EzoCalState::Stabilizing));
+  TEST_ASSERT_EQUAL_STRING("running", ezoCalStateName(EzoCalState::Running));
+  TEST_ASSERT_EQUAL_STRING("done", ezoCalStateName(EzoCalState::Done));
+  TEST_ASSERT_EQUAL_STRING("failed", ezoCalStateName(EzoCalState::Failed));
+  TEST_ASSERT_NULL(ezoCalErrorName(EzoCalError::None));
+  TEST_ASSERT_EQUAL_STRING("unstable", ezoCalErrorName(EzoCalError::Unstable));
+  TEST_ASSERT_EQUAL_STRING("bus", ezoCalErrorName(EzoCalError::Bus));
+  TEST_ASSERT_EQUAL_STRING("rejected", ezoCalErrorName(EzoCalError::Rejected));
+}
+
+void test_stability_run_inside_band(void) {
+  EzoStability st(kEzoCalStableSamples, kEzoCalStableBandPh);
+  TEST_ASSERT_FALSE(st.stable());
+  const float v[] = {7.01f, 7.02f, 7.00f, 7.015f};
+  for (int i = 0; i < 3; ++i) st.add(v[i]);
+  TEST_ASSERT_FALSE(st.stable());
+  TEST_ASSERT_EQUAL_UINT32(3, st.run());
+  st.add(v[3]);
+  TEST_ASSERT_TRUE(st.stable());
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.02f, st.spread());
+  TEST_ASSERT_EQUAL_UINT32(kEzoCalStableSamples, st.required());
+}
+
+void test_stability_reanchors_out_of_band(void) {
+  EzoStability st(4, 0.02f);
+  // Sonde qui descend du bain pH 7 vers le bain pH 4.
+  st.add(7.00f);
+  st.add(6.10f);
+  TEST_ASSERT_EQUAL_UINT32(1, st.run());
+  st.add(4.30f);
+  st.add(4.05f);
+  TEST_ASSERT_EQUAL_UINT32(1, st.run());
+  st.add(4.04f);
+  st.add(4.05f);
+  st.add(4.03f);
+  TEST_ASSERT_TRUE(st.stable());
+}
+
+void test_stability_slow_drift_breaks_run(void) {
+  EzoStability st(4, 0.02f);
+  // Dérive de 0,008 / lecture : la bande (0,02) est dépassée à la 4ᵉ.
+  for (int i = 0; i < 4; ++i) st.add(7.0f + 0.008f * i);
+  TEST_ASSERT_FALSE(st.stable());
+  TEST_ASSERT_EQUAL_UINT32(1, st.run());
+}
+
+void test_stability_failure_restarts(void) {
+  EzoStability st(3, 5.0f);
+  st.add(650.0f);
+  st.add(651.0f);
+  st.interrupt();
+  TEST_ASSERT_EQUAL_UINT32(0, st.run());
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, st.spread());
+  st.add(650.0f);
+  st.add(NAN);
+  TEST_ASSERT_EQUAL_UINT32(0, st.run());
+  st.add(650.0f);
+  st.add(652.0f);
+  st.add(649.0f);
+  TEST_ASSERT_TRUE(st.stable());
+}
+
+void test_stability_seq_counts_every_reading(void) {
+  EzoStability st(2, 1.0f);
+  TEST_ASSERT_EQUAL_UINT32(0, st.seq());
+  st.add(1.0f);
+  st.interrupt();
+  st.add(NAN);
+  st.add(1.0f);
+  TEST_ASSERT_EQUAL_UINT32(4, st.seq());
+}
+
+void test_flow_waits_then_issues(void) {
+  EzoCalFlow f(kEzoCalStabilityTimeoutMs);
+  TEST_ASSERT_FALSE(f.busy());
+  f.start(true, 1000);
+  TEST_ASSERT_TRUE(f.busy());
+  TEST_ASSERT_TRUE(EzoCalState::Stabilizing == f.state());
+  TEST_ASSERT_TRUE(EzoCalStep::None == f.poll(false, 6000));
+  TEST_ASSERT_TRUE(EzoCalStep::Issue == f.poll(true, 16000));
+  TEST_ASSERT_TRUE(EzoCalState::Running == f.state());
+  TEST_ASSERT_EQUAL_UINT32(15000, f.waitedMs());
+  // Plus rien à émettre tant que le bilan n'est pas posé.
+  TEST_ASSERT_TRUE(EzoCalStep::None == f.poll(true, 17000));
+  f.finished(true, true, 17800);
+  TEST_ASSERT_TRUE(EzoCalState::Done == f.state());
+  TEST_ASSERT_TRUE(EzoCalError::None == f.error());
+  TEST_ASSERT_FALSE(f.busy());
+  TEST_ASSERT_EQUAL_UINT32(16800, f.elapsedMs(99999));  // Figée à la fin
+}
+
+void test_flow_without_wait_issues_immediately(void) {
+  EzoCalFlow f(kEzoCalStabilityTimeoutMs);
+  f.start(false, 500);
+  TEST_ASSERT_TRUE(EzoCalStep::Issue == f.poll(false, 520));
+  TEST_ASSERT_EQUAL_UINT32(0, f.waitedMs());
+  TEST_ASSERT_EQUAL_UINT32(100, f.elapsedMs(600));  // En cours : glissante
+}
+
+void test_flow_times_out_unstable(void) {
+  EzoCalFlow f(10000);
+  f.start(true, 0);
+  TEST_ASSERT_TRUE(EzoCalStep::None == f.poll(false, 9999));
+  TEST_ASSERT_TRUE(EzoCalStep::TimedOut == f.poll(false, 10000));
+  TEST_ASSERT_TRUE(EzoCalState::Failed == f.state());
+  TEST_ASSERT_TRUE(EzoCalError::Unstable == f.error());
+  TEST_ASSERT_EQUAL_UINT32(10000, f.waitedMs());
+  TEST_ASSERT_TRUE(EzoCalStep::None == f.poll(true, 10001));
+  // Relance possible après un échec.
+  f.start(true, 20000);
+  TEST_ASSERT_TRUE(EzoCalError::None == f.error());
+  TEST_ASSERT_TRUE(EzoCalStep::Issue == f.poll(true, 20005));
+}
+
+void test_flow_bus_and_rejected(void) {
+  EzoCalFlow f(kEzoCalStabilityTimeoutMs);
+  f.start(false, 0);
+  f.poll(false, 0);
+  f.finished(false, false, 2000);
+  TEST_ASSERT_TRUE(EzoCalError::Bus == f.error());
+
+  f.start(false, 3000);
+  f.poll(false, 3000);
+  f.finished(true, false, 4000);
+  TEST_ASSERT_TRUE(EzoCalState::Failed == f.state());
+  TEST_ASSERT_TRUE(EzoCalError::Rejected == f.error());
+}
+
+void test_flow_finished_ignored_outside_running(void) {
+  EzoCalFlow f(kEzoCalStabilityTimeoutMs);
+  f.finished(true, true, 10);
+  TEST_ASSERT_TRUE(EzoCalState::Idle == f.state());
+  f.start(true, 0);
+  f.finished(true, true, 10);  // Pas encore émise
+  TEST_ASSERT_TRUE(EzoCalState::Stabilizing == f.state());
+}
+
+void test_flow_across_millis_wrap(void) {
+  EzoCalFlow f(10000);
+  const uint32_t t0 = UINT32_MAX - 3000;
+  f.start(true, t0);
+  TEST_ASSERT_TRUE(EzoCalStep::None == f.poll(false, t0 + 6000));  // Après le passage à 0
+  TEST_ASSERT_TRUE(EzoCalStep::TimedOut == f.poll(false, t0 + 10000));
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_parse_cal_points);
+  RUN_TEST(test_parse_slope);
+  RUN_TEST(test_names);
+  RUN_TEST(test_stability_run_inside_band);
+  RUN_TEST(test_stability_reanchors_out_of_band);
+  RUN_TEST(test_stability_slow_drift_breaks_run);
+  RUN_TEST(test_stability_failure_restarts);
+  RUN_TEST(test_stability_seq_counts_every_reading);
+  RUN_TEST(test_flow_waits_then_issues);
+  RUN_TEST(test_flow_without_wait_issues_immediately);
+  RUN_TEST(test_flow_times_out_unstable);
+  RUN_TEST(test_flow_bus_and_rejected);
+  RUN_TEST(test_flow_finished_ignored_outside_running);
+  RUN_TEST(test_flow_across_millis_wrap);
+  return UNITY_END();
+}
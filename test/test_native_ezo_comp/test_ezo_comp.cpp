@@ -0,0 +1,126 @@
+// =============================================================================
+// Tests unitaires natifs — ezo_comp_logic (compensation T° EZO pH persistante)
+// =============================================================================
+// Tournent sur PC (env:native, Unity), HORS matériel ESP32 / EZO.
+// On teste :
+//   - ezoQuantizeTemp / ezoFormatTempCmd : format de la commande `T,<t>`
+//   - EzoTempCompPolicy : 1ᵉʳ envoi, seuil, rafraîchissement, invalidation
+//   - profil 24 h réaliste : nombre de `T` émis vs un `RT` par cycle
+// =============================================================================
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include "ezo_comp_logic.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// -----------------------------------------------------------------------------
+// Format
+// -----------------------------------------------------------------------------
+void test_quantize_rounds_to_tenth(void) {
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 25.3f, ezoQuantizeTemp(25.34f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 25.4f, ezoQuantizeTemp(25.36f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, -1.3f, ezoQuantizeTemp(-1.26f));
+}
+
+void test_format_temp_cmd(void) {
+  char buf[16];
+  TEST_ASSERT_EQUAL_UINT32(6, ezoFormatTempCmd(25.34f, buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("T,25.3", buf);
+  ezoFormatTempCmd(8.0f, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("T,8.0", buf);
+}
+
+void test_format_temp_cmd_too_small(void) {
+  char buf[4] = "xyz";
+  TEST_ASSERT_EQUAL_UINT32(0, ezoFormatTempCmd(25.0f, buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("", buf);
+  TEST_ASSERT_EQUAL_UINT32(0, ezoFormatTempCmd(25.0f, nullptr, 8));
+}
+
+// -----------------------------------------------------------------------------
+// Politique
+// -----------------------------------------------------------------------------
+void test_first_read_pushes(void) {
+  EzoTempCompPolicy p;
+  TEST_ASSERT_FALSE(p.valid());
+  TEST_ASSERT_TRUE(p.shouldPush(26.0f, 0));
+}
+
+void test_nan_never_pushes(void) {
+  EzoTempCompPolicy p;
+  TEST_ASSERT_FALSE(p.shouldPush(NAN, 0));
+}
+
+void test_threshold(void) {
+  EzoTempCompPolicy p;
+  p.pushed(26.04f, 1000);  // appliqué : 26.0
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, 26.0f, p.appliedTemp());
+  TEST_ASSERT_FALSE(p.shouldPush(26.0f, 2000));
+  TEST_ASSERT_FALSE(p.shouldPush(26.24f, 2000));   // 26.2 : sous le seuil
+  TEST_ASSERT_FALSE(p.shouldPush(25.76f, 2000));   // 25.8
+  TEST_ASSERT_TRUE(p.shouldPush(26.25f, 2000));    // 26.3 : seuil atteint
+  TEST_ASSERT_TRUE(p.shouldPush(25.7f, 2000));     // -0.3
+}
+
+void test_periodic_refresh(void) {
+  EzoTempCompPolicy p;
+  p.pushed(26.0f, 1000);
+  TEST_ASSERT_FALSE(p.shouldPush(26.0f, 1000 + kEzoTempCompRefreshMs - 1));
+  TEST_ASSERT_TRUE(p.shouldPush(26.0f, 1000 + kEzoTempCompRefreshMs));
+}
+
+void test_refresh_survives_millis_wrap(void) {
+  EzoTempCompPolicy p;
+  p.pushed(26.0f, 0xFFFFF000u);
+  TEST_ASSERT_FALSE(p.shouldPush(26.0f, 0x00001000u));  // +8 s après wrap
+}
+
+void test_invalidate_forces_push(void) {
+  EzoTempCompPolicy p;
+  p.pushed(26.0f, 1000);
+  p.invalidate();
+  TEST_ASSERT_TRUE(p.shouldPush(26.0f, 2000));
+  p.pushed(26.0f, 2000);
+  TEST_ASSERT_EQUAL_UINT32(2, p.pushCount());
+  TEST_ASSERT_FALSE(p.shouldPush(26.0f, 3000));
+}
+
+// Journée type : 24 °C → 27 °C l'après-midi → 24,5 °C la nuit, bruit DS18B20
+// ±0,06 °C, une lecture toutes les 5 s. Un `RT` par cycle = 17 280 commandes.
+void test_daily_profile_push_count(void) {
+  EzoTempCompPolicy p;
+  const uint32_t cycles = 86400000UL / 5000UL;
+  uint32_t pushes = 0;
+  for (uint32_t i = 0; i < cycles; ++i) {
+    const uint32_t now = i * 5000UL;
+    const float h = now / 3600000.0f;
+    const float base = 25.75f - 1.5f * cosf((h - 3.0f) * 3.14159265f / 12.0f);
+    const float noise = ((i * 7919u) % 13u) * 0.01f - 0.06f;
+    const float t = base + noise;
+    if (p.shouldPush(t, now)) {
+      p.pushed(t, now);
+      pushes++;
+    }
+  }
+  // Bruit absorbé par le seuil : les rafraîchissements (96) dominent, < 1 % des cycles.
+  TEST_ASSERT_TRUE(pushes >= 96);
+  TEST_ASSERT_TRUE(pushes < cycles / 100);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_quantize_rounds_to_tenth);
+  RUN_TEST(test_format_temp_cmd);
+  RUN_TEST(test_format_temp_cmd_too_small);
+  RUN_TEST(test_first_read_pushes);
+  RUN_TEST(test_nan_never_pushes);
+  RUN_TEST(test_threshold);
+  RUN_TEST(test_periodic_refresh);
+  RUN_TEST(test_refresh_survives_millis_wrap);
+  RUN_TEST(test_invalidate_forces_push);
+  RUN_TEST(test_daily_profile_push_count);
+  return UNITY_END();
+}
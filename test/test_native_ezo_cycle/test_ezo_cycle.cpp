@@ -0,0 +1,113 @@
+// =============================================================================
+// Tests unitaires natifs — ezo_cycle_logic (lecture pH + ORP en parallèle)
+// =============================================================================
+// Tournent sur PC (env:native, Unity), HORS matériel ESP32 / EZO.
+// On teste :
+//   - poll() : 1er cycle immédiat, échéances T (300 ms) et R (900 ms)
+//   - cadence de début à début, robuste au wrap de millis()
+//   - busy() pendant tout le cycle
+//   - statistiques : durée de cycle, occupation bus
+// =============================================================================
+
+#include <unity.h>
+#include <stdint.h>
+#include "ezo_cycle_logic.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static EzoReadCycle makeCycle() { return EzoReadCycle(5000, 300, 900); }
+
+void test_first_cycle_starts_immediately(void) {
+  EzoReadCycle c = makeCycle();
+  TEST_ASSERT_EQUAL(EzoCycleStep::Start, c.poll(0));
+  TEST_ASSERT_FALSE(c.busy());
+}
+
+void test_reads_collected_after_one_conversion(void) {
+  EzoReadCycle c = makeCycle();
+  c.readsIssued(1000);
+  TEST_ASSERT_TRUE(c.busy());
+  TEST_ASSERT_EQUAL(EzoCycleStep::None, c.poll(1899));
+  TEST_ASSERT_EQUAL(EzoCycleStep::Collect, c.poll(1900));
+  c.finished(1902);
+  TEST_ASSERT_FALSE(c.busy());
+  TEST_ASSERT_EQUAL_UINT32(902, c.lastCycleMs());
+}
+
+void test_temp_then_reads(void) {
+  EzoReadCycle c = makeCycle();
+  c.tempIssued(0);
+  TEST_ASSERT_EQUAL(EzoCycleStep::None, c.poll(299));
+  TEST_ASSERT_EQUAL(EzoCycleStep::CollectTemp, c.poll(300));
+  c.readsIssued(301);
+  TEST_ASSERT_EQUAL(EzoCycleStep::None, c.poll(1200));
+  TEST_ASSERT_EQUAL(EzoCycleStep::Collect, c.poll(1201));
+  c.finished(1203);
+  // Durée comptée depuis le début du cycle (émission de T).
+  TEST_ASSERT_EQUAL_UINT32(1203, c.lastCycleMs());
+}
+
+void test_cadence_start_to_start(void) {
+  EzoReadCycle c = makeCycle();
+  c.readsIssued(1000);
+  c.finished(1900);
+  TEST_ASSERT_EQUAL(EzoCycleStep::None, c.poll(5999));
+  TEST_ASSERT_EQUAL(EzoCycleStep::Start, c.poll(6000));
+}
+
+void test_cadence_across_millis_wrap(void) {
+  EzoReadCycle c = makeCycle();
+  c.readsIssued(0xFFFFF000u);
+  TEST_ASSERT_EQUAL(EzoCycleStep::Collect, c.poll(0xFFFFF000u + 900));
+  c.finished(0xFFFFF000u + 900);
+  TEST_ASSERT_EQUAL(EzoCycleStep::None, c.poll(0x00000100u));          // +4,35 s
+  TEST_ASSERT_EQUAL(EzoCycleStep::Start, c.poll(0xFFFFF000u + 5000));  // wrap
+  TEST_ASSERT_EQUAL_UINT32(900, c.lastCycleMs());
+}
+
+void test_abort_at_start_keeps_cadence(void) {
+  EzoReadCycle c = makeCycle();
+  c.finished(1000);  // transaction expirée : rien d'émis
+  TEST_ASSERT_FALSE(c.busy());
+  TEST_ASSERT_EQUAL_UINT32(0, c.lastCycleMs());
+  TEST_ASSERT_EQUAL(EzoCycleStep::None, c.poll(5999));
+  TEST_ASSERT_EQUAL(EzoCycleStep::Start, c.poll(6000));
+}
+
+void test_stats_and_bus_hold(void) {
+  EzoReadCycle c = makeCycle();
+  c.readsIssued(0);
+  c.addBusHoldUs(800);
+  c.addBusHoldUs(1200);
+  c.finished(900);
+  c.tempIssued(5000);
+  c.addBusHoldUs(500);
+  c.readsIssued(5300);
+  c.finished(6200);
+  TEST_ASSERT_EQUAL_UINT32(2, c.cycleCount());
+  TEST_ASSERT_EQUAL_UINT32(1200, c.lastCycleMs());
+  TEST_ASSERT_EQUAL_UINT32(1200, c.maxCycleMs());
+  TEST_ASSERT_EQUAL_UINT32(1050, c.avgCycleMs());
+  // Occupation remise à zéro à chaque début de cycle.
+  TEST_ASSERT_EQUAL_UINT32(500, c.lastBusHoldUs());
+}
+
+void test_avg_zero_without_cycle(void) {
+  EzoReadCycle c = makeCycle();
+  TEST_ASSERT_EQUAL_UINT32(0, c.avgCycleMs());
+  TEST_ASSERT_EQUAL_UINT32(0, c.cycleCount());
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_first_cycle_starts_immediately);
+  RUN_TEST(test_reads_collected_after_one_conversion);
+  RUN_TEST(test_temp_then_reads);
+  RUN_TEST(test_cadence_start_to_start);
+  RUN_TEST(test_cadence_across_millis_wrap);
+  RUN_TEST(test_abort_at_start_keeps_cadence);
+  RUN_TEST(test_stats_and_bus_hold);
+  RUN_TEST(test_avg_zero_without_cycle);
+  return UNITY_END();
+}
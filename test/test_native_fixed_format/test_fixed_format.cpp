@@ -0,0 +1,177 @@
+// =============================================================================
+// Tests unitaires natifs — fixed_format (formatage virgule fixe sans tas)
+// =============================================================================
+// Tournent sur PC (env:native, Unity), HORS matériel ESP32.
+// On teste :
+//   - parité EXACTE avec snprintf("%.*f") (= String(value, n)) : balayage des
+//     plages pH / ORP / température, égalités binaires exactes (x.5, x.25…),
+//     zéro négatif, valeurs aléatoires sur toute la plage int32
+//   - formatFixed : signe, INT32_MIN, zéros de tête des décimales
+//   - tampon trop petit, NaN / infini
+//   - fixedRound : même arrondi que le texte
+// =============================================================================
+
+#include <unity.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "fixed_format.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+namespace {
+
+// Compare la sortie à snprintf pour une valeur ; true si identique.
+bool sameAsPrintf(float v, uint8_t decimals) {
+  char ref[64];
+  char out[kFixedFormatMax];
+  snprintf(ref, sizeof(ref), "%.*f", decimals, static_cast<double>(v));
+  formatFloatFixed(out, sizeof(out), v, decimals);
+  if (strcmp(ref, out) == 0) return true;
+  char msg[160];
+  snprintf(msg, sizeof(msg), "%.9g (%u déc.) : printf=\"%s\" fixe=\"%s\"", static_cast<double>(v),
+           static_cast<unsigned>(decimals), ref, out);
+  TEST_MESSAGE(msg);
+  return false;
+}
+
+// Balaye [lo, hi] par pas `step` (en float, comme les lectures capteur).
+uint32_t sweep(float lo, float hi, float step, uint8_t decimals) {
+  uint32_t mismatches = 0;
+  const int n = static_cast<int>((hi - lo) / step);
+  for (int i = 0; i <= n; ++i) {
+    const float v = lo + static_cast<float>(i) * step;
+    if (!sameAsPrintf(v, decimals)) mismatches++;
+  }
+  return mismatches;
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+// Parité printf
+// -----------------------------------------------------------------------------
+void test_parity_ph_range(void) {
+  TEST_ASSERT_EQUAL_UINT32(0, sweep(0.0f, 14.0f, 0.0001f, kFixedPhDecimals));
+  TEST_ASSERT_EQUAL_UINT32(0, sweep(6.0f, 8.5f, 0.05f, 1));  // consigne pH
+}
+
+void test_parity_orp_range(void) {
+  TEST_ASSERT_EQUAL_UINT32(0, sweep(-2000.0f, 2000.0f, 0.01f, kFixedOrpDecimals));
+}
+
+void test_parity_temperature_range(void) {
+  TEST_ASSERT_EQUAL_UINT32(0, sweep(-30.0f, 60.0f, 0.001f, kFixedTempDecimals));
+  TEST_ASSERT_EQUAL_UINT32(0, sweep(-30.0f, 60.0f, 0.0625f, 2));  // pas DS18B20 12 bits
+}
+
+void test_parity_exact_binary_ties(void) {
+  // Égalités exactes en binaire : printf arrondit au pair.
+  const float ties[] = {0.5f, 1.5f, 2.5f, -0.5f, -2.5f, 650.5f, 651.5f,
+                        0.25f, 0.75f, 26.25f, 26.75f, 0.125f, 7.0625f, 7.1875f};
+  for (float v : ties) {
+    for (uint8_t d = 0; d <= 3; ++d) TEST_ASSERT_TRUE(sameAsPrintf(v, d));
+  }
+}
+
+void test_parity_negative_zero(void) {
+  char out[kFixedFormatMax];
+  formatFloatFixed(out, sizeof(out), -0.04f, 1);
+  TEST_ASSERT_EQUAL_STRING("-0.0", out);
+  TEST_ASSERT_TRUE(sameAsPrintf(-0.0f, 0));
+  TEST_ASSERT_TRUE(sameAsPrintf(-0.0004f, 3));
+  TEST_ASSERT_TRUE(sameAsPrintf(0.0f, 2));
+}
+
+void test_parity_random_values(void) {
+  // Générateur congruentiel déterministe ; valeurs bornées à la plage int32.
+  uint32_t x = 12345;
+  uint32_t mismatches = 0;
+  for (int i = 0; i < 200000; ++i) {
+    x = x * 1664525u + 1013904223u;
+    const uint8_t d = static_cast<uint8_t>(x >> 30);
+    x = x * 1664525u + 1013904223u;
+    const float v = (static_cast<float>(x) / 4294967296.0f - 0.5f) * 4.0e6f;
+    if (!sameAsPrintf(v, d)) mismatches++;
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+}
+
+// -----------------------------------------------------------------------------
+// formatFixed / fixedFromFloat
+// -----------------------------------------------------------------------------
+void test_format_fixed(void) {
+  char out[kFixedFormatMax];
+  TEST_ASSERT_EQUAL(5, formatFixed(out, sizeof(out), 7235, 3));
+  TEST_ASSERT_EQUAL_STRING("7.235", out);
+  formatFixed(out, sizeof(out), 7005, 3);
+  TEST_ASSERT_EQUAL_STRING("7.005", out);
+  formatFixed(out, sizeof(out), -5, 1);
+  TEST_ASSERT_EQUAL_STRING("-0.5", out);
+  formatFixed(out, sizeof(out), 650, 0);
+  TEST_ASSERT_EQUAL_STRING("650", out);
+  formatFixed(out, sizeof(out), INT32_MIN, 3);
+  TEST_ASSERT_EQUAL_STRING("-2147483.648", out);
+  formatFixed(out, sizeof(out), 42, 9);  // ramené à 3 décimales
+  TEST_ASSERT_EQUAL_STRING("0.042", out);
+}
+
+void test_fixed_from_float(void) {
+  TEST_ASSERT_EQUAL_INT32(7235, fixedFromFloat(7.235f, 3));
+  TEST_ASSERT_EQUAL_INT32(264, fixedFromFloat(26.44f, 1));
+  TEST_ASSERT_EQUAL_INT32(-650, fixedFromFloat(-650.4f, 0));
+  TEST_ASSERT_EQUAL_INT32(2, fixedFromFloat(2.5f, 0));  // égalité → pair
+  TEST_ASSERT_EQUAL_INT32(0, fixedFromFloat(NAN, 2));
+  TEST_ASSERT_EQUAL_INT32(INT32_MAX, fixedFromFloat(1.0e12f, 3));
+  TEST_ASSERT_EQUAL_INT32(INT32_MIN, fixedFromFloat(-1.0e12f, 3));
+}
+
+void test_small_buffer_and_non_finite(void) {
+  char out[5];
+  TEST_ASSERT_EQUAL(0, formatFloatFixed(out, sizeof(out), 7.235f, 3));  // "7.235" + NUL = 6
+  TEST_ASSERT_EQUAL_STRING("", out);
+  TEST_ASSERT_EQUAL(4, formatFloatFixed(out, sizeof(out), 7.24f, 2));
+  TEST_ASSERT_EQUAL_STRING("7.24", out);
+  TEST_ASSERT_EQUAL(0, formatFloatFixed(out, sizeof(out), NAN, 1));
+  TEST_ASSERT_EQUAL_STRING("", out);
+  TEST_ASSERT_EQUAL(0, formatFloatFixed(out, sizeof(out), INFINITY, 1));
+  TEST_ASSERT_EQUAL(0, formatFixed(nullptr, 0, 1, 0));
+}
+
+void test_named_metrics(void) {
+  char out[kFixedFormatMax];
+  formatPh(out, sizeof(out), 7.2f);
+  TEST_ASSERT_EQUAL_STRING("7.200", out);
+  formatOrp(out, sizeof(out), 649.6f);
+  TEST_ASSERT_EQUAL_STRING("650", out);
+  formatTemperature(out, sizeof(out), 26.46f);
+  TEST_ASSERT_EQUAL_STRING("26.5", out);
+}
+
+void test_fixed_round_matches_text(void) {
+  TEST_ASSERT_EQUAL_FLOAT(7.235f, fixedRound(7.2349f, 3));
+  TEST_ASSERT_EQUAL_FLOAT(26.4f, fixedRound(26.44f, 1));
+  TEST_ASSERT_EQUAL_FLOAT(650.0f, fixedRound(650.4f, 0));
+  TEST_ASSERT_TRUE(isnan(fixedRound(NAN, 1)));
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_parity_ph_range);
+  RUN_TEST(test_parity_orp_range);
+  RUN_TEST(test_parity_temperature_range);
+  RUN_TEST(test_parity_exact_binary_ties);
+  RUN_TEST(test_parity_negative_zero);
+  RUN_TEST(test_parity_random_values);
+
+  RUN_TEST(test_format_fixed);
+  RUN_TEST(test_fixed_from_float);
+  RUN_TEST(test_small_buffer_and_non_finite);
+  RUN_TEST(test_named_metrics);
+  RUN_TEST(test_fixed_round_matches_text);
+
+  return UNITY_END();
+}
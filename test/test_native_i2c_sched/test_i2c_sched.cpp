@@ -0,0 +1,193 @@
+// =============================================================================
+// Tests unitaires natifs — i2c_sched_logic (ordonnanceur du bus capteurs)
+// =============================================================================
+// Tournent sur PC (env:native, Unity), HORS matériel ESP32.
+// On teste :
+//   - priorité : une calibration passe devant les lectures périodiques en file
+//   - réservation : périphérique occupé pendant une conversion, bus libre
+//     pour les autres périphériques
+//   - espacement des lectures périodiques (mise en forme du débit)
+//   - échéance : retrait avant démarrage, retard compté après
+//   - idleMs() : prochain réveil de la tâche
+//   - statistiques d'attente / de tenue par périphérique, file pleine
+// =============================================================================
+
+#include <unity.h>
+#include <stdint.h>
+#include "i2c_sched_logic.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static const uint8_t kPh = i2cDeviceBit(I2cDevice::EzoPh);
+static const uint8_t kOrp = i2cDeviceBit(I2cDevice::EzoOrp);
+static const uint8_t kRtc = i2cDeviceBit(I2cDevice::Rtc);
+static const uint8_t kOw = i2cDeviceBit(I2cDevice::OneWire);
+
+void test_urgent_preempts_queued_periodic(void) {
+  I2cScheduler s;
+  int periodic = s.enqueue(kPh | kOrp, I2cPriority::Periodic, 0, 5000);
+  int onDemand = s.enqueue(kPh, I2cPriority::OnDemand, 1, 2000);
+  int urgent = s.enqueue(kPh, I2cPriority::Urgent, 2, 2000);
+  TEST_ASSERT_EQUAL_INT(urgent, s.next(2));
+  s.stepDone(urgent, 1000, 50, 0);
+  TEST_ASSERT_EQUAL_INT(onDemand, s.next(1000));
+  s.stepDone(onDemand, 1900, 50, 0);
+  TEST_ASSERT_EQUAL_INT(periodic, s.next(1900));
+}
+
+void test_same_priority_is_fifo(void) {
+  I2cScheduler s;
+  int a = s.enqueue(kRtc, I2cPriority::OnDemand, 0, 2000);
+  int b = s.enqueue(kRtc, I2cPriority::OnDemand, 0, 2000);
+  TEST_ASSERT_EQUAL_INT(a, s.next(0));
+  s.stepDone(a, 1, 10, 0);
+  TEST_ASSERT_EQUAL_INT(b, s.next(1));
+}
+
+void test_conversion_wait_frees_bus_for_other_devices(void) {
+  I2cScheduler s;
+  int ezo = s.enqueue(kPh | kOrp, I2cPriority::Periodic, 0, 5000);
+  TEST_ASSERT_EQUAL_INT(ezo, s.next(0));
+  s.stepDone(ezo, 2, 1500, 900);  // R ×2 émis, conversion 900 ms
+  TEST_ASSERT_EQUAL_UINT8(kPh | kOrp, s.reserved());
+
+  // Calibration pH : attend la fin du cycle, le RTC passe pendant ce temps.
+  int cal = s.enqueue(kPh, I2cPriority::Urgent, 10, 2000);
+  int rtc = s.enqueue(kRtc, I2cPriority::OnDemand, 10, 2000);
+  TEST_ASSERT_EQUAL_INT(rtc, s.next(10));
+  s.stepDone(rtc, 11, 400, 0);
+  TEST_ASSERT_EQUAL_INT(-1, s.next(11));
+
+  // Conversion échue : la reprise passe avant la calibration en file.
+  TEST_ASSERT_EQUAL_INT(ezo, s.next(902));
+  s.stepDone(ezo, 904, 1200, 0);
+  TEST_ASSERT_EQUAL_INT(cal, s.next(904));
+  TEST_ASSERT_EQUAL_UINT32(894, s.stats(I2cDevice::EzoPh).waitLastMs);
+}
+
+void test_periodic_spacing_shapes_rate(void) {
+  I2cScheduler s;
+  s.setPeriodicSpacing(I2cDevice::EzoPh, 1000);
+  int a = s.enqueue(kPh, I2cPriority::Periodic, 0, 5000);
+  TEST_ASSERT_EQUAL_INT(a, s.next(0));
+  s.stepDone(a, 5, 100, 0);
+
+  int b = s.enqueue(kPh, I2cPriority::Periodic, 10, 5000);
+  TEST_ASSERT_EQUAL_INT(-1, s.next(999));
+  TEST_ASSERT_EQUAL_UINT32(1, s.idleMs(999, 100));
+  TEST_ASSERT_EQUAL_INT(b, s.next(1000));
+  s.stepDone(b, 1001, 100, 0);
+
+  // L'espacement ne freine que les lectures périodiques.
+  int c = s.enqueue(kPh, I2cPriority::OnDemand, 1002, 2000);
+  TEST_ASSERT_EQUAL_INT(c, s.next(1002));
+}
+
+void test_expired_before_start_is_dropped(void) {
+  I2cScheduler s;
+  int busy = s.enqueue(kOw, I2cPriority::Periodic, 0, 50);
+  TEST_ASSERT_EQUAL_INT(busy, s.next(0));
+  s.stepDone(busy, 0, 100, 800);  // garde le périphérique
+
+  int read = s.enqueue(kOw, I2cPriority::Periodic, 10, 50);
+  TEST_ASSERT_EQUAL_INT(-1, s.popExpired(59));
+  TEST_ASSERT_EQUAL_INT(read, s.popExpired(60));
+  TEST_ASSERT_EQUAL_INT(-1, s.popExpired(60));
+  TEST_ASSERT_EQUAL_UINT32(1, s.stats(I2cDevice::OneWire).expired);
+  TEST_ASSERT_EQUAL_UINT8(1, s.pending());
+}
+
+void test_late_completion_counted(void) {
+  I2cScheduler s;
+  int a = s.enqueue(kRtc, I2cPriority::OnDemand, 0, 100);
+  TEST_ASSERT_EQUAL_INT(a, s.next(90));
+  s.stepDone(a, 90, 10, 20);
+  TEST_ASSERT_EQUAL_INT(a, s.next(110));
+  s.stepDone(a, 110, 10, 0);
+  const I2cDeviceStats& st = s.stats(I2cDevice::Rtc);
+  TEST_ASSERT_EQUAL_UINT32(1, st.late);
+  TEST_ASSERT_EQUAL_UINT32(0, st.expired);
+  TEST_ASSERT_EQUAL_UINT32(20, st.holdLastMs);
+  TEST_ASSERT_EQUAL_UINT32(20, st.busUs);
+}
+
+void test_idle_ms_wakes_for_resume_and_expiry(void) {
+  I2cScheduler s;
+  TEST_ASSERT_EQUAL_UINT32(100, s.idleMs(0, 100));
+  int ezo = s.enqueue(kPh, I2cPriority::Periodic, 0, 5000);
+  TEST_ASSERT_EQUAL_UINT32(0, s.idleMs(0, 100));
+  s.next(0);
+  s.stepDone(ezo, 0, 100, 300);
+  TEST_ASSERT_EQUAL_UINT32(100, s.idleMs(0, 100));
+  TEST_ASSERT_EQUAL_UINT32(50, s.idleMs(250, 1000));
+  // Bloquée par la réservation : réveil à l'expiration.
+  s.enqueue(kPh, I2cPriority::Urgent, 100, 120);
+  TEST_ASSERT_EQUAL_UINT32(120, s.idleMs(100, 1000));
+}
+
+void test_wait_and_hold_stats(void) {
+  I2cScheduler s;
+  int a = s.enqueue(kPh | kOrp, I2cPriority::Periodic, 0, 5000);
+  s.next(100);
+  s.stepDone(a, 100, 1000, 900);
+  s.next(1000);
+  s.stepDone(a, 1002, 800, 0);
+  int b = s.enqueue(kPh, I2cPriority::Urgent, 2000, 2000);
+  s.next(2300);
+  s.stepDone(b, 3200, 500, 0);
+
+  const I2cDeviceStats& ph = s.stats(I2cDevice::EzoPh);
+  TEST_ASSERT_EQUAL_UINT32(2, ph.txns);
+  TEST_ASSERT_EQUAL_UINT32(300, ph.waitMaxMs);
+  TEST_ASSERT_EQUAL_UINT32(200, ph.avgWaitMs());
+  TEST_ASSERT_EQUAL_UINT32(902, ph.holdMaxMs);
+  TEST_ASSERT_EQUAL_UINT32(900, ph.holdLastMs);
+  TEST_ASSERT_EQUAL_UINT32(901, ph.avgHoldMs());
+  TEST_ASSERT_EQUAL_UINT32(2300, ph.busUs);
+  const I2cDeviceStats& orp = s.stats(I2cDevice::EzoOrp);
+  TEST_ASSERT_EQUAL_UINT32(1, orp.txns);
+  TEST_ASSERT_EQUAL_UINT32(1800, orp.busUs);
+  TEST_ASSERT_EQUAL_UINT8(0, s.reserved());
+}
+
+void test_queue_full_and_empty_mask_rejected(void) {
+  I2cScheduler s;
+  TEST_ASSERT_EQUAL_INT(-1, s.enqueue(0, I2cPriority::Urgent, 0, 100));
+  for (uint8_t i = 0; i < kI2cSchedCapacity; ++i) {
+    TEST_ASSERT_TRUE(s.enqueue(kRtc, I2cPriority::OnDemand, 0, 100) >= 0);
+  }
+  TEST_ASSERT_EQUAL_INT(-1, s.enqueue(kRtc, I2cPriority::Urgent, 0, 100));
+  TEST_ASSERT_EQUAL_UINT8(kI2cSchedCapacity, s.peakPending());
+}
+
+void test_across_millis_wrap(void) {
+  I2cScheduler s;
+  s.setPeriodicSpacing(I2cDevice::EzoPh, 1000);
+  const uint32_t t0 = 0xFFFFFF00u;
+  int a = s.enqueue(kPh, I2cPriority::Periodic, t0, 5000);
+  TEST_ASSERT_EQUAL_INT(a, s.next(t0));
+  s.stepDone(a, t0, 10, 900);
+  TEST_ASSERT_EQUAL_INT(-1, s.next(t0 + 899));
+  TEST_ASSERT_EQUAL_INT(a, s.next(t0 + 900));
+  s.stepDone(a, t0 + 902, 10, 0);
+  TEST_ASSERT_EQUAL_UINT32(902, s.stats(I2cDevice::EzoPh).holdLastMs);
+  int b = s.enqueue(kPh, I2cPriority::Periodic, t0 + 903, 5000);
+  TEST_ASSERT_EQUAL_INT(-1, s.next(t0 + 999));
+  TEST_ASSERT_EQUAL_INT(b, s.next(t0 + 1000));
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_urgent_preempts_queued_periodic);
+  RUN_TEST(test_same_priority_is_fifo);
+  RUN_TEST(test_conversion_wait_frees_bus_for_other_devices);
+  RUN_TEST(test_periodic_spacing_shapes_rate);
+  RUN_TEST(test_expired_before_start_is_dropped);
+  RUN_TEST(test_late_completion_counted);
+  RUN_TEST(test_idle_ms_wakes_for_resume_and_expiry);
+  RUN_TEST(test_wait_and_hold_stats);
+  RUN_TEST(test_queue_full_and_empty_mask_rejected);
+  RUN_TEST(test_across_millis_wrap);
+  return UNITY_END();
+}
@@ -0,0 +1,210 @@
+// =============================================================================
+// Tests unitaires natifs — mqtt_cadence (cadence MQTT selon la phase de process)
+// =============================================================================
+// Tournent sur PC (env:native, Unity), HORS matériel ESP32 / PubSubClient.
+// On teste :
+//   - phase courante (injection/mélange > filtration > repos), groupes de topics
+//   - décision : bande immédiate, intervalle échu, topic non cadencé
+//   - intervalles et bandes configurables
+//   - intégration MqttDedup : bruit retenu au repos, suivi fin en dosage,
+//     transition franche immédiate, rafraîchissement forcé inchangé
+//   - bilan de messages sur une heure simulée (repos puis dosage)
+// =============================================================================
+
+#include <unity.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "mqtt_cadence.h"
+#include "mqtt_dedup.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// -----------------------------------------------------------------------------
+// Phase et groupes
+// -----------------------------------------------------------------------------
+void test_phase_priority(void) {
+  TEST_ASSERT_TRUE(mqttProcessPhase(false, false) == MqttProcessPhase::Idle);
+  TEST_ASSERT_TRUE(mqttProcessPhase(false, true) == MqttProcessPhase::Filtering);
+  TEST_ASSERT_TRUE(mqttProcessPhase(true, false) == MqttProcessPhase::Dosing);
+  TEST_ASSERT_TRUE(mqttProcessPhase(true, true) == MqttProcessPhase::Dosing);
+}
+
+void test_metric_groups(void) {
+  TEST_ASSERT_TRUE(mqttMetricGroup(MqttTopicId::PhState) == MqttMetricGroup::Chemistry);
+  TEST_ASSERT_TRUE(mqttMetricGroup(MqttTopicId::OrpFilteredState) == MqttMetricGroup::Chemistry);
+  TEST_ASSERT_TRUE(mqttMetricGroup(MqttTopicId::TemperatureCircuitState) == MqttMetricGroup::Temperature);
+  TEST_ASSERT_TRUE(mqttMetricGroup(MqttTopicId::OrpDailyMlState) == MqttMetricGroup::Volume);
+  TEST_ASSERT_TRUE(mqttMetricGroup(MqttTopicId::PhRejectedCountState) == MqttMetricGroup::None);
+  TEST_ASSERT_TRUE(mqttMetricGroup(MqttTopicId::FiltrationState) == MqttMetricGroup::None);
+}
+
+// -----------------------------------------------------------------------------
+// Décision
+// -----------------------------------------------------------------------------
+void test_interval_follows_phase(void) {
+  MqttCadence c;
+  TEST_ASSERT_EQUAL_UINT32(120000, c.intervalMs(MqttTopicId::PhState));
+  c.setPhase(MqttProcessPhase::Filtering);
+  TEST_ASSERT_EQUAL_UINT32(30000, c.intervalMs(MqttTopicId::PhState));
+  c.setPhase(MqttProcessPhase::Dosing);
+  TEST_ASSERT_EQUAL_UINT32(2000, c.intervalMs(MqttTopicId::PhState));
+  TEST_ASSERT_EQUAL_UINT32(30000, c.intervalMs(MqttTopicId::TemperatureState));
+  TEST_ASSERT_EQUAL_UINT32(0, c.intervalMs(MqttTopicId::PhRejectedCountState));
+}
+
+void test_due_rules(void) {
+  MqttCadence c;  // Idle : chimie 120 s, bande immédiate pH 50
+  TEST_ASSERT_FALSE(c.due(MqttTopicId::PhState, 20, 10000));
+  TEST_ASSERT_TRUE(c.due(MqttTopicId::PhState, 20, 120000));
+  TEST_ASSERT_TRUE(c.due(MqttTopicId::PhState, 50, 0));
+  TEST_ASSERT_TRUE(c.due(MqttTopicId::PhState, -50, 0));
+  TEST_ASSERT_FALSE(c.due(MqttTopicId::PhState, -49, 1000));
+  // Topic non cadencé : toujours dû.
+  TEST_ASSERT_TRUE(c.due(MqttTopicId::PhRejectedCountState, 1, 0));
+}
+
+void test_configurable_bands_and_intervals(void) {
+  MqttCadence c;
+  c.setImmediateBand(MqttTopicId::OrpState, 5);
+  TEST_ASSERT_EQUAL_INT32(5, c.immediateBand(MqttTopicId::OrpState));
+  TEST_ASSERT_TRUE(c.due(MqttTopicId::OrpState, 5, 0));
+  c.setImmediateBand(MqttTopicId::OrpState, -3);  // borné à 0 : bande désactivée
+  TEST_ASSERT_EQUAL_INT32(0, c.immediateBand(MqttTopicId::OrpState));
+  TEST_ASSERT_FALSE(c.due(MqttTopicId::OrpState, 500, 0));
+
+  c.setInterval(MqttMetricGroup::Chemistry, MqttProcessPhase::Idle, 60000);
+  TEST_ASSERT_EQUAL_UINT32(60000, c.intervalMs(MqttTopicId::OrpState));
+  c.setInterval(MqttMetricGroup::None, MqttProcessPhase::Idle, 5000);  // ignoré
+  TEST_ASSERT_EQUAL_UINT32(0, c.intervalMs(MqttTopicId::FiltrationState));
+  c.setPhase(MqttProcessPhase::Count);  // ignoré
+  TEST_ASSERT_TRUE(c.phase() == MqttProcessPhase::Idle);
+}
+
+// -----------------------------------------------------------------------------
+// Intégration MqttDedup
+// -----------------------------------------------------------------------------
+void test_dedup_idle_noise_is_held(void) {
+  MqttCadence c;
+  MqttDedup d;
+  d.setCadence(&c);
+  d.markValue(MqttTopicId::PhState, 7200, 0);
+  // Bruit de 0,02 pH (≥ résolution 0,01, < bande immédiate 0,05) : retenu.
+  TEST_ASSERT_FALSE(d.valueDue(MqttTopicId::PhState, 7220, 10000));
+  TEST_ASSERT_FALSE(d.valueDue(MqttTopicId::PhState, 7220, 119999));
+  TEST_ASSERT_TRUE(d.valueDue(MqttTopicId::PhState, 7220, 120000));
+  // Sous la résolution : jamais dû (hors rafraîchissement forcé).
+  TEST_ASSERT_FALSE(d.valueDue(MqttTopicId::PhState, 7205, 500000));
+  TEST_ASSERT_TRUE(d.valueDue(MqttTopicId::PhState, 7205, kMqttDedupRefreshMs));
+}
+
+void test_dedup_transition_is_immediate(void) {
+  MqttCadence c;
+  MqttDedup d;
+  d.setCadence(&c);
+  d.markValue(MqttTopicId::OrpState, 700, 0);
+  TEST_ASSERT_TRUE(d.valueDue(MqttTopicId::OrpState, 685, 2000));
+  d.markValue(MqttTopicId::TemperatureState, 250, 0);
+  TEST_ASSERT_TRUE(d.valueDue(MqttTopicId::TemperatureState, 255, 1000));
+}
+
+void test_dedup_dosing_tracks_fine_changes(void) {
+  MqttCadence c;
+  MqttDedup d;
+  d.setCadence(&c);
+  c.setPhase(MqttProcessPhase::Dosing);
+  d.markValue(MqttTopicId::PhState, 7400, 0);
+  TEST_ASSERT_FALSE(d.valueDue(MqttTopicId::PhState, 7390, 1000));
+  TEST_ASSERT_TRUE(d.valueDue(MqttTopicId::PhState, 7390, 2000));
+  d.markValue(MqttTopicId::PhDailyMlState, 125, 0);
+  TEST_ASSERT_TRUE(d.valueDue(MqttTopicId::PhDailyMlState, 131, 2000));
+}
+
+void test_dedup_without_cadence_is_unchanged(void) {
+  MqttDedup d;
+  d.markValue(MqttTopicId::PhState, 7200, 0);
+  TEST_ASSERT_TRUE(d.valueDue(MqttTopicId::PhState, 7210, 1000));
+  MqttCadence c;
+  d.setCadence(&c);
+  TEST_ASSERT_FALSE(d.valueDue(MqttTopicId::PhState, 7210, 1000));
+  d.setCadence(nullptr);
+  TEST_ASSERT_TRUE(d.valueDue(MqttTopicId::PhState, 7210, 1000));
+}
+
+// -----------------------------------------------------------------------------
+// Bilan sur une heure simulée : 50 min de repos (pH bruité ±0,02 autour de
+// 7,20) puis 10 min d'injection (pH −0,003 par pas de 2 s). Historique : cycle
+// 10 s, bande morte seule. Cadence : échantillonnage 2 s, phase posée à chaque
+// pas. On compte les publications et l'écart maximal entre la valeur réelle et
+// la dernière valeur publiée pendant l'injection.
+// -----------------------------------------------------------------------------
+namespace {
+
+struct HourStats {
+  uint32_t publishes = 0;
+  int32_t maxDosingLag = 0;
+};
+
+HourStats runHour(MqttDedup& d, MqttCadence* c) {
+  HourStats st;
+  int32_t ph = 7200;
+  int32_t published = 0;
+  for (uint32_t tick = 0; tick < 1800; ++tick) {
+    const uint32_t nowMs = tick * 2000;
+    const bool dosing = tick >= 1500;
+    ph = dosing ? ph - 3 : 7200 + static_cast<int32_t>(tick % 3) * 20 - 20;
+    const bool sampled = c != nullptr || tick % 5 == 0;
+    if (c) c->setPhase(mqttProcessPhase(dosing, false));
+    if (sampled && d.valueDue(MqttTopicId::PhState, ph, nowMs)) {
+      d.markValue(MqttTopicId::PhState, ph, nowMs);
+      published = ph;
+      st.publishes++;
+    }
+    if (dosing) {
+      const int32_t lag = published - ph;
+      if (lag > st.maxDosingLag) st.maxDosingLag = lag;
+    }
+  }
+  return st;
+}
+
+}  // namespace
+
+void test_hour_profile_fewer_messages_faster_transitions(void) {
+  MqttDedup legacy;
+  const HourStats before = runHour(legacy, nullptr);
+
+  MqttDedup d;
+  MqttCadence c;
+  d.setCadence(&c);
+  const HourStats after = runHour(d, &c);
+
+  char msg[128];
+  snprintf(msg, sizeof(msg), "pH/h : historique %u publish (écart max %d), cadence %u publish (écart max %d)",
+           (unsigned)before.publishes, (int)before.maxDosingLag,
+           (unsigned)after.publishes, (int)after.maxDosingLag);
+  TEST_MESSAGE(msg);
+
+  TEST_ASSERT_TRUE(after.publishes < before.publishes);
+  TEST_ASSERT_TRUE(after.maxDosingLag < before.maxDosingLag);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_phase_priority);
+  RUN_TEST(test_metric_groups);
+
+  RUN_TEST(test_interval_follows_phase);
+  RUN_TEST(test_due_rules);
+  RUN_TEST(test_configurable_bands_and_intervals);
+
+  RUN_TEST(test_dedup_idle_noise_is_held);
+  RUN_TEST(test_dedup_transition_is_immediate);
+  RUN_TEST(test_dedup_dosing_tracks_fine_changes);
+  RUN_TEST(test_dedup_without_cadence_is_unchanged);
+
+  RUN_TEST(test_hour_profile_fewer_messages_faster_transitions);
+
+  return UNITY_END();
+}
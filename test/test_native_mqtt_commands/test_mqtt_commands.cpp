@@ -0,0 +1,192 @@
+// =============================================================================
+// Tests unitaires natifs — mqtt_commands (décodage des commandes HA)
+// =============================================================================
+// Tournent sur PC (env:native, Unity), HORS matériel ESP32 / FreeRTOS.
+// Caractérisation de la validation d'origine de drainCommandQueue :
+//   - topic `.../set` → commande, autres topics refusés
+//   - trim + casse normalisée (modes en minuscules, ON/OFF en majuscules)
+//   - bornes des consignes pH / ORP (préfixe numérique façon toFloat)
+//   - volumes quotidiens : payload numérique strict, négatif ramené à 0
+//   - heures HH:MM, mode d'installation, reboot (tout payload)
+//   - lot drainé : coalescence par type (dernière valide gagne), ordre de la
+//     dernière occurrence, commandes de config vs actions directes
+// =============================================================================
+
+#include <unity.h>
+#include <string.h>
+#include "mqtt_commands.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// -----------------------------------------------------------------------------
+// Topic → commande
+// -----------------------------------------------------------------------------
+
+void test_every_command_topic_maps(void) {
+  size_t mapped = 0;
+  for (size_t i = 0; i < kMqttTopicCount; ++i) {
+    const MqttTopicId id = static_cast<MqttTopicId>(i);
+    MqttCommand cmd;
+    const bool ok = mqttCommandFor(id, cmd);
+    TEST_ASSERT_EQUAL(mqttTopicKind(id) == MqttTopicKind::Command, ok);
+    if (ok) mapped++;
+  }
+  TEST_ASSERT_EQUAL(18, mapped);
+  MqttCommand cmd;
+  TEST_ASSERT_TRUE(mqttCommandFor(MqttTopicId::PhTargetCommand, cmd));
+  TEST_ASSERT_EQUAL(static_cast<int>(MqttCommand::PhTarget), static_cast<int>(cmd));
+}
+
+// -----------------------------------------------------------------------------
+// Payloads
+// -----------------------------------------------------------------------------
+
+void test_on_off_is_trimmed_and_uppercased(void) {
+  MqttCommandArgs a = parseMqttCommand(MqttCommand::Lighting, "  on\r\n");
+  TEST_ASSERT_TRUE(a.valid);
+  TEST_ASSERT_TRUE(a.on);
+  TEST_ASSERT_EQUAL_STRING("ON", a.text);
+  a = parseMqttCommand(MqttCommand::Boost, "Off");
+  TEST_ASSERT_TRUE(a.valid);
+  TEST_ASSERT_FALSE(a.on);
+  a = parseMqttCommand(MqttCommand::FiltrationOnOff, "1");
+  TEST_ASSERT_FALSE(a.valid);
+}
+
+void test_modes_are_lowercased_and_checked(void) {
+  MqttCommandArgs a = parseMqttCommand(MqttCommand::FiltrationMode, " AUTO ");
+  TEST_ASSERT_TRUE(a.valid);
+  TEST_ASSERT_EQUAL_STRING("auto", a.text);
+  TEST_ASSERT_FALSE(parseMqttCommand(MqttCommand::FiltrationMode, "automatic").valid);
+  TEST_ASSERT_TRUE(parseMqttCommand(MqttCommand::PhRegulationMode, "Scheduled").valid);
+  TEST_ASSERT_FALSE(parseMqttCommand(MqttCommand::OrpRegulationMode, "auto").valid);
+  a = parseMqttCommand(MqttCommand::InstallMode, "External");
+  TEST_ASSERT_TRUE(a.valid);
+  TEST_ASSERT_EQUAL_STRING("external", a.text);
+  TEST_ASSERT_FALSE(parseMqttCommand(MqttCommand::InstallMode, "pilote").valid);
+}
+
+void test_targets_are_range_checked(void) {
+  MqttCommandArgs a = parseMqttCommand(MqttCommand::PhTarget, "7.4");
+  TEST_ASSERT_TRUE(a.valid);
+  TEST_ASSERT_EQUAL_FLOAT(7.4f, a.number);
+  TEST_ASSERT_TRUE(parseMqttCommand(MqttCommand::PhTarget, "6.0").valid);
+  TEST_ASSERT_TRUE(parseMqttCommand(MqttCommand::PhTarget, "8.5").valid);
+  TEST_ASSERT_FALSE(parseMqttCommand(MqttCommand::PhTarget, "8.6").valid);
+  TEST_ASSERT_FALSE(parseMqttCommand(MqttCommand::PhTarget, "abc").valid);
+  // Préfixe numérique accepté, comme String::toFloat().
+  TEST_ASSERT_TRUE(parseMqttCommand(MqttCommand::PhTarget, "7.2abc").valid);
+  TEST_ASSERT_TRUE(parseMqttCommand(MqttCommand::OrpTarget, "650").valid);
+  TEST_ASSERT_FALSE(parseMqttCommand(MqttCommand::OrpTarget, "399").valid);
+  TEST_ASSERT_FALSE(parseMqttCommand(MqttCommand::OrpTarget, "901").valid);
+}
+
+void test_daily_targets_are_strictly_numeric(void) {
+  MqttCommandArgs a = parseMqttCommand(MqttCommand::PhDailyTarget, "150.0");
+  TEST_ASSERT_TRUE(a.valid);
+  TEST_ASSERT_EQUAL(150, a.integer);
+  a = parseMqttCommand(MqttCommand::OrpDailyTarget, "-5");
+  TEST_ASSERT_TRUE(a.valid);
+  TEST_ASSERT_EQUAL(0, a.integer);
+  TEST_ASSERT_FALSE(parseMqttCommand(MqttCommand::PhDailyTarget, "").valid);
+  TEST_ASSERT_FALSE(parseMqttCommand(MqttCommand::PhDailyTarget, "12a").valid);
+  TEST_ASSERT_FALSE(parseMqttCommand(MqttCommand::PhDailyTarget, "-").valid);
+  TEST_ASSERT_FALSE(mqttIsNumericPayload(nullptr));
+  TEST_ASSERT_TRUE(mqttIsNumericPayload("+3"));
+}
+
+void test_times_and_reboot(void) {
+  MqttCommandArgs a = parseMqttCommand(MqttCommand::FiltrationStart, " 08:30 ");
+  TEST_ASSERT_TRUE(a.valid);
+  TEST_ASSERT_EQUAL_STRING("08:30", a.text);
+  TEST_ASSERT_FALSE(parseMqttCommand(MqttCommand::LightingEnd, "24:00").valid);
+  TEST_ASSERT_FALSE(parseMqttCommand(MqttCommand::LightingStart, "8:30").valid);
+  TEST_ASSERT_TRUE(parseMqttCommand(MqttCommand::Reboot, "PRESS").valid);
+  TEST_ASSERT_TRUE(parseMqttCommand(MqttCommand::Reboot, "").valid);
+}
+
+void test_long_payload_is_truncated(void) {
+  char big[200];
+  for (size_t i = 0; i < sizeof(big) - 1; ++i) big[i] = 'a';
+  big[sizeof(big) - 1] = '\0';
+  const MqttCommandArgs a = parseMqttCommand(MqttCommand::FiltrationMode, big);
+  TEST_ASSERT_FALSE(a.valid);
+  TEST_ASSERT_EQUAL(kMqttCommandPayloadMax - 1, strlen(a.text));
+}
+
+// -----------------------------------------------------------------------------
+// Lot de commandes (drainCommandQueue)
+// -----------------------------------------------------------------------------
+void test_batch_last_command_wins(void) {
+  MqttCommandBatch b;
+  TEST_ASSERT_TRUE(b.add(MqttCommand::PhTarget, "7.0") == MqttCommandBatch::AddResult::Added);
+  TEST_ASSERT_TRUE(b.add(MqttCommand::OrpTarget, "650") == MqttCommandBatch::AddResult::Added);
+  TEST_ASSERT_TRUE(b.add(MqttCommand::PhTarget, "7.4") == MqttCommandBatch::AddResult::Coalesced);
+  TEST_ASSERT_EQUAL(2, b.size());
+  // Ordre de la dernière occurrence : ORP puis pH.
+  TEST_ASSERT_TRUE(b.type(0) == MqttCommand::OrpTarget);
+  TEST_ASSERT_TRUE(b.type(1) == MqttCommand::PhTarget);
+  TEST_ASSERT_EQUAL_FLOAT(7.4f, b.args(1).number);
+  TEST_ASSERT_EQUAL_UINT32(1, b.coalescedCount());
+}
+
+void test_batch_invalid_does_not_override_valid(void) {
+  MqttCommandBatch b;
+  b.add(MqttCommand::FiltrationMode, "auto");
+  TEST_ASSERT_TRUE(b.add(MqttCommand::FiltrationMode, "bogus") == MqttCommandBatch::AddResult::Ignored);
+  TEST_ASSERT_EQUAL_STRING("auto", b.args(0).text);
+  // Seule, une commande invalide reste dans le lot (warning + resync côté coquille).
+  b.add(MqttCommand::LightingStart, "25:99");
+  TEST_ASSERT_EQUAL(2, b.size());
+  TEST_ASSERT_FALSE(b.args(1).valid);
+  // Une valide remplace une invalide.
+  TEST_ASSERT_TRUE(b.add(MqttCommand::LightingStart, "21:00") == MqttCommandBatch::AddResult::Coalesced);
+  TEST_ASSERT_TRUE(b.args(1).valid);
+  TEST_ASSERT_EQUAL_UINT32(2, b.coalescedCount());
+}
+
+void test_batch_restore_burst_and_clear(void) {
+  // Restauration HA : les 18 commandes deux fois de suite → 18 entrées.
+  MqttCommandBatch b;
+  for (int pass = 0; pass < 2; ++pass) {
+    for (size_t t = 0; t < kMqttCommandCount; ++t) b.add(static_cast<MqttCommand>(t), "ON");
+  }
+  TEST_ASSERT_EQUAL(kMqttCommandCount, b.size());
+  TEST_ASSERT_EQUAL_UINT32(kMqttCommandCount, b.coalescedCount());
+  b.clear();
+  TEST_ASSERT_EQUAL(0, b.size());
+  TEST_ASSERT_TRUE(b.add(MqttCommand::Boost, "OFF") == MqttCommandBatch::AddResult::Added);
+  TEST_ASSERT_FALSE(b.args(0).on);
+}
+
+void test_config_commands_vs_actions(void) {
+  TEST_ASSERT_TRUE(mqttCommandWritesConfig(MqttCommand::PhTarget));
+  TEST_ASSERT_TRUE(mqttCommandWritesConfig(MqttCommand::FiltrationOnOff));
+  TEST_ASSERT_TRUE(mqttCommandWritesConfig(MqttCommand::LightingSchedule));
+  TEST_ASSERT_TRUE(mqttCommandWritesConfig(MqttCommand::InstallMode));
+  TEST_ASSERT_FALSE(mqttCommandWritesConfig(MqttCommand::Lighting));
+  TEST_ASSERT_FALSE(mqttCommandWritesConfig(MqttCommand::Boost));
+  TEST_ASSERT_FALSE(mqttCommandWritesConfig(MqttCommand::Reboot));
+  TEST_ASSERT_FALSE(mqttCommandWritesConfig(MqttCommand::FiltrationExternalState));
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_every_command_topic_maps);
+
+  RUN_TEST(test_on_off_is_trimmed_and_uppercased);
+  RUN_TEST(test_modes_are_lowercased_and_checked);
+  RUN_TEST(test_targets_are_range_checked);
+  RUN_TEST(test_daily_targets_are_strictly_numeric);
+  RUN_TEST(test_times_and_reboot);
+  RUN_TEST(test_long_payload_is_truncated);
+
+  RUN_TEST(test_batch_last_command_wins);
+  RUN_TEST(test_batch_invalid_does_not_override_valid);
+  RUN_TEST(test_batch_restore_burst_and_clear);
+  RUN_TEST(test_config_commands_vs_actions);
+
+  return UNITY_END();
+}
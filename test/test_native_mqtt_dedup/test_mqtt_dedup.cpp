@@ -0,0 +1,187 @@
+// =============================================================================
+// Tests unitaires natifs — mqtt_dedup (publication MQTT sur changement)
+// =============================================================================
+// Tournent sur PC (env:native, Unity), HORS matériel ESP32 / PubSubClient.
+// On teste :
+//   - 1ʳᵉ publication, valeur inchangée, bande morte (franchissement, dérive
+//     lente mesurée depuis la dernière valeur PUBLIÉE)
+//   - dédup texte (ON/OFF, modes), changement de nature valeur ↔ texte
+//   - rafraîchissement forcé, wrap de millis(), reset() de session
+//   - topics en pass-through (alerts, logs, status, diagnostic, history)
+// =============================================================================
+
+#include <unity.h>
+#include <stdint.h>
+#include "mqtt_dedup.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// -----------------------------------------------------------------------------
+// Valeurs en virgule fixe
+// -----------------------------------------------------------------------------
+void test_value_first_publish_is_due(void) {
+  MqttDedup d;
+  TEST_ASSERT_TRUE(d.valueDue(MqttTopicId::PhState, 7200, 1000));
+}
+
+void test_value_unchanged_is_not_due(void) {
+  MqttDedup d;
+  d.markValue(MqttTopicId::PhDailyMlState, 125, 1000);
+  TEST_ASSERT_FALSE(d.valueDue(MqttTopicId::PhDailyMlState, 125, 11000));
+  TEST_ASSERT_TRUE(d.valueDue(MqttTopicId::PhDailyMlState, 126, 11000));  // bande morte nulle
+}
+
+void test_value_deadband_ph(void) {
+  MqttDedup d;
+  TEST_ASSERT_EQUAL_INT32(kMqttDeadbandPhMilli, d.deadband(MqttTopicId::PhState));
+  d.markValue(MqttTopicId::PhState, 7200, 0);
+  TEST_ASSERT_FALSE(d.valueDue(MqttTopicId::PhState, 7209, 10000));
+  TEST_ASSERT_FALSE(d.valueDue(MqttTopicId::PhState, 7191, 10000));
+  TEST_ASSERT_TRUE(d.valueDue(MqttTopicId::PhState, 7210, 10000));
+  TEST_ASSERT_TRUE(d.valueDue(MqttTopicId::PhState, 7190, 10000));
+}
+
+void test_value_slow_drift_publishes_once_band_crossed(void) {
+  MqttDedup d;
+  d.markValue(MqttTopicId::OrpState, 650, 0);
+  // +1 mV par cycle : comparé à la dernière valeur publiée, pas à la précédente.
+  TEST_ASSERT_FALSE(d.valueDue(MqttTopicId::OrpState, 651, 10000));
+  TEST_ASSERT_FALSE(d.valueDue(MqttTopicId::OrpState, 652, 20000));
+  TEST_ASSERT_TRUE(d.valueDue(MqttTopicId::OrpState, 653, 30000));
+}
+
+void test_value_custom_deadband(void) {
+  MqttDedup d;
+  d.setDeadband(MqttTopicId::PhRemainingState, 50);
+  d.markValue(MqttTopicId::PhRemainingState, 1000, 0);
+  TEST_ASSERT_FALSE(d.valueDue(MqttTopicId::PhRemainingState, 951, 1000));
+  TEST_ASSERT_TRUE(d.valueDue(MqttTopicId::PhRemainingState, 950, 1000));
+  d.setDeadband(MqttTopicId::PhRemainingState, -3);  // borné à 0
+  TEST_ASSERT_EQUAL_INT32(0, d.deadband(MqttTopicId::PhRemainingState));
+}
+
+void test_value_negative_and_extreme_values(void) {
+  MqttDedup d;
+  d.markValue(MqttTopicId::PhCalPointsState, -1, 0);
+  TEST_ASSERT_FALSE(d.valueDue(MqttTopicId::PhCalPointsState, -1, 1000));
+  TEST_ASSERT_TRUE(d.valueDue(MqttTopicId::PhCalPointsState, 2, 1000));
+  d.markValue(MqttTopicId::OrpState, INT32_MIN, 0);
+  TEST_ASSERT_TRUE(d.valueDue(MqttTopicId::OrpState, INT32_MAX, 1000));  // pas d'overflow
+}
+
+// -----------------------------------------------------------------------------
+// Payloads texte
+// -----------------------------------------------------------------------------
+void test_text_dedup(void) {
+  MqttDedup d;
+  TEST_ASSERT_TRUE(d.textDue(MqttTopicId::FiltrationState, "ON", 0));
+  d.markText(MqttTopicId::FiltrationState, "ON", 0);
+  TEST_ASSERT_FALSE(d.textDue(MqttTopicId::FiltrationState, "ON", 10000));
+  TEST_ASSERT_TRUE(d.textDue(MqttTopicId::FiltrationState, "OFF", 10000));
+  d.markText(MqttTopicId::FiltrationModeState, "auto", 0);
+  TEST_ASSERT_TRUE(d.textDue(MqttTopicId::FiltrationModeState, "manual", 10));
+  TEST_ASSERT_FALSE(d.textDue(MqttTopicId::FiltrationModeState, "auto", 10));
+}
+
+void test_text_null_payload_equals_empty(void) {
+  MqttDedup d;
+  d.markText(MqttTopicId::LightingEndState, "", 0);
+  TEST_ASSERT_FALSE(d.textDue(MqttTopicId::LightingEndState, nullptr, 10));
+}
+
+void test_kind_change_is_due(void) {
+  MqttDedup d;
+  d.markText(MqttTopicId::PhRemainingState, "500", 0);
+  TEST_ASSERT_TRUE(d.valueDue(MqttTopicId::PhRemainingState, 500, 10));
+}
+
+void test_topics_are_independent(void) {
+  MqttDedup d;
+  d.markText(MqttTopicId::PhDosingState, "OFF", 0);
+  TEST_ASSERT_TRUE(d.textDue(MqttTopicId::OrpDosingState, "OFF", 10));
+}
+
+// -----------------------------------------------------------------------------
+// Rafraîchissement forcé / session
+// -----------------------------------------------------------------------------
+void test_forced_refresh(void) {
+  MqttDedup d;
+  d.markValue(MqttTopicId::TemperatureState, 265, 5000);
+  TEST_ASSERT_FALSE(d.valueDue(MqttTopicId::TemperatureState, 265, 5000 + kMqttDedupRefreshMs - 1));
+  TEST_ASSERT_TRUE(d.valueDue(MqttTopicId::TemperatureState, 265, 5000 + kMqttDedupRefreshMs));
+  d.markText(MqttTopicId::BoostState, "OFF", 5000);
+  TEST_ASSERT_TRUE(d.textDue(MqttTopicId::BoostState, "OFF", 5000 + kMqttDedupRefreshMs));
+}
+
+void test_forced_refresh_across_millis_wrap(void) {
+  MqttDedup d;
+  d.markText(MqttTopicId::LightingState, "ON", 0xFFFFF000u);
+  TEST_ASSERT_FALSE(d.textDue(MqttTopicId::LightingState, "ON", 0x00001000u));
+  TEST_ASSERT_TRUE(d.textDue(MqttTopicId::LightingState, "ON", 0xFFFFF000u + kMqttDedupRefreshMs));
+}
+
+void test_reset_forgets_values_keeps_deadbands(void) {
+  MqttDedup d;
+  d.setDeadband(MqttTopicId::OrpState, 20);
+  d.markValue(MqttTopicId::OrpState, 700, 0);
+  d.markText(MqttTopicId::FiltrationState, "ON", 0);
+  d.reset();
+  TEST_ASSERT_TRUE(d.valueDue(MqttTopicId::OrpState, 700, 10));
+  TEST_ASSERT_TRUE(d.textDue(MqttTopicId::FiltrationState, "ON", 10));
+  TEST_ASSERT_EQUAL_INT32(20, d.deadband(MqttTopicId::OrpState));
+}
+
+// -----------------------------------------------------------------------------
+// Pass-through
+// -----------------------------------------------------------------------------
+void test_event_topics_are_pass_through(void) {
+  MqttDedup d;
+  const MqttTopicId events[] = {
+    MqttTopicId::Alerts, MqttTopicId::Logs, MqttTopicId::Status, MqttTopicId::Diagnostic,
+    MqttTopicId::SensorHealth,
+    MqttTopicId::AlertsCalibration, MqttTopicId::AlertsSensorStale, MqttTopicId::AlertsSensorFrozen,
+    MqttTopicId::History, MqttTopicId::StateDocument,
+  };
+  for (MqttTopicId id : events) {
+    TEST_ASSERT_FALSE(MqttDedup::isDeduplicated(id));
+    d.markText(id, "online", 0);
+    TEST_ASSERT_TRUE(d.textDue(id, "online", 1));
+  }
+  TEST_ASSERT_FALSE(MqttDedup::isDeduplicated(MqttTopicId::PhTargetCommand));
+  TEST_ASSERT_TRUE(MqttDedup::isDeduplicated(MqttTopicId::PhTargetState));
+}
+
+void test_suppressed_counter(void) {
+  MqttDedup d;
+  TEST_ASSERT_EQUAL_UINT32(0, d.suppressedCount());
+  d.noteSuppressed();
+  d.noteSuppressed();
+  d.reset();
+  TEST_ASSERT_EQUAL_UINT32(2, d.suppressedCount());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_value_first_publish_is_due);
+  RUN_TEST(test_value_unchanged_is_not_due);
+  RUN_TEST(test_value_deadband_ph);
+  RUN_TEST(test_value_slow_drift_publishes_once_band_crossed);
+  RUN_TEST(test_value_custom_deadband);
+  RUN_TEST(test_value_negative_and_extreme_values);
+
+  RUN_TEST(test_text_dedup);
+  RUN_TEST(test_text_null_payload_equals_empty);
+  RUN_TEST(test_kind_change_is_due);
+  RUN_TEST(test_topics_are_independent);
+
+  RUN_TEST(test_forced_refresh);
+  RUN_TEST(test_forced_refresh_across_millis_wrap);
+  RUN_TEST(test_reset_forgets_values_keeps_deadbands);
+
+  RUN_TEST(test_event_topics_are_pass_through);
+  RUN_TEST(test_suppressed_counter);
+
+  return UNITY_END();
+}
@@ -0,0 +1,265 @@
+// =============================================================================
+// Tests unitaires natifs — mqtt_discovery (auto-discovery HA incrémentale)
+// =============================================================================
+// Tournent sur PC (env:native, Unity), HORS matériel ESP32.
+// On teste :
+//   - topic de config et payload JSON (sensor, select, number, switch optimiste)
+//   - mode document d'état : state_topic {base}/state + value_template
+//   - entité retirée (payload vide), échappement, débordement
+//   - cohérence de la table : object_id uniques, natures des topics
+//   - pire cas : toutes les entités tiennent dans kHaDiscoveryPayloadMax
+//   - hash et cache (republication uniquement si le payload change)
+// =============================================================================
+
+#include <unity.h>
+#include <string.h>
+#include "mqtt_discovery.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static MqttTopicTable topics;
+
+static HaDiscoveryContext ctx(bool stateJson = false) {
+  return HaDiscoveryContext{&topics, stateJson, "homeassistant", "poolcontroller", "Pool Controller"};
+}
+
+static const HaEntity* find(const char* objectId, HaComponent component) {
+  for (size_t i = 0; i < kHaEntityCount; ++i) {
+    if (kHaEntities[i].component == component && strcmp(kHaEntities[i].objectId, objectId) == 0) {
+      return &kHaEntities[i];
+    }
+  }
+  return nullptr;
+}
+
+static bool contains(const char* haystack, const char* needle) {
+  return strstr(haystack, needle) != nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Sérialisation
+// -----------------------------------------------------------------------------
+void test_config_topic(void) {
+  topics.build("pool/sensors");
+  char buf[kHaDiscoveryTopicMax];
+  const HaEntity* e = find("ph_dosing", HaComponent::BinarySensor);
+  TEST_ASSERT_NOT_NULL(e);
+  TEST_ASSERT_TRUE(haDiscoveryTopic(*e, ctx(), buf, sizeof(buf)) > 0);
+  TEST_ASSERT_EQUAL_STRING("homeassistant/binary_sensor/poolcontroller_ph_dosing/config", buf);
+}
+
+void test_sensor_payload(void) {
+  topics.build("pool/sensors");
+  char buf[kHaDiscoveryPayloadMax];
+  const HaEntity* e = find("temperature", HaComponent::Sensor);
+  TEST_ASSERT_NOT_NULL(e);
+  TEST_ASSERT_TRUE(haDiscoveryPayload(*e, ctx(), buf, sizeof(buf)) > 0);
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"name\":\"Piscine Température\",\"unique_id\":\"poolcontroller_temperature\","
+      "\"state_topic\":\"pool/sensors/temperature\",\"device_class\":\"temperature\","
+      "\"unit_of_measurement\":\"°C\",\"state_class\":\"measurement\","
+      "\"device\":{\"name\":\"Pool Controller\",\"manufacturer\":\"ESP32\","
+      "\"model\":\"Pool Controller\",\"identifiers\":[\"poolcontroller\"]}}",
+      buf);
+}
+
+void test_select_payload(void) {
+  topics.build("pool/sensors");
+  char buf[kHaDiscoveryPayloadMax];
+  const HaEntity* e = find("lighting_schedule", HaComponent::Select);
+  TEST_ASSERT_NOT_NULL(e);
+  TEST_ASSERT_TRUE(haDiscoveryPayload(*e, ctx(), buf, sizeof(buf)) > 0);
+  TEST_ASSERT_TRUE(contains(buf, "\"command_topic\":\"pool/sensors/lighting_schedule/set\""));
+  TEST_ASSERT_TRUE(contains(buf, "\"options\":[\"Programmation\",\"Désactivé\"]"));
+  TEST_ASSERT_TRUE(contains(buf,
+      "\"value_template\":\"{{ {'ON':'Programmation','OFF':'Désactivé'}.get(value, value) }}\""));
+  TEST_ASSERT_TRUE(contains(buf,
+      "\"command_template\":\"{{ {'Programmation':'ON','Désactivé':'OFF'}[value] }}\""));
+}
+
+void test_number_and_optimistic_switch_payloads(void) {
+  topics.build("pool/sensors");
+  char buf[kHaDiscoveryPayloadMax];
+  const HaEntity* e = find("ph_daily_target", HaComponent::Number);
+  TEST_ASSERT_NOT_NULL(e);
+  TEST_ASSERT_TRUE(haDiscoveryPayload(*e, ctx(), buf, sizeof(buf)) > 0);
+  TEST_ASSERT_TRUE(contains(buf, "\"min\":0,\"max\":2000,\"step\":10,\"mode\":\"box\""));
+
+  e = find("filtration_external", HaComponent::Switch);
+  TEST_ASSERT_NOT_NULL(e);
+  TEST_ASSERT_TRUE(haDiscoveryPayload(*e, ctx(), buf, sizeof(buf)) > 0);
+  TEST_ASSERT_FALSE(contains(buf, "state_topic"));
+  TEST_ASSERT_TRUE(contains(buf, "\"optimistic\":true"));
+  TEST_ASSERT_TRUE(contains(buf, "\"command_topic\":\"pool/sensors/filtration_external_state/set\""));
+}
+
+void test_state_document_mode(void) {
+  topics.build("pool/sensors");
+  char buf[kHaDiscoveryPayloadMax];
+  const HaEntity* e = find("ph", HaComponent::Sensor);
+  TEST_ASSERT_NOT_NULL(e);
+  haDiscoveryPayload(*e, ctx(true), buf, sizeof(buf));
+  TEST_ASSERT_TRUE(contains(buf, "\"state_topic\":\"pool/sensors/state\""));
+  TEST_ASSERT_TRUE(contains(buf, "\"value_template\":\"{{ value_json.ph | default('') }}\""));
+
+  // Select : extraction de `value` puis template de libellés inchangé.
+  e = find("filtration_mode", HaComponent::Select);
+  haDiscoveryPayload(*e, ctx(true), buf, sizeof(buf));
+  TEST_ASSERT_TRUE(contains(buf,
+      "\"value_template\":\"{% set value = value_json.filtration_mode | default('') %}{{ {'auto':"));
+
+  // La disponibilité reste sur son topic dédié.
+  e = find("status", HaComponent::BinarySensor);
+  haDiscoveryPayload(*e, ctx(true), buf, sizeof(buf));
+  TEST_ASSERT_TRUE(contains(buf, "\"state_topic\":\"pool/sensors/status\""));
+  TEST_ASSERT_FALSE(contains(buf, "value_template"));
+}
+
+void test_removed_entity_has_empty_payload(void) {
+  topics.build("pool/sensors");
+  char buf[kHaDiscoveryPayloadMax];
+  const HaEntity* e = find("lighting_schedule", HaComponent::Switch);
+  TEST_ASSERT_NOT_NULL(e);
+  TEST_ASSERT_EQUAL_UINT32(0, haDiscoveryPayload(*e, ctx(), buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("", buf);
+}
+
+void test_device_fields_are_escaped(void) {
+  topics.build("pool/sensors");
+  char buf[kHaDiscoveryPayloadMax];
+  HaDiscoveryContext c = ctx();
+  c.deviceName = "Pool \"A\"";
+  haDiscoveryPayload(kHaEntities[0], c, buf, sizeof(buf));
+  TEST_ASSERT_TRUE(contains(buf, "\"device\":{\"name\":\"Pool \\\"A\\\"\""));
+}
+
+void test_overflow_returns_zero(void) {
+  topics.build("pool/sensors");
+  char buf[32];
+  TEST_ASSERT_EQUAL_UINT32(0, haDiscoveryPayload(kHaEntities[0], ctx(), buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_UINT32(sizeof(buf) - 1, strlen(buf));
+  TEST_ASSERT_EQUAL_UINT32(0, haDiscoveryTopic(kHaEntities[0], ctx(), buf, 8));
+}
+
+// -----------------------------------------------------------------------------
+// Table
+// -----------------------------------------------------------------------------
+void test_table_is_consistent(void) {
+  TEST_ASSERT_TRUE(kHaEntityCount <= HaDiscoveryCache::kSlots);
+  for (size_t i = 0; i < kHaEntityCount; ++i) {
+    const HaEntity& a = kHaEntities[i];
+    for (size_t j = i + 1; j < kHaEntityCount; ++j) {
+      const HaEntity& b = kHaEntities[j];
+      const bool same = a.component == b.component && strcmp(a.objectId, b.objectId) == 0;
+      TEST_ASSERT_FALSE_MESSAGE(same, a.objectId);
+    }
+    if (a.state != MqttTopicId::Count) {
+      TEST_ASSERT_TRUE(mqttTopicKind(a.state) == MqttTopicKind::State);
+    }
+    if (a.command != MqttTopicId::Count) {
+      TEST_ASSERT_TRUE(mqttTopicKind(a.command) == MqttTopicKind::Command);
+    }
+  }
+}
+
+void test_worst_case_fits_buffers(void) {
+  // Base de longueur maximale, mode document d'état (templates les plus longs).
+  char base[kMqttMaxBaseLen + 1];
+  memset(base, 'b', kMqttMaxBaseLen);
+  base[kMqttMaxBaseLen] = '\0';
+  topics.build(base);
+  char topic[kHaDiscoveryTopicMax];
+  char payload[kHaDiscoveryPayloadMax];
+  for (size_t i = 0; i < kHaEntityCount; ++i) {
+    const HaEntity& e = kHaEntities[i];
+    TEST_ASSERT_TRUE_MESSAGE(haDiscoveryTopic(e, ctx(true), topic, sizeof(topic)) > 0, e.objectId);
+    if (e.name == nullptr) continue;
+    TEST_ASSERT_TRUE_MESSAGE(haDiscoveryPayload(e, ctx(true), payload, sizeof(payload)) > 0, e.objectId);
+    TEST_ASSERT_TRUE_MESSAGE(haDiscoveryPayload(e, ctx(false), payload, sizeof(payload)) > 0, e.objectId);
+  }
+  topics.build("pool/sensors");
+}
+
+// -----------------------------------------------------------------------------
+// Hash et cache
+// -----------------------------------------------------------------------------
+void test_hash_follows_payload(void) {
+  char topic[kHaDiscoveryTopicMax];
+  char payload[kHaDiscoveryPayloadMax];
+  const HaEntity* e = find("ph", HaComponent::Sensor);
+
+  topics.build("pool/sensors");
+  haDiscoveryTopic(*e, ctx(), topic, sizeof(topic));
+  haDiscoveryPayload(*e, ctx(), payload, sizeof(payload));
+  const uint32_t h1 = haDiscoveryHash(topic, payload);
+  TEST_ASSERT_EQUAL_UINT32(h1, haDiscoveryHash(topic, payload));
+
+  haDiscoveryPayload(*e, ctx(true), payload, sizeof(payload));
+  const uint32_t h2 = haDiscoveryHash(topic, payload);
+  TEST_ASSERT_TRUE(h1 != h2);
+
+  topics.build("piscine");
+  haDiscoveryPayload(*e, ctx(), payload, sizeof(payload));
+  TEST_ASSERT_TRUE(h1 != haDiscoveryHash(topic, payload));
+  topics.build("pool/sensors");
+
+  // Payload vide (entité retirée) : hash non nul, donc mémorisable.
+  TEST_ASSERT_TRUE(haDiscoveryHash(topic, "") != 0);
+}
+
+void test_cache_mark_and_invalidate(void) {
+  HaDiscoveryCache cache;
+  cache.clearDirty();
+  TEST_ASSERT_FALSE(cache.isPublished(3, 0x1234));
+  cache.markPublished(3, 0x1234);
+  TEST_ASSERT_TRUE(cache.dirty());
+  TEST_ASSERT_TRUE(cache.isPublished(3, 0x1234));
+  TEST_ASSERT_FALSE(cache.isPublished(3, 0x1235));
+  TEST_ASSERT_FALSE(cache.isPublished(4, 0x1234));
+
+  // Même hash : rien à persister.
+  cache.clearDirty();
+  cache.markPublished(3, 0x1234);
+  TEST_ASSERT_FALSE(cache.dirty());
+
+  cache.invalidate();
+  TEST_ASSERT_FALSE(cache.isPublished(3, 0x1234));
+  TEST_ASSERT_TRUE(cache.dirty());
+}
+
+void test_cache_load_round_trip(void) {
+  HaDiscoveryCache a;
+  a.markPublished(0, 11);
+  a.markPublished(HaDiscoveryCache::kSlots - 1, 22);
+
+  HaDiscoveryCache b;
+  TEST_ASSERT_FALSE(b.load(a.data(), HaDiscoveryCache::dataSize() - 4));
+  TEST_ASSERT_FALSE(b.isPublished(0, 11));
+  TEST_ASSERT_TRUE(b.load(a.data(), HaDiscoveryCache::dataSize()));
+  TEST_ASSERT_FALSE(b.dirty());
+  TEST_ASSERT_TRUE(b.isPublished(0, 11));
+  TEST_ASSERT_TRUE(b.isPublished(HaDiscoveryCache::kSlots - 1, 22));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_config_topic);
+  RUN_TEST(test_sensor_payload);
+  RUN_TEST(test_select_payload);
+  RUN_TEST(test_number_and_optimistic_switch_payloads);
+  RUN_TEST(test_state_document_mode);
+  RUN_TEST(test_removed_entity_has_empty_payload);
+  RUN_TEST(test_device_fields_are_escaped);
+  RUN_TEST(test_overflow_returns_zero);
+
+  RUN_TEST(test_table_is_consistent);
+  RUN_TEST(test_worst_case_fits_buffers);
+
+  RUN_TEST(test_hash_follows_payload);
+  RUN_TEST(test_cache_mark_and_invalidate);
+  RUN_TEST(test_cache_load_round_trip);
+
+  return UNITY_END();
+}
@@ -0,0 +1,413 @@
+// =============================================================================
+// Tests unitaires natifs — mqtt_outbox (store-and-forward MQTT)
+// =============================================================================
+// Tournent sur PC (env:native, Unity), HORS matériel ESP32 / LittleFS.
+// Le spill flash est remplacé par un store mémoire (MemSpill).
+// On teste :
+//   - classes : State abandonné hors-ligne, Event en RAM, Alert/Sample en spill
+//   - voies : routage, remplacement des états, tourniquet pondéré
+//   - ordre de rejeu : fusion spill/RAM par séquence dans une voie, reprise après reboot
+//   - voie pleine : éviction de la tête (abandon ou déversement), voies isolées
+//   - échec de publication : persistant conservé en tête, éphémère abandonné
+//   - budgets du spill (échantillons vs alertes) et cadence de rejeu
+// =============================================================================
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "mqtt_outbox.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// -----------------------------------------------------------------------------
+// Spill mémoire : FIFO bornée, même contrat que le store LittleFS
+// -----------------------------------------------------------------------------
+class MemSpill : public MqttSpillStore {
+public:
+  static constexpr size_t kSlots = 400;
+  MqttOutboxRecord recs[kSlots];
+  size_t head = 0;
+  size_t tail = 0;
+  size_t bytes = 0;
+  bool failAppend = false;
+
+  bool append(const MqttOutboxRecord& rec) override {
+    if (failAppend || tail == kSlots) return false;
+    recs[tail++] = rec;
+    bytes += rec.storedSize();
+    return true;
+  }
+  bool peek(MqttOutboxRecord& out) override {
+    if (empty()) return false;
+    out = recs[head];
+    return true;
+  }
+  void pop() override {
+    if (empty()) return;
+    bytes -= recs[head].storedSize();
+    head++;
+  }
+  bool empty() const override { return head == tail; }
+  size_t usedBytes() const override { return bytes; }
+  uint32_t lastSeq() const override { return empty() ? 0 : recs[tail - 1].seq; }
+  size_t count() const { return tail - head; }
+};
+
+static MqttOutboxRecord rec(MqttTopicId id, const char* payload, bool retain = false) {
+  MqttOutboxRecord r;
+  r.set(id, mqttMsgClassFor(id), retain, payload, 0);
+  return r;
+}
+
+// Publie tout ce qui est en attente (succès) et concatène les payloads.
+static void drainAll(MqttOutbox& box, char* out, size_t outLen) {
+  out[0] = '\0';
+  MqttOutboxRecord r;
+  while (box.front(r)) {
+    strncat(out, r.payload, outLen - strlen(out) - 1);
+    strncat(out, ",", outLen - strlen(out) - 1);
+    box.complete(true);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Classes / routage
+// -----------------------------------------------------------------------------
+void test_class_mapping(void) {
+  TEST_ASSERT_EQUAL(MqttMsgClass::Alert, mqttMsgClassFor(MqttTopicId::Alerts));
+  TEST_ASSERT_EQUAL(MqttMsgClass::Alert, mqttMsgClassFor(MqttTopicId::AlertsSensorStale));
+  TEST_ASSERT_EQUAL(MqttMsgClass::Event, mqttMsgClassFor(MqttTopicId::Logs));
+  TEST_ASSERT_EQUAL(MqttMsgClass::Sample, mqttMsgClassFor(MqttTopicId::History));
+  TEST_ASSERT_EQUAL(MqttMsgClass::State, mqttMsgClassFor(MqttTopicId::Status));
+  TEST_ASSERT_EQUAL(MqttMsgClass::State, mqttMsgClassFor(MqttTopicId::PhState));
+}
+
+void test_record_set_truncates_payload(void) {
+  char big[300];
+  memset(big, 'a', sizeof(big) - 1);
+  big[sizeof(big) - 1] = '\0';
+  MqttOutboxRecord r = rec(MqttTopicId::Logs, big);
+  TEST_ASSERT_EQUAL_UINT32(kMqttOutboxPayloadMax - 1, r.len);
+  TEST_ASSERT_EQUAL_UINT32(kMqttOutboxPayloadMax - 1, strlen(r.payload));
+  r.set(MqttTopicId::Logs, MqttMsgClass::Event, false, nullptr, 0);
+  TEST_ASSERT_EQUAL_UINT32(0, r.len);
+}
+
+void test_connected_everything_goes_to_ram(void) {
+  MemSpill spill;
+  MqttOutbox box(&spill);
+  TEST_ASSERT_EQUAL(MqttOutboxPush::Queued, box.push(rec(MqttTopicId::PhState, "7.2"), true));
+  TEST_ASSERT_EQUAL(MqttOutboxPush::Queued, box.push(rec(MqttTopicId::Alerts, "a"), true));
+  TEST_ASSERT_EQUAL_UINT32(2, box.ramCount());
+  TEST_ASSERT_TRUE(spill.empty());
+}
+
+void test_disconnected_routing(void) {
+  MemSpill spill;
+  MqttOutbox box(&spill);
+  TEST_ASSERT_EQUAL(MqttOutboxPush::Dropped, box.push(rec(MqttTopicId::PhState, "7.2"), false));
+  TEST_ASSERT_EQUAL(MqttOutboxPush::Queued, box.push(rec(MqttTopicId::Logs, "log"), false));
+  TEST_ASSERT_EQUAL(MqttOutboxPush::Spilled, box.push(rec(MqttTopicId::Alerts, "a"), false));
+  TEST_ASSERT_EQUAL(MqttOutboxPush::Spilled, box.push(rec(MqttTopicId::History, "s"), false));
+  TEST_ASSERT_EQUAL_UINT32(1, box.ramCount());
+  TEST_ASSERT_EQUAL_UINT32(2, spill.count());
+  TEST_ASSERT_EQUAL_UINT32(1, box.droppedCount());
+  TEST_ASSERT_EQUAL_UINT32(2, box.spilledCount());
+}
+
+void test_no_spill_keeps_persistent_in_ram(void) {
+  MqttOutbox box;
+  TEST_ASSERT_EQUAL(MqttOutboxPush::Queued, box.push(rec(MqttTopicId::Alerts, "a"), false));
+  TEST_ASSERT_EQUAL(MqttOutboxPush::Queued, box.push(rec(MqttTopicId::History, "s"), false));
+  TEST_ASSERT_EQUAL_UINT32(2, box.ramCount());
+}
+
+// -----------------------------------------------------------------------------
+// Voies de priorité
+// -----------------------------------------------------------------------------
+void test_lane_mapping(void) {
+  TEST_ASSERT_EQUAL(MqttLane::Control, mqttLaneFor(MqttTopicId::Status));
+  TEST_ASSERT_EQUAL(MqttLane::Control, mqttLaneFor(MqttTopicId::FiltrationState));
+  TEST_ASSERT_EQUAL(MqttLane::Control, mqttLaneFor(MqttTopicId::PhTargetState));
+  TEST_ASSERT_EQUAL(MqttLane::Alert, mqttLaneFor(MqttTopicId::Alerts));
+  TEST_ASSERT_EQUAL(MqttLane::Alert, mqttLaneFor(MqttTopicId::AlertsSensorFrozen));
+  TEST_ASSERT_EQUAL(MqttLane::Telemetry, mqttLaneFor(MqttTopicId::PhState));
+  TEST_ASSERT_EQUAL(MqttLane::Telemetry, mqttLaneFor(MqttTopicId::Logs));
+  TEST_ASSERT_EQUAL(MqttLane::Telemetry, mqttLaneFor(MqttTopicId::History));
+}
+
+void test_pending_state_is_coalesced(void) {
+  MqttOutbox box;
+  box.push(rec(MqttTopicId::PhState, "7.1"), true);
+  box.push(rec(MqttTopicId::OrpState, "650"), true);
+  box.push(rec(MqttTopicId::PhState, "7.2"), true);
+  TEST_ASSERT_EQUAL_UINT32(2, box.ramCount());
+  TEST_ASSERT_EQUAL_UINT32(1, box.coalescedCount());
+  TEST_ASSERT_EQUAL_UINT32(0, box.droppedCount());
+  // Place d'origine conservée, dernière valeur publiée.
+  char out[32];
+  drainAll(box, out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("7.2,650,", out);
+}
+
+void test_events_are_not_coalesced(void) {
+  MqttOutbox box;
+  box.push(rec(MqttTopicId::Logs, "a"), true);
+  box.push(rec(MqttTopicId::Logs, "b"), true);
+  box.push(rec(MqttTopicId::Alerts, "x"), true);
+  box.push(rec(MqttTopicId::Alerts, "y"), true);
+  TEST_ASSERT_EQUAL_UINT32(4, box.ramCount());
+  TEST_ASSERT_EQUAL_UINT32(0, box.coalescedCount());
+}
+
+void test_telemetry_burst_does_not_evict_alerts(void) {
+  MqttOutbox box;
+  box.push(rec(MqttTopicId::Alerts, "alert"), true);
+  char p[8];
+  for (int i = 0; i < 50; ++i) {
+    snprintf(p, sizeof(p), "%d", i);
+    box.push(rec(MqttTopicId::Logs, p), true);
+  }
+  TEST_ASSERT_EQUAL_UINT32(1, box.laneCount(MqttLane::Alert));
+  TEST_ASSERT_EQUAL_UINT32(0, box.laneDroppedCount(MqttLane::Alert));
+  MqttOutboxRecord r;
+  TEST_ASSERT_TRUE(box.front(r));
+  TEST_ASSERT_EQUAL_STRING("alert", r.payload);
+}
+
+void test_weighted_drain_shares_each_round(void) {
+  // Trois voies chargées : sur kMqttOutboxLiveBurst publish, chaque voie en
+  // obtient exactement son poids, dans l'ordre de priorité.
+  MqttOutbox box;
+  const MqttTopicId control[] = {MqttTopicId::FiltrationState, MqttTopicId::LightingState,
+                                 MqttTopicId::BoostState, MqttTopicId::PhTargetState,
+                                 MqttTopicId::OrpTargetState};
+  for (MqttTopicId id : control) box.push(rec(id, "C"), true);
+  for (int i = 0; i < 5; ++i) box.push(rec(MqttTopicId::Alerts, "A"), true);
+  for (int i = 0; i < 5; ++i) box.push(rec(MqttTopicId::Logs, "T"), true);
+
+  char out[64] = "";
+  MqttOutboxRecord r;
+  for (size_t i = 0; i < kMqttOutboxLiveBurst; ++i) {
+    TEST_ASSERT_TRUE(box.front(r));
+    strcat(out, r.payload);
+    box.complete(true);
+  }
+  TEST_ASSERT_EQUAL_STRING("CCCAAATT", out);
+  // Tour suivant : le reliquat, mêmes priorités.
+  drainAll(box, out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("C,C,A,A,T,T,T,", out);
+}
+
+void test_weighted_drain_is_work_conserving(void) {
+  // Seule la télémétrie a du travail : elle prend tout le débit.
+  MqttOutbox box;
+  for (int i = 0; i < 10; ++i) box.push(rec(MqttTopicId::Logs, "T"), true);
+  MqttOutboxRecord r;
+  for (int i = 0; i < 10; ++i) {
+    TEST_ASSERT_TRUE(box.front(r));
+    box.complete(true);
+  }
+  TEST_ASSERT_TRUE(box.empty());
+  TEST_ASSERT_FALSE(box.front(r));
+}
+
+// -----------------------------------------------------------------------------
+// Ordre de rejeu
+// -----------------------------------------------------------------------------
+void test_replay_merges_spill_and_ram_per_lane(void) {
+  MemSpill spill;
+  MqttOutbox box(&spill);
+  box.push(rec(MqttTopicId::Logs, "1"), false);     // RAM, télémétrie
+  box.push(rec(MqttTopicId::Alerts, "2"), false);   // spill
+  box.push(rec(MqttTopicId::Logs, "3"), false);     // RAM, télémétrie
+  box.push(rec(MqttTopicId::History, "4"), false);  // spill
+  box.push(rec(MqttTopicId::PhState, "x"), false);  // abandonné
+  box.push(rec(MqttTopicId::Alerts, "5"), true);    // reconnecté : RAM, alertes
+  // Voie alertes d'abord (spill puis RAM), puis télémétrie dans l'ordre de
+  // production, échantillon du spill compris.
+  char out[64];
+  drainAll(box, out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("2,5,1,3,4,", out);
+  TEST_ASSERT_TRUE(box.empty());
+  TEST_ASSERT_EQUAL_UINT32(5, box.sentCount());
+}
+
+void test_spill_from_previous_boot_replays_first(void) {
+  MemSpill spill;
+  {
+    MqttOutbox before(&spill);
+    before.push(rec(MqttTopicId::Alerts, "old1"), false);
+    before.push(rec(MqttTopicId::Alerts, "old2"), false);
+  }
+  // Reboot : nouvelle outbox, séquence reprise après le spill.
+  MqttOutbox box(&spill);
+  box.push(rec(MqttTopicId::Logs, "new"), true);
+  char out[64];
+  drainAll(box, out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("old1,old2,new,", out);
+}
+
+// -----------------------------------------------------------------------------
+// Anneau plein
+// -----------------------------------------------------------------------------
+void test_full_ring_evicts_oldest_event(void) {
+  MqttOutbox box;
+  const size_t slots = kMqttLaneSlots[static_cast<size_t>(MqttLane::Telemetry)];
+  char p[8];
+  for (size_t i = 0; i < slots + 3; ++i) {
+    snprintf(p, sizeof(p), "%u", static_cast<unsigned>(i));
+    box.push(rec(MqttTopicId::Logs, p), false);
+  }
+  TEST_ASSERT_EQUAL_UINT32(slots, box.ramCount());
+  TEST_ASSERT_EQUAL_UINT32(3, box.laneDroppedCount(MqttLane::Telemetry));
+  TEST_ASSERT_EQUAL_UINT32(3, box.droppedCount());
+  MqttOutboxRecord r;
+  TEST_ASSERT_TRUE(box.front(r));
+  TEST_ASSERT_EQUAL_STRING("3", r.payload);
+}
+
+void test_full_ring_spills_persistent_head_in_order(void) {
+  MemSpill spill;
+  MqttOutbox box(&spill);
+  const size_t slots = kMqttLaneSlots[static_cast<size_t>(MqttLane::Alert)];
+  char p[8];
+  // Connecté mais lien lent : les alertes s'accumulent en RAM.
+  for (size_t i = 0; i < slots + 2; ++i) {
+    snprintf(p, sizeof(p), "%u", static_cast<unsigned>(i));
+    box.push(rec(MqttTopicId::Alerts, p), true);
+  }
+  TEST_ASSERT_EQUAL_UINT32(2, spill.count());
+  TEST_ASSERT_EQUAL_UINT32(0, box.droppedCount());
+  MqttOutboxRecord r;
+  for (size_t i = 0; i < slots + 2; ++i) {
+    TEST_ASSERT_TRUE(box.front(r));
+    snprintf(p, sizeof(p), "%u", static_cast<unsigned>(i));
+    TEST_ASSERT_EQUAL_STRING(p, r.payload);
+    box.complete(true);
+  }
+  TEST_ASSERT_TRUE(box.empty());
+}
+
+// -----------------------------------------------------------------------------
+// Échec de publication
+// -----------------------------------------------------------------------------
+void test_failed_persistent_stays_at_head(void) {
+  MemSpill spill;
+  MqttOutbox box(&spill);
+  box.push(rec(MqttTopicId::Alerts, "a"), false);
+  box.push(rec(MqttTopicId::Alerts, "b"), true);
+  MqttOutboxRecord r;
+  TEST_ASSERT_TRUE(box.front(r));
+  TEST_ASSERT_FALSE(box.complete(false));
+  TEST_ASSERT_TRUE(box.front(r));
+  TEST_ASSERT_EQUAL_STRING("a", r.payload);
+  box.complete(true);
+  TEST_ASSERT_TRUE(box.front(r));
+  TEST_ASSERT_FALSE(box.complete(false));
+  TEST_ASSERT_TRUE(box.front(r));
+  TEST_ASSERT_EQUAL_STRING("b", r.payload);
+}
+
+void test_failed_ephemeral_is_dropped(void) {
+  MqttOutbox box;
+  box.push(rec(MqttTopicId::PhState, "7.2"), true);
+  box.push(rec(MqttTopicId::Logs, "l"), true);
+  MqttOutboxRecord r;
+  TEST_ASSERT_TRUE(box.front(r));
+  TEST_ASSERT_TRUE(box.complete(false));
+  TEST_ASSERT_TRUE(box.front(r));
+  TEST_ASSERT_EQUAL_STRING("l", r.payload);
+  TEST_ASSERT_EQUAL_UINT32(1, box.droppedCount());
+}
+
+// -----------------------------------------------------------------------------
+// Budgets du spill
+// -----------------------------------------------------------------------------
+void test_sample_budget_reserves_room_for_alerts(void) {
+  MemSpill spill;
+  MqttOutbox box(&spill);
+  char payload[100];
+  memset(payload, 's', sizeof(payload) - 1);
+  payload[sizeof(payload) - 1] = '\0';
+  MqttOutboxPush last = MqttOutboxPush::Spilled;
+  size_t samples = 0;
+  while (last == MqttOutboxPush::Spilled && samples < MemSpill::kSlots) {
+    last = box.push(rec(MqttTopicId::History, payload), false);
+    if (last == MqttOutboxPush::Spilled) samples++;
+  }
+  TEST_ASSERT_EQUAL(MqttOutboxPush::Dropped, last);
+  TEST_ASSERT_TRUE(box.spillBytes() <= kMqttSpillSampleMaxBytes);
+  TEST_ASSERT_EQUAL_UINT32(0, box.ramCount());  // pas de repli RAM pour les échantillons
+  // Les alertes ont encore de la place au-delà du budget échantillons.
+  TEST_ASSERT_EQUAL(MqttOutboxPush::Spilled, box.push(rec(MqttTopicId::Alerts, payload), false));
+}
+
+void test_spill_failure_falls_back_to_ram(void) {
+  MemSpill spill;
+  spill.failAppend = true;
+  MqttOutbox box(&spill);
+  TEST_ASSERT_EQUAL(MqttOutboxPush::Queued, box.push(rec(MqttTopicId::Alerts, "a"), false));
+  TEST_ASSERT_EQUAL_UINT32(1, box.ramCount());
+}
+
+// -----------------------------------------------------------------------------
+// Cadence de rejeu
+// -----------------------------------------------------------------------------
+void test_live_budget_when_backlog_small(void) {
+  MqttOutbox box;
+  box.push(rec(MqttTopicId::PhState, "7.2"), true);
+  TEST_ASSERT_EQUAL_UINT32(kMqttOutboxLiveBurst, box.flushBudget(0));
+  TEST_ASSERT_EQUAL_UINT32(kMqttOutboxLiveBurst, box.flushBudget(1));
+}
+
+void test_replay_budget_is_rate_limited(void) {
+  MemSpill spill;
+  MqttOutbox box(&spill);
+  for (int i = 0; i < 10; ++i) box.push(rec(MqttTopicId::Alerts, "a"), false);
+  const uint32_t t0 = 0xFFFFFF00u;  // fenêtre à cheval sur le wrap de millis()
+  TEST_ASSERT_EQUAL_UINT32(kMqttReplayBurst, box.flushBudget(t0));
+  MqttOutboxRecord r;
+  for (size_t i = 0; i < kMqttReplayBurst; ++i) {
+    box.front(r);
+    box.complete(true);
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, box.flushBudget(t0 + 10));
+  TEST_ASSERT_EQUAL_UINT32(0, box.flushBudget(t0 + kMqttReplayIntervalMs - 1));
+  TEST_ASSERT_EQUAL_UINT32(kMqttReplayBurst, box.flushBudget(t0 + kMqttReplayIntervalMs));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_class_mapping);
+  RUN_TEST(test_record_set_truncates_payload);
+  RUN_TEST(test_connected_everything_goes_to_ram);
+  RUN_TEST(test_disconnected_routing);
+  RUN_TEST(test_no_spill_keeps_persistent_in_ram);
+
+  RUN_TEST(test_lane_mapping);
+  RUN_TEST(test_pending_state_is_coalesced);
+  RUN_TEST(test_events_are_not_coalesced);
+  RUN_TEST(test_telemetry_burst_does_not_evict_alerts);
+  RUN_TEST(test_weighted_drain_shares_each_round);
+  RUN_TEST(test_weighted_drain_is_work_conserving);
+
+  RUN_TEST(test_replay_merges_spill_and_ram_per_lane);
+  RUN_TEST(test_spill_from_previous_boot_replays_first);
+
+  RUN_TEST(test_full_ring_evicts_oldest_event);
+  RUN_TEST(test_full_ring_spills_persistent_head_in_order);
+
+  RUN_TEST(test_failed_persistent_stays_at_head);
+  RUN_TEST(test_failed_ephemeral_is_dropped);
+
+  RUN_TEST(test_sample_budget_reserves_room_for_alerts);
+  RUN_TEST(test_spill_failure_falls_back_to_ram);
+
+  RUN_TEST(test_live_budget_when_backlog_small);
+  RUN_TEST(test_replay_budget_is_rate_limited);
+
+  return UNITY_END();
+}
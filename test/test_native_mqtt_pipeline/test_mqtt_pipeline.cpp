@@ -0,0 +1,491 @@
+// =============================================================================
+// Banc d'intégration natif — chaîne MQTT complète contre un broker simulé
+// =============================================================================
+// Tourne sur PC (env:native, Unity), HORS matériel ESP32 / FreeRTOS / réseau.
+// Pilote le MqttPipeline (mqtt_pipeline.h) qu'utilise mqtt_manager.cpp, avec
+// des FIFO à la place des queues FreeRTOS et un broker simulé à la place de
+// PubSubClient :
+//
+//   producteur → mqtt_slab + file de poignées → dédup (mqtt_dedup) → mqtt_outbox
+//     → FakeBroker (retain + journal)  ;  FakeBroker → mqtt_topics::matchCommand
+//     → mqtt_commands → file entrante → application sous « configMutex »
+//
+// Seule l'application des consignes pH/ORP (lot coalescé, publishTargetState)
+// est simulée ici ; l'horloge aussi (une itération de mqttTask =
+// kMqttTaskLoopTimeoutMs). On mesure et on vérifie :
+//   - débit (messages/s) de la chaîne producteur → broker
+//   - latence d'une commande HA ph_target/set → consigne appliquée → état
+//     republié (en itérations et en temps CPU)
+//   - tempête de reconnexions : alertes livrées une fois, dans l'ordre ;
+//     états retain finaux exacts ; aucun bloc du pool perdu
+//   - saturation de la file sortante : drop du plus ancien, valeurs les plus
+//     récentes livrées, pool rendu intégralement
+// Les chiffres de débit/latence sont imprimés (TEST_MESSAGE) à titre indicatif,
+// sans seuil : ils dépendent de la machine.
+// =============================================================================
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "mqtt_pipeline.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// -----------------------------------------------------------------------------
+// Spill mémoire : FIFO circulaire, même contrat que le store LittleFS
+// -----------------------------------------------------------------------------
+class MemSpill : public MqttSpillStore {
+public:
+  static constexpr size_t kSlots = 256;
+  MqttOutboxRecord recs[kSlots];
+  size_t head = 0;
+  size_t count = 0;
+  size_t bytes = 0;
+
+  bool append(const MqttOutboxRecord& rec) override {
+    if (count == kSlots) return false;
+    recs[(head + count) % kSlots] = rec;
+    count++;
+    bytes += rec.storedSize();
+    return true;
+  }
+  bool peek(MqttOutboxRecord& out) override {
+    if (empty()) return false;
+    out = recs[head];
+    return true;
+  }
+  void pop() override {
+    if (empty()) return;
+    bytes -= recs[head].storedSize();
+    head = (head + 1) % kSlots;
+    count--;
+  }
+  bool empty() const override { return count == 0; }
+  size_t usedBytes() const override { return bytes; }
+  uint32_t lastSeq() const override { return empty() ? 0 : recs[(head + count - 1) % kSlots].seq; }
+};
+
+// -----------------------------------------------------------------------------
+// Broker simulé : dernier retain par topic + journal des alertes
+// -----------------------------------------------------------------------------
+struct FakeBroker {
+  static constexpr size_t kRetainSlots = 96;
+  static constexpr size_t kAlertLog = 1024;
+
+  bool online = true;
+  uint32_t published = 0;
+  char retainedTopic[kRetainSlots][96] = {};
+  char retained[kRetainSlots][kMqttSlabPayloadMax + 1] = {};
+  size_t retainedCount = 0;
+  int alertSeq[kAlertLog] = {};
+  size_t alertCount = 0;
+  const char* alertsTopic = nullptr;
+
+  bool publish(const char* topic, const char* payload, bool retain) {
+    if (!online) return false;
+    published++;
+    if (alertsTopic != nullptr && strcmp(topic, alertsTopic) == 0 && alertCount < kAlertLog) {
+      int seq = -1;
+      sscanf(payload, "{\"seq\":%d}", &seq);
+      alertSeq[alertCount++] = seq;
+    }
+    if (retain) {
+      size_t i = 0;
+      while (i < retainedCount && strcmp(retainedTopic[i], topic) != 0) ++i;
+      if (i == retainedCount) {
+        if (retainedCount == kRetainSlots) return true;
+        strncpy(retainedTopic[i], topic, sizeof(retainedTopic[i]) - 1);
+        retainedCount++;
+      }
+      strncpy(retained[i], payload, sizeof(retained[i]) - 1);
+      retained[i][sizeof(retained[i]) - 1] = '\0';
+    }
+    return true;
+  }
+
+  const char* retainedValue(const char* topic) const {
+    for (size_t i = 0; i < retainedCount; ++i) {
+      if (strcmp(retainedTopic[i], topic) == 0) return retained[i];
+    }
+    return "";
+  }
+};
+
+// -----------------------------------------------------------------------------
+// Appareil : MqttPipeline branché sur des FIFO et le broker simulé
+// -----------------------------------------------------------------------------
+template <typename T, size_t N>
+struct Fifo : public MqttQueue<T> {
+  T items[N];
+  size_t head = 0;
+  size_t count = 0;
+  bool send(const T& v) override {
+    if (count == N) return false;
+    items[(head + count) % N] = v;
+    count++;
+    return true;
+  }
+  bool receive(T& out) override {
+    if (count == 0) return false;
+    out = items[head];
+    head = (head + 1) % N;
+    count--;
+    return true;
+  }
+};
+
+// mqtt.connected() = linkUp (vue du client) ; publish() échoue si le broker
+// est tombé sans que le client ne l'ait encore vu.
+struct BrokerLink : public MqttPublisher {
+  FakeBroker& broker;
+  bool linkUp = true;
+  explicit BrokerLink(FakeBroker& b) : broker(b) {}
+  bool connected() override { return linkUp; }
+  bool publish(const char* topic, const char* payload, bool retain) override {
+    return linkUp && broker.publish(topic, payload, retain);
+  }
+};
+
+struct Device {
+  FakeBroker& broker;
+  BrokerLink link;
+  MqttTopicTable topics;
+  MqttSlabPool slab;
+  Fifo<MqttSlabHandle, kMqttOutQueueLength> outQueue;
+  Fifo<MqttInboundCmd, kMqttInQueueLength> inQueue;
+  MqttDedup dedup;
+  MemSpill spill;
+  MqttOutbox outbox;
+  MqttPipeline pipeline;
+  uint32_t nowMs = 1000;
+  uint32_t queueDrops = 0;
+  uint32_t iterations = 0;
+
+  // Config appliquée par loopTask (configMutex, NVS et broadcast WS simulés par
+  // des compteurs).
+  MqttCommandBatch cmdBatch;
+  float phTarget = 7.2f;
+  float orpTarget = 650.0f;
+  uint32_t configTakes = 0;
+  uint32_t configSaves = 0;
+  uint32_t broadcasts = 0;
+
+  explicit Device(FakeBroker& b)
+      : broker(b), link(b), outbox(&spill), pipeline(topics, slab, dedup, outbox) {
+    topics.build("pool/sensors");
+    broker.alertsTopic = topics.get(MqttTopicId::Alerts);
+    pipeline.attach(&outQueue, &inQueue, &link);
+  }
+
+  void setLinkUp(bool up) { link.linkUp = up; }
+  bool linkUp() const { return link.linkUp; }
+
+  void enqueueOutbound(MqttTopicId id, const char* text, bool retain) {
+    queueDrops += pipeline.enqueue(id, text, retain).dropped;
+  }
+
+  // PubSubClient → messageCallback().
+  bool onMessage(const char* topic, const char* payload) {
+    return pipeline.onMessage(topic, reinterpret_cast<const uint8_t*>(payload), strlen(payload)) ==
+           MqttInboundResult::Queued;
+  }
+
+  // drainCommandQueue(), consignes pH/ORP : inQueue drainée en lot coalescé,
+  // une prise de configMutex, une écriture NVS, un publishTargetState() et un
+  // broadcast WS par lot.
+  void drainCommandQueue() {
+    bool configCmd = false;
+    pipeline.collectCommands(cmdBatch, configCmd);
+    if (cmdBatch.size() == 0) return;
+    bool persist = false;
+    configTakes++;
+    for (size_t i = 0; i < cmdBatch.size(); ++i) {
+      const MqttCommandArgs& args = cmdBatch.args(i);
+      if (!args.valid) continue;
+      if (cmdBatch.type(i) == MqttCommand::PhTarget) phTarget = args.number;
+      else if (cmdBatch.type(i) == MqttCommand::OrpTarget) orpTarget = args.number;
+      else continue;
+      persist = true;
+    }
+    if (persist) configSaves++;
+    publishTargetState();
+    broadcasts++;
+  }
+
+  void publishTargetState() {
+    char text[16];
+    snprintf(text, sizeof(text), "%.1f", static_cast<double>(phTarget));
+    enqueueOutbound(MqttTopicId::PhTargetState, text, true);
+    snprintf(text, sizeof(text), "%.0f", static_cast<double>(orpTarget));
+    enqueueOutbound(MqttTopicId::OrpTargetState, text, true);
+  }
+
+  // Une itération de taskLoop() après connexion.
+  void mqttIteration() {
+    pipeline.drainOutQueue(nowMs, 0, true, false);
+    pipeline.flushOutbox(nowMs);
+    nowMs += kMqttTaskLoopTimeoutMs;
+    iterations++;
+  }
+
+  // Reconnexion : dédup remise à zéro (connectInTask) puis état courant republié.
+  void reconnect() {
+    setLinkUp(true);
+    broker.online = true;
+    dedup.reset();
+  }
+
+  bool idle() const { return outQueue.count == 0 && outbox.empty(); }
+
+  size_t slabInUse() const {
+    size_t n = 0;
+    for (size_t c = 0; c < kMqttSlabClassCount; ++c) n += slab.used(c);
+    return n;
+  }
+};
+
+static double elapsedSec(clock_t start) {
+  return static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void postAlert(Device& dev, int seq) {
+  char text[24];
+  snprintf(text, sizeof(text), "{\"seq\":%d}", seq);
+  dev.enqueueOutbound(MqttTopicId::Alerts, text, false);
+}
+
+static void assertAlertsInOrder(const FakeBroker& broker, int expected) {
+  TEST_ASSERT_EQUAL(expected, broker.alertCount);
+  for (int i = 0; i < expected; ++i) TEST_ASSERT_EQUAL(i, broker.alertSeq[i]);
+}
+
+// Fait tourner mqttTask jusqu'à vider file et outbox (rejeu cadencé compris).
+static void settle(Device& dev) {
+  for (int i = 0; i < 10000 && !dev.idle(); ++i) dev.mqttIteration();
+  TEST_ASSERT_TRUE(dev.idle());
+}
+
+// -----------------------------------------------------------------------------
+// Débit
+// -----------------------------------------------------------------------------
+
+void test_throughput_states_and_alerts(void) {
+  static FakeBroker broker;
+  static Device dev(broker);
+  static const MqttTopicId kStates[] = {
+      MqttTopicId::TemperatureState, MqttTopicId::PhState, MqttTopicId::OrpState,
+      MqttTopicId::FiltrationState, MqttTopicId::LightingState, MqttTopicId::PhDosingState,
+  };
+  constexpr int kMessages = 20000;
+  int alerts = 0;
+  char text[16];
+
+  const clock_t start = clock();
+  for (int i = 0; i < kMessages; ++i) {
+    if (i % 50 == 0) {
+      postAlert(dev, alerts++);
+    } else {
+      snprintf(text, sizeof(text), "%d", i);
+      dev.enqueueOutbound(kStates[i % 6], text, true);
+    }
+    if (i % 4 == 3) dev.mqttIteration();
+  }
+  settle(dev);
+  const double sec = elapsedSec(start);
+
+  char msg[128];
+  snprintf(msg, sizeof(msg), "%d messages, %u publiés, %.0f msg/s (CPU), %u coalescés",
+           kMessages, static_cast<unsigned>(broker.published), sec > 0 ? kMessages / sec : 0.0,
+           static_cast<unsigned>(dev.outbox.coalescedCount()));
+  TEST_MESSAGE(msg);
+
+  assertAlertsInOrder(broker, alerts);
+  TEST_ASSERT_EQUAL_UINT32(0, dev.queueDrops);
+  TEST_ASSERT_EQUAL(0, dev.slabInUse());
+  // Dernière valeur de chaque état présente chez le broker.
+  snprintf(text, sizeof(text), "%d", kMessages - 1);
+  TEST_ASSERT_EQUAL_STRING(text, broker.retainedValue(dev.topics.get(kStates[(kMessages - 1) % 6])));
+}
+
+// -----------------------------------------------------------------------------
+// Latence de commande
+// -----------------------------------------------------------------------------
+
+void test_command_round_trip_latency(void) {
+  static FakeBroker broker;
+  static Device dev(broker);
+  const char* setTopic = dev.topics.get(MqttTopicId::PhTargetCommand);
+  const char* stateTopic = dev.topics.get(MqttTopicId::PhTargetState);
+  constexpr int kCommands = 1000;
+  char value[16];
+  uint32_t maxIterations = 0;
+
+  const clock_t start = clock();
+  for (int i = 0; i < kCommands; ++i) {
+    snprintf(value, sizeof(value), "%.1f", 6.0 + (i % 25) * 0.1);
+    TEST_ASSERT_TRUE(dev.onMessage(setTopic, value));  // mqttTask : mqtt.loop()
+    dev.drainCommandQueue();                            // loopTask
+    const uint32_t before = dev.iterations;
+    while (strcmp(broker.retainedValue(stateTopic), value) != 0 && dev.iterations - before < 50) {
+      dev.mqttIteration();
+    }
+    TEST_ASSERT_EQUAL_STRING(value, broker.retainedValue(stateTopic));
+    if (dev.iterations - before > maxIterations) maxIterations = dev.iterations - before;
+  }
+  const double sec = elapsedSec(start);
+
+  char msg[128];
+  snprintf(msg, sizeof(msg), "%d commandes, %.2f us/aller-retour (CPU), <= %u iteration(s) mqttTask",
+           kCommands, sec * 1e6 / kCommands, static_cast<unsigned>(maxIterations));
+  TEST_MESSAGE(msg);
+
+  // Appliquée dans le tour de loopTask suivant, acquittée dès l'itération suivante.
+  TEST_ASSERT_EQUAL_UINT32(kCommands, dev.configTakes);
+  TEST_ASSERT_EQUAL_UINT32(1, maxIterations);
+  TEST_ASSERT_FALSE(dev.onMessage(dev.topics.get(MqttTopicId::PhTargetState), "7.0"));
+}
+
+void test_invalid_command_is_not_applied(void) {
+  static FakeBroker broker;
+  static Device dev(broker);
+  TEST_ASSERT_TRUE(dev.onMessage(dev.topics.get(MqttTopicId::PhTargetCommand), "9.9"));
+  dev.drainCommandQueue();
+  TEST_ASSERT_EQUAL_UINT32(0, dev.configSaves);
+  TEST_ASSERT_EQUAL_FLOAT(7.2f, dev.phTarget);
+}
+
+// Restauration d'état HA : rafale de consignes reçues avant le tour de loopTask.
+void test_command_burst_is_coalesced(void) {
+  static FakeBroker broker;
+  static Device dev(broker);
+  const char* phSet = dev.topics.get(MqttTopicId::PhTargetCommand);
+  const char* orpSet = dev.topics.get(MqttTopicId::OrpTargetCommand);
+  const char* phValues[] = {"7.0", "7.1", "9.9", "7.3", "7.4", "7.5"};
+  for (const char* v : phValues) TEST_ASSERT_TRUE(dev.onMessage(phSet, v));
+  for (int i = 0; i < 6; ++i) {
+    char v[8];
+    snprintf(v, sizeof(v), "%d", 600 + i * 10);
+    TEST_ASSERT_TRUE(dev.onMessage(orpSet, v));
+  }
+  TEST_ASSERT_TRUE(dev.onMessage(phSet, "abc"));  // invalide : n'écrase pas 7.5
+
+  dev.drainCommandQueue();
+  char msg[96];
+  snprintf(msg, sizeof(msg), "13 commandes -> %u prise(s) mutex, %u écriture(s) NVS, %u broadcast(s)",
+           (unsigned)dev.configTakes, (unsigned)dev.configSaves, (unsigned)dev.broadcasts);
+  TEST_MESSAGE(msg);
+
+  TEST_ASSERT_EQUAL_UINT32(1, dev.configTakes);
+  TEST_ASSERT_EQUAL_UINT32(1, dev.configSaves);
+  TEST_ASSERT_EQUAL_UINT32(1, dev.broadcasts);
+  TEST_ASSERT_EQUAL_FLOAT(7.5f, dev.phTarget);
+  TEST_ASSERT_EQUAL_FLOAT(650.0f, dev.orpTarget);
+  dev.mqttIteration();
+  TEST_ASSERT_EQUAL_STRING("7.5", broker.retainedValue(dev.topics.get(MqttTopicId::PhTargetState)));
+  TEST_ASSERT_EQUAL_STRING("650", broker.retainedValue(dev.topics.get(MqttTopicId::OrpTargetState)));
+}
+
+// -----------------------------------------------------------------------------
+// Tempête de reconnexions
+// -----------------------------------------------------------------------------
+
+void test_reconnect_storm(void) {
+  static FakeBroker broker;
+  static Device dev(broker);
+  const char* filtTopic = dev.topics.get(MqttTopicId::FiltrationState);
+  constexpr int kCycles = 300;
+  const char* filtration = "OFF";
+
+  for (int i = 0; i < kCycles; ++i) {
+    // Coupure une itération sur trois ; le broker tombe avant que le client ne le voie.
+    const bool down = (i % 3) == 1;
+    broker.online = !down;
+    if (i % 3 == 2) {
+      dev.setLinkUp(false);  // détectée à l'itération suivante
+    } else if (!dev.linkUp() && !down) {
+      dev.reconnect();
+      dev.enqueueOutbound(MqttTopicId::FiltrationState, filtration, true);  // publishAllStates
+    }
+    postAlert(dev, i);
+    filtration = (i % 2) ? "ON" : "OFF";
+    dev.enqueueOutbound(MqttTopicId::FiltrationState, filtration, true);
+    dev.mqttIteration();
+  }
+  dev.reconnect();
+  dev.enqueueOutbound(MqttTopicId::FiltrationState, filtration, true);
+  settle(dev);
+
+  char msg[128];
+  snprintf(msg, sizeof(msg), "%d cycles, %u publiés, %u déversés, %u abandonnés",
+           kCycles, static_cast<unsigned>(broker.published),
+           static_cast<unsigned>(dev.outbox.spilledCount()),
+           static_cast<unsigned>(dev.outbox.droppedCount()));
+  TEST_MESSAGE(msg);
+
+  assertAlertsInOrder(broker, kCycles);
+  TEST_ASSERT_EQUAL_STRING(filtration, broker.retainedValue(filtTopic));
+  TEST_ASSERT_EQUAL(0, dev.slabInUse());
+}
+
+// -----------------------------------------------------------------------------
+// Saturation de la file sortante
+// -----------------------------------------------------------------------------
+
+void test_queue_saturation_keeps_newest(void) {
+  static FakeBroker broker;
+  static Device dev(broker);
+  static const MqttTopicId kStates[] = {
+      MqttTopicId::TemperatureState, MqttTopicId::PhState, MqttTopicId::OrpState,
+      MqttTopicId::PhRemainingState, MqttTopicId::OrpRemainingState,
+  };
+  constexpr int kBurst = 500;
+  char text[16];
+
+  // mqttTask bloquée (connect TCP, DNS…) : rien n'est drainé pendant la rafale.
+  for (int i = 0; i < kBurst; ++i) {
+    snprintf(text, sizeof(text), "%d", i);
+    dev.enqueueOutbound(kStates[i % 5], text, true);
+  }
+  const size_t capacity = kMqttSlabBlockCount[0] + kMqttSlabBlockCount[1];
+  TEST_ASSERT_EQUAL(capacity, dev.outQueue.count);
+  TEST_ASSERT_EQUAL_UINT32(kBurst - capacity, dev.queueDrops);
+  TEST_ASSERT_EQUAL(0, dev.slab.used(2));  // le bloc du diagnostic reste libre
+  TEST_ASSERT_TRUE(dev.slab.failures() > 0);
+
+  settle(dev);
+  for (int k = 0; k < 5; ++k) {
+    snprintf(text, sizeof(text), "%d", kBurst - 5 + k);
+    TEST_ASSERT_EQUAL_STRING(text, broker.retainedValue(dev.topics.get(kStates[(kBurst - 5 + k) % 5])));
+  }
+  TEST_ASSERT_EQUAL(0, dev.slabInUse());
+  TEST_ASSERT_EQUAL(capacity, dev.slab.peak(0) + dev.slab.peak(1));
+}
+
+void test_large_payload_bypasses_outbox(void) {
+  static FakeBroker broker;
+  static Device dev(broker);
+  static char diag[900];
+  memset(diag, 'd', sizeof(diag) - 1);
+  diag[sizeof(diag) - 1] = '\0';
+  dev.enqueueOutbound(MqttTopicId::Diagnostic, diag, true);
+  TEST_ASSERT_EQUAL(1, dev.slab.used(2));
+  dev.mqttIteration();
+  TEST_ASSERT_EQUAL_STRING(diag, broker.retainedValue(dev.topics.get(MqttTopicId::Diagnostic)));
+  TEST_ASSERT_EQUAL(0, dev.slabInUse());
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_throughput_states_and_alerts);
+  RUN_TEST(test_command_round_trip_latency);
+  RUN_TEST(test_invalid_command_is_not_applied);
+  RUN_TEST(test_command_burst_is_coalesced);
+  RUN_TEST(test_reconnect_storm);
+  RUN_TEST(test_queue_saturation_keeps_newest);
+  RUN_TEST(test_large_payload_bypasses_outbox);
+
+  return UNITY_END();
+}
@@ -0,0 +1,141 @@
+// =============================================================================
+// Tests unitaires natifs — mqtt_slab (pool de records MQTT sortants)
+// =============================================================================
+// Tournent sur PC (env:native, Unity), HORS matériel ESP32 / FreeRTOS.
+// On teste :
+//   - choix de la classe selon la longueur, troncature au-delà du max
+//   - contenu du record (en-tête + payload NUL-terminé)
+//   - épuisement : débordement vers la classe suivante, dernière réservée
+//   - libération et réutilisation, compteurs d'occupation / pic / échecs
+// =============================================================================
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "mqtt_slab.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static size_t classOf(MqttSlabHandle h) { return h >> 8; }
+
+// -----------------------------------------------------------------------------
+// Classes et contenu
+// -----------------------------------------------------------------------------
+
+void test_class_follows_payload_length(void) {
+  MqttSlabPool pool;
+  const size_t max0 = kMqttSlabBlockSize[0] - sizeof(MqttSlabHeader) - 1;
+  const size_t max1 = kMqttSlabBlockSize[1] - sizeof(MqttSlabHeader) - 1;
+  TEST_ASSERT_EQUAL(0, classOf(pool.alloc(0)));
+  TEST_ASSERT_EQUAL(0, classOf(pool.alloc(max0)));
+  TEST_ASSERT_EQUAL(1, classOf(pool.alloc(max0 + 1)));
+  TEST_ASSERT_EQUAL(1, classOf(pool.alloc(max1)));
+  TEST_ASSERT_EQUAL(2, classOf(pool.alloc(max1 + 1)));
+  TEST_ASSERT_EQUAL(2, classOf(pool.alloc(kMqttSlabPayloadMax)));
+  TEST_ASSERT_EQUAL_UINT16(kMqttSlabNone, pool.alloc(kMqttSlabPayloadMax + 1));
+  TEST_ASSERT_EQUAL_UINT32(1, pool.failures());
+}
+
+void test_store_writes_header_and_payload(void) {
+  MqttSlabPool pool;
+  const MqttSlabHandle h = pool.store(MqttTopicId::FiltrationState, true, "ON", 2);
+  TEST_ASSERT_NOT_EQUAL(kMqttSlabNone, h);
+  const MqttSlabHeader& hdr = pool.header(h);
+  TEST_ASSERT_EQUAL(static_cast<int>(MqttTopicId::FiltrationState), static_cast<int>(hdr.topic));
+  TEST_ASSERT_TRUE(hdr.retain);
+  TEST_ASSERT_EQUAL_UINT16(2, hdr.len);
+  TEST_ASSERT_EQUAL_STRING("ON", pool.payload(h));
+  TEST_ASSERT_EQUAL(kMqttSlabBlockSize[0] - sizeof(MqttSlabHeader), pool.capacity(h));
+}
+
+void test_store_truncates_oversized_payload(void) {
+  MqttSlabPool pool;
+  static char big[kMqttSlabPayloadMax + 50];
+  memset(big, 'x', sizeof(big));
+  const MqttSlabHandle h = pool.store(MqttTopicId::Logs, false, big, sizeof(big));
+  TEST_ASSERT_NOT_EQUAL(kMqttSlabNone, h);
+  TEST_ASSERT_EQUAL_UINT16(kMqttSlabPayloadMax, pool.header(h).len);
+  TEST_ASSERT_EQUAL(kMqttSlabPayloadMax, strlen(pool.payload(h)));
+}
+
+void test_records_do_not_overlap(void) {
+  MqttSlabPool pool;
+  MqttSlabHandle hs[kMqttSlabBlockCount[0]];
+  char text[8];
+  for (size_t i = 0; i < kMqttSlabBlockCount[0]; ++i) {
+    snprintf(text, sizeof(text), "%u", static_cast<unsigned>(i));
+    hs[i] = pool.store(MqttTopicId::TemperatureState, true, text, strlen(text));
+    TEST_ASSERT_EQUAL(0, classOf(hs[i]));
+  }
+  for (size_t i = 0; i < kMqttSlabBlockCount[0]; ++i) {
+    snprintf(text, sizeof(text), "%u", static_cast<unsigned>(i));
+    TEST_ASSERT_EQUAL_STRING(text, pool.payload(hs[i]));
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Épuisement et réutilisation
+// -----------------------------------------------------------------------------
+
+void test_exhausted_class_overflows_to_next(void) {
+  MqttSlabPool pool;
+  for (size_t i = 0; i < kMqttSlabBlockCount[0]; ++i) pool.alloc(2);
+  const MqttSlabHandle h = pool.alloc(2);
+  TEST_ASSERT_EQUAL(1, classOf(h));
+  TEST_ASSERT_EQUAL(kMqttSlabBlockCount[0], pool.used(0));
+  TEST_ASSERT_EQUAL(1, pool.used(1));
+  TEST_ASSERT_EQUAL_UINT32(0, pool.failures());
+}
+
+void test_last_class_is_reserved(void) {
+  MqttSlabPool pool;
+  for (size_t i = 0; i < kMqttSlabBlockCount[1]; ++i) pool.alloc(100);
+  // Classe 1 pleine : un record moyen ne vole pas un bloc du diagnostic.
+  TEST_ASSERT_EQUAL_UINT16(kMqttSlabNone, pool.alloc(100));
+  TEST_ASSERT_EQUAL(0, pool.used(2));
+  TEST_ASSERT_EQUAL_UINT32(1, pool.failures());
+  TEST_ASSERT_NOT_EQUAL(kMqttSlabNone, pool.alloc(500));
+}
+
+void test_release_makes_block_reusable(void) {
+  MqttSlabPool pool;
+  MqttSlabHandle hs[kMqttSlabBlockCount[2]];
+  for (size_t i = 0; i < kMqttSlabBlockCount[2]; ++i) hs[i] = pool.alloc(800);
+  TEST_ASSERT_EQUAL_UINT16(kMqttSlabNone, pool.alloc(800));
+  pool.release(hs[0]);
+  TEST_ASSERT_EQUAL(kMqttSlabBlockCount[2] - 1, pool.used(2));
+  TEST_ASSERT_EQUAL_UINT16(hs[0], pool.alloc(800));
+  pool.release(kMqttSlabNone);  // ignoré
+  TEST_ASSERT_EQUAL(kMqttSlabBlockCount[2], pool.used(2));
+}
+
+void test_peak_tracks_high_water_mark(void) {
+  MqttSlabPool pool;
+  MqttSlabHandle a = pool.alloc(1);
+  MqttSlabHandle b = pool.alloc(1);
+  MqttSlabHandle c = pool.alloc(1);
+  pool.release(a);
+  pool.release(b);
+  pool.release(c);
+  TEST_ASSERT_EQUAL(0, pool.used(0));
+  TEST_ASSERT_EQUAL(3, pool.peak(0));
+  pool.alloc(1);
+  TEST_ASSERT_EQUAL(3, pool.peak(0));
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_class_follows_payload_length);
+  RUN_TEST(test_store_writes_header_and_payload);
+  RUN_TEST(test_store_truncates_oversized_payload);
+  RUN_TEST(test_records_do_not_overlap);
+
+  RUN_TEST(test_exhausted_class_overflows_to_next);
+  RUN_TEST(test_last_class_is_reserved);
+  RUN_TEST(test_release_makes_block_reusable);
+  RUN_TEST(test_peak_tracks_high_water_mark);
+
+  return UNITY_END();
+}
@@ -0,0 +1,213 @@
+// =============================================================================
+// Tests unitaires natifs — mqtt_state_doc (document d'état JSON unique)
+// =============================================================================
+// Tournent sur PC (env:native, Unity), HORS matériel ESP32.
+// On teste :
+//   - sérialisation : virgule fixe (signe, zéros, arrondi), NaN omis, échappement
+//   - débordement du tampon détecté, NUL toujours présent
+//   - dédup par champ : document dû si un champ l'est, commit() mémorise tout
+//   - pire cas : tous les champs tiennent dans kMqttStateDocMax
+// =============================================================================
+
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include "mqtt_state_doc.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// -----------------------------------------------------------------------------
+// Sérialisation
+// -----------------------------------------------------------------------------
+void test_empty_document(void) {
+  char buf[8];
+  MqttDedup dedup;
+  MqttStateDoc doc(buf, sizeof(buf), dedup, 0);
+  TEST_ASSERT_TRUE(doc.finish());
+  TEST_ASSERT_EQUAL_STRING("{}", doc.c_str());
+  TEST_ASSERT_FALSE(doc.due());
+}
+
+void test_fixed_point_values(void) {
+  char buf[256];
+  MqttDedup dedup;
+  MqttStateDoc doc(buf, sizeof(buf), dedup, 0);
+  doc.value(MqttTopicId::PhState, 7.2149f, 3);
+  doc.value(MqttTopicId::OrpState, 682.4f, 0);
+  doc.value(MqttTopicId::TemperatureState, -0.44f, 1);
+  doc.value(MqttTopicId::PhSlopeZeroState, 0.05f, 2);
+  doc.value(MqttTopicId::PhDailyMlState, 12.0f, 1);
+  TEST_ASSERT_TRUE(doc.finish());
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"ph\":7.215,\"orp\":682,\"temperature\":-0.4,\"ph_slope_zero\":0.05,\"ph_daily_ml\":12.0}",
+      doc.c_str());
+}
+
+void test_nan_is_omitted(void) {
+  char buf[64];
+  MqttDedup dedup;
+  MqttStateDoc doc(buf, sizeof(buf), dedup, 0);
+  doc.value(MqttTopicId::PhState, NAN, 3);
+  doc.value(MqttTopicId::OrpState, 700.0f, 0);
+  TEST_ASSERT_TRUE(doc.finish());
+  TEST_ASSERT_EQUAL_STRING("{\"orp\":700}", doc.c_str());
+  TEST_ASSERT_EQUAL_UINT32(1, doc.fieldCount());
+}
+
+void test_text_is_escaped(void) {
+  char buf[64];
+  MqttDedup dedup;
+  MqttStateDoc doc(buf, sizeof(buf), dedup, 0);
+  doc.text(MqttTopicId::FiltrationModeState, "a\"b\\c\n");
+  doc.text(MqttTopicId::LightingState, nullptr);
+  TEST_ASSERT_TRUE(doc.finish());
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"filtration_mode\":\"a\\\"b\\\\c\\u000a\",\"lighting_state\":\"\"}", doc.c_str());
+}
+
+void test_overflow_is_detected(void) {
+  char buf[16];
+  MqttDedup dedup;
+  MqttStateDoc doc(buf, sizeof(buf), dedup, 0);
+  doc.text(MqttTopicId::FiltrationState, "ON");
+  doc.text(MqttTopicId::LightingState, "OFF");
+  TEST_ASSERT_FALSE(doc.finish());
+  TEST_ASSERT_TRUE(doc.overflowed());
+  TEST_ASSERT_EQUAL_UINT32(sizeof(buf) - 1, strlen(buf));
+}
+
+// -----------------------------------------------------------------------------
+// Dédup par champ
+// -----------------------------------------------------------------------------
+void test_due_until_committed(void) {
+  char buf[128];
+  MqttDedup dedup;
+  {
+    MqttStateDoc doc(buf, sizeof(buf), dedup, 1000);
+    doc.value(MqttTopicId::PhState, 7.2f, 3);
+    doc.text(MqttTopicId::FiltrationState, "ON");
+    TEST_ASSERT_TRUE(doc.finish());
+    TEST_ASSERT_TRUE(doc.due());
+    doc.commit(dedup);
+  }
+  // Valeurs identiques : plus rien de dû.
+  MqttStateDoc doc(buf, sizeof(buf), dedup, 2000);
+  doc.value(MqttTopicId::PhState, 7.2f, 3);
+  doc.text(MqttTopicId::FiltrationState, "ON");
+  TEST_ASSERT_TRUE(doc.finish());
+  TEST_ASSERT_FALSE(doc.due());
+}
+
+void test_single_changed_field_makes_document_due(void) {
+  char buf[128];
+  MqttDedup dedup;
+  {
+    MqttStateDoc doc(buf, sizeof(buf), dedup, 0);
+    doc.value(MqttTopicId::PhState, 7.200f, 3);
+    doc.text(MqttTopicId::FiltrationState, "ON");
+    doc.finish();
+    doc.commit(dedup);
+  }
+  // Sous la bande morte pH : pas dû.
+  {
+    MqttStateDoc doc(buf, sizeof(buf), dedup, 10);
+    doc.value(MqttTopicId::PhState, 7.205f, 3);
+    doc.text(MqttTopicId::FiltrationState, "ON");
+    doc.finish();
+    TEST_ASSERT_FALSE(doc.due());
+  }
+  // Texte changé : dû, et le document porte tous les champs.
+  MqttStateDoc doc(buf, sizeof(buf), dedup, 20);
+  doc.value(MqttTopicId::PhState, 7.205f, 3);
+  doc.text(MqttTopicId::FiltrationState, "OFF");
+  doc.finish();
+  TEST_ASSERT_TRUE(doc.due());
+  TEST_ASSERT_EQUAL_STRING("{\"ph\":7.205,\"filtration_state\":\"OFF\"}", doc.c_str());
+}
+
+void test_commit_matches_per_topic_marks(void) {
+  // Les entrées mémorisées par commit() sont celles de markValue/markText :
+  // un topic isolé peut ensuite être interrogé indifféremment.
+  char buf[128];
+  MqttDedup dedup;
+  MqttStateDoc doc(buf, sizeof(buf), dedup, 0);
+  doc.value(MqttTopicId::OrpState, 650.0f, 0);
+  doc.text(MqttTopicId::LightingState, "ON");
+  doc.finish();
+  doc.commit(dedup);
+  TEST_ASSERT_FALSE(dedup.valueDue(MqttTopicId::OrpState, 650, 1));
+  TEST_ASSERT_FALSE(dedup.textDue(MqttTopicId::LightingState, "ON", 1));
+  TEST_ASSERT_TRUE(dedup.textDue(MqttTopicId::LightingState, "OFF", 1));
+}
+
+void test_forced_refresh_makes_document_due(void) {
+  char buf[64];
+  MqttDedup dedup;
+  {
+    MqttStateDoc doc(buf, sizeof(buf), dedup, 0);
+    doc.text(MqttTopicId::BoostState, "OFF");
+    doc.finish();
+    doc.commit(dedup);
+  }
+  MqttStateDoc doc(buf, sizeof(buf), dedup, kMqttDedupRefreshMs);
+  doc.text(MqttTopicId::BoostState, "OFF");
+  doc.finish();
+  TEST_ASSERT_TRUE(doc.due());
+}
+
+void test_document_fields(void) {
+  TEST_ASSERT_TRUE(MqttStateDoc::isDocumentField(MqttTopicId::PhState));
+  TEST_ASSERT_TRUE(MqttStateDoc::isDocumentField(MqttTopicId::InstallModeState));
+  TEST_ASSERT_FALSE(MqttStateDoc::isDocumentField(MqttTopicId::StateDocument));
+  TEST_ASSERT_FALSE(MqttStateDoc::isDocumentField(MqttTopicId::Status));
+  TEST_ASSERT_FALSE(MqttStateDoc::isDocumentField(MqttTopicId::Diagnostic));
+  TEST_ASSERT_FALSE(MqttStateDoc::isDocumentField(MqttTopicId::AlertsCalibration));
+  TEST_ASSERT_FALSE(MqttStateDoc::isDocumentField(MqttTopicId::History));
+  TEST_ASSERT_FALSE(MqttStateDoc::isDocumentField(MqttTopicId::PhTargetCommand));
+}
+
+// -----------------------------------------------------------------------------
+// Dimensionnement
+// -----------------------------------------------------------------------------
+void test_worst_case_fits_buffer(void) {
+  // Tous les champs du document, valeur numérique la plus longue plausible
+  // (-99999.999) ou texte de 16 caractères (heures, modes).
+  static char buf[kMqttStateDocMax];
+  MqttDedup dedup;
+  MqttStateDoc doc(buf, sizeof(buf), dedup, 0);
+  size_t fields = 0;
+  for (size_t i = 0; i < kMqttTopicCount; ++i) {
+    const MqttTopicId id = static_cast<MqttTopicId>(i);
+    if (!MqttStateDoc::isDocumentField(id)) continue;
+    if (fields % 2 == 0) {
+      doc.value(id, -99999.999f, 3);
+    } else {
+      doc.text(id, "automatic_manual");
+    }
+    fields++;
+  }
+  TEST_ASSERT_TRUE(doc.finish());
+  TEST_ASSERT_EQUAL_UINT32(fields, doc.fieldCount());
+  TEST_ASSERT_TRUE(doc.length() < kMqttStateDocMax);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_empty_document);
+  RUN_TEST(test_fixed_point_values);
+  RUN_TEST(test_nan_is_omitted);
+  RUN_TEST(test_text_is_escaped);
+  RUN_TEST(test_overflow_is_detected);
+
+  RUN_TEST(test_due_until_committed);
+  RUN_TEST(test_single_changed_field_makes_document_due);
+  RUN_TEST(test_commit_matches_per_topic_marks);
+  RUN_TEST(test_forced_refresh_makes_document_due);
+  RUN_TEST(test_document_fields);
+
+  RUN_TEST(test_worst_case_fits_buffer);
+
+  return UNITY_END();
+}
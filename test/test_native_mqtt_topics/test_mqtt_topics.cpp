@@ -0,0 +1,203 @@
+// =============================================================================
+// Tests unitaires natifs — mqtt_topics (table des topics MQTT)
+// =============================================================================
+// Tournent sur PC (env:native, Unity), HORS matériel ESP32 / PubSubClient.
+// On teste :
+//   - build() : normalisation de la base (trim, '/' finaux, vide, trop longue)
+//     et reconstruction uniquement sur changement de base
+//   - get() : "{base}/{suffixe}" pour chaque MqttTopicId, bornes de l'arène
+//   - matchCommand() : dispatch de toutes les commandes, rejets (état, base
+//     différente, préfixe sans '/', suffixe inconnu)
+// =============================================================================
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "mqtt_topics.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void assertAllTopicsUnder(const MqttTopicTable& t, const char* base) {
+  char expected[128];
+  for (size_t i = 0; i < kMqttTopicCount; ++i) {
+    MqttTopicId id = static_cast<MqttTopicId>(i);
+    snprintf(expected, sizeof(expected), "%s/%s", base, mqttTopicSuffix(id));
+    TEST_ASSERT_EQUAL_STRING(expected, t.get(id));
+  }
+}
+
+// -----------------------------------------------------------------------------
+// Construction / normalisation
+// -----------------------------------------------------------------------------
+void test_default_table_uses_default_base(void) {
+  MqttTopicTable t;
+  TEST_ASSERT_EQUAL_STRING("pool/sensors", t.base());
+  TEST_ASSERT_EQUAL_STRING("pool/sensors/ph", t.get(MqttTopicId::PhState));
+  TEST_ASSERT_EQUAL_STRING("pool/sensors/filtration_external_state/set",
+                           t.get(MqttTopicId::FiltrationExternalStateCommand));
+  assertAllTopicsUnder(t, "pool/sensors");
+}
+
+void test_build_custom_base(void) {
+  MqttTopicTable t;
+  TEST_ASSERT_EQUAL(MqttTopicBuildResult::Rebuilt, t.build("maison/piscine"));
+  TEST_ASSERT_EQUAL_STRING("maison/piscine", t.base());
+  TEST_ASSERT_EQUAL_UINT32(14, t.baseLength());
+  TEST_ASSERT_EQUAL_STRING("maison/piscine/alerts/sensor_frozen",
+                           t.get(MqttTopicId::AlertsSensorFrozen));
+  assertAllTopicsUnder(t, "maison/piscine");
+}
+
+void test_build_trims_spaces_and_trailing_slashes(void) {
+  MqttTopicTable t;
+  t.build("  pool/garden//  ");
+  TEST_ASSERT_EQUAL_STRING("pool/garden", t.base());
+  TEST_ASSERT_EQUAL_STRING("pool/garden/status", t.get(MqttTopicId::Status));
+}
+
+void test_build_empty_or_slashes_falls_back_to_default(void) {
+  MqttTopicTable t;
+  t.build("autre");
+  t.build("   ");
+  TEST_ASSERT_EQUAL_STRING("pool/sensors", t.base());
+  t.build("autre");
+  t.build("///");
+  TEST_ASSERT_EQUAL_STRING("pool/sensors", t.base());
+  t.build(nullptr);
+  TEST_ASSERT_EQUAL_STRING("pool/sensors", t.base());
+}
+
+void test_build_same_base_is_unchanged_and_keeps_pointers(void) {
+  MqttTopicTable t;
+  t.build("a/b");
+  const char* before = t.get(MqttTopicId::PhState);
+  TEST_ASSERT_EQUAL(MqttTopicBuildResult::Unchanged, t.build("a/b/"));
+  TEST_ASSERT_EQUAL_PTR(before, t.get(MqttTopicId::PhState));
+  TEST_ASSERT_EQUAL_STRING("a/b/ph", t.get(MqttTopicId::PhState));
+}
+
+void test_build_max_length_base_fits_arena(void) {
+  char base[kMqttMaxBaseLen + 1];
+  memset(base, 'x', kMqttMaxBaseLen);
+  base[kMqttMaxBaseLen] = '\0';
+  MqttTopicTable t;
+  TEST_ASSERT_EQUAL(MqttTopicBuildResult::Rebuilt, t.build(base));
+  assertAllTopicsUnder(t, base);
+  // Dernier topic : se termine exactement dans l'arène.
+  const char* last = t.get(static_cast<MqttTopicId>(kMqttTopicCount - 1));
+  TEST_ASSERT_TRUE(last + strlen(last) + 1 <= t.base() + MqttTopicTable::kArenaSize);
+}
+
+void test_build_too_long_base_is_truncated_not_replaced(void) {
+  char base[kMqttMaxBaseLen + 2];
+  memset(base, 'y', kMqttMaxBaseLen + 1);
+  base[kMqttMaxBaseLen + 1] = '\0';
+  MqttTopicTable t;
+  t.build("autre");
+  TEST_ASSERT_EQUAL(MqttTopicBuildResult::TooLong, t.build(base));
+  // Même troncature que le chargement config : jamais la base par défaut.
+  base[kMqttMaxBaseLen] = '\0';
+  TEST_ASSERT_EQUAL_STRING(base, t.base());
+  assertAllTopicsUnder(t, base);
+  // Toujours signalé, même si l'arène est déjà sur la base tronquée.
+  base[kMqttMaxBaseLen] = 'y';
+  TEST_ASSERT_EQUAL(MqttTopicBuildResult::TooLong, t.build(base));
+}
+
+void test_normalize_base_shared_with_config(void) {
+  const char* start = nullptr;
+  TEST_ASSERT_EQUAL_UINT32(3, mqttTopicNormalizeBase("  a/b//  ", &start));
+  TEST_ASSERT_EQUAL_INT(0, strncmp(start, "a/b", 3));
+  TEST_ASSERT_EQUAL_UINT32(strlen(kMqttDefaultBase), mqttTopicNormalizeBase(" / ", &start));
+  TEST_ASSERT_EQUAL_STRING(kMqttDefaultBase, start);
+  TEST_ASSERT_EQUAL_UINT32(strlen(kMqttDefaultBase), mqttTopicNormalizeBase(nullptr, &start));
+  // Longueur non bornée : la validation /save-config compare à kMqttMaxBaseLen.
+  char base[kMqttMaxBaseLen + 6];
+  memset(base, 'z', sizeof(base) - 1);
+  base[sizeof(base) - 1] = '\0';
+  TEST_ASSERT_EQUAL_UINT32(kMqttMaxBaseLen + 5, mqttTopicNormalizeBase(base, &start));
+}
+
+// -----------------------------------------------------------------------------
+// Dispatch des commandes
+// -----------------------------------------------------------------------------
+void test_match_every_command_topic(void) {
+  MqttTopicTable t;
+  t.build("maison/piscine");
+  size_t commands = 0;
+  for (size_t i = 0; i < kMqttTopicCount; ++i) {
+    MqttTopicId id = static_cast<MqttTopicId>(i);
+    if (mqttTopicKind(id) != MqttTopicKind::Command) continue;
+    ++commands;
+    TEST_ASSERT_EQUAL(id, t.matchCommand(t.get(id)));
+  }
+  TEST_ASSERT_EQUAL_UINT32(18, commands);
+}
+
+void test_match_rejects_state_topics(void) {
+  MqttTopicTable t;
+  for (size_t i = 0; i < kMqttTopicCount; ++i) {
+    MqttTopicId id = static_cast<MqttTopicId>(i);
+    if (mqttTopicKind(id) != MqttTopicKind::State) continue;
+    TEST_ASSERT_EQUAL(MqttTopicId::Count, t.matchCommand(t.get(id)));
+  }
+}
+
+void test_match_rejects_other_base_and_bad_prefix(void) {
+  MqttTopicTable t;
+  t.build("pool/sensors");
+  TEST_ASSERT_EQUAL(MqttTopicId::Count, t.matchCommand("pool/other/ph_target/set"));
+  TEST_ASSERT_EQUAL(MqttTopicId::Count, t.matchCommand("pool/sensorsph_target/set"));
+  TEST_ASSERT_EQUAL(MqttTopicId::Count, t.matchCommand("pool/sensors2/ph_target/set"));
+  TEST_ASSERT_EQUAL(MqttTopicId::Count, t.matchCommand("pool/sensors"));
+  TEST_ASSERT_EQUAL(MqttTopicId::Count, t.matchCommand(""));
+  TEST_ASSERT_EQUAL(MqttTopicId::Count, t.matchCommand(nullptr));
+}
+
+void test_match_rejects_unknown_or_partial_suffix(void) {
+  MqttTopicTable t;
+  TEST_ASSERT_EQUAL(MqttTopicId::Count, t.matchCommand("pool/sensors/ph_target/se"));
+  TEST_ASSERT_EQUAL(MqttTopicId::Count, t.matchCommand("pool/sensors/ph_target/set/"));
+  TEST_ASSERT_EQUAL(MqttTopicId::Count, t.matchCommand("pool/sensors/unknown/set"));
+  TEST_ASSERT_EQUAL(MqttTopicId::Count, t.matchCommand("pool/sensors/"));
+}
+
+void test_match_follows_rebuilt_base(void) {
+  MqttTopicTable t;
+  TEST_ASSERT_EQUAL(MqttTopicId::BoostCommand, t.matchCommand("pool/sensors/boost/set"));
+  t.build("spa");
+  TEST_ASSERT_EQUAL(MqttTopicId::Count, t.matchCommand("pool/sensors/boost/set"));
+  TEST_ASSERT_EQUAL(MqttTopicId::BoostCommand, t.matchCommand("spa/boost/set"));
+}
+
+void test_suffixes_are_unique(void) {
+  for (size_t i = 0; i < kMqttTopicCount; ++i) {
+    for (size_t j = i + 1; j < kMqttTopicCount; ++j) {
+      TEST_ASSERT_TRUE(strcmp(mqttTopicSuffix(static_cast<MqttTopicId>(i)),
+                              mqttTopicSuffix(static_cast<MqttTopicId>(j))) != 0);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_default_table_uses_default_base);
+  RUN_TEST(test_build_custom_base);
+  RUN_TEST(test_build_trims_spaces_and_trailing_slashes);
+  RUN_TEST(test_build_empty_or_slashes_falls_back_to_default);
+  RUN_TEST(test_build_same_base_is_unchanged_and_keeps_pointers);
+  RUN_TEST(test_build_max_length_base_fits_arena);
+  RUN_TEST(test_build_too_long_base_is_truncated_not_replaced);
+  RUN_TEST(test_normalize_base_shared_with_config);
+
+  RUN_TEST(test_match_every_command_topic);
+  RUN_TEST(test_match_rejects_state_topics);
+  RUN_TEST(test_match_rejects_other_base_and_bad_prefix);
+  RUN_TEST(test_match_rejects_unknown_or_partial_suffix);
+  RUN_TEST(test_match_follows_rebuilt_base);
+  RUN_TEST(test_suffixes_are_unique);
+
+  return UNITY_END();
+}
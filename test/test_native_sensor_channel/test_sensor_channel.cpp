@@ -0,0 +1,252 @@
+// =============================================================================
+// Tests unitaires natifs — sensor_channel (voie de mesure générique + table)
+// =============================================================================
+// Tournent sur PC (env:native, Unity), HORS matériel ESP32.
+// On teste :
+//   - bilan d'une lecture : cache, filtre alimenté, stabilité, fail-streak
+//   - bus dégradé : seuil signalé une fois, lecture et points invalidés,
+//     front "dégradé" unique par série, réarmé au retour du bus
+//   - fenêtre stale : valueAt() NaN, front unique, réarmé par une lecture
+//   - fronts du détecteur figé, âge de la dernière lecture
+//   - table : ajout, capacité, clé en double, recherche, masque des modules
+// Le pilote est un faux (aucun I²C) : la voie ne l'appelle jamais elle-même.
+// =============================================================================
+
+#include <unity.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include "constants.h"
+#include "sensor_channel.h"
+
+namespace {
+
+class FakeDriver : public SensorDriver {
+public:
+  FakeDriver(I2cDevice dev, const char* name) : _dev(dev), _name(name) {}
+  bool startRead() override { return true; }
+  bool collectReading(float& out) override {
+    out = 7.0f;
+    return true;
+  }
+  bool startCalPointsQuery() override { return true; }
+  int collectCalPoints() override { return 2; }
+  bool identify(char* buf, size_t len) override {
+    strncpy(buf, "?I,pH,2.16", len);
+    return true;
+  }
+  int queryCalPoints() override { return 2; }
+  I2cDevice device() const override { return _dev; }
+  const char* name() const override { return _name; }
+
+private:
+  I2cDevice _dev;
+  const char* _name;
+};
+
+SensorFilterConfig phFilterConfig() {
+  return SensorFilterConfig{
+      kPhFilterMin, kPhFilterMax, kPhFilterMaxStep, kPhEmaAlpha,
+      kPhFilterMedianWindow, kSensorFilterWarmupSamples,
+      kSensorFilterMaxConsecutiveRejects, kSensorFilterMaxAgeMs,
+      kSensorFrozenSamples, kSensorFrozenEpsilonPh,
+      SensorEstimatorConfig{SensorEstimator::Ema, kPhKalmanAccelStd, kPhKalmanMeasStd,
+                            kSensorKalmanDoseGain, (uint32_t)kPhMixingDelayMs}};
+}
+
+const SensorChannelInfo kPhInfo{"ph", "pH", "", 3, kSensorHealthNoiseLimitPh,
+                                kEzoCalStableBandPh, true};
+const SensorChannelInfo kOrpInfo{"orp", "ORP", "mV", 0, kSensorHealthNoiseLimitOrp,
+                                 kEzoCalStableBandOrp, true};
+
+}  // namespace
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_apply_ok_updates_cache_filter_and_stability(void) {
+  FakeDriver drv(I2cDevice::EzoPh, "EZO pH");
+  WindowedSensorFilter<kPhFilterMedianWindow> filter(phFilterConfig());
+  SensorChannel ch(kPhInfo, drv, filter);
+
+  TEST_ASSERT_TRUE(isnan(ch.last()));
+  TEST_ASSERT_EQUAL_INT(-1, ch.calPoints());
+  const SensorChannelUpdate up = ch.apply(true, 7.20f, 1000);
+  TEST_ASSERT_FALSE(up.failThreshold);
+  TEST_ASSERT_FALSE(up.degraded);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 7.20f, ch.last());
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 7.20f, ch.valueAt(1000));
+  TEST_ASSERT_TRUE(ch.lastAccepted());
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 7.20f, filter.raw());
+  TEST_ASSERT_EQUAL_UINT32(1, ch.stability().run());
+  TEST_ASSERT_EQUAL_INT(0, ch.failStreak());
+}
+
+void test_apply_rejected_sample_keeps_cache(void) {
+  FakeDriver drv(I2cDevice::EzoPh, "EZO pH");
+  WindowedSensorFilter<kPhFilterMedianWindow> filter(phFilterConfig());
+  SensorChannel ch(kPhInfo, drv, filter);
+
+  ch.apply(true, 7.20f, 1000);
+  // Hors plage filtre : rejetée par le filtre, mais la lecture brute reste
+  // la dernière valeur valide du module (getPh() brut, rétrocompat).
+  ch.apply(true, kPhFilterMax + 1.0f, 6000);
+  TEST_ASSERT_FALSE(ch.lastAccepted());
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, kPhFilterMax + 1.0f, ch.last());
+  TEST_ASSERT_EQUAL_INT(0, ch.failStreak());
+}
+
+void test_fail_streak_threshold_and_invalidation(void) {
+  FakeDriver drv(I2cDevice::EzoPh, "EZO pH");
+  WindowedSensorFilter<kPhFilterMedianWindow> filter(phFilterConfig());
+  SensorChannel ch(kPhInfo, drv, filter);
+
+  ch.apply(true, 7.20f, 1000);
+  ch.setCalPoints(2);
+  uint32_t t = 1000;
+  int thresholds = 0;
+  int degraded = 0;
+  for (int i = 1; i < kEzoBusFailMaxConsecutive; ++i) {
+    const SensorChannelUpdate up = ch.apply(false, NAN, t += 5000);
+    thresholds += up.failThreshold;
+    degraded += up.degraded;
+    TEST_ASSERT_FALSE(ch.lastAccepted());
+  }
+  // Sous le seuil : la dernière lecture reste servie (fenêtre stale mise à part).
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 7.20f, ch.last());
+  TEST_ASSERT_EQUAL_INT(2, ch.calPoints());
+  TEST_ASSERT_EQUAL_UINT32(0, ch.stability().run());
+
+  for (int i = 0; i < 5; ++i) {
+    const SensorChannelUpdate up = ch.apply(false, NAN, t += 5000);
+    thresholds += up.failThreshold;
+    degraded += up.degraded;
+  }
+  TEST_ASSERT_EQUAL_INT(1, thresholds);
+  TEST_ASSERT_EQUAL_INT(1, degraded);
+  TEST_ASSERT_EQUAL_INT(kEzoBusFailMaxConsecutive + 4, ch.failStreak());
+  TEST_ASSERT_TRUE(isnan(ch.last()));
+  TEST_ASSERT_TRUE(isnan(ch.valueAt(t)));
+  TEST_ASSERT_EQUAL_INT(-1, ch.calPoints());
+}
+
+void test_degraded_rearmed_after_recovery(void) {
+  FakeDriver drv(I2cDevice::EzoOrp, "EZO ORP");
+  WindowedSensorFilter<kPhFilterMedianWindow> filter(phFilterConfig());
+  SensorChannel ch(kOrpInfo, drv, filter);
+
+  uint32_t t = 0;
+  int degraded = 0;
+  for (int i = 0; i < kEzoBusFailMaxConsecutive; ++i) degraded += ch.apply(false, NAN, t += 5000).degraded;
+  TEST_ASSERT_EQUAL_INT(1, degraded);
+  ch.apply(true, 7.0f, t += 5000);
+  TEST_ASSERT_EQUAL_INT(0, ch.failStreak());
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 7.0f, ch.valueAt(t));
+  for (int i = 0; i < kEzoBusFailMaxConsecutive; ++i) degraded += ch.apply(false, NAN, t += 5000).degraded;
+  TEST_ASSERT_EQUAL_INT(2, degraded);
+}
+
+void test_stale_window_and_edge(void) {
+  FakeDriver drv(I2cDevice::EzoPh, "EZO pH");
+  WindowedSensorFilter<kPhFilterMedianWindow> filter(phFilterConfig());
+  SensorChannel ch(kPhInfo, drv, filter);
+
+  TEST_ASSERT_FALSE(ch.staleEdge(100000));  // Jamais lue : rien à signaler
+  ch.apply(true, 7.10f, 1000);
+  const uint32_t limit = 1000 + kSensorStaleTimeoutMs;
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 7.10f, ch.valueAt(limit));
+  TEST_ASSERT_FALSE(ch.staleEdge(limit));
+  TEST_ASSERT_TRUE(isnan(ch.valueAt(limit + 1)));
+  TEST_ASSERT_TRUE(ch.staleEdge(limit + 1));
+  TEST_ASSERT_FALSE(ch.staleEdge(limit + 5000));  // Une seule fois
+  // Lecture valide suivante : réarmé.
+  ch.apply(true, 7.11f, limit + 6000);
+  TEST_ASSERT_FALSE(ch.staleEdge(limit + 6000));
+  TEST_ASSERT_TRUE(ch.staleEdge(limit + 7000 + kSensorStaleTimeoutMs));
+}
+
+void test_age_ms(void) {
+  FakeDriver drv(I2cDevice::EzoPh, "EZO pH");
+  WindowedSensorFilter<kPhFilterMedianWindow> filter(phFilterConfig());
+  SensorChannel ch(kPhInfo, drv, filter);
+
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, ch.ageMs(5000));
+  ch.apply(true, 7.0f, 5000);
+  TEST_ASSERT_EQUAL_UINT32(1500, ch.ageMs(6500));
+  // Échec : l'âge continue de courir depuis la dernière lecture valide.
+  ch.apply(false, NAN, 10000);
+  TEST_ASSERT_EQUAL_UINT32(7000, ch.ageMs(12000));
+}
+
+void test_frozen_edges(void) {
+  FakeDriver drv(I2cDevice::EzoPh, "EZO pH");
+  WindowedSensorFilter<kPhFilterMedianWindow> filter(phFilterConfig());
+  SensorChannel ch(kPhInfo, drv, filter);
+
+  TEST_ASSERT_TRUE(SensorChannelEdge::None == ch.frozenEdge());
+  uint32_t t = 0;
+  for (uint16_t i = 0; i < kSensorFrozenSamples; ++i) ch.apply(true, 7.0f, t += 5000);
+  TEST_ASSERT_TRUE(filter.frozen());
+  TEST_ASSERT_TRUE(SensorChannelEdge::Raised == ch.frozenEdge());
+  TEST_ASSERT_TRUE(SensorChannelEdge::None == ch.frozenEdge());
+  filter.reset();
+  TEST_ASSERT_TRUE(SensorChannelEdge::Cleared == ch.frozenEdge());
+  TEST_ASSERT_TRUE(SensorChannelEdge::None == ch.frozenEdge());
+}
+
+void test_table_add_capacity_duplicate(void) {
+  FakeDriver ph(I2cDevice::EzoPh, "EZO pH");
+  FakeDriver orp(I2cDevice::EzoOrp, "EZO ORP");
+  WindowedSensorFilter<kPhFilterMedianWindow> f1(phFilterConfig());
+  WindowedSensorFilter<kPhFilterMedianWindow> f2(phFilterConfig());
+  WindowedSensorFilter<kPhFilterMedianWindow> f3(phFilterConfig());
+  SensorChannel a(kPhInfo, ph, f1);
+  SensorChannel b(kOrpInfo, orp, f2);
+  SensorChannel dup(kPhInfo, ph, f3);
+
+  SensorChannelTable<2> table;
+  TEST_ASSERT_EQUAL_UINT32(2, table.capacity());
+  TEST_ASSERT_EQUAL_UINT32(0, table.size());
+  TEST_ASSERT_TRUE(table.add(a));
+  TEST_ASSERT_FALSE(table.add(dup));  // Clé "ph" déjà prise
+  TEST_ASSERT_TRUE(table.add(b));
+  TEST_ASSERT_FALSE(table.add(dup));  // Pleine
+  TEST_ASSERT_EQUAL_UINT32(2, table.size());
+  TEST_ASSERT_TRUE(&table[0] == &a);
+  TEST_ASSERT_TRUE(&table[1] == &b);
+}
+
+void test_table_find_and_devices(void) {
+  FakeDriver ph(I2cDevice::EzoPh, "EZO pH");
+  FakeDriver orp(I2cDevice::EzoOrp, "EZO ORP");
+  WindowedSensorFilter<kPhFilterMedianWindow> f1(phFilterConfig());
+  WindowedSensorFilter<kPhFilterMedianWindow> f2(phFilterConfig());
+  SensorChannel a(kPhInfo, ph, f1);
+  SensorChannel b(kOrpInfo, orp, f2);
+
+  SensorChannelTable<kSensorChannelCapacity> table;
+  TEST_ASSERT_EQUAL_UINT8(0, table.devices());
+  table.add(a);
+  table.add(b);
+  TEST_ASSERT_TRUE(table.find("orp") == &b);
+  TEST_ASSERT_TRUE(table.find("ph") == &a);
+  TEST_ASSERT_NULL(table.find("ec"));
+  TEST_ASSERT_NULL(table.find(nullptr));
+  TEST_ASSERT_EQUAL_UINT8(i2cDeviceBit(I2cDevice::EzoPh) | i2cDeviceBit(I2cDevice::EzoOrp),
+                          table.devices());
+  TEST_ASSERT_EQUAL_STRING("EZO ORP", table[1].driver().name());
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_apply_ok_updates_cache_filter_and_stability);
+  RUN_TEST(test_apply_rejected_sample_keeps_cache);
+  RUN_TEST(test_fail_streak_threshold_and_invalidation);
+  RUN_TEST(test_degraded_rearmed_after_recovery);
+  RUN_TEST(test_stale_window_and_edge);
+  RUN_TEST(test_age_ms);
+  RUN_TEST(test_frozen_edges);
+  RUN_TEST(test_table_add_capacity_duplicate);
+  RUN_TEST(test_table_find_and_devices);
+  return UNITY_END();
+}
@@ -0,0 +1,190 @@
+// =============================================================================
+// Tests unitaires natifs — sensor_estimator (Kalman niveau + tendance)
+// =============================================================================
+// Tournent sur PC (env:native, Unity), HORS matériel ESP32.
+// On teste :
+//   - amorçage, convergence sur constante, tendance sur rampe
+//   - comparaison à l'EMA du firmware : bruit de sortie équivalent, retard
+//     sur rampe nettement plus court (réglage λ ≈ 0,003)
+//   - couplage dose : suivi plus rapide pendant la fenêtre, expiration
+//   - intégration SensorFilter : config courte = EMA, reset, stabilité numérique
+// =============================================================================
+
+#include <unity.h>
+#include <math.h>
+#include <stdint.h>
+#include "constants.h"
+#include "sensor_estimator.h"
+#include "sensor_filter.h"
+#include "test_noise.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static const uint32_t kT = 5000;  // Cadence capteurs pH/ORP
+
+static SensorEstimatorConfig phKalman() {
+  return SensorEstimatorConfig{SensorEstimator::Kalman, kPhKalmanAccelStd, kPhKalmanMeasStd,
+                               kSensorKalmanDoseGain, 900000UL};
+}
+
+static SensorFilterConfig phFilterConfig(SensorEstimator mode) {
+  return SensorFilterConfig{
+      kPhFilterMin, kPhFilterMax, kPhFilterMaxStep, kPhEmaAlpha,
+      kPhFilterMedianWindow, kSensorFilterWarmupSamples,
+      kSensorFilterMaxConsecutiveRejects, kSensorFilterMaxAgeMs,
+      0, 0.0f,  // détection figé hors sujet ici
+      SensorEstimatorConfig{mode, kPhKalmanAccelStd, kPhKalmanMeasStd,
+                            kSensorKalmanDoseGain, 900000UL}};
+}
+
+void test_primes_on_first_sample(void) {
+  KalmanTrend k(phKalman());
+  TEST_ASSERT_FALSE(k.primed());
+  TEST_ASSERT_TRUE(isnan(k.level()));
+  TEST_ASSERT_TRUE(isnan(k.trendPerMin()));
+  TEST_ASSERT_EQUAL_FLOAT(7.4f, k.update(7.4f, 1000));
+  TEST_ASSERT_TRUE(k.primed());
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, k.trendPerMin());
+}
+
+void test_constant_input_converges(void) {
+  KalmanTrend k(phKalman());
+  for (uint32_t i = 0; i < 500; ++i) k.update(7.30f + noise(i, 0.005f), i * kT);
+  TEST_ASSERT_FLOAT_WITHIN(0.003f, 7.30f, k.level());
+  TEST_ASSERT_FLOAT_WITHIN(0.002f, 0.0f, k.trendPerMin());
+}
+
+void test_ramp_trend_estimated(void) {
+  // pH qui baisse de 0,02/min (retour après dose de pH-).
+  KalmanTrend k(phKalman());
+  const float slopePerMin = -0.02f;
+  for (uint32_t i = 0; i < 400; ++i) {
+    const float t = i * kT / 60000.0f;
+    k.update(7.6f + slopePerMin * t, i * kT);
+  }
+  TEST_ASSERT_FLOAT_WITHIN(0.002f, slopePerMin, k.trendPerMin());
+}
+
+// Même bruit en entrée : écart-type de sortie de l'étage Kalman comparable à
+// celui de l'EMA (réglage à λ ≈ 0,003), sur une mesure stable.
+void test_noise_comparable_to_ema(void) {
+  SensorFilter ema(phFilterConfig(SensorEstimator::Ema));
+  SensorFilter kal(phFilterConfig(SensorEstimator::Kalman));
+  double sumE = 0, sumE2 = 0, sumK = 0, sumK2 = 0;
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < 3000; ++i) {
+    const float x = 7.30f + noise(i, 0.02f);
+    ema.addSample(x, i * kT);
+    kal.addSample(x, i * kT);
+    if (i < 500) continue;  // régime établi
+    sumE += ema.filtered(); sumE2 += (double)ema.filtered() * ema.filtered();
+    sumK += kal.filtered(); sumK2 += (double)kal.filtered() * kal.filtered();
+    ++n;
+  }
+  const double sdE = sqrt(sumE2 / n - (sumE / n) * (sumE / n));
+  const double sdK = sqrt(sumK2 / n - (sumK / n) * (sumK / n));
+  TEST_ASSERT_TRUE(sdK < 1.4 * sdE);
+}
+
+// Rampe : l'EMA traîne d'environ slope·(1-α)/α·T, le Kalman rattrape la rampe.
+void test_ramp_lag_shorter_than_ema(void) {
+  SensorFilter ema(phFilterConfig(SensorEstimator::Ema));
+  SensorFilter kal(phFilterConfig(SensorEstimator::Kalman));
+  const float slopePerSample = -0.002f;  // 0,024 pH/min
+  float x = 7.6f;
+  for (uint32_t i = 0; i < 30; ++i) {    // amorçage à plat
+    ema.addSample(x, i * kT);
+    kal.addSample(x, i * kT);
+  }
+  for (uint32_t i = 30; i < 330; ++i) {
+    x += slopePerSample;
+    ema.addSample(x, i * kT);
+    kal.addSample(x, i * kT);
+  }
+  const float lagEma = fabsf(ema.filtered() - x);
+  const float lagKal = fabsf(kal.filtered() - x);
+  TEST_ASSERT_TRUE(lagEma > 0.015f);          // ≈ médiane (3 pas) + EMA (9 pas)
+  TEST_ASSERT_TRUE(lagKal < 0.5f * lagEma);
+  TEST_ASSERT_TRUE(kal.trendPerMin() < -0.015f);
+}
+
+void test_dose_boost_tracks_faster(void) {
+  // Marche de -0,1 pH : avec dose signalée, l'écart résiduel après 12 pas
+  // (1 min) est plus faible.
+  KalmanTrend plain(phKalman()), dosed(phKalman());
+  for (uint32_t i = 0; i < 200; ++i) {
+    plain.update(7.5f, i * kT);
+    dosed.update(7.5f, i * kT);
+  }
+  dosed.noteDose(199 * kT);
+  TEST_ASSERT_TRUE(dosed.boosted(200 * kT));
+  for (uint32_t i = 200; i < 212; ++i) {
+    plain.update(7.4f, i * kT);
+    dosed.update(7.4f, i * kT);
+  }
+  TEST_ASSERT_TRUE(fabsf(dosed.level() - 7.4f) < fabsf(plain.level() - 7.4f));
+}
+
+void test_dose_boost_expires_across_wrap(void) {
+  SensorEstimatorConfig c = phKalman();
+  c.doseBoostMs = 10000;
+  KalmanTrend k(c);
+  const uint32_t t0 = 0xFFFFF000u;  // wrap millis() pendant la fenêtre
+  k.noteDose(t0);
+  TEST_ASSERT_TRUE(k.boosted(t0 + 5000));
+  TEST_ASSERT_FALSE(k.boosted(t0 + 10000));
+  k.reset();
+  TEST_ASSERT_FALSE(k.boosted(t0 + 1));
+}
+
+void test_short_config_defaults_to_ema(void) {
+  // Init agrégat historique (sans étage) : EMA, pas de tendance, noteDose inerte.
+  SensorFilter f(SensorFilterConfig{0.0f, 14.0f, 0.15f, 0.1f, 7, 5, 10, 20000});
+  TEST_ASSERT_TRUE(f.estimator() == SensorEstimator::Ema);
+  for (uint32_t i = 0; i < 10; ++i) f.addSample(7.2f, i * kT);
+  f.noteDose(10 * kT);
+  TEST_ASSERT_TRUE(isnan(f.trendPerMin()));
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 7.2f, f.filtered());
+}
+
+void test_filter_reset_clears_kalman(void) {
+  SensorFilter f(phFilterConfig(SensorEstimator::Kalman));
+  for (uint32_t i = 0; i < 20; ++i) f.addSample(7.2f + 0.001f * i, i * kT);
+  TEST_ASSERT_FALSE(isnan(f.trendPerMin()));
+  f.reset();
+  TEST_ASSERT_TRUE(isnan(f.trendPerMin()));
+  TEST_ASSERT_TRUE(isnan(f.filtered()));
+  f.addSample(7.0f, 100 * kT);
+  TEST_ASSERT_EQUAL_FLOAT(7.0f, f.filtered());
+}
+
+void test_numerically_stable_long_run(void) {
+  // ~6 jours à 5 s avec cadence irrégulière, trous et doses : covariance
+  // finie, niveau borné.
+  KalmanTrend k(phKalman());
+  uint32_t now = 0;
+  for (uint32_t i = 0; i < 100000; ++i) {
+    now += (i % 97 == 0) ? 60000 : kT + (i % 7) * 100;
+    if (i % 720 == 0) k.noteDose(now);
+    const float lvl = k.update(7.3f + 0.05f * sinf(i * 0.001f) + noise(i, 0.01f), now);
+    if (!isfinite(lvl)) TEST_FAIL_MESSAGE("niveau non fini");
+  }
+  TEST_ASSERT_FLOAT_WITHIN(0.06f, 7.3f, k.level());
+  TEST_ASSERT_TRUE(isfinite(k.trendPerMin()));
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_primes_on_first_sample);
+  RUN_TEST(test_constant_input_converges);
+  RUN_TEST(test_ramp_trend_estimated);
+  RUN_TEST(test_noise_comparable_to_ema);
+  RUN_TEST(test_ramp_lag_shorter_than_ema);
+  RUN_TEST(test_dose_boost_tracks_faster);
+  RUN_TEST(test_dose_boost_expires_across_wrap);
+  RUN_TEST(test_short_config_defaults_to_ema);
+  RUN_TEST(test_filter_reset_clears_kalman);
+  RUN_TEST(test_numerically_stable_long_run);
+  return UNITY_END();
+}
@@ -0,0 +1,319 @@
+// =============================================================================
+// Tests unitaires natifs — équivalence de la médiane glissante (SensorFilter)
+// =============================================================================
+// Tournent sur PC (env:native, Unity), HORS matériel Atlas EZO.
+// La fenêtre médiane est maintenue triée incrémentalement (SlidingMedian) au
+// lieu d'être copiée puis triée par insertion à chaque mesure. On vérifie que
+// les sorties sont BIT À BIT identiques à l'implémentation précédente :
+//   - LegacySensorFilter ci-dessous = copie fidèle de l'ancienne logique
+//     (buffer circulaire + tri par insertion, logs retirés) — oracle ;
+//   - traces déterministes type terrain (bruit quantifié EZO, pics, rafales
+//     NaN / hors plage, saut durable → re-sync, boucle EMI → latch) ;
+//   - toutes les fenêtres logiques 1..7 sur SensorFilter (capacité 7) ;
+//   - SlidingMedian seule contre le tri par insertion, fenêtres jusqu'à 11.
+// =============================================================================
+
+#include <unity.h>
+#include <math.h>  // C header uniquement (libc++ <cmath> indisponible sur l'hôte)
+#include <stdio.h>
+#include <string.h>
+#include "sensor_filter.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// -----------------------------------------------------------------------------
+// Oracle : ancienne médiane (copie + tri par insertion) et ancien addSample()
+// -----------------------------------------------------------------------------
+
+static float insertionSortMedian(const float* buf, uint8_t count) {
+  if (count == 0) return NAN;
+  float tmp[16];
+  for (uint8_t i = 0; i < count; ++i) tmp[i] = buf[i];
+  for (uint8_t i = 1; i < count; ++i) {
+    float key = tmp[i];
+    int j = (int)i - 1;
+    while (j >= 0 && tmp[j] > key) {
+      tmp[j + 1] = tmp[j];
+      --j;
+    }
+    tmp[j + 1] = key;
+  }
+  if (count & 1) return tmp[count / 2];
+  return 0.5f * (tmp[count / 2 - 1] + tmp[count / 2]);
+}
+
+class LegacySensorFilter {
+public:
+  explicit LegacySensorFilter(const SensorFilter::Config& cfg)
+      : _cfg(cfg), _frozen(cfg.frozenSamples, cfg.frozenEpsilon) {
+    if (_cfg.medianWindow == 0) _cfg.medianWindow = 1;
+    if (_cfg.medianWindow > kSensorFilterMedianWindow) _cfg.medianWindow = kSensorFilterMedianWindow;
+  }
+
+  bool addSample(float raw, uint32_t nowMs) {
+    _raw = raw;
+    const bool warmingUp = (_validCount < _cfg.warmupSamples);
+    if (isnan(raw) || raw < _cfg.minValue || raw > _cfg.maxValue) {
+      if (_rejectedCount < 255) ++_rejectedCount;
+      if (_consecutiveRejects < 255) ++_consecutiveRejects;
+      return false;
+    }
+    if (!warmingUp && !isnan(_filtered) && fabsf(raw - _filtered) > _cfg.maxStep) {
+      if (_rejectedCount < 255) ++_rejectedCount;
+      if (_consecutiveRejects < 255) ++_consecutiveRejects;
+      _rejBuffer[_rejIdx] = raw;
+      _rejIdx = (_rejIdx + 1) % _cfg.medianWindow;
+      if (_rejCount < _cfg.medianWindow) ++_rejCount;
+      if (_consecutiveRejects >= kSensorFilterResyncRejects) {
+        uint8_t kept = 0;
+        for (uint8_t i = 0; i < _resyncCount; ++i) {
+          if ((uint32_t)(nowMs - _resync[i]) <= kSensorFilterResyncWindowMs) _resync[kept++] = _resync[i];
+        }
+        _resyncCount = kept;
+        if (_resyncCount < kSensorFilterMaxResyncPerWindow) {
+          _resync[_resyncCount++] = nowMs;
+        } else {
+          for (uint8_t i = 1; i < kSensorFilterMaxResyncPerWindow; ++i) _resync[i - 1] = _resync[i];
+          _resync[kSensorFilterMaxResyncPerWindow - 1] = nowMs;
+        }
+        _bufIdx = 0;
+        _bufCount = 0;
+        _filtered = NAN;
+        _validCount = 0;
+        _consecutiveRejects = 0;
+        _rejIdx = 0;
+        _rejCount = 0;
+        if (_resyncCount >= kSensorFilterMaxResyncPerWindow) _latched = true;
+      }
+      return false;
+    }
+    _consecutiveRejects = 0;
+    _frozen.addSample(raw);
+    _buffer[_bufIdx] = raw;
+    _bufIdx = (_bufIdx + 1) % _cfg.medianWindow;
+    if (_bufCount < _cfg.medianWindow) ++_bufCount;
+    const float med = insertionSortMedian(_buffer, _bufCount);
+    if (isnan(_filtered)) {
+      _filtered = med;
+    } else {
+      _filtered = _cfg.emaAlpha * med + (1.0f - _cfg.emaAlpha) * _filtered;
+    }
+    if (_validCount < 255) ++_validCount;
+    _lastValidMs = nowMs;
+    _hasValid = true;
+    return true;
+  }
+
+  float median() const { return insertionSortMedian(_buffer, _bufCount); }
+  float filtered() const { return _filtered; }
+  bool ready(uint32_t nowMs) const {
+    return _validCount >= _cfg.warmupSamples && _hasValid &&
+           (nowMs - _lastValidMs) <= _cfg.maxAgeMs && !_frozen.frozen();
+  }
+  bool unstable() const { return _consecutiveRejects >= _cfg.maxConsecutiveRejects || _latched; }
+  uint8_t consecutiveRejects() const { return _consecutiveRejects; }
+  uint8_t resyncCount() const { return _resyncCount; }
+
+private:
+  SensorFilter::Config _cfg;
+  float _buffer[kSensorFilterMedianWindow];
+  uint8_t _bufIdx = 0, _bufCount = 0;
+  float _rejBuffer[kSensorFilterMedianWindow];
+  uint8_t _rejIdx = 0, _rejCount = 0;
+  float _raw = NAN, _filtered = NAN;
+  uint8_t _validCount = 0, _rejectedCount = 0, _consecutiveRejects = 0;
+  uint32_t _lastValidMs = 0;
+  bool _hasValid = false;
+  uint32_t _resync[kSensorFilterMaxResyncPerWindow] = {};
+  uint8_t _resyncCount = 0;
+  bool _latched = false;
+  FrozenDetector _frozen;
+};
+
+// -----------------------------------------------------------------------------
+// Traces déterministes (LCG) : bruit quantifié à la résolution EZO
+// -----------------------------------------------------------------------------
+
+static uint32_t gSeed = 1;
+static float noise() {  // [-1, 1)
+  gSeed = gSeed * 1664525u + 1013904223u;
+  return (float)(gSeed >> 8) / 8388608.0f - 1.0f;
+}
+static float quantize(float v, float lsb) { return roundf(v / lsb) * lsb; }
+
+static const int kTraceLen = 600;
+
+// pH : dérive lente, bruit ±0.01, pics isolés, rafales NaN / hors plage,
+// sonde en solution 4.0 pendant 20 lectures (re-sync), plateaux identiques.
+static void buildPhTrace(float* out) {
+  gSeed = 0x5eed0001u;
+  for (int i = 0; i < kTraceLen; ++i) {
+    float v = 7.20f + 0.0005f * (float)i + 0.01f * noise();
+    if (i % 37 == 11) v += 0.6f;                       // pic isolé
+    if (i >= 120 && i < 140) v = 4.00f + 0.002f * noise();  // saut durable
+    if (i >= 200 && i < 215) v = 7.35f;                // plateau (doublons)
+    v = quantize(v, 0.001f);
+    if (i % 53 == 7) v = NAN;                          // lecture ratée
+    if (i == 300 || i == 301) v = 15.2f;               // hors plage
+    out[i] = v;
+  }
+}
+
+// ORP : bruit ±3 mV quantifié 0.1, pics 250 mV, trois sauts durables
+// rapprochés (boucle de re-sync → latch).
+static void buildOrpTrace(float* out) {
+  gSeed = 0x5eed0002u;
+  for (int i = 0; i < kTraceLen; ++i) {
+    float v = 650.0f + 3.0f * noise();
+    if (i % 41 == 5) v += 250.0f;
+    if ((i >= 100 && i < 115) || (i >= 160 && i < 175) || (i >= 220 && i < 235)) {
+      v = ((i / 60) & 1) ? 420.0f + noise() : 880.0f + noise();
+    }
+    v = quantize(v, 0.1f);
+    if (i % 97 == 3) v = NAN;
+    out[i] = v;
+  }
+}
+
+static uint32_t bits(float f) {
+  uint32_t u;
+  memcpy(&u, &f, sizeof u);
+  return u;
+}
+
+static void assertSameBits(float expected, float actual, int step) {
+  char msg[48];
+  snprintf(msg, sizeof msg, "echantillon %d", step);
+  if (isnan(expected)) {
+    TEST_ASSERT_TRUE_MESSAGE(isnan(actual), msg);
+  } else {
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(bits(expected), bits(actual), msg);
+  }
+}
+
+// Rejoue la trace sur l'oracle et sur SensorFilter pour chaque fenêtre.
+// Retourne le nombre de fenêtres ayant fini latchées (la trace doit bien
+// exercer les chemins re-sync / latch, sinon l'équivalence serait partielle).
+static int replayAndCompare(const float* trace, SensorFilter::Config cfg, uint32_t periodMs,
+                            uint8_t* maxResync) {
+  int latched = 0;
+  *maxResync = 0;
+  for (uint8_t w = 1; w <= kSensorFilterMedianWindow; ++w) {
+    cfg.medianWindow = w;
+    LegacySensorFilter ref(cfg);
+    SensorFilter f(cfg);
+    uint32_t t = 0;
+    for (int i = 0; i < kTraceLen; ++i) {
+      TEST_ASSERT_EQUAL(ref.addSample(trace[i], t), f.addSample(trace[i], t));
+      assertSameBits(ref.median(), f.median(), i);
+      assertSameBits(ref.filtered(), f.filtered(), i);
+      TEST_ASSERT_EQUAL(ref.ready(t), f.ready(t));
+      TEST_ASSERT_EQUAL(ref.unstable(), f.unstable());
+      TEST_ASSERT_EQUAL_UINT8(ref.consecutiveRejects(), f.consecutiveRejects());
+      TEST_ASSERT_EQUAL_UINT8(ref.resyncCount(), f.resyncCount());
+      if (f.resyncCount() > *maxResync) *maxResync = f.resyncCount();
+      t += periodMs;
+    }
+    if (f.unstableLatched()) ++latched;
+  }
+  return latched;
+}
+
+// --- Trace pH : toutes fenêtres 1..7, sorties identiques bit à bit ----------
+void test_ph_trace_bit_identical_all_windows(void) {
+  float trace[kTraceLen];
+  buildPhTrace(trace);
+  uint8_t maxResync = 0;
+  replayAndCompare(trace,
+                   SensorFilter::Config{0.0f, 14.0f, 0.15f, 0.10f, 7, 5, 10, 20000,
+                                        kSensorFrozenSamples, kSensorFrozenEpsilonPh},
+                   5000, &maxResync);
+  TEST_ASSERT_TRUE(maxResync >= 1);
+}
+
+// --- Trace ORP : re-sync en boucle → latch, sorties identiques --------------
+void test_orp_trace_bit_identical_all_windows(void) {
+  float trace[kTraceLen];
+  buildOrpTrace(trace);
+  uint8_t maxResync = 0;
+  const int latched = replayAndCompare(
+      trace,
+      SensorFilter::Config{-1000.0f, 1500.0f, 50.0f, 0.08f, 7, 5, 10, 20000,
+                           kSensorFrozenSamples, kSensorFrozenEpsilonOrp},
+      2000, &maxResync);
+  TEST_ASSERT_EQUAL_UINT8(kSensorFilterMaxResyncPerWindow, maxResync);
+  TEST_ASSERT_EQUAL_INT(kSensorFilterMedianWindow, latched);
+}
+
+// --- SlidingMedian seule : fenêtres > 7 (capacité libre), forts doublons ---
+void test_sliding_median_matches_insertion_sort(void) {
+  float ring[11], sorted[11];
+  SlidingMedian m(ring, sorted, 11);
+  for (uint8_t w = 1; w <= 11; ++w) {
+    m.setWindow(w);
+    float last[11];
+    uint8_t idx = 0, count = 0;
+    gSeed = 0xabcd0000u + w;
+    for (int i = 0; i < 400; ++i) {
+      // Résolution grossière → beaucoup de valeurs égales (retrait d'un doublon).
+      const float v = quantize(7.0f + 0.02f * noise(), 0.005f);
+      m.push(v);
+      last[idx] = v;
+      idx = (uint8_t)((idx + 1) % w);
+      if (count < w) ++count;
+      TEST_ASSERT_EQUAL_UINT8(count, m.count());
+      assertSameBits(insertionSortMedian(last, count), m.median(), i);
+    }
+  }
+}
+
+// --- Capacité par template : fenêtre pH ≠ fenêtre ORP -----------------------
+void test_template_capacity_bounds_window(void) {
+  SensorFilter::Config cfg{0.0f, 14.0f, 0.15f, 0.10f, 99, 5, 10, 20000};
+  WindowedSensorFilter<5> five(cfg);
+  WindowedSensorFilter<11> eleven(cfg);
+  TEST_ASSERT_EQUAL_UINT8(5, five.medianWindow());
+  TEST_ASSERT_EQUAL_UINT8(11, eleven.medianWindow());
+  TEST_ASSERT_EQUAL_UINT8(7, SensorFilter(cfg).medianWindow());
+
+  // Même séquence, médianes différentes : fenêtre 5 = {7.00 ×3, 7.10 ×2},
+  // fenêtre 11 = {7.10 ×8, 7.00 ×3}.
+  uint32_t t = 0;
+  const float seq[] = {7.10f, 7.10f, 7.10f, 7.10f, 7.10f, 7.10f,
+                       7.00f, 7.00f, 7.00f, 7.10f, 7.10f};
+  for (float v : seq) {
+    five.addSample(v, t);
+    eleven.addSample(v, t);
+    t += 1000;
+  }
+  TEST_ASSERT_EQUAL_FLOAT(7.00f, five.median());
+  TEST_ASSERT_EQUAL_FLOAT(7.10f, eleven.median());
+  for (int i = 0; i < 3; ++i) {
+    five.addSample(7.00f, t);
+    eleven.addSample(7.00f, t);
+    t += 1000;
+  }
+  TEST_ASSERT_EQUAL_FLOAT(7.00f, five.median());   // {7.00 ×5}
+  TEST_ASSERT_EQUAL_FLOAT(7.00f, eleven.median()); // {7.10 ×5, 7.00 ×6}
+}
+
+// --- reset() vide la fenêtre triée (pas de valeur résiduelle) ---------------
+void test_reset_clears_sorted_window(void) {
+  SensorFilter f(SensorFilter::Config{0.0f, 14.0f, 0.15f, 0.10f, 7, 5, 10, 20000});
+  for (int i = 0; i < 7; ++i) f.addSample(8.00f, (uint32_t)i * 1000);
+  f.reset();
+  TEST_ASSERT_TRUE(isnan(f.median()));
+  f.addSample(6.50f, 10000);
+  TEST_ASSERT_EQUAL_FLOAT(6.50f, f.median());
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_ph_trace_bit_identical_all_windows);
+  RUN_TEST(test_orp_trace_bit_identical_all_windows);
+  RUN_TEST(test_sliding_median_matches_insertion_sort);
+  RUN_TEST(test_template_capacity_bounds_window);
+  RUN_TEST(test_reset_clears_sorted_window);
+  return UNITY_END();
+}
@@ -0,0 +1,178 @@
+// =============================================================================
+// Tests unitaires natifs — sensor_health_logic (santé voie pH / ORP)
+// =============================================================================
+// Tournent sur PC (env:native, Unity), HORS matériel ESP32.
+// On teste :
+//   - bruit : σ retrouvé sur bruit blanc, rampe lente quasi invisible, NaN
+//     avant 2 acceptées, lectures rejetées ignorées
+//   - taux de pics et d'échecs I²C, amorçage et oubli exponentiel
+//   - percentiles de latence par classes, oubli, cycle non démarré
+//   - score : voie saine 100, dégradations progressives, voie muette 0, reset
+// =============================================================================
+
+#include <unity.h>
+#include <math.h>
+#include <stdint.h>
+#include "constants.h"
+#include "sensor_health_logic.h"
+#include "test_noise.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static const uint32_t kT = 5000;
+
+static SensorHealthConfig phConfig() {
+  return SensorHealthConfig{kSensorHealthWindowSamples, kSensorHealthNoiseLimitPh,
+                            kSensorHealthSpikeRateLimit, kSensorHealthFailRateLimit,
+                            kSensorHealthLatencyLimitMs, kSensorFilterMaxAgeMs};
+}
+
+void test_noise_nan_until_two_accepted(void) {
+  SensorHealth h(phConfig());
+  TEST_ASSERT_TRUE(isnan(h.noiseStd()));
+  h.onRead(true, true, 7.2f, 900, 0);
+  TEST_ASSERT_TRUE(isnan(h.noiseStd()));
+  h.onRead(true, true, 7.2f, 900, kT);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, h.noiseStd());
+}
+
+void test_noise_matches_white_noise_std(void) {
+  SensorHealth h(phConfig());
+  for (uint32_t i = 0; i < 2000; ++i) h.onRead(true, true, 7.3f + noise(i, 0.01f), 900, i * kT);
+  const float sigma = 0.01f / sqrtf(3.0f);
+  TEST_ASSERT_FLOAT_WITHIN(0.25f * sigma, sigma, h.noiseStd());
+}
+
+void test_slow_ramp_not_counted_as_noise(void) {
+  // Dérive de 0,05 pH/h : différence de 7e-5 par lecture.
+  SensorHealth h(phConfig());
+  for (uint32_t i = 0; i < 1000; ++i) h.onRead(true, true, 7.0f + i * 7e-5f, 900, i * kT);
+  TEST_ASSERT_TRUE(h.noiseStd() < 1e-4f);
+}
+
+void test_rejected_reads_do_not_feed_noise(void) {
+  SensorHealth h(phConfig());
+  for (uint32_t i = 0; i < 50; ++i) {
+    h.onRead(true, true, 7.2f, 900, i * kT);
+    h.onRead(true, false, 9.0f, 900, i * kT + 1);  // pic rejeté par le filtre
+  }
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, h.noiseStd());
+  TEST_ASSERT_FLOAT_WITHIN(0.02f, 0.5f, h.spikeRate());
+  TEST_ASSERT_EQUAL_UINT32(50, h.acceptedCount());
+}
+
+void test_fail_rate_primes_then_forgets(void) {
+  SensorHealth h(phConfig());
+  for (uint32_t i = 0; i < 10; ++i) h.onRead(i % 2 == 0, true, 7.2f, 900, i * kT);
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.5f, h.failRate());  // Moyenne exacte à l'amorçage
+  for (uint32_t i = 10; i < 1000; ++i) h.onRead(true, true, 7.2f, 900, i * kT);
+  TEST_ASSERT_TRUE(h.failRate() < 0.001f);
+  // Les échecs ne comptent pas dans les pics (dénominateur = lectures valides).
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, h.spikeRate());
+}
+
+void test_latency_percentiles_by_bucket(void) {
+  SensorHealth h(phConfig());
+  TEST_ASSERT_EQUAL_UINT32(0, h.latencyPercentileMs(50));
+  for (uint32_t i = 0; i < 90; ++i) h.onRead(true, true, 7.2f, 950, i * kT);
+  for (uint32_t i = 90; i < 100; ++i) h.onRead(true, true, 7.2f, 2600, i * kT);
+  TEST_ASSERT_EQUAL_UINT32(1000, h.latencyPercentileMs(50));  // Borne de la classe
+  TEST_ASSERT_EQUAL_UINT32(1000, h.latencyPercentileMs(90));
+  TEST_ASSERT_EQUAL_UINT32(2600, h.latencyPercentileMs(95));  // Borne 3000 > plus grande vue
+  h.onRead(true, true, 7.2f, 42000, 100 * kT);
+  TEST_ASSERT_EQUAL_UINT32(42000, h.latencyPercentileMs(100)); // Classe ouverte
+  TEST_ASSERT_EQUAL_UINT32(42000, h.latencyMaxMs());
+}
+
+void test_latency_forgets_old_regime(void) {
+  SensorHealth h(phConfig());
+  for (uint32_t i = 0; i < 200; ++i) h.onRead(true, true, 7.2f, 4000, i * kT);
+  TEST_ASSERT_EQUAL_UINT32(4000, h.latencyPercentileMs(50));
+  for (uint32_t i = 200; i < 1200; ++i) h.onRead(true, true, 7.2f, 900, i * kT);
+  TEST_ASSERT_TRUE(h.latencyPercentileMs(95) <= 1000);
+}
+
+void test_not_started_cycle_has_no_latency(void) {
+  SensorHealth h(phConfig());
+  h.onRead(false, false, NAN, kSensorHealthNoLatency, 0);
+  TEST_ASSERT_EQUAL_UINT32(0, h.latencyPercentileMs(95));
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, h.failRate());
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, h.sampleAgeMs(kT));
+}
+
+void test_healthy_channel_scores_100(void) {
+  SensorHealth h(phConfig());
+  for (uint32_t i = 0; i < 200; ++i) h.onRead(true, true, 7.3f + noise(i, 0.001f), 950, i * kT);
+  TEST_ASSERT_EQUAL_UINT8(100, h.score(199 * kT));
+}
+
+void test_score_degrades_with_noise_and_failures(void) {
+  SensorHealth clean(phConfig()), noisy(phConfig()), flaky(phConfig());
+  for (uint32_t i = 0; i < 300; ++i) {
+    const uint32_t now = i * kT;
+    clean.onRead(true, true, 7.3f, 950, now);
+    noisy.onRead(true, true, 7.3f + noise(i, 0.05f), 950, now);
+    flaky.onRead(i % 4 != 0, true, 7.3f, i % 4 != 0 ? 950 : kSensorHealthNoLatency, now);
+  }
+  const uint32_t now = 299 * kT;
+  TEST_ASSERT_EQUAL_UINT8(70, noisy.score(now));   // Bruit > limite : −30
+  TEST_ASSERT_EQUAL_UINT8(75, flaky.score(now));   // 25 % d'échecs > limite : −25
+  TEST_ASSERT_EQUAL_UINT8(100, clean.score(now));
+}
+
+void test_score_partial_penalty_between_half_and_limit(void) {
+  // Latence p95 entre la moitié de la limite (1500) et la limite (3000) :
+  // pénalité linéaire.
+  SensorHealth h(phConfig());
+  for (uint32_t i = 0; i < 100; ++i) h.onRead(true, true, 7.3f, 1900, i * kT);
+  TEST_ASSERT_EQUAL_UINT32(1900, h.latencyPercentileMs(95));
+  // 2 × 1900 / 3000 − 1 = 0,267 → 0,267 × 15 = 4 points
+  TEST_ASSERT_EQUAL_UINT8(96, h.score(99 * kT));
+}
+
+void test_silent_channel_scores_zero(void) {
+  SensorHealth h(phConfig());
+  TEST_ASSERT_EQUAL_UINT8(0, h.score(0));
+  for (uint32_t i = 0; i < 10; ++i) h.onRead(true, true, 7.3f, 950, i * kT);
+  TEST_ASSERT_TRUE(h.score(9 * kT) > 0);
+  TEST_ASSERT_EQUAL_UINT8(0, h.score(9 * kT + kSensorFilterMaxAgeMs + 1));
+}
+
+void test_sample_age_across_wrap(void) {
+  SensorHealth h(phConfig());
+  const uint32_t t0 = 0xFFFFF000u;
+  h.onRead(true, true, 7.3f, 950, t0);
+  TEST_ASSERT_EQUAL_UINT32(0x2000u, h.sampleAgeMs(t0 + 0x2000u));
+}
+
+void test_reset_clears_history(void) {
+  SensorHealth h(phConfig());
+  for (uint32_t i = 0; i < 50; ++i) h.onRead(i % 3 != 0, i % 5 != 0, 7.3f + noise(i, 0.05f), 2500, i * kT);
+  h.reset();
+  TEST_ASSERT_TRUE(isnan(h.noiseStd()));
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, h.spikeRate());
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, h.failRate());
+  TEST_ASSERT_EQUAL_UINT32(0, h.latencyPercentileMs(95));
+  TEST_ASSERT_EQUAL_UINT32(0, h.reads());
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, h.sampleAgeMs(0));
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_noise_nan_until_two_accepted);
+  RUN_TEST(test_noise_matches_white_noise_std);
+  RUN_TEST(test_slow_ramp_not_counted_as_noise);
+  RUN_TEST(test_rejected_reads_do_not_feed_noise);
+  RUN_TEST(test_fail_rate_primes_then_forgets);
+  RUN_TEST(test_latency_percentiles_by_bucket);
+  RUN_TEST(test_latency_forgets_old_regime);
+  RUN_TEST(test_not_started_cycle_has_no_latency);
+  RUN_TEST(test_healthy_channel_scores_100);
+  RUN_TEST(test_score_degrades_with_noise_and_failures);
+  RUN_TEST(test_score_partial_penalty_between_half_and_limit);
+  RUN_TEST(test_silent_channel_scores_zero);
+  RUN_TEST(test_sample_age_across_wrap);
+  RUN_TEST(test_reset_clears_history);
+  return UNITY_END();
+}
@@ -0,0 +1,228 @@
+// =============================================================================
+// Tests unitaires natifs — sensor_trace_logic + sensor_replay_logic
+// =============================================================================
+// Tournent sur PC (env:native, Unity), HORS matériel ESP32 / LittleFS.
+// On teste :
+//   - format binaire : tailles, en-tête, position des slots, repli de l'anneau
+//   - reprise (scan) et ordre chronologique après repli
+//   - relecture déterministe : même config → aucun écart ; fenêtre médiane
+//     différente → écart filtre ; consigne différente → décisions divergentes
+//   - concordance avec l'état enregistré (flags + filtré au bit)
+// =============================================================================
+
+#include <unity.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include "constants.h"
+#include "sensor_trace_logic.h"
+#include "sensor_replay_logic.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static ReplayChannelParams phParams() {
+  ReplayChannelParams p = {};
+  p.filter = SensorFilterConfig{
+      kPhFilterMin, kPhFilterMax, kPhFilterMaxStep, kPhEmaAlpha,
+      kPhFilterMedianWindow, kSensorFilterWarmupSamples,
+      kSensorFilterMaxConsecutiveRejects, kSensorFilterMaxAgeMs,
+      kSensorFrozenSamples, kSensorFrozenEpsilonPh};
+  p.target = 7.2f;
+  p.errorAboveTarget = true;
+  p.startThreshold = 0.05f;
+  p.stopThreshold = 0.01f;
+  p.minInjectionTimeMs = 30000;
+  p.maxCyclesPerDay = 20;
+  p.kp = 8.0f;
+  p.integralMax = 50.0f;
+  p.minFlow = 5.2f;
+  p.maxFlow = 90.0f;
+  return p;
+}
+
+// Trace pH synthétique déterministe : dérive lente au-dessus de la consigne,
+// bruit pseudo-aléatoire ±0.01 et un pic EMI tous les 40 cycles.
+static float syntheticPh(uint32_t i) {
+  uint32_t x = i * 2654435761u;
+  const float noise = ((x >> 16) % 21 - 10) * 0.001f;
+  float v = 7.25f + 0.0005f * i + noise;
+  if (i % 40 == 39) v += 0.6f;
+  return v;
+}
+
+// ---------------------------------------------------------------------------
+// Format
+// ---------------------------------------------------------------------------
+
+void test_header_roundtrip(void) {
+  SensorTraceHeader h = sensorTraceMakeHeader(256);
+  TEST_ASSERT_EQUAL_UINT32(kSensorTraceMagic, h.magic);
+  TEST_ASSERT_TRUE(sensorTraceHeaderValid(h, 256));
+  TEST_ASSERT_FALSE(sensorTraceHeaderValid(h, 128));   // autre capacité → recréé
+  h.version = kSensorTraceVersion + 1;
+  TEST_ASSERT_FALSE(sensorTraceHeaderValid(h, 256));
+  SensorTraceHeader zero = {};
+  TEST_ASSERT_FALSE(sensorTraceHeaderValid(zero, 0));
+}
+
+void test_file_size_and_offsets(void) {
+  TEST_ASSERT_EQUAL_UINT32(16 + 256 * 32, sensorTraceFileSize(256));
+  TEST_ASSERT_EQUAL_UINT32(16, sensorTraceOffset(1, 256));
+  TEST_ASSERT_EQUAL_UINT32(16 + 255 * 32, sensorTraceOffset(256, 256));
+  TEST_ASSERT_EQUAL_UINT32(16, sensorTraceOffset(257, 256));        // repli
+  TEST_ASSERT_EQUAL_UINT32(16 + 32, sensorTraceOffset(258, 256));
+}
+
+void test_flags_packing(void) {
+  TEST_ASSERT_EQUAL_UINT8(0, sensorTraceFlags(false, false, false, false, false));
+  TEST_ASSERT_EQUAL_UINT8(kTraceSampled | kTraceReady,
+                          sensorTraceFlags(true, false, true, false, false));
+  TEST_ASSERT_EQUAL_UINT8(0x1F, sensorTraceFlags(true, true, true, true, true));
+}
+
+// ---------------------------------------------------------------------------
+// Reprise et ordre
+// ---------------------------------------------------------------------------
+
+void test_scan_empty_and_partial(void) {
+  SensorTraceRecord slots[8] = {};
+  uint32_t seq = 99;
+  uint16_t session = 99;
+  sensorTraceScan(slots, 8, &seq, &session);
+  TEST_ASSERT_EQUAL_UINT32(0, seq);
+  TEST_ASSERT_EQUAL_UINT16(0, session);
+
+  slots[0].seq = 1; slots[0].session = 1;
+  slots[1].seq = 2; slots[1].session = 2;
+  sensorTraceScan(slots, 8, &seq, &session);
+  TEST_ASSERT_EQUAL_UINT32(2, seq);
+  TEST_ASSERT_EQUAL_UINT16(2, session);
+}
+
+void test_order_after_wrap(void) {
+  // Anneau de 8 après 11 écritures : slots 0..2 = seq 9..11, 3..7 = seq 4..8.
+  SensorTraceRecord slots[8] = {};
+  for (uint32_t seq = 1; seq <= 11; ++seq) {
+    const size_t slot = (sensorTraceOffset(seq, 8) - sizeof(SensorTraceHeader)) /
+                        sizeof(SensorTraceRecord);
+    slots[slot].seq = seq;
+  }
+  uint16_t order[8];
+  const size_t n = sensorTraceOrder(slots, 8, order);
+  TEST_ASSERT_EQUAL_UINT32(8, n);
+  for (size_t i = 0; i < n; ++i) {
+    TEST_ASSERT_EQUAL_UINT32(4 + i, slots[order[i]].seq);
+  }
+}
+
+void test_order_skips_empty_slots(void) {
+  SensorTraceRecord slots[6] = {};
+  slots[4].seq = 3;
+  slots[1].seq = 1;
+  slots[2].seq = 2;
+  uint16_t order[6];
+  TEST_ASSERT_EQUAL_UINT32(3, sensorTraceOrder(slots, 6, order));
+  TEST_ASSERT_EQUAL_UINT16(1, order[0]);
+  TEST_ASSERT_EQUAL_UINT16(2, order[1]);
+  TEST_ASSERT_EQUAL_UINT16(4, order[2]);
+}
+
+// ---------------------------------------------------------------------------
+// Relecture
+// ---------------------------------------------------------------------------
+
+void test_replay_same_config_no_diff(void) {
+  ReplayChannel a(phParams()), b(phParams());
+  ReplayDiff d;
+  for (uint32_t i = 0; i < 300; ++i) {
+    const uint32_t now = 1000 + i * 5000;
+    replayDiffAdd(d, a.step(true, syntheticPh(i), now), b.step(true, syntheticPh(i), now));
+  }
+  TEST_ASSERT_EQUAL_UINT32(300, d.steps);
+  TEST_ASSERT_EQUAL_UINT32(0, d.dosingDiffs);
+  TEST_ASSERT_EQUAL_UINT32(0, d.refusalDiffs);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, d.maxFilteredDelta);
+  TEST_ASSERT_EQUAL_INT32(-1, d.firstDiff);
+  TEST_ASSERT_TRUE(d.dosingStepsRef > 0);   // la trace fait bien doser
+}
+
+void test_replay_restart_is_deterministic(void) {
+  ReplayChannel c(phParams());
+  float first[50];
+  for (uint32_t i = 0; i < 50; ++i) first[i] = c.step(true, syntheticPh(i), i * 5000).filtered;
+  c.restart();
+  for (uint32_t i = 0; i < 50; ++i) {
+    const float v = c.step(true, syntheticPh(i), i * 5000).filtered;
+    TEST_ASSERT_TRUE(memcmp(&first[i], &v, sizeof(float)) == 0 || (isnan(first[i]) && isnan(v)));
+  }
+}
+
+void test_replay_window_change_shows_filter_diff(void) {
+  ReplayChannelParams wide = phParams();
+  wide.filter.medianWindow = kReplayMaxMedianWindow;
+  ReplayChannel a(phParams()), b(wide);
+  ReplayDiff d;
+  for (uint32_t i = 0; i < 200; ++i) {
+    const uint32_t now = i * 5000;
+    replayDiffAdd(d, a.step(true, syntheticPh(i), now), b.step(true, syntheticPh(i), now));
+  }
+  TEST_ASSERT_TRUE(d.maxFilteredDelta > 0.0f);
+}
+
+void test_replay_target_change_diverges_decision(void) {
+  ReplayChannelParams high = phParams();
+  high.target = 7.6f;   // au-dessus de toute la trace → jamais de pH-
+  ReplayChannel a(phParams()), b(high);
+  ReplayDiff d;
+  for (uint32_t i = 0; i < 200; ++i) {
+    const uint32_t now = i * 5000;
+    replayDiffAdd(d, a.step(true, syntheticPh(i), now), b.step(true, syntheticPh(i), now));
+  }
+  TEST_ASSERT_TRUE(d.dosingDiffs > 0);
+  TEST_ASSERT_EQUAL_UINT32(0, d.dosingStepsCand);
+  TEST_ASSERT_TRUE(d.firstDiff >= 0);
+}
+
+void test_replay_not_ready_refuses_dosing(void) {
+  ReplayChannel c(phParams());
+  const ReplayStep s = c.step(true, 7.8f, 0);   // 1er échantillon : warmup
+  TEST_ASSERT_FALSE(s.ready);
+  TEST_ASSERT_TRUE(s.refusal != DoseRefusal::None);
+  TEST_ASSERT_FALSE(s.dosing);
+  const ReplayStep miss = c.step(false, NAN, 5000);  // lecture ratée : non alimenté
+  TEST_ASSERT_FALSE(miss.accepted);
+}
+
+void test_recorded_match(void) {
+  ReplayChannel c(phParams());
+  ReplayStep s = {};
+  for (uint32_t i = 0; i < 10; ++i) s = c.step(true, syntheticPh(i), i * 5000);
+  const uint8_t flags = sensorTraceFlags(true, s.accepted, s.ready, s.unstable, s.frozen);
+  TEST_ASSERT_TRUE(replayMatchesRecorded(s, flags, s.filtered));
+  // 1 ulp d'écart → non concordant (comparaison au bit).
+  const float off = nextafterf(s.filtered, 100.0f);
+  TEST_ASSERT_FALSE(replayMatchesRecorded(s, flags, off));
+  TEST_ASSERT_FALSE(replayMatchesRecorded(s, flags ^ kTraceReady, s.filtered));
+  // Avant amorçage : NaN des deux côtés = concordant.
+  ReplayChannel cold(phParams());
+  const ReplayStep none = cold.step(false, NAN, 0);
+  TEST_ASSERT_TRUE(replayMatchesRecorded(none, 0, NAN));
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_header_roundtrip);
+  RUN_TEST(test_file_size_and_offsets);
+  RUN_TEST(test_flags_packing);
+  RUN_TEST(test_scan_empty_and_partial);
+  RUN_TEST(test_order_after_wrap);
+  RUN_TEST(test_order_skips_empty_slots);
+  RUN_TEST(test_replay_same_config_no_diff);
+  RUN_TEST(test_replay_restart_is_deterministic);
+  RUN_TEST(test_replay_window_change_shows_filter_diff);
+  RUN_TEST(test_replay_target_change_diverges_decision);
+  RUN_TEST(test_replay_not_ready_refuses_dosing);
+  RUN_TEST(test_recorded_match);
+  return UNITY_END();
+}
@@ -0,0 +1,136 @@
+// =============================================================================
+// Tests unitaires natifs — ws_push_logic (cadence WS adaptative)
+// =============================================================================
+// Tournent sur PC (env:native, Unity), HORS matériel ESP32 / AsyncWebSocket.
+// On teste :
+//   - wsLinkObserve / wsLinkLatencyMs : estimation de latence sur la file d'envoi
+//   - wsPushIntervalMs : matrice visibilité × activité × qualité du lien
+//   - wsPushDue : échéance, sentinelle 0 et wrap de millis()
+// =============================================================================
+
+#include <unity.h>
+#include <stdint.h>
+#include "ws_push_logic.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static WsPushPolicyInput input(bool hidden, bool live, bool active, uint32_t latencyMs) {
+  WsPushPolicyInput in = {hidden, live, active, latencyMs};
+  return in;
+}
+
+// -----------------------------------------------------------------------------
+// Latence du lien
+// -----------------------------------------------------------------------------
+void test_link_first_sample_is_taken_as_is(void) {
+  WsLinkState s;
+  wsLinkObserve(s, 2, 1000);   // file non vide → début de l'échantillon
+  wsLinkObserve(s, 1, 1040);   // toujours non vide : pas de nouvel échantillon
+  wsLinkObserve(s, 0, 1120);   // vidée → 120 ms
+  TEST_ASSERT_TRUE(s.hasSample);
+  TEST_ASSERT_FALSE(s.busy);
+  TEST_ASSERT_EQUAL_UINT32(120, s.latencyMs);
+}
+
+void test_link_ewma_quarter_weight(void) {
+  WsLinkState s;
+  wsLinkObserve(s, 1, 0);
+  wsLinkObserve(s, 0, 100);    // 1er échantillon : 100
+  wsLinkObserve(s, 1, 200);
+  wsLinkObserve(s, 0, 700);    // 500 → (100*3 + 500)/4 = 200
+  TEST_ASSERT_EQUAL_UINT32(200, s.latencyMs);
+}
+
+void test_link_idle_queue_keeps_estimate(void) {
+  WsLinkState s;
+  wsLinkObserve(s, 1, 0);
+  wsLinkObserve(s, 0, 80);
+  wsLinkObserve(s, 0, 5000);   // file restée vide : aucune mise à jour
+  TEST_ASSERT_EQUAL_UINT32(80, s.latencyMs);
+  TEST_ASSERT_EQUAL_UINT32(80, wsLinkLatencyMs(s, 9000));
+}
+
+void test_link_stuck_backlog_counts_as_latency(void) {
+  WsLinkState s;
+  wsLinkObserve(s, 1, 0);
+  wsLinkObserve(s, 0, 50);     // EWMA 50
+  wsLinkObserve(s, 3, 1000);   // backlog depuis 1000
+  TEST_ASSERT_EQUAL_UINT32(50, wsLinkLatencyMs(s, 1020));   // backlog 20 < EWMA
+  TEST_ASSERT_EQUAL_UINT32(900, wsLinkLatencyMs(s, 1900));  // backlog 900 > EWMA
+}
+
+void test_link_sample_across_millis_wrap(void) {
+  WsLinkState s;
+  wsLinkObserve(s, 1, 0xFFFFFFF0u);
+  wsLinkObserve(s, 0, 0x00000010u);  // 32 ms à travers le wrap
+  TEST_ASSERT_EQUAL_UINT32(32, s.latencyMs);
+}
+
+// -----------------------------------------------------------------------------
+// Intervalle de push
+// -----------------------------------------------------------------------------
+void test_interval_hidden_is_heartbeat_whatever_activity(void) {
+  TEST_ASSERT_EQUAL_UINT32(kWsPushHiddenMs, wsPushIntervalMs(input(true, false, false, 0)));
+  TEST_ASSERT_EQUAL_UINT32(kWsPushHiddenMs, wsPushIntervalMs(input(true, true, true, 0)));
+  TEST_ASSERT_EQUAL_UINT32(kWsPushHiddenMs, wsPushIntervalMs(input(true, false, true, 5000)));
+}
+
+void test_interval_visible_idle_good_link(void) {
+  TEST_ASSERT_EQUAL_UINT32(kWsPushIdleMs, wsPushIntervalMs(input(false, false, false, 0)));
+  TEST_ASSERT_EQUAL_UINT32(kWsPushIdleMs,
+                           wsPushIntervalMs(input(false, false, false, kWsSlowLinkLatencyMs - 1)));
+}
+
+void test_interval_visible_idle_slow_link(void) {
+  TEST_ASSERT_EQUAL_UINT32(kWsPushSlowLinkMs,
+                           wsPushIntervalMs(input(false, false, false, kWsSlowLinkLatencyMs)));
+}
+
+void test_interval_dosing_or_live_good_link_is_fast(void) {
+  TEST_ASSERT_EQUAL_UINT32(kWsPushActiveMs, wsPushIntervalMs(input(false, false, true, 10)));
+  TEST_ASSERT_EQUAL_UINT32(kWsPushActiveMs, wsPushIntervalMs(input(false, true, false, 10)));
+}
+
+void test_interval_active_slow_link_falls_back_to_idle_rate(void) {
+  TEST_ASSERT_EQUAL_UINT32(kWsPushIdleMs, wsPushIntervalMs(input(false, true, true, 2000)));
+}
+
+// -----------------------------------------------------------------------------
+// Échéance
+// -----------------------------------------------------------------------------
+void test_due_zero_sentinel_is_immediate(void) {
+  TEST_ASSERT_TRUE(wsPushDue(0, 5, kWsPushHiddenMs));
+}
+
+void test_due_respects_interval(void) {
+  TEST_ASSERT_FALSE(wsPushDue(1000, 1999, 1000));
+  TEST_ASSERT_TRUE(wsPushDue(1000, 2000, 1000));
+}
+
+void test_due_across_millis_wrap(void) {
+  TEST_ASSERT_FALSE(wsPushDue(0xFFFFFF00u, 0x00000010u, 1000));  // 272 ms écoulées
+  TEST_ASSERT_TRUE(wsPushDue(0xFFFFFF00u, 0x00000300u, 1000));   // 1024 ms écoulées
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_link_first_sample_is_taken_as_is);
+  RUN_TEST(test_link_ewma_quarter_weight);
+  RUN_TEST(test_link_idle_queue_keeps_estimate);
+  RUN_TEST(test_link_stuck_backlog_counts_as_latency);
+  RUN_TEST(test_link_sample_across_millis_wrap);
+
+  RUN_TEST(test_interval_hidden_is_heartbeat_whatever_activity);
+  RUN_TEST(test_interval_visible_idle_good_link);
+  RUN_TEST(test_interval_visible_idle_slow_link);
+  RUN_TEST(test_interval_dosing_or_live_good_link_is_fast);
+  RUN_TEST(test_interval_active_slow_link_falls_back_to_idle_rate);
+
+  RUN_TEST(test_due_zero_sentinel_is_immediate);
+  RUN_TEST(test_due_respects_interval);
+  RUN_TEST(test_due_across_millis_wrap);
+
+  return UNITY_END();
+}
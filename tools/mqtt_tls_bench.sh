@@ -0,0 +1,91 @@
+#!/usr/bin/env bash
+# =============================================================================
+# Broker MQTT TLS local + banc de coût des handshakes (reprise de session).
+# =============================================================================
+# Sert de broker de substitution pour valider le transport TLS du contrôleur
+# (MqttTlsClient) sans broker distant : certificat auto-signé, mosquitto en
+# écoute sur 8883, puis déconnexions forcées pour mesurer le coût des
+# reconnexions (handshake complet vs session reprise).
+#
+# Prérequis : openssl, mosquitto, mosquitto_sub / mosquitto_pub (paquet
+# mosquitto-clients), jq pour le bilan.
+#
+# Usage :
+#   ./tools/mqtt_tls_bench.sh broker            # certificat + mosquitto -p 8883 (avant-plan)
+#   ./tools/mqtt_tls_bench.sh bench [N] [BASE]  # N déconnexions forcées (déf. 20), bilan
+#
+# Étapes :
+#   1. `broker` dans un terminal ; il affiche l'EMPREINTE à coller dans
+#      Paramètres → MQTT (serveur = IP du PC, port 8883, TLS activé).
+#   2. Attendre « MQTT TLS : session complète, handshake … » dans les logs.
+#   3. `bench 20 pool/sensors` dans un second terminal : chaque itération
+#      se connecte avec l'identifiant client du contrôleur, ce qui fait
+#      fermer sa session par le broker ; il se reconnecte après le délai de
+#      backoff (5 s). Le diagnostic est ensuite redemandé et résumé.
+#
+# Référence « sans reprise » : le premier handshake après le démarrage du
+# broker est toujours complet (moyenne « complets » du bilan) ; redémarrer
+# mosquitto entre deux mesures invalide aussi tickets et cache de session.
+# =============================================================================
+set -euo pipefail
+
+cd "$(dirname "$0")/.."   # racine du projet
+
+WORK_DIR="$PWD/.mqtt_tls_bench"
+PORT="${PORT:-8883}"
+CLIENT_ID="ESP32PoolController"   # identifiant utilisé par connectInTask()
+RECONNECT_WAIT_S="${RECONNECT_WAIT_S:-8}"  # > backoff initial 5 s + handshake
+
+mkdir -p "$WORK_DIR"
+
+cmd_broker() {
+  if [ ! -f "$WORK_DIR/broker.pem" ]; then
+    openssl req -x509 -newkey rsa:2048 -nodes -days 365 \
+      -keyout "$WORK_DIR/broker.key" -out "$WORK_DIR/broker.pem" \
+      -subj "/CN=pool-mqtt-bench" >/dev/null 2>&1
+  fi
+  echo "Empreinte à saisir dans l'UI :"
+  openssl x509 -noout -fingerprint -sha256 -in "$WORK_DIR/broker.pem" | sed 's/.*=//'
+
+  {
+    echo "listener $PORT"
+    echo "allow_anonymous true"
+    echo "certfile $WORK_DIR/broker.pem"
+    echo "keyfile $WORK_DIR/broker.key"
+    echo "tls_version tlsv1.2"
+  } > "$WORK_DIR/mosquitto.conf"
+  exec mosquitto -c "$WORK_DIR/mosquitto.conf" -v
+}
+
+cmd_bench() {
+  local n="${1:-20}"
+  local base="${2:-pool/sensors}"
+  local tls_opts=(-p "$PORT" --cafile "$WORK_DIR/broker.pem" --insecure)
+
+  for i in $(seq 1 "$n"); do
+    # Même identifiant client : le broker ferme la session du contrôleur.
+    mosquitto_sub -h localhost "${tls_opts[@]}" -i "$CLIENT_ID" -t "$base/status" -C 1 -W 1 >/dev/null 2>&1 || true
+    echo "[$i/$n] déconnexion forcée, attente ${RECONNECT_WAIT_S} s"
+    sleep "$RECONNECT_WAIT_S"
+  done
+
+  # Le diagnostic est republié à chaque reconnexion (retain) : dernier état.
+  local diag
+  diag=$(mosquitto_sub -h localhost "${tls_opts[@]}" -t "$base/diagnostic" -C 1 -W 10)
+  echo "$diag" | jq -r '
+    .mqtt_tls as $t
+    | if $t == null then "mqtt_tls absent (TLS désactivé ?)" else
+      "handshakes complets : \($t[0]) (moy. \($t[4]) ms)\n" +
+      "sessions reprises   : \($t[1]) (moy. \($t[5]) ms)\n" +
+      "reprises refusées   : \($t[2])\n" +
+      "échecs              : \($t[3])\n" +
+      "handshake max       : \($t[6]) ms\n" +
+      "pic tas max         : \($t[7]) o\n" +
+      "tas résident        : \($t[8]) o" end'
+}
+
+case "${1:-}" in
+  broker) cmd_broker ;;
+  bench)  shift; cmd_bench "$@" ;;
+  *) sed -n '2,28p' "$0"; exit 1 ;;
+esac
@@ -0,0 +1,48 @@
+#!/usr/bin/env bash
+# =============================================================================
+# Relecture hors ligne d'une trace capteurs pH/ORP (sensor_trace.bin).
+# =============================================================================
+# Compile tools/trace_replay/trace_replay.cpp avec les modules purs du firmware
+# (sensor_filter, sensor_estimator, dosing_logic, sensor_trace_logic,
+# sensor_replay_logic) et le shim natif des tests, puis rejoue la ou les
+# traces fournies.
+#
+# Prérequis : g++ (C++17), curl pour `fetch`.
+#
+# Usage :
+#   ./tools/trace_replay.sh fetch HOTE [FICHIER]   # télécharge la trace (auth WRITE)
+#   ./tools/trace_replay.sh [options] trace.bin [trace2.bin ...]
+#
+# Capture :
+#   curl -u admin:MDP -X POST "http://HOTE/sensor-trace/start?minutes=120"
+#   puis `fetch` toutes les ~10 min (anneau de 127 cycles) : l'outil fusionne
+#   les fichiers par numéro de séquence.
+#
+# Options : voir `./tools/trace_replay.sh --help` (fenêtre médiane, EMA, saut
+# max, consigne, seuil de démarrage, étage EMA/Kalman candidats ; --csv ;
+# --bench N).
+# Code retour : 0 décisions identiques, 3 décisions divergentes, 1-2 erreur.
+# =============================================================================
+set -euo pipefail
+
+cd "$(dirname "$0")/.."   # racine du projet
+
+BIN=".trace_replay/trace_replay"
+
+if [ "${1:-}" = "fetch" ]; then
+  host="${2:?HOTE requis}"
+  out="${3:-sensor_trace_$(date +%Y%m%d_%H%M%S).bin}"
+  user="${POOL_USER:-admin}"
+  curl -fsS -u "$user${POOL_PASS:+:$POOL_PASS}" -o "$out" "http://$host/sensor-trace/download"
+  echo "$out"
+  exit 0
+fi
+
+mkdir -p "$(dirname "$BIN")"
+g++ -std=c++17 -O2 -Wall -Wno-unused-variable \
+  -I src -I test/native_shim -include test/native_shim/logger_shim.h \
+  src/sensor_filter.cpp src/sensor_estimator.cpp src/dosing_logic.cpp \
+  src/sensor_trace_logic.cpp src/sensor_replay_logic.cpp \
+  tools/trace_replay/trace_replay.cpp -o "$BIN"
+
+exec "$BIN" "$@"
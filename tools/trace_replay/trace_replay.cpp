@@ -0,0 +1,293 @@
+// =============================================================================
+// trace_replay — Relecture hors ligne d'une trace capteurs (sensor_trace.bin)
+// =============================================================================
+// Rejoue les bruts pH/ORP enregistrés par le contrôleur (GET /sensor-trace/download)
+// à travers le VRAI code du firmware (sensor_filter, dosing_logic) compilé pour
+// le PC, avec deux configurations :
+//   - référence  : constantes du firmware (constants.h, défauts config.h) ;
+//   - candidate  : référence modifiée par les options --ph-* / --orp-*.
+// Bilan : écarts filtre / ready / refus / décision de dosage, et concordance de
+// la référence avec l'état enregistré par le firmware.
+//
+// Compilation et usage : tools/trace_replay.sh (voir son en-tête).
+// =============================================================================
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "constants.h"
+#include "sensor_replay_logic.h"
+#include "sensor_trace_logic.h"
+
+namespace {
+
+struct Channel {
+  const char* name;
+  ReplayChannelParams params;
+};
+
+// Défauts firmware : constants.h (filtre), config.h (cibles, seuils, cycles),
+// pump_controller.h (PID, débit mini), débit maxi par défaut de la pompe.
+ReplayChannelParams phDefaults() {
+  ReplayChannelParams p = {};
+  p.filter = SensorFilterConfig{
+      kPhFilterMin, kPhFilterMax, kPhFilterMaxStep, kPhEmaAlpha,
+      kPhFilterMedianWindow, kSensorFilterWarmupSamples,
+      kSensorFilterMaxConsecutiveRejects, kSensorFilterMaxAgeMs,
+      kSensorFrozenSamples, kSensorFrozenEpsilonPh,
+      SensorEstimatorConfig{
+          kPhFilterUseKalman ? SensorEstimator::Kalman : SensorEstimator::Ema,
+          kPhKalmanAccelStd, kPhKalmanMeasStd, kSensorKalmanDoseGain,
+          static_cast<uint32_t>(kPhMixingDelayMs)}};
+  p.target = 7.2f;
+  p.errorAboveTarget = true;   // pH- : erreur = mesure - cible
+  p.startThreshold = 0.05f;
+  p.stopThreshold = 0.01f;
+  p.minInjectionTimeMs = 30000;
+  p.maxCyclesPerDay = 20;
+  p.kp = 8.0f;
+  p.integralMax = 50.0f;
+  p.minFlow = 5.2f;
+  p.maxFlow = 90.0f;
+  p.trendHorizonMin = kPhTrendHorizonMin;
+  return p;
+}
+
+ReplayChannelParams orpDefaults() {
+  ReplayChannelParams p = phDefaults();
+  p.filter = SensorFilterConfig{
+      kOrpFilterMin, kOrpFilterMax, kOrpFilterMaxStep, kOrpEmaAlpha,
+      kOrpFilterMedianWindow, kSensorFilterWarmupSamples,
+      kSensorFilterMaxConsecutiveRejects, kSensorFilterMaxAgeMs,
+      kSensorFrozenSamples, kSensorFrozenEpsilonOrp,
+      SensorEstimatorConfig{
+          kOrpFilterUseKalman ? SensorEstimator::Kalman : SensorEstimator::Ema,
+          kOrpKalmanAccelStd, kOrpKalmanMeasStd, kSensorKalmanDoseGain,
+          static_cast<uint32_t>(kOrpMixingDelayMs)}};
+  p.target = 650.0f;
+  p.errorAboveTarget = false;  // chlore : erreur = cible - mesure
+  p.startThreshold = 15.0f;
+  p.stopThreshold = 2.0f;
+  p.kp = 0.3f;
+  p.trendHorizonMin = kOrpTrendHorizonMin;
+  return p;
+}
+
+void usage() {
+  fprintf(stderr,
+          "usage: trace_replay [options] trace.bin [trace2.bin ...]\n"
+          "  --ph-window N  --orp-window N     fenetre mediane candidate (1..%u, impaire)\n"
+          "  --ph-alpha A   --orp-alpha A      coefficient EMA candidat\n"
+          "  --ph-maxstep S --orp-maxstep S    saut max candidat\n"
+          "  --ph-target T  --orp-target T     consigne candidate\n"
+          "  --ph-start S   --orp-start S      seuil de demarrage candidat\n"
+          "  --ph-estimator ema|kalman  --orp-estimator ema|kalman   etage final candidat\n"
+          "  --ph-accel A   --orp-accel A      sigma acceleration Kalman candidat (unites/s2)\n"
+          "  --csv FICHIER                     detail pas a pas (reference / candidate)\n"
+          "  --bench N                         N relectures chronometrees (ns/echantillon)\n",
+          static_cast<unsigned>(kReplayMaxMedianWindow));
+}
+
+// Lit un fichier de trace ; ajoute ses enregistrements non vides à `bySeq`
+// (les téléchargements successifs d'une longue capture se recouvrent).
+bool loadTrace(const char* path, std::map<uint32_t, SensorTraceRecord>& bySeq) {
+  FILE* f = fopen(path, "rb");
+  if (!f) {
+    fprintf(stderr, "%s : ouverture impossible\n", path);
+    return false;
+  }
+  SensorTraceHeader h;
+  if (fread(&h, sizeof(h), 1, f) != 1 || !sensorTraceHeaderValid(h, h.capacity)) {
+    fprintf(stderr, "%s : en-tete invalide (format ou version)\n", path);
+    fclose(f);
+    return false;
+  }
+  std::vector<SensorTraceRecord> slots(h.capacity);
+  const size_t got = fread(slots.data(), sizeof(SensorTraceRecord), h.capacity, f);
+  fclose(f);
+  if (got < h.capacity) {
+    fprintf(stderr, "%s : tronque (%zu/%u slots), slots lus conserves\n", path, got,
+            static_cast<unsigned>(h.capacity));
+  }
+  std::vector<uint16_t> order(got);
+  const size_t n = sensorTraceOrder(slots.data(), got, order.data());
+  for (size_t i = 0; i < n; ++i) {
+    const SensorTraceRecord& r = slots[order[i]];
+    bySeq[r.seq] = r;
+  }
+  printf("%s : %zu enregistrements (seq %u..%u)\n", path, n,
+         n ? slots[order[0]].seq : 0, n ? slots[order[n - 1]].seq : 0);
+  return true;
+}
+
+struct ChannelReport {
+  ReplayDiff diff;
+  uint32_t recordedSteps = 0;
+  uint32_t recordedMatches = 0;
+  float recordedMaxDelta = 0.0f;
+};
+
+void printReport(const char* name, const ChannelReport& r) {
+  const ReplayDiff& d = r.diff;
+  printf("\n[%s] %u pas\n", name, d.steps);
+  printf("  filtre    : ecart max %.4f, ready different sur %u pas\n", d.maxFilteredDelta,
+         d.readyDiffs);
+  printf("  decision  : refus differents %u, dosage different %u (ref %u pas, cand %u pas)\n",
+         d.refusalDiffs, d.dosingDiffs, d.dosingStepsRef, d.dosingStepsCand);
+  printf("  debit     : ecart max %.2f ml/min\n", d.maxFlowDelta);
+  if (d.firstDiff >= 0) {
+    printf("  1re divergence de decision au pas %d\n", d.firstDiff);
+  }
+  printf("  reference vs enregistre : %u/%u pas identiques, ecart filtre max %.4f\n",
+         r.recordedMatches, r.recordedSteps, r.recordedMaxDelta);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Channel ph = {"pH", phDefaults()};
+  Channel orp = {"ORP", orpDefaults()};
+  ReplayChannelParams phCand = ph.params;
+  ReplayChannelParams orpCand = orp.params;
+  const char* csvPath = nullptr;
+  long benchRuns = 0;
+  std::vector<const char*> files;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (a == "--csv" && hasValue) { csvPath = argv[++i]; continue; }
+    if (a == "--bench" && hasValue) { benchRuns = atol(argv[++i]); continue; }
+    if ((a == "--ph-estimator" || a == "--orp-estimator") && hasValue) {
+      const std::string m = argv[++i];
+      if (m != "ema" && m != "kalman") { usage(); return 2; }
+      ReplayChannelParams& c = (a == "--ph-estimator") ? phCand : orpCand;
+      c.filter.estimator.mode = (m == "kalman") ? SensorEstimator::Kalman : SensorEstimator::Ema;
+      continue;
+    }
+    if (a.compare(0, 2, "--") == 0 && hasValue) {
+      const float v = static_cast<float>(atof(argv[++i]));
+      if      (a == "--ph-window")   phCand.filter.medianWindow = static_cast<uint8_t>(v);
+      else if (a == "--orp-window")  orpCand.filter.medianWindow = static_cast<uint8_t>(v);
+      else if (a == "--ph-alpha")    phCand.filter.emaAlpha = v;
+      else if (a == "--orp-alpha")   orpCand.filter.emaAlpha = v;
+      else if (a == "--ph-maxstep")  phCand.filter.maxStep = v;
+      else if (a == "--orp-maxstep") orpCand.filter.maxStep = v;
+      else if (a == "--ph-target")   phCand.target = v;
+      else if (a == "--orp-target")  orpCand.target = v;
+      else if (a == "--ph-start")    phCand.startThreshold = v;
+      else if (a == "--orp-start")   orpCand.startThreshold = v;
+      else if (a == "--ph-accel")    phCand.filter.estimator.accelStd = v;
+      else if (a == "--orp-accel")   orpCand.filter.estimator.accelStd = v;
+      else { usage(); return 2; }
+      continue;
+    }
+    if (a.compare(0, 2, "--") == 0) { usage(); return 2; }
+    files.push_back(argv[i]);
+  }
+  if (files.empty()) { usage(); return 2; }
+  const uint8_t phW = phCand.filter.medianWindow, orpW = orpCand.filter.medianWindow;
+  if (phW == 0 || orpW == 0 || phW > kReplayMaxMedianWindow || orpW > kReplayMaxMedianWindow ||
+      phW % 2 == 0 || orpW % 2 == 0) {
+    fprintf(stderr, "fenetre mediane : impaire, 1..%u\n",
+            static_cast<unsigned>(kReplayMaxMedianWindow));
+    return 2;
+  }
+
+  std::map<uint32_t, SensorTraceRecord> bySeq;
+  for (const char* path : files) {
+    if (!loadTrace(path, bySeq)) return 1;
+  }
+  if (bySeq.empty()) {
+    fprintf(stderr, "trace vide\n");
+    return 1;
+  }
+  std::vector<SensorTraceRecord> trace;
+  trace.reserve(bySeq.size());
+  uint32_t gaps = 0, prevSeq = 0;
+  for (const auto& kv : bySeq) {
+    if (prevSeq && kv.first != prevSeq + 1) gaps++;
+    prevSeq = kv.first;
+    trace.push_back(kv.second);
+  }
+  printf("Fusion : %zu enregistrements, %u trous de seq (slots ecrases ou perdus entre deux telechargements)\n",
+         trace.size(), gaps);
+
+  ReplayChannel phRef(ph.params), phAlt(phCand);
+  ReplayChannel orpRef(orp.params), orpAlt(orpCand);
+  ChannelReport phRep, orpRep;
+  FILE* csv = csvPath ? fopen(csvPath, "w") : nullptr;
+  if (csv) {
+    fprintf(csv, "seq,session,ms,ph_raw,ph_rec,ph_ref,ph_cand,ph_dose_ref,ph_dose_cand,"
+                 "orp_raw,orp_rec,orp_ref,orp_cand,orp_dose_ref,orp_dose_cand\n");
+  }
+
+  uint16_t session = 0;
+  for (const SensorTraceRecord& r : trace) {
+    if (r.session != session) {
+      // Nouvel armement : le contrôleur a pu redémarrer entre-temps.
+      session = r.session;
+      phRef.restart(); phAlt.restart();
+      orpRef.restart(); orpAlt.restart();
+    }
+    const bool phSampled = (r.phFlags & kTraceSampled) != 0;
+    const bool orpSampled = (r.orpFlags & kTraceSampled) != 0;
+    const ReplayStep pr = phRef.step(phSampled, r.phRaw, r.ms);
+    const ReplayStep pc = phAlt.step(phSampled, r.phRaw, r.ms);
+    const ReplayStep orr = orpRef.step(orpSampled, r.orpRaw, r.ms);
+    const ReplayStep oc = orpAlt.step(orpSampled, r.orpRaw, r.ms);
+    replayDiffAdd(phRep.diff, pr, pc);
+    replayDiffAdd(orpRep.diff, orr, oc);
+
+    struct { ChannelReport* rep; const ReplayStep* s; uint8_t flags; float rec; } checks[] = {
+        {&phRep, &pr, r.phFlags, r.phFiltered}, {&orpRep, &orr, r.orpFlags, r.orpFiltered}};
+    for (auto& c : checks) {
+      c.rep->recordedSteps++;
+      if (replayMatchesRecorded(*c.s, c.flags, c.rec)) c.rep->recordedMatches++;
+      if (!isnan(c.rec) && !isnan(c.s->filtered)) {
+        const float delta = fabsf(c.rec - c.s->filtered);
+        if (delta > c.rep->recordedMaxDelta) c.rep->recordedMaxDelta = delta;
+      }
+    }
+    if (csv) {
+      fprintf(csv, "%u,%u,%u,%.3f,%.4f,%.4f,%.4f,%d,%d,%.1f,%.2f,%.2f,%.2f,%d,%d\n", r.seq,
+              r.session, r.ms, r.phRaw, r.phFiltered, pr.filtered, pc.filtered, pr.dosing,
+              pc.dosing, r.orpRaw, r.orpFiltered, orr.filtered, oc.filtered, orr.dosing,
+              oc.dosing);
+    }
+  }
+  if (csv) fclose(csv);
+
+  printReport(ph.name, phRep);
+  printReport(orp.name, orpRep);
+  printf("\nNB : la capture demarre filtre deja amorce cote firmware ; les premiers pas de\n"
+         "chaque session peuvent differer de l'enregistre avant convergence de l'EMA.\n");
+
+  if (benchRuns > 0) {
+    // Coût de la chaîne complète (filtre + décision) par échantillon et par voie.
+    ReplayChannel bench(ph.params);
+    const auto t0 = std::chrono::steady_clock::now();
+    uint32_t sink = 0;
+    for (long run = 0; run < benchRuns; ++run) {
+      bench.restart();
+      for (const SensorTraceRecord& r : trace) {
+        sink += bench.step((r.phFlags & kTraceSampled) != 0, r.phRaw, r.ms).dosing;
+      }
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+    printf("\nbench : %.1f ns/echantillon (%ld x %zu pas, %u doses)\n",
+           ns / (static_cast<double>(benchRuns) * trace.size()), benchRuns, trace.size(), sink);
+  }
+
+  const bool differs = phRep.diff.dosingDiffs || orpRep.diff.dosingDiffs ||
+                       phRep.diff.refusalDiffs || orpRep.diff.refusalDiffs;
+  return differs ? 3 : 0;
+}